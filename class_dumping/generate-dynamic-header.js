@@ -38,30 +38,30 @@ header += `
 var POPULATED_MAP = "";
 
 for (var clz in fullClassTable) {
-	POPULATED_MAP += `\t\tclassid_mapping["${clz}"] = &${clz};\n`;
+	POPULATED_MAP += `\t\t{ "${clz}", &dynamic::${clz} },\n`;
 }
 
 var source = `
 
 #include "classinfo/dynamic.gen.hpp"
 #include "common.hpp"
+#include "core/perfecthash.hpp"
 
 namespace client_classes {
 	
-std::unordered_map<std::string, int*> classid_mapping {};
+static perfect_hash<int dynamic::*> classid_mapping {};
 	
 dynamic::dynamic() {
+	classid_mapping.Build({
 ${POPULATED_MAP}
+	});
 }
 
 void dynamic::Populate() {
-	ClientClass* cc = g_IBaseClient->GetAllClasses();
-	while (cc) {
-		std::string name(cc->GetName());
-		if (classid_mapping.find(name) != classid_mapping.end())
-			*classid_mapping[name] = cc->m_ClassID;
-		cc = cc->m_pNext;
-	}
+	// A single hash lookup for every class the game has
+	for (ClientClass* cc = g_IBaseClient->GetAllClasses(); cc; cc = cc->m_pNext)
+		if (auto member = classid_mapping.Find(cc->GetName()))
+			this->**member = cc->m_ClassID;
 }
 	
 dynamic dynamic_list;
@@ -0,0 +1,46 @@
+const fs = require("fs");
+
+// Usage: node generate-netvar-schema.js [netvar dump from debug_dump_netvars...]
+// Every dump given gets checked for the paths in netvars.json, so a renamed prop shows up here instead of as a 0 offset in game
+
+const schema = JSON.parse(fs.readFileSync("netvars.json").toString());
+
+for (var i = 2; i < process.argv.length; i++) {
+	var dumped = {};
+	for (var line of fs.readFileSync(process.argv[i]).toString().split("\n")) {
+		var prop = /^(\S+) (\d+)$/.exec(line);
+		if (prop)
+			dumped[prop[1]] = true;
+	}
+	for (var netvar of schema) {
+		if (netvar.path && !dumped[netvar.path])
+			console.log(process.argv[i] + ": missing " + netvar.name + " (" + netvar.path + ")");
+	}
+}
+
+console.log("Generating netvar schema");
+
+var header = `/*
+	AUTO-GENERATED HEADER - DO NOT MODIFY
+	NETVAR SCHEMA, EDIT class_dumping/netvars.json INSTEAD
+*/
+
+#ifndef NETVARSCHEMA_AUTOGEN_HPP
+#define NETVARSCHEMA_AUTOGEN_HPP
+
+// NETVAR(member, game, path) for networked props, FIXED(member, game, offset) for fields that aren't networked
+#define NETVAR_SCHEMA(NETVAR, FIXED) \\
+`;
+
+for (var netvar of schema) {
+	if (netvar.path)
+		header += `\tNETVAR(${netvar.name}, ${netvar.game}, "${netvar.path}") \\\n`;
+	else
+		header += `\t/* ${netvar.comment} */ FIXED(${netvar.name}, ${netvar.game}, ${netvar.offset}) \\\n`;
+}
+
+header += `
+#endif /* NETVARSCHEMA_AUTOGEN_HPP */
+`;
+
+fs.writeFileSync("../include/core/netvarschema.gen.hpp", header);
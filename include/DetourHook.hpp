@@ -13,6 +13,12 @@ class DetourHook
     uintptr_t original_address;
     std::unique_ptr<BytePatch> patch;
     void *hook_fn;
+    // The overwritten prologue relocated, followed by a jump back behind the patch.
+    // nullptr if the prologue has something that can't be moved, calling the original unpatches then
+    void *trampoline{ nullptr };
+
+    static void *BuildTrampoline(uintptr_t address, size_t patch_size);
+    void FreeTrampoline();
 
 public:
     DetourHook()
@@ -29,6 +35,8 @@ public:
         original_address   = original;
         hook_fn            = hook_func;
         uintptr_t rel_addr = ((uintptr_t) hook_func - ((uintptr_t) original_address)) - 5;
+        FreeTrampoline();
+        trampoline = BuildTrampoline(original, 5);
         patch.reset(new BytePatch(original, { 0xE9, foffset(rel_addr, 0), foffset(rel_addr, 1), foffset(rel_addr, 2), foffset(rel_addr, 3) }));
         InitBytepatch();
     }
@@ -48,13 +56,17 @@ public:
     ~DetourHook()
     {
         Shutdown();
+        FreeTrampoline();
     }
 
-    // Gets the original function with no patches
+    // Gets the original function, pair every call with RestorePatch()
     void *GetOriginalFunc() const
     {
         if (patch)
         {
+            // Callable while the hook stays in place
+            if (trampoline)
+                return trampoline;
             // Unpatch
             (*patch).Shutdown();
             return (void *) original_address;
@@ -63,9 +75,10 @@ public:
         return nullptr;
     }
 
-    // Restore the patches
+    // Restore the patches, nothing to do with a trampoline
     inline void RestorePatch()
     {
-        InitBytepatch();
+        if (!trampoline)
+            InitBytepatch();
     }
 };
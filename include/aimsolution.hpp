@@ -0,0 +1,18 @@
+#pragma once
+
+#include <mathlib/vector.h>
+
+class CachedEntity;
+
+// Per tick aim data several aim helpers ask for, computed the first time anyone asks for an entity
+namespace aim_solution
+{
+// Center of the collision box, no bone setup needed
+const Vector &Center(CachedEntity *ent);
+// Fov from the crosshair to Center()
+float Fov(CachedEntity *ent);
+// Distance from the eye to Center()
+float Distance(CachedEntity *ent);
+// Whether the pelvis hitbox center can be seen from the eye, false if there are no hitboxes
+bool PelvisVisible(CachedEntity *ent);
+} // namespace aim_solution
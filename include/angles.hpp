@@ -7,26 +7,110 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include "mathlib/vector.h"
 #include "entitycache.hpp"
 namespace angles
 {
 
-struct angle_data_s
+// Last N angles and statistics over the steps between them, all kept up to date by push so reading them is free
+template <size_t N> struct angle_history_s
 {
-    static constexpr size_t count = 16;
-    void push(const Vector &angle);
-    float deviation(int steps) const;
+    static_assert(N >= 3, "Need at least two steps for the snap");
+    static constexpr size_t count = N;
+    static constexpr size_t steps = N - 1;
+
+    void push(const Vector &angle)
+    {
+        if (not angle.x and not angle.y)
+            return;
+        good = true;
+        if (angle_count)
+        {
+            const Vector &last = angles[(angle_index + count - 1) % count];
+            float dx           = std::abs(angle.x - last.x);
+            float dy           = std::abs(angle.y - last.y);
+            if (dy > 180)
+                dy = 360 - dy;
+            PushStep(dx, dy);
+        }
+        angles[angle_index] = angle;
+        if (++angle_index >= int(count))
+            angle_index = 0;
+        if (angle_count < int(count))
+            angle_count++;
+    }
 
     Vector angles[count]{};
     bool good{ false };
     int angle_index{ 0 };
     int angle_count{ 0 };
+
+    // Largest pitch and yaw change over the last two steps combined, what the aimbot detector looks for
+    float snap{ 0 };
+    // Largest single step and the mean and variance of all steps in the window
+    float max_step{ 0 };
+    float mean_step{ 0 };
+    float step_variance{ 0 };
+    // Change in step size between the last two steps, degrees per tick per tick
+    float acceleration{ 0 };
+
+private:
+    void PushStep(float dx, float dy)
+    {
+        float step = std::sqrt(dx * dx + dy * dy);
+        int prev   = (step_index + steps - 1) % steps;
+        bool full  = step_count == int(steps);
+        float old  = full ? step_size[step_index] : 0.0f;
+        if (full)
+        {
+            step_sum -= old;
+            step_sum_sq -= double(old) * old;
+        }
+        if (step_count)
+        {
+            float hx     = std::max(dx, step_x[prev]);
+            float hy     = std::max(dy, step_y[prev]);
+            snap         = std::sqrt(hx * hx + hy * hy);
+            acceleration = step - step_size[prev];
+        }
+        else
+            snap = step;
+        step_x[step_index]    = dx;
+        step_y[step_index]    = dy;
+        step_size[step_index] = step;
+        if (++step_index >= int(steps))
+            step_index = 0;
+        if (!full)
+            step_count++;
+        step_sum += step;
+        step_sum_sq += double(step) * step;
+
+        // Only have to look at the whole window again when the largest step just dropped out of it
+        if (step >= max_step)
+            max_step = step;
+        else if (full && old >= max_step)
+            max_step = *std::max_element(step_size, step_size + steps);
+        mean_step     = step_sum / step_count;
+        step_variance = std::max(0.0, step_sum_sq / step_count - double(mean_step) * mean_step);
+    }
+
+    float step_x[steps]{};
+    float step_y[steps]{};
+    float step_size[steps]{};
+    int step_index{ 0 };
+    int step_count{ 0 };
+    double step_sum{ 0 };
+    double step_sum_sq{ 0 };
 };
 
+typedef angle_history_s<16> angle_data_s;
+
 extern angle_data_s data_[PLAYER_ARRAY_SIZE];
 
-void Update();
+// Detector thread, once per tick for every player. Players that aren't present lose their history
+void Update(int index, bool present, const Vector &angle);
 angle_data_s &data_idx(int index);
 angle_data_s &data(const CachedEntity *entity);
 } // namespace angles
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <functional>
+#include "public/mathlib/vector.h"
+
+// Visibility checks that don't need an answer this tick. They get traced on the game thread
+// in later CreateMoves with a bounded number of traces per tick, so big batches don't cause frame time spikes
+namespace asynctrace
+{
+// Called from a later CreateMove with the IsVectorVisible() result
+typedef std::function<void(bool visible)> callback_t;
+
+// Same arguments as IsVectorVisible(), self is always the local player
+void Submit(const Vector &origin, const Vector &target, bool enviroment_only, unsigned int mask, callback_t callback);
+// Queued checks that haven't been traced yet
+size_t Pending();
+} // namespace asynctrace
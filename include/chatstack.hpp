@@ -10,23 +10,47 @@
 constexpr float CHATSTACK_INTERVAL = 0.8f;
 
 #include "config.h"
+#include <cstdint>
 #include <string>
-#include <stack>
 #include <functional>
 
 namespace chat_stack
 {
 
+// Higher ones always go out first, same priority goes out in the order it was said
+enum priority : uint8_t
+{
+    // Spam, only worth saying if nothing else is waiting
+    low = 0,
+    normal,
+    // Has to go out right away, chat censoring
+    high,
+    PRIORITY_COUNT
+};
+
 struct msg_t
 {
-    std::string text;
-    bool team;
+    // The whole say/say_team command
+    std::string command;
+    priority level;
+};
+
+struct stats_s
+{
+    uint64_t queued{ 0 };
+    uint64_t sent{ 0 };
+    // Pushed out by something of higher priority or never let in because the queue was full
+    uint64_t dropped{ 0 };
 };
 
-void Say(const std::string &message, bool team = false);
+// False if the message got dropped right away
+bool Say(const std::string &message, bool team = false, priority level = normal);
+// Whether Say with level would get in without being dropped
+bool CanQueue(priority level);
+size_t Pending();
 void OnCreateMove();
 void Reset();
 
-extern std::stack<msg_t> stack;
+extern stats_s stats;
 extern float last_say;
 } // namespace chat_stack
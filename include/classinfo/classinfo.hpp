@@ -23,11 +23,14 @@
 #include "css_constexpr.gen.hpp"
 
 void InitClassTable();
+// Only does something in universal builds, game specific ones have a constexpr table
+void RebuildClassTable();
 
-extern client_classes::dummy *client_class_list;
+// Copy of the ids of the running game, so every CL_CLASS is a single load from a fixed address
+extern client_classes::dummy client_class_ids;
 
 #if not GAME_SPECIFIC
-#define CL_CLASS(x) (client_class_list->x)
+#define CL_CLASS(x) (client_class_ids.x)
 #else
 #define CL_CLASS(x) (client_classes_constexpr::GAME::x)
 #endif
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "enums.hpp"
+#include "classinfo.hpp"
+
+namespace classinfo
+{
+// All known games stay well below this many client classes
+constexpr int CLASS_TABLE_SIZE = 512;
+
+enum class_flags : uint16_t
+{
+    CF_NONE       = 0,
+    CF_PROJECTILE = 1 << 0,
+    CF_GRENADE    = 1 << 1,
+    CF_BUILDING   = 1 << 2,
+    CF_NPC        = 1 << 3,
+    CF_PICKUP     = 1 << 4,
+    // Used by the trace filters
+    CF_TRACE_INVISIBLE = 1 << 5, // Things bullets pass through that still block traces
+    CF_PLAYER_RESOURCE = 1 << 6,
+    CF_WORLD           = 1 << 7 // World, props, doors and other brush entities
+};
+
+struct class_entry
+{
+    EntityType type{ ENTITY_GENERIC };
+    uint16_t flags{ CF_NONE };
+};
+
+typedef std::array<class_entry, CLASS_TABLE_SIZE> class_table_t;
+
+// Game specific builds know every class id at compile time, universal builds fill the table at InitClassTable()
+#if GAME_SPECIFIC
+#define CLASS_TABLE_CONSTEXPR constexpr
+#else
+#define CLASS_TABLE_CONSTEXPR inline
+#endif
+
+CLASS_TABLE_CONSTEXPR void SetClassEntry(class_table_t &table, int classid, EntityType type, uint16_t flags)
+{
+    // Id 0 means "class does not exist in this game"
+    if (classid <= 0 || classid >= CLASS_TABLE_SIZE)
+        return;
+    table[classid].type  = type;
+    table[classid].flags = flags;
+}
+
+CLASS_TABLE_CONSTEXPR class_table_t BuildClassTable()
+{
+    class_table_t table{};
+
+    SetClassEntry(table, CL_CLASS(CTFPlayer), ENTITY_PLAYER, CF_NONE);
+
+    SetClassEntry(table, CL_CLASS(CTFGrenadePipebombProjectile), ENTITY_PROJECTILE, CF_PROJECTILE | CF_GRENADE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_Cleaver), ENTITY_PROJECTILE, CF_PROJECTILE | CF_GRENADE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_Jar), ENTITY_PROJECTILE, CF_PROJECTILE | CF_GRENADE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_JarMilk), ENTITY_PROJECTILE, CF_PROJECTILE | CF_GRENADE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_Arrow), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_EnergyBall), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_EnergyRing), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_GrapplingHook), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_HealingBolt), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_Rocket), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_SentryRocket), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_BallOfFire), ENTITY_PROJECTILE, CF_PROJECTILE);
+    SetClassEntry(table, CL_CLASS(CTFProjectile_Flare), ENTITY_PROJECTILE, CF_PROJECTILE);
+
+    SetClassEntry(table, CL_CLASS(CObjectTeleporter), ENTITY_BUILDING, CF_BUILDING);
+    SetClassEntry(table, CL_CLASS(CObjectSentrygun), ENTITY_BUILDING, CF_BUILDING);
+    SetClassEntry(table, CL_CLASS(CObjectDispenser), ENTITY_BUILDING, CF_BUILDING);
+
+    SetClassEntry(table, CL_CLASS(CZombie), ENTITY_NPC, CF_NPC);
+    SetClassEntry(table, CL_CLASS(CTFTankBoss), ENTITY_NPC, CF_NPC);
+    SetClassEntry(table, CL_CLASS(CMerasmus), ENTITY_NPC, CF_NPC);
+    SetClassEntry(table, CL_CLASS(CMerasmusDancer), ENTITY_NPC, CF_NPC);
+    SetClassEntry(table, CL_CLASS(CEyeballBoss), ENTITY_NPC, CF_NPC);
+    SetClassEntry(table, CL_CLASS(CHeadlessHatman), ENTITY_NPC, CF_NPC);
+
+    // Pickups stay generic entities, ItemManager still decides what they are
+    SetClassEntry(table, CL_CLASS(CCurrencyPack), ENTITY_GENERIC, CF_PICKUP);
+    SetClassEntry(table, CL_CLASS(CTFAmmoPack), ENTITY_GENERIC, CF_PICKUP);
+    SetClassEntry(table, CL_CLASS(CHalloweenPickup), ENTITY_GENERIC, CF_PICKUP);
+    SetClassEntry(table, CL_CLASS(CHalloweenGiftPickup), ENTITY_GENERIC, CF_PICKUP);
+    SetClassEntry(table, CL_CLASS(CBonusDuckPickup), ENTITY_GENERIC, CF_PICKUP);
+    SetClassEntry(table, CL_CLASS(CHalloweenSoulPack), ENTITY_GENERIC, CF_PICKUP);
+
+    SetClassEntry(table, CL_CLASS(CFuncRespawnRoomVisualizer), ENTITY_GENERIC, CF_TRACE_INVISIBLE);
+    SetClassEntry(table, CL_CLASS(CTFMedigunShield), ENTITY_GENERIC, CF_TRACE_INVISIBLE);
+    SetClassEntry(table, CL_CLASS(CFuncAreaPortalWindow), ENTITY_GENERIC, CF_TRACE_INVISIBLE);
+    SetClassEntry(table, CL_CLASS(CTFPlayerResource), ENTITY_GENERIC, CF_PLAYER_RESOURCE);
+    SetClassEntry(table, CL_CLASS(CWorld), ENTITY_GENERIC, CF_WORLD);
+    SetClassEntry(table, CL_CLASS(CPhysicsProp), ENTITY_GENERIC, CF_WORLD);
+    SetClassEntry(table, CL_CLASS(CDynamicProp), ENTITY_GENERIC, CF_WORLD);
+    SetClassEntry(table, CL_CLASS(CBaseDoor), ENTITY_GENERIC, CF_WORLD);
+    SetClassEntry(table, CL_CLASS(CBaseEntity), ENTITY_GENERIC, CF_WORLD);
+
+    return table;
+}
+
+#if GAME_SPECIFIC
+inline constexpr class_table_t class_table = BuildClassTable();
+#else
+extern class_table_t class_table;
+#endif
+
+inline const class_entry &GetClassEntry(int classid)
+{
+    static constexpr class_entry empty{};
+    if (classid <= 0 || classid >= CLASS_TABLE_SIZE)
+        return empty;
+    return class_table[classid];
+}
+} // namespace classinfo
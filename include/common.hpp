@@ -46,6 +46,9 @@
 #include <enums.hpp>
 #include "projlogging.hpp"
 #include "velocity.hpp"
+#include "projectiletracker.hpp"
+#include "spectators.hpp"
+#include "aimsolution.hpp"
 #include "globals.h"
 #include <helpers.hpp>
 #include "playerlist.hpp"
@@ -76,6 +79,7 @@
 #include <CNavFile.h>
 #include "HookTools.hpp"
 #include "bytepatch.hpp"
+#include "gameevents.hpp"
 
 #include "copypasted/Netvar.h"
 #include "copypasted/CSignature.h"
@@ -186,7 +186,7 @@ constexpr condition_data_s KCritBoostMask       = CreateConditionMask(TFCond_Kri
 // Compiler will optimize this to extremely small functions I guess.
 // These functions are never used with dynamic "cond" value anyways.
 
-template <condition cond> inline bool CondBitCheck(condition_data_s &data)
+template <condition cond> inline bool CondBitCheck(const condition_data_s &data)
 {
     if (cond >= 32 * 3)
     {
@@ -208,20 +208,55 @@ template <condition cond> inline bool CondBitCheck(condition_data_s &data)
 }
 
 // I haven't figured out how to pass a struct as a parameter, sorry.
-template <uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3> inline bool CondMaskCheck(condition_data_s &data)
+template <uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3> inline bool CondMaskCheck(const condition_data_s &data)
 {
     return (data.cond_0 & c0) || (data.cond_1 & c1) || (data.cond_2 & c2) || (data.cond_3 & c3);
 }
 
-template <uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3> inline bool HasConditionMask(CachedEntity *ent)
+// iCond with the TF2 condition list on top, read straight from the entity
+inline condition_data_s LiveConditions(CachedEntity *ent)
 {
-    IF_GAME(!IsTF()) return false;
+    condition_data_s data = CE_VAR(ent, netvar.iCond, condition_data_s);
     IF_GAME(IsTF2())
     {
-        if (CondMaskCheck<c0, c1, c2, c3>(CE_VAR(ent, netvar._condition_bits, condition_data_s)))
-            return true;
+        // The list only covers the first 96 conditions
+        const condition_data_s &list = CE_VAR(ent, netvar._condition_bits, condition_data_s);
+        data.cond_0 |= list.cond_0;
+        data.cond_1 |= list.cond_1;
+        data.cond_2 |= list.cond_2;
+    }
+    return data;
+}
+
+inline void SnapshotConditions(CachedEntity *ent)
+{
+    if (ent->m_IDX > 0 && ent->m_IDX < PLAYER_ARRAY_SIZE)
+    {
+        condition_data_s data = LiveConditions(ent);
+        uint32_t(&bits)[4]    = entity_cache::snapshot.conditions[ent->m_IDX];
+        bits[0]               = data.cond_0;
+        bits[1]               = data.cond_1;
+        bits[2]               = data.cond_2;
+        bits[3]               = data.cond_3;
     }
-    return CondMaskCheck<c0, c1, c2, c3>(CE_VAR(ent, netvar.iCond, condition_data_s));
+}
+
+// Same as LiveConditions, but from the entity snapshot for players inside CreateMove
+inline condition_data_s Conditions(CachedEntity *ent)
+{
+    int idx = ent->m_IDX;
+    if (idx > 0 && idx < PLAYER_ARRAY_SIZE && entity_cache::SnapshotValid(idx) && entity_cache::snapshot.type[idx] == ENTITY_PLAYER)
+    {
+        const uint32_t(&bits)[4] = entity_cache::snapshot.conditions[idx];
+        return condition_data_s{ bits[0], bits[1], bits[2], bits[3] };
+    }
+    return LiveConditions(ent);
+}
+
+template <uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3> inline bool HasConditionMask(CachedEntity *ent)
+{
+    IF_GAME(!IsTF()) return false;
+    return CondMaskCheck<c0, c1, c2, c3>(Conditions(ent));
 }
 
 template <condition cond, bool state> inline void CondBitSet(condition_data_s &data)
@@ -269,12 +304,7 @@ template <condition cond, bool state> inline void CondBitSet(condition_data_s &d
 template <condition cond> inline bool HasCondition(CachedEntity *ent)
 {
     IF_GAME(!IsTF()) return false;
-    IF_GAME(IsTF2() && cond < condition(96))
-    {
-        if (CondBitCheck<cond>(CE_VAR(ent, netvar._condition_bits, condition_data_s)))
-            return true;
-    }
-    return CondBitCheck<cond>(CE_VAR(ent, netvar.iCond, condition_data_s));
+    return CondBitCheck<cond>(Conditions(ent));
 }
 
 template <condition cond> inline void AddCondition(CachedEntity *ent)
@@ -285,6 +315,7 @@ template <condition cond> inline void AddCondition(CachedEntity *ent)
         CondBitSet<cond, true>(CE_VAR(ent, netvar._condition_bits, condition_data_s));
     }
     CondBitSet<cond, true>(CE_VAR(ent, netvar.iCond, condition_data_s));
+    SnapshotConditions(ent);
 }
 
 template <condition cond> inline void RemoveCondition(CachedEntity *ent)
@@ -295,4 +326,5 @@ template <condition cond> inline void RemoveCondition(CachedEntity *ent)
         CondBitSet<cond, false>(CE_VAR(ent, netvar._condition_bits, condition_data_s));
     }
     CondBitSet<cond, false>(CE_VAR(ent, netvar.iCond, condition_data_s));
+    SnapshotConditions(ent);
 }
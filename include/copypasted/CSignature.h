@@ -6,9 +6,31 @@
 #include <stdint.h>
 #include "sharedobj.hpp"
 #include <elf.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace CSignature_space
 {
+// A hex pattern like "8B 45 ? 89" parsed once into bytes and a mask, 0 in the mask for wildcards
+struct CompiledPattern
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint8_t> mask;
+    // First and last byte that isn't a wildcard, the scan compares these before anything else
+    uint32_t first{ 0 };
+    uint32_t last{ 0 };
+
+    explicit CompiledPattern(const char *pattern);
+    bool Matches(const uint8_t *at) const
+    {
+        for (uint32_t i = first; i <= last; i++)
+            if (mask[i] && at[i] != bytes[i])
+                return false;
+        return true;
+    }
+};
+
 struct SharedObjStorage
 {
     bool inited;
@@ -16,6 +38,11 @@ struct SharedObjStorage
     link_map *moduleMap;
     int textOffset;
     int textSize;
+    // Pattern string to rebased address, 0 if it isn't in the module
+    std::unordered_map<std::string, uintptr_t> found;
+    // resolve_cache::ModuleKey() of the file
+    std::string key;
+    std::string name;
     SharedObjStorage()
     {
     }
@@ -42,6 +69,10 @@ public:
     static uintptr_t dwFindPattern(uintptr_t dwAddress, uintptr_t dwLength, const char *szPattern);
     static void *GetModuleHandleSafe(const char *pszModuleName);
     static uintptr_t GetSignature(const char *chPattern, sharedobj::SharedObject &obj, int idx);
+    // Resolves all of them in a single pass over .text, Get*Signature calls with these patterns don't scan anymore afterwards
+    static void Prefetch(const std::vector<std::string> &patterns, sharedobj::SharedObject &obj, int idx);
+    // Hands everything resolved so far to resolve_cache, the next launch of the same build doesn't scan at all
+    static void StoreCache();
     static uintptr_t GetClientSignature(const char *chPattern);
     static uintptr_t GetEngineSignature(const char *chPattern);
     static uintptr_t GetLauncherSignature(const char *chaPattern);
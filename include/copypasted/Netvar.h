@@ -4,6 +4,8 @@
 //#include <cstring>
 #include <string.h>
 #include <memory>
+#include <string>
+#include <vector>
 #include "core/logging.hpp"
 
 // this and the cpp are creds to "Altimor"
@@ -52,13 +54,24 @@ class netvar_tree
     };
 
     map_type nodes;
+    // "DT_Table/m_Member/..." to offset, from resolve_cache or the lookups so far
+    std::unordered_map<std::string, int> resolved;
+    bool built{ false };
 
 public:
     // netvar_tree ( );
 
+    // Takes the offsets from resolve_cache if client.so is still the same build
     void init();
+    void store_cache();
+    // Offsets of every "DT_Table/m_Member/..." path, 0 for the ones that don't exist. Everything the cache doesn't have gets
+    // resolved in a single walk over the recv tables, without building the tree
+    std::vector<int> resolve_all(const std::vector<std::string> &paths);
 
 private:
+    struct walk_s;
+    void walk(RecvTable *recv_table, std::string &path, int base, walk_s &state);
+    void build();
     void populate_nodes(class RecvTable *recv_table, map_type *map);
 
     /**
@@ -123,6 +136,13 @@ public:
      */
     template <typename... args_t> int get_offset(const char *name, args_t... args)
     {
+        std::string path = name;
+        ((path += '/', path += args), ...);
+        auto cached = resolved.find(path);
+        if (cached != resolved.end())
+            return cached->second;
+        if (!built)
+            build();
         const auto &node = nodes[name];
         if (node == 0)
         {
@@ -130,11 +150,15 @@ public:
             return 0;
         }
         int offset = get_offset_recursive(node->nodes, node->offset, args...);
+        if (offset)
+            resolved[path] = offset;
         return offset;
     }
 
     template <typename... args_t> RecvProp *get_prop(const char *name, args_t... args)
     {
+        if (!built)
+            build();
         const auto &node = nodes[name];
         return get_prop_recursive(node->nodes, args...);
     }
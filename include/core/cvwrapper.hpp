@@ -13,6 +13,7 @@ class ConVar;
 #include <core/interfaces.hpp>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 
@@ -37,3 +38,7 @@ public:
 std::vector<CatCommand *> &commandRegistrationArray();
 
 void RegisterCatCommands();
+
+// Runs the commands in line right away if every one of them is ours, looked up in a perfect hash over the registered names.
+// False if any of them isn't, the whole line has to go through the engine then so the order stays the same
+bool DispatchCatCommands(std::string_view line);
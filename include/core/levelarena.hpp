@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory_resource>
+
+/*
+ * Pooled memory for data that only lives as long as the current level. Containers get their memory
+ * in large chunks instead of one heap block each, and on LevelShutdown every registered container is
+ * emptied and all chunks are handed back at once.
+ */
+
+namespace level_arena
+{
+// Thread safe, the nav loader fills its containers on the job pool
+std::pmr::memory_resource *resource();
+
+void Track(void *owner, void (*reset)(void *));
+void Untrack(void *owner);
+// Empties every tracked container, then frees the pool. Runs last on LevelShutdown
+void Release();
+
+// A container that allocates from the level arena and is empty again once the level ends.
+// Anything still holding iterators or pointers into it after LevelShutdown dangles, same as with clear()
+template <typename T> class level : public T
+{
+public:
+    level() : T(resource())
+    {
+        Track(this, [](void *owner) { static_cast<T &>(*static_cast<level *>(owner)) = T(resource()); });
+    }
+    ~level()
+    {
+        Untrack(this);
+    }
+    level(const level &) = delete;
+    level &operator=(const level &) = delete;
+    // Polymorphic allocators don't propagate on assignment, whatever gets assigned lands in the arena
+    using T::operator=;
+};
+} // namespace level_arena
@@ -8,14 +8,13 @@
 #pragma once
 
 #include <stdio.h>
-#include <fstream>
 
 namespace logging
 {
-extern std::ofstream handle;
-
 void Initialize();
 void Shutdown();
+// Synchronously writes everything still queued, safe to call from the crash handler
+void Flush();
 void Info(const char *fmt, ...);
 void File(const char *fmt, ...);
 } // namespace logging
@@ -57,6 +57,19 @@ public:
     // round timer
     offset_t m_nSetupTimeLength;
     offset_t m_nState;
+    offset_t m_flTimerEndTime;
+    offset_t m_bTimerPaused;
+    offset_t m_flTimeRemaining; // only while paused
+
+    // objective resource, arrays of MAX_CONTROL_POINTS unless noted
+    offset_t cp_iTimerToShowInHUD;
+    offset_t cp_iNumControlPoints;
+    offset_t cp_vCPPositions;
+    offset_t cp_bCPLocked;
+    offset_t cp_bTeamCanCap;     // point + team * MAX_CONTROL_POINTS
+    offset_t cp_iPreviousPoints; // 3 per point and team, point * 3 + team * MAX_CONTROL_POINTS * 3
+    offset_t cp_iCappingTeam;
+    offset_t cp_iOwner;
 
     offset_t iLifeState;
     offset_t iCond;
@@ -75,6 +88,7 @@ public:
     offset_t m_hBuilder;
     offset_t m_bCanPlace;
     offset_t m_iObjectType;
+    offset_t m_iObjectMode; // teleporters, 0 entrance 1 exit
     offset_t m_bMiniBuilding;
     offset_t m_bHasSapper;
     offset_t m_bPlacing;
@@ -98,6 +112,7 @@ public:
     offset_t vVelocity;
     offset_t bGlowEnabled;
     offset_t movetype;
+    offset_t m_fEffects;
     offset_t iGlowIndex;
     offset_t iReloadMode;
     offset_t res_iMaxHealth;
@@ -167,7 +182,11 @@ public:
     offset_t m_hHealingTarget;
     offset_t m_flChargeLevel;
 
+    // Not networked, see class_dumping/netvars.json
     offset_t m_rgflCoordinateFrame;
+    offset_t m_vecAbsOrigin;
+    offset_t m_pCurrentCommand;
+    offset_t m_nCachedBones;
     offset_t m_bFeignDeathReady;
     offset_t m_bCarryingObject;
     offset_t m_hCarriedObject;
@@ -177,6 +196,7 @@ public:
     offset_t m_bViewingCYOAPDA;
     offset_t m_angEyeAnglesLocal;
     offset_t m_nSequence;
+    offset_t m_flModelScale;
     offset_t m_flSimulationTime;
     offset_t m_flAnimTime;
     offset_t m_angRotation;
@@ -0,0 +1,158 @@
+/*
+	AUTO-GENERATED HEADER - DO NOT MODIFY
+	NETVAR SCHEMA, EDIT class_dumping/netvars.json INSTEAD
+*/
+
+#ifndef NETVARSCHEMA_AUTOGEN_HPP
+#define NETVARSCHEMA_AUTOGEN_HPP
+
+// NETVAR(member, game, path) for networked props, FIXED(member, game, offset) for fields that aren't networked
+#define NETVAR_SCHEMA(NETVAR, FIXED) \
+	NETVAR(iFlags, all, "DT_BasePlayer/m_fFlags") \
+	NETVAR(iHealth, all, "DT_BasePlayer/m_iHealth") \
+	NETVAR(iLifeState, all, "DT_BasePlayer/m_lifeState") \
+	NETVAR(iTeamNum, all, "DT_BaseEntity/m_iTeamNum") \
+	NETVAR(vViewOffset, all, "DT_BasePlayer/localdata/m_vecViewOffset[0]") \
+	NETVAR(hActiveWeapon, all, "DT_BaseCombatCharacter/m_hActiveWeapon") \
+	NETVAR(hMyWeapons, all, "DT_BaseCombatCharacter/m_hMyWeapons") \
+	NETVAR(iHitboxSet, all, "DT_BaseAnimating/m_nHitboxSet") \
+	NETVAR(vVelocity, all, "DT_BasePlayer/localdata/m_vecVelocity[0]") \
+	NETVAR(movetype, all, "DT_BaseEntity/movetype") \
+	NETVAR(m_fEffects, all, "DT_BaseEntity/m_fEffects") \
+	NETVAR(m_iAmmo, all, "DT_BasePlayer/localdata/m_iAmmo") \
+	NETVAR(m_iPrimaryAmmoType, all, "DT_BaseCombatWeapon/LocalWeaponData/m_iPrimaryAmmoType") \
+	NETVAR(m_iSecondaryAmmoType, all, "DT_BaseCombatWeapon/LocalWeaponData/m_iSecondaryAmmoType") \
+	NETVAR(m_iClip1, all, "DT_BaseCombatWeapon/LocalWeaponData/m_iClip1") \
+	NETVAR(m_iClip2, all, "DT_BaseCombatWeapon/LocalWeaponData/m_iClip2") \
+	NETVAR(m_Collision, all, "DT_BaseEntity/m_Collision") \
+	NETVAR(m_flSimulationTime, all, "DT_BaseEntity/m_flSimulationTime") \
+	NETVAR(m_flAnimTime, all, "DT_BaseEntity/AnimTimeMustBeFirst/m_flAnimTime") \
+	NETVAR(m_angRotation, all, "DT_BaseEntity/m_angRotation") \
+	NETVAR(res_iTeam, tf2, "DT_TFPlayerResource/baseclass/m_iTeam") \
+	NETVAR(res_bAlive, tf2, "DT_TFPlayerResource/baseclass/m_bAlive") \
+	NETVAR(res_iMaxBuffedHealth, tf2, "DT_TFPlayerResource/m_iMaxBuffedHealth") \
+	NETVAR(m_angEyeAngles, tf2, "DT_TFPlayer/tfnonlocaldata/m_angEyeAngles[0]") \
+	NETVAR(m_angEyeAnglesLocal, tf2, "DT_TFPlayer/tflocaldata/m_angEyeAngles[0]") \
+	NETVAR(bGlowEnabled, tf2, "DT_TFPlayer/m_bGlowEnabled") \
+	NETVAR(iItemDefinitionIndex, tf2, "DT_EconEntity/m_AttributeManager/m_Item/m_iItemDefinitionIndex") \
+	NETVAR(AttributeList, tf2, "DT_EconEntity/m_AttributeManager/m_Item/m_AttributeList") \
+	NETVAR(flChargeBeginTime, tf2, "DT_WeaponPipebombLauncher/PipebombLauncherLocalData/m_flChargeBeginTime") \
+	NETVAR(flLastFireTime, tf2, "DT_TFWeaponBase/LocalActiveTFWeaponData/m_flLastFireTime") \
+	NETVAR(flObservedCritChance, tf2, "DT_TFWeaponBase/LocalActiveTFWeaponData/m_flObservedCritChance") \
+	NETVAR(bDistributed, tf2, "DT_CurrencyPack/m_bDistributed") \
+	NETVAR(_condition_bits, tf2, "DT_TFPlayer/m_Shared/m_ConditionList/_condition_bits") \
+	NETVAR(m_flStealthNoAttackExpire, tf2, "DT_TFPlayer/m_Shared/tfsharedlocaldata/m_flStealthNoAttackExpire") \
+	NETVAR(m_iCrits, tf2, "DT_TFPlayer/m_Shared/tfsharedlocaldata/m_RoundScoreData/m_iCrits") \
+	NETVAR(m_nChargeResistType, tf2, "DT_WeaponMedigun/m_nChargeResistType") \
+	NETVAR(m_hHealingTarget, tf2, "DT_WeaponMedigun/m_hHealingTarget") \
+	NETVAR(m_flChargeLevel, tf2, "DT_WeaponMedigun/NonLocalTFWeaponMedigunData/m_flChargeLevel") \
+	NETVAR(m_bFeignDeathReady, tf2, "DT_TFPlayer/m_Shared/m_bFeignDeathReady") \
+	NETVAR(m_bCarryingObject, tf2, "DT_TFPlayer/m_Shared/m_bCarryingObject") \
+	NETVAR(m_hCarriedObject, tf2, "DT_TFPlayer/m_Shared/m_hCarriedObject") \
+	NETVAR(m_nSequence, tf2, "DT_BaseAnimating/m_nSequence") \
+	NETVAR(m_flModelScale, tf2, "DT_BaseAnimating/m_flModelScale") \
+	NETVAR(m_iTauntIndex, tf2, "DT_TFPlayer/m_Shared/m_iTauntIndex") \
+	NETVAR(m_iTauntConcept, tf2, "DT_TFPlayer/m_Shared/m_iTauntConcept") \
+	NETVAR(m_bViewingCYOAPDA, tf2, "DT_TFPlayer/m_bViewingCYOAPDA") \
+	NETVAR(res_iScore, all, "DT_TFPlayerResource/baseclass/m_iScore") \
+	NETVAR(m_hOwnerEntity, tf, "DT_BaseEntity/m_hOwnerEntity") \
+	NETVAR(res_iMaxHealth, tf, "DT_TFPlayerResource/m_iMaxHealth") \
+	NETVAR(res_iPlayerClass, tf, "DT_TFPlayerResource/m_iPlayerClass") \
+	NETVAR(m_bReadyToBackstab, tf, "DT_TFWeaponKnife/m_bReadyToBackstab") \
+	NETVAR(m_bDucked, tf, "DT_TFPlayer/localdata/m_Local/m_bDucked") \
+	NETVAR(m_flDuckTimer, tf, "DT_TFPlayer/m_Shared/m_flDuckTimer") \
+	NETVAR(iCond, tf, "DT_TFPlayer/m_Shared/m_nPlayerCond") \
+	NETVAR(iCond1, tf, "DT_TFPlayer/m_Shared/m_nPlayerCondEx") \
+	NETVAR(iCond2, tf, "DT_TFPlayer/m_Shared/m_nPlayerCondEx2") \
+	NETVAR(iCond3, tf, "DT_TFPlayer/m_Shared/m_nPlayerCondEx3") \
+	NETVAR(iClass, tf, "DT_TFPlayer/m_PlayerClass/m_iClass") \
+	NETVAR(flChargedDamage, tf, "DT_TFSniperRifle/SniperRifleLocalData/m_flChargedDamage") \
+	NETVAR(m_iAmmoShells, tf, "DT_ObjectSentrygun/m_iAmmoShells") \
+	NETVAR(m_iAmmoRockets, tf, "DT_ObjectSentrygun/m_iAmmoRockets") \
+	NETVAR(m_iSentryState, tf, "DT_ObjectSentrygun/m_iState") \
+	NETVAR(m_iAmmoMetal, tf, "DT_ObjectDispenser/m_iAmmoMetal") \
+	NETVAR(m_nSetupTimeLength, tf, "DT_TeamRoundTimer/m_nSetupTimeLength") \
+	NETVAR(m_nState, tf, "DT_TeamRoundTimer/m_nState") \
+	NETVAR(m_flTimerEndTime, tf, "DT_TeamRoundTimer/m_flTimerEndTime") \
+	NETVAR(m_bTimerPaused, tf, "DT_TeamRoundTimer/m_bTimerPaused") \
+	NETVAR(m_flTimeRemaining, tf, "DT_TeamRoundTimer/m_flTimeRemaining") \
+	NETVAR(cp_iTimerToShowInHUD, tf, "DT_BaseTeamObjectiveResource/m_iTimerToShowInHUD") \
+	NETVAR(cp_iNumControlPoints, tf, "DT_BaseTeamObjectiveResource/m_iNumControlPoints") \
+	NETVAR(cp_vCPPositions, tf, "DT_BaseTeamObjectiveResource/m_vCPPositions[0]") \
+	NETVAR(cp_bCPLocked, tf, "DT_BaseTeamObjectiveResource/m_bCPLocked") \
+	NETVAR(cp_bTeamCanCap, tf, "DT_BaseTeamObjectiveResource/m_bTeamCanCap") \
+	NETVAR(cp_iPreviousPoints, tf, "DT_BaseTeamObjectiveResource/m_iPreviousPoints") \
+	NETVAR(cp_iCappingTeam, tf, "DT_BaseTeamObjectiveResource/m_iCappingTeam") \
+	NETVAR(cp_iOwner, tf, "DT_BaseTeamObjectiveResource/m_iOwner") \
+	NETVAR(m_iUpgradeMetal, tf, "DT_BaseObject/m_iUpgradeMetal") \
+	NETVAR(m_flPercentageConstructed, tf, "DT_BaseObject/m_flPercentageConstructed") \
+	NETVAR(iUpgradeLevel, tf, "DT_BaseObject/m_iUpgradeLevel") \
+	NETVAR(m_hBuilder, tf, "DT_BaseObject/m_hBuilder") \
+	NETVAR(m_bCanPlace, tf, "DT_BaseObject/m_bServerOverridePlacement") \
+	NETVAR(m_bBuilding, tf, "DT_BaseObject/m_bBuilding") \
+	NETVAR(m_iObjectType, tf, "DT_BaseObject/m_iObjectType") \
+	NETVAR(m_iObjectMode, tf, "DT_BaseObject/m_iObjectMode") \
+	NETVAR(m_bHasSapper, tf, "DT_BaseObject/m_bHasSapper") \
+	NETVAR(m_bPlacing, tf, "DT_BaseObject/m_bPlacing") \
+	NETVAR(m_bMiniBuilding, tf, "DT_BaseObject/m_bMiniBuilding") \
+	NETVAR(m_iTeleState, tf, "DT_ObjectTeleporter/m_iState") \
+	NETVAR(m_flTeleRechargeTime, tf, "DT_ObjectTeleporter/m_flRechargeTime") \
+	NETVAR(m_flTeleCurrentRechargeDuration, tf, "DT_ObjectTeleporter/m_flCurrentRechargeDuration") \
+	NETVAR(m_iTeleTimesUsed, tf, "DT_ObjectTeleporter/m_iTimesUsed") \
+	NETVAR(m_flTeleYawToExit, tf, "DT_ObjectTeleporter/m_flYawToExit") \
+	NETVAR(m_bMatchBuilding, tf, "DT_ObjectTeleporter/m_bMatchBuilding") \
+	NETVAR(m_DmgRadius, tf, "DT_BaseGrenade/m_DmgRadius") \
+	NETVAR(iPipeType, tf, "DT_TFProjectile_Pipebomb/m_iType") \
+	NETVAR(iBuildingHealth, tf, "DT_BaseObject/m_iHealth") \
+	NETVAR(iBuildingMaxHealth, tf, "DT_BaseObject/m_iMaxHealth") \
+	NETVAR(iReloadMode, tf, "DT_TFWeaponBase/m_iReloadMode") \
+	NETVAR(Rocket_iDeflected, tf, "DT_TFBaseRocket/m_iDeflected") \
+	NETVAR(Grenade_iDeflected, tf, "DT_TFWeaponBaseGrenadeProj/m_iDeflected") \
+	NETVAR(nForceTauntCam, tf, "DT_TFPlayer/m_nForceTauntCam") \
+	NETVAR(Rocket_bCritical, tf, "DT_TFProjectile_Rocket/m_bCritical") \
+	NETVAR(Grenade_bCritical, tf, "DT_TFWeaponBaseGrenadeProj/m_bCritical") \
+	NETVAR(angEyeAngles, tf, "DT_TFPlayer/tfnonlocaldata/m_angEyeAngles[0]") \
+	NETVAR(iWeaponState, tf, "DT_WeaponMinigun/m_iWeaponState") \
+	NETVAR(flChargeLevel, tf, "DT_WeaponMedigun/NonLocalTFWeaponMedigunData/m_flChargeLevel") \
+	NETVAR(bChargeRelease, tf, "DT_WeaponMedigun/m_bChargeRelease") \
+	NETVAR(m_nStreaks_Player, tf, "DT_TFPlayer/m_Shared/m_nStreaks") \
+	NETVAR(m_nStreaks_Resource, tf, "DT_TFPlayerResource/m_iStreaks") \
+	NETVAR(m_iKills_Resource, tf, "DT_TFPlayerResource/baseclass/m_iScore") \
+	NETVAR(m_iPing_Resource, tf, "DT_TFPlayerResource/baseclass/m_iPing") \
+	NETVAR(m_iDeaths_Resource, tf, "DT_TFPlayerResource/baseclass/m_iDeaths") \
+	NETVAR(m_iHealth_Resource, tf, "DT_TFPlayerResource/baseclass/m_iHealth") \
+	NETVAR(m_iTotalScore_Resource, tf, "DT_TFPlayerResource/m_iTotalScore") \
+	NETVAR(m_iMaxHealth_Resource, tf, "DT_TFPlayerResource/m_iMaxHealth") \
+	NETVAR(m_iMaxBuffedHealth_Resource, tf, "DT_TFPlayerResource/m_iMaxBuffedHealth") \
+	NETVAR(m_iPlayerClass_Resource, tf, "DT_TFPlayerResource/m_iPlayerClass") \
+	NETVAR(m_iActiveDominations_Resource, tf, "DT_TFPlayerResource/m_iActiveDominations") \
+	NETVAR(m_flNextRespawnTime_Resource, tf, "DT_TFPlayerResource/m_flNextRespawnTime") \
+	NETVAR(m_iDamage_Resource, tf, "DT_TFPlayerResource/m_iDamage") \
+	NETVAR(m_iDamageAssist_Resource, tf, "DT_TFPlayerResource/m_iDamageAssist") \
+	NETVAR(m_iHealing_Resource, tf, "DT_TFPlayerResource/m_iHealing") \
+	NETVAR(m_iHealingAssist_Resource, tf, "DT_TFPlayerResource/m_iHealingAssist") \
+	NETVAR(m_iPlayerLevel_Resource, tf, "DT_TFPlayerResource/m_iPlayerLevel") \
+	NETVAR(m_iPlayerIndex, tf, "DT_TFRagdoll/m_iPlayerIndex") \
+	NETVAR(m_hTargetPlayer, tf, "DT_CHalloweenGiftPickup/m_hTargetPlayer") \
+	NETVAR(iCritMult, tf2c, "DT_TFPlayer/m_Shared/m_iCritMult") \
+	NETVAR(bRespawning, tf2c, "DT_WeaponSpawner/m_bRespawning") \
+	NETVAR(flNextAttack, all, "DT_BaseCombatCharacter/bcc_localdata/m_flNextAttack") \
+	NETVAR(flNextPrimaryAttack, all, "DT_BaseCombatWeapon/LocalActiveWeaponData/m_flNextPrimaryAttack") \
+	NETVAR(flNextSecondaryAttack, all, "DT_BaseCombatWeapon/LocalActiveWeaponData/m_flNextSecondaryAttack") \
+	NETVAR(iNextThinkTick, all, "DT_BaseCombatWeapon/LocalActiveWeaponData/m_nNextThinkTick") \
+	NETVAR(nTickBase, all, "DT_BasePlayer/localdata/m_nTickBase") \
+	NETVAR(vecPunchAngle, all, "DT_BasePlayer/localdata/m_Local/m_vecPunchAngle") \
+	NETVAR(vecPunchAngleVel, all, "DT_BasePlayer/localdata/m_Local/m_vecPunchAngleVel") \
+	NETVAR(hThrower, all, "DT_BaseGrenade/m_hThrower") \
+	NETVAR(iObserverMode, all, "DT_BasePlayer/m_iObserverMode") \
+	NETVAR(hObserverTarget, all, "DT_BasePlayer/m_hObserverTarget") \
+	NETVAR(deadflag, all, "DT_BasePlayer/pl/deadflag") \
+	NETVAR(iFOV, all, "DT_BasePlayer/m_iFOV") \
+	NETVAR(iDefaultFOV, all, "DT_BasePlayer/m_iDefaultFOV") \
+	NETVAR(hOwner, all, "DT_BaseCombatWeapon/m_hOwner") \
+	/* matrix3x4_t of the entity, C_BaseEntity */ FIXED(m_rgflCoordinateFrame, all, 0x324) \
+	/* Right behind m_rgflCoordinateFrame, engine prediction restores it */ FIXED(m_vecAbsOrigin, all, 0x354) \
+	/* CUserCmd the player is running, C_BasePlayer */ FIXED(m_pCurrentCommand, all, 4188) \
+	/* Bone count of the last SetupBones, C_BaseAnimating */ FIXED(m_nCachedBones, all, 0x844) \
+
+#endif /* NETVARSCHEMA_AUTOGEN_HPP */
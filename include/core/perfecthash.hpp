@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+ * Name to value table without collisions, rebuilt whenever the names change.
+ * Names get spread over buckets first and every bucket gets its own seed that puts its names into free slots (hash and displace),
+ * so a lookup is two hashes and a single name compare however many names there are.
+ */
+
+template <typename T> class perfect_hash
+{
+public:
+    // Keys have to outlive the table. For duplicate names the first one wins, like it would in a map
+    void Build(std::vector<std::pair<std::string_view, T>> entries)
+    {
+        this->entries = std::move(entries);
+        size_t buckets = 1;
+        while (buckets * 2 < this->entries.size())
+            buckets *= 2;
+        size_t size = 8;
+        while (size < this->entries.size() + this->entries.size() / 4)
+            size *= 2;
+        while (!TryBuild(buckets, size))
+            size *= 2;
+    }
+
+    const T *Find(std::string_view name) const
+    {
+        if (slots.empty())
+            return nullptr;
+        uint32_t seed = seeds[Hash(name, 0) & (seeds.size() - 1)];
+        int32_t index = slots[Hash(name, seed) & (slots.size() - 1)];
+        if (index < 0 || entries[index].first != name)
+            return nullptr;
+        return &entries[index].second;
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+private:
+    static uint32_t Hash(std::string_view name, uint32_t seed)
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (char c : name)
+            hash = (hash ^ uint8_t(c)) * 16777619u;
+        return hash ^ (hash >> 15);
+    }
+
+    bool TryBuild(size_t bucket_count, size_t size)
+    {
+        std::vector<std::vector<int32_t>> buckets(bucket_count);
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            auto &bucket = buckets[Hash(entries[i].first, 0) & (bucket_count - 1)];
+            bool duplicate = std::any_of(bucket.begin(), bucket.end(), [&](int32_t other) { return entries[other].first == entries[i].first; });
+            if (!duplicate)
+                bucket.push_back(int32_t(i));
+        }
+        std::vector<size_t> order(bucket_count);
+        for (size_t i = 0; i < bucket_count; i++)
+            order[i] = i;
+        // Biggest buckets first while there is still room
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        slots.assign(size, -1);
+        seeds.assign(bucket_count, 0);
+        std::vector<size_t> taken;
+        for (size_t bucket : order)
+        {
+            if (buckets[bucket].empty())
+                break;
+            uint32_t seed = 1;
+            for (; seed < 4096; seed++)
+            {
+                taken.clear();
+                for (int32_t index : buckets[bucket])
+                {
+                    size_t slot = Hash(entries[index].first, seed) & (size - 1);
+                    if (slots[slot] >= 0 || std::find(taken.begin(), taken.end(), slot) != taken.end())
+                        break;
+                    taken.push_back(slot);
+                }
+                if (taken.size() == buckets[bucket].size())
+                    break;
+            }
+            if (seed == 4096)
+                return false;
+            seeds[bucket] = seed;
+            for (size_t i = 0; i < taken.size(); i++)
+                slots[taken[i]] = buckets[bucket][i];
+        }
+        return true;
+    }
+
+    std::vector<std::pair<std::string_view, T>> entries;
+    std::vector<uint32_t> seeds;
+    std::vector<int32_t> slots;
+};
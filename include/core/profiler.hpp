@@ -7,37 +7,165 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include <vector>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 #include "config.h"
 
 class ProfilerNode;
 
+namespace profiler
+{
+// Raw timestamps, convert with NsPerTick()
+inline uint64_t Now()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+// Calibrated against steady_clock once enough time has passed since injection
+double NsPerTick();
+// Marks the start of a new frame for profiler_capture
+void FrameMark();
+
+// Totals since the last spew, in ns
+struct section_stats_s
+{
+    std::string name;
+    std::string parent;
+    unsigned calls;
+    uint64_t sum_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+};
+// Every section that was measured at least once, doesn't reset anything
+void CollectSections(std::vector<section_stats_s> &out);
+
+// Nodes are only measured when (random & sample_mask) == 0, so 0 measures everything.
+// Set from debug.profiler.sample-rate, cleared while profiler_capture runs
+extern unsigned sample_mask;
+inline bool ShouldSample()
+{
+    if (!sample_mask)
+        return true;
+    // xorshift32, a plain counter would alias with loops that hit sections in a fixed pattern
+    static thread_local uint32_t state = 2463534242u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return !(state & sample_mask);
+}
+} // namespace profiler
+
 class ProfilerSection
 {
 public:
     ProfilerSection(std::string name, ProfilerSection *parent = nullptr);
+    ~ProfilerSection();
 
-    void OnNodeDeath(ProfilerNode &node);
+    void OnNodeDeath(ProfilerNode &node, uint64_t end);
+    // For spans measured some other way, GPU time for example. Both in profiler::Now() ticks
+    void Add(uint64_t start, uint64_t end);
 
-    std::chrono::nanoseconds m_min;
-    std::chrono::nanoseconds m_max;
-    std::chrono::nanoseconds m_sum;
-    unsigned m_spewcount;
-    unsigned m_calls;
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_log;
+    // Toggled at runtime with profiler_enable
+    bool m_enabled{ true };
+    // All in profiler::Now() ticks, sections can be entered from several threads
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<unsigned> m_spewcount;
+    std::atomic<unsigned> m_calls;
     std::string m_name;
+    // First section this one was entered from, used to indent the spew
     ProfilerSection *m_parent;
+
+private:
+    void Spew();
 };
 
+// The checks are inline, so skipped and disabled sections cost a branch instead of a call
 class ProfilerNode
 {
 public:
-    ProfilerNode(ProfilerSection &section);
-    ~ProfilerNode();
+    ProfilerNode(ProfilerSection &section) : m_section(section)
+    {
+        m_active = section.m_enabled && profiler::ShouldSample();
+        if (m_active)
+            Begin();
+    }
+    ~ProfilerNode()
+    {
+        if (m_active)
+            End();
+    }
 
-    std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
+    uint64_t m_start;
     ProfilerSection &m_section;
+    // Enclosing measured node on this thread
+    ProfilerNode *m_outer;
+    bool m_active;
+
+private:
+    void Begin();
+    void End();
+};
+
+// Hit/miss statistics for caches, spewed together with the sections
+class ProfilerCounter
+{
+public:
+    ProfilerCounter(std::string name);
+
+    void Hit();
+    void Miss();
+
+    unsigned m_hits;
+    unsigned m_misses;
+    unsigned m_spewcount;
+    std::string m_name;
+
+private:
+    void Spew();
+};
+
+// Log-linear latency histogram, 4 steps per power of two so percentiles stay within 25%
+class ProfilerHistogram
+{
+public:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int BUCKETS     = 42 * SUB_BUCKETS;
+
+    void Record(uint64_t ns)
+    {
+        counts[Bucket(ns)]++;
+        // Halve everything once in a while, so old samples fade out instead of piling up
+        if (++total >= 8192)
+            Decay();
+    }
+    // Upper bound in ns of the bucket holding the p-th fraction of samples
+    uint64_t Percentile(float p) const;
+    void Reset();
+
+    unsigned counts[BUCKETS]{};
+    unsigned total{ 0 };
+
+private:
+    static int Bucket(uint64_t ns)
+    {
+        if (ns < SUB_BUCKETS)
+            return int(ns);
+        int msb = 63 - __builtin_clzll(ns);
+        int idx = (msb - 1) * SUB_BUCKETS + int((ns >> (msb - 2)) & (SUB_BUCKETS - 1));
+        return idx < BUCKETS ? idx : BUCKETS - 1;
+    }
+    void Decay();
 };
 
 #if ENABLE_PROFILER
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Signature addresses and netvar offsets from the last launch, kept in the data directory.
+ * Every section belongs to one module and is only used while that module is still the same build,
+ * after a game update everything in it gets resolved again.
+ */
+
+namespace resolve_cache
+{
+// Pattern or netvar path to its value. Signatures are stored relative to the module base
+typedef std::unordered_map<std::string, uintptr_t> entries_t;
+
+// ELF build id of the file, its size and mtime if it has none. Empty if the file can't be read
+std::string ModuleKey(const std::string &path);
+// False unless section was written for the same key
+bool Get(const std::string &section, const std::string &key, entries_t &out);
+// Whatever is stored for section regardless of key, the names are still worth resolving again after an update
+bool GetAny(const std::string &section, entries_t &out);
+void Put(const std::string &section, const std::string &key, const entries_t &entries);
+// Writes the file if anything was put since it was read
+void Save();
+} // namespace resolve_cache
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <mathlib/vector.h>
+
+class CNavArea;
+
+// One position per player each tick, live when we can see them and estimated from sounds and their last velocity when dormant
+namespace dormant
+{
+enum source_e : uint8_t
+{
+    // Nothing recent enough, origin isn't valid
+    UNKNOWN = 0,
+    LIVE,
+    // A sound was the last fix
+    HEARD,
+    // Going on from the last fix with the velocity they had
+    PREDICTED
+};
+
+struct estimate_s
+{
+    source_e source{ UNKNOWN };
+    Vector origin{};
+    // 1 while live, falls to 0 as the last fix gets older
+    float confidence{ 0.0f };
+    // Seconds since the last fix
+    float age{ 0.0f };
+
+    // Last fix, and the area it was on if the nav mesh is loaded
+    Vector anchor{};
+    Vector velocity{};
+    float anchor_time{ 0.0f };
+    bool heard{ false };
+    // soundcache stamp of the sound the last fix came from
+    int64_t sound_stamp{ 0 };
+    CNavArea *area{ nullptr };
+    unsigned long tick{ 0 };
+
+    bool Valid() const
+    {
+        return source != UNKNOWN;
+    }
+};
+
+// Call once per tick after velocity::Update
+void Update();
+// nullptr for anything that isn't a player slot, check Valid() on the rest
+const estimate_s *Get(int idx);
+} // namespace dormant
@@ -21,12 +21,14 @@
 #include "playerresource.h"
 #include "globals.h"
 #include "classinfo/classinfo.hpp"
+#include "classinfo/classtable.hpp"
 #include "client_class.h"
 #include "Constants.hpp"
 
 struct matrix3x4_t;
 
 class IClientEntity;
+class CNavArea;
 struct player_info_s;
 struct model_t;
 struct mstudiohitboxset_t;
@@ -35,6 +37,10 @@ struct mstudiobbox_t;
 constexpr int MAX_STRINGS = 16;
 
 #define PROXY_ENTITY true
+// Resolve IClientEntity * once per tick in entity_cache::Update() instead of on every RAW_ENT
+#define CACHE_RAW_ENTITY true
+// Check every cached pointer against the entity list, very slow
+#define VALIDATE_RAW_ENTITY false
 
 #if PROXY_ENTITY == true
 #define RAW_ENT(ce) ce->InternalEntity()
@@ -59,9 +65,56 @@ constexpr int MAX_STRINGS = 16;
 
 #define HIGHEST_ENTITY (entity_cache::max)
 #define ENTITY(idx) (&entity_cache::Get(idx))
+// Only for indices that are already known to be in range, e.g. loops bounded by HIGHEST_ENTITY
+#define ENTITY_UNCHECKED(idx) (&entity_cache::UncheckedGet(idx))
 
 bool IsProjectileACrit(CachedEntity *ent);
-class CachedEntity
+
+namespace playerlist
+{
+struct userdata;
+}
+
+namespace entity_cache
+{
+// Packed per-tick copy of the fields everything reads all the time, filled once by entity_cache::Update()
+struct snapshot_s
+{
+    unsigned long tick[MAX_ENTITIES];
+    int class_id[MAX_ENTITIES];
+    EntityType type[MAX_ENTITIES];
+    int team[MAX_ENTITIES];
+    int health[MAX_ENTITIES];
+    Vector origin[MAX_ENTITIES];
+    bool alive[MAX_ENTITIES];
+    bool dormant[MAX_ENTITIES];
+    // ITEM_NONE for everything but generic entities
+    k_EItemType item_type[MAX_ENTITIES];
+    // Players only, every condition bit with the TF2 condition list merged in, see Conditions()
+    uint32_t conditions[PLAYER_ARRAY_SIZE][4];
+    // Players only, tf_class, 0 outside of TF
+    int player_class[PLAYER_ARRAY_SIZE];
+    // Derived from the local player, which updates after the entity cache, so these get memoized on first use
+    unsigned long distance_tick[MAX_ENTITIES];
+    float distance[MAX_ENTITIES];
+};
+extern snapshot_s snapshot;
+
+// Rarely touched per-entity data, kept out of CachedEntity so the hot fields of neighbouring entities share cache lines
+struct cold_data_s
+{
+    player_info_s player_info{};
+};
+extern cold_data_s cold_array[MAX_ENTITIES];
+
+// Outside of CreateMove entities get interpolated every frame, so only trust the snapshot in there
+inline bool SnapshotValid(int idx)
+{
+    return g_Settings.is_create_move && snapshot.tick[idx] == tickcount;
+}
+} // namespace entity_cache
+
+class alignas(64) CachedEntity
 {
 public:
     typedef CachedEntity ThisClass;
@@ -73,30 +126,62 @@ public:
     void Reset();
     __attribute__((always_inline, hot, const)) IClientEntity *InternalEntity() const
     {
+#if CACHE_RAW_ENTITY == true
+        // Entities only get created/deleted while packets are processed, so the pointer is stable for the rest of CreateMove
+        if (g_Settings.is_create_move && raw_entity_tick == tickcount)
+        {
+#if VALIDATE_RAW_ENTITY == true
+            ValidateRawEntity();
+#endif
+            return raw_entity;
+        }
+#endif
         return g_IEntityList->GetClientEntity(m_IDX);
     }
     __attribute__((always_inline, hot, const)) inline bool Good() const
     {
-        if (!RAW_ENT(this) || !RAW_ENT(this)->GetClientClass()->m_ClassID)
-            return false;
         IClientEntity *const entity = InternalEntity();
-        return entity && !entity->IsDormant();
+        if (!entity || !entity->GetClientClass()->m_ClassID)
+            return false;
+        return !entity->IsDormant();
     }
     __attribute__((always_inline, hot, const)) inline bool Valid() const
     {
-        if (!RAW_ENT(this) || !RAW_ENT(this)->GetClientClass()->m_ClassID)
-            return false;
         IClientEntity *const entity = InternalEntity();
-        return entity;
+        return entity && entity->GetClientClass()->m_ClassID;
     }
+    void ValidateRawEntity() const;
     template <typename T> __attribute__((always_inline, hot, const)) inline T &var(uintptr_t offset) const
     {
         return *reinterpret_cast<T *>(uintptr_t(RAW_ENT(this)) + offset);
     }
 
     const int m_IDX;
+    // Hot fields, everything RAW_ENT/CE_GOOD and the vischeck cache touch, keep them at the start
+    // Filled by Update(), only trusted while raw_entity_tick matches tickcount
+    IClientEntity *raw_entity{ nullptr };
+    unsigned long raw_entity_tick{ 0 };
+    hitbox_cache::EntityHitboxCache &hitboxes;
+    bool m_bAnyHitboxVisible{ false };
+    bool m_bVisCheckComplete{ false };
+    // Set when the slot got (re)filled or the player changed name, player_info only gets refetched then
+    bool player_info_dirty{ true };
+    // Set by entity_cache::Update() when this slot was empty last update
+    bool slot_changed{ true };
+    // m_vecVelocity and m_vecAcceleration got filled by velocity::Update() this tick
+    bool velocity_is_valid{ false };
+    unsigned long m_lSeenTicks{ 0 };
+    unsigned long m_lLastSeen{ 0 };
+    // Cold fields live in entity_cache::cold_array
+    player_info_s &player_info;
 
     int m_iClassID()
+    {
+        if (entity_cache::SnapshotValid(m_IDX))
+            return entity_cache::snapshot.class_id[m_IDX];
+        return ClassIDLive();
+    };
+    int ClassIDLive()
     {
         if (RAW_ENT(this))
             if (RAW_ENT(this)->GetClientClass())
@@ -106,15 +191,22 @@ public:
     };
     Vector m_vecOrigin()
     {
+        // Engine prediction moves the local player mid-tick, always read it live
+        if (entity_cache::SnapshotValid(m_IDX) && m_IDX != g_pLocalPlayer->entity_idx)
+            return entity_cache::snapshot.origin[m_IDX];
         return RAW_ENT(this)->GetAbsOrigin();
     };
     std::optional<Vector> m_vecDormantOrigin();
     int m_iTeam()
     {
+        if (entity_cache::SnapshotValid(m_IDX))
+            return entity_cache::snapshot.team[m_IDX];
         return NET_INT(RAW_ENT(this), netvar.iTeamNum);
     };
     bool m_bAlivePlayer()
     {
+        if (entity_cache::SnapshotValid(m_IDX))
+            return entity_cache::snapshot.alive[m_IDX];
         return !(NET_BYTE(RAW_ENT(this), netvar.iLifeState));
     };
     bool m_bEnemy()
@@ -133,6 +225,12 @@ public:
             return 0.0f;
     };
     int m_iHealth()
+    {
+        if (entity_cache::SnapshotValid(m_IDX))
+            return entity_cache::snapshot.health[m_IDX];
+        return HealthLive();
+    };
+    int HealthLive()
     {
         if (m_Type() == ENTITY_PLAYER)
             return NET_INT(RAW_ENT(this), netvar.iHealth);
@@ -149,22 +247,29 @@ public:
     // Entity fields start here
     EntityType m_Type()
     {
-        EntityType ret = ENTITY_GENERIC;
-        int classid    = m_iClassID();
-        if (classid == CL_CLASS(CTFPlayer))
-            ret = ENTITY_PLAYER;
-        else if (classid == CL_CLASS(CTFGrenadePipebombProjectile) || classid == CL_CLASS(CTFProjectile_Cleaver) || classid == CL_CLASS(CTFProjectile_Jar) || classid == CL_CLASS(CTFProjectile_JarMilk) || classid == CL_CLASS(CTFProjectile_Arrow) || classid == CL_CLASS(CTFProjectile_EnergyBall) || classid == CL_CLASS(CTFProjectile_EnergyRing) || classid == CL_CLASS(CTFProjectile_GrapplingHook) || classid == CL_CLASS(CTFProjectile_HealingBolt) || classid == CL_CLASS(CTFProjectile_Rocket) || classid == CL_CLASS(CTFProjectile_SentryRocket) || classid == CL_CLASS(CTFProjectile_BallOfFire) || classid == CL_CLASS(CTFProjectile_Flare))
-            ret = ENTITY_PROJECTILE;
-        else if (classid == CL_CLASS(CObjectTeleporter) || classid == CL_CLASS(CObjectSentrygun) || classid == CL_CLASS(CObjectDispenser))
-            ret = ENTITY_BUILDING;
-        else if (classid == CL_CLASS(CZombie) || classid == CL_CLASS(CTFTankBoss) || classid == CL_CLASS(CMerasmus) || classid == CL_CLASS(CMerasmusDancer) || classid == CL_CLASS(CEyeballBoss) || classid == CL_CLASS(CHeadlessHatman))
-            ret = ENTITY_NPC;
-        else
-            ret = ENTITY_GENERIC;
-        return ret;
+        if (entity_cache::SnapshotValid(m_IDX))
+            return entity_cache::snapshot.type[m_IDX];
+        return TypeFromClassID(m_iClassID());
+    };
+    static EntityType TypeFromClassID(int classid)
+    {
+        return classinfo::GetClassEntry(classid).type;
     };
 
     float m_flDistance()
+    {
+        if (entity_cache::SnapshotValid(m_IDX))
+        {
+            if (entity_cache::snapshot.distance_tick[m_IDX] != tickcount)
+            {
+                entity_cache::snapshot.distance_tick[m_IDX] = tickcount;
+                entity_cache::snapshot.distance[m_IDX]      = DistanceLive();
+            }
+            return entity_cache::snapshot.distance[m_IDX];
+        }
+        return DistanceLive();
+    };
+    float DistanceLive()
     {
         if (CE_GOOD(g_pLocalPlayer->entity))
             return g_pLocalPlayer->v_Origin.DistTo(m_vecOrigin());
@@ -181,34 +286,31 @@ public:
     };
     bool m_bGrenadeProjectile()
     {
-        return m_iClassID() == CL_CLASS(CTFGrenadePipebombProjectile) || m_iClassID() == CL_CLASS(CTFProjectile_Cleaver) || m_iClassID() == CL_CLASS(CTFProjectile_Jar) || m_iClassID() == CL_CLASS(CTFProjectile_JarMilk);
+        return classinfo::GetClassEntry(m_iClassID()).flags & classinfo::CF_GRENADE;
     };
 
-    bool m_bAnyHitboxVisible{ false };
-    bool m_bVisCheckComplete{ false };
-
     k_EItemType m_ItemType()
     {
+        if (entity_cache::SnapshotValid(m_IDX))
+            return entity_cache::snapshot.item_type[m_IDX];
         if (m_Type() == ENTITY_GENERIC)
             return g_ItemManager.GetItemType(this);
         else
             return ITEM_NONE;
     };
 
-    unsigned long m_lSeenTicks{ 0 };
-    unsigned long m_lLastSeen{ 0 };
-    Vector m_vecVOrigin{ 0 };
-    Vector m_vecVelocity{ 0 };
-    Vector m_vecAcceleration{ 0 };
-    float m_fLastUpdate{ 0.0f };
-    hitbox_cache::EntityHitboxCache &hitboxes;
-    player_info_s player_info{};
-    Averager<float> velocity_averager{ 8 };
     bool was_dormant()
     {
+        if (entity_cache::SnapshotValid(m_IDX))
+            return entity_cache::snapshot.dormant[m_IDX];
         return RAW_ENT(this)->IsDormant();
     };
-    bool velocity_is_valid{ false };
+    // Only used for debug output, kept at the tail of the object
+    Vector m_vecVOrigin{ 0 };
+    // Smoothed over the last few server updates, see velocity::Update()
+    Vector m_vecVelocity{ 0 };
+    Vector m_vecAcceleration{ 0 };
+    float m_fLastUpdate{ 0.0f };
 #if PROXY_ENTITY != true
     IClientEntity *m_pEntity{ nullptr };
 #endif
@@ -220,12 +322,141 @@ namespace entity_cache
 extern CachedEntity array[MAX_ENTITIES]; // b1g fat array in
 inline CachedEntity &Get(int idx)
 {
-    if (idx < 0 || idx >= 2048)
+    if (idx < 0 || idx >= MAX_ENTITIES)
         throw std::out_of_range("Entity index out of range!");
     return array[idx];
 }
+// No bounds check, keeps the throw out of hot loops
+__attribute__((always_inline, hot)) inline CachedEntity &UncheckedGet(int idx)
+{
+    return array[idx];
+}
 void Update();
 void Invalidate();
 void Shutdown();
 extern int max;
+
+constexpr int ENTITY_TYPE_COUNT = ENTITY_NPC + 1;
+// Team numbers go from TEAM_UNK up to TEAM_BLU
+constexpr int TEAM_COUNT = TEAM_BLU + 1;
+
+// Valid (not null, may be dormant) entities of each type, rebuilt every Update()
+extern std::vector<CachedEntity *> valid_by_type[ENTITY_TYPE_COUNT];
+extern std::vector<CachedEntity *> valid_by_team[ENTITY_TYPE_COUNT][TEAM_COUNT];
+
+inline const std::vector<CachedEntity *> &OfType(EntityType type)
+{
+    return valid_by_type[type];
+}
+inline const std::vector<CachedEntity *> &OfTeam(EntityType type, int team)
+{
+    static const std::vector<CachedEntity *> empty{};
+    if (team < 0 || team >= TEAM_COUNT)
+        return empty;
+    return valid_by_team[type][team];
+}
+inline const std::vector<CachedEntity *> &players()
+{
+    return valid_by_type[ENTITY_PLAYER];
+}
+inline const std::vector<CachedEntity *> &projectiles()
+{
+    return valid_by_type[ENTITY_PROJECTILE];
+}
+inline const std::vector<CachedEntity *> &buildings()
+{
+    return valid_by_type[ENTITY_BUILDING];
+}
+inline const std::vector<CachedEntity *> &npcs()
+{
+    return valid_by_type[ENTITY_NPC];
+}
+
+struct pickup_s
+{
+    CachedEntity *ent;
+    Vector origin;
+    // False while it waits to respawn
+    bool available;
+    // Nav area it lies on, nullptr until the nav mesh is loaded
+    CNavArea *area;
+};
+// Non dormant generic entities with an item type, rebuilt every Update()
+extern std::vector<pickup_s> pickups_by_type[ITEM_COUNT];
+
+inline const std::vector<pickup_s> &pickups(k_EItemType type)
+{
+    return pickups_by_type[type];
+}
+
+// Mann vs Machine map, set on level init
+extern bool mvm;
+// Only filled in MvM, rebuilt every Update()
+extern std::vector<CachedEntity *> mvm_busters;
+
+inline const std::vector<CachedEntity *> &busters()
+{
+    return mvm_busters;
+}
+// Sentry buster as of the last Update()
+bool IsBuster(int idx);
+
+enum building_kind : uint8_t
+{
+    BUILDING_DISPENSER,
+    BUILDING_TELE_ENTRANCE,
+    BUILDING_TELE_EXIT,
+    BUILDING_SENTRY,
+    BUILDING_KIND_COUNT
+};
+
+struct building_s
+{
+    CachedEntity *ent;
+    building_kind kind;
+    // Entity index of the engineer, 0 if the handle doesn't resolve
+    int owner;
+    int team;
+    int level;
+    bool mini;
+    // Still being constructed
+    bool building;
+    // Blueprint that hasn't been put down yet
+    bool placing;
+    bool sapped;
+    bool dormant;
+    int health;
+    int max_health;
+    Vector origin;
+};
+// Every sentry, dispenser and teleporter with a snapshot this tick, rebuilt every Update().
+// object_destroyed removes a building right away instead of when its entity goes
+extern std::vector<building_s> building_list;
+// Into building_list, the ones the local player owns
+extern std::vector<const building_s *> own_buildings;
+
+inline const std::vector<building_s> &building_registry()
+{
+    return building_list;
+}
+inline const std::vector<const building_s *> &our_buildings()
+{
+    return own_buildings;
+}
+// Our placed building of that kind, nullptr if there is none
+inline const building_s *OurBuilding(building_kind kind)
+{
+    for (auto building : own_buildings)
+        if (building->kind == kind && !building->placing)
+            return building;
+    return nullptr;
+}
+
+// Kept up to date from player_info and the connect/disconnect events, so none of these ask the engine
+// Entity index of the player with that userid, 0 if there is none
+int IndexForUserID(int userid);
+// Steam account id of the player in slot idx, 0 for bots and empty slots
+unsigned SteamID(int idx);
+// Playerlist entry of the player in slot idx
+playerlist::userdata &PlayerlistEntry(int idx);
 } // namespace entity_cache
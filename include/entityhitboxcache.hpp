@@ -27,6 +27,36 @@ struct CachedHitbox
     mstudiobbox_t *bbox;
 };
 
+// Bump allocator for bone matrices. Reset every tick, so only entities that actually asked for their bones use memory.
+// Two buffers are swapped on reset so pointers handed out last tick stay readable for one more tick (Draw, DME)
+class BoneArena
+{
+public:
+    // Every allocation is this big so callers can index any bone below MAXSTUDIOBONES
+    static constexpr int BONES_PER_ENTITY = MAXSTUDIOBONES;
+    static constexpr int MAX_ALLOCATIONS  = 96;
+
+    // Returns nullptr when the arena is full, callers fall back to their own storage
+    matrix3x4_t *Allocate();
+    void Reset();
+    // Whether memory handed out in that generation has not been reused yet
+    bool IsValid(unsigned gen) const
+    {
+        return gen && gen + 1 >= generation;
+    }
+
+    unsigned generation{ 1 };
+
+private:
+    std::unique_ptr<matrix3x4_t[]> storage[2];
+    int used{ 0 };
+};
+
+extern BoneArena bone_arena;
+
+// Transforms bbmin/bbmax of the first count hitboxes in set through their bones. Hitboxes with a bad bone get a null bbox
+void TransformHitboxes(const matrix3x4_t *bones, mstudiohitboxset_t *set, int count, CachedHitbox *out);
+
 class EntityHitboxCache
 {
 public:
@@ -41,6 +71,8 @@ public:
     int GetNumHitboxes();
     void Reset();
     matrix3x4_t *GetBones(int numbones = -1);
+    // Bones a CreateMove of this or the last tick set up, nullptr if there are none. Never sets anything up itself, for the paint path
+    const matrix3x4_t *PreparedBones() const;
 
     int m_nNumHitboxes;
     bool m_bModelSet;
@@ -50,20 +82,36 @@ public:
     model_t *m_pLastModel;
     CachedEntity *parent_ref; // TODO FIXME turn this into an actual reference
 
+    // Kept across ticks, trace::Batch tries it first
+    int last_visible_hitbox{ -1 };
     bool m_VisCheckValidationFlags[CACHE_MAX_HITBOXES]{ false };
     bool m_VisCheck[CACHE_MAX_HITBOXES]{ false };
     bool m_CacheValidationFlags[CACHE_MAX_HITBOXES]{ false };
     std::vector<CachedHitbox> m_CacheInternal;
 
+    // Fallback storage for when the arena is full, only ever grows
     std::vector<matrix3x4_t> bones;
+    matrix3x4_t *bone_data{ nullptr };
+    unsigned bones_generation{ 0 };
+    // Arena generation of the last successful setup, 0 if it failed
+    unsigned prepared_generation{ 0 };
     bool bones_setup{ false };
 };
 
 extern EntityHitboxCache array[2048];
+// Call once per tick before any bones are requested
+void Update();
+// Sets up bones of every alive player in one pass, call after the local player got updated
+void PrepareBones();
 inline EntityHitboxCache &Get(unsigned i)
 {
-    if (i > 2048)
+    if (i >= 2048)
         throw std::out_of_range("Requested out-of-range entity hitbox cache entry!");
     return array[i];
 }
+// No bounds check, for callers that already know the index is good
+__attribute__((always_inline, hot)) inline EntityHitboxCache &UncheckedGet(unsigned i)
+{
+    return array[i];
+}
 } // namespace hitbox_cache
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ *  The last RECORDS ticks, kept in memory all the time and written out on a fatal signal or a tick that took too long.
+ *  A dump is a header_s followed by header.records record_s, the ring as it was in memory. Record i of the ring holds
+ *  the tick with index i modulo records, entries whose index doesn't match were never or only partly written.
+ *  Everything here is plain data, so an offline tool only needs this header
+ */
+
+namespace flight_recorder
+{
+constexpr uint32_t MAGIC   = 0x52544c46; // "FLTR"
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t RECORDS = 1024; // Power of two, about 15 seconds at 66 ticks
+constexpr int CALLBACKS     = 4;
+constexpr int CALLBACK_NAME = 28;
+
+enum dump_reason : uint32_t
+{
+    REASON_SIGNAL = 0,
+    REASON_SPIKE,
+    REASON_COMMAND
+};
+
+struct callback_s
+{
+    // Truncated, not always null terminated
+    char name[CALLBACK_NAME];
+    uint32_t us;
+};
+
+struct record_s
+{
+    // Ticks recorded so far when this one was written, written last
+    uint64_t index;
+    // CLOCK_MONOTONIC
+    int64_t time_ns;
+    uint32_t tickcount;
+    // CreateMove, from the earliest to the latest callback
+    uint32_t tick_us;
+    uint16_t entities;
+    uint16_t players;
+    uint16_t projectiles;
+    uint16_t buildings;
+    // Ray traces issued during the tick
+    uint32_t traces;
+    uint16_t path_solves;
+    uint16_t repaths;
+    uint32_t path_solve_us;
+    // NavBot task id and nav priority
+    uint8_t nav_task;
+    // governor::level
+    uint8_t quality_level;
+    uint8_t pad[2];
+    int32_t nav_priority;
+    // Slowest CreateMove callbacks, only with debug.ec-monitor.enable. Unused ones have us 0
+    callback_s callbacks[CALLBACKS];
+};
+
+struct header_s
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t records;
+    // Ticks recorded in total, the newest one is (written - 1) % records
+    uint64_t written;
+    int32_t pid;
+    dump_reason reason;
+};
+
+// Writes the ring, safe to call from a signal handler
+void DumpFatal();
+} // namespace flight_recorder
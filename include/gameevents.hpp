@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+class IGameEvent;
+
+/*
+ * Every module gets its game events through here. The router registers with the event manager once per event name,
+ * decodes the events a lot of modules care about once and hands them to all subscribers of that event.
+ */
+
+namespace game_events
+{
+typedef uint16_t event_id;
+
+// Interned first, so they are known without a lookup
+enum : event_id
+{
+    player_death = 0,
+    player_hurt
+};
+
+struct player_death_s
+{
+    int victim_userid;
+    int attacker_userid;
+    int assister_userid;
+    // Entity indices, 0 if the player isn't in game
+    int victim;
+    int attacker;
+    int assister;
+    int weaponid;
+    int customkill;
+    int damagebits;
+    int death_flags;
+};
+
+struct player_hurt_s
+{
+    int victim_userid;
+    int attacker_userid;
+    // Entity indices, 0 if the player isn't in game
+    int victim;
+    int attacker;
+    int health;
+    int damage;
+    int weaponid;
+    int custom;
+    bool crit;
+    bool minicrit;
+};
+
+struct event_s
+{
+    event_id id;
+    IGameEvent *raw;
+    // The "userid" key and its entity index, -1 and 0 for events without one
+    int userid;
+    int player;
+    // Only set for the event with the same name
+    const player_death_s *death;
+    const player_hurt_s *hurt;
+};
+
+typedef std::function<void(const event_s &)> callback_t;
+
+// The same id for the same name until the game closes
+event_id Intern(const char *name);
+const char *Name(event_id id);
+// Callbacks of an event run in the order they subscribed
+event_id Subscribe(const char *name, callback_t callback);
+} // namespace game_events
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Steps optional work down while CreateMove keeps going over governor.budget-us, and back up once it has been
+ * comfortably under it for a while. Each level also keeps everything the levels below it dropped.
+ */
+
+namespace governor
+{
+enum level : uint8_t
+{
+    FULL = 0,
+    // Path, crumb, hitbox and warp visualisers
+    NO_VISUALISERS,
+    // NavBot rescans building spots less often and scores fewer per tick
+    SLOW_NAVBOT_SCORING,
+    // ESP only looks at players and buildings
+    NO_ESP_EXTRAS,
+    // IsVisible only checks a few player hitboxes, even with debug.fast-vischeck off
+    FAST_VISCHECK,
+    // Only every other backtrack tick is offered
+    HALF_BACKTRACK,
+    LEVEL_COUNT
+};
+
+// Written by the game thread, callbacks on stage workers read it too
+extern std::atomic<uint8_t> current;
+
+inline uint8_t Level()
+{
+    return current.load(std::memory_order_relaxed);
+}
+inline bool Degraded(level at)
+{
+    return Level() >= at;
+}
+const char *Name(level at);
+} // namespace governor
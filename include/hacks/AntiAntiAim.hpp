@@ -9,18 +9,13 @@
 #pragma once
 class IClientEntity;
 
-struct brutedata
-{
-    int brutenum{ 0 };
-    int hits_in_a_row{ 0 };
-    Vector original_angle{};
-    Vector new_angle{};
-};
-
 namespace hacks::shared::anti_anti_aim
 {
-extern std::unordered_map<unsigned, brutedata> resolver_map;
+// Hitrate feedback for the player in that slot
+void registerHit(int idx);
 void increaseBruteNum(int idx);
+// Forget everything, on level change
+void reset();
 void frameStageNotify(ClientFrameStage_t stage);
 // void resolveEnt(int IDX, IClientEntity *entity = nullptr);
 } // namespace hacks::shared::anti_anti_aim
@@ -9,9 +9,7 @@
 
 #include "common.hpp"
 
-#include "ac/aimbot.hpp"
-#include "ac/antiaim.hpp"
-#include "ac/bhop.hpp"
+#include "ac/pipeline.hpp"
 
 namespace hacks::shared::anticheat
 {
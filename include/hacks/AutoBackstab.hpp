@@ -0,0 +1,53 @@
+/*
+ * AutoBackstab.hpp
+ *
+ *  Created on: Apr 14, 2017
+ *      Author: nullifiedcat
+ */
+
+#pragma once
+
+#include "Backtrack.hpp"
+
+namespace hacks::tf2::autobackstab
+{
+// Every melee opportunity of one pass in SoA layout, so the range and behind checks run four candidates at a time.
+// Padded to a multiple of 4 with candidates that are never in range
+struct stab_candidates_s
+{
+    static constexpr int MAX = (PLAYER_ARRAY_SIZE * backtrack::MAX_TICKS + 3) & ~3;
+
+    // Attacker to victim. The angle checks only use x and y, z only counts for the range
+    alignas(16) float dx[MAX];
+    alignas(16) float dy[MAX];
+    alignas(16) float dz[MAX];
+    // Unit forward vectors on the ground plane, see FlatForward
+    alignas(16) float attacker_x[MAX];
+    alignas(16) float attacker_y[MAX];
+    alignas(16) float victim_x[MAX];
+    alignas(16) float victim_y[MAX];
+    alignas(16) float max_sq[MAX];
+    // Nonzero if a hit from any side kills
+    alignas(16) float facestab[MAX];
+    // From Evaluate, squared distance if in range and FLT_MAX otherwise
+    alignas(16) float score[MAX];
+    bool stab[MAX];
+    int entity[MAX];
+    const backtrack::BacktrackData *tick[MAX];
+    int count{ 0 };
+
+    void Clear()
+    {
+        count = 0;
+    }
+    // False once full
+    bool Add(const Vector &delta, const Vector &attacker_forward, const Vector &victim_forward, float max_distance, bool can_facestab, int entity_idx, const backtrack::BacktrackData *from_tick = nullptr);
+    void Evaluate();
+    // Closest candidate in range, only ones that can be stabbed if stab_only. The candidate is taken out, so the next
+    // call returns the runner up. -1 once nothing is left
+    int PopBest(bool stab_only);
+};
+
+// Unit vector along yaw on the ground plane
+Vector FlatForward(float yaw);
+} // namespace hacks::tf2::autobackstab
@@ -31,7 +31,6 @@ class BacktrackData
 public:
     int tickcount{};
 
-    std::array<hitboxData, 18> hitboxes{};
     Vector m_vecOrigin{};
     Vector m_vecAngles{};
 
@@ -41,7 +40,120 @@ public:
     float m_flSimulationTime{};
     bool has_updated{};
 
-    std::vector<matrix3x4_t> bones{};
+    // Points into the pooled storage of the owning record, only valid until that slot is recorded again
+    matrix3x4_t *bones{ nullptr };
+    int numbones{ 0 };
+    // Set of the model the bones belong to
+    mstudiohitboxset_t *hitbox_set{ nullptr };
+
+    // Most ticks never get looked at, so hitboxes are only transformed from the bones on first use
+    const hitboxData &hitbox(int id) const
+    {
+        if (!hitboxes_ready)
+            materializeHitboxes();
+        return hitboxes.at(id);
+    }
+
+private:
+    void materializeHitboxes() const;
+
+    mutable std::array<hitboxData, 18> hitboxes{};
+    mutable bool hitboxes_ready{ false };
+};
+
+// getTicks() never goes above a second worth of ticks
+constexpr int MAX_TICKS = 67;
+
+// Oldest first list of a player's good ticks. Points into the backtrack records, so only valid until the next backtrack CreateMove
+class GoodTicks
+{
+public:
+    class iterator
+    {
+    public:
+        explicit iterator(const BacktrackData *const *at) : at(at)
+        {
+        }
+        const BacktrackData &operator*() const
+        {
+            return **at;
+        }
+        iterator &operator++()
+        {
+            ++at;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const
+        {
+            return at != other.at;
+        }
+
+    private:
+        const BacktrackData *const *at;
+    };
+
+    void push_back(const BacktrackData &tick)
+    {
+        ticks[count++] = &tick;
+    }
+    iterator begin() const
+    {
+        return iterator(ticks.data());
+    }
+    iterator end() const
+    {
+        return iterator(ticks.data() + count);
+    }
+    const BacktrackData &operator[](size_t i) const
+    {
+        return *ticks[i];
+    }
+    size_t size() const
+    {
+        return count;
+    }
+    bool empty() const
+    {
+        return !count;
+    }
+    // Ring order is not tick order once the tick count changes
+    void sort()
+    {
+        std::sort(ticks.begin(), ticks.begin() + count, [](const BacktrackData *a, const BacktrackData *b) { return a->tickcount < b->tickcount; });
+    }
+
+private:
+    std::array<const BacktrackData *, MAX_TICKS> ticks{};
+    size_t count{ 0 };
+};
+
+// Conservative box around the hull and hitboxes of every usable tick a player has stored
+class TickBounds
+{
+public:
+    Vector min{ 0.0f, 0.0f, 0.0f };
+    Vector max{ 0.0f, 0.0f, 0.0f };
+
+    void Reset(const Vector &point)
+    {
+        min = max = point;
+    }
+    void Add(const Vector &point)
+    {
+        VectorMin(min, point, min);
+        VectorMax(max, point, max);
+    }
+    void Add(const TickBounds &other)
+    {
+        Add(other.min);
+        Add(other.max);
+    }
+    // Lower bound for the distance from vec to anything inside
+    float DistTo(const Vector &vec) const
+    {
+        Vector closest(std::clamp(vec.x, min.x, max.x), std::clamp(vec.y, min.y, max.y), std::clamp(vec.z, min.z, max.z));
+        return closest.DistTo(vec);
+    }
 };
 
 // Stuff that has to be accessible from outside, mostly functions
@@ -53,6 +165,8 @@ extern settings::Boolean chams;
 extern settings::Int chams_ticks;
 extern settings::Rgba chams_color;
 extern settings::Boolean chams_solid;
+extern settings::Int chams_tick;
+extern settings::Boolean chams_hitboxes;
 #endif
 
 // Check if backtrack is enabled
@@ -60,6 +174,8 @@ extern bool isBacktrackEnabled;
 #if ENABLE_VISUALS
 // Drawing Backtrack chams
 extern bool isDrawing;
+// framecount of the last frame the world pass drew a player's backtrack chams, the chams effect only fills in for the rest
+extern int chams_drawn_frame[PLAYER_ARRAY_SIZE];
 #endif
 // Event callbacks
 void CreateMove();
@@ -72,15 +188,92 @@ void LevelShutdown();
 void adjustPing(INetChannel *);
 void updateDatagram();
 void resetData(int);
-bool isGoodTick(BacktrackData &);
-bool defaultTickFilter(CachedEntity *, BacktrackData);
+bool isGoodTick(const BacktrackData &);
+bool defaultTickFilter(CachedEntity *, const BacktrackData &);
 bool defaultEntFilter(CachedEntity *);
 
 // Various functions for getting backtrack ticks
-std::vector<BacktrackData> getGoodTicks(int);
-std::optional<BacktrackData> getBestTick(CachedEntity *, std::function<bool(CachedEntity *, BacktrackData &, std::optional<BacktrackData> &)>);
-std::optional<BacktrackData> getClosestEntTick(CachedEntity *, Vector, std::function<bool(CachedEntity *, BacktrackData)>);
-std::optional<std::pair<CachedEntity *, BacktrackData>> getClosestTick(Vector, std::function<bool(CachedEntity *)>, std::function<bool(CachedEntity *, BacktrackData)>);
+GoodTicks getGoodTicks(int);
+#if ENABLE_VISUALS
+// The ones backtrack.chams.tick picks out of those, oldest first
+GoodTicks getChamsTicks(int);
+#endif
+// nullptr if nothing is recorded for that player
+const TickBounds *getTickBounds(int);
+// Could any tick of that player be within fov degrees of the crosshair?
+bool boundsInFov(int, float);
 
-void SetBacktrackData(CachedEntity *ent, BacktrackData);
+void SetBacktrackData(CachedEntity *ent, const BacktrackData &);
+
+// The tick filters are plain callables so scanning the history does not copy or allocate anything
+
+// callback(ent, tick, best_tick) returns true if tick beats best_tick, which is nullptr for the first candidate
+template <typename Callback> std::optional<BacktrackData> getBestTick(CachedEntity *ent, Callback &&callback)
+{
+    const BacktrackData *best_tick = nullptr;
+
+    // Let the callback do the lifting
+    for (auto &tick : getGoodTicks(ent->m_IDX))
+        if (callback(ent, tick, best_tick))
+            best_tick = &tick;
+
+    if (!best_tick)
+        return std::nullopt;
+    return *best_tick;
+}
+
+// Get Closest tick of a specific entity
+template <typename TickFilter> std::optional<BacktrackData> getClosestEntTick(CachedEntity *ent, const Vector &vec, TickFilter &&tick_filter)
+{
+    const BacktrackData *closest = nullptr;
+    float distance               = FLT_MAX;
+
+    for (auto &tick : getGoodTicks(ent->m_IDX))
+    {
+        float tick_distance = tick.m_vecOrigin.DistTo(vec);
+        // Found Closer tick that passes the filter
+        if (tick_distance < distance && tick_filter(ent, tick))
+        {
+            closest  = &tick;
+            distance = tick_distance;
+        }
+    }
+    if (!closest)
+        return std::nullopt;
+    return *closest;
+}
+
+// Get Closest tick of any (enemy) entity, Second Parameter is to allow custom filters for entity criteria, third for ticks. We provide defaults for vischecks + melee for the second one
+template <typename EntFilter, typename TickFilter> std::optional<std::pair<CachedEntity *, BacktrackData>> getClosestTick(const Vector &vec, EntFilter &&ent_filter, TickFilter &&tick_filter)
+{
+    float distance         = FLT_MAX;
+    CachedEntity *best_ent = nullptr;
+    std::optional<BacktrackData> best_data;
+
+    for (int i = 0; i <= g_IEngine->GetMaxClients(); i++)
+    {
+        CachedEntity *ent = ENTITY(i);
+        // These checks are always present
+        if (CE_INVALID(ent) || !ent->m_bAlivePlayer() || !ent->m_bEnemy())
+            continue;
+        // Nothing stored for them can get closer than what we have
+        auto bounds = getTickBounds(i);
+        if (!bounds || bounds->DistTo(vec) > distance)
+            continue;
+        // true = passes check
+        if (!ent_filter(ent))
+            continue;
+        auto closest_entdata = getClosestEntTick(ent, vec, tick_filter);
+        // Closer than the stuff we have
+        if (closest_entdata && closest_entdata->m_vecOrigin.DistTo(vec) <= distance)
+        {
+            distance  = closest_entdata->m_vecOrigin.DistTo(vec);
+            best_data = closest_entdata;
+            best_ent  = ent;
+        }
+    }
+    if (!best_ent)
+        return std::nullopt;
+    return std::pair<CachedEntity *, BacktrackData>(best_ent, *best_data);
+}
 } // namespace hacks::tf2::backtrack
@@ -18,5 +18,5 @@
 
 namespace hacks::shared::ChatCommands
 {
-void handleChatMessage(std::string message, int userid);
+void handleChatMessage(std::string_view message, int userid);
 }
@@ -12,12 +12,18 @@
 namespace hacks::shared::esp
 {
 
-// Strings
+// Strings, kept per entity between ticks and only rewritten when their text changes
 class ESPString
 {
 public:
-    std::string data{ "" };
+    static constexpr int MAX_LENGTH = 64;
+    char data[MAX_LENGTH]{};
     rgba_t color{ colors::empty };
+    // Format and key that produced data, plain strings have no format
+    const char *format{ nullptr };
+    uint64_t key{ 0 };
+    // Changes whenever data does, Draw keys its measured text widths on it
+    uint32_t revision{ 0 };
 };
 
 // Cached data
@@ -40,17 +46,38 @@ extern std::array<ESPData, 2048> data;
 
 // Entity Processing
 void __attribute__((fastcall)) ProcessEntity(CachedEntity *ent);
-void __attribute__((fastcall)) ProcessEntityPT(CachedEntity *ent);
+void __attribute__((fastcall)) ProcessEntityPT(CachedEntity *ent, ESPData &ent_data);
 void __attribute__((fastcall)) emoji(CachedEntity *ent);
 
 // helper funcs
 void __attribute__((fastcall)) Draw3DBox(CachedEntity *ent, const rgba_t &clr);
-void __attribute__((fastcall)) DrawBox(CachedEntity *ent, const rgba_t &clr);
+void __attribute__((fastcall)) DrawBox(CachedEntity *ent, const rgba_t &clr, ESPData &ent_data);
 void BoxCorners(int minx, int miny, int maxx, int maxy, const rgba_t &color, bool transparent);
-bool GetCollide(CachedEntity *ent);
+bool GetCollide(CachedEntity *ent, ESPData &ent_data);
 
 // Strings
-void AddEntityString(CachedEntity *entity, const std::string &string, const rgba_t &color = colors::empty);
+ESPString *NextEntityString(CachedEntity *entity);
+uint32_t NextStringRevision();
+void AddEntityString(CachedEntity *entity, const char *string, const rgba_t &color = colors::empty);
+inline void AddEntityString(CachedEntity *entity, const std::string &string, const rgba_t &color = colors::empty)
+{
+    AddEntityString(entity, string.c_str(), color);
+}
+// Only formats again when the key changes, so the key has to pack every value the text depends on
+template <typename... Args> void AddEntityStringFormat(CachedEntity *entity, uint64_t key, const rgba_t &color, const char *fmt, Args... args)
+{
+    ESPString *string = NextEntityString(entity);
+    if (!string)
+        return;
+    if (string->format != fmt || string->key != key)
+    {
+        snprintf(string->data, sizeof(string->data), fmt, args...);
+        string->format   = fmt;
+        string->key      = key;
+        string->revision = NextStringRevision();
+    }
+    string->color = color;
+}
 void SetEntityColor(CachedEntity *entity, const rgba_t &color);
 void ResetEntityStrings();
 } // namespace hacks::shared::esp
@@ -19,7 +19,8 @@ enum task : uint8_t
     dispenser,
     followbot,
     outofbounds,
-    engineer
+    engineer,
+    objective
 };
 
 enum engineer_task : uint8_t
@@ -60,6 +60,7 @@ public:
     CAttributeList();
     float GetAttribute(int defindex);
     void SetAttribute(int index, float value);
+    void SetAttribute(AttributeDefinitionPtr_t definition, float value);
     void RemoveAttribute(int index);
 
 public:
@@ -116,9 +117,17 @@ struct def_attribute_modifier
     void Apply(int entity);
     void Set(int id, float value);
     void Remove(int id);
+    // Looks the attribute definitions up again on the next Apply, call after changing modifiers
+    void Invalidate();
     int defidx{ 0 };
     int defidx_redirect{ 0 };
     std::vector<attribute_s> modifiers{};
+    // Schema definition of every modifier, resolved once instead of on every Apply
+    std::vector<AttributeDefinitionPtr_t> definitions{};
+    bool resolved{ false };
+
+private:
+    bool Resolve();
 };
 
 extern std::unordered_map<int, def_attribute_modifier> modifier_map;
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "common.hpp"
+#include "angles.hpp"
+
+/*
+ * The game thread copies what the detectors need out of every player once per tick and hands it to a detector thread
+ * through a ring, the detectors run there and send their verdicts back the same way. Nothing on the detector thread
+ * touches the game, all engine calls happen when the verdicts get drained in CreateMove.
+ *
+ * Detectors register themselves with the features they need. Every feature is extracted once per player per tick
+ * if any detector asked for it, then each detector sees every checked player.
+ */
+
+namespace ac
+{
+struct player_s
+{
+    // Alive and valid this tick, the angle history gets dropped otherwise
+    bool present;
+    // Passes the target filter, detectors only look at these
+    bool check;
+    bool on_ground;
+    Vector angles;
+    Vector origin;
+    // Class id of the active weapon, -1 without one
+    int weapon_class;
+    // Client class name, lives as long as the client library
+    const char *weapon_name;
+    condition_data_s conditions;
+};
+
+// A player got hurt or killed this tick
+struct hit_s
+{
+    int attacker;
+    int victim;
+    int weaponid;
+};
+
+struct tick_s
+{
+    int tickcount;
+    // Players to forget before the detectors run, bit per entity index
+    uint64_t reset;
+    bool reset_all;
+    int hit_count;
+    hit_s hits[16];
+    player_s players[PLAYER_ARRAY_SIZE];
+};
+
+enum feature : uint32_t
+{
+    // features_s::velocity and speed
+    feature_velocity = 1 << 0,
+    // features_s::landed, jumped and ground_ticks
+    feature_ground = 1 << 1
+};
+
+// Derived from the snapshots on the detector thread
+struct features_s
+{
+    // Always there, the history gets pushed for every present player anyway
+    const angles::angle_data_s *angles;
+    // Units per tick since the previous tick the player was present in
+    Vector velocity;
+    float speed;
+    // Touched the ground or left it this tick
+    bool landed;
+    bool jumped;
+    // Ticks on the ground so far, or the ones before the jump on the tick they jumped
+    int ground_ticks;
+};
+
+struct frame_s
+{
+    const tick_s &tick;
+    const player_s &player;
+    const features_s &features;
+};
+
+struct detector_s
+{
+    const char *name;
+    // Bits of feature
+    uint32_t features;
+    // Once per tick for every player that passes the target filter
+    void (*update)(int idx, const frame_s &frame);
+    void (*reset_player)(int idx);
+    void (*reset_all)();
+    // Before the tick's players, for the hits that happened since the previous tick
+    void (*hit)(const hit_s &hit);
+    // After the hits, before any updates
+    void (*begin_tick)();
+};
+
+// From an InitRoutine, detectors can't come and go once the detector thread runs
+void Register(const detector_s &detector);
+
+// Detector thread only
+void Accuse(int idx, const char *hack, const std::string &details);
+// Mark them as rage in the playerlist, if find-cheaters.auto-rage allows it
+void Rage(int idx);
+} // namespace ac
@@ -29,7 +29,11 @@ constexpr float RADPI = 57.295779513082f;
 #include <core/logging.hpp>
 
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
 #include <vector>
 #include <mutex>
 #include <random>
@@ -212,17 +216,94 @@ int SharedRandomInt(unsigned iseed, const char *sharedname, int iMinVal, int iMa
 bool HookNetvar(std::vector<std::string> path, ProxyFnHook &hook, RecvVarProxyFn function);
 float ATTRIB_HOOK_FLOAT(float base_value, const char *search_string, IClientEntity *ent, void *buffer, bool is_global_const_string);
 
-void format_internal(std::stringstream &stream);
-template <typename T, typename... Targs> void format_internal(std::stringstream &stream, T value, Targs... args)
+// Where format and format_to put their output, either a growing string or a fixed buffer that cuts off at its end
+class format_sink
 {
-    stream << value;
-    format_internal(stream, args...);
+public:
+    explicit format_sink(std::string &out) : m_string{ &out }
+    {
+    }
+    format_sink(char *buffer, size_t size) : m_at{ buffer }, m_end{ buffer + size - 1 }
+    {
+    }
+    void write(const char *data, size_t size)
+    {
+        if (m_string)
+        {
+            m_string->append(data, size);
+            return;
+        }
+        size = std::min(size, size_t(m_end - m_at));
+        memcpy(m_at, data, size);
+        m_at += size;
+    }
+    // Null terminates a buffer, returns the length written
+    size_t finish(const char *buffer)
+    {
+        if (m_string)
+            return m_string->size();
+        *m_at = 0;
+        return m_at - buffer;
+    }
+
+private:
+    std::string *m_string{ nullptr };
+    char *m_at{ nullptr };
+    char *m_end{ nullptr };
+};
+
+// Same text streaming value into a std::stringstream gives, without a stream for the common types
+template <typename T> void format_value(format_sink &sink, const T &value)
+{
+    if constexpr (std::is_same_v<T, bool>)
+        sink.write(value ? "1" : "0", 1);
+    else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+        sink.write((const char *) &value, 1);
+    else if constexpr (std::is_integral_v<T>)
+    {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        sink.write(digits, result.ptr - digits);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        char digits[32];
+        int length = snprintf(digits, sizeof(digits), "%g", double(value));
+        sink.write(digits, std::clamp(length, 0, int(sizeof(digits)) - 1));
+    }
+    else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>)
+    {
+        if (value)
+            sink.write(value, strlen(value));
+    }
+    else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+    {
+        std::string_view view = value;
+        sink.write(view.data(), view.size());
+    }
+    else
+    {
+        std::stringstream stream;
+        stream << value;
+        std::string text = stream.str();
+        sink.write(text.data(), text.size());
+    }
 }
+
 template <typename... Args> std::string format(const Args &... args)
 {
-    std::stringstream stream;
-    format_internal(stream, args...);
-    return stream.str();
+    std::string out;
+    out.reserve(64);
+    format_sink sink(out);
+    (format_value(sink, args), ...);
+    return out;
+}
+// Allocation free format for strings that only live until the next draw, truncated to the buffer
+template <size_t N, typename... Args> size_t format_to(char (&buffer)[N], const Args &... args)
+{
+    format_sink sink(buffer, N);
+    (format_value(sink, args), ...);
+    return sink.finish(buffer);
 }
 
 extern const std::string classes[10];
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+
 namespace hitrate
 {
 
@@ -14,6 +17,31 @@ extern int count_shots;
 extern int count_hits;
 extern int count_hits_head;
 
+enum weapon_class : uint8_t
+{
+    class_hitscan = 0,
+    class_sniper,
+    class_projectile,
+    class_melee,
+    WEAPON_CLASSES
+};
+
+// Below 256, 512, 1024 and 2048 units, then everything beyond
+constexpr int DISTANCE_BUCKETS = 5;
+// Below 16ms, doubling up to 1024ms, then everything beyond
+constexpr int TIME_BUCKETS = 8;
+
+// Running totals since injection. Only ever written on the game thread, relaxed so telemetry can read them anywhere
+struct metrics_s
+{
+    std::atomic<uint32_t> shots[WEAPON_CLASSES][DISTANCE_BUCKETS]{};
+    std::atomic<uint32_t> hits[WEAPON_CLASSES][DISTANCE_BUCKETS]{};
+    std::atomic<uint32_t> headshots[WEAPON_CLASSES][DISTANCE_BUCKETS]{};
+    // From the shot to the hurt event of the aimbot target
+    std::atomic<uint32_t> time_to_hit[WEAPON_CLASSES][TIME_BUCKETS]{};
+};
+extern metrics_s metrics;
+
 void AimbotShot(int idx, bool target_body);
 void Update();
 } // namespace hitrate
@@ -3,6 +3,13 @@
 #include "core/profiler.hpp"
 #include "functional"
 #include <array>
+#include <string>
+#include <vector>
+
+namespace settings
+{
+template <typename T> class VariableBase;
+}
 
 namespace EC
 {
@@ -40,8 +47,89 @@ enum ec_priority
     very_late
 };
 
-typedef std::function<void()> EventFunction;
+// Plain function pointers, so dispatching is one indirect call per callback
+typedef void (*EventFunction)();
+
+// How often a callback runs, for things that don't need to run every time the event fires.
+// Callbacks sharing a rate get spread out so they don't all land on the same tick
+struct run_rate
+{
+    // Run on every n-th time the event fires, 0 means no tick limit
+    unsigned ticks{ 0 };
+    // Run at most every n milliseconds, 0 means no time limit
+    unsigned ms{ 0 };
+};
+inline run_rate every_ticks(unsigned ticks)
+{
+    return run_rate{ ticks, 0 };
+}
+inline run_rate every_ms(unsigned ms)
+{
+    return run_rate{ 0, ms };
+}
+
 void Register(enum ec_types type, const EventFunction &function, const std::string &name, enum ec_priority priority = average);
+// Only dispatched while gate is true, disabled features don't even get called
+void Register(enum ec_types type, const EventFunction &function, const std::string &name, settings::VariableBase<bool> &gate, enum ec_priority priority = average);
+void Register(enum ec_types type, const EventFunction &function, const std::string &name, run_rate rate, enum ec_priority priority = average);
+#if ENABLE_VISUALS
+enum visual_update
+{
+    // Projects world positions or animates, has to run every frame
+    per_frame,
+    // Only shows data that changes per tick. Runs once per tick and whatever it drew gets replayed on the frames in between,
+    // so it must draw through draw:: only, side and center strings would not be replayed
+    per_tick
+};
+void Register(enum ec_types type, const EventFunction &function, const std::string &name, visual_update update, enum ec_priority priority = average);
+#endif
 void Unregister(enum ec_types type, const std::string &name);
+
+// State a callback touches. Callbacks that declare theirs may run at the same time as other declared
+// callbacks of the same priority on the stage workers, as long as neither writes what the other one uses
+enum ec_resource : uint32_t
+{
+    // Entity cache, netvars and the local player
+    res_snapshot = 1 << 0,
+    // Hitbox cache, reading hitboxes sets up bones on first use
+    res_bones       = 1 << 1,
+    res_predictions = 1 << 2,
+    res_nav         = 1 << 3,
+    res_sounds      = 1 << 4,
+    res_playerlist  = 1 << 5,
+    // ESP strings and colors, chams and glow state
+    res_visuals = 1 << 6,
+    // Never leave the game thread, anything in here keeps a callback serial
+    res_usercmd = 1 << 7,
+    // Traces and interfaces that aren't safe off the game thread
+    res_engine = 1 << 8,
+    res_all    = ~0u
+};
+struct stage
+{
+    uint32_t reads;
+    uint32_t writes;
+};
+// Callbacks that never declared anything read and write everything, so they always run alone and in priority order
+void Declare(enum ec_types type, const std::string &name, stage access);
 void run(enum ec_types type);
+
+// Filled in while debug.ec-monitor.enable is on
+struct callback_latency
+{
+    std::string name;
+    const char *event;
+    float p50_us;
+    float p99_us;
+};
+// Callbacks with the worst p99, worst first
+std::vector<callback_latency> SlowestCallbacks(size_t count);
+struct callback_time
+{
+    // Stays valid while the callback is registered
+    const char *name;
+    uint32_t us;
+};
+// Slowest callbacks of the last run of type, worst first, also needs debug.ec-monitor.enable. Doesn't allocate
+size_t SlowestLastRun(enum ec_types type, callback_time *out, size_t count);
 } // namespace EC
@@ -24,15 +24,78 @@ struct SDL_Window;
     namespace original                          \
     {                                           \
     extern types::name name;                    \
+    }                                           \
+    namespace stats                             \
+    {                                           \
+    extern hook_stats_s name;                   \
     }
 
 #define DEFINE_HOOKED_METHOD(name, rtype, ...) \
     types::name original::name{ nullptr };     \
+    hook_stats_s stats::name{ #name };         \
     rtype methods::name(__VA_ARGS__)
 
+// For hooks that run every frame or more often, GCC keeps them together in .text.hot
+#define DEFINE_HOT_HOOKED_METHOD(name, rtype, ...) \
+    types::name original::name{ nullptr };         \
+    hook_stats_s stats::name{ #name };             \
+    [[gnu::hot]] rtype methods::name(__VA_ARGS__)
+
+// First statement of every hook body, counts and times the call while debug.hook-stats.enable is on
+#define HOOK_SCOPE(name) hooked_methods::HookScope hook_scope_(hooked_methods::stats::name)
+// Fast path for hooks no enabled feature needs, forwards straight to the original
+#define HOOK_SKIP_UNLESS(needed, ...) \
+    if (!(needed))                    \
+    {                                 \
+        hook_scope_.Skip();           \
+        return __VA_ARGS__;           \
+    }
+
 #define HOOK_ARGS(name) hooked_methods::methods::name, offsets::name(), &hooked_methods::original::name
 namespace hooked_methods
 {
+// Everything in profiler::Now() ticks, hooks can be called from several threads
+struct hook_stats_s
+{
+    explicit hook_stats_s(const char *name);
+
+    const char *name;
+    std::atomic<uint64_t> calls{ 0 };
+    // Calls that took the HOOK_SKIP_UNLESS fast path
+    std::atomic<uint64_t> skipped{ 0 };
+    // Includes the original and anything else the body calls
+    std::atomic<uint64_t> ticks{ 0 };
+    std::atomic<uint64_t> max_ticks{ 0 };
+};
+
+// Set from debug.hook-stats.enable, a disabled scope costs one branch
+extern bool hook_stats_enabled;
+
+class HookScope
+{
+public:
+    explicit HookScope(hook_stats_s &stats) : m_stats(stats)
+    {
+        m_start = hook_stats_enabled ? profiler::Now() : 0;
+    }
+    ~HookScope()
+    {
+        if (m_start)
+            End();
+    }
+    void Skip()
+    {
+        if (m_start)
+            m_stats.skipped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    void End();
+
+    hook_stats_s &m_stats;
+    uint64_t m_start;
+};
+
 // ClientMode
 DECLARE_HOOKED_METHOD(CreateMove, bool, void *, float, CUserCmd *);
 DECLARE_HOOKED_METHOD(LevelInit, void, void *, const char *);
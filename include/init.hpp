@@ -7,19 +7,48 @@
 
 #pragma once
 
+#include <initializer_list>
 #include <stack>
+#include <string>
+#include <vector>
 
-std::stack<void (*)()> &init_stack();
-std::stack<void (*)()> &init_stack_early();
+namespace startup
+{
+enum thread_class
+{
+    // Registers callbacks, hooks or otherwise talks to the engine
+    main_thread,
+    // Pure CPU work (parsing, decoding, scanning), may run on a worker next to the main thread ones
+    any_thread
+};
+
+struct routine
+{
+    void (*func)();
+    // Whatever the routine was registered with, file:line of the registration otherwise
+    std::string name;
+    thread_class threads;
+    // Names of the routines that have to be done before this one starts
+    std::vector<std::string> after;
+};
+
+// Runs and pops every routine on stack. Main thread routines keep their order, the rest start as soon as their dependencies are done.
+// Prints how long each one took in the end
+void Run(std::stack<routine> &stack, const char *what);
+} // namespace startup
+
+std::stack<startup::routine> &init_stack();
+std::stack<startup::routine> &init_stack_early();
 
 class InitRoutine
 {
 public:
-    InitRoutine(void (*func)());
+    InitRoutine(void (*func)(), const char *file = __builtin_FILE(), int line = __builtin_LINE());
+    InitRoutine(const char *name, void (*func)(), startup::thread_class threads = startup::main_thread, std::initializer_list<const char *> after = {});
 };
 
 class InitRoutineEarly
 {
 public:
-    InitRoutineEarly(void (*func)());
+    InitRoutineEarly(void (*func)(), const char *file = __builtin_FILE(), int line = __builtin_LINE());
 };
@@ -16,6 +16,7 @@
 #include <time.h>
 
 class CatCommand;
+class Vector;
 
 namespace ipc
 {
@@ -29,15 +30,28 @@ constexpr unsigned execute_client_cmd_long = 3;
 constexpr unsigned move_to_vector          = 4;
 constexpr unsigned stop_moving             = 5;
 constexpr unsigned start_moving            = 6;
+// Payload is the name of a shared memory object holding a compiled settings profile
+constexpr unsigned load_profile = 7;
 } // namespace commands
 
-constexpr unsigned cathook_magic_number = 0x0DEADCA7;
+// Doubles as the layout version, bump it whenever server_data_s or user_data_s change shape
+constexpr unsigned cathook_magic_number = 0x0DEADCA8;
 
 struct server_data_s
 {
     unsigned magic_number;
 };
 
+// Parts of user_data_s, user_data_s::changed tells which of them the last sequence bump touched
+enum user_data_fields : unsigned
+{
+    UD_IDENTITY    = 1 << 0, // name, friendid, textmode, ts_injected
+    UD_CONNECTION  = 1 << 1, // connected and the connect/disconnect times
+    UD_ACCUMULATED = 1 << 2,
+    UD_INGAME      = 1 << 3,
+    UD_CLAIM       = 1 << 4
+};
+
 struct user_data_s
 {
     char name[32];
@@ -91,6 +105,32 @@ struct user_data_s
         char server[24];
         char mapname[32];
     } ingame;
+
+    // Goal this bot is heading for, other bots on the server avoid picking the same one
+    struct
+    {
+        unsigned type; // claims::claim_type
+        float x;
+        float y;
+        float z;
+        time_t refreshed;
+    } claim;
+
+    // Bumped after every change except the heartbeat, readers can skip peers whose sequence didn't move
+    uint32_t sequence;
+    unsigned changed; // user_data_fields
+};
+
+// Snapshots our user_data_s and publishes whatever changed in it once the scope ends
+class publish_scope
+{
+public:
+    explicit publish_scope(user_data_s &data);
+    ~publish_scope();
+
+private:
+    user_data_s &data;
+    user_data_s before;
 };
 
 using peer_t = cat_ipc::Peer<server_data_s, user_data_s>;
@@ -104,6 +144,25 @@ void UpdateTemporaryData();
 void UpdateServerAddress(bool shutdown = false);
 void StoreClientData();
 void UpdatePlayerlist();
+
+namespace claims
+{
+enum claim_type : unsigned
+{
+    none = 0,
+    health,
+    ammo,
+    sniper_spot,
+    building_spot
+};
+
+void Set(claim_type type, const Vector &location);
+// Keeps the current claim alive
+void Refresh();
+void Clear();
+// Did a bot on our server and team claim something of this type within radius of location?
+bool ClaimedByOthers(claim_type type, const Vector &location, float radius);
+} // namespace claims
 } // namespace ipc
 
 #endif
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "config.h"
+
+#if ENABLE_IPC
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ipc.hpp"
+
+/*
+ *  Typed messages between IPC peers without going through the SimpleIPC command slots.
+ *  Every peer owns an inbox ring in a shared segment next to the IPC server, any peer can push into it without locking.
+ *  Inboxes are drained every frame instead of every second.
+ */
+
+namespace ipc::channel
+{
+constexpr uint32_t MAGIC        = 0x4e484343; // "CCHN"
+constexpr uint32_t VERSION      = 1;
+constexpr uint32_t RING_SIZE    = 64; // Power of two
+constexpr uint32_t MESSAGE_SIZE = 240;
+
+struct message_s
+{
+    // One of ipc::commands
+    uint16_t type;
+    uint16_t size;
+    uint32_t sender;
+    // CLOCK_MONOTONIC
+    int64_t sent_ns;
+    char data[MESSAGE_SIZE];
+};
+
+struct slot_s
+{
+    // Bounded MPSC queue: equals the ring position when free, position + 1 once the message is complete
+    std::atomic<uint32_t> sequence;
+    message_s message;
+};
+
+struct inbox_s
+{
+    // Pid of the peer draining this inbox, 0 if it doesn't use the channel. Senders fall back to SimpleIPC then
+    std::atomic<int32_t> owner;
+    std::atomic<uint32_t> tail; // Reserved by senders
+    uint32_t head;              // Only the owner touches this
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> delivered;
+    std::atomic<int64_t> latency_ns; // Running average, written by the owner
+    slot_s slots[RING_SIZE];
+};
+
+struct segment_s
+{
+    std::atomic<uint32_t> state; // 0 fresh, 1 being set up, 2 ready
+    uint32_t magic;
+    uint32_t version;
+    inbox_s inboxes[cat_ipc::max_peers];
+};
+
+typedef std::function<void(const message_s &)> handler_t;
+
+// Called by ipc_connect/ipc_disconnect, each IPC server gets its own segment
+bool Connect(const std::string &server);
+void Disconnect();
+
+// Messages to send together, Send() puts all of them into each inbox in one pass
+struct batch_s
+{
+    std::vector<message_s> messages{};
+
+    void add(uint16_t type, const void *data, size_t size);
+    template <typename T> void add(uint16_t type, const T &value)
+    {
+        add(type, &value, sizeof(T));
+    }
+};
+
+void SetHandler(uint16_t type, handler_t handler);
+
+// Target -1 sends to every other live peer. False if the message doesn't fit or any inbox was full
+bool Send(int target, uint16_t type, const void *data, size_t size);
+bool Send(int target, const batch_s &batch);
+template <typename T> bool Send(int target, uint16_t type, const T &value)
+{
+    return Send(target, type, &value, sizeof(T));
+}
+
+// Console command on the target peer(s), goes through SimpleIPC if the channel is unavailable or the command too long
+void SendCommand(int target, const std::string &command);
+} // namespace ipc::channel
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "config.h"
+
+#if ENABLE_IPC
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ *  Playerlist states shared by every peer on the host, kept in a segment next to the IPC server.
+ *  A state set on one peer shows up on all others on their next tick, nothing has to be sent around.
+ *  Only the state is shared, colors and counters stay local.
+ */
+
+namespace ipc::shared_playerlist
+{
+constexpr uint32_t MAGIC    = 0x4C504843; // "CHPL"
+constexpr uint32_t VERSION  = 1;
+constexpr uint32_t CAPACITY = 8192; // Power of two
+
+struct slot_s
+{
+    // 0 while free, never changes once claimed
+    std::atomic<uint32_t> steamid;
+    std::atomic<uint32_t> state;
+    // Counts the writes to this slot
+    std::atomic<uint32_t> revision;
+};
+
+struct segment_s
+{
+    std::atomic<uint32_t> state; // 0 fresh, 1 being set up, 2 ready
+    uint32_t magic;
+    uint32_t version;
+    // Bumped after every slot write, peers only look at the slots when it moved
+    std::atomic<uint32_t> revision;
+    slot_s slots[CAPACITY];
+};
+
+// Called by ipc_connect/ipc_disconnect
+bool Connect(const std::string &server);
+void Disconnect();
+// Called by playerlist::ChangeState for every state that got applied locally
+void Publish(unsigned steamid, int state);
+} // namespace ipc::shared_playerlist
+
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "config.h"
+
+#if ENABLE_IPC
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "ipc.hpp"
+
+/*
+ *  Host wide scheduling of IPC peers, kept in a shared segment next to the IPC server.
+ *  Peers get balanced onto ipc.bot-chunks chunks, can be sent to the servers other peers play on,
+ *  and take a lease before expensive operations so a whole host doesn't load or compile at once.
+ */
+
+namespace ipc::scheduler
+{
+constexpr uint32_t MAGIC      = 0x48435343; // "CSCH"
+constexpr uint32_t VERSION    = 1;
+constexpr uint32_t MAX_LEASES = 16;
+
+enum operation : uint8_t
+{
+    // From starting a queue or connect until the first CreateMove on the new level
+    level_load = 0,
+    nav_compile,
+    OPERATION_COUNT
+};
+
+struct peer_s
+{
+    // Pid of the peer that owns this entry, 0 if unused
+    std::atomic<int32_t> owner;
+    std::atomic<int32_t> chunk;
+    // Server this peer is connecting to, counts towards that server until the peer shows up in its user data
+    char target[24];
+    std::atomic<int64_t> target_until_ms;
+};
+
+struct segment_s
+{
+    std::atomic<uint32_t> state; // 0 fresh, 1 being set up, 2 ready
+    uint32_t magic;
+    uint32_t version;
+    peer_s peers[cat_ipc::max_peers];
+    // Client id + 1 in the low 16 bits, CLOCK_MONOTONIC ms the lease runs out at above that. 0 is free
+    std::atomic<uint64_t> leases[OPERATION_COUNT][MAX_LEASES];
+};
+
+// Called by ipc_connect/ipc_disconnect
+bool Connect(const std::string &server);
+void Disconnect();
+
+// Chunk for the ipc autoexec, client id based if the scheduler is unavailable
+int Chunk();
+
+// Takes one of the leases for op, true if we may go ahead. Leases run out by themselves after hold_ms
+bool TryBegin(operation op, unsigned hold_ms);
+// Same, but waits up to timeout_ms for a lease and goes ahead anyway after that. Blocks, so neither the game thread nor the job pool should call it
+void Begin(operation op, unsigned hold_ms, unsigned timeout_ms);
+void End(operation op);
+} // namespace ipc::scheduler
+
+#endif
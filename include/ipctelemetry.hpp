@@ -0,0 +1,121 @@
+#pragma once
+
+#include "config.h"
+
+#if ENABLE_IPC
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "ipc.hpp"
+#include "hitrate.hpp"
+#include "memtrack.hpp"
+
+/*
+ *  Performance samples of every bot on an IPC server, for a collector outside the game.
+ *  Each peer appends one sample per interval to its own ring in a shared segment next to the IPC server, writing never takes a lock or a syscall.
+ *  Everything below the bot section is plain data so the collector only needs this header, hitrate.hpp for the bucket counts and memtrack.hpp for the tags
+ */
+
+namespace ipc::telemetry
+{
+constexpr uint32_t MAGIC     = 0x4d4c5443; // "CTLM"
+constexpr uint32_t VERSION   = 5;
+constexpr uint32_t RING_SIZE = 64; // Power of two
+
+inline std::string SegmentName(const std::string &server)
+{
+    return "/cathook-telemetry-" + server;
+}
+
+// Counts and times cover the interval since the previous sample
+struct sample_s
+{
+    // CLOCK_MONOTONIC
+    int64_t time_ns;
+    uint32_t interval_ms;
+    uint32_t ticks;
+    // Whole CreateMove, including the original and engine prediction
+    uint32_t tick_p50_us;
+    uint32_t tick_p90_us;
+    uint32_t tick_p99_us;
+    uint32_t tick_max_us;
+    uint16_t players;
+    uint16_t entities; // Highest entity index
+    uint16_t projectiles;
+    uint16_t buildings;
+    uint32_t path_solves;
+    uint32_t path_solve_us; // Sum over all solves
+    uint32_t repaths;
+    uint32_t traces;
+    uint32_t traces_max_tick; // Traces between two ticks, draw included
+    // Bytes malloc has handed out, mmapped chunks included
+    uint64_t heap_bytes;
+    // Live kB of each memtrack::tag at sampling time
+    uint32_t memory_kb[memtrack::TAG_COUNT];
+    uint8_t ingame;
+    // governor::level at sampling time and the highest one during the interval
+    uint8_t quality_level;
+    uint8_t quality_max;
+    // By hitrate::weapon_class and distance bucket
+    uint16_t shots[hitrate::WEAPON_CLASSES][hitrate::DISTANCE_BUCKETS];
+    uint16_t hits[hitrate::WEAPON_CLASSES][hitrate::DISTANCE_BUCKETS];
+    uint16_t headshots[hitrate::WEAPON_CLASSES][hitrate::DISTANCE_BUCKETS];
+    uint16_t time_to_hit[hitrate::WEAPON_CLASSES][hitrate::TIME_BUCKETS];
+    // Drawn frames and our share of them, zero in textmode. Stages are begin, draw and end visuals, then the CPU and GPU side of the flush
+    uint32_t frames;
+    uint32_t frames_over_budget;
+    uint32_t frame_p50_us[5];
+    uint32_t frame_p99_us[5];
+};
+
+struct record_s
+{
+    // Odd while the bot writes this record
+    std::atomic<uint32_t> sequence;
+    // Which sample of the ring this is, records get reused every RING_SIZE samples
+    uint64_t index;
+    sample_s sample;
+};
+
+struct ring_s
+{
+    // Pid of the peer writing this ring, 0 if the slot is unused
+    std::atomic<int32_t> owner;
+    // Samples written so far, the newest is at (written - 1) % RING_SIZE
+    std::atomic<uint64_t> written;
+    record_s records[RING_SIZE];
+};
+
+struct segment_s
+{
+    std::atomic<uint32_t> state; // 0 fresh, 1 being set up, 2 ready
+    uint32_t magic;
+    uint32_t version;
+    // Indexed by IPC client id
+    ring_s rings[cat_ipc::max_peers];
+};
+
+// Collector side. Copies sample number index of the ring, false if it was overwritten or is being written right now
+inline bool Read(const ring_s &ring, uint64_t index, sample_s &out)
+{
+    uint64_t written = ring.written.load(std::memory_order_acquire);
+    if (index >= written || written - index > RING_SIZE)
+        return false;
+    const record_s &record = ring.records[index & (RING_SIZE - 1)];
+    uint32_t sequence      = record.sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+        return false;
+    uint64_t copied = record.index;
+    out             = record.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // The bot may have lapped the ring while we copied
+    return record.sequence.load(std::memory_order_relaxed) == sequence && copied == index;
+}
+
+// Bot side, called by ipc_connect/ipc_disconnect
+bool Connect(const std::string &server);
+void Disconnect();
+} // namespace ipc::telemetry
+
+#endif
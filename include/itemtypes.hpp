@@ -139,6 +139,7 @@ enum k_EItemType
 };
 
 class CachedEntity;
+struct model_t;
 typedef bool (*ItemCheckerFn)(CachedEntity *);
 typedef k_EItemType (*ItemSpecialMapperFn)(CachedEntity *);
 
@@ -158,8 +159,12 @@ public:
     ItemManager();
     void RegisterModelMapping(std::string path, k_EItemType type);
     void RegisterSpecialMapping(ItemCheckerFn fn, k_EItemType type);
+    // Cached per model and class, the first entity with them goes through Classify
     k_EItemType GetItemType(CachedEntity *ent);
+    k_EItemType Classify(CachedEntity *ent);
 
+    // Model pointer above the class id, ItemManager gets rebuilt every level so the pointers stay valid
+    std::unordered_map<uint64_t, k_EItemType> cache;
     std::unordered_map<ItemCheckerFn, k_EItemType> special_map;
     std::vector<ItemSpecialMapperFn> specials;
     ItemModelMapper mapper_special;
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <functional>
+
+// Shared job system so saves, reloads and level data building don't hitch the game thread
+namespace jobs
+{
+typedef std::function<void()> job_t;
+
+// Runs on the game thread from Paint, as many as fit into the per-tick time budget (at least one per tick)
+void Defer(job_t job);
+// Runs on the background pool. Don't touch game state from these, Defer() the result back instead
+void Background(job_t job);
+// Waits for running background jobs and drops everything that hasn't started yet
+void Shutdown();
+} // namespace jobs
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+class KeyValues;
+
+/*
+ * Prebuilt KeyValues for messages that get sent over and over. ServerCmdKeyValues takes ownership of whatever it gets,
+ * so every send is a copy of the template with only the values patched in. That skips the key lookups, path parsing and
+ * node creation SetInt and friends do for missing keys. The nodes themselves come from the engine's KeyValuesSystem pool
+ */
+class kv_template
+{
+public:
+    // build runs once on first use and sets every key the messages patch, with its default value
+    kv_template(const char *name, std::function<void(KeyValues *)> build);
+    ~kv_template();
+
+    class message
+    {
+    public:
+        message(const message &) = delete;
+        message &operator=(const message &) = delete;
+        ~message();
+
+        message &Int(const char *key, int value);
+        message &Float(const char *key, float value);
+        // The engine deletes it once it's sent
+        void Send();
+
+    private:
+        friend class kv_template;
+        message(const kv_template &owner, KeyValues *root);
+
+        const kv_template &m_owner;
+        KeyValues *m_root;
+        // Top level keys in the order build created them
+        KeyValues *m_keys[16];
+    };
+    message Make();
+
+private:
+    const char *m_name;
+    std::function<void(KeyValues *)> m_build;
+    KeyValues *m_template{ nullptr };
+    std::vector<const char *> m_key_names;
+
+    int Index(const char *key) const;
+};
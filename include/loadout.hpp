@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+class CachedEntity;
+
+// What every player carries, rebuilt only when their m_hMyWeapons changes. HasWeapon/getWeaponByID read this
+namespace loadout
+{
+constexpr int MAX_WEAPONS = 48;
+// Item definition filter, a hit still needs the list to confirm it
+constexpr int FILTER_BITS = 512;
+
+struct loadout_s
+{
+    // Handles were compared against the player on this tick
+    unsigned long tick{ 0 };
+    // m_hMyWeapons as of the last rebuild
+    int handle_count{ 0 };
+    int handles[MAX_WEAPONS]{};
+    // Set if a weapon wasn't networked yet, rebuilds again next tick
+    bool incomplete{ false };
+    int count{ 0 };
+    int idx[MAX_WEAPONS]{};
+    int item_definition[MAX_WEAPONS]{};
+    int weapon_id[MAX_WEAPONS]{};
+    uint64_t item_filter[FILTER_BITS / 64]{};
+
+    bool Has(int item_definition) const;
+    // Entity index, -1 if the player doesn't own it
+    int Find(int weapon_id) const;
+};
+
+// nullptr for anything that isn't a good player
+const loadout_s *Get(CachedEntity *player);
+} // namespace loadout
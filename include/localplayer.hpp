@@ -11,19 +11,42 @@
 #include <enums.hpp>
 
 class CachedEntity;
+class IClientEntity;
+namespace projectile_table
+{
+struct params_s;
+}
+
+// Everything about the held weapon that only changes when another weapon gets pulled out, rebuilt by LocalPlayer::Update
+struct weapon_profile_s
+{
+    // Only trust this while tick matches tickcount
+    unsigned long tick{ 0 };
+    int handle{ 0 };
+    int item_definition{ -1 };
+    int idx{ -1 };
+    int class_id{ 0 };
+    IClientEntity *raw{ nullptr };
+    weaponmode mode{ weapon_invalid };
+    // GetProjectileData for weapons that don't charge, charged ones only redo the charge every call
+    const projectile_table::params_s *projectile_params{ nullptr };
+    bool projectile{ false };
+    bool charged{ false };
+    float projectile_speed{ 0.0f };
+    float projectile_gravity{ 0.0f };
+    float projectile_start_velocity{ 0.0f };
+    bool rapid_fire{ false };
+    bool sniper_rifle{ false };
+    bool ambassador{ false };
+    bool sapper{ false };
+};
 
 class LocalPlayer
 {
     unsigned long melee_damagetick = 0;
+    void UpdateWeaponProfile(CachedEntity *wep);
 
 public:
-    enum SpectatorState
-    {
-        NONE,
-        THIRDPERSON,
-        FIRSTPERSON
-    };
-
     // Start of CM
     void Update();
     // End of CM
@@ -38,6 +61,9 @@ public:
     bool holding_sniper_rifle;
     bool holding_sapper;
     weaponmode weapon_mode;
+    weapon_profile_s weapon_profile;
+    // Swing range of the held melee weapon this tick, shield charges change it
+    float melee_range{ 0.0f };
     bool using_action_slot_item{ false };
 
     Vector v_ViewOffset;
@@ -46,12 +72,13 @@ public:
     int entity_idx;
     CachedEntity *entity{ 0 };
     CachedEntity *weapon();
+    // weapon_profile when it was built this tick, asks the weapon otherwise
+    bool holdingAmbassador();
     bool weapon_melee_damage_tick;
     Vector v_OrigViewangles;
     Vector v_SilentAngles;
     bool bUseSilentAngles;
     bool bAttackLastTick;
-    SpectatorState spectator_state;
 
     bool isFakeAngleCM = false;
     Vector realAngles{ 0.0f, 0.0f, 0.0f };
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+/*
+ *  Memory per subsystem, for finding out what grows in bots that run for days.
+ *  Containers that can take an allocator use resource(tag) and get counted exactly,
+ *  everything else reports its capacity whenever the numbers get read.
+ *  The tags are plain data so the telemetry collector can use them too
+ */
+
+namespace memtrack
+{
+enum tag : uint8_t
+{
+    // Level arena chunks, see core/levelarena.hpp
+    tag_level = 0,
+    tag_backtrack,
+    tag_esp,
+    tag_walkbot,
+    TAG_COUNT
+};
+
+inline const char *Name(tag t)
+{
+    static const char *const names[] = { "level", "backtrack", "esp", "walkbot" };
+    static_assert(sizeof(names) / sizeof(names[0]) == TAG_COUNT, "Every tag needs a name");
+    return t < TAG_COUNT ? names[t] : "?";
+}
+
+struct stats_s
+{
+    // Allocated through resource(tag) and not freed yet
+    std::atomic<int64_t> tracked{ 0 };
+    // Sum of the reporters at the last Update()
+    std::atomic<int64_t> reported{ 0 };
+    std::atomic<int64_t> peak{ 0 };
+    // Through resource(tag) only, reported memory has no notion of allocations
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> allocated_bytes{ 0 };
+
+    int64_t Live() const
+    {
+        return tracked.load(std::memory_order_relaxed) + reported.load(std::memory_order_relaxed);
+    }
+};
+extern stats_s stats[TAG_COUNT];
+
+// Counts into the tag, then hands the allocation to the heap. Thread safe
+std::pmr::memory_resource *resource(tag t);
+// Capacity of memory that can't go through a resource, in bytes. Only called on the game thread
+void Report(tag t, size_t (*bytes)());
+// Runs the reporters and updates the peaks
+void Update();
+} // namespace memtrack
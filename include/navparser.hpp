@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include "mathlib/vector.h"
 
 class CNavFile;
@@ -28,10 +31,28 @@ extern bool ReadyForCommands;
 // Ignore. For level init only
 extern std::atomic<init_status> status;
 
+// Running totals for telemetry, async repaths are solved on the job pool
+struct stats_s
+{
+    std::atomic<uint64_t> solves{ 0 };
+    std::atomic<uint64_t> solve_ns{ 0 };
+    std::atomic<uint64_t> repaths{ 0 };
+};
+extern stats_s stats;
+// Connections currently ignored, walks every connection so keep it out of hot paths
+size_t ignoredConnections();
+
 // Nav to vector
 bool navTo(const Vector &destination, int priority = 5, bool should_repath = true, bool nav_to_local = true, bool is_repath = false);
 // Find closest to vector area
 CNavArea *findClosestNavSquare(const Vector &vec);
+// Area origin is on, or the one with the closest center. No vischecks and no stuck detection, for things other than the local player.
+// Pass the area it was on last time to make that a lot cheaper
+CNavArea *findArea(const Vector &origin, CNavArea *previous = nullptr);
+// Same, but nullptr instead of the closest center when origin isn't on the mesh
+CNavArea *findAreaOn(const Vector &origin, CNavArea *previous = nullptr);
+// Path cost from start to each of targets in a single search, INFINITY where there is no path
+std::vector<float> pathDistances(CNavArea *start, const std::vector<CNavArea *> &targets);
 // Check and init navparser
 bool prepare();
 // Clear current path
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include "HookTools.hpp"
+
+class INetMessage;
+
+/*
+ * Outgoing net messages go through here from the SendNetMsg hook. The type is resolved once per message and only the
+ * subscribers of that type see it, so clc_Move doesn't wander past modules that only want key values.
+ */
+
+namespace net_messages
+{
+struct outgoing_s
+{
+    INetMessage &msg;
+    int type;
+    // Subscribers can only turn this on
+    bool force_reliable;
+};
+
+// True when the later subscribers of the type shouldn't see the message anymore
+typedef std::function<bool(outgoing_s &)> callback_t;
+
+// Lower priorities run first, equal ones in the order they subscribed
+void Subscribe(int type, callback_t callback, enum EC::ec_priority priority = EC::average);
+void Dispatch(outgoing_s &message);
+} // namespace net_messages
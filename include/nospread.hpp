@@ -1,11 +1,11 @@
 #pragma once
 #include "common.hpp"
+#include "usermessages.hpp"
 
 namespace hacks::tf2::nospread
 {
 extern bool is_syncing;
-bool SendNetMessage(INetMessage *);
 void SendNetMessagePost();
-bool DispatchUserMessage(bf_read *, int);
+bool DispatchUserMessage(const usermessages::message_s &message);
 void CL_SendMove_hook();
 } // namespace hacks::tf2::nospread
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "mathlib/vector.h"
+#include "teamroundtimer.hpp"
+
+class CNavArea;
+class CachedEntity;
+
+/*
+ * Round state and the map objectives. The objective resource, round timers and payload carts are looked up
+ * once per round, after that everything is read from their netvars once per tick.
+ */
+
+namespace objectives
+{
+constexpr int MAX_CONTROL_POINTS = 8;
+
+struct control_point_s
+{
+    Vector origin;
+    // nullptr until the nav mesh is loaded
+    CNavArea *area;
+    int owner;
+    // Team on the point right now, 0 if nobody is capturing
+    int capping_team;
+    bool locked;
+    // 1 << team for every team that can capture it right now, points it depends on included
+    uint8_t capturable_by;
+};
+
+struct cart_s
+{
+    CachedEntity *ent;
+    int team;
+    // Last known position if it went dormant
+    Vector origin;
+    CNavArea *area;
+};
+
+enum objective_kind : uint8_t
+{
+    OBJECTIVE_NONE = 0,
+    // Take a point we can capture
+    OBJECTIVE_CAPTURE,
+    // Stand on one of ours the enemy can capture
+    OBJECTIVE_DEFEND,
+    // Push our cart
+    OBJECTIVE_PUSH,
+    // Stop the enemy cart
+    OBJECTIVE_BLOCK
+};
+
+struct objective_s
+{
+    objective_kind kind;
+    // Control point index or cart entity index
+    int index;
+    Vector origin;
+    CNavArea *area;
+};
+
+struct round_s
+{
+    round_states state;
+    // Seconds left on the timer the HUD shows, -1 without one
+    float time_left;
+    int setup_length;
+    // Entity index of that timer, 0 if there is none
+    int timer;
+};
+
+extern control_point_s control_points[MAX_CONTROL_POINTS];
+extern int control_point_count;
+extern std::vector<cart_s> carts;
+extern round_s round_info;
+// For the local player's team
+extern objective_s current_objective;
+
+inline const objective_s &Current()
+{
+    return current_objective;
+}
+inline const round_s &Round()
+{
+    return round_info;
+}
+} // namespace objectives
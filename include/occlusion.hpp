@@ -0,0 +1,11 @@
+#pragma once
+
+#include "public/mathlib/vector.h"
+
+// Static world occlusion from the map's PVS, built once per level on a worker thread
+namespace occlusion
+{
+// True means world geometry is guaranteed to block every line between a and b.
+// False means "don't know", do a real trace
+bool DefinitelyOccluded(const Vector &a, const Vector &b);
+} // namespace occlusion
@@ -48,6 +48,8 @@ struct userdata
 };
 
 extern std::unordered_map<unsigned, userdata> data;
+// Bumped whenever entries get erased, references into data from before are stale then
+extern unsigned generation;
 
 void Save();
 void Load();
@@ -30,6 +30,27 @@ public:
     bool isAlive(int idx);
 
     int entity;
+
+private:
+    // Slots copied out of the resource entity, enough for every index a getter accepts
+    static constexpr int SLOTS = 64;
+    // Copy of the resource entity's arrays, refreshed by Update() so the getters don't have to look the entity up
+    struct
+    {
+        bool valid;
+        int health[SLOTS];
+        int max_health[SLOTS];
+        int max_buffed_health[SLOTS];
+        int player_class[SLOTS];
+        int team[SLOTS];
+        int score[SLOTS];
+        int kills[SLOTS];
+        int deaths[SLOTS];
+        int level[SLOTS];
+        int damage[SLOTS];
+        int ping[SLOTS];
+        bool alive[SLOTS];
+    } data{};
 };
 
 extern TFPlayerResource *g_pPlayerResource;
@@ -13,6 +13,7 @@
 #include <optional>
 #include "interfaces.hpp"
 #include "sdk.hpp"
+#include "usercmd.hpp"
 
 #pragma once
 
@@ -27,10 +28,34 @@ Vector BuildingPrediction(CachedEntity *building, Vector vec, float speed, float
 Vector ProjectilePrediction(CachedEntity *ent, int hb, float speed, float gravitymod, float entgmod, float proj_startvelocity = 0.0f);
 Vector ProjectilePrediction_Engine(CachedEntity *ent, int hb, float speed, float gravitymod, float entgmod /* ignored */, float proj_startvelocity = 0.0f);
 
-std::vector<Vector> Predict(Vector pos, float offset, Vector vel, Vector acceleration, std::pair<Vector, Vector> minmax, float time, int count, bool vischeck = true);
+// Fills out with count positions at start, start + steplength, ... Ground gets traced when the path crosses the last known ground height
+// (and every few steps while on it), grounddistance seeds it so the first steps don't need a trace
+void PredictPath(const Vector &pos, const Vector &vel, const Vector &acceleration, const std::pair<Vector, Vector> &minmax, float start, float steplength, int count, Vector *out, bool vischeck = true, std::optional<float> grounddistance = std::nullopt);
 Vector PredictStep(Vector pos, Vector &vel, Vector acceleration, std::pair<Vector, Vector> &minmax, float time, float steplength = g_GlobalVars->interval_per_tick, bool vischeck = true, std::optional<float> grounddistance = std::nullopt);
 float PlayerGravityMod(CachedEntity *player);
 
+// Runs the game's movement code on an entity for as many steps as needed, everything gets restored once when the session ends
+class EnginePredictionSession
+{
+public:
+    explicit EnginePredictionSession(CachedEntity *entity);
+    ~EnginePredictionSession();
+    EnginePredictionSession(const EnginePredictionSession &) = delete;
+    EnginePredictionSession &operator=(const EnginePredictionSession &) = delete;
+
+    // Simulates count steps of steplength seconds, every intermediate position goes into out if set. Returns the last one
+    Vector Step(float steplength, int count = 1, Vector *out = nullptr);
+
+private:
+    CachedEntity *entity;
+    CUserCmd cmd{};
+    CUserCmd *original_cmd{ nullptr };
+    Vector old_origin;
+    Vector old_angles;
+    float old_frametime;
+    float old_curtime;
+};
+
 Vector EnginePrediction(CachedEntity *player, float time);
 #if ENABLE_VISUALS
 void Prediction_PaintTraverse();
@@ -0,0 +1,33 @@
+#pragma once
+
+class CachedEntity;
+
+// Launch parameters of every projectile weapon, looked up once per weapon switch instead of a switch per call
+namespace projectile_table
+{
+struct params_s
+{
+    int class_id;
+    // -1 for every item of the class, specific items win over it
+    int item_definition;
+    float speed;
+    float gravity;
+    float start_velocity;
+    // Charging weapons go linearly from speed/gravity to these over charge_time seconds
+    float charge_time;
+    float charged_speed;
+    float charged_gravity;
+    // A charge begin time of 0 means not charging, instead of a charge since the start of the map
+    bool zero_uncharged;
+
+    bool Charged() const
+    {
+        return charge_time > 0.0f;
+    }
+    // Speed and gravity with the weapon's current charge
+    void Charge(CachedEntity *weapon, float &speed, float &gravity) const;
+};
+
+// nullptr for anything that doesn't fire a predictable projectile
+const params_s *Find(CachedEntity *weapon);
+} // namespace projectile_table
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <mathlib/vector.h>
+
+class CachedEntity;
+
+// Live projectiles of the current tick, shared by everything that reacts to them
+namespace projectile_tracker
+{
+struct projectile_s
+{
+    CachedEntity *entity;
+    int classid;
+    // Player that fired it, -1 if unknown
+    int owner;
+    bool enemy;
+    bool crit;
+    bool grenade;
+    // Only set for CTFGrenadePipebombProjectile
+    bool sticky;
+    bool deflected;
+    // Dormant projectiles keep their last known origin and no velocity
+    bool dormant;
+    Vector origin;
+    Vector velocity;
+
+    // Straight line extrapolation, good enough for the fraction of a second everything here looks ahead
+    Vector PositionAt(float time) const
+    {
+        return origin + velocity * time;
+    }
+    // Seconds until the projectile is closest to pos, 0 if it is already moving away
+    float TimeToClosestApproach(const Vector &pos) const;
+    // Distance at that point, looking no further than max_time ahead
+    float ClosestApproach(const Vector &pos, float max_time) const;
+};
+
+// Call once per tick after the entity cache updated
+void Update();
+const std::vector<projectile_s> &All();
+} // namespace projectile_tracker
@@ -65,6 +65,16 @@ public:
         setInternal(!value);
     }
 
+    void storeDefault() override
+    {
+        default_value = value;
+    }
+
+    void resetToDefault() override
+    {
+        setInternal(default_value);
+    }
+
 protected:
     void setInternal(bool next)
     {
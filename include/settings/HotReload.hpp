@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+/*
+ * Opt-in reloading of the loaded config whenever it changes on disk. The config directory is watched with inotify,
+ * the watch is read and the changed file parsed on the job pool, and only variables whose value differs get set.
+ */
+
+namespace settings::hot_reload
+{
+// File name inside the config directory, called by cat_load
+void Watch(const std::string &name);
+} // namespace settings::hot_reload
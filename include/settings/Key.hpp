@@ -71,6 +71,17 @@ public:
         setInternal(Key{});
     }
 
+    void storeDefault() override
+    {
+        default_value = value;
+    }
+
+    void resetToDefault() override
+    {
+        if (value.mouse != default_value.mouse || value.keycode != default_value.keycode)
+            setInternal(default_value);
+    }
+
     void key(SDL_Keycode key)
     {
         Key k{};
@@ -168,6 +179,14 @@ public:
     void fromString(const std::string &string) override
     {
     }
+
+    void storeDefault() override
+    {
+    }
+
+    void resetToDefault() override
+    {
+    }
     // Variable & causes segfault with gcc optimizations + these dont even
     // return anything
     void operator=(const std::string &string)
@@ -6,6 +6,7 @@
 
 #include <unordered_map>
 #include <vector>
+#include <string_view>
 #include "Settings.hpp"
 
 /*
@@ -45,7 +46,21 @@ public:
     void add(IVariable &me, std::string name);
     void add(IVariable &me, std::string name, std::string value);
     IVariable *lookup(const std::string &string);
+    void resetToDefaults();
+
+    // Map nodes never move, so the index can point straight into registered
+    typedef std::pair<const std::string *, VariableDescriptor *> index_entry;
+    typedef std::vector<index_entry>::const_iterator index_iterator;
+
+    // Every registered variable sorted by name, rebuilt on first use after add()
+    const std::vector<index_entry> &sorted();
+    // Range of sorted() whose names start with prefix
+    std::pair<index_iterator, index_iterator> withPrefix(std::string_view prefix);
 
     std::unordered_map<std::string, VariableDescriptor> registered{};
+
+private:
+    std::vector<index_entry> index{};
+    bool index_dirty{ true };
 };
 } // namespace settings
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * Compiled configs. Every entry is an index into Manager::sorted() followed by the typed value, so a load is
+ * a straight copy without any parsing. The header carries a checksum of the registry (names and types),
+ * a profile only loads into a build that registers exactly the same variables.
+ */
+
+namespace settings::profile
+{
+constexpr uint32_t MAGIC   = 0x50544143; // "CATP"
+constexpr uint32_t VERSION = 1;
+
+struct header_s
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t schema;
+    uint32_t count;
+    // Bytes of entries following the header
+    uint32_t size;
+};
+
+uint64_t Schema();
+// Like .conf files only variables that differ from their default get stored
+std::string Compile();
+// Resets everything to defaults first, same as loading a .conf
+bool Load(const void *data, size_t size);
+
+bool SaveTo(const std::string &path);
+bool LoadFrom(const std::string &path);
+} // namespace settings::profile
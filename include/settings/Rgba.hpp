@@ -49,6 +49,16 @@ public:
         setInternal(next);
     }
 
+    void storeDefault() override
+    {
+        default_value = value;
+    }
+
+    void resetToDefault() override
+    {
+        setInternal(default_value);
+    }
+
     inline void operator=(const rgba_t &rgba)
     {
         setInternal(rgba);
@@ -8,6 +8,10 @@
 #include <string>
 #include <functional>
 #include <atomic>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <type_traits>
 
 #if ENABLE_VISUALS
 #include <drawing.hpp>
@@ -60,6 +64,82 @@ public:
     // Const reference because every variable will cache the string value
     // instead of generating it every call
     virtual const std::string &toString() = 0;
+    // Remembers the current value as the default, resetToDefault restores it without parsing a string
+    virtual void storeDefault()   = 0;
+    virtual void resetToDefault() = 0;
+
+    // Bumped on every change, lets autosave skip saves that wouldn't write anything new
+    uint64_t version{ 0 };
+
+protected:
+    friend class CallbackBatch;
+    // Runs the callbacks a batch held back, with the value the variable ended up with
+    virtual void firePendingCallbacks() = 0;
+
+    bool callbacks_pending{ false };
+};
+
+// Holds back change callbacks until the outermost batch goes out of scope, then every changed variable fires its callbacks once.
+// Game thread only, used around config loads so callbacks don't run for every intermediate value
+class CallbackBatch
+{
+public:
+    CallbackBatch();
+    ~CallbackBatch();
+
+    static bool active();
+    static void defer(IVariable &variable);
+
+private:
+    static int depth;
+    static std::vector<IVariable *> pending;
+};
+
+// Copy of a variable's value for other threads. Plain values sit behind a seqlock and readers retry on a torn read,
+// everything else gets published as an immutable copy
+template <typename T, bool = std::is_trivially_copyable<T>::value> class Published
+{
+public:
+    void store(const T &next)
+    {
+        sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        value = next;
+        sequence.fetch_add(1, std::memory_order_release);
+    }
+    T load() const
+    {
+        while (true)
+        {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            T result        = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(before & 1) && sequence.load(std::memory_order_relaxed) == before)
+                return result;
+        }
+    }
+
+private:
+    // Odd while the game thread writes
+    std::atomic<uint32_t> sequence{ 0 };
+    T value{};
+};
+
+template <typename T> class Published<T, false>
+{
+public:
+    void store(const T &next)
+    {
+        std::atomic_store(&value, std::make_shared<const T>(next));
+    }
+    T load() const
+    {
+        auto current = std::atomic_load(&value);
+        return current ? *current : T{};
+    }
+
+private:
+    std::shared_ptr<const T> value{};
 };
 
 template <typename T> class VariableBase : public IVariable
@@ -71,20 +151,49 @@ public:
 
     virtual const T &operator*() = 0;
 
+    // Safe to call from any thread and never tears. Game thread code should keep using operator*, which doesn't copy
+    T load() const
+    {
+        return published.load();
+    }
+
     void installChangeCallback(std::function<void(VariableBase<T> &var, T after)> callback)
     {
-        callbacks.push_back(callback);
+        callbacks.push_back(std::move(callback));
     }
 
 protected:
-    void fireCallbacks(T next)
+    // Every setter calls this with the new value, so it doubles as the point where the value gets published
+    void fireCallbacks(const T &next)
     {
+        this->version++;
+        published.store(next);
+        if (callbacks.empty())
+            return;
+        if (CallbackBatch::active())
+        {
+            if (!this->callbacks_pending)
+            {
+                this->callbacks_pending = true;
+                CallbackBatch::defer(*this);
+            }
+            return;
+        }
         for (auto &c : callbacks)
             c(*this, next);
     }
 
+    void firePendingCallbacks() override
+    {
+        this->callbacks_pending = false;
+        T current = **this;
+        for (auto &c : callbacks)
+            c(*this, current);
+    }
+
     std::vector<std::function<void(VariableBase<T> &, T)>> callbacks{};
     T default_value{};
+    Published<T> published{};
 };
 
 template <typename T> class Variable
@@ -112,6 +221,15 @@ public:
     // T min{ std::numeric_limits<T>::min() };
     // T max{ std::numeric_limits<T>::max() };
 
+    void storeDefault() override
+    {
+        this->default_value = value;
+    }
+    void resetToDefault() override
+    {
+        set(this->default_value);
+    }
+
     virtual void set(T next)
     {
         // if (next < min) next = min;
@@ -5,8 +5,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
+#include <functional>
+#include <vector>
 #include "Manager.hpp"
 
 namespace settings
@@ -21,10 +24,22 @@ public:
 
     bool loadFromString(std::string stream);
 
+    typedef std::vector<std::pair<std::string, std::string>> values_t;
+    // Only parses, doesn't touch any variable, so it's fine off the game thread
+    bool parseFile(const std::string &path, values_t &out);
+    // Ends up where loading the file would, but only sets the variables whose value differs. Returns how many changed
+    size_t applyValues(const values_t &values);
+
 protected:
+    // Tokenizes a whole config in one pass
+    void parse(std::string_view data);
     void pushChar(char c);
     void finishString(bool complete);
-    void onReadKeyValue(std::string key, std::string value);
+    void onReadKeyValue(const std::string &key, const std::string &value);
+    typedef std::unordered_map<std::string, Manager::VariableDescriptor>::value_type registered_t;
+    // Variable a legacy key maps to, nullptr if it isn't one
+    registered_t *migrationTarget(const std::string &key);
+    std::string migrate(std::string key);
     bool reading_key{ true };
 
     bool escape{ false };
@@ -36,6 +51,8 @@ protected:
     std::string oss{};
     std::string stored_key{};
     std::ifstream stream{};
+    // parseFile collects into this instead of setting anything
+    values_t *collect{ nullptr };
     Manager &manager;
 };
 
@@ -44,14 +61,15 @@ class SettingsWriter
 public:
     explicit SettingsWriter(Manager &manager);
 
-    bool saveTo(std::string path, bool autosave = false);
+    // The file is written on the job pool, done runs on the game thread once it is on disk
+    bool saveTo(std::string path, bool autosave = false, std::function<void(bool)> done = nullptr);
 
 protected:
-    void write(std::string name, IVariable *variable);
-    void writeEscaped(std::string str);
+    void write(const std::string &name, IVariable *variable);
+    void writeEscaped(const std::string &str);
 
     bool only_changed{ false };
-    std::ofstream stream{};
+    std::string buffer{};
     Manager &manager;
 };
 } // namespace settings
@@ -30,9 +30,20 @@ public:
         return value;
     }
 
+    void storeDefault() override
+    {
+        default_value = value;
+    }
+
+    void resetToDefault() override
+    {
+        if (value != default_value)
+            fromString(default_value);
+    }
+
     inline void operator=(const std::string &string)
     {
-        fireCallbacks(std::string(string));
+        fireCallbacks(string);
         value = string;
     }
 
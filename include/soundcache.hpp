@@ -6,6 +6,7 @@
 
 namespace soundcache
 {
-std::optional<Vector> GetSoundLocation(int entid);
+// age gets the seconds since the sound and stamp when it was cached, only changes with a new sound
+std::optional<Vector> GetSoundLocation(int entid, float *age = nullptr, int64_t *stamp = nullptr);
 void cache_sound(const Vector *Origin, int source);
 } // namespace soundcache
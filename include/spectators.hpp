@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+// Who is spectating whom, read from every player's observer target and mode once per tick
+namespace spectators
+{
+// m_iObserverMode values
+enum observer_mode : int
+{
+    NONE = 0,
+    DEATHCAM,
+    FREEZECAM,
+    FIXED,
+    FIRSTPERSON,
+    THIRDPERSON,
+    POI,
+    FREECAM
+};
+
+struct spectator_s
+{
+    int idx;
+    int target;
+    observer_mode mode;
+};
+
+// Call once per tick after the local player updated
+void Update();
+// Everyone in an observer mode with a player as the target
+const std::vector<spectator_s> &All();
+// The ones watching us
+const std::vector<spectator_s> &Local();
+// FIRSTPERSON if anyone is in our eyes, THIRDPERSON if anyone is only chasing us, NONE otherwise and while we're dead
+observer_mode LocalState();
+// Player the entity index is watching, -1 if it isn't spectating a player
+int TargetOf(int idx);
+} // namespace spectators
@@ -9,4 +9,6 @@
 
 class CachedEntity;
 
-int GetScoreForEntity(CachedEntity *entity);
\ No newline at end of file
+int GetScoreForEntity(CachedEntity *entity);
+// Same scores for count entities at once, read from the entity snapshot inside CreateMove
+void GetScoresForEntities(CachedEntity *const *entities, int count, float *scores);
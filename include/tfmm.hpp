@@ -9,6 +9,21 @@
 
 namespace tfmm
 {
+// What the GC and the party client last said about matchmaking. Read once a second at most, and again right
+// away after we queue, leave, abandon or change level
+struct queue_state_s
+{
+    // False while the GC client system or the party client is missing
+    bool available{ false };
+    bool connected_to_match{ false };
+    bool live_match{ false };
+    // In the autoqueue.mode queue or queued for standby
+    bool in_queue{ false };
+    int pending_invites{ 0 };
+};
+const queue_state_s &queueState();
+// Extra delay between our queue attempts, different for every IPC peer so a host full of bots drifts apart
+unsigned queueStagger();
 
 void startQueue();
 void startQueueStandby();
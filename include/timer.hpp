@@ -8,17 +8,33 @@
 #ifndef CH_TIMER_HPP
 #define CH_TIMER_HPP
 #include <chrono>
+#include <atomic>
 
 class Timer
 {
 public:
-    typedef std::chrono::system_clock clock;
+    // Monotonic, so wall clock changes can't fire or freeze timers
+    typedef std::chrono::steady_clock clock;
+    static constexpr bool PRECISE = true;
+
+    // One sample at the start of every CreateMove, Paint and Draw, shared by every timer that isn't precise
+    static inline clock::time_point Now()
+    {
+        clock::rep sampled = coarse_now.load(std::memory_order_relaxed);
+        return sampled ? clock::time_point(clock::duration(sampled)) : clock::now();
+    }
+    static inline void Sample()
+    {
+        coarse_now.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
 
     inline Timer(){};
+    // For timers that have to move within one tick or frame
+    inline explicit Timer(bool precise) : precise(precise){};
 
     inline bool check(unsigned ms) const
     {
-        return std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - last).count() >= ms;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now() - last).count() >= ms;
     }
     inline bool test_and_set(unsigned ms)
     {
@@ -31,10 +47,19 @@ public:
     }
     inline void update()
     {
-        last = clock::now();
+        last = now();
     }
 
 public:
     std::chrono::time_point<clock> last{};
+
+private:
+    static inline std::atomic<clock::rep> coarse_now{ 0 };
+    bool precise{ false };
+
+    inline clock::time_point now() const
+    {
+        return precise ? clock::now() : Now();
+    }
 };
 #endif
@@ -7,40 +7,66 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <engine/IEngineTrace.h>
 
 // This file is a mess. I need to fix it. TODO
 
 class IClientEntity;
+class CachedEntity;
 
 namespace trace
 {
 
-class FilterDefault : public ITraceFilter
+// Behaviour bits for FilterMask, combine these instead of writing yet another filter class
+enum filter_flags : unsigned
+{
+    FILTER_IGNORE_SELF         = 1 << 0,
+    FILTER_IGNORE_INVISIBLE    = 1 << 1, // Respawn room visualizers, medigun shields, areaportal windows
+    FILTER_IGNORE_PLAYERS      = 1 << 2, // Also ignores the player resource
+    FILTER_SNIPER_TEAMMATES    = 1 << 3, // Sniper rifles can shoot through teammates
+    FILTER_WORLD_ONLY          = 1 << 4, // Only hit the world, props, doors and the like
+    FILTER_IGNORE_FIRST_PLAYER = 1 << 5  // Ignore the first player the ray touches, for penetration checks
+};
+
+// ShouldHitEntity() gets called for every entity a ray touches, so everything it needs
+// is either precomputed in SetSelf() or read from the class table/entity cache snapshot
+class FilterMask : public ITraceFilter
 {
 public:
     IClientEntity *m_pSelf;
+    IClientEntity *m_pIgnoreFirst;
+    unsigned m_flags;
 
 public:
-    virtual ~FilterDefault();
-    FilterDefault();
+    FilterMask(unsigned flags);
+    virtual ~FilterMask();
     virtual bool ShouldHitEntity(IHandleEntity *entity, int mask);
     void SetSelf(IClientEntity *self);
+    // Forget the player ignored by FILTER_IGNORE_FIRST_PLAYER
+    void Reset();
     virtual TraceType_t GetTraceType() const;
+
+private:
+    int m_iSelfTeam;
+    bool m_bSelfSniper;
 };
 
-class FilterNoPlayer : public ITraceFilter
+class FilterDefault : public FilterMask
 {
 public:
-    IClientEntity *m_pSelf;
+    FilterDefault();
+};
 
+class FilterNoPlayer : public FilterMask
+{
 public:
-    virtual ~FilterNoPlayer();
     FilterNoPlayer();
-    virtual bool ShouldHitEntity(IHandleEntity *entity, int mask);
+    // Keeps the previous self when passed nullptr, unlike FilterMask::SetSelf
     void SetSelf(IClientEntity *self);
-    virtual TraceType_t GetTraceType() const;
 };
+
 class FilterNavigation : public ITraceFilter
 {
 
@@ -51,32 +77,16 @@ public:
     virtual TraceType_t GetTraceType() const;
 };
 
-class FilterNoEntity : public ITraceFilter
+class FilterNoEntity : public FilterMask
 {
 public:
-    IClientEntity *m_pSelf;
-
-public:
-    virtual ~FilterNoEntity();
     FilterNoEntity();
-    virtual bool ShouldHitEntity(IHandleEntity *entity, int mask);
-    void SetSelf(IClientEntity *self);
-    virtual TraceType_t GetTraceType() const;
 };
 
-class FilterPenetration : public ITraceFilter
+class FilterPenetration : public FilterMask
 {
 public:
-    IClientEntity *m_pSelf;
-    IClientEntity *m_pIgnoreFirst;
-
-public:
-    virtual ~FilterPenetration();
     FilterPenetration();
-    virtual bool ShouldHitEntity(IHandleEntity *entity, int mask);
-    void SetSelf(IClientEntity *self);
-    void Reset();
-    virtual TraceType_t GetTraceType() const;
 };
 
 extern FilterDefault filter_default;
@@ -84,4 +94,60 @@ extern FilterNoPlayer filter_no_player;
 extern FilterNavigation filter_navigation;
 extern FilterNoEntity filter_no_entity;
 extern FilterPenetration filter_penetration;
+
+// Every trace cathook does goes through here, rays counts them for telemetry. Traces also run on the job pool
+extern std::atomic<uint32_t> rays;
+void TraceRay(const Ray_t &ray, unsigned int mask, ITraceFilter *filter, trace_t *trace);
+
+// A set of visibility queries from the local player against one entity, all using filter_default and the same mask.
+// Queries are ordered cheapest-to-succeed first so "any visible" checks can stop after as few traces as possible
+class Batch
+{
+public:
+    static constexpr int MAX_QUERIES = 64;
+
+    struct Query
+    {
+        Vector end;
+        // Hitbox id for AddHitbox(), caller defined otherwise
+        int id;
+        bool hitbox;
+        bool pinned;
+        float fov;
+        bool done;
+        bool visible;
+    };
+
+    Batch(CachedEntity *target, unsigned mask = MASK_SHOT_HULL, bool use_weapon_offset = true);
+
+    // Pinned queries are always traced first, in the order they were added
+    void Add(const Vector &end, int id, bool pinned = false);
+    // Goes through the hitbox cache so results are shared with VisibilityCheck()
+    void AddHitbox(int hitbox, bool pinned = false);
+
+    // Id of the first visible query, -1 if none are visible
+    int AnyVisible();
+    // Traces everything, results are in queries()
+    void All();
+
+    Query *queries()
+    {
+        return m_queries;
+    }
+    int size() const
+    {
+        return m_count;
+    }
+
+private:
+    void Sort();
+    bool Run(Query &query);
+
+    CachedEntity *m_target;
+    unsigned m_mask;
+    bool m_use_weapon_offset;
+    bool m_sorted{ false };
+    int m_count{ 0 };
+    Query m_queries[MAX_QUERIES];
+};
 } // namespace trace
@@ -0,0 +1,92 @@
+#pragma once
+
+class bf_read;
+
+/*
+ * User messages decoded once in DispatchUserMessage. Strings are read into the message itself, nothing allocates,
+ * and the buffer is always left at the start for the original.
+ */
+
+namespace usermessages
+{
+// Only the ones something in here decodes
+enum type : int
+{
+    SayText2       = 4,
+    TextMsg        = 5,
+    VGUIMenu       = 12,
+    VoiceSubtitle  = 25,
+    HudNotify      = 26,
+    CallVoteFailed = 45,
+    VoteStart      = 46,
+    VotePass       = 47,
+    VoteFailed     = 48,
+    VoteSetup      = 49
+};
+
+struct say_text2_s
+{
+    int entity;
+    bool chat;
+    // Point into raw
+    const char *event;
+    const char *name;
+    const char *message;
+};
+
+struct text_msg_s
+{
+    int dest;
+    // Only the first string, the rest are format arguments
+    const char *text;
+};
+
+struct vgui_menu_s
+{
+    const char *name;
+};
+
+struct voice_subtitle_s
+{
+    int entity;
+    int menu;
+    int command;
+};
+
+struct hud_notify_s
+{
+    int type;
+};
+
+struct vote_start_s
+{
+    int team;
+    int caller;
+    // Entity index of the player being voted on
+    int target;
+    const char *reason;
+    const char *name;
+};
+
+struct message_s
+{
+    int type;
+    // Bytes in the buffer, even for messages that don't get decoded
+    int size;
+    // Only the one matching type is valid
+    union
+    {
+        say_text2_s say_text2;
+        text_msg_s text_msg;
+        vgui_menu_s vgui_menu;
+        voice_subtitle_s voice_subtitle;
+        hud_notify_s hud_notify;
+        vote_start_s vote_start;
+    };
+    // Backing storage for the strings
+    char raw[256];
+};
+
+// False if type isn't known here or the message is malformed, out.type and out.size are set either way
+bool Decode(bf_read &buf, int type, message_s &out);
+} // namespace usermessages
@@ -9,6 +9,7 @@
 
 #include <functional>
 class IClientEntity;
+class CachedEntity;
 class Vector;
 
 namespace velocity
@@ -18,4 +19,8 @@ typedef std::function<void(IClientEntity *, Vector &)> EstimateAbsVelocity_t;
 extern EstimateAbsVelocity_t EstimateAbsVelocity;
 
 void Init();
+// Estimates velocity and acceleration of every player from their recent origins, call once per tick after the entity cache and local player updated
+void Update();
+// The estimate from Update() if there is one this tick, the game's guess otherwise
+void Get(CachedEntity *ent, Vector &out);
 } // namespace velocity
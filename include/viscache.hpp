@@ -0,0 +1,33 @@
+#pragma once
+
+#include "public/mathlib/vector.h"
+
+// Tick scoped cache for visibility traces, so modules asking the same question in one tick only pay for one trace
+namespace viscache
+{
+enum filter_type : unsigned
+{
+    FILTER_DEFAULT,
+    FILTER_NO_PLAYER,
+    FILTER_NO_ENTITY,
+    FILTER_NAVIGATION
+};
+
+// self/target are entity indexes, -1 if the query doesn't care about them
+struct query
+{
+    // Start is snapped to a 1 unit grid, eye positions jitter a bit between callers
+    int start[3];
+    float end[3];
+    int self;
+    int target;
+    unsigned mask;
+    unsigned filter;
+
+    query(const Vector &start, const Vector &end, int self, int target, unsigned mask, filter_type filter);
+};
+
+// Returns true if the query has already been traced this tick, the answer is written to visible
+bool Lookup(const query &q, bool &visible);
+void Store(const query &q, bool visible);
+} // namespace viscache
@@ -48,7 +48,10 @@ public:
     void SetEntityColor(CachedEntity *ent, rgba_t color);
     rgba_t ChamsColor(IClientEntity *entity);
     bool ShouldRenderChams(IClientEntity *entity);
-    void RenderChams(IClientEntity *entity);
+    // Classifies and colors every entity once, then renders them grouped by material and color
+    void BuildRenderPlan();
+    void RenderPass(float brightness);
+    void RenderPlan();
     void BeginRenderChams();
     void EndRenderChams();
     void RenderChamsRecursive(IClientEntity *entity);
@@ -41,7 +41,9 @@ public:
     void DrawToBuffer(IClientEntity *entity);
     rgba_t GlowColor(IClientEntity *entity);
     bool ShouldRenderGlow(IClientEntity *entity);
-    void RenderGlow(IClientEntity *entity);
+    // Classifies and colors every entity once per frame, then draws them grouped by color
+    void BuildRenderPlan();
+    void RenderPlan();
     void BeginRenderGlow();
     void EndRenderGlow();
 
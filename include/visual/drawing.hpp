@@ -16,6 +16,7 @@
 #endif
 
 #include "colors.hpp"
+#include "timer.hpp"
 #include <string>
 #include <memory>
 #include <vector>
@@ -23,6 +24,7 @@
 
 class CachedEntity;
 class Vector;
+struct matrix3x4_t;
 class IClientEntity;
 class CatEnum;
 class VMatrix;
@@ -39,7 +41,7 @@ struct font
     int size;
     bool outline = false;
     operator unsigned int();
-    void stringSize(std::string string, float *x, float *y);
+    void stringSize(const std::string &string, float *x, float *y);
     void changeSize(int new_font_size);
     void Init();
     std::map<int, unsigned int> size_map;
@@ -55,6 +57,8 @@ extern std::unique_ptr<font> menu;
 extern std::unique_ptr<font> center_screen;
 
 void Update();
+// Sum of cached glyph advances, no backend text measuring after the first time a glyph is seen
+float TextWidth(font &font, const char *text);
 
 extern const std::vector<std::string> fonts;
 } // namespace fonts
@@ -67,7 +71,9 @@ constexpr rgba_t GUIColor()
 void InitStrings();
 void ResetStrings();
 void AddCenterString(const std::string &string, const rgba_t &color = colors::white);
+void AddCenterString(const char *string, const rgba_t &color = colors::white);
 void AddSideString(const std::string &string, const rgba_t &color = colors::white);
+void AddSideString(const char *string, const rgba_t &color = colors::white);
 void DrawStrings();
 
 std::string ShrinkString(std::string data, int max_x, fonts::font &font);
@@ -116,7 +122,68 @@ typedef im_renderer::Texture Texture;
 typedef glez::texture Texture;
 #endif
 
+#if ENABLE_IMGUI_DRAWING
+typedef im_renderer::frame_stats frame_stats;
+#else
+struct frame_stats
+{
+    int draw_calls{ 0 };
+    int vertices{ 0 };
+};
+#endif
+
+// Primitives between these get batched by texture and font, layers keep everything drawn after NextLayer on top
+void BeginFrame();
+void NextLayer();
+void EndFrame();
+const frame_stats &LastFrameStats();
+
+// Everything a visual drew on its last tick, so frames in between ticks can replay it instead of running the visual again
+struct display_list
+{
+    enum command_type : uint8_t
+    {
+        CMD_LINE,
+        CMD_STRING,
+        CMD_RECTANGLE,
+        CMD_TRIANGLE,
+        CMD_RECTANGLE_OUTLINED,
+        CMD_TEXTURED,
+        CMD_CIRCLE
+    };
+    struct command_s
+    {
+        command_type type;
+        float p[6];
+        rgba_t color;
+        // Thickness, circles keep theirs in p[3] and their step count here
+        float thickness;
+        // tx, ty, tw, th and angle of textured rectangles
+        float tex[5];
+        // Font or texture
+        void *resource;
+        // Offset of the text in text
+        uint32_t text;
+    };
+    std::vector<command_s> commands;
+    std::vector<char> text;
+    unsigned long tick{ 0 };
+    int screen_width{ 0 };
+    int screen_height{ 0 };
+    Timer recorded{};
+    bool valid{ false };
+};
+// Replays list if it was recorded this tick, returns false if the visual has to run again
+bool Replay(display_list &list);
+// Draws everything in list again, whenever it was recorded
+void Play(const display_list &list);
+// Primitives drawn until EndRecording still get drawn, and are also stored in list
+void BeginRecording(display_list &list);
+void EndRecording();
+
 void Line(float x1, float y1, float x2, float y2, rgba_t color, float thickness);
+// count segments between points[pairs[2i]] and points[pairs[2i + 1]], in screen space
+void Lines(const Vector *points, const uint8_t *pairs, int count, rgba_t color, float thickness);
 void String(int x, int y, rgba_t rgba, const char *text, fonts::font &font);
 void Rectangle(float x, float y, float w, float h, rgba_t color);
 void Triangle(float x, float y, float x2, float y2, float x3, float y3, rgba_t color);
@@ -126,6 +193,10 @@ void Circle(float x, float y, float radius, rgba_t color, float thickness, int s
 
 void UpdateWTS();
 bool WorldToScreen(const Vector &origin, Vector &screen);
+// Projects count points at once, visible may be null. Returns true if every point is in front of the camera
+bool WorldToScreenBatch(const Vector *world, int count, Vector *screen, uint8_t *visible);
+// Same, for points given in the space transform maps to the world
+bool WorldToScreenBatch(const matrix3x4_t &transform, const Vector *local, int count, Vector *screen, uint8_t *visible);
 bool EntityCenterToScreen(CachedEntity *entity, Vector &out);
 
 void InitGL();
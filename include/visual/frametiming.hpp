@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * How much of every frame is ours. The game thread times Begin/Draw/EndCheatVisuals, SDL_GL_SwapWindow
+ * times flushing the draw lists on the CPU and, with GL timer queries, on the GPU.
+ * GPU results arrive a few frames late since waiting on a query would stall the game.
+ */
+
+namespace frame_timing
+{
+enum stage
+{
+    BEGIN_VISUALS,
+    DRAW_VISUALS,
+    END_VISUALS,
+    // BeginGL to EndGL in SDL_GL_SwapWindow
+    FLUSH_CPU,
+    FLUSH_GPU,
+    STAGE_COUNT
+};
+
+// Interval statistics for telemetry, all in us
+struct summary_s
+{
+    uint32_t frames;
+    uint32_t p50_us[STAGE_COUNT];
+    uint32_t p99_us[STAGE_COUNT];
+    // Frames whose visuals and flush together took longer than debug.frame-timing.budget-us
+    uint32_t over_budget;
+};
+
+// Game thread, profiler::Now() taken before each stage of render_cheat_visuals and after the last
+void Visuals(uint64_t begin, uint64_t draw, uint64_t end, uint64_t done);
+// Render thread with the drawing context current, around BeginGL and EndGL
+void FlushBegin();
+void FlushEnd();
+// Graph of the last frames, if debug.frame-timing.overlay is on
+void DrawOverlay();
+// Everything since the last call
+void Collect(summary_s &out);
+} // namespace frame_timing
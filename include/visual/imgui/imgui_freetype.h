@@ -30,6 +30,36 @@ enum RasterizerFlags
 
 IMGUI_API bool BuildFontAtlas(ImFontAtlas *atlas, unsigned int extra_flags = 0);
 
+// One rasterized glyph, Pixels is Width * Height alpha values and stays valid until the next Rasterize()
+struct GlyphBitmap
+{
+    int Width;
+    int Height;
+    int OffsetX; // From the pen position to the left of the bitmap
+    int OffsetY; // From the baseline to the top of the bitmap, usually negative
+    float AdvanceX;
+    const unsigned char *Pixels;
+};
+
+// Renders single glyphs of a font outside of any atlas, for code points that only get baked once something needs them.
+// cfg.FontData has to outlive the rasterizer, fonts added to an atlas keep theirs until the atlas is cleared
+class IMGUI_API GlyphRasterizer
+{
+public:
+    GlyphRasterizer() = default;
+    ~GlyphRasterizer();
+    GlyphRasterizer(const GlyphRasterizer &) = delete;
+    GlyphRasterizer &operator=(const GlyphRasterizer &) = delete;
+
+    bool Init(const ImFontConfig &cfg, unsigned int extra_flags = 0);
+    // False if the font has no glyph for codepoint
+    bool Rasterize(unsigned int codepoint, GlyphBitmap &out);
+
+private:
+    struct Impl;
+    Impl *impl{ nullptr };
+};
+
 // By default ImGuiFreeType will use ImGui::MemAlloc()/MemFree().
 // However, as FreeType does lots of allocations we provide a way for the user to redirect it to a separate memory heap if desired:
 IMGUI_API void SetAllocatorFunctions(void *(*alloc_func)(size_t sz, void *user_data), void (*free_func)(void *ptr, void *user_data), void *user_data = NULL);
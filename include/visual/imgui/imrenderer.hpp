@@ -32,20 +32,21 @@ struct font
     bool outline       = false;
     bool needs_rebuild = true;
     operator ImFont *();
-    void stringSize(std::string string, float *x, float *y);
+    void stringSize(const std::string &string, float *x, float *y);
     void changeSize(int new_font_size);
     void rebuild();
     ImFontAtlas *font_atlas{ nullptr };
     std::map<int, ImFont *> size_map;
 };
 
+// Textures loaded from a path are decoded in the background and packed into one shared GL texture,
+// get() returns 0 until that is done
 class Texture
 {
 public:
     explicit Texture(std::string path);
     Texture(unsigned int id, int h, int w);
     ~Texture();
-    void load();
     unsigned int get();
     int getWidth()
     {
@@ -55,17 +56,42 @@ public:
     {
         return height;
     }
+    // Maps a pixel of this texture to atlas texture coordinates
+    float getU(float tx)
+    {
+        return (atlas_x + tx) / atlas_width;
+    }
+    float getV(float ty)
+    {
+        return (atlas_y + ty) / atlas_height;
+    }
 
 private:
-    unsigned char *data{ nullptr };
+    friend void updateAtlas();
     unsigned int texture_id{ 0 };
     std::string path{ "" };
     int height{ 0 };
     int width{ 0 };
+    // Where this texture lives inside the GL texture
+    int atlas_x{ 0 };
+    int atlas_y{ 0 };
+    int atlas_width{ 0 };
+    int atlas_height{ 0 };
+    bool owns_texture{ false };
+};
+
+struct frame_stats
+{
+    int draw_calls{ 0 };
+    int vertices{ 0 };
 };
 
 void init();
 void bufferBegin();
+// Everything drawn after this goes on top of everything drawn before
+void bufferLayer();
+void bufferEnd();
+const frame_stats &lastFrameStats();
 void renderStart();
 void renderEnd();
 
@@ -0,0 +1,124 @@
+#pragma once
+
+/*
+ *  Hands finished ImGui frames to an overlay running in its own process through shared memory.
+ *  The game writes into one of FRAME_SLOTS slots and never waits on the overlay, the overlay renders the newest complete one.
+ *  Everything below the writer section is plain data so the overlay only needs this header
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+struct ImDrawData;
+
+namespace overlay_transport
+{
+constexpr const char *SHM_NAME       = "/cathook-overlay";
+constexpr uint32_t MAGIC             = 0x564f4843; // "CHOV"
+constexpr uint32_t VERSION           = 1;
+constexpr int FRAME_SLOTS            = 3;
+constexpr uint32_t MAX_VERTICES      = 1 << 18;
+constexpr uint32_t MAX_INDICES       = 3 << 17;
+constexpr uint32_t MAX_COMMANDS      = 4096;
+constexpr int MAX_TEXTURES           = 16;
+constexpr uint32_t TEXTURE_POOL_SIZE = 32 << 20;
+
+// Same layout as ImDrawVert
+struct vertex_s
+{
+    float x, y;
+    float u, v;
+    uint32_t color;
+};
+
+struct command_s
+{
+    uint32_t element_count;
+    float clip[4];
+    // Index into header_s::textures, -1 for untextured
+    int32_t texture;
+};
+
+// RGBA8 pixels at offset in the texture pool
+struct texture_s
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t offset;
+};
+
+struct frame_s
+{
+    // Odd while the game writes this slot
+    std::atomic<uint32_t> sequence;
+    uint64_t frame_number;
+    // CLOCK_MONOTONIC, when the game finished writing
+    int64_t publish_ns;
+    // header_s::texture_sequence the commands refer to
+    uint32_t texture_sequence;
+    float display_x, display_y;
+    float display_width, display_height;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t command_count;
+    // Indices are relative to the start of vertices, commands consume them in order
+    vertex_s vertices[MAX_VERTICES];
+    uint32_t indices[MAX_INDICES];
+    command_s commands[MAX_COMMANDS];
+};
+
+struct header_s
+{
+    uint32_t magic;
+    uint32_t version;
+    // Slot of the newest complete frame, -1 before the first one
+    std::atomic<int32_t> latest;
+    // Odd while the game changes the texture table or pool. Textures only get appended until the table is reset
+    std::atomic<uint32_t> texture_sequence;
+    uint32_t texture_count;
+    texture_s textures[MAX_TEXTURES];
+    // Written by the overlay
+    std::atomic<uint64_t> overlay_frame;
+    std::atomic<int64_t> overlay_latency_ns;
+    frame_s frames[FRAME_SLOTS];
+    uint8_t texture_pool[TEXTURE_POOL_SIZE];
+};
+
+inline int64_t Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Overlay side. Returns the newest complete frame or nullptr, render straight from it and hand it to ReleaseFrame after
+inline const frame_s *AcquireFrame(header_s *header, uint32_t &sequence)
+{
+    int32_t slot = header->latest.load(std::memory_order_acquire);
+    if (slot < 0 || slot >= FRAME_SLOTS)
+        return nullptr;
+    const frame_s *frame = &header->frames[slot];
+    sequence             = frame->sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+        return nullptr;
+    return frame;
+}
+
+// False if the game started rewriting the frame while it was read, the result has to be dropped then
+inline bool ReleaseFrame(header_s *header, const frame_s *frame, uint32_t sequence)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (frame->sequence.load(std::memory_order_relaxed) != sequence)
+        return false;
+    header->overlay_frame.store(frame->frame_number, std::memory_order_relaxed);
+    header->overlay_latency_ns.store(Now() - frame->publish_ns, std::memory_order_relaxed);
+    return true;
+}
+
+// Game side, only built for the streamproof draw type.
+// Returns true if the frame went to the overlay, which means it must not be rendered in process
+bool Publish(ImDrawData *data);
+// Call after deleting or refilling a GL texture, the overlay gets a fresh copy of every texture then
+void InvalidateTextures();
+} // namespace overlay_transport
@@ -14,7 +14,10 @@ namespace gui
 void init();
 void shutdown();
 void draw();
+// Only decides whether the game gets to see the event, the menu itself handles it in draw()
 bool handleSdlEvent(SDL_Event *event);
+// The game's poll loop is done for this frame
+void flushSdlEvents();
 
 void onLevelLoad();
 } // namespace gui
@@ -48,7 +48,13 @@ public:
 
     Container *getTab(std::string title);
 
+    // Builds the tab if it has not been shown yet
+    Container *loadTab(size_t index);
+
     TabSelection selection;
     std::vector<std::unique_ptr<Container>> containers{};
+    // Xml of tabs that were never shown, nullptr once built. Points into Menu::xml_source, which outlives the objects.
+    // findElement only sees built tabs
+    std::vector<const tinyxml2::XMLElement *> pending{};
 };
 } // namespace zerokernel
\ No newline at end of file
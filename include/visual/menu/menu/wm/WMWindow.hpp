@@ -31,6 +31,14 @@ public:
 
     void render() override;
 
+    void update() override;
+
+    void recursiveSizeUpdate() override;
+
+    void emitSizeUpdate() override;
+
+    void onMove() override;
+
     void reorderElements() override;
 
     void loadFromXml(const tinyxml2::XMLElement *data) override;
@@ -65,6 +73,16 @@ public:
     std::string name{};
     std::string short_name{};
     bool focused{ false };
+    // Layout that was skipped while hidden, redone the next time the window updates
+    bool layout_pending{ false };
+
+    // Last frame of the window, replayed while nothing can have changed it
+    draw::display_list render_cache{};
+    bool render_dirty{ true };
+    bool mouse_was_inside{ false };
+    size_t rendered_frame{ 0 };
+    // Bound variables can change from outside the menu, picked up at this interval
+    Timer render_refresh{};
 
     HeaderLocation location{ HeaderLocation::TOP };
     settings::Variable<int> header_location{};
@@ -8,11 +8,11 @@
 #pragma once
 
 #include "string"
-class bf_read;
+#include "usermessages.hpp"
 
 namespace votelogger
 {
 
-void dispatchUserMessage(bf_read &buffer, int type);
+void dispatchUserMessage(const usermessages::message_s &message);
 void onShutdown(std::string message);
 } // namespace votelogger
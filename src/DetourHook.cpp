@@ -0,0 +1,258 @@
+/*
+ * Trampolines for DetourHook. The game is 32 bit, so the only position dependent instructions a
+ * prologue can have are relative branches and calls, everything else is copied as is.
+ */
+
+#include "DetourHook.hpp"
+#include <sys/mman.h>
+
+namespace
+{
+constexpr size_t TRAMPOLINE_SIZE = 128;
+
+struct instruction_s
+{
+    size_t length;
+    // Relative branch target size in bytes, 0 if the instruction isn't one
+    int rel_size;
+    // Ends the function or jumps away for good
+    bool ends_flow;
+};
+
+size_t ModRMLength(const uint8_t *modrm)
+{
+    int mod = *modrm >> 6;
+    int rm  = *modrm & 7;
+    if (mod == 3)
+        return 1;
+    size_t length = 1;
+    if (rm == 4)
+    {
+        length++;
+        if (mod == 0 && (modrm[1] & 7) == 5)
+            length += 4;
+    }
+    if (mod == 0 && rm == 5)
+        length += 4;
+    else if (mod == 1)
+        length += 1;
+    else if (mod == 2)
+        length += 4;
+    return length;
+}
+
+// Enough of the one and two byte opcode maps for compiler generated prologues, false for anything else
+bool Decode(const uint8_t *code, instruction_s &out)
+{
+    const uint8_t *at = code;
+    bool operand16    = false;
+    for (;; at++)
+    {
+        if (*at == 0x66)
+            operand16 = true;
+        else if (*at == 0x67)
+            return false;
+        else if (*at != 0xF0 && *at != 0xF2 && *at != 0xF3 && *at != 0x2E && *at != 0x36 && *at != 0x3E && *at != 0x26 && *at != 0x64 && *at != 0x65)
+            break;
+        if (at - code >= 4)
+            return false;
+    }
+    size_t immz   = operand16 ? 2 : 4;
+    uint8_t op    = *at++;
+    out.rel_size  = 0;
+    out.ends_flow = false;
+    size_t rest   = 0;
+
+    if (op == 0x0F)
+    {
+        uint8_t op2 = *at++;
+        if (op2 >= 0x80 && op2 <= 0x8F)
+        {
+            out.rel_size = 4;
+            rest         = 4;
+        }
+        else if ((op2 >= 0x70 && op2 <= 0x73) || op2 == 0xA4 || op2 == 0xAC || op2 == 0xBA || op2 == 0xC2 || (op2 >= 0xC4 && op2 <= 0xC6))
+            rest = ModRMLength(at) + 1;
+        else if ((op2 >= 0x10 && op2 <= 0x1F) || (op2 >= 0x28 && op2 <= 0x2F) || (op2 >= 0x40 && op2 <= 0x7F) || (op2 >= 0x90 && op2 <= 0x9F) || op2 == 0xA3 || op2 == 0xAB || op2 == 0xAF || op2 == 0xB0 || op2 == 0xB1 || op2 == 0xB6 || op2 == 0xB7 || op2 == 0xBE || op2 == 0xBF || op2 == 0xC0 || op2 == 0xC1 || op2 >= 0xD0)
+            rest = ModRMLength(at);
+        else
+            return false;
+        out.length = at - code + rest;
+        return op2 != 0xFF;
+    }
+
+    if (op < 0x40 && (op & 7) < 4)
+        rest = ModRMLength(at);
+    else if (op < 0x40 && (op & 7) == 4)
+        rest = 1;
+    else if (op < 0x40 && (op & 7) == 5)
+        rest = immz;
+    else if (op >= 0x40 && op <= 0x61)
+        rest = 0;
+    else if (op == 0x68)
+        rest = immz;
+    else if (op == 0x6A)
+        rest = 1;
+    else if (op == 0x69)
+        rest = ModRMLength(at) + immz;
+    else if (op == 0x6B)
+        rest = ModRMLength(at) + 1;
+    else if (op >= 0x70 && op <= 0x7F)
+    {
+        out.rel_size = 1;
+        rest         = 1;
+    }
+    else if (op == 0x80 || op == 0x82 || op == 0x83 || op == 0xC0 || op == 0xC1 || op == 0xC6)
+        rest = ModRMLength(at) + 1;
+    else if (op == 0x81 || op == 0xC7)
+        rest = ModRMLength(at) + immz;
+    else if ((op >= 0x84 && op <= 0x8B) || op == 0x8D || op == 0x8F || (op >= 0xD0 && op <= 0xD3))
+        rest = ModRMLength(at);
+    else if ((op >= 0x90 && op <= 0x99) || op == 0x9C || op == 0x9D)
+        rest = 0;
+    else if (op >= 0xA0 && op <= 0xA3)
+        rest = 4;
+    else if (op == 0xA8 || (op >= 0xB0 && op <= 0xB7))
+        rest = 1;
+    else if (op == 0xA9 || (op >= 0xB8 && op <= 0xBF))
+        rest = immz;
+    else if (op == 0xC3 || op == 0xCC)
+        out.ends_flow = true;
+    else if (op == 0xC2)
+    {
+        rest          = 2;
+        out.ends_flow = true;
+    }
+    else if (op == 0xE8 || op == 0xE9)
+    {
+        out.rel_size  = 4;
+        rest          = 4;
+        out.ends_flow = op == 0xE9;
+    }
+    else if (op == 0xEB)
+    {
+        out.rel_size  = 1;
+        rest          = 1;
+        out.ends_flow = true;
+    }
+    else if (op == 0xF6 || op == 0xF7)
+    {
+        int reg = (*at >> 3) & 7;
+        rest    = ModRMLength(at) + (reg < 2 ? (op == 0xF6 ? 1 : immz) : 0);
+    }
+    else if (op == 0xFE)
+        rest = ModRMLength(at);
+    else if (op == 0xFF)
+    {
+        int reg       = (*at >> 3) & 7;
+        rest          = ModRMLength(at);
+        out.ends_flow = reg == 4 || reg == 5;
+        if (reg == 7)
+            return false;
+    }
+    else
+        return false;
+    out.length = at - code + rest;
+    return true;
+}
+
+void Emit32(uint8_t *&out, uint32_t value)
+{
+    memcpy(out, &value, 4);
+    out += 4;
+}
+} // namespace
+
+void *DetourHook::BuildTrampoline(uintptr_t address, size_t patch_size)
+{
+    const uint8_t *code = (const uint8_t *) address;
+    void *memory        = mmap(nullptr, TRAMPOLINE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return nullptr;
+    // Relative targets depend on where the copy lives, so it's written in place
+    uint8_t *out  = (uint8_t *) memory;
+    size_t stolen = 0;
+    auto fail     = [&]() {
+        munmap(memory, TRAMPOLINE_SIZE);
+        return nullptr;
+    };
+
+    while (stolen < patch_size)
+    {
+        instruction_s instruction;
+        if (!Decode(code + stolen, instruction))
+        {
+            logging::Info("DetourHook: can't relocate byte %02x at %p+%u, unpatching for every call", code[stolen], code, (unsigned) stolen);
+            return fail();
+        }
+        // Whatever follows could be another function, the patch must not spill into it
+        if (instruction.ends_flow && stolen + instruction.length < patch_size)
+            return fail();
+        const uint8_t *insn = code + stolen;
+        uintptr_t next      = address + stolen + instruction.length;
+        if (!instruction.rel_size)
+        {
+            memcpy(out, insn, instruction.length);
+            out += instruction.length;
+        }
+        else
+        {
+            const uint8_t *op = insn + instruction.length - 1 - instruction.rel_size;
+            int32_t rel       = 0;
+            if (instruction.rel_size == 1)
+                rel = (int8_t) insn[instruction.length - 1];
+            else
+                memcpy(&rel, insn + instruction.length - 4, 4);
+            uintptr_t target = next + rel;
+            // Back into the bytes the patch overwrites
+            if (target >= address && target < address + patch_size)
+                return fail();
+            // Two byte conditional jumps have their 0F in front
+            if (instruction.rel_size == 4 && op > insn && op[-1] == 0x0F)
+                op--;
+            if (*op == 0xE8)
+            {
+                const uint8_t *callee = (const uint8_t *) target;
+                // __x86.get_pc_thunk.reg, the return address it reads has to stay the original one
+                if (callee[0] == 0x8B && (callee[1] & 0xC7) == 0x04 && callee[2] == 0x24 && callee[3] == 0xC3)
+                {
+                    *out++ = 0xB8 + ((callee[1] >> 3) & 7);
+                    Emit32(out, next);
+                }
+                else
+                {
+                    *out++ = 0xE8;
+                    Emit32(out, target - ((uintptr_t) out + 4));
+                }
+            }
+            else if (*op == 0xE9 || *op == 0xEB)
+            {
+                *out++ = 0xE9;
+                Emit32(out, target - ((uintptr_t) out + 4));
+            }
+            else
+            {
+                // Short or near Jcc, both become the near form
+                uint8_t condition = *op == 0x0F ? op[1] & 0x0F : *op & 0x0F;
+                *out++            = 0x0F;
+                *out++            = 0x80 | condition;
+                Emit32(out, target - ((uintptr_t) out + 4));
+            }
+        }
+        stolen += instruction.length;
+    }
+    *out++ = 0xE9;
+    Emit32(out, address + stolen - ((uintptr_t) out + 4));
+
+    if (mprotect(memory, TRAMPOLINE_SIZE, PROT_READ | PROT_EXEC))
+        return fail();
+    return memory;
+}
+
+void DetourHook::FreeTrampoline()
+{
+    if (!trampoline)
+        return;
+    munmap(trampoline, TRAMPOLINE_SIZE);
+    trampoline = nullptr;
+}
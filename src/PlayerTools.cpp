@@ -10,6 +10,7 @@
 #include "entitycache.hpp"
 #include "settings/Bool.hpp"
 #include "MiscTemporary.hpp"
+#include "ipcchannel.hpp"
 
 namespace player_tools
 {
@@ -119,10 +120,7 @@ void onKilledBy(unsigned id)
             if (ipc::peer && ipc::peer->connected)
             {
                 std::string command = "cat_ipc_exec_all cat_pl_mark_betrayal " + std::to_string(id);
-                if (command.length() >= 63)
-                    ipc::peer->SendMessage(0, -1, ipc::commands::execute_client_cmd_long, command.c_str(), command.length() + 1);
-                else
-                    ipc::peer->SendMessage(command.c_str(), -1, ipc::commands::execute_client_cmd, 0, 0);
+                ipc::channel::SendCommand(-1, command);
             }
         }
     }
@@ -151,31 +149,11 @@ void onKilledBy(CachedEntity *entity)
     onKilledBy(entity->player_info.friendsID);
 }
 
-class PlayerToolsEventListener : public IGameEventListener2
+static void OnPlayerDeath(const game_events::event_s &event)
 {
-    void FireGameEvent(IGameEvent *event) override
-    {
-
-        int killer_id = g_IEngine->GetPlayerForUserID(event->GetInt("attacker"));
-        int victim_id = g_IEngine->GetPlayerForUserID(event->GetInt("userid"));
-
-        if (victim_id == g_IEngine->GetLocalPlayer())
-        {
-            onKilledBy(ENTITY(killer_id));
-            return;
-        }
-    }
-};
-
-PlayerToolsEventListener &listener()
-{
-    static PlayerToolsEventListener object{};
-    return object;
+    if (event.death->victim == g_IEngine->GetLocalPlayer())
+        onKilledBy(ENTITY(event.death->attacker));
 }
 
-static InitRoutine register_event([]() {
-    g_IEventManager2->AddListener(&listener(), "player_death", false);
-    EC::Register(
-        EC::Shutdown, []() { g_IEventManager2->RemoveListener(&listener()); }, "playerlist_shutdown");
-});
+static InitRoutine register_event([]() { game_events::Subscribe("player_death", OnPlayerDeath); });
 } // namespace player_tools
@@ -0,0 +1,55 @@
+#include "aimsolution.hpp"
+#include "common.hpp"
+
+namespace aim_solution
+{
+struct solution_s
+{
+    unsigned long tick{ ~0UL };
+    Vector center;
+    float fov;
+    float distance;
+    unsigned long visible_tick{ ~0UL };
+    bool pelvis_visible;
+};
+static std::array<solution_s, MAX_ENTITIES> solutions{};
+
+static solution_s &Update(CachedEntity *ent)
+{
+    auto &solution = solutions[ent->m_IDX];
+    if (solution.tick == tickcount)
+        return solution;
+    solution.tick     = tickcount;
+    auto collideable  = RAW_ENT(ent)->GetCollideable();
+    solution.center   = ent->m_vecOrigin() + (collideable->OBBMins() + collideable->OBBMaxs()) / 2;
+    solution.fov      = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, solution.center);
+    solution.distance = solution.center.DistTo(g_pLocalPlayer->v_Eye);
+    return solution;
+}
+
+const Vector &Center(CachedEntity *ent)
+{
+    return Update(ent).center;
+}
+
+float Fov(CachedEntity *ent)
+{
+    return Update(ent).fov;
+}
+
+float Distance(CachedEntity *ent)
+{
+    return Update(ent).distance;
+}
+
+bool PelvisVisible(CachedEntity *ent)
+{
+    auto &solution = solutions[ent->m_IDX];
+    if (solution.visible_tick == tickcount)
+        return solution.pelvis_visible;
+    solution.visible_tick   = tickcount;
+    auto hitbox             = ent->hitboxes.GetHitbox(pelvis);
+    solution.pelvis_visible = hitbox && IsEntityVectorVisible(ent, hitbox->center);
+    return solution.pelvis_visible;
+}
+} // namespace aim_solution
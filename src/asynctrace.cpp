@@ -0,0 +1,56 @@
+#include "common.hpp"
+#include "settings/Int.hpp"
+#include "asynctrace.hpp"
+#include <deque>
+
+namespace asynctrace
+{
+static settings::Int budget{ "trace.async-budget", "48" };
+
+struct request
+{
+    Vector origin;
+    Vector target;
+    bool enviroment_only;
+    unsigned int mask;
+    callback_t callback;
+};
+
+static std::deque<request> queue;
+
+void Submit(const Vector &origin, const Vector &target, bool enviroment_only, unsigned int mask, callback_t callback)
+{
+    queue.push_back(request{ origin, target, enviroment_only, mask, std::move(callback) });
+}
+
+size_t Pending()
+{
+    return queue.size();
+}
+
+static void CreateMove()
+{
+    if (queue.empty() || CE_BAD(LOCAL_E))
+        return;
+    PROF_SECTION(CM_AsyncTrace);
+    for (int i = 0; i < *budget && !queue.empty(); i++)
+    {
+        // Callbacks may submit more work, so take the request out first
+        request req = std::move(queue.front());
+        queue.pop_front();
+        req.callback(IsVectorVisible(req.origin, req.target, req.enviroment_only, LOCAL_E, req.mask));
+    }
+}
+
+// Callbacks usually hold pointers into level data (nav areas, entities), drop them without calling
+static void Clear()
+{
+    queue.clear();
+}
+
+static InitRoutine init([]() {
+    EC::Register(EC::CreateMove, CreateMove, "cm_asynctrace", EC::very_late);
+    EC::Register(EC::LevelInit, Clear, "levelinit_asynctrace");
+    EC::Register(EC::LevelShutdown, Clear, "levelshutdown_asynctrace");
+});
+} // namespace asynctrace
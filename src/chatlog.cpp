@@ -8,98 +8,204 @@
 #include "common.hpp"
 #include "init.hpp"
 
+#include <fcntl.h>
 #include <pwd.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <hacks/Spam.hpp>
 #include <settings/Bool.hpp>
+#include <settings/Int.hpp>
 
 namespace chatlog
 {
 static settings::Boolean enable{ "chat-log.enable", "false" };
 static settings::Boolean no_spam{ "chat-log.no-spam", "true" };
 static settings::Boolean no_ipc{ "chat-log.no-ipc", "true" };
+static settings::Int flush_rows{ "chat-log.flush-rows", "32" };
+static settings::Int flush_ms{ "chat-log.flush-interval-ms", "5000" };
+// 0 for never
+static settings::Int rotate_mb{ "chat-log.rotate-mb", "64" };
+static settings::Int rotate_hours{ "chat-log.rotate-hours", "0" };
+// gzip rotated logs
+static settings::Boolean compress{ "chat-log.compress", "false" };
 
-class csv_stream
+// Rows get queued by the chat hook and written by a thread of their own
+class csv_writer
 {
 public:
-    struct end_t
+    ~csv_writer()
     {
-    };
-    static end_t end;
-
-public:
-    csv_stream()
-    {
-        open();
+        Stop();
     }
-    ~csv_stream()
+
+    void Row(std::initializer_list<std::string> columns)
     {
-        stream.close();
+        std::string row;
+        for (const auto &column : columns)
+        {
+            if (!row.empty())
+                row += ',';
+            row += '"';
+            for (char i : column)
+            {
+                if (i == '"')
+                    row += '"';
+                row += i;
+            }
+            row += '"';
+        }
+        row += '\n';
+        // Settings are only read on the game thread
+        rows_per_flush.store(std::max(*flush_rows, 1), std::memory_order_relaxed);
+        ms_per_flush.store(std::max(*flush_ms, 100), std::memory_order_relaxed);
+        rotate_bytes.store(size_t(std::max(*rotate_mb, 0)) << 20, std::memory_order_relaxed);
+        rotate_seconds.store(std::max(*rotate_hours, 0) * 3600, std::memory_order_relaxed);
+        compress_archives.store(*compress, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (!thread.joinable())
+            thread = std::thread(&csv_writer::Run, this);
+        pending += row;
+        if (++rows >= unsigned(rows_per_flush.load(std::memory_order_relaxed)))
+            wake.notify_one();
     }
-    bool open()
+
+    // Writes whatever is still queued
+    void Stop()
     {
-        logging::Info("csvstream: Trying to open log file");
-        uid_t uid         = geteuid();
-        struct passwd *pw = getpwuid(uid);
-        std::string uname = "";
-        if (pw)
         {
-            uname = std::string(pw->pw_name);
+            std::lock_guard<std::mutex> guard(lock);
+            if (!thread.joinable())
+                return;
+            stop = true;
         }
-        else
-            uname = "unknown";
-        stream.open(paths::getDataPath("/chat-" + uname + ".csv"), std::ios::out | std::ios::app);
-        return stream.good();
+        wake.notify_one();
+        thread.join();
+        stop = false;
     }
 
-public:
-    int columns{ 0 };
-    std::ofstream stream;
-};
-
-csv_stream::end_t csv_stream::end{};
+private:
+    static std::string Path(const std::string &suffix)
+    {
+        struct passwd *pw = getpwuid(geteuid());
+        std::string uname = pw ? std::string(pw->pw_name) : "unknown";
+        return paths::getDataPath("/chat-" + uname + suffix + ".csv");
+    }
 
-csv_stream &operator<<(csv_stream &log, const std::string &string)
-{
-    if (!log.stream.good())
+    bool Open()
     {
-        logging::Info("[ERROR] csvstream is not open!");
-        if (!log.open())
-            return log;
+        if (fd >= 0)
+            return true;
+        logging::Info("csv_writer: Trying to open log file");
+        fd = open(Path("").c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        struct stat st;
+        file_size = fd >= 0 && !fstat(fd, &st) ? st.st_size : 0;
+        opened_at = time(nullptr);
+        if (fd < 0)
+            logging::Info("[ERROR] Couldn't open the chat log: %s", strerror(errno));
+        return fd >= 0;
     }
-    if (log.columns)
-        log.stream << ',';
-    log.stream << '"';
-    for (const auto &i : string)
+
+    void Rotate()
     {
-        if (i == '"')
+        size_t max_bytes = rotate_bytes.load(std::memory_order_relaxed);
+        time_t max_age   = rotate_seconds.load(std::memory_order_relaxed);
+        if (fd < 0 || !((max_bytes && file_size >= max_bytes) || (max_age && time(nullptr) - opened_at >= max_age)))
+            return;
+        close(fd);
+        fd = -1;
+
+        char stamp[32];
+        time_t now = time(nullptr);
+        struct tm time_info;
+        localtime_r(&now, &time_info);
+        strftime(stamp, sizeof(stamp), "-%Y%m%d-%H%M%S", &time_info);
+        std::string archive = Path(stamp);
+        // Never overwrite an older archive from the same second
+        for (int i = 1; !access(archive.c_str(), F_OK) || !access((archive + ".gz").c_str(), F_OK); i++)
+            archive = Path(stamp + ("-" + std::to_string(i)));
+        if (rename(Path("").c_str(), archive.c_str()))
         {
-            log.stream << '"';
+            logging::Info("[ERROR] Couldn't rotate the chat log: %s", strerror(errno));
+            return;
         }
-        log.stream << i;
+        if (!compress_archives.load(std::memory_order_relaxed))
+            return;
+        pid_t pid;
+        const char *argv[] = { "gzip", "-f", archive.c_str(), nullptr };
+        if (posix_spawnp(&pid, "gzip", nullptr, nullptr, (char *const *) argv, environ))
+            logging::Info("[ERROR] Couldn't start gzip for %s", archive.c_str());
+        else
+            compressing.push_back(pid);
     }
-    log.stream << '"';
-    log.columns++;
-    return log;
-}
 
-csv_stream &operator<<(csv_stream &log, const csv_stream::end_t &end)
-{
-    if (!log.stream.good())
+    void Run()
     {
-        logging::Info("[ERROR] csvstream is not open!");
-        if (!log.open())
-            return log;
+        std::unique_lock<std::mutex> guard(lock);
+        while (!stop || !pending.empty())
+        {
+            wake.wait_for(guard, std::chrono::milliseconds(ms_per_flush.load(std::memory_order_relaxed)), [this] { return stop || rows >= unsigned(rows_per_flush.load(std::memory_order_relaxed)); });
+            if (pending.empty())
+                continue;
+            std::string batch;
+            batch.swap(pending);
+            rows = 0;
+            guard.unlock();
+
+            if (Open())
+            {
+                for (size_t done = 0; done < batch.size();)
+                {
+                    ssize_t written = write(fd, batch.data() + done, batch.size() - done);
+                    if (written <= 0)
+                        break;
+                    done += written;
+                }
+                file_size += batch.size();
+                Rotate();
+            }
+            // Reap finished compressions
+            compressing.erase(std::remove_if(compressing.begin(), compressing.end(), [](pid_t pid) { return waitpid(pid, nullptr, WNOHANG) != 0; }), compressing.end());
+            guard.lock();
+        }
+        guard.unlock();
+        for (pid_t pid : compressing)
+            waitpid(pid, nullptr, 0);
+        compressing.clear();
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
     }
-    log.stream << '\n';
-    log.stream.flush();
-    log.columns = 0;
-    return log;
-}
 
-csv_stream &logger()
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread thread;
+    // Guarded by lock
+    std::string pending;
+    unsigned rows{ 0 };
+    bool stop{ false };
+
+    std::atomic<int> rows_per_flush{ 32 };
+    std::atomic<int> ms_per_flush{ 5000 };
+    std::atomic<size_t> rotate_bytes{ 0 };
+    std::atomic<time_t> rotate_seconds{ 0 };
+    std::atomic<bool> compress_archives{ false };
+
+    // Writer thread only
+    int fd{ -1 };
+    size_t file_size{ 0 };
+    time_t opened_at{ 0 };
+    std::vector<pid_t> compressing;
+};
+
+csv_writer &logger()
 {
-    static csv_stream object{};
+    static csv_writer object{};
     return object;
 }
 
@@ -128,10 +234,12 @@ void LogMessage(int eid, std::string message)
         if (x == '\n' || x == '\r')
             x = '*';
     }
-    logger() << std::to_string(time(nullptr)) << std::to_string(info.friendsID) << name << message
 #if ENABLE_IPC
-             << std::to_string(ipc::peer ? ipc::peer->client_id : 0)
+    logger().Row({ std::to_string(time(nullptr)), std::to_string(info.friendsID), name, message, std::to_string(ipc::peer ? ipc::peer->client_id : 0) });
+#else
+    logger().Row({ std::to_string(time(nullptr)), std::to_string(info.friendsID), name, message });
 #endif
-             << csv_stream::end;
 }
+
+static InitRoutine init([]() { EC::Register(EC::Shutdown, []() { logger().Stop(); }, "shutdown_chatlog"); });
 } // namespace chatlog
@@ -6,13 +6,61 @@
  */
 
 #include "common.hpp"
+#include <settings/Int.hpp>
+#include <deque>
 
 namespace chat_stack
 {
+static settings::Int capacity{ "chat.queue.capacity", "16" };
 
-void Say(const std::string &message, bool team)
+static std::deque<msg_t> queues[PRIORITY_COUNT];
+static size_t pending = 0;
+
+static size_t Capacity()
+{
+    return std::max(*capacity, 1);
+}
+
+// Lowest priority with anything queued at or below level, PRIORITY_COUNT if there is none
+static int Victim(priority level)
 {
-    stack.push({ message, team });
+    for (int i = low; i <= level; i++)
+        if (!queues[i].empty())
+            return i;
+    return PRIORITY_COUNT;
+}
+
+bool CanQueue(priority level)
+{
+    return pending < Capacity() || Victim(level) != PRIORITY_COUNT;
+}
+
+size_t Pending()
+{
+    return pending;
+}
+
+bool Say(const std::string &message, bool team, priority level)
+{
+    if (message.empty())
+        return true;
+    while (pending >= Capacity())
+    {
+        int victim = Victim(level);
+        if (victim == PRIORITY_COUNT)
+        {
+            stats.dropped++;
+            return false;
+        }
+        // Oldest of the lowest priority, newer ones are more relevant
+        queues[victim].pop_front();
+        pending--;
+        stats.dropped++;
+    }
+    queues[level].push_back({ format(team ? "say_team \"" : "say \"", message, '"'), level });
+    pending++;
+    stats.queued++;
+    return true;
 }
 
 void OnCreateMove()
@@ -21,29 +69,32 @@ void OnCreateMove()
         last_say = 0;
     if (g_GlobalVars->curtime - last_say <= CHATSTACK_INTERVAL)
         return;
-    if (!stack.empty())
+    for (int i = PRIORITY_COUNT - 1; i >= low; i--)
     {
-        const msg_t &msg = stack.top();
-        stack.pop();
-        if (msg.text.size())
-        {
-            // logging::Info("Saying %s %i", msg.text.c_str(), msg.text.size());
-            if (msg.team)
-                g_IEngine->ServerCmd(format("say_team \"", msg.text.c_str(), '"').c_str());
-            else
-                g_IEngine->ServerCmd(format("say \"", msg.text.c_str(), '"').c_str());
-            last_say = g_GlobalVars->curtime;
-        }
+        if (queues[i].empty())
+            continue;
+        // logging::Info("Saying %s", queues[i].front().command.c_str());
+        g_IEngine->ServerCmd(queues[i].front().command.c_str());
+        queues[i].pop_front();
+        pending--;
+        stats.sent++;
+        last_say = g_GlobalVars->curtime;
+        return;
     }
 }
 
 void Reset()
 {
-    while (!stack.empty())
-        stack.pop();
+    for (auto &queue : queues)
+        queue.clear();
+    pending  = 0;
     last_say = 0.0f;
 }
 
-std::stack<msg_t> stack;
+static CatCommand print_stats("chat_queue_stats", "Show chat queue counters", []() {
+    logging::Info("%zu pending (%zu high, %zu normal, %zu low), %llu queued, %llu sent, %llu dropped", pending, queues[high].size(), queues[normal].size(), queues[low].size(), (unsigned long long) stats.queued, (unsigned long long) stats.sent, (unsigned long long) stats.dropped);
+});
+
+stats_s stats{};
 float last_say = 0.0f;
 } // namespace chat_stack
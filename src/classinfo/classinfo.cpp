@@ -6,8 +6,14 @@
  */
 
 #include "common.hpp"
+#include "classinfo/classtable.hpp"
 
-client_classes::dummy *client_class_list = nullptr;
+client_classes::dummy client_class_ids{};
+static bool class_list_ready = false;
+
+#if not GAME_SPECIFIC
+classinfo::class_table_t classinfo::class_table{};
+#endif
 
 #define INST_CLIENT_CLASS_LIST(x) client_classes::x client_classes::x##_list
 
@@ -18,30 +24,44 @@ INST_CLIENT_CLASS_LIST(css);
 
 void InitClassTable()
 {
+    const client_classes::dummy *list = nullptr;
     if (IsTF2())
     {
-        client_class_list = (client_classes::dummy *) &client_classes::tf2_list;
+        list = (client_classes::dummy *) &client_classes::tf2_list;
     }
     if (IsTF2C())
     {
-        client_class_list = (client_classes::dummy *) &client_classes::tf2c_list;
+        list = (client_classes::dummy *) &client_classes::tf2c_list;
     }
     if (IsHL2DM())
     {
-        client_class_list = (client_classes::dummy *) &client_classes::hl2dm_list;
+        list = (client_classes::dummy *) &client_classes::hl2dm_list;
     }
     if (IsCSS())
     {
-        client_class_list = (client_classes::dummy *) &client_classes::css_list;
+        list = (client_classes::dummy *) &client_classes::css_list;
     }
     if (IsDynamic())
     {
-        client_class_list = (client_classes::dummy *) &client_classes::dynamic_list;
+        client_classes::dynamic_list.Populate();
+        list = (client_classes::dummy *) &client_classes::dynamic_list;
     }
-    if (!client_class_list)
+    if (!list)
     {
         logging::Info("FATAL: Cannot initialize class list! Game will crash if "
                       "cathook is enabled.");
         // cathook = false;
+        return;
     }
+    client_class_ids = *list;
+    class_list_ready = true;
+    RebuildClassTable();
+}
+
+void RebuildClassTable()
+{
+#if not GAME_SPECIFIC
+    if (class_list_ready)
+        classinfo::class_table = classinfo::BuildClassTable();
+#endif
 }
@@ -6,6 +6,7 @@
  */
 
 #include "common.hpp"
+#include "copypasted/CDumper.hpp"
 
 void PerformClassDump()
 {
@@ -24,4 +25,36 @@ void PerformClassDump()
 
 static CatCommand do_dump("debug_dump_classes", "Dump classes", PerformClassDump);
 
-static CatCommand populate_dynamic("debug_populate_dynamic", "Populate dynamic class table", []() { client_classes::dynamic_list.Populate(); });
+static void DumpNetvarPaths(FILE *out, RecvTable *table, std::string &path, int base)
+{
+    size_t length = path.size();
+    for (int i = 0; i < table->GetNumProps(); i++)
+    {
+        RecvProp *prop = table->GetProp(i);
+        path.resize(length);
+        path += '/';
+        path += prop->GetName();
+        fprintf(out, "%s %d\n", path.c_str(), base + prop->GetOffset());
+        if (prop->GetType() == DPT_DataTable)
+            DumpNetvarPaths(out, prop->GetDataTable(), path, base + prop->GetOffset());
+    }
+    path.resize(length);
+}
+
+// The flat list is what class_dumping/generate-netvar-schema.js checks netvars.json against
+static CatCommand dump_netvars("debug_dump_netvars", "Dump netvars to /tmp/netdump.txt and every netvar path to /tmp/cathook-netvars.txt", []() {
+    CDumper dumper;
+    dumper.SaveDump();
+    FILE *out = fopen("/tmp/cathook-netvars.txt", "w");
+    if (!out)
+        return;
+    std::string path;
+    for (ClientClass *cc = g_IBaseClient->GetAllClasses(); cc; cc = cc->m_pNext)
+    {
+        path = cc->m_pRecvTable->GetName();
+        DumpNetvarPaths(out, cc->m_pRecvTable, path, 0);
+    }
+    fclose(out);
+});
+
+static CatCommand populate_dynamic("debug_populate_dynamic", "Populate dynamic class table", []() { InitClassTable(); });
@@ -2,6 +2,9 @@
 //#include "SDK.h"
 
 #include "common.hpp"
+#include "core/resolvecache.hpp"
+#include <immintrin.h>
+#include <mutex>
 
 // module should be a pointer to the base of an elf32 module
 // this is not the value returned by dlopen (which returns an opaque handle to
@@ -68,50 +71,183 @@ int GetBytes(const char *x)
     return GetBits(x[0]) << 4 | GetBits(x[1]);
 }
 
-/* Shoutouts
- * To
- * Marc3842h
- * for
- * the
- * way
- * better
- * sigscan
- */
-uintptr_t CSignature::dwFindPattern(uintptr_t dwAddress, uintptr_t dwLength, const char *szPattern)
+CSignature_space::CompiledPattern::CompiledPattern(const char *pattern)
 {
-    const char *pattern  = szPattern;
-    uintptr_t firstMatch = 0;
+    for (const char *at = pattern; *at;)
+    {
+        if (*at == ' ')
+            at++;
+        else if (*at == '\?')
+        {
+            // Both "?" and "??" are one wildcard byte
+            while (*at == '\?')
+                at++;
+            bytes.push_back(0);
+            mask.push_back(0);
+        }
+        else
+        {
+            bytes.push_back(GetBytes(at));
+            mask.push_back(1);
+            at += at[1] ? 2 : 1;
+        }
+    }
+    while (first < mask.size() && !mask[first])
+        first++;
+    last = mask.size() ? mask.size() - 1 : 0;
+    while (last > first && !mask[last])
+        last--;
+}
+
+using CSignature_space::CompiledPattern;
 
-    uintptr_t start = dwAddress;
-    uintptr_t end   = dwLength;
+// First position in [begin, end) where the pattern matches, the vector loops only look at
+// starts where both the first and the last fixed byte match before comparing the rest
+__attribute__((target("avx2"))) static const uint8_t *ScanAVX2(const uint8_t *begin, const uint8_t *end, const CompiledPattern &pattern)
+{
+    const uint8_t *limit = end - pattern.bytes.size();
+    __m256i first        = _mm256_set1_epi8(pattern.bytes[pattern.first]);
+    __m256i last         = _mm256_set1_epi8(pattern.bytes[pattern.last]);
+    const uint8_t *at    = begin;
+    for (; at + pattern.last + 32 <= end && at <= limit; at += 32)
+    {
+        __m256i a     = _mm256_loadu_si256((const __m256i *) (at + pattern.first));
+        __m256i b     = _mm256_loadu_si256((const __m256i *) (at + pattern.last));
+        uint32_t hits = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+        while (hits)
+        {
+            const uint8_t *candidate = at + __builtin_ctz(hits);
+            if (candidate > limit)
+                return nullptr;
+            if (pattern.Matches(candidate))
+                return candidate;
+            hits &= hits - 1;
+        }
+    }
+    for (; at <= limit; at++)
+        if (pattern.Matches(at))
+            return at;
+    return nullptr;
+}
 
-    for (uintptr_t pos = start; pos < end; pos++)
+__attribute__((target("sse2"))) static const uint8_t *ScanSSE2(const uint8_t *begin, const uint8_t *end, const CompiledPattern &pattern)
+{
+    const uint8_t *limit = end - pattern.bytes.size();
+    __m128i first        = _mm_set1_epi8(pattern.bytes[pattern.first]);
+    __m128i last         = _mm_set1_epi8(pattern.bytes[pattern.last]);
+    const uint8_t *at    = begin;
+    for (; at + pattern.last + 16 <= end && at <= limit; at += 16)
     {
-        if (*pattern == 0)
-            return firstMatch;
+        __m128i a     = _mm_loadu_si128((const __m128i *) (at + pattern.first));
+        __m128i b     = _mm_loadu_si128((const __m128i *) (at + pattern.last));
+        uint32_t hits = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (hits)
+        {
+            const uint8_t *candidate = at + __builtin_ctz(hits);
+            if (candidate > limit)
+                return nullptr;
+            if (pattern.Matches(candidate))
+                return candidate;
+            hits &= hits - 1;
+        }
+    }
+    for (; at <= limit; at++)
+        if (pattern.Matches(at))
+            return at;
+    return nullptr;
+}
 
-        const uint8_t currentPattern = *reinterpret_cast<const uint8_t *>(pattern);
-        const uint8_t currentMemory  = *reinterpret_cast<const uint8_t *>(pos);
+static const uint8_t *Scan(const uint8_t *begin, const uint8_t *end, const CompiledPattern &pattern)
+{
+    if (pattern.bytes.empty() || size_t(end - begin) < pattern.bytes.size())
+        return nullptr;
+    // Nothing but wildcards
+    if (pattern.first >= pattern.bytes.size())
+        return begin;
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2 ? ScanAVX2(begin, end, pattern) : ScanSSE2(begin, end, pattern);
+}
 
-        if (currentPattern == '\?' || currentMemory == GetBytes(pattern))
+// Finds the first match of every pattern in one pass. Patterns are bucketed by a pair of consecutive fixed bytes,
+// so each position costs one lookup in a 64k bit table. Patterns without such a pair get a scan of their own
+static void ScanMany(const uint8_t *begin, const uint8_t *end, const std::vector<CompiledPattern> &patterns, std::vector<const uint8_t *> &out)
+{
+    out.assign(patterns.size(), nullptr);
+    struct bucket_entry
+    {
+        uint16_t key;
+        uint32_t anchor;
+        size_t index;
+        bool operator<(const bucket_entry &other) const
         {
-            if (firstMatch == 0)
-                firstMatch = pos;
+            return key < other.key;
+        }
+    };
+    // Most patterns start with a function prologue, bucketing on that would check nearly all of them at every function.
+    // A sample of the section tells which of their byte pairs are rare
+    std::vector<uint32_t> frequency(65536, 0);
+    for (const uint8_t *at = begin; at + 1 < end; at += 61)
+        frequency[at[0] | at[1] << 8]++;
 
-            if (pattern[2] == 0)
+    std::vector<bucket_entry> entries;
+    std::vector<uint64_t> present(65536 / 64, 0);
+    for (size_t i = 0; i < patterns.size(); i++)
+    {
+        auto &pattern = patterns[i];
+        uint32_t best = UINT32_MAX;
+        uint16_t key  = 0;
+        for (uint32_t j = pattern.first; j < pattern.last; j++)
+        {
+            if (!pattern.mask[j] || !pattern.mask[j + 1])
+                continue;
+            uint16_t pair = pattern.bytes[j] | pattern.bytes[j + 1] << 8;
+            if (best == UINT32_MAX || frequency[pair] < frequency[key])
             {
-                logging::Info("Found pattern \"%s\" at 0x%08X.", szPattern, firstMatch);
-                return firstMatch;
+                best = j;
+                key  = pair;
             }
-
-            pattern += currentPattern != '\?' ? 3 : 2;
         }
-        else
+        if (best == UINT32_MAX)
         {
-            pattern    = szPattern;
-            firstMatch = 0;
+            out[i] = Scan(begin, end, pattern);
+            continue;
+        }
+        entries.push_back(bucket_entry{ key, best, i });
+        present[key >> 6] |= 1ull << (key & 63);
+    }
+    std::sort(entries.begin(), entries.end());
+
+    size_t remaining = entries.size();
+    for (const uint8_t *at = begin; remaining && at + 1 < end; at++)
+    {
+        uint16_t key = at[0] | at[1] << 8;
+        if (!(present[key >> 6] & (1ull << (key & 63))))
+            continue;
+        auto range = std::equal_range(entries.begin(), entries.end(), bucket_entry{ key, 0, 0 });
+        for (auto entry = range.first; entry != range.second; entry++)
+        {
+            auto &pattern = patterns[entry->index];
+            if (out[entry->index] || size_t(at - begin) < entry->anchor)
+                continue;
+            const uint8_t *start = at - entry->anchor;
+            if (size_t(end - start) >= pattern.bytes.size() && pattern.Matches(start))
+            {
+                out[entry->index] = start;
+                remaining--;
+            }
         }
     }
+}
+
+uintptr_t CSignature::dwFindPattern(uintptr_t dwAddress, uintptr_t dwLength, const char *szPattern)
+{
+    CompiledPattern pattern(szPattern);
+    auto match = Scan((const uint8_t *) dwAddress, (const uint8_t *) dwLength, pattern);
+    if (match)
+    {
+        logging::Info("Found pattern \"%s\" at 0x%08X.", szPattern, (uintptr_t) match);
+        return (uintptr_t) match;
+    }
     logging::Info("THIS IS SERIOUS: Could not locate signature: "
                   "\n============\n\"%s\"\n============",
                   szPattern);
@@ -164,21 +300,65 @@ void *CSignature::GetModuleHandleSafe(const char *pszModuleName)
     return moduleHandle;
 }
 
-static CSignature_space::SharedObjStorage objects[CSignature_space::entry_count];
+// Function local so it's constructed before the first static initializer asking for a signature
+static CSignature_space::SharedObjStorage *Objects()
+{
+    static CSignature_space::SharedObjStorage objects[CSignature_space::entry_count];
+    return objects;
+}
 
-uintptr_t CSignature::GetSignature(const char *chPattern, sharedobj::SharedObject &obj, int idx)
+// Signatures get resolved from static initializers and the job pool alike
+static std::mutex objects_lock;
+
+// we need to remap the address that we got from the pattern search from our
+// mapped file to the actual memory we do this by rebasing the address
+// (subbing the mmapped one and replacing it with the dlopened one.
+static uintptr_t Rebase(const CSignature_space::SharedObjStorage &object, uintptr_t address)
+{
+    if (!address)
+        return 0;
+    return address - (uintptr_t) (object.module) + object.moduleMap->l_addr;
+}
+
+static void PrefetchLocked(CSignature_space::SharedObjStorage &object, const std::vector<std::string> &patterns)
+{
+    std::vector<std::string> pending;
+    std::vector<CompiledPattern> compiled;
+    for (auto &pattern : patterns)
+        if (!object.found.count(pattern))
+        {
+            pending.push_back(pattern);
+            compiled.emplace_back(pattern.c_str());
+        }
+    if (pending.empty())
+        return;
+    auto text = (const uint8_t *) object.module + object.textOffset;
+    std::vector<const uint8_t *> matches;
+    ScanMany(text, text + object.textSize, compiled, matches);
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        if (!matches[i])
+            logging::Info("THIS IS SERIOUS: Could not locate signature: "
+                          "\n============\n\"%s\"\n============",
+                          pending[i].c_str());
+        object.found[pending[i]] = Rebase(object, (uintptr_t) matches[i]);
+    }
+    logging::Info("Resolved %u signatures in %s in one pass", pending.size(), object.name.c_str());
+}
+
+static CSignature_space::SharedObjStorage *LoadObject(sharedobj::SharedObject &obj, int idx)
 {
     // we need to do this becuase (i assume that) under the hood, dlopen only
     // loads up the sections that it needs into memory, meaning that we cannot
     // get the string table from the module.
 
-    auto &object = objects[idx];
+    auto &object = Objects()[idx];
     if (!object.inited)
     {
         int fd       = open(obj.path.c_str(), O_RDONLY);
         void *module = mmap(NULL, lseek(fd, 0, SEEK_END), PROT_READ, MAP_SHARED, fd, 0);
         if ((unsigned) module == 0xffffffff)
-            return NULL;
+            return nullptr;
         link_map *moduleMap = obj.lmap;
 
         // static void *module = (void *)moduleMap->l_addr;
@@ -191,15 +371,65 @@ uintptr_t CSignature::GetSignature(const char *chPattern, sharedobj::SharedObjec
 
         object        = CSignature_space::SharedObjStorage(module, moduleMap, textOffset, textSize);
         object.inited = true;
+        object.name   = obj.file;
+        object.key    = resolve_cache::ModuleKey(obj.path);
+
+        resolve_cache::entries_t cached;
+        if (resolve_cache::Get("sig:" + object.name, object.key, cached))
+        {
+            for (auto &entry : cached)
+                object.found[entry.first] = entry.second + moduleMap->l_addr;
+            logging::Info("Loaded %u cached signatures for %s", cached.size(), object.name.c_str());
+        }
+        // The game updated, look for everything the last build needed in one go
+        else if (resolve_cache::GetAny("sig:" + object.name, cached))
+        {
+            std::vector<std::string> patterns;
+            for (auto &entry : cached)
+                patterns.push_back(entry.first);
+            PrefetchLocked(object, patterns);
+        }
     }
+    return &object;
+}
 
-    // we need to remap the address that we got from the pattern search from our
-    // mapped file to the actual memory we do this by rebasing the address
-    // (subbing the mmapped one and replacing it with the dlopened one.
-    uintptr_t patr = dwFindPattern(((uintptr_t) object.module) + object.textOffset, ((uintptr_t) object.module) + object.textOffset + object.textSize, chPattern);
-    if (!patr)
+uintptr_t CSignature::GetSignature(const char *chPattern, sharedobj::SharedObject &obj, int idx)
+{
+    std::lock_guard<std::mutex> lock(objects_lock);
+    auto object = LoadObject(obj, idx);
+    if (!object)
         return NULL;
-    return patr - (uintptr_t)(object.module) + object.moduleMap->l_addr;
+    auto cached = object->found.find(chPattern);
+    if (cached != object->found.end())
+        return cached->second;
+
+    uintptr_t patr = dwFindPattern(((uintptr_t) object->module) + object->textOffset, ((uintptr_t) object->module) + object->textOffset + object->textSize, chPattern);
+    return object->found[chPattern] = Rebase(*object, patr);
+}
+
+void CSignature::Prefetch(const std::vector<std::string> &patterns, sharedobj::SharedObject &obj, int idx)
+{
+    std::lock_guard<std::mutex> lock(objects_lock);
+    auto object = LoadObject(obj, idx);
+    if (object)
+        PrefetchLocked(*object, patterns);
+}
+
+void CSignature::StoreCache()
+{
+    std::lock_guard<std::mutex> lock(objects_lock);
+    for (int i = 0; i < CSignature_space::entry_count; i++)
+    {
+        auto &object = Objects()[i];
+        if (!object.inited)
+            continue;
+        resolve_cache::entries_t entries;
+        // Misses aren't stored, they get logged again next launch instead of silently being 0
+        for (auto &entry : object.found)
+            if (entry.second)
+                entries[entry.first] = entry.second - object.moduleMap->l_addr;
+        resolve_cache::Put("sig:" + object.name, object.key, entries);
+    }
 }
 //===================================================================================
 uintptr_t CSignature::GetClientSignature(const char *chPattern)
@@ -227,4 +457,17 @@ uintptr_t CSignature::GetVstdSignature(const char *chPattern)
     return GetSignature(chPattern, sharedobj::vstdlib(), CSignature_space::vstd);
 }
 
+// Maps every module and loads its cached signatures, or finds last build's all at once after an update, while the main thread routines run
+static InitRoutine warm_signatures(
+    "signatures",
+    []() {
+        std::pair<sharedobj::SharedObject *, int> modules[] = { { &sharedobj::client(), CSignature_space::client }, { &sharedobj::engine(), CSignature_space::engine }, { &sharedobj::steamapi(), CSignature_space::steamapi }, { &sharedobj::vstdlib(), CSignature_space::vstd }, { &sharedobj::launcher(), CSignature_space::launcher } };
+        for (auto &module : modules)
+        {
+            std::lock_guard<std::mutex> lock(objects_lock);
+            LoadObject(*module.first, module.second);
+        }
+    },
+    startup::any_thread);
+
 CSignature gSignatures;
@@ -1,12 +1,102 @@
 #include "common.hpp"
+#include "core/resolvecache.hpp"
+#include <unordered_set>
+
+void netvar_tree::init()
+{
+    resolve_cache::entries_t cached;
+    if (resolve_cache::Get("netvar:client", resolve_cache::ModuleKey(sharedobj::client().path), cached))
+    {
+        for (auto &entry : cached)
+            resolved[entry.first] = int(entry.second);
+        logging::Info("Loaded %u cached netvar offsets", cached.size());
+    }
+}
+
+void netvar_tree::store_cache()
+{
+    resolve_cache::entries_t entries;
+    for (auto &entry : resolved)
+        entries[entry.first] = uintptr_t(entry.second);
+    resolve_cache::Put("netvar:client", resolve_cache::ModuleKey(sharedobj::client().path), entries);
+}
+
+struct netvar_tree::walk_s
+{
+    // Path to the indices asking for it, removed once found so the first prop of a name wins like in the tree
+    std::unordered_map<std::string, std::vector<size_t>> wanted;
+    // Every table path some wanted prop is under, nothing else gets descended into
+    std::unordered_set<std::string> prefixes;
+    std::vector<int> *offsets;
+};
+
+std::vector<int> netvar_tree::resolve_all(const std::vector<std::string> &paths)
+{
+    std::vector<int> offsets(paths.size(), 0);
+    walk_s state;
+    state.offsets = &offsets;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        auto cached = resolved.find(paths[i]);
+        if (cached != resolved.end())
+        {
+            offsets[i] = cached->second;
+            continue;
+        }
+        state.wanted[paths[i]].push_back(i);
+        for (size_t at = paths[i].find('/'); at != std::string::npos; at = paths[i].find('/', at + 1))
+            state.prefixes.insert(paths[i].substr(0, at));
+    }
+    if (state.wanted.empty())
+        return offsets;
+
+    std::string path;
+    for (auto *client_class = g_IBaseClient->GetAllClasses(); client_class && !state.wanted.empty(); client_class = client_class->m_pNext)
+    {
+        auto *recv_table = client_class->m_pRecvTable;
+        path             = recv_table->GetName();
+        // Only the first table of a name, same as the tree
+        if (state.prefixes.erase(path))
+            walk(recv_table, path, 0, state);
+    }
+    for (auto &missing : state.wanted)
+        logging::Info("can't find %s!", missing.first.c_str());
+    return offsets;
+}
+
+void netvar_tree::walk(RecvTable *recv_table, std::string &path, int base, walk_s &state)
+{
+    size_t length = path.size();
+    for (int i = 0; i < recv_table->GetNumProps(); i++)
+    {
+        const auto *prop = recv_table->GetProp(i);
+        path.resize(length);
+        path += '/';
+        path += prop->GetName();
+        int offset = base + prop->GetOffset();
+        auto found = state.wanted.find(path);
+        if (found != state.wanted.end())
+        {
+            for (size_t index : found->second)
+                (*state.offsets)[index] = offset;
+            if (offset)
+                resolved[path] = offset;
+            state.wanted.erase(found);
+        }
+        if (prop->GetType() == DPT_DataTable && state.prefixes.count(path))
+            walk(prop->GetDataTable(), path, offset, state);
+    }
+    path.resize(length);
+}
 
 /**
- * netvar_tree - Constructor
+ * build - Build the tree
  *
  * Call populate_nodes on every RecvTable under client->GetAllClasses()
  */
-void netvar_tree::init()
+void netvar_tree::build()
 {
+    built = true;
     const auto *client_class = g_IBaseClient->GetAllClasses();
     while (client_class != nullptr)
     {
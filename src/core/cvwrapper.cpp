@@ -8,6 +8,7 @@
 #include <core/cvwrapper.hpp>
 #include <helpers.hpp>
 #include <common.hpp>
+#include <core/perfecthash.hpp>
 
 std::vector<CatCommand *> &commandRegistrationArray()
 {
@@ -49,6 +50,76 @@ void CatCommand::Register()
     // name_c and help_c are not freed because ConCommandBase doesn't copy them
 }
 
+static perfect_hash<ConCommand *> command_table;
+// Size of RegisteredCommandsList the table was built for, commands only ever get added
+static size_t command_table_built = 0;
+
+static const perfect_hash<ConCommand *> &CommandTable()
+{
+    auto &list = RegisteredCommandsList();
+    if (command_table_built != list.size())
+    {
+        std::vector<std::pair<std::string_view, ConCommand *>> entries;
+        entries.reserve(list.size());
+        for (auto cmd : list)
+            entries.emplace_back(cmd->GetName(), cmd);
+        command_table.Build(std::move(entries));
+        command_table_built = list.size();
+    }
+    return command_table;
+}
+
+// First token of a command, quoted or up to the next whitespace
+static std::string_view CommandName(std::string_view command)
+{
+    size_t start = command.find_first_not_of(" \t\r");
+    if (start == command.npos)
+        return {};
+    if (command[start] == '"')
+    {
+        size_t end = command.find('"', start + 1);
+        return command.substr(start + 1, end == command.npos ? command.npos : end - start - 1);
+    }
+    size_t end = command.find_first_of(" \t\r", start);
+    return command.substr(start, end == command.npos ? command.npos : end - start);
+}
+
+bool DispatchCatCommands(std::string_view line)
+{
+    std::array<std::pair<std::string_view, ConCommand *>, 16> commands;
+    size_t count = 0;
+    auto &table  = CommandTable();
+    // Split like the engine's command buffer, on ; and newlines outside of quotes
+    bool quoted  = false;
+    size_t start = 0;
+    for (size_t i = 0; i <= line.size(); i++)
+    {
+        if (i < line.size() && line[i] == '"')
+            quoted = !quoted;
+        if (i < line.size() && (quoted || (line[i] != ';' && line[i] != '\n')))
+            continue;
+        std::string_view command = line.substr(start, i - start);
+        start                    = i + 1;
+        std::string_view name    = CommandName(command);
+        if (name.empty())
+            continue;
+        auto found = table.Find(name);
+        if (!found || count == commands.size() || command.size() >= size_t(CCommand::COMMAND_MAX_LENGTH))
+            return false;
+        commands[count++] = { command, *found };
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        char buffer[CCommand::COMMAND_MAX_LENGTH];
+        memcpy(buffer, commands[i].first.data(), commands[i].first.size());
+        buffer[commands[i].first.size()] = 0;
+        CCommand args;
+        if (args.Tokenize(buffer))
+            commands[i].second->Dispatch(args);
+    }
+    return count;
+}
+
 void RegisterCatCommands()
 {
     while (!commandRegistrationArray().empty())
@@ -6,25 +6,206 @@
  */
 
 #include "init.hpp"
+#include "core/logging.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
 
-std::stack<void (*)()> &init_stack()
+static std::string FileName(const char *file, int line)
 {
-    static std::stack<void (*)()> stack{};
+    // CMake hands us absolute paths
+    const char *src = strstr(file, "/src/");
+    return std::string(src ? src + 1 : file) + ":" + std::to_string(line);
+}
+
+std::stack<startup::routine> &init_stack()
+{
+    static std::stack<startup::routine> stack{};
     return stack;
 }
 
-InitRoutine::InitRoutine(void (*func)())
+InitRoutine::InitRoutine(void (*func)(), const char *file, int line)
+{
+    init_stack().push(startup::routine{ func, FileName(file, line), startup::main_thread, {} });
+}
+
+InitRoutine::InitRoutine(const char *name, void (*func)(), startup::thread_class threads, std::initializer_list<const char *> after)
 {
-    init_stack().push(func);
+    init_stack().push(startup::routine{ func, name, threads, std::vector<std::string>(after.begin(), after.end()) });
 }
 
-std::stack<void (*)()> &init_stack_early()
+std::stack<startup::routine> &init_stack_early()
 {
-    static std::stack<void (*)()> stack{};
+    static std::stack<startup::routine> stack{};
     return stack;
 }
 
-InitRoutineEarly::InitRoutineEarly(void (*func)())
+InitRoutineEarly::InitRoutineEarly(void (*func)(), const char *file, int line)
 {
-    init_stack_early().push(func);
+    init_stack_early().push(startup::routine{ func, FileName(file, line), startup::main_thread, {} });
+}
+
+namespace startup
+{
+struct state_s
+{
+    std::vector<routine> routines;
+    std::vector<std::vector<size_t>> depends;
+    // Everything below is guarded by lock
+    std::mutex lock;
+    std::condition_variable changed;
+    std::vector<bool> done;
+    std::vector<bool> started;
+    std::vector<double> took_ms;
+    std::vector<bool> on_worker;
+    std::deque<size_t> queue;
+    unsigned running{ 0 };
+    bool stop{ false };
+
+    bool Ready(size_t i)
+    {
+        for (auto dependency : depends[i])
+            if (!done[dependency])
+                return false;
+        return true;
+    }
+    // Queue every worker routine that can go now
+    void Schedule()
+    {
+        for (size_t i = 0; i < routines.size(); i++)
+            if (routines[i].threads == any_thread && !started[i] && Ready(i))
+            {
+                started[i] = true;
+                queue.push_back(i);
+            }
+    }
+    void Execute(std::unique_lock<std::mutex> &guard, size_t i, bool worker)
+    {
+        started[i] = true;
+        running++;
+        guard.unlock();
+        auto start = std::chrono::steady_clock::now();
+        routines[i].func();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        guard.lock();
+        running--;
+        done[i]      = true;
+        took_ms[i]   = ms;
+        on_worker[i] = worker;
+        Schedule();
+        changed.notify_all();
+    }
+    // Nothing that could ever make i ready is left running or queued
+    bool Stuck(size_t i)
+    {
+        return !Ready(i) && !running && queue.empty();
+    }
+};
+
+static void Worker(state_s &state)
+{
+    std::unique_lock<std::mutex> guard(state.lock);
+    while (true)
+    {
+        state.changed.wait(guard, [&]() { return state.stop || !state.queue.empty(); });
+        if (state.queue.empty())
+            return;
+        size_t i = state.queue.front();
+        state.queue.pop_front();
+        state.Execute(guard, i, true);
+    }
+}
+
+void Run(std::stack<routine> &stack, const char *what)
+{
+    auto start = std::chrono::steady_clock::now();
+    state_s state;
+    while (!stack.empty())
+    {
+        state.routines.push_back(std::move(stack.top()));
+        stack.pop();
+    }
+    size_t count = state.routines.size();
+    state.depends.resize(count);
+    state.done.resize(count, false);
+    state.started.resize(count, false);
+    state.took_ms.resize(count, 0.0);
+    state.on_worker.resize(count, false);
+
+    unsigned workers = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (state.routines[i].threads == any_thread)
+            workers++;
+        for (auto &name : state.routines[i].after)
+        {
+            auto found = std::find_if(state.routines.begin(), state.routines.end(), [&](const routine &other) { return other.name == name; });
+            if (found == state.routines.end())
+            {
+                logging::Info("%s: %s depends on unknown routine %s", what, state.routines[i].name.c_str(), name.c_str());
+                continue;
+            }
+            state.depends[i].push_back(found - state.routines.begin());
+        }
+    }
+    workers = std::min(workers, std::max(std::thread::hardware_concurrency(), 2u) - 1);
+
+    std::vector<std::thread> pool;
+    std::unique_lock<std::mutex> guard(state.lock);
+    state.Schedule();
+    for (unsigned i = 0; i < workers; i++)
+        pool.emplace_back(Worker, std::ref(state));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (state.routines[i].threads != main_thread)
+            continue;
+        state.changed.wait(guard, [&]() { return state.Ready(i) || state.Stuck(i); });
+        if (!state.Ready(i))
+            logging::Info("%s: %s waits on routines that can only run after it, running it anyway", what, state.routines[i].name.c_str());
+        state.Execute(guard, i, false);
+    }
+    state.changed.wait(guard, [&]() { return !state.running && state.queue.empty(); });
+    state.stop = true;
+    state.changed.notify_all();
+    guard.unlock();
+    for (auto &thread : pool)
+        thread.join();
+
+    // Worker routines with dependency cycles, run in order so they at least get to run once
+    for (size_t i = 0; i < count; i++)
+        if (!state.done[i])
+        {
+            logging::Info("%s: %s has a dependency cycle, running it anyway", what, state.routines[i].name.c_str());
+            guard.lock();
+            state.Execute(guard, i, false);
+            guard.unlock();
+        }
+
+    double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double sum   = 0.0;
+    std::vector<size_t> order;
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += state.took_ms[i];
+        order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return state.took_ms[a] > state.took_ms[b]; });
+    logging::Info("%s: %u routines took %.1fms, %.1fms with %u workers", what, count, sum, total, workers);
+    size_t shown = 0;
+    for (auto i : order)
+    {
+        // The rest are just callback registrations
+        if (state.took_ms[i] < 1.0)
+            break;
+        logging::Info("%8.1fms%s %s", state.took_ms[i], state.on_worker[i] ? " (worker)" : "", state.routines[i].name.c_str());
+        shown++;
+    }
+    if (shown < count)
+        logging::Info("    %u more under 1ms", count - shown);
 }
+} // namespace startup
@@ -0,0 +1,49 @@
+#include "common.hpp"
+#include "core/levelarena.hpp"
+#include "memtrack.hpp"
+
+namespace level_arena
+{
+static std::mutex &lock()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Function statics, containers at namespace scope get constructed during static init
+std::pmr::memory_resource *resource()
+{
+    static std::pmr::synchronized_pool_resource pool(memtrack::resource(memtrack::tag_level));
+    return &pool;
+}
+
+static std::vector<std::pair<void *, void (*)(void *)>> &tracked()
+{
+    static std::vector<std::pair<void *, void (*)(void *)>> list;
+    return list;
+}
+
+void Track(void *owner, void (*reset)(void *))
+{
+    std::lock_guard<std::mutex> guard(lock());
+    tracked().emplace_back(owner, reset);
+}
+
+void Untrack(void *owner)
+{
+    std::lock_guard<std::mutex> guard(lock());
+    auto &list = tracked();
+    list.erase(std::remove_if(list.begin(), list.end(), [&](const std::pair<void *, void (*)(void *)> &entry) { return entry.first == owner; }), list.end());
+}
+
+void Release()
+{
+    std::lock_guard<std::mutex> guard(lock());
+    // Emptied containers give their blocks back to the pool, which costs next to nothing before the release
+    for (auto &entry : tracked())
+        entry.second(entry.first);
+    static_cast<std::pmr::synchronized_pool_resource *>(resource())->release();
+}
+
+static InitRoutine init([]() { EC::Register(EC::LevelShutdown, Release, "level_arena_release", EC::very_late); });
+} // namespace level_arena
@@ -6,7 +6,13 @@
  */
 
 #include <stdarg.h>
-#include <string>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <ctime>
 
 #include <pwd.h>
 #include <settings/Bool.hpp>
@@ -18,33 +24,197 @@
 static settings::Boolean log_to_console{ "hack.log-console", "false" };
 
 static bool shut_down = false;
-std::ofstream logging::handle{ nullptr };
 
 #if ENABLE_LOGGING
+namespace
+{
+// Lines are queued by any thread and written in batches by the writer thread
+constexpr size_t RING_SIZE  = 1024;
+constexpr size_t LINE_SIZE  = 512;
+constexpr size_t BATCH_SIZE = 64 * 1024;
+
+struct LogSlot
+{
+    std::atomic<size_t> sequence;
+    time_t time;
+    unsigned length;
+    char text[LINE_SIZE];
+};
+
+struct LogRing
+{
+    LogRing()
+    {
+        for (size_t i = 0; i < RING_SIZE; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    LogSlot slots[RING_SIZE];
+    std::atomic<size_t> head{ 0 };
+    // Only touched while holding consumer
+    size_t tail{ 0 };
+    std::atomic_flag consumer = ATOMIC_FLAG_INIT;
+};
+
+LogRing ring;
+int log_fd = -1;
+std::once_flag init_flag;
+std::thread writer;
+std::atomic<bool> writer_stop{ false };
+std::atomic<unsigned> dropped{ 0 };
+// Holder of ring.consumer, so a forced drain can tell its own interrupted batch apart from another thread's
+std::atomic<std::thread::id> consumer_owner{};
+
+// Only used by whoever holds ring.consumer
+char batch[BATCH_SIZE];
+time_t stamp_time = -1;
+char stamp[16];
+} // namespace
+
+static bool Push(const char *text, unsigned length)
+{
+    size_t pos = ring.head.load(std::memory_order_relaxed);
+    LogSlot *slot;
+    for (;;)
+    {
+        slot          = &ring.slots[pos & (RING_SIZE - 1)];
+        size_t seq    = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0)
+        {
+            if (ring.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        // Ring is full
+        else if (diff < 0)
+            return false;
+        else
+            pos = ring.head.load(std::memory_order_relaxed);
+    }
+    slot->time   = time(nullptr);
+    slot->length = length;
+    memcpy(slot->text, text, length);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+static void WriteBatch(size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t written = ::write(log_fd, batch + done, size - done);
+        if (written <= 0)
+            return;
+        done += written;
+    }
+}
+
+static bool TryConsume()
+{
+    if (ring.consumer.test_and_set(std::memory_order_acquire))
+        return false;
+    consumer_owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    return true;
+}
+
+static bool AcquireConsumer(bool force)
+{
+    if (TryConsume())
+        return true;
+    if (!force)
+        return false;
+    // The crash handler interrupted this thread mid-batch, nobody else is going to finish it.
+    // Better a duplicated line than a lost log
+    if (consumer_owner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+        return true;
+    // Another thread is writing, let it finish instead of sharing the tail and batch with it
+    for (int i = 0; i < 200; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (TryConsume())
+            return true;
+    }
+    // Whoever has it is stuck, a crash log is worth the risk
+    return true;
+}
+
+static void Drain(bool force)
+{
+    if (!AcquireConsumer(force))
+        return;
+    if (log_fd >= 0)
+    {
+        size_t used = 0;
+        for (;;)
+        {
+            LogSlot &slot = ring.slots[ring.tail & (RING_SIZE - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != ring.tail + 1)
+                break;
+            // The timestamp only changes once a second
+            if (slot.time != stamp_time)
+            {
+                struct tm time_info;
+                stamp_time = slot.time;
+                localtime_r(&stamp_time, &time_info);
+                strftime(stamp, sizeof(stamp), "[%H:%M:%S] ", &time_info);
+            }
+            size_t stamp_length = strlen(stamp);
+            if (used + stamp_length + slot.length + 1 > BATCH_SIZE)
+            {
+                WriteBatch(used);
+                used = 0;
+            }
+            memcpy(batch + used, stamp, stamp_length);
+            used += stamp_length;
+            memcpy(batch + used, slot.text, slot.length);
+            used += slot.length;
+            batch[used++] = '\n';
+
+            slot.sequence.store(ring.tail + RING_SIZE, std::memory_order_release);
+            ring.tail++;
+        }
+        unsigned lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost && used + 64 <= BATCH_SIZE)
+            used += snprintf(batch + used, 64, "%s%u log lines dropped\n", stamp, lost);
+        if (used)
+            WriteBatch(used);
+    }
+    consumer_owner.store(std::thread::id(), std::memory_order_relaxed);
+    ring.consumer.clear(std::memory_order_release);
+}
+
+static void WriterThread()
+{
+    while (!writer_stop.load(std::memory_order_relaxed))
+    {
+        Drain(false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
 void logging::Initialize()
 {
-    // FIXME other method of naming the file?
-    static passwd *pwd = getpwuid(getuid());
-    logging::handle.open(strfmt("/tmp/cathook-%s-%d.log", pwd->pw_name, getpid()).get(), std::ios::out | std::ios::app);
+    std::call_once(init_flag, []() {
+        // FIXME other method of naming the file?
+        passwd *pwd = getpwuid(getuid());
+        log_fd      = open(strfmt("/tmp/cathook-%s-%d.log", pwd->pw_name, getpid()).get(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        writer      = std::thread(WriterThread);
+    });
 }
 #endif
 
-static inline void Log(const char *result, bool file_only)
+static inline void Log(const char *result, int size, bool file_only)
 {
 #if ENABLE_LOGGING
-    if (!logging::handle.is_open())
-        logging::Initialize();
-    time_t current_time;
-    struct tm *time_info = nullptr;
-    char timeString[10];
-    time(&current_time);
-    time_info = localtime(&current_time);
-    strftime(timeString, sizeof(timeString), "%H:%M:%S", time_info);
-
-    std::string to_log = result;
-    to_log             = strfmt("[%s] ", timeString).get() + to_log + "\n";
-    logging::handle << to_log;
-    logging::handle.flush();
+    logging::Initialize();
+    unsigned length = std::min<unsigned>(size, LINE_SIZE - 1);
+    if (!Push(result, length))
+    {
+        // Writer fell behind, help it out once before giving up on the line
+        Drain(false);
+        if (!Push(result, length))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
 #if ENABLE_VISUALS
     if (!hack::shutdown)
     {
@@ -71,7 +241,7 @@ void logging::Info(const char *fmt, ...)
     if(size < 0)
         return;
 
-    Log(result, false);
+    Log(result, size, false);
 #endif
 }
 
@@ -91,15 +261,27 @@ void logging::File(const char *fmt, ...)
     if(size < 0)
         return;
 
-    Log(result, true);
+    Log(result, size, true);
+#endif
+}
+
+void logging::Flush()
+{
+#if ENABLE_LOGGING
+    Drain(true);
 #endif
 }
 
 void logging::Shutdown()
 {
 #if ENABLE_LOGGING
-    if (logging::handle.is_open())
-        logging::handle.close();
     shut_down = true;
+    writer_stop.store(true);
+    if (writer.joinable())
+        writer.join();
+    Drain(false);
+    if (log_fd >= 0)
+        close(log_fd);
+    log_fd = -1;
 #endif
 }
@@ -6,55 +6,382 @@
  */
 
 #include "common.hpp"
+#include <pwd.h>
+#include <sys/syscall.h>
 
 unsigned g_spewcount{ 0 };
 
 static CatCommand profiler_begin("profiler_spew", "Spew and reset", []() { g_spewcount++; });
 
+namespace profiler
+{
+unsigned sample_mask = 0;
+static std::atomic<int> capture_frames{ 0 };
+// What sample_mask goes back to after a capture
+static unsigned configured_mask = 0;
+
+static settings::Int sample_rate{ "debug.profiler.sample-rate", "1" };
+
+static InitRoutine init_sampling([]() {
+    sample_rate.installChangeCallback([](settings::VariableBase<int> &, int after) {
+        // Round up to a power of two so sampling is a single mask
+        unsigned rate = 1;
+        while (rate < unsigned(std::max(after, 1)) && rate < (1u << 16))
+            rate <<= 1;
+        configured_mask = rate - 1;
+        if (!capture_frames.load())
+            sample_mask = configured_mask;
+    });
+});
+
+// Every live section, for profiler_enable. Function statics since sections get created during static init
+static std::mutex &sections_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+static std::vector<ProfilerSection *> &sections()
+{
+    static std::vector<ProfilerSection *> list;
+    return list;
+}
+
+static const uint64_t base_ticks = Now();
+static const auto base_time      = std::chrono::steady_clock::now();
+
+double NsPerTick()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    static double calibrated = 0.0;
+    if (calibrated != 0.0)
+        return calibrated;
+    uint64_t ticks = Now() - base_ticks;
+    double ns      = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - base_time).count();
+    if (!ticks)
+        return 1.0;
+    // Too close to injection for a stable ratio, use it but try again next time
+    if (ns < 1e8)
+        return ns / ticks;
+    calibrated = ns / ticks;
+    return calibrated;
+#else
+    return 1.0;
+#endif
+}
+
+// Frame capture, every thread records into its own buffer
+constexpr size_t TRACE_EVENTS = 1 << 16;
+
+struct TraceEvent
+{
+    const ProfilerSection *section;
+    uint64_t start;
+    uint64_t end;
+};
+
+struct ThreadTrace
+{
+    TraceEvent events[TRACE_EVENTS];
+    std::atomic<size_t> count{ 0 };
+    long tid;
+};
+
+static std::mutex traces_mutex;
+static std::vector<ThreadTrace *> traces;
+static thread_local ThreadTrace *thread_trace = nullptr;
+static std::vector<uint64_t> frame_marks;
+
+static void Record(const ProfilerSection *section, uint64_t start, uint64_t end)
+{
+    if (!thread_trace)
+    {
+        // Never freed, exported traces may outlive the thread
+        thread_trace      = new ThreadTrace();
+        thread_trace->tid = syscall(SYS_gettid);
+        std::lock_guard<std::mutex> lock(traces_mutex);
+        traces.push_back(thread_trace);
+    }
+    size_t n = thread_trace->count.load(std::memory_order_relaxed);
+    if (n >= TRACE_EVENTS)
+        return;
+    thread_trace->events[n] = { section, start, end };
+    thread_trace->count.store(n + 1, std::memory_order_release);
+}
+
+static void WriteEscaped(std::ofstream &out, const std::string &text)
+{
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+}
+
+static void Export()
+{
+    passwd *pwd      = getpwuid(getuid());
+    std::string path = strfmt("/tmp/cathook-%s-%d-trace-%ld.json", pwd->pw_name, getpid(), (long) time(nullptr)).get();
+    std::ofstream out(path);
+    if (!out)
+    {
+        logging::Info("[P] Failed to open %s", path.c_str());
+        return;
+    }
+    double ns_per_tick = NsPerTick();
+    uint64_t origin    = frame_marks.empty() ? base_ticks : frame_marks.front();
+    auto to_us         = [&](uint64_t ticks) { return (double) (int64_t)(ticks - origin) * ns_per_tick / 1000.0; };
+    long pid           = getpid();
+    size_t total       = 0;
+    bool first         = true;
+
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < frame_marks.size(); i++)
+    {
+        out << (first ? "" : ",") << "{\"name\":\"frame " << i << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":" << pid << ",\"tid\":0,\"ts\":" << to_us(frame_marks[i]) << "}";
+        first = false;
+    }
+    std::lock_guard<std::mutex> lock(traces_mutex);
+    for (auto trace : traces)
+    {
+        size_t count = trace->count.load(std::memory_order_acquire);
+        total += count;
+        for (size_t i = 0; i < count; i++)
+        {
+            auto &event = trace->events[i];
+            out << (first ? "" : ",") << "{\"name\":\"";
+            WriteEscaped(out, event.section->m_name);
+            out << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << trace->tid << ",\"ts\":" << to_us(event.start) << ",\"dur\":" << (double) (event.end - event.start) * ns_per_tick / 1000.0 << "}";
+            first = false;
+        }
+        if (count >= TRACE_EVENTS)
+            logging::Info("[P] Thread %ld filled its trace buffer, capture is truncated", trace->tid);
+    }
+    out << "]}";
+    logging::Info("[P] Wrote %u events over %u frames to %s", (unsigned) total, (unsigned) frame_marks.size(), path.c_str());
+}
+
+void FrameMark()
+{
+    int frames = capture_frames.load(std::memory_order_relaxed);
+    if (frames <= 0)
+        return;
+    frame_marks.push_back(Now());
+    // The last mark closes the last captured frame
+    if ((int) frame_marks.size() > frames)
+    {
+        capture_frames.store(0);
+        sample_mask = configured_mask;
+        Export();
+    }
+}
+
+void CollectSections(std::vector<section_stats_s> &out)
+{
+    double ns_per_tick = NsPerTick();
+    std::lock_guard<std::mutex> lock(sections_mutex());
+    out.reserve(out.size() + sections().size());
+    for (auto section : sections())
+    {
+        unsigned calls = section->m_calls.load(std::memory_order_relaxed);
+        if (!calls)
+            continue;
+        out.push_back(section_stats_s{ section->m_name, section->m_parent ? section->m_parent->m_name : "", calls, uint64_t(section->m_sum.load(std::memory_order_relaxed) * ns_per_tick), uint64_t(section->m_min.load(std::memory_order_relaxed) * ns_per_tick), uint64_t(section->m_max.load(std::memory_order_relaxed) * ns_per_tick) });
+    }
+}
+
+static CatCommand profiler_capture("profiler_capture", "Capture the next <frames> frames into a chrome://tracing json in /tmp", [](const CCommand &args) {
+    int frames = 1;
+    if (args.ArgC() > 1)
+        frames = std::max(1, atoi(args.Arg(1)));
+    if (capture_frames.load())
+    {
+        logging::Info("[P] Capture already running");
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(traces_mutex);
+        for (auto trace : traces)
+            trace->count.store(0);
+    }
+    frame_marks.clear();
+    // A capture wants every node, not a sample
+    sample_mask = 0;
+    capture_frames.store(frames);
+    logging::Info("[P] Capturing %d frames", frames);
+});
+
+static CatCommand profiler_enable("profiler_enable", "profiler_enable <name part|all> <0|1>, toggle measuring sections", [](const CCommand &args) {
+    if (args.ArgC() < 3)
+    {
+        logging::Info("Usage: profiler_enable <name part|all> <0|1>");
+        return;
+    }
+    std::string filter = args.Arg(1);
+    bool enable        = atoi(args.Arg(2));
+    bool all           = filter == "all";
+    unsigned changed   = 0;
+    std::lock_guard<std::mutex> lock(sections_mutex());
+    for (auto section : sections())
+        if (all || section->m_name.find(filter) != std::string::npos)
+        {
+            section->m_enabled = enable;
+            changed++;
+        }
+    logging::Info("[P] %s %u sections", enable ? "Enabled" : "Disabled", changed);
+});
+} // namespace profiler
+
+// Every node on this thread that has not finished yet, innermost first
+static thread_local ProfilerNode *current_node = nullptr;
+
 ProfilerSection::ProfilerSection(std::string name, ProfilerSection *parent)
 {
-    m_name   = name;
-    m_calls  = 0;
-    m_log    = std::chrono::high_resolution_clock::now();
-    m_min    = std::chrono::nanoseconds::zero();
-    m_max    = std::chrono::nanoseconds::zero();
-    m_sum    = std::chrono::nanoseconds::zero();
-    m_parent = parent;
+    m_name      = name;
+    m_calls     = 0;
+    m_min       = 0;
+    m_max       = 0;
+    m_sum       = 0;
+    m_spewcount = 0;
+    m_parent    = parent;
+    std::lock_guard<std::mutex> lock(profiler::sections_mutex());
+    profiler::sections().push_back(this);
 }
 
-void ProfilerSection::OnNodeDeath(ProfilerNode &node)
+ProfilerSection::~ProfilerSection()
 {
-    auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - node.m_start);
-    if (m_min == std::chrono::nanoseconds::zero())
-        m_min = dur;
-    else if (dur < m_min)
-        m_min = dur;
+    std::lock_guard<std::mutex> lock(profiler::sections_mutex());
+    auto &list = profiler::sections();
+    auto it    = std::find(list.begin(), list.end(), this);
+    if (it != list.end())
+        list.erase(it);
+}
 
-    if (m_max == std::chrono::nanoseconds::zero())
-        m_max = dur;
-    else if (dur > m_max)
-        m_max = dur;
-    m_sum += dur;
-    m_calls++;
+void ProfilerSection::OnNodeDeath(ProfilerNode &node, uint64_t end)
+{
+    Add(node.m_start, end);
+}
 
-    if (g_spewcount > m_spewcount)
+void ProfilerSection::Add(uint64_t start, uint64_t end)
+{
+    uint64_t dur = end - start;
+
+    uint64_t min = m_min.load(std::memory_order_relaxed);
+    while ((!min || dur < min) && !m_min.compare_exchange_weak(min, dur, std::memory_order_relaxed))
+        ;
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (dur > max && !m_max.compare_exchange_weak(max, dur, std::memory_order_relaxed))
+        ;
+    m_sum.fetch_add(dur, std::memory_order_relaxed);
+    m_calls.fetch_add(1, std::memory_order_relaxed);
+
+    if (profiler::capture_frames.load(std::memory_order_relaxed) > 0)
+        profiler::Record(this, start, end);
+
+    unsigned spewcount = m_spewcount.load(std::memory_order_relaxed);
+    if (g_spewcount > spewcount && m_spewcount.compare_exchange_strong(spewcount, g_spewcount))
+        Spew();
+}
+
+void ProfilerSection::Spew()
+{
+    double ns_per_tick = profiler::NsPerTick();
+    unsigned calls     = m_calls.exchange(0);
+    auto sum           = (unsigned long long) (m_sum.exchange(0) * ns_per_tick);
+    auto min           = (unsigned long long) (m_min.exchange(0) * ns_per_tick);
+    auto max           = (unsigned long long) (m_max.exchange(0) * ns_per_tick);
+
+    // Indent by depth so the spew reads as a tree
+    int depth = 0;
+    for (ProfilerSection *parent = m_parent; parent && depth < 8; parent = parent->m_parent)
+        depth++;
+    std::string name = std::string(depth * 2, ' ') + m_name;
+    // Sum and calls are measured ones, multiply by the sample rate for an estimate of the real totals
+    logging::Info("[P],'%-32s',%12llu,%12llu,%12llu,%12llu,%u,'%s',1/%u", name.c_str(), sum, sum / (calls ? calls : 1), min, max, calls, m_parent ? m_parent->m_name.c_str() : "", profiler::sample_mask + 1);
+}
+
+void ProfilerNode::Begin()
+{
+    m_outer      = current_node;
+    current_node = this;
+    // Sections are static, so the first caller we see becomes the parent
+    if (!m_section.m_parent && m_outer && &m_outer->m_section != &m_section)
+        m_section.m_parent = &m_outer->m_section;
+    m_start = profiler::Now();
+}
+
+void ProfilerNode::End()
+{
+    uint64_t end = profiler::Now();
+    current_node = m_outer;
+    m_section.OnNodeDeath(*this, end);
+}
+
+uint64_t ProfilerHistogram::Percentile(float p) const
+{
+    if (!total)
+        return 0;
+    unsigned wanted = unsigned(p * total);
+    unsigned seen   = 0;
+    for (int i = 0; i < BUCKETS; i++)
     {
-        logging::Info("[P],'%-32s',%12llu,%12llu,%12llu,%12llu,%u", m_name.c_str(), std::chrono::duration_cast<std::chrono::nanoseconds>(m_sum).count(), std::chrono::duration_cast<std::chrono::nanoseconds>(m_sum).count() / (m_calls ? m_calls : 1), std::chrono::duration_cast<std::chrono::nanoseconds>(m_min).count(), std::chrono::duration_cast<std::chrono::nanoseconds>(m_max).count(), m_calls);
-        m_log       = std::chrono::high_resolution_clock::now();
-        m_min       = std::chrono::nanoseconds::zero();
-        m_max       = std::chrono::nanoseconds::zero();
-        m_sum       = std::chrono::nanoseconds::zero();
-        m_calls     = 0;
-        m_spewcount = g_spewcount;
+        seen += counts[i];
+        if (seen > wanted || i == BUCKETS - 1)
+        {
+            if (i < SUB_BUCKETS)
+                return i;
+            int shift = i / SUB_BUCKETS - 1;
+            return uint64_t(SUB_BUCKETS + i % SUB_BUCKETS + 1) << shift;
+        }
+    }
+    return 0;
+}
+
+void ProfilerHistogram::Reset()
+{
+    for (auto &count : counts)
+        count = 0;
+    total = 0;
+}
+
+void ProfilerHistogram::Decay()
+{
+    total = 0;
+    for (auto &count : counts)
+    {
+        count >>= 1;
+        total += count;
     }
 }
 
-ProfilerNode::ProfilerNode(ProfilerSection &section) : m_section(section)
+ProfilerCounter::ProfilerCounter(std::string name)
+{
+    m_name      = name;
+    m_hits      = 0;
+    m_misses    = 0;
+    m_spewcount = 0;
+}
+
+void ProfilerCounter::Hit()
+{
+    m_hits++;
+    Spew();
+}
+
+void ProfilerCounter::Miss()
 {
-    m_start = std::chrono::high_resolution_clock::now();
+    m_misses++;
+    Spew();
 }
 
-ProfilerNode::~ProfilerNode()
+void ProfilerCounter::Spew()
 {
-    m_section.OnNodeDeath(*this);
+    if (g_spewcount > m_spewcount)
+    {
+        unsigned total = m_hits + m_misses;
+        logging::Info("[P],'%-32s',hits %u,misses %u,%.1f%%", m_name.c_str(), m_hits, m_misses, total ? 100.0f * m_hits / total : 0.0f);
+        m_hits      = 0;
+        m_misses    = 0;
+        m_spewcount = g_spewcount;
+    }
 }
@@ -0,0 +1,180 @@
+#include "common.hpp"
+#include "core/resolvecache.hpp"
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <mutex>
+
+namespace resolve_cache
+{
+constexpr const char *HEADER = "cathook-resolve-cache 1";
+
+struct section_s
+{
+    std::string key;
+    entries_t entries;
+};
+
+static std::mutex lock;
+static std::unordered_map<std::string, section_s> sections;
+static bool loaded = false;
+static bool dirty  = false;
+
+static std::string CachePath()
+{
+    return paths::getDataPath("/resolve.cache");
+}
+
+static std::string Hex(const uint8_t *data, size_t size)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    for (size_t i = 0; i < size; i++)
+    {
+        out += digits[data[i] >> 4];
+        out += digits[data[i] & 0xF];
+    }
+    return out;
+}
+
+// NT_GNU_BUILD_ID note of the module, read straight from the section headers
+static std::string BuildId(int fd)
+{
+    Elf32_Ehdr ehdr;
+    if (pread(fd, &ehdr, sizeof(ehdr), 0) != sizeof(ehdr) || memcmp(ehdr.e_ident, ELFMAG, SELFMAG) || ehdr.e_ident[EI_CLASS] != ELFCLASS32 || ehdr.e_shentsize != sizeof(Elf32_Shdr))
+        return "";
+    for (int i = 0; i < ehdr.e_shnum; i++)
+    {
+        Elf32_Shdr shdr;
+        if (pread(fd, &shdr, sizeof(shdr), ehdr.e_shoff + i * sizeof(shdr)) != sizeof(shdr))
+            return "";
+        if (shdr.sh_type != SHT_NOTE || shdr.sh_size > 4096)
+            continue;
+        std::vector<uint8_t> notes(shdr.sh_size);
+        if (pread(fd, notes.data(), notes.size(), shdr.sh_offset) != ssize_t(notes.size()))
+            return "";
+        for (size_t at = 0; at + sizeof(Elf32_Nhdr) <= notes.size();)
+        {
+            auto note   = (const Elf32_Nhdr *) &notes[at];
+            size_t name = at + sizeof(Elf32_Nhdr);
+            size_t desc = name + ((note->n_namesz + 3) & ~3u);
+            if (desc + note->n_descsz > notes.size())
+                break;
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && !memcmp(&notes[name], "GNU", 4))
+                return "build-" + Hex(&notes[desc], note->n_descsz);
+            at = desc + ((note->n_descsz + 3) & ~3u);
+        }
+    }
+    return "";
+}
+
+std::string ModuleKey(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return "";
+    std::string key = BuildId(fd);
+    struct stat st;
+    // Valve doesn't always link with build ids
+    if (key.empty() && !fstat(fd, &st))
+        key = "file-" + std::to_string(st.st_size) + "-" + std::to_string(st.st_mtime);
+    close(fd);
+    return key;
+}
+
+static void Load()
+{
+    if (loaded)
+        return;
+    loaded = true;
+    std::ifstream in(CachePath());
+    std::string line;
+    if (!std::getline(in, line) || line != HEADER)
+        return;
+    section_s *current = nullptr;
+    while (std::getline(in, line))
+    {
+        size_t space = line.find(' ');
+        if (space == std::string::npos)
+            continue;
+        if (!line.compare(0, space, "section"))
+        {
+            size_t second = line.find(' ', space + 1);
+            if (second == std::string::npos)
+            {
+                current = nullptr;
+                continue;
+            }
+            current      = &sections[line.substr(space + 1, second - space - 1)];
+            current->key = line.substr(second + 1);
+            current->entries.clear();
+        }
+        else if (current)
+            current->entries[line.substr(space + 1)] = std::strtoul(line.c_str(), nullptr, 16);
+    }
+}
+
+bool Get(const std::string &section, const std::string &key, entries_t &out)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    Load();
+    auto found = sections.find(section);
+    if (key.empty() || found == sections.end() || found->second.key != key)
+        return false;
+    out = found->second.entries;
+    return true;
+}
+
+bool GetAny(const std::string &section, entries_t &out)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    Load();
+    auto found = sections.find(section);
+    if (found == sections.end())
+        return false;
+    out = found->second.entries;
+    return true;
+}
+
+void Put(const std::string &section, const std::string &key, const entries_t &entries)
+{
+    if (key.empty())
+        return;
+    std::lock_guard<std::mutex> guard(lock);
+    Load();
+    auto &stored = sections[section];
+    if (stored.key == key && stored.entries == entries)
+        return;
+    stored.key     = key;
+    stored.entries = entries;
+    dirty          = true;
+}
+
+void Save()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (!dirty)
+        return;
+    // Every bot on the host shares the file, only ever rename complete ones into place
+    std::string path = CachePath();
+    std::string temp = path + "." + std::to_string(getpid());
+    std::ofstream out(temp);
+    out << HEADER << '\n';
+    for (auto &section : sections)
+    {
+        out << "section " << section.first << ' ' << section.second.key << '\n';
+        for (auto &entry : section.second.entries)
+            out << std::hex << entry.second << std::dec << ' ' << entry.first << '\n';
+    }
+    out.close();
+    if (!out || std::rename(temp.c_str(), path.c_str()))
+    {
+        logging::Info("Failed to write %s", path.c_str());
+        std::remove(temp.c_str());
+        return;
+    }
+    dirty = false;
+}
+} // namespace resolve_cache
@@ -2,6 +2,7 @@
 #include "crits.hpp"
 #include "Backtrack.hpp"
 #include "WeaponData.hpp"
+#include "jobs.hpp"
 #include "netadr.h"
 
 std::unordered_map<int, int> command_number_mod{};
@@ -196,43 +197,152 @@ static int damageUntilToCrit(IClientEntity *wep)
     return damage - (cached_damage - round_damage);
 }
 
-// Calculate next tick we can crit at
+// How many command numbers nextCritTick may try per call, the rest of the search continues on the next call
+static settings::Int search_budget{ "crit.search-budget", "256" };
+
+// MD5_PseudoRandom(cmd) & 0x7FFFFFFF for the command numbers coming up, filled on the background pool
+constexpr int SEED_TABLE_SIZE = 8192;
+struct seed_table_s
+{
+    std::mutex lock;
+    // Seeds for [base, end), slot is the command number modulo SEED_TABLE_SIZE
+    int base{ 0 };
+    int end{ 0 };
+    // Bumped whenever the command numbers jump, a fill running from before must not commit
+    unsigned generation{ 0 };
+    bool filling{ false };
+    int seeds[SEED_TABLE_SIZE];
+};
+static seed_table_s seed_table;
+
+static void fillSeedTable()
+{
+    constexpr int CHUNK = 1024;
+    int chunk[CHUNK];
+    while (true)
+    {
+        int from, count;
+        unsigned generation;
+        {
+            std::lock_guard<std::mutex> guard(seed_table.lock);
+            from       = seed_table.end;
+            count      = std::min(CHUNK, seed_table.base + SEED_TABLE_SIZE - seed_table.end);
+            generation = seed_table.generation;
+            if (count <= 0)
+            {
+                seed_table.filling = false;
+                return;
+            }
+        }
+        for (int i = 0; i < count; i++)
+            chunk[i] = MD5_PseudoRandom(from + i) & 0x7FFFFFFF;
+        std::lock_guard<std::mutex> guard(seed_table.lock);
+        if (seed_table.generation != generation || seed_table.end != from)
+            continue;
+        for (int i = 0; i < count; i++)
+            seed_table.seeds[(from + i) & (SEED_TABLE_SIZE - 1)] = chunk[i];
+        seed_table.end = from + count;
+    }
+}
+
+// Drops everything before cmd_number and tops the table up in the background
+static void advanceSeedTable(int cmd_number)
+{
+    std::lock_guard<std::mutex> guard(seed_table.lock);
+    if (cmd_number < seed_table.base || cmd_number > seed_table.end)
+    {
+        seed_table.base = seed_table.end = cmd_number;
+        seed_table.generation++;
+    }
+    else
+        seed_table.base = cmd_number;
+    if (seed_table.filling || seed_table.end - seed_table.base > SEED_TABLE_SIZE / 2)
+        return;
+    seed_table.filling = true;
+    jobs::Background(fillSeedTable);
+}
+
+static int critSeed(int cmd_number)
+{
+    {
+        std::lock_guard<std::mutex> guard(seed_table.lock);
+        if (cmd_number >= seed_table.base && cmd_number < seed_table.end)
+            return seed_table.seeds[cmd_number & (SEED_TABLE_SIZE - 1)];
+    }
+    return MD5_PseudoRandom(cmd_number) & 0x7FFFFFFF;
+}
+
+// First crit in [from, from + count), -1 if there is none
+static int findCrit(IClientEntity *wep, int from, int count)
+{
+    int old_seed = *g_PredictionRandomSeed;
+    // CalcIsAttackCritical changes the weapon state, we still need every try to start from the same one
+    weapon_info info(wep);
+    int found = -1;
+    for (int cmd_number = from; cmd_number < from + count; cmd_number++)
+    {
+        *g_PredictionRandomSeed = critSeed(cmd_number);
+        bool is_crit            = re::C_TFWeaponBase::CalcIsAttackCritical(wep);
+        info.restore_data(wep);
+        if (is_crit)
+        {
+            found = cmd_number;
+            break;
+        }
+    }
+    *g_PredictionRandomSeed = old_seed;
+    return found;
+}
+
+// Where a search too big for one call left off
+struct crit_search_s
+{
+    int weapon{ -1 };
+    int start{ 0 };
+    int next{ 0 };
+    int loops{ 0 };
+};
+static crit_search_s crit_search;
+
+// Calculate next tick we can crit at. Searches over more than crit.search-budget command numbers take multiple calls and return -1 until they are done
 static int nextCritTick(int loops = 4096)
 {
     // Previous crit tick stuff
     static int previous_crit   = -1;
     static int previous_weapon = -1;
 
-    auto wep = RAW_ENT(LOCAL_W);
+    auto wep       = RAW_ENT(LOCAL_W);
+    int cmd_number = current_late_user_cmd->command_number;
 
     // Already have a tick, use it
-    if (previous_weapon == wep->entindex() && previous_crit >= current_late_user_cmd->command_number)
+    if (previous_weapon == wep->entindex() && previous_crit >= cmd_number)
         return previous_crit;
 
-    int old_seed = MD5_PseudoRandom(current_late_user_cmd->command_number) & 0x7FFFFFFF;
-    // Try 4096 times
-    for (int i = 0; i < loops; i++)
+    advanceSeedTable(cmd_number);
+    int budget = std::max(1, *search_budget);
+    int found;
+    if (loops <= budget)
+        found = findCrit(wep, cmd_number, loops);
+    else
     {
-        int cmd_number = current_late_user_cmd->command_number + i;
-        // Set random seed
-        *g_PredictionRandomSeed = MD5_PseudoRandom(cmd_number) & 0x7FFFFFFF;
-        // Save weapon state to not break anything
-        weapon_info info(wep);
-        bool is_crit = re::C_TFWeaponBase::CalcIsAttackCritical(wep);
-        // Restore state
-        info.restore_data(wep);
-        // Is a crit
-        if (is_crit)
-        {
-            *g_PredictionRandomSeed = old_seed;
-            previous_crit           = cmd_number;
-            previous_weapon         = wep->entindex();
-            return cmd_number;
-        }
+        crit_search_s &search = crit_search;
+        if (search.weapon != wep->entindex() || search.loops != loops || cmd_number < search.start || cmd_number >= search.start + loops)
+            search = crit_search_s{ wep->entindex(), cmd_number, cmd_number, loops };
+        // Everything before the current command is useless now
+        search.next = std::max(search.next, cmd_number);
+        int count   = std::min(budget, search.start + loops - search.next);
+        found       = findCrit(wep, search.next, count);
+        search.next += count;
+        // Found one or tried everything, start over next time
+        if (found != -1 || search.next >= search.start + loops)
+            search.weapon = -1;
     }
-    // Reset
-    *g_PredictionRandomSeed = old_seed;
-    return -1;
+    if (found != -1)
+    {
+        previous_crit   = found;
+        previous_weapon = wep->entindex();
+    }
+    return found;
 }
 
 static bool randomCritEnabled()
@@ -912,79 +1022,73 @@ void Draw()
 }
 #endif
 
-// Listener for damage
-class CritEventListener : public IGameEventListener
+// Reset cached Damage, round reset
+static void OnRoundStart(const game_events::event_s &)
 {
-public:
-    void FireGameEvent(KeyValues *event) override
+    crit_damage   = 0;
+    melee_damage  = 0;
+    round_damage  = g_pPlayerResource->GetDamage(g_pLocalPlayer->entity_idx);
+    cached_damage = round_damage - melee_damage;
+}
+
+// Something took damage
+static void OnPlayerHurt(const game_events::event_s &event)
+{
+    const auto &hurt = *event.hurt;
+    int victim       = hurt.victim;
+    int health       = hurt.health;
+    if (!victim)
+        return;
+
+    auto &status          = player_status_list[victim - 1];
+    int health_difference = status.health - health;
+    status.health         = health;
+    status.just_updated   = true;
+
+    // That something was hurt by us
+    if (hurt.attacker == g_pLocalPlayer->entity_idx)
     {
-        // Reset cached Damage, round reset
-        if (!strcmp(event->GetName(), "teamplay_round_start"))
-        {
-            crit_damage   = 0;
-            melee_damage  = 0;
-            round_damage  = g_pPlayerResource->GetDamage(g_pLocalPlayer->entity_idx);
-            cached_damage = round_damage - melee_damage;
-        }
-        // Something took damage
-        else if (!strcmp(event->GetName(), "player_hurt"))
+        // Don't count self damage
+        if (victim != g_pLocalPlayer->entity_idx)
         {
-            int victim = g_IEngine->GetPlayerForUserID(event->GetInt("userid"));
-            int health = event->GetInt("health");
+            // The weapon we damaged with
+            int weaponid   = hurt.weaponid;
+            int weapon_idx = getWeaponByID(LOCAL_E, weaponid);
 
-            auto &status          = player_status_list[victim - 1];
-            int health_difference = status.health - health;
-            status.health         = health;
-            status.just_updated   = true;
-
-            // That something was hurt by us
-            if (g_IEngine->GetPlayerForUserID(event->GetInt("attacker")) == g_pLocalPlayer->entity_idx)
+            bool isMelee = false;
+            if (IDX_GOOD(weapon_idx))
             {
-                // Don't count self damage
-                if (victim != g_pLocalPlayer->entity_idx)
-                {
-                    // The weapon we damaged with
-                    int weaponid   = event->GetInt("weaponid");
-                    int weapon_idx = getWeaponByID(LOCAL_E, weaponid);
-
-                    bool isMelee = false;
-                    if (IDX_GOOD(weapon_idx))
-                    {
-                        int slot = re::C_BaseCombatWeapon::GetSlot(g_IEntityList->GetClientEntity(weapon_idx));
-                        if (slot == 2)
-                            isMelee = true;
-                    }
+                int slot = re::C_BaseCombatWeapon::GetSlot(g_IEntityList->GetClientEntity(weapon_idx));
+                if (slot == 2)
+                    isMelee = true;
+            }
 
-                    // Iterate all the weapons of the local palyer for weaponid
+            // Iterate all the weapons of the local palyer for weaponid
 
-                    // General damage counter
-                    int damage = event->GetInt("damageamount");
-                    if (damage > health_difference && !health)
-                        damage = health_difference;
+            // General damage counter
+            int damage = hurt.damage;
+            if (damage > health_difference && !health)
+                damage = health_difference;
 
-                    // Not a melee weapon
-                    if (!isMelee)
-                    {
-                        // Crit handling
-                        if (CE_BAD(LOCAL_E) || CE_BAD(LOCAL_W) || !re::CTFPlayerShared::IsCritBoosted(re::CTFPlayerShared::GetPlayerShared(RAW_ENT(LOCAL_E))))
-                        {
-                            // Crit damage counter
-                            if (event->GetBool("crit"))
-                                crit_damage += damage;
-                        }
-                    }
-                    else
-                    {
-                        // Melee damage
-                        melee_damage += damage;
-                    }
+            // Not a melee weapon
+            if (!isMelee)
+            {
+                // Crit handling
+                if (CE_BAD(LOCAL_E) || CE_BAD(LOCAL_W) || !re::CTFPlayerShared::IsCritBoosted(re::CTFPlayerShared::GetPlayerShared(RAW_ENT(LOCAL_E))))
+                {
+                    // Crit damage counter
+                    if (hurt.crit)
+                        crit_damage += damage;
                 }
             }
+            else
+            {
+                // Melee damage
+                melee_damage += damage;
+            }
         }
     }
-};
-
-static CritEventListener listener{};
+}
 
 void observedcritchance_nethook(const CRecvProxyData *data, void *pWeapon, void *out)
 {
@@ -1035,6 +1139,7 @@ void LevelShutdown()
     is_out_of_sync  = false;
     crit_cmds.clear();
     current_index = 0;
+    crit_search   = {};
 }
 
 // Prints basically everything you need to know about crits
@@ -1067,17 +1172,15 @@ static CatCommand debug_print_crit_info("debug_print_crit_info", "Print a bunch
 static InitRoutine init([]() {
     EC::Register(EC::CreateMoveLate, CreateMove, "crit_cm");
 #if ENABLE_VISUALS
-    EC::Register(EC::Draw, Draw, "crit_draw");
+    EC::Register(EC::Draw, Draw, "crit_draw", EC::per_tick);
 #endif
     EC::Register(EC::LevelShutdown, LevelShutdown, "crit_lvlshutdown");
-    g_IGameEventManager->AddListener(&listener, false);
+    game_events::Subscribe("teamplay_round_start", OnRoundStart);
+    game_events::Subscribe("player_hurt", OnPlayerHurt);
     HookNetvar({ "DT_TFWeaponBase", "LocalActiveTFWeaponData", "m_flObservedCritChance" }, observed_crit_chance_hook, observedcritchance_nethook);
     EC::Register(
         EC::Shutdown,
-        []() {
-            g_IGameEventManager->RemoveListener(&listener);
-            observed_crit_chance_hook.restore();
-        },
+        []() { observed_crit_chance_hook.restore(); },
         "crit_shutdown");
     // Attached in game, out of sync
     if (g_IEngine->IsInGame())
@@ -0,0 +1,149 @@
+#include "common.hpp"
+#include "dormant.hpp"
+#include "soundcache.hpp"
+#include "navparser.hpp"
+
+namespace dormant
+{
+// How long a fix is worth anything, soundcache keeps sounds for as long
+constexpr float HEARD_MAX_AGE = 10.0f;
+// Not having heard anything since they walked out of sight means they're probably somewhere else by now
+constexpr float SEEN_MAX_AGE = 3.0f;
+// Velocity is only any good for about this long
+constexpr float PREDICT_TIME = 1.0f;
+// Two sounds further apart than this say nothing about velocity
+constexpr float VELOCITY_WINDOW = 2.0f;
+constexpr float MAX_SPEED       = 520.0f;
+
+static estimate_s estimates[PLAYER_ARRAY_SIZE]{};
+
+static void Reset(estimate_s &estimate)
+{
+    unsigned long tick = estimate.tick;
+    estimate           = estimate_s{};
+    estimate.tick      = tick;
+}
+
+static void Fix(estimate_s &estimate, const Vector &origin, const Vector &velocity, float time, bool heard)
+{
+    estimate.anchor      = origin;
+    estimate.velocity    = velocity;
+    estimate.anchor_time = time;
+    estimate.heard       = heard;
+    estimate.area        = nullptr;
+}
+
+// Going along velocity, but not off the nav mesh
+static Vector Predict(estimate_s &estimate, float time)
+{
+    if (estimate.velocity.IsZero() || nav::status != nav::on)
+        return estimate.anchor + estimate.velocity * time;
+    if (!estimate.area)
+        estimate.area = nav::findAreaOn(estimate.anchor);
+    if (!estimate.area)
+        return estimate.anchor;
+    for (float step : { time, time * 0.5f })
+    {
+        Vector predicted = estimate.anchor + estimate.velocity * step;
+        if (nav::findAreaOn(predicted, estimate.area))
+            return predicted;
+    }
+    return estimate.anchor;
+}
+
+static void UpdatePlayer(int idx, float now)
+{
+    estimate_s &estimate = estimates[idx];
+    estimate.tick        = tickcount;
+    CachedEntity *ent    = ENTITY(idx);
+    if (CE_INVALID(ent) || !g_pPlayerResource->isAlive(idx))
+    {
+        Reset(estimate);
+        return;
+    }
+    if (!RAW_ENT(ent)->IsDormant())
+    {
+        Vector velocity;
+        velocity::Get(ent, velocity);
+        Fix(estimate, ent->m_vecOrigin(), velocity, now, false);
+        estimate.source     = LIVE;
+        estimate.origin     = estimate.anchor;
+        estimate.confidence = 1.0f;
+        estimate.age        = 0.0f;
+        return;
+    }
+
+    float sound_age;
+    int64_t stamp;
+    auto sound = soundcache::GetSoundLocation(idx, &sound_age, &stamp);
+    // Only a sound we haven't used yet is a new fix, the two clocks drift too much to compare times
+    bool fixed = false;
+    if (sound && stamp != estimate.sound_stamp)
+    {
+        estimate.sound_stamp = stamp;
+        float time           = now - sound_age;
+        // Sounds from before we last saw them say nothing new
+        if (!estimate.Valid() || time > estimate.anchor_time)
+        {
+            // Two sounds close enough together tell us where they're going
+            float dt = time - estimate.anchor_time;
+            Vector velocity{};
+            if (estimate.Valid() && dt > 0.05f && dt < VELOCITY_WINDOW)
+            {
+                velocity    = (*sound - estimate.anchor) / dt;
+                float speed = velocity.Length();
+                if (speed > MAX_SPEED)
+                    velocity *= MAX_SPEED / speed;
+            }
+            Fix(estimate, *sound, velocity, time, true);
+            fixed = true;
+        }
+    }
+    if (!estimate.Valid() && !fixed)
+        return;
+
+    estimate.age  = now - estimate.anchor_time;
+    float max_age = estimate.heard ? HEARD_MAX_AGE : SEEN_MAX_AGE;
+    if (estimate.age >= max_age)
+    {
+        Reset(estimate);
+        return;
+    }
+    estimate.confidence = 1.0f - estimate.age / max_age;
+    if (estimate.velocity.IsZero())
+    {
+        estimate.source = estimate.heard ? HEARD : PREDICTED;
+        estimate.origin = estimate.anchor;
+        return;
+    }
+    estimate.source = PREDICTED;
+    // Past the prediction window they just stay where it ended
+    if (estimate.age <= PREDICT_TIME + g_GlobalVars->interval_per_tick)
+        estimate.origin = Predict(estimate, std::min(estimate.age, PREDICT_TIME));
+}
+
+void Update()
+{
+    if (CE_BAD(LOCAL_E))
+        return;
+    float now       = g_GlobalVars->realtime;
+    int max_clients = std::min(g_IEngine->GetMaxClients(), MAX_PLAYERS);
+    for (int i = 1; i <= max_clients; i++)
+    {
+        if (i != g_pLocalPlayer->entity_idx)
+            UpdatePlayer(i, now);
+    }
+}
+
+const estimate_s *Get(int idx)
+{
+    if (idx <= 0 || idx >= PLAYER_ARRAY_SIZE)
+        return nullptr;
+    return &estimates[idx];
+}
+
+static InitRoutine init([]() {
+    EC::Register(
+        EC::LevelInit, []() { std::fill(estimates, estimates + PLAYER_ARRAY_SIZE, estimate_s{}); }, "dormant_levelinit");
+});
+} // namespace dormant
@@ -8,8 +8,18 @@
 #include "common.hpp"
 
 #include <time.h>
+#include <bitset>
 #include <settings/Float.hpp>
+#include <settings/Int.hpp>
 #include "soundcache.hpp"
+#include "dormant.hpp"
+#include "navparser.hpp"
+#include "governor.hpp"
+
+namespace entity_cache
+{
+static void SetUserID(int idx, int userid);
+}
 
 bool IsProjectileACrit(CachedEntity *ent)
 {
@@ -18,16 +28,17 @@ bool IsProjectileACrit(CachedEntity *ent)
     return CE_BYTE(ent, netvar.Rocket_bCritical);
 }
 // This method of const'ing the index is weird.
-CachedEntity::CachedEntity() : m_IDX(int(((unsigned) this - (unsigned) &entity_cache::array) / sizeof(CachedEntity))), hitboxes(hitbox_cache::Get(unsigned(m_IDX)))
+CachedEntity::CachedEntity() : m_IDX(int(((unsigned) this - (unsigned) &entity_cache::array) / sizeof(CachedEntity))), hitboxes(hitbox_cache::UncheckedGet(unsigned(m_IDX))), player_info(entity_cache::cold_array[m_IDX].player_info)
 {
 #if PROXY_ENTITY != true
     m_pEntity = nullptr;
 #endif
-    m_fLastUpdate = 0.0f;
 }
 
 void CachedEntity::Reset()
 {
+    raw_entity      = nullptr;
+    raw_entity_tick = 0;
     m_bAnyHitboxVisible = false;
     m_bVisCheckComplete = false;
     m_lLastSeen         = 0;
@@ -36,7 +47,10 @@ void CachedEntity::Reset()
     m_vecAcceleration.Zero();
     m_vecVOrigin.Zero();
     m_vecVelocity.Zero();
-    m_fLastUpdate = 0;
+    velocity_is_valid = false;
+    m_fLastUpdate     = 0;
+    player_info_dirty = true;
+    slot_changed      = true;
 }
 
 CachedEntity::~CachedEntity()
@@ -46,9 +60,16 @@ CachedEntity::~CachedEntity()
 static settings::Float ve_window{ "debug.ve.window", "0" };
 static settings::Boolean ve_smooth{ "debug.ve.smooth", "true" };
 static settings::Int ve_averager_size{ "debug.ve.averaging", "0" };
+static settings::Boolean incremental{ "debug.entitycache.incremental", "true" };
+// Even in incremental mode refetch player_info every so often in case we missed an update
+static settings::Int player_info_refresh{ "debug.entitycache.player-info-refresh", "66" };
 
 void CachedEntity::Update()
 {
+#if CACHE_RAW_ENTITY == true
+    raw_entity      = g_IEntityList->GetClientEntity(m_IDX);
+    raw_entity_tick = tickcount;
+#endif
     auto raw = RAW_ENT(this);
 
     if (!raw)
@@ -61,17 +82,62 @@ void CachedEntity::Update()
     }
 #endif
     bool dormant               = raw->IsDormant();
-    bool dormant_state_changed = dormant != was_dormant();
+    bool dormant_state_changed = dormant != entity_cache::snapshot.dormant[m_IDX];
+
+    // Fill the snapshot before anything below reads through the accessors
+    auto &snapshot                = entity_cache::snapshot;
+    Vector previous_origin        = snapshot.origin[m_IDX];
+    snapshot.tick[m_IDX]          = tickcount;
+    snapshot.class_id[m_IDX]      = ClassIDLive();
+    snapshot.type[m_IDX]          = TypeFromClassID(snapshot.class_id[m_IDX]);
+    snapshot.team[m_IDX]          = NET_INT(raw, netvar.iTeamNum);
+    snapshot.health[m_IDX]        = HealthLive();
+    snapshot.origin[m_IDX]        = raw->GetAbsOrigin();
+    snapshot.alive[m_IDX]         = !NET_BYTE(raw, netvar.iLifeState);
+    snapshot.dormant[m_IDX]       = dormant;
+    snapshot.distance_tick[m_IDX] = 0;
+    // A hash lookup once ItemManager has seen the model
+    snapshot.item_type[m_IDX] = snapshot.type[m_IDX] == ENTITY_GENERIC ? g_ItemManager.GetItemType(this) : ITEM_NONE;
 
     m_lSeenTicks = 0;
     m_lLastSeen  = 0;
 
-    hitboxes.Update();
+    // Dormant entities don't change, and generic entities have nothing worth caching unless they move
+    bool refresh_hitboxes = !*incremental || slot_changed || dormant_state_changed;
+    if (!refresh_hitboxes && !dormant)
+        refresh_hitboxes = snapshot.type[m_IDX] != ENTITY_GENERIC || snapshot.origin[m_IDX] != previous_origin;
+    if (refresh_hitboxes)
+        hitboxes.Update();
 
     m_bVisCheckComplete = false;
 
-    if (m_Type() == EntityType::ENTITY_PLAYER)
-        g_IEngine->GetPlayerInfo(m_IDX, &player_info);
+    if (snapshot.type[m_IDX] == EntityType::ENTITY_PLAYER)
+    {
+        IF_GAME(IsTF())
+        {
+            SnapshotConditions(this);
+            if (m_IDX < PLAYER_ARRAY_SIZE)
+                snapshot.player_class[m_IDX] = NET_INT(raw, netvar.iClass);
+        }
+        bool refresh_info = !*incremental || slot_changed || player_info_dirty;
+        if (!refresh_info && *player_info_refresh > 0)
+            refresh_info = (tickcount + m_IDX) % *player_info_refresh == 0;
+        if (refresh_info)
+        {
+            g_IEngine->GetPlayerInfo(m_IDX, &player_info);
+            player_info_dirty = false;
+            if (m_IDX < PLAYER_ARRAY_SIZE)
+                entity_cache::SetUserID(m_IDX, player_info.userID);
+        }
+    }
+    slot_changed = false;
+}
+
+void CachedEntity::ValidateRawEntity() const
+{
+    IClientEntity *live = g_IEntityList->GetClientEntity(m_IDX);
+    if (live != raw_entity)
+        logging::Info("Stale raw entity for %d: cached %p, live %p (tick %lu, stamped %lu)", m_IDX, (void *) raw_entity, (void *) live, tickcount, raw_entity_tick);
 }
 
 // FIXME maybe disable this by default
@@ -80,7 +146,7 @@ static settings::Boolean fast_vischeck{ "debug.fast-vischeck", "true" };
 bool CachedEntity::IsVisible()
 {
     static constexpr int optimal_hitboxes[] = { hitbox_t::head, hitbox_t::foot_L, hitbox_t::hand_R, hitbox_t::spine_1 };
-    static bool vischeck0, vischeck;
+    static bool vischeck0;
 
     PROF_SECTION(CE_IsVisible);
     if (m_bVisCheckComplete)
@@ -95,43 +161,34 @@ bool CachedEntity::IsVisible()
         return true;
     }
 
-    if (m_Type() == ENTITY_PLAYER && fast_vischeck)
+    trace::Batch batch(this);
+    if (m_Type() == ENTITY_PLAYER && (fast_vischeck || governor::Degraded(governor::FAST_VISCHECK)))
     {
         for (int i = 0; i < 4; i++)
-        {
-            if (hitboxes.VisibilityCheck(optimal_hitboxes[i]))
-            {
-                m_bAnyHitboxVisible = true;
-                m_bVisCheckComplete = true;
-                return true;
-            }
-        }
-        m_bAnyHitboxVisible = false;
-        m_bVisCheckComplete = true;
-        return false;
+            batch.AddHitbox(optimal_hitboxes[i]);
     }
-
-    for (int i = 0; i < hitboxes.m_nNumHitboxes; i++)
+    else
     {
-        vischeck = false;
-        vischeck = hitboxes.VisibilityCheck(i);
-        if (vischeck)
-        {
-            m_bAnyHitboxVisible = true;
-            m_bVisCheckComplete = true;
-            return true;
-        }
+        for (int i = 0; i < hitboxes.GetNumHitboxes(); i++)
+            batch.AddHitbox(i);
     }
-    m_bAnyHitboxVisible = false;
+    m_bAnyHitboxVisible = batch.AnyVisible() != -1;
     m_bVisCheckComplete = true;
-
-    return false;
+    return m_bAnyHitboxVisible;
 }
 
 std::optional<Vector> CachedEntity::m_vecDormantOrigin()
 {
     if (!RAW_ENT(this)->IsDormant())
         return m_vecOrigin();
+    // Players get one estimate per tick, so everything agrees on where they are
+    auto estimate = m_IDX <= MAX_PLAYERS ? dormant::Get(m_IDX) : nullptr;
+    if (estimate && estimate->tick == tickcount)
+    {
+        if (estimate->Valid())
+            return estimate->origin;
+        return std::nullopt;
+    }
     auto vec = soundcache::GetSoundLocation(this->m_IDX);
     if (vec)
         return *vec;
@@ -141,21 +198,281 @@ std::optional<Vector> CachedEntity::m_vecDormantOrigin()
 namespace entity_cache
 {
 
+// Declared before the entity array, CachedEntity's constructor binds references into it
+cold_data_s cold_array[MAX_ENTITIES]{};
 CachedEntity array[MAX_ENTITIES]{};
+snapshot_s snapshot{};
+
+std::vector<CachedEntity *> valid_by_type[ENTITY_TYPE_COUNT];
+std::vector<CachedEntity *> valid_by_team[ENTITY_TYPE_COUNT][TEAM_COUNT];
+std::vector<pickup_s> pickups_by_type[ITEM_COUNT];
+bool mvm = false;
+std::vector<CachedEntity *> mvm_busters;
+static std::bitset<MAX_ENTITIES> buster_set;
+std::vector<building_s> building_list;
+std::vector<const building_s *> own_buildings;
+// Indices object_destroyed named, they stay out of the registry until their entity is gone.
+// The engine waits a while before it hands out a freed index again
+static std::bitset<MAX_ENTITIES> destroyed_buildings;
+
+// Pickups barely ever move, so their nav area only gets looked up again when they do or the nav mesh changes
+struct pickup_area_s
+{
+    CNavArea *area;
+    Vector origin;
+    const CNavFile *navfile;
+};
+static pickup_area_s pickup_areas[MAX_ENTITIES]{};
+// tickcount of the previous Update(), used to detect slots that just got filled
+static unsigned long last_update_tick = 0;
+
+static void ClearLists()
+{
+    for (int type = 0; type < ENTITY_TYPE_COUNT; type++)
+    {
+        valid_by_type[type].clear();
+        for (auto &list : valid_by_team[type])
+            list.clear();
+    }
+    for (auto &list : pickups_by_type)
+        list.clear();
+    building_list.clear();
+    own_buildings.clear();
+    mvm_busters.clear();
+    buster_set.reset();
+}
+
+static pickup_s MakePickup(CachedEntity *ent)
+{
+    auto &cached  = pickup_areas[ent->m_IDX];
+    Vector origin = snapshot.origin[ent->m_IDX];
+    if (!cached.area || cached.origin != origin || cached.navfile != nav::navfile.get())
+    {
+        cached.area    = nav::findArea(origin, cached.navfile == nav::navfile.get() ? cached.area : nullptr);
+        cached.origin  = origin;
+        cached.navfile = nav::navfile.get();
+    }
+    bool hidden = NET_INT(RAW_ENT(ent), netvar.m_fEffects) & EF_NODRAW;
+    return pickup_s{ ent, origin, !hidden, cached.area };
+}
+
+static void AddPickup(CachedEntity *ent, k_EItemType type)
+{
+    pickups_by_type[type].push_back(MakePickup(ent));
+}
+
+// Busters aren't their own type, everything here is from the snapshot
+static void AddMvM(CachedEntity *ent)
+{
+    int idx = ent->m_IDX;
+    if (snapshot.type[idx] != ENTITY_PLAYER || snapshot.team[idx] != TEAM_BLU)
+        return;
+    if (snapshot.player_class[idx] == tf_demoman && g_pPlayerResource->GetMaxHealth(ent) == 2500)
+    {
+        mvm_busters.push_back(ent);
+        buster_set.set(idx);
+    }
+}
+
+bool IsBuster(int idx)
+{
+    return idx >= 0 && idx < MAX_ENTITIES && buster_set.test(idx);
+}
+
+static void IndexOwnBuildings(int local)
+{
+    own_buildings.clear();
+    for (auto &building : building_list)
+        if (building.owner == local && local > 0)
+            own_buildings.push_back(&building);
+}
+
+static void UpdateBuildings()
+{
+    int local = g_IEngine->GetLocalPlayer();
+    std::bitset<MAX_ENTITIES> still_destroyed;
+    for (auto ent : valid_by_type[ENTITY_BUILDING])
+    {
+        int idx = ent->m_IDX;
+        if (destroyed_buildings.test(idx))
+        {
+            still_destroyed.set(idx);
+            continue;
+        }
+        building_s building;
+        int classid = snapshot.class_id[idx];
+        if (classid == CL_CLASS(CObjectSentrygun))
+            building.kind = BUILDING_SENTRY;
+        else if (classid == CL_CLASS(CObjectDispenser))
+            building.kind = BUILDING_DISPENSER;
+        else if (classid == CL_CLASS(CObjectTeleporter))
+            building.kind = NET_INT(RAW_ENT(ent), netvar.m_iObjectMode) ? BUILDING_TELE_EXIT : BUILDING_TELE_ENTRANCE;
+        else
+            continue;
+        IClientEntity *raw  = RAW_ENT(ent);
+        building.ent        = ent;
+        building.owner      = HandleToIDX(NET_INT(raw, netvar.m_hBuilder));
+        building.team       = snapshot.team[idx];
+        building.level      = NET_INT(raw, netvar.iUpgradeLevel);
+        building.mini       = NET_BYTE(raw, netvar.m_bMiniBuilding);
+        building.building   = NET_BYTE(raw, netvar.m_bBuilding);
+        building.placing    = NET_BYTE(raw, netvar.m_bPlacing);
+        building.sapped     = NET_BYTE(raw, netvar.m_bHasSapper);
+        building.dormant    = snapshot.dormant[idx];
+        building.health     = NET_INT(raw, netvar.iBuildingHealth);
+        building.max_health = NET_INT(raw, netvar.iBuildingMaxHealth);
+        building.origin     = snapshot.origin[idx];
+        building_list.push_back(building);
+    }
+    destroyed_buildings = still_destroyed;
+    IndexOwnBuildings(local);
+}
+
+static void OnObjectDestroyed(const game_events::event_s &event)
+{
+    int idx = event.raw->GetInt("index");
+    if (idx <= 0 || idx >= MAX_ENTITIES)
+        return;
+    destroyed_buildings.set(idx);
+    // Gone for the rest of this tick too
+    auto removed = std::find_if(building_list.begin(), building_list.end(), [idx](const building_s &building) { return building.ent->m_IDX == idx; });
+    if (removed == building_list.end())
+        return;
+    building_list.erase(removed);
+    IndexOwnBuildings(g_IEngine->GetLocalPlayer());
+}
 
 void Update()
 {
+    hitbox_cache::Update();
     max = g_IEntityList->GetHighestEntityIndex();
     if (max >= MAX_ENTITIES)
         max = MAX_ENTITIES - 1;
+    ClearLists();
     for (int i = 0; i <= max; i++)
     {
+        if (!last_update_tick || snapshot.tick[i] != last_update_tick)
+            array[i].slot_changed = true;
         array[i].Update();
+        // Only entities that got a snapshot this tick are valid
+        if (snapshot.tick[i] != tickcount)
+            continue;
+        EntityType type = snapshot.type[i];
+        int team        = snapshot.team[i];
+        valid_by_type[type].push_back(&array[i]);
+        if (team >= 0 && team < TEAM_COUNT)
+            valid_by_team[type][team].push_back(&array[i]);
+        k_EItemType item = snapshot.item_type[i];
+        if (item != ITEM_NONE && item < ITEM_COUNT && !snapshot.dormant[i])
+            AddPickup(&array[i], item);
+        if (mvm)
+            AddMvM(&array[i]);
     }
+    UpdateBuildings();
+    last_update_tick = tickcount;
+}
+
+struct identity_s
+{
+    int userid;
+    // Entry of entry_steamid as of playerlist::generation entry_generation
+    playerlist::userdata *entry;
+    unsigned entry_steamid;
+    unsigned entry_generation;
+};
+static identity_s identities[PLAYER_ARRAY_SIZE]{};
+// Userids are 16 bit on the wire, the identity confirms the slot still belongs to that userid
+static uint8_t index_by_userid[1 << 16]{};
+
+static void SetUserID(int idx, int userid)
+{
+    auto &identity = identities[idx];
+    if (identity.userid == userid)
+        return;
+    if (index_by_userid[identity.userid & 0xFFFF] == idx)
+        index_by_userid[identity.userid & 0xFFFF] = 0;
+    identity.userid = userid;
+    if (userid > 0)
+        index_by_userid[userid & 0xFFFF] = idx;
 }
 
+int IndexForUserID(int userid)
+{
+    if (userid <= 0)
+        return 0;
+    int idx = index_by_userid[userid & 0xFFFF];
+    if (idx && identities[idx].userid == userid)
+        return idx;
+    // Not seen yet, players that were already there when we got injected have no info until their next update
+    idx = g_IEngine->GetPlayerForUserID(userid);
+    if (idx <= 0 || idx >= PLAYER_ARRAY_SIZE)
+        return 0;
+    array[idx].player_info_dirty = true;
+    return idx;
+}
+
+unsigned SteamID(int idx)
+{
+    if (idx <= 0 || idx >= PLAYER_ARRAY_SIZE)
+        return 0;
+    return cold_array[idx].player_info.friendsID;
+}
+
+playerlist::userdata &PlayerlistEntry(int idx)
+{
+    unsigned steamid = SteamID(idx);
+    if (!steamid)
+        return playerlist::AccessData(0U);
+    auto &identity = identities[idx];
+    if (!identity.entry || identity.entry_steamid != steamid || identity.entry_generation != playerlist::generation)
+    {
+        identity.entry            = &playerlist::AccessData(steamid);
+        identity.entry_steamid    = steamid;
+        identity.entry_generation = playerlist::generation;
+    }
+    return *identity.entry;
+}
+
+static void OnPlayerConnect(const game_events::event_s &event)
+{
+    // The engine doesn't know the userid yet, but the event has the slot
+    int idx = event.raw->GetInt("index") + 1;
+    if (idx <= 0 || idx >= PLAYER_ARRAY_SIZE)
+        return;
+    SetUserID(idx, event.userid);
+    array[idx].player_info_dirty = true;
+}
+
+static void OnPlayerDisconnect(const game_events::event_s &event)
+{
+    if (!event.player)
+        return;
+    SetUserID(event.player, 0);
+    array[event.player].player_info_dirty = true;
+}
+
+static void OnPlayerInfoChanged(const game_events::event_s &event)
+{
+    if (event.player)
+        array[event.player].player_info_dirty = true;
+}
+
+static InitRoutine init([]() {
+    game_events::Subscribe("player_changename", OnPlayerInfoChanged);
+    game_events::Subscribe("player_connect_client", OnPlayerConnect);
+    game_events::Subscribe("player_disconnect", OnPlayerDisconnect);
+    game_events::Subscribe("object_destroyed", OnObjectDestroyed);
+    EC::Register(
+        EC::LevelInit, []() { mvm = GetLevelName().rfind("mvm_", 0) == 0; }, "entity_cache_mvm");
+});
+
 void Invalidate()
 {
+    memset(snapshot.tick, 0, sizeof(snapshot.tick));
+    ClearLists();
+    destroyed_buildings.reset();
+    // The nav mesh of the next level may well end up at the same address
+    memset(pickup_areas, 0, sizeof(pickup_areas));
     for (auto &ent : array)
     {
         // pMuch useless line!
@@ -166,6 +483,7 @@ void Invalidate()
 
 void Shutdown()
 {
+    ClearLists();
     for (auto &ent : array)
     {
         ent.Reset();
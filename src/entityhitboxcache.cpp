@@ -8,11 +8,14 @@
 #include <settings/Int.hpp>
 #include "common.hpp"
 #include "MiscTemporary.hpp"
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 
 namespace hitbox_cache
 {
 
-EntityHitboxCache::EntityHitboxCache() : parent_ref(&entity_cache::Get(((unsigned) this - (unsigned) &hitbox_cache::array) / sizeof(EntityHitboxCache)))
+EntityHitboxCache::EntityHitboxCache() : parent_ref(&entity_cache::UncheckedGet(((unsigned) this - (unsigned) &hitbox_cache::array) / sizeof(EntityHitboxCache)))
 {
     Reset();
 }
@@ -103,8 +106,7 @@ bool EntityHitboxCache::VisibilityCheck(int id)
 
 static settings::Int setupbones_time{ "source.setupbones-time", "2" };
 static settings::Boolean bonecache_enabled{ "source.use-bone-cache", "false" };
-
-static std::mutex setupbones_mutex;
+static settings::Boolean batch_setupbones{ "source.batch-setupbones", "true" };
 
 matrix3x4_t *EntityHitboxCache::GetBones(int numbones)
 {
@@ -125,57 +127,86 @@ matrix3x4_t *EntityHitboxCache::GetBones(int numbones)
         if (CE_GOOD(parent_ref))
             bones_setup_time = CE_FLOAT(parent_ref, netvar.m_flSimulationTime);
     }
-    if (!bones_setup)
+    // Arena memory is only ours for the tick it was handed out in
+    if (bones_setup && bones_generation != bone_arena.generation)
+        bones_setup = false;
+    // Outside of CreateMove nothing gets set up, so the game's own cache stays untouched there too
+    if (!bones_setup && g_Settings.is_create_move)
     {
         // Reset game cache
         if (!bonecache_enabled && CE_GOOD(parent_ref))
             re::C_BaseAnimating::InvalidateBoneCache(RAW_ENT(parent_ref));
 
-        // If numbones is not set, get it from some terrible and unnamed variable
+        // If numbones is not set, get it from the last SetupBones
         if (numbones == -1)
         {
             if (parent_ref->m_Type() == ENTITY_PLAYER)
-                numbones = CE_INT(parent_ref, 0x844);
+                numbones = CE_INT(parent_ref, netvar.m_nCachedBones);
             else
                 numbones = MAXSTUDIOBONES;
         }
+        if (numbones > MAXSTUDIOBONES)
+            numbones = MAXSTUDIOBONES;
 
-        if (bones.size() < (size_t) numbones)
-            bones.resize(numbones);
-        if (g_Settings.is_create_move)
+        // Failed setups retry into the same slot instead of taking a new one
+        if (!bone_data || bones_generation != bone_arena.generation)
         {
+            bone_data = bone_arena.Allocate();
+            if (!bone_data)
+            {
+                if (bones.size() < (size_t) BoneArena::BONES_PER_ENTITY)
+                    bones.resize(BoneArena::BONES_PER_ENTITY);
+                bone_data = bones.data();
+            }
+            bones_generation = bone_arena.generation;
+        }
 #if !ENABLE_TEXTMODE
-            if (!*bonecache_enabled || parent_ref->m_Type() != ENTITY_PLAYER || IsPlayerInvisible(parent_ref))
+        if (!*bonecache_enabled || parent_ref->m_Type() != ENTITY_PLAYER || IsPlayerInvisible(parent_ref))
+        {
+            PROF_SECTION(bone_setup);
+            bones_setup = RAW_ENT(parent_ref)->SetupBones(bone_data, numbones, 0x7FF00, bones_setup_time);
+        }
+        else
+        {
+            PROF_SECTION(bone_cache);
+            auto to_copy = CE_VAR(parent_ref, 0x838, matrix3x4_t *);
+            if (to_copy)
             {
-                PROF_SECTION(bone_setup);
-                bones_setup = RAW_ENT(parent_ref)->SetupBones(bones.data(), numbones, 0x7FF00, bones_setup_time);
+                // This is catastrophically bad, don't do this. Someone needs to fix this.
+                memcpy(bone_data, to_copy, sizeof(matrix3x4_t) * numbones);
+                bones_setup = true;
             }
             else
             {
-                PROF_SECTION(bone_cache);
-                auto to_copy = CE_VAR(parent_ref, 0x838, matrix3x4_t *);
-                if (to_copy)
-                {
-                    // This is catastrophically bad, don't do this. Someone needs to fix this.
-                    memcpy(bones.data(), to_copy, sizeof(matrix3x4_t) * numbones);
-                    bones_setup = true;
-                }
-                else
-                {
-                    PROF_SECTION(bone_setup);
-                    bones_setup = RAW_ENT(parent_ref)->SetupBones(bones.data(), numbones, 0x7FF00, bones_setup_time);
-                }
+                PROF_SECTION(bone_setup);
+                bones_setup = RAW_ENT(parent_ref)->SetupBones(bone_data, numbones, 0x7FF00, bones_setup_time);
             }
+        }
 #else
-            // Textmode bots miss/shoot at nothing when the tf2 bonecache is used
-            PROF_SECTION(bone_setup);
-            bones_setup = RAW_ENT(parent_ref)->SetupBones(bones.data(), numbones, 0x7FF00, bones_setup_time);
+        // Textmode bots miss/shoot at nothing when the tf2 bonecache is used
+        PROF_SECTION(bone_setup);
+        bones_setup = RAW_ENT(parent_ref)->SetupBones(bone_data, numbones, 0x7FF00, bones_setup_time);
 #endif
-        }
+        prepared_generation = bones_setup ? bones_generation : 0;
     }
+    if (bone_data && (bone_data == bones.data() || bone_arena.IsValid(bones_generation)))
+        return bone_data;
+    // Nothing usable (e.g. first request happened outside of CreateMove), hand out zeroed storage so callers can still index it
+    if (bones.size() < (size_t) BoneArena::BONES_PER_ENTITY)
+        bones.resize(BoneArena::BONES_PER_ENTITY);
     return bones.data();
 }
 
+const matrix3x4_t *EntityHitboxCache::PreparedBones() const
+{
+    if (!bone_data || !prepared_generation || prepared_generation != bones_generation)
+        return nullptr;
+    // The fallback storage only gets written by the next setup, which either succeeds or clears prepared_generation
+    if (bone_data != bones.data() && !bone_arena.IsValid(prepared_generation))
+        return nullptr;
+    return bone_data;
+}
+
 void EntityHitboxCache::Reset()
 {
     memset(m_VisCheck, 0, sizeof(bool) * CACHE_MAX_HITBOXES);
@@ -185,19 +216,22 @@ void EntityHitboxCache::Reset()
     m_CacheInternal.shrink_to_fit();
     bones.clear();
     bones.shrink_to_fit();
-    m_nNumHitboxes = 0;
-    m_bInit        = false;
-    m_bModelSet    = false;
-    m_bSuccess     = false;
-    m_pLastModel   = nullptr;
-    bones_setup    = false;
+    m_nNumHitboxes      = 0;
+    m_bInit             = false;
+    m_bModelSet         = false;
+    m_bSuccess          = false;
+    m_pLastModel        = nullptr;
+    last_visible_hitbox = -1;
+    bone_data           = nullptr;
+    bones_generation    = 0;
+    prepared_generation = 0;
+    bones_setup         = false;
 }
 
 CachedHitbox *EntityHitboxCache::GetHitbox(int id)
 {
     if (m_CacheValidationFlags[id])
         return &m_CacheInternal[id];
-    mstudiobbox_t *box;
 
     if (!m_bInit)
         Init();
@@ -218,23 +252,106 @@ CachedHitbox *EntityHitboxCache::GetHitbox(int id)
         return nullptr;
     if (m_nNumHitboxes > m_CacheInternal.size())
         m_CacheInternal.resize(m_nNumHitboxes);
-    box = set->pHitbox(id);
-    if (!box)
-        return nullptr;
-    if (box->bone < 0 || box->bone >= MAXSTUDIOBONES)
+    // Most callers want more than one hitbox, so do all of them at once
+    TransformHitboxes(GetBones(shdr->numbones), set, m_nNumHitboxes, m_CacheInternal.data());
+    for (int i = 0; i < m_nNumHitboxes; i++)
+        m_CacheValidationFlags[i] = m_CacheInternal[i].bbox != nullptr;
+    if (!m_CacheValidationFlags[id])
         return nullptr;
-    VectorTransform(box->bbmin, GetBones(shdr->numbones)[box->bone], m_CacheInternal[id].min);
-    VectorTransform(box->bbmax, GetBones(shdr->numbones)[box->bone], m_CacheInternal[id].max);
-    m_CacheInternal[id].bbox   = box;
-    m_CacheInternal[id].center = (m_CacheInternal[id].min + m_CacheInternal[id].max) / 2;
-    m_CacheValidationFlags[id] = true;
     return &m_CacheInternal[id];
 }
 
+void TransformHitboxes(const matrix3x4_t *bones, mstudiohitboxset_t *set, int count, CachedHitbox *out)
+{
+    for (int i = 0; i < count; i++)
+    {
+        mstudiobbox_t *box = set->pHitbox(i);
+        out[i].bbox        = nullptr;
+        if (!box || box->bone < 0 || box->bone >= MAXSTUDIOBONES)
+            continue;
+        const matrix3x4_t &bone = bones[box->bone];
+#if defined(__SSE__)
+        // Columns of the bone matrix, so a transform is just 3 multiply-adds on top of the translation.
+        // Summed in VectorTransform's order, but this is 32 bit float math and the scalar path may run on x87 or
+        // contract into fma, so results can differ from it in the last bits. Nothing here needs them exact
+        __m128 c0 = _mm_loadu_ps(bone[0]);
+        __m128 c1 = _mm_loadu_ps(bone[1]);
+        __m128 c2 = _mm_loadu_ps(bone[2]);
+        __m128 c3 = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        __m128 min = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(box->bbmin.x)), _mm_mul_ps(c1, _mm_set1_ps(box->bbmin.y))), _mm_mul_ps(c2, _mm_set1_ps(box->bbmin.z))), c3);
+        __m128 max = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(box->bbmax.x)), _mm_mul_ps(c1, _mm_set1_ps(box->bbmax.y))), _mm_mul_ps(c2, _mm_set1_ps(box->bbmax.z))), c3);
+        __m128 center = _mm_mul_ps(_mm_add_ps(min, max), _mm_set1_ps(0.5f));
+
+        alignas(16) float result[3][4];
+        _mm_store_ps(result[0], min);
+        _mm_store_ps(result[1], max);
+        _mm_store_ps(result[2], center);
+        out[i].min    = Vector(result[0][0], result[0][1], result[0][2]);
+        out[i].max    = Vector(result[1][0], result[1][1], result[1][2]);
+        out[i].center = Vector(result[2][0], result[2][1], result[2][2]);
+#else
+        VectorTransform(box->bbmin, bone, out[i].min);
+        VectorTransform(box->bbmax, bone, out[i].max);
+        out[i].center = (out[i].min + out[i].max) / 2;
+#endif
+        out[i].bbox = box;
+    }
+}
+
+matrix3x4_t *BoneArena::Allocate()
+{
+    if (used >= MAX_ALLOCATIONS)
+        return nullptr;
+    auto &buffer = storage[generation & 1];
+    if (!buffer)
+        buffer = std::make_unique<matrix3x4_t[]>(MAX_ALLOCATIONS * BONES_PER_ENTITY);
+    return &buffer[BONES_PER_ENTITY * used++];
+}
+
+void BoneArena::Reset()
+{
+    generation++;
+    used = 0;
+}
+
+BoneArena bone_arena{};
+
 EntityHitboxCache array[MAX_ENTITIES]{};
 
 void Update()
 {
+    bone_arena.Reset();
+}
+
+#if ENABLE_TEXTMODE
+extern settings::Boolean textmode_minimal_cpu;
+#endif
+
+void PrepareBones()
+{
+    if (!*batch_setupbones || !g_Settings.is_create_move)
+        return;
+#if ENABLE_TEXTMODE
+    // Nothing draws hitboxes here, whatever aims still sets up the bones it needs through GetBones
+    if (*textmode_minimal_cpu)
+        return;
+#endif
+    // SetupBones touches the model cache and animation state, so this has to stay on the game thread.
+    // Doing it in one pass still keeps the cost in one place instead of spread over whatever asks first.
+    for (auto ent : entity_cache::players())
+    {
+        if (ent->m_IDX == g_pLocalPlayer->entity_idx || !ent->m_bAlivePlayer())
+            continue;
+        auto model = (const model_t *) RAW_ENT(ent)->GetModel();
+        if (!model)
+            continue;
+        auto shdr = g_IModelInfo->GetStudiomodel(model);
+        if (!shdr)
+            continue;
+        ent->hitboxes.GetBones(shdr->numbones);
+    }
 }
 
 void Invalidate()
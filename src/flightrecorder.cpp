@@ -0,0 +1,145 @@
+#include "common.hpp"
+#include "flightrecorder.hpp"
+#include "navparser.hpp"
+#include "hacks/NavBot.hpp"
+#include "governor.hpp"
+#include <fcntl.h>
+#include <pwd.h>
+#include <unistd.h>
+#include <array>
+
+namespace flight_recorder
+{
+static settings::Boolean enable{ "debug.flight-recorder.enable", "true" };
+// Dump when a tick takes longer than this, 0 to only dump on crashes
+static settings::Int spike_ms{ "debug.flight-recorder.spike-ms", "100" };
+
+static record_s ring[RECORDS]{};
+// Only the game thread writes, relaxed is enough for a signal handler on the same thread
+static std::atomic<uint64_t> written{ 0 };
+
+static uint64_t tick_start    = 0;
+static uint32_t tick_rays     = 0;
+static uint64_t last_solves   = 0;
+static uint64_t last_solve_ns = 0;
+static uint64_t last_repaths  = 0;
+static Timer spike_timer{};
+
+// Built before anything can crash, the signal handler can't format strings
+static char fatal_path[128];
+static char spike_path[128];
+
+static int64_t Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Only open, write and close, so the signal handler can use it
+static bool Write(const char *path, const record_s *records, uint64_t count, dump_reason reason)
+{
+    header_s header{ MAGIC, VERSION, sizeof(record_s), RECORDS, count, int32_t(getpid()), reason };
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    bool success = write(fd, &header, sizeof(header)) == ssize_t(sizeof(header)) && write(fd, records, sizeof(ring)) == ssize_t(sizeof(ring));
+    close(fd);
+    return success;
+}
+
+void DumpFatal()
+{
+    if (fatal_path[0])
+        Write(fatal_path, ring, written.load(std::memory_order_relaxed), REASON_SIGNAL);
+}
+
+// Copies the ring, the write itself happens on the job pool
+static void Dump(const char *path, dump_reason reason)
+{
+    auto copy = std::make_shared<std::array<record_s, RECORDS>>();
+    memcpy(copy->data(), ring, sizeof(ring));
+    std::string target = path;
+    uint64_t count     = written.load(std::memory_order_relaxed);
+    jobs::Background([copy, target, count, reason]() {
+        bool success = Write(target.c_str(), copy->data(), count, reason);
+        jobs::Defer([target, success]() { logging::Info("Flight recorder: %s %s", success ? "dumped to" : "couldn't write", target.c_str()); });
+    });
+}
+
+static void TickStart()
+{
+    tick_start = profiler::Now();
+}
+
+static void TickEnd()
+{
+    // CreateMove bailed out before the normal events this tick
+    if (!tick_start)
+        return;
+    uint64_t ns = uint64_t((profiler::Now() - tick_start) * profiler::NsPerTick());
+    tick_start  = 0;
+
+    uint64_t index    = written.load(std::memory_order_relaxed);
+    record_s &record  = ring[index & (RECORDS - 1)];
+    uint32_t rays     = trace::rays.load(std::memory_order_relaxed);
+    uint64_t solves   = nav::stats.solves.load(std::memory_order_relaxed);
+    uint64_t solve_ns = nav::stats.solve_ns.load(std::memory_order_relaxed);
+    uint64_t repaths  = nav::stats.repaths.load(std::memory_order_relaxed);
+    // Half written records are told apart by a stale index
+    record.index         = ~0ull;
+    record.time_ns       = Now();
+    record.tickcount     = uint32_t(tickcount);
+    record.tick_us       = uint32_t(ns / 1000);
+    record.entities      = uint16_t(std::max(entity_cache::max, 0));
+    record.players       = uint16_t(entity_cache::players().size());
+    record.projectiles   = uint16_t(entity_cache::projectiles().size());
+    record.buildings     = uint16_t(entity_cache::buildings().size());
+    record.traces        = rays - tick_rays;
+    record.path_solves   = uint16_t(solves - last_solves);
+    record.repaths       = uint16_t(repaths - last_repaths);
+    record.path_solve_us = uint32_t((solve_ns - last_solve_ns) / 1000);
+    record.nav_task      = uint8_t(hacks::tf2::NavBot::task::current_task.id);
+    record.nav_priority  = nav::curr_priority;
+    record.quality_level = governor::Level();
+
+    EC::callback_time slowest[CALLBACKS];
+    size_t found = EC::SlowestLastRun(EC::CreateMove, slowest, CALLBACKS);
+    for (size_t i = 0; i < size_t(CALLBACKS); i++)
+    {
+        auto &callback = record.callbacks[i];
+        if (i < found)
+        {
+            strncpy(callback.name, slowest[i].name, CALLBACK_NAME);
+            callback.us = slowest[i].us;
+        }
+        else
+        {
+            callback.name[0] = '\0';
+            callback.us      = 0;
+        }
+    }
+    record.index = index;
+    written.store(index + 1, std::memory_order_relaxed);
+
+    tick_rays     = rays;
+    last_solves   = solves;
+    last_solve_ns = solve_ns;
+    last_repaths  = repaths;
+
+    if (*spike_ms > 0 && ns > uint64_t(*spike_ms) * 1000000 && spike_timer.test_and_set(30000))
+        Dump(spike_path, REASON_SPIKE);
+}
+
+static CatCommand dump("flight_recorder_dump", "Write the last ticks to /tmp", []() { Dump(spike_path, REASON_COMMAND); });
+
+static InitRoutine init([]() {
+    passwd *pwd      = getpwuid(getuid());
+    const char *user = pwd ? pwd->pw_name : "unknown";
+    // Next to the segfault log
+    snprintf(fatal_path, sizeof(fatal_path), "/tmp/cathook-%s-%d-flight.bin", user, getpid());
+    snprintf(spike_path, sizeof(spike_path), "/tmp/cathook-%s-%d-flight-spike.bin", user, getpid());
+    EC::Register(EC::CreateMoveEarly, TickStart, "flight_recorder_tick_start", enable, EC::very_early);
+    EC::Register(EC::CreateMove, TickEnd, "flight_recorder_tick_end", enable, EC::very_late);
+});
+} // namespace flight_recorder
@@ -0,0 +1,129 @@
+#include "common.hpp"
+#include "gameevents.hpp"
+#include <deque>
+
+namespace game_events
+{
+struct registry_s
+{
+    std::vector<std::string> names;
+    std::unordered_map<std::string, event_id> ids;
+    // Deques so callbacks can subscribe without moving the one that is running
+    std::deque<std::deque<callback_t>> subscribers;
+    // Event names point into the event manager's descriptors, which live as long as the game does
+    std::unordered_map<const char *, event_id> by_pointer;
+
+    registry_s()
+    {
+        // Same order as the enum
+        for (const char *name : { "player_death", "player_hurt" })
+            Add(name);
+    }
+
+    event_id Add(const std::string &name)
+    {
+        auto found = ids.find(name);
+        if (found != ids.end())
+            return found->second;
+        event_id id = names.size();
+        names.push_back(name);
+        subscribers.emplace_back();
+        ids.emplace(name, id);
+        return id;
+    }
+};
+
+static registry_s &Registry()
+{
+    static registry_s object{};
+    return object;
+}
+
+event_id Intern(const char *name)
+{
+    return Registry().Add(name);
+}
+
+const char *Name(event_id id)
+{
+    auto &names = Registry().names;
+    return id < names.size() ? names[id].c_str() : "";
+}
+
+static int PlayerFor(int userid)
+{
+    return entity_cache::IndexForUserID(userid);
+}
+
+class RouterListener : public IGameEventListener2
+{
+    void FireGameEvent(IGameEvent *event) override
+    {
+        auto &registry   = Registry();
+        const char *name = event->GetName();
+        auto found       = registry.by_pointer.find(name);
+        if (found == registry.by_pointer.end())
+            found = registry.by_pointer.emplace(name, registry.Add(name)).first;
+        event_id id       = found->second;
+        auto &subscribers = registry.subscribers[id];
+        if (subscribers.empty())
+            return;
+
+        event_s decoded{};
+        decoded.id     = id;
+        decoded.raw    = event;
+        decoded.userid = event->GetInt("userid", -1);
+        decoded.player = decoded.userid == -1 ? 0 : PlayerFor(decoded.userid);
+
+        player_death_s death;
+        player_hurt_s hurt;
+        if (id == player_death)
+        {
+            death.victim_userid   = decoded.userid;
+            death.attacker_userid = event->GetInt("attacker");
+            death.assister_userid = event->GetInt("assister", -1);
+            death.victim          = decoded.player;
+            death.attacker        = PlayerFor(death.attacker_userid);
+            death.assister        = death.assister_userid == -1 ? 0 : PlayerFor(death.assister_userid);
+            death.weaponid        = event->GetInt("weaponid");
+            death.customkill      = event->GetInt("customkill");
+            death.damagebits      = event->GetInt("damagebits");
+            death.death_flags     = event->GetInt("death_flags");
+            decoded.death         = &death;
+        }
+        else if (id == player_hurt)
+        {
+            hurt.victim_userid   = decoded.userid;
+            hurt.attacker_userid = event->GetInt("attacker");
+            hurt.victim          = decoded.player;
+            hurt.attacker        = PlayerFor(hurt.attacker_userid);
+            hurt.health          = event->GetInt("health");
+            hurt.damage          = event->GetInt("damageamount");
+            hurt.weaponid        = event->GetInt("weaponid");
+            hurt.custom          = event->GetInt("custom");
+            hurt.crit            = event->GetBool("crit");
+            hurt.minicrit        = event->GetBool("minicrit");
+            decoded.hurt         = &hurt;
+        }
+        for (size_t i = 0; i < subscribers.size(); i++)
+            subscribers[i](decoded);
+    }
+};
+
+static RouterListener listener{};
+
+event_id Subscribe(const char *name, callback_t callback)
+{
+    auto &registry = Registry();
+    event_id id    = registry.Add(name);
+    if (registry.subscribers[id].empty())
+        g_IEventManager2->AddListener(&listener, name, false);
+    registry.subscribers[id].push_back(std::move(callback));
+    return id;
+}
+
+static InitRoutine init([]() {
+    EC::Register(
+        EC::Shutdown, []() { g_IEventManager2->RemoveListener(&listener); }, "shutdown_game_events");
+});
+} // namespace game_events
@@ -0,0 +1,108 @@
+#include "common.hpp"
+#include "governor.hpp"
+
+namespace governor
+{
+static settings::Boolean enable{ "governor.enable", "false" };
+static settings::Int budget{ "governor.budget-us", "10000" };
+// Steps back up once whole windows stay below this share of the budget
+static settings::Int recover_percent{ "governor.recover-percent", "60" };
+
+// Ticks per decision, about half a second
+constexpr uint32_t WINDOW = 32;
+// A quarter of the window over budget steps down, single spikes don't
+constexpr uint32_t OVER_LIMIT = WINDOW / 4;
+// Calm windows in a row before stepping up again
+constexpr uint32_t RECOVER_WINDOWS = 6;
+
+std::atomic<uint8_t> current{ FULL };
+
+static const char *const names[] = { "full", "no visualisers", "slow navbot scoring", "no esp extras", "fast vischeck", "half backtrack" };
+static_assert(sizeof(names) / sizeof(names[0]) == LEVEL_COUNT, "Every level needs a name");
+
+static uint64_t tick_start   = 0;
+static uint32_t ticks        = 0;
+static uint32_t over         = 0;
+static uint64_t total_ns     = 0;
+static uint32_t calm_windows = 0;
+
+const char *Name(level at)
+{
+    return at < LEVEL_COUNT ? names[at] : "unknown";
+}
+
+static void Set(uint8_t next)
+{
+    uint8_t previous = Level();
+    if (next == previous)
+        return;
+    current.store(next, std::memory_order_relaxed);
+    logging::Info("Governor: %s -> %s", Name(level(previous)), Name(level(next)));
+}
+
+static void TickStart()
+{
+    tick_start = profiler::Now();
+}
+
+static void TickEnd()
+{
+    // CreateMove bailed out before the normal events this tick
+    if (!tick_start)
+        return;
+    uint64_t ns = uint64_t((profiler::Now() - tick_start) * profiler::NsPerTick());
+    tick_start  = 0;
+
+    uint64_t budget_ns = uint64_t(std::max(*budget, 1000)) * 1000;
+    total_ns += ns;
+    if (ns > budget_ns)
+        over++;
+    if (++ticks < WINDOW)
+        return;
+
+    uint8_t at = Level();
+    if (over >= OVER_LIMIT)
+    {
+        calm_windows = 0;
+        if (at + 1 < LEVEL_COUNT)
+            Set(at + 1);
+    }
+    // Average well under budget, and not even one tick over
+    else if (!over && total_ns / WINDOW < budget_ns * uint64_t(std::clamp(*recover_percent, 10, 95)) / 100)
+    {
+        if (at != FULL && ++calm_windows >= RECOVER_WINDOWS)
+        {
+            calm_windows = 0;
+            Set(at - 1);
+        }
+    }
+    else
+        calm_windows = 0;
+    ticks    = 0;
+    over     = 0;
+    total_ns = 0;
+}
+
+static void Reset()
+{
+    tick_start   = 0;
+    ticks        = 0;
+    over         = 0;
+    total_ns     = 0;
+    calm_windows = 0;
+    Set(FULL);
+}
+
+static CatCommand print("governor_status", "Show the current quality level", []() { logging::Info("Governor: level %u, %s%s", unsigned(Level()), Name(level(Level())), *enable ? "" : " (disabled)"); });
+
+static InitRoutine init([]() {
+    enable.installChangeCallback([](settings::VariableBase<bool> &, bool after) {
+        if (!after)
+            Reset();
+    });
+    EC::Register(EC::CreateMoveEarly, TickStart, "governor_tick_start", enable, EC::very_early);
+    EC::Register(EC::CreateMove, TickEnd, "governor_tick_end", enable, EC::very_late);
+    // Loading a map is slow on its own, don't start the next one degraded
+    EC::Register(EC::LevelInit, Reset, "governor_levelinit");
+});
+} // namespace governor
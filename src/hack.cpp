@@ -31,9 +31,11 @@
 #define STRINGIFY(x) #x
 #define TO_STRING(x) STRINGIFY(x)
 
-#include "copypasted/CDumper.hpp"
 #include "version.h"
 #include <cxxabi.h>
+#include "jobs.hpp"
+#include "core/resolvecache.hpp"
+#include "flightrecorder.hpp"
 
 /*
  *  Credits to josh33901 aka F1ssi0N for butifel F1Public and Darkstorm 2015
@@ -127,6 +129,10 @@ void critical_error_handler(int signum)
 {
     namespace st = boost::stacktrace;
     ::signal(signum, SIG_DFL);
+    // First, it's only plain writes and doesn't depend on anything below working
+    flight_recorder::DumpFatal();
+    // Get whatever is still queued onto disk before we go down
+    logging::Flush();
     passwd *pwd = getpwuid(getuid());
     std::ofstream out(strfmt("/tmp/cathook-%s-%d-segfault.log", pwd->pw_name, getpid()).get());
 
@@ -314,16 +320,10 @@ free(logname);*/
 
     CreateEarlyInterfaces();
     logging::Info("Clearing Early initializer stack");
-    while (!init_stack_early().empty())
-    {
-        init_stack_early().top()();
-        init_stack_early().pop();
-    }
+    startup::Run(init_stack_early(), "Early initializer stack");
     logging::Info("Early Initializer stack done");
     sharedobj::LoadAllSharedObjects();
     CreateInterfaces();
-    CDumper dumper;
-    dumper.SaveDump();
     logging::Info("Is TF2? %d", IsTF2());
     logging::Info("Is TF2C? %d", IsTF2C());
     logging::Info("Is HL2DM? %d", IsHL2DM());
@@ -356,12 +356,12 @@ free(logname);*/
     InitStrings();
 #endif /* TEXTMODE */
     logging::Info("Clearing initializer stack");
-    while (!init_stack().empty())
-    {
-        init_stack().top()();
-        init_stack().pop();
-    }
+    startup::Run(init_stack(), "Initializer stack");
     logging::Info("Initializer stack done");
+    // Everything the next launch of the same build can skip resolving
+    gSignatures.StoreCache();
+    gNetvars.store_cache();
+    resolve_cache::Save();
 #if ENABLE_TEXTMODE
     hack::command_stack().push("exec cat_autoexec_textmode");
 #else
@@ -398,12 +398,18 @@ void hack::Shutdown()
     hack::shutdown = true;
     // Stop cathook stuff
     settings::cathook_disabled.store(true);
+    logging::Info("Stopping background jobs..");
+    jobs::Shutdown();
     playerlist::Save();
 #if ENABLE_VISUALS
     sdl_hooks::cleanSdlHooks();
 #endif
     logging::Info("Unregistering convars..");
     ConVar_Unregister();
+    // Catches the lazy ones resolved after init
+    gSignatures.StoreCache();
+    gNetvars.store_cache();
+    resolve_cache::Save();
     logging::Info("Unloading sharedobjects..");
     sharedobj::UnloadAllSharedObjects();
     logging::Info("Deleting global interfaces...");
@@ -106,7 +106,7 @@ static void spectatorUpdate()
         break;
         // Disable if being spectated in first person
     case 1:
-        if (g_pLocalPlayer->spectator_state == g_pLocalPlayer->FIRSTPERSON)
+        if (spectators::LocalState() == spectators::FIRSTPERSON)
         {
             enable   = *specenable;
             slow_aim = *specslow;
@@ -115,7 +115,7 @@ static void spectatorUpdate()
         break;
         // Disable if being spectated
     case 2:
-        if (g_pLocalPlayer->spectator_state != g_pLocalPlayer->NONE)
+        if (spectators::LocalState() != spectators::NONE)
         {
             enable   = *specenable;
             slow_aim = *specslow;
@@ -137,18 +137,10 @@ float stop_moving_time = 0;
 
 int GetSentry()
 {
-    for (int i = 1; i <= HIGHEST_ENTITY; i++)
-    {
-        CachedEntity *ent = ENTITY(i);
-        if (CE_BAD(ent))
-            continue;
-        if (ent->m_Type() != ENTITY_BUILDING || ent->m_iClassID() != CL_CLASS(CObjectSentrygun))
-            continue;
-        if ((CE_INT(ent, netvar.m_hBuilder) & 0xFFF) != g_pLocalPlayer->entity_idx)
-            continue;
-        return i;
-    }
-    return -1;
+    auto sentry = entity_cache::OurBuilding(entity_cache::BUILDING_SENTRY);
+    if (!sentry || sentry->dormant)
+        return -1;
+    return sentry->ent->m_IDX;
 }
 
 settings::Boolean ignore_cloak{ "aimbot.target.ignore-cloaked-spies", "1" };
@@ -170,12 +162,12 @@ static bool CarryingHeatmaker()
 }
 
 // Backtrack filter for aimbot
-bool aimbotTickFilter(CachedEntity *ent, hacks::tf2::backtrack::BacktrackData tick)
+bool aimbotTickFilter(CachedEntity *ent, const hacks::tf2::backtrack::BacktrackData &tick)
 {
     // FOV check
     if (fov > 0.0f)
     {
-        float fov_scr = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, tick.hitboxes.at(0).center);
+        float fov_scr = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, tick.hitbox(0).center);
         // Failed FOV check
         if (fov_scr > fov)
             return false;
@@ -184,7 +176,15 @@ bool aimbotTickFilter(CachedEntity *ent, hacks::tf2::backtrack::BacktrackData ti
     if (g_pLocalPlayer->weapon_mode != weapon_hitscan)
         return true;
     // Return visibility
-    return IsEntityVectorVisible(ent, tick.hitboxes.at(head).center, true, MASK_SHOT);
+    return IsEntityVectorVisible(ent, tick.hitbox(head).center, true, MASK_SHOT);
+}
+
+// Closest tick passing aimbotTickFilter, skips the tick scan if none of them can be in the fov
+static std::optional<hacks::tf2::backtrack::BacktrackData> getBacktrackTick(CachedEntity *ent)
+{
+    if (fov > 0.0f && !hacks::tf2::backtrack::boundsInFov(ent->m_IDX, fov))
+        return std::nullopt;
+    return hacks::tf2::backtrack::getClosestEntTick(ent, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
 }
 static void doAutoZoom(bool target_found)
 {
@@ -498,6 +498,29 @@ bool ShouldAim()
     return true;
 }
 
+// Score a target by priority mode. Uses the collision box center instead of the aim position, since that is only known after IsTargetStateGood
+static float BroadphaseScore(CachedEntity *ent)
+{
+    // Distance Priority, Uses this is melee is used
+    if (GetWeaponMode() == weaponmode::weapon_melee || (int) priority_mode == 2)
+        return 4096.0f - aim_solution::Distance(ent);
+    switch ((int) priority_mode)
+    {
+    case 0: // Smart Priority, scored for all candidates at once in RetrieveBestTarget
+        return 0.0f;
+    case 1: // Fov Priority
+        return 360.0f - aim_solution::Fov(ent);
+    case 3: // Health Priority (Lowest)
+        return 450.0f - ent->m_iHealth();
+    case 4: // Distance Priority (Furthest Away)
+        return aim_solution::Distance(ent);
+    case 5: // Health Priority (Highest)
+        return ent->m_iHealth() * 4;
+    default:
+        return 0.0f;
+    }
+}
+
 // Function to find a suitable target
 CachedEntity *RetrieveBestTarget(bool aimkey_state)
 {
@@ -516,54 +539,48 @@ CachedEntity *RetrieveBestTarget(bool aimkey_state)
         }
     }
 
-    float target_highest_score, scr = 0.0f;
-    CachedEntity *ent;
-    CachedEntity *target_highest_ent = 0;
-    target_highest_score             = -256;
+    // Broadphase, score everything from cached data only and validate in score order.
+    // IsTargetStateGood does the hitbox selection, prediction and vischecks, so it only runs until the first target passes
+    struct candidate_s
+    {
+        float score;
+        CachedEntity *ent;
+    };
+    static std::vector<candidate_s> candidates;
+    candidates.clear();
     for (int i = 1; i <= HIGHEST_ENTITY; i++)
     {
-        ent = ENTITY(i);
+        CachedEntity *ent = ENTITY_UNCHECKED(i);
         if (CE_BAD(ent))
             continue; // Check for null and dormant
-        // Check whether the current ent is good enough to target
-        if (IsTargetStateGood(ent))
+        if (ent->m_Type() != ENTITY_PLAYER && ent->m_Type() != ENTITY_BUILDING && ent->m_Type() != ENTITY_NPC)
         {
-            // Distance Priority, Uses this is melee is used
-            if (GetWeaponMode() == weaponmode::weapon_melee || (int) priority_mode == 2)
-                scr = 4096.0f - calculated_data_array[i].aim_position.DistTo(g_pLocalPlayer->v_Eye);
-            else
-            {
-                switch ((int) priority_mode)
-                {
-                case 0: // Smart Priority
-                    scr = GetScoreForEntity(ent);
-                    break;
-                case 1: // Fov Priority
-                    scr = 360.0f - calculated_data_array[ent->m_IDX].fov;
-                    break;
-                case 3: // Health Priority (Lowest)
-                    scr = 450.0f - ent->m_iHealth();
-                    break;
-                case 4: // Distance Priority (Furthest Away)
-                    scr = calculated_data_array[i].aim_position.DistTo(g_pLocalPlayer->v_Eye);
-                    break;
-                case 5: // Health Priority (Highest)
-                    scr = ent->m_iHealth() * 4;
-                    break;
-                default:
-                    break;
-                }
-            }
-            // Compare the top score to our current ents score
-            if (scr > target_highest_score)
-            {
-                target_highest_score = scr;
-                target_highest_ent   = ent;
-            }
+            // Stickies are projectiles, IsTargetStateGood does the rest of the checks
+            if (!stickybot || ent->m_Type() != ENTITY_PROJECTILE || ent->m_iClassID() != CL_CLASS(CTFGrenadePipebombProjectile))
+                continue;
         }
+        if (ent == LOCAL_E)
+            continue;
+        candidates.push_back({ BroadphaseScore(ent), ent });
     }
+    if (GetWeaponMode() != weaponmode::weapon_melee && (int) priority_mode == 0)
+    {
+        static std::vector<CachedEntity *> entities;
+        static std::vector<float> scores;
+        entities.clear();
+        for (auto &candidate : candidates)
+            entities.push_back(candidate.ent);
+        scores.resize(entities.size());
+        GetScoresForEntities(entities.data(), entities.size(), scores.data());
+        for (size_t i = 0; i < candidates.size(); i++)
+            candidates[i].score = scores[i];
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const candidate_s &a, const candidate_s &b) { return a.score > b.score; });
 
-    return target_highest_ent;
+    for (auto &candidate : candidates)
+        if (IsTargetStateGood(candidate.ent))
+            return candidate.ent;
+    return nullptr;
 }
 
 // A second check to determine whether a target is good enough to be aimed at
@@ -604,14 +621,14 @@ bool IsTargetStateGood(CachedEntity *entity)
                     Ray_t ray;
                     trace::filter_default.SetSelf(RAW_ENT(g_pLocalPlayer->entity));
                     ray.Init(g_pLocalPlayer->v_Eye, GetForwardVector(g_pLocalPlayer->v_Eye, newangle, swingrange, LOCAL_E));
-                    g_ITrace->TraceRay(ray, MASK_SHOT_HULL, &trace::filter_default, &trace);
+                    trace::TraceRay(ray, MASK_SHOT_HULL, &trace::filter_default, &trace);
                     if ((IClientEntity *) trace.m_pEnt != RAW_ENT(entity))
                         return false;
                 }
                 else
                 {
                     // This does vischecks and everything
-                    auto data = hacks::tf2::backtrack::getClosestEntTick(entity, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
+                    auto data = getBacktrackTick(entity);
                     // No data found
                     if (!data)
                         return false;
@@ -734,7 +751,7 @@ bool IsTargetStateGood(CachedEntity *entity)
             if (shouldBacktrack())
             {
                 // This does vischecks and everything
-                auto data = hacks::tf2::backtrack::getClosestEntTick(entity, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
+                auto data = getBacktrackTick(entity);
                 // No data found
                 if (!data)
                     return false;
@@ -881,7 +898,7 @@ bool IsTargetStateGood(CachedEntity *entity)
             if (shouldBacktrack())
             {
                 // This does vischecks and everything
-                auto data = hacks::tf2::backtrack::getClosestEntTick(entity, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
+                auto data = getBacktrackTick(entity);
                 // No data found
                 if (!data)
                     return false;
@@ -927,8 +944,8 @@ void Aim(CachedEntity *entity)
         if (shouldBacktrack())
         {
             // This does vischecks and everything
-            auto data    = hacks::tf2::backtrack::getClosestEntTick(entity, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
-            auto bt_hb   = data->hitboxes.at(cd.hitbox);
+            auto data    = getBacktrackTick(entity);
+            auto bt_hb   = data->hitbox(cd.hitbox);
             hitboxcenter = bt_hb.center;
             hitboxmin    = bt_hb.min;
             hitboxmax    = bt_hb.max;
@@ -976,7 +993,7 @@ void Aim(CachedEntity *entity)
     // Set Backtrack data
     if (shouldBacktrack() && entity->m_Type() == ENTITY_PLAYER)
     {
-        auto data = hacks::tf2::backtrack::getClosestEntTick(entity, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
+        auto data = getBacktrackTick(entity);
         if (data)
             hacks::tf2::backtrack::SetBacktrackData(entity, *data);
     }
@@ -1061,7 +1078,7 @@ void DoAutoshoot(CachedEntity *target_entity)
     // Ambassador check
     IF_GAME(IsTF2())
     {
-        if (IsAmbassador(g_pLocalPlayer->weapon()))
+        if (g_pLocalPlayer->holdingAmbassador())
         {
             // Check if ambasador can headshot
             if (!AmbassadorCanHeadshot() && wait_for_charge)
@@ -1156,10 +1173,10 @@ const Vector &PredictEntity(CachedEntity *entity)
     }
     else
     {
-        auto data = hacks::tf2::backtrack::getClosestEntTick(entity, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
+        auto data = getBacktrackTick(entity);
         if (data)
         {
-            result          = data->hitboxes.at(cd.hitbox).center;
+            result          = data->hitbox(cd.hitbox).center;
             cd.predict_tick = tickcount;
             cd.fov          = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, result);
         }
@@ -1168,6 +1185,92 @@ const Vector &PredictEntity(CachedEntity *entity)
     return result;
 }
 
+// Everything BestHitbox needs to know about the local weapon, the same for every target in a tick
+struct weapon_profile_s
+{
+    unsigned long tick{ ~0UL };
+    int preferred{ 0 };
+    bool headonly{ false };
+    bool sniper{ false };
+    bool can_headshot{ false };
+    bool bow{ false };
+    int bow_damage{ 0 };
+    bool ambassador{ false };
+    bool projectile{ false };
+    bool crit_boosted{ false };
+    // Sniper charged and body shot damage, heatmaker already applied
+    float charged_damage{ 0.0f };
+    float body_damage{ 50.0f };
+};
+
+static const weapon_profile_s &GetWeaponProfile()
+{
+    static weapon_profile_s profile;
+    if (profile.tick == tickcount)
+        return profile;
+    profile           = weapon_profile_s{};
+    profile.tick      = tickcount;
+    profile.preferred = int(hitbox);
+
+    IF_GAME(IsTF())
+    {
+        int ci               = g_pLocalPlayer->weapon()->m_iClassID();
+        profile.preferred    = hitbox_t::spine_2;
+        profile.projectile   = GetWeaponMode() == weaponmode::weapon_projectile;
+        profile.crit_boosted = IsPlayerCritBoosted(g_pLocalPlayer->entity);
+        // Sniper rifle
+        if (g_pLocalPlayer->holding_sniper_rifle)
+        {
+            profile.sniper         = true;
+            profile.can_headshot   = CanHeadshot();
+            profile.headonly       = profile.can_headshot;
+            profile.charged_damage = CE_FLOAT(LOCAL_W, netvar.flChargedDamage);
+            if (CarryingHeatmaker())
+            {
+                profile.body_damage    = (profile.body_damage * .80) - 1;
+                profile.charged_damage = (profile.charged_damage * .80) - 1;
+            }
+        }
+        // Hunstman
+        else if (ci == CL_CLASS(CTFCompoundBow))
+        {
+            float begincharge  = CE_FLOAT(g_pLocalPlayer->weapon(), netvar.flChargeBeginTime);
+            float charge       = g_GlobalVars->curtime - begincharge;
+            profile.bow        = true;
+            profile.bow_damage = std::floor(50.0f + 70.0f * fminf(1.0f, charge));
+        }
+        else if (g_pLocalPlayer->holdingAmbassador())
+        {
+            profile.ambassador = true;
+            profile.headonly   = AmbassadorCanHeadshot();
+        }
+        // These weapons should aim at the foot if the target is grounded
+        else if (ci == CL_CLASS(CTFPipebombLauncher) || ci == CL_CLASS(CTFRocketLauncher) || ci == CL_CLASS(CTFParticleCannon) || ci == CL_CLASS(CTFRocketLauncher_AirStrike) || ci == CL_CLASS(CTFRocketLauncher_Mortar))
+        {
+            profile.preferred = hitbox_t::foot_L;
+        }
+        // These weapons should aim at the center of mass due to little/no splash
+        else if (ci == CL_CLASS(CTFRocketLauncher_DirectHit) || ci == CL_CLASS(CTFGrenadeLauncher))
+        {
+            profile.preferred = hitbox_t::spine_3;
+        }
+    }
+    // In counter-strike source, headshots are what we want
+    else IF_GAME(IsCSS())
+    {
+        profile.headonly = true;
+    }
+    return profile;
+}
+
+// Per target result of the auto hitbox mode, BestHitbox gets asked more than once per target and tick
+struct hitbox_choice_s
+{
+    unsigned long tick{ ~0UL };
+    int hitbox{ -1 };
+};
+static std::array<hitbox_choice_s, 2048> hitbox_choices{};
+
 // A function to find the best hitbox for a target
 int BestHitbox(CachedEntity *target)
 {
@@ -1176,72 +1279,47 @@ int BestHitbox(CachedEntity *target)
     {
     case 0:
     { // AUTO-HEAD priority
-        int preferred = int(hitbox);
-        bool headonly = false; // Var to keep if we can bodyshot
+        auto &choice = hitbox_choices[target->m_IDX];
+        if (choice.tick == tickcount)
+            return choice.hitbox;
+        choice.tick   = tickcount;
+        choice.hitbox = -1;
+
+        const auto &profile = GetWeaponProfile();
+        int preferred       = profile.preferred;
+        bool headonly       = profile.headonly; // Var to keep if we can bodyshot
 
         IF_GAME(IsTF())
         {
-            int ci    = g_pLocalPlayer->weapon()->m_iClassID();
-            preferred = hitbox_t::spine_2;
-            // Sniper rifle
-            if (g_pLocalPlayer->holding_sniper_rifle)
+            if (profile.bow)
             {
-                headonly = CanHeadshot();
-                // Hunstman
-            }
-            else if (ci == CL_CLASS(CTFCompoundBow))
-            {
-                float begincharge = CE_FLOAT(g_pLocalPlayer->weapon(), netvar.flChargeBeginTime);
-                float charge      = g_GlobalVars->curtime - begincharge;
-                int damage        = std::floor(50.0f + 70.0f * fminf(1.0f, charge));
-                if (damage >= target->m_iHealth())
+                if (profile.bow_damage >= target->m_iHealth())
                     preferred = hitbox_t::spine_3;
                 else
                     preferred = hitbox_t::head;
             }
-            else if (IsAmbassador(g_pLocalPlayer->weapon()))
+            else if (profile.ambassador)
             {
-                headonly = AmbassadorCanHeadshot();
                 // 18 health is a good number to use as thats the usual minimum
                 // damage it can do with a bodyshot, but damage could
                 // potentially be higher
-                if (target->m_iHealth() <= 18 || IsPlayerCritBoosted(g_pLocalPlayer->entity) || target->m_flDistance() > 1200)
+                if (target->m_iHealth() <= 18 || profile.crit_boosted || target->m_flDistance() > 1200)
                     headonly = false;
-                // Rocket launcher
-            }
-            // These weapons should aim at the foot if the target is grounded
-            else if (ci == CL_CLASS(CTFPipebombLauncher) || ci == CL_CLASS(CTFRocketLauncher) || ci == CL_CLASS(CTFParticleCannon) || ci == CL_CLASS(CTFRocketLauncher_AirStrike) || ci == CL_CLASS(CTFRocketLauncher_Mortar))
-            {
-                preferred = hitbox_t::foot_L;
-            }
-            // These weapons should aim at the center of mass due to little/no splash
-            else if (ci == CL_CLASS(CTFRocketLauncher_DirectHit) || ci == CL_CLASS(CTFGrenadeLauncher))
-            {
-                preferred = hitbox_t::spine_3;
             }
 
             // Airborn targets should always get hit in center
-            if (GetWeaponMode() == weaponmode::weapon_projectile)
+            if (profile.projectile && !profile.bow)
             {
-                if (g_pLocalPlayer->weapon()->m_iClassID() != CL_CLASS(CTFCompoundBow))
-                {
-                    bool ground = CE_INT(target, netvar.iFlags) & (1 << 0);
-                    if (!ground)
-                        preferred = hitbox_t::spine_3;
-                }
+                bool ground = CE_INT(target, netvar.iFlags) & (1 << 0);
+                if (!ground)
+                    preferred = hitbox_t::spine_3;
             }
 
             // Bodyshot handling
-            if (g_pLocalPlayer->holding_sniper_rifle)
+            if (profile.sniper)
             {
-
-                float cdmg = CE_FLOAT(LOCAL_W, netvar.flChargedDamage);
-                float bdmg = 50;
-                if (CarryingHeatmaker())
-                {
-                    bdmg = (bdmg * .80) - 1;
-                    cdmg = (cdmg * .80) - 1;
-                }
+                float cdmg = profile.charged_damage;
+                float bdmg = profile.body_damage;
                 // Darwins damage correction, protects against 15% of damage
                 //                if (HasDarwins(target))
                 //                {
@@ -1272,60 +1350,57 @@ int BestHitbox(CachedEntity *target)
                 // zoomed, or if the enemy has less than 40, due to darwins, and
                 // only if they have less than 150 health will it try to
                 // bodyshot
-                if (CanHeadshot() && (std::floor(cdmg) >= target->m_iHealth() || IsPlayerCritBoosted(g_pLocalPlayer->entity) || !g_pLocalPlayer->bZoomed || target->m_iHealth() <= std::floor(bdmg)) && target->m_iHealth() <= 150)
+                if (profile.can_headshot && (std::floor(cdmg) >= target->m_iHealth() || profile.crit_boosted || !g_pLocalPlayer->bZoomed || target->m_iHealth() <= std::floor(bdmg)) && target->m_iHealth() <= 150)
                 {
                     // We dont need to hit the head as a bodyshot will kill
                     preferred = hitbox_t::spine_1;
                     headonly  = false;
                 }
             }
-            // In counter-strike source, headshots are what we want
-        }
-        else IF_GAME(IsCSS())
-        {
-            headonly = true;
         }
         // Head only
         if (headonly)
         {
             IF_GAME(IsTF())
-            return hitbox_t::head;
+            return choice.hitbox = hitbox_t::head;
             IF_GAME(IsCSS())
-            return 12;
+            return choice.hitbox = 12;
         }
 
         // Backtracking and preferred hitbox
         if (shouldBacktrack())
         {
-            auto data = hacks::tf2::backtrack::getClosestEntTick(target, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
+            auto data = getBacktrackTick(target);
 
             if (data)
             {
+                trace::Batch batch(target, MASK_SHOT_HULL, false);
                 // First check preferred hitbox
-                if (IsEntityVectorVisible(target, (*data).hitboxes[preferred].center, false))
-                    return preferred;
+                batch.Add((*data).hitbox(preferred).center, preferred, true);
 
-                // Then check the rest
+                // Then check the rest, pinned too so they keep this order
                 if (*backtrackVischeckAll)
                     for (int j = head; j < foot_R; j++)
-                    {
-                        if (IsEntityVectorVisible(target, (*data).hitboxes[j].center, false))
-                            return j;
-                    }
-                else if (IsEntityVectorVisible(target, (*data).hitboxes.at(head).center, false))
-                    return 0;
+                        batch.Add((*data).hitbox(j).center, j, true);
+                else
+                    batch.Add((*data).hitbox(head).center, 0, true);
+                int visible = batch.AnyVisible();
+                if (visible != -1)
+                    return choice.hitbox = visible;
             }
             // Nothing found, falling through to further below
         }
-        else if (target->hitboxes.VisibilityCheck(preferred))
-            return preferred;
-        // Else attempt to find any hitbox at all
-        if (!shouldBacktrack())
+        else
+        {
+            trace::Batch batch(target);
+            batch.AddHitbox(preferred, true);
+            // Else attempt to find any hitbox at all, lowest id first like always
             for (int i = projectile_mode ? 1 : 0; i < target->hitboxes.GetNumHitboxes() && i < 6; i++)
-            {
-                if (target->hitboxes.VisibilityCheck(i))
-                    return i;
-            }
+                batch.AddHitbox(i, true);
+            int visible = batch.AnyVisible();
+            if (visible != -1)
+                return choice.hitbox = visible;
+        }
     }
     break;
     case 1:
@@ -1390,8 +1465,8 @@ bool VischeckPredictedEntity(CachedEntity *entity)
     }
     else
     {
-        auto data = hacks::tf2::backtrack::getClosestEntTick(entity, LOCAL_E->m_vecOrigin(), aimbotTickFilter);
-        if (data && IsEntityVectorVisible(entity, data->hitboxes.at((cd.hitbox == -1 || cd.hitbox >= 18) ? 0 : cd.hitbox).center, false, MASK_SHOT))
+        auto data = getBacktrackTick(entity);
+        if (data && IsEntityVectorVisible(entity, data->hitbox((cd.hitbox == -1 || cd.hitbox >= 18) ? 0 : cd.hitbox).center, false, MASK_SHOT))
             cd.visible = true;
         else
             cd.visible = false;
@@ -1504,7 +1579,7 @@ bool UpdateAimkey()
 float EffectiveTargetingRange()
 {
     if (GetWeaponMode() == weapon_melee)
-        return (float) re::C_TFWeaponBaseMelee::GetSwingRange(RAW_ENT(LOCAL_W));
+        return g_pLocalPlayer->melee_range;
     if (g_pLocalPlayer->weapon()->m_iClassID() == CL_CLASS(CTFFlameThrower))
         return 310.0f; // Pyros only have so much until their flames hit
     if (g_pLocalPlayer->weapon()->m_iClassID() == CL_CLASS(CTFWeaponFlameBall))
@@ -69,10 +69,12 @@ void check_combos()
     }
 }
 
-void on_kill(IGameEvent *event)
+void on_kill(const game_events::event_s &event)
 {
-    int killer_id = g_IEngine->GetPlayerForUserID(event->GetInt("attacker"));
-    int victim_id = g_IEngine->GetPlayerForUserID(event->GetInt("userid"));
+    if (!enable)
+        return;
+    int killer_id = event.death->attacker;
+    int victim_id = event.death->victim;
 
     if (victim_id == g_IEngine->GetLocalPlayer())
     {
@@ -96,7 +98,7 @@ void on_kill(IGameEvent *event)
         playsound("humiliation.wav");
         return;
     }
-    if (event->GetInt("customkill") == 1)
+    if (event.death->customkill == 1)
     {
         headshotcombo++;
         last_headshot.update();
@@ -120,44 +122,24 @@ void on_kill(IGameEvent *event)
     }
 }
 
-void on_spawn(IGameEvent *event)
+void on_spawn(const game_events::event_s &event)
 {
-    int userid = g_IEngine->GetPlayerForUserID(event->GetInt("userid"));
-
-    if (userid == g_IEngine->GetLocalPlayer())
+    if (!enable)
+        return;
+    if (event.player == g_IEngine->GetLocalPlayer())
     {
         reset();
     }
 }
 
-class AnnouncerEventListener : public IGameEventListener2
-{
-    virtual void FireGameEvent(IGameEvent *event)
-    {
-        if (!enable)
-            return;
-        if (0 == strcmp(event->GetName(), "player_death"))
-            on_kill(event);
-        else if (0 == strcmp(event->GetName(), "player_spawn"))
-            on_spawn(event);
-    }
-};
-
-AnnouncerEventListener &listener()
-{
-    static AnnouncerEventListener object{};
-    return object;
-}
-
 void init()
 {
-    g_IEventManager2->AddListener(&listener(), "player_death", false);
-    g_IEventManager2->AddListener(&listener(), "player_spawn", false);
+    game_events::Subscribe("player_death", on_kill);
+    game_events::Subscribe("player_spawn", on_spawn);
 }
 
 void shutdown()
 {
-    g_IEventManager2->RemoveListener(&listener());
 }
 
 static InitRoutine EC([]() {
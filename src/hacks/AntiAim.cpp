@@ -276,20 +276,88 @@ float edgeDistance(float edgeRayYaw)
     forward   = forward * 300.0f + g_pLocalPlayer->v_Eye;
     ray.Init(g_pLocalPlayer->v_Eye, forward);
     // trace::g_pFilterNoPlayer to only focus on the enviroment
-    g_ITrace->TraceRay(ray, 0x4200400B, &trace::filter_no_player, &trace);
+    trace::TraceRay(ray, 0x4200400B, &trace::filter_no_player, &trace);
     // Pythagorean theorem to calculate distance
     float edgeDistance = (sqrt(pow(trace.startpos.x - trace.endpos.x, 2) + pow(trace.startpos.y - trace.endpos.y, 2)));
     return edgeDistance;
 }
 
+// Edge distances on a fixed ring of yaws around the eye, kept until we leave the grid cell they were cast from.
+// Standing still, a direction only gets traced again once its result is a second old
+namespace edge_probes
+{
+constexpr int STEPS        = 120; // 3 degrees apart
+constexpr float CELL       = 8.0f;
+constexpr int MAX_AGE      = 66; // ticks
+constexpr int WARMUP_SLOTS = 2;  // Extra directions cast per tick once we stopped
+
+static float distance[STEPS];
+// Tick a direction was cast at, -1 if not since the cell changed
+static int cast_tick[STEPS];
+static int cell[3]{ INT_MIN, INT_MIN, INT_MIN };
+static int cell_tick = 0;
+static int warmup    = 0;
+
+static void Invalidate()
+{
+    for (int &tick : cast_tick)
+        tick = -1;
+}
+
+static void Update()
+{
+    int now = g_GlobalVars->tickcount;
+    int x   = (int) floorf(g_pLocalPlayer->v_Eye.x / CELL);
+    int y   = (int) floorf(g_pLocalPlayer->v_Eye.y / CELL);
+    int z   = (int) floorf(g_pLocalPlayer->v_Eye.z / CELL);
+    // Tick count going backwards means a new server or a rejoin
+    if (x != cell[0] || y != cell[1] || z != cell[2] || now < cell_tick)
+    {
+        cell[0]   = x;
+        cell[1]   = y;
+        cell[2]   = z;
+        cell_tick = now;
+        Invalidate();
+        return;
+    }
+    // Same cell since last tick, fill in the rest of the ring before the view turns to it
+    if (now == cell_tick)
+        return;
+    for (int budget = WARMUP_SLOTS, checked = 0; budget && checked < STEPS; checked++)
+    {
+        warmup = (warmup + 1) % STEPS;
+        if (cast_tick[warmup] >= 0)
+            continue;
+        distance[warmup]  = edgeDistance(warmup * (360.0f / STEPS));
+        cast_tick[warmup] = now;
+        budget--;
+    }
+}
+
+static float Distance(float yaw)
+{
+    int step = (int) roundf(yaw / (360.0f / STEPS)) % STEPS;
+    if (step < 0)
+        step += STEPS;
+    int now = g_GlobalVars->tickcount;
+    if (cast_tick[step] < 0 || now - cast_tick[step] > MAX_AGE)
+    {
+        distance[step]  = edgeDistance(step * (360.0f / STEPS));
+        cast_tick[step] = now;
+    }
+    return distance[step];
+}
+} // namespace edge_probes
+
 // Function to Find an edge and report if one is found at all
 bool findEdge(float edgeOrigYaw)
 {
+    edge_probes::Update();
     // distance two vectors and report their combined distances
-    float edgeLeftDist  = edgeDistance(edgeOrigYaw - 21);
-    edgeLeftDist        = edgeLeftDist + edgeDistance(edgeOrigYaw - 27);
-    float edgeRightDist = edgeDistance(edgeOrigYaw + 21);
-    edgeRightDist       = edgeRightDist + edgeDistance(edgeOrigYaw + 27);
+    float edgeLeftDist  = edge_probes::Distance(edgeOrigYaw - 21);
+    edgeLeftDist        = edgeLeftDist + edge_probes::Distance(edgeOrigYaw - 27);
+    float edgeRightDist = edge_probes::Distance(edgeOrigYaw + 21);
+    edgeRightDist       = edgeRightDist + edge_probes::Distance(edgeOrigYaw + 27);
 
     // If the distance is too far, then set the distance to max so the angle
     // isnt used
@@ -596,5 +664,6 @@ bool isEnabled()
     return *enable;
 }
 
+static InitRoutine edge_reset([]() { EC::Register(EC::LevelInit, edge_probes::Invalidate, "antiaim_edge_probes"); });
 static InitRoutine fakelag_check([]() { yaw_mode.installChangeCallback([](settings::VariableBase<int> &, int after) { force_fakelag = after >= 9 ? true : false; }); });
 } // namespace hacks::shared::antiaim
@@ -11,9 +11,122 @@ namespace hacks::shared::anti_anti_aim
 static settings::Boolean enable{ "anti-anti-aim.enable", "false" };
 static settings::Boolean debug{ "anti-anti-aim.debug.enable", "false" };
 
-std::unordered_map<unsigned, brutedata> resolver_map;
 std::array<CachedEntity *, 32> sniperdot_array;
 
+static std::array<float, 5> yaw_resolves{ 0.0f, 180.0f, 65.0f, -65.0f, -180.0f };
+
+enum pitch_mode : uint8_t
+{
+    pitch_networked,
+    pitch_flip,
+    pitch_sniperdot
+};
+
+// Per player slot, indexed by entindex. The recv proxies only ever look up and write what the tick stage in
+// CreateMove put here, they run in the middle of packet processing
+static struct
+{
+    bool active[PLAYER_ARRAY_SIZE];
+    uint8_t pitch[PLAYER_ARRAY_SIZE];
+    float yaw_offset[PLAYER_ARRAY_SIZE];
+    float dot_pitch[PLAYER_ARRAY_SIZE];
+    // Angles as networked, before we touched them
+    float networked_pitch[PLAYER_ARRAY_SIZE];
+    float networked_yaw[PLAYER_ARRAY_SIZE];
+    // Brute force history, starts over once someone else is in the slot
+    unsigned friendsid[PLAYER_ARRAY_SIZE];
+    int brutenum[PLAYER_ARRAY_SIZE];
+    int hits_in_a_row[PLAYER_ARRAY_SIZE];
+} resolver{};
+
+static inline float normalizeYaw(float angle)
+{
+    return angle - 360.0f * std::round(angle / 360.0f);
+}
+
+static inline float resolvedPitch(int idx, float angle)
+{
+    if (!resolver.active[idx])
+        return angle;
+    switch (resolver.pitch[idx])
+    {
+    case pitch_flip:
+        if (angle >= 90)
+            return -89;
+        if (angle <= -90)
+            return 89;
+        return angle;
+    case pitch_sniperdot:
+        return resolver.dot_pitch[idx];
+    default:
+        return angle;
+    }
+}
+
+static inline float resolvedYaw(int idx, float angle)
+{
+    if (!resolver.active[idx])
+        return angle;
+    return normalizeYaw(angle + resolver.yaw_offset[idx]);
+}
+
+// The CSniperDot the player is aiming with, if any
+static CachedEntity *sniperDot(CachedEntity *ent)
+{
+    // Get Weapon id
+    auto weapon_id = HandleToIDX(CE_INT(ent, netvar.hActiveWeapon));
+
+    // Check IDX for validity
+    if (IDX_BAD(weapon_id))
+        return nullptr;
+    auto weapon_ent = ENTITY(weapon_id);
+    // Check weapon for validity
+    if (CE_BAD(weapon_ent) || (weapon_ent->m_iClassID() != CL_CLASS(CTFSniperRifle) && weapon_ent->m_iClassID() != CL_CLASS(CTFSniperRifleDecap) && weapon_ent->m_iClassID() != CL_CLASS(CTFSniperRifleClassic)))
+        return nullptr;
+    // Check if the dot is still good
+    CachedEntity *sniper_dot = sniperdot_array.at(ent->m_IDX - 1);
+    if (CE_BAD(sniper_dot) || sniper_dot->m_iClassID() != CL_CLASS(CSniperDot))
+        return nullptr;
+    return sniper_dot;
+}
+
+// Works out what the proxies apply to that player from the brute force state
+static void updateSlot(int idx)
+{
+    CachedEntity *ent = ENTITY(idx);
+    if (CE_BAD(ent) || !ent->m_bAlivePlayer())
+    {
+        resolver.active[idx] = false;
+        return;
+    }
+    if (resolver.friendsid[idx] != ent->player_info.friendsID)
+    {
+        resolver.friendsid[idx]     = ent->player_info.friendsID;
+        resolver.brutenum[idx]      = 0;
+        resolver.hits_in_a_row[idx] = 0;
+    }
+    // Yaw Resolving
+    // Find out which angle we should try
+    resolver.yaw_offset[idx] = yaw_resolves[(resolver.brutenum[idx] / 2) % yaw_resolves.size()];
+
+    CachedEntity *sniper_dot = sniperDot(ent);
+    // No sniper dot/not using a sniperrifle.
+    if (!sniper_dot)
+        resolver.pitch[idx] = resolver.brutenum[idx] % 2 ? pitch_flip : pitch_networked;
+    // Sniper dot found, use it.
+    else
+    {
+        // Get Angle from eye to dot
+        Vector diff = sniper_dot->m_vecOrigin() - re::C_BasePlayer::GetEyePosition(RAW_ENT(ent));
+        Vector angles;
+        VectorAngles(diff, angles);
+        // Use the pitch (yaw is not useable because sadly the sniper dot does not represent it with fake yaw)
+        resolver.pitch[idx]     = pitch_sniperdot;
+        resolver.dot_pitch[idx] = angles.x;
+    }
+    resolver.active[idx] = true;
+}
+
 static inline void modifyAnlges()
 {
     for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
@@ -21,12 +134,12 @@ static inline void modifyAnlges()
         auto player = ENTITY(i);
         if (CE_BAD(player) || !player->m_bAlivePlayer() || !player->m_bEnemy() || !player->player_info.friendsID)
             continue;
-        auto &data  = resolver_map[player->player_info.friendsID];
         auto &angle = CE_VECTOR(player, netvar.m_angEyeAngles);
-        angle.x     = data.new_angle.x;
-        angle.y     = data.new_angle.y;
+        angle.x     = resolvedPitch(i, resolver.networked_pitch[i]);
+        angle.y     = resolvedYaw(i, resolver.networked_yaw[i]);
     }
 }
+
 static inline void CreateMove()
 {
     // Empty the array
@@ -46,6 +159,8 @@ static inline void CreateMove()
         // Good sniper dot, add to array
         sniperdot_array.at(ent_idx - 1) = dot_ent;
     }
+    for (int i = 1; i < PLAYER_ARRAY_SIZE; i++)
+        updateSlot(i);
 }
 
 void frameStageNotify(ClientFrameStage_t stage)
@@ -60,141 +175,71 @@ void frameStageNotify(ClientFrameStage_t stage)
 #endif
 }
 
-static std::array<float, 5> yaw_resolves{ 0.0f, 180.0f, 65.0f, -65.0f, -180.0f };
-
-static float resolveAngleYaw(float angle, brutedata &brute)
-{
-    brute.original_angle.y = angle;
-    while (angle > 180)
-        angle -= 360;
-
-    while (angle < -180)
-        angle += 360;
-
-    // Yaw Resolving
-    // Find out which angle we should try
-    int entry = (int) std::floor((brute.brutenum / 2.0f)) % yaw_resolves.size();
-    angle += yaw_resolves[entry];
-
-    while (angle > 180)
-        angle -= 360;
-
-    while (angle < -180)
-        angle += 360;
-    brute.new_angle.y = angle;
-    return angle;
-}
-
-static float resolveAnglePitch(float angle, brutedata &brute, CachedEntity *ent)
+void registerHit(int idx)
 {
-    brute.original_angle.x = angle;
-
-    // Get CSniperDot associated with entity
-    CachedEntity *sniper_dot = nullptr;
-
-    // Get Weapon id
-    auto weapon_id = HandleToIDX(CE_INT(ent, netvar.hActiveWeapon));
-
-    // Check IDX for validity
-    if (IDX_GOOD(weapon_id))
-    {
-        auto weapon_ent = ENTITY(weapon_id);
-        // Check weapon for validity
-        if (CE_GOOD(weapon_ent) && (weapon_ent->m_iClassID() == CL_CLASS(CTFSniperRifle) || weapon_ent->m_iClassID() == CL_CLASS(CTFSniperRifleDecap) || weapon_ent->m_iClassID() == CL_CLASS(CTFSniperRifleClassic)))
-        {
-            // Get Sniperdot
-            sniper_dot = sniperdot_array.at(ent->m_IDX - 1);
-            // Check if the dot is still good, if not then set to nullptr
-            if (CE_BAD(sniper_dot) || sniper_dot->m_iClassID() != CL_CLASS(CSniperDot))
-                sniper_dot = nullptr;
-        }
-    }
-    // No sniper dot/not using a sniperrifle.
-    if (sniper_dot == nullptr)
-    {
-        if (brute.brutenum % 2)
-        {
-            // Pitch resolver
-            if (angle >= 90)
-                angle = -89;
-            if (angle <= -90)
-                angle = 89;
-        }
-    }
-    // Sniper dot found, use it.
-    else
-    {
-        // Get End and start point
-        auto dot_origin = sniper_dot->m_vecOrigin();
-        auto eye_origin = re::C_BasePlayer::GetEyePosition(RAW_ENT(ent));
-        // Get Angle from eye to dot
-        Vector diff = dot_origin - eye_origin;
-        Vector angles;
-        VectorAngles(diff, angles);
-        // Use the pitch (yaw is not useable because sadly the sniper dot does not represent it with fake yaw)
-        angle = angles.x;
-    }
-
-    brute.new_angle.x = angle;
-    return angle;
+    auto ent = ENTITY(idx);
+    if (idx <= 0 || idx >= PLAYER_ARRAY_SIZE || CE_BAD(ent) || resolver.friendsid[idx] != ent->player_info.friendsID)
+        return;
+    resolver.hits_in_a_row[idx]++;
 }
 
 void increaseBruteNum(int idx)
 {
     auto ent = ENTITY(idx);
-    if (CE_BAD(ent) || !ent->player_info.friendsID)
+    if (idx <= 0 || idx >= PLAYER_ARRAY_SIZE || CE_BAD(ent) || !ent->player_info.friendsID || resolver.friendsid[idx] != ent->player_info.friendsID)
         return;
-    auto &data = hacks::shared::anti_anti_aim::resolver_map[ent->player_info.friendsID];
-    if (data.hits_in_a_row >= 4)
-        data.hits_in_a_row = 2;
-    else if (data.hits_in_a_row >= 2)
-        data.hits_in_a_row = 0;
+    int &hits_in_a_row = resolver.hits_in_a_row[idx];
+    if (hits_in_a_row >= 4)
+        hits_in_a_row = 2;
+    else if (hits_in_a_row >= 2)
+        hits_in_a_row = 0;
     else
     {
-        data.brutenum++;
+        resolver.brutenum[idx]++;
         if (debug)
-            logging::Info("AAA: Brutenum for entity %i increased to %i", idx, data.brutenum);
-        data.hits_in_a_row = 0;
-        auto &angle        = CE_VECTOR(ent, netvar.m_angEyeAngles);
-        angle.x            = resolveAnglePitch(data.original_angle.x, data, ent);
-        angle.y            = resolveAngleYaw(data.original_angle.y, data);
-        data.new_angle.x   = angle.x;
-        data.new_angle.y   = angle.y;
+            logging::Info("AAA: Brutenum for entity %i increased to %i", idx, resolver.brutenum[idx]);
+        hits_in_a_row = 0;
+        // Apply the next guess right away instead of waiting for the next update
+        updateSlot(idx);
+        auto &angle = CE_VECTOR(ent, netvar.m_angEyeAngles);
+        angle.x     = resolvedPitch(idx, resolver.networked_pitch[idx]);
+        angle.y     = resolvedYaw(idx, resolver.networked_yaw[idx]);
     }
 }
 
+void reset()
+{
+    resolver = {};
+}
+
 static void pitchHook(const CRecvProxyData *pData, void *pStruct, void *pOut)
 {
     float flPitch      = pData->m_Value.m_Float;
     float *flPitch_out = (float *) pOut;
+    int idx            = ((IClientEntity *) pStruct)->entindex();
 
-    if (!enable)
+    if (!enable || idx <= 0 || idx >= PLAYER_ARRAY_SIZE)
     {
         *flPitch_out = flPitch;
         return;
     }
-
-    auto client_ent   = (IClientEntity *) (pStruct);
-    CachedEntity *ent = ENTITY(client_ent->entindex());
-    if (CE_GOOD(ent))
-        *flPitch_out = resolveAnglePitch(flPitch, resolver_map[ent->player_info.friendsID], ent);
+    resolver.networked_pitch[idx] = flPitch;
+    *flPitch_out                  = resolvedPitch(idx, flPitch);
 }
 
 static void yawHook(const CRecvProxyData *pData, void *pStruct, void *pOut)
 {
     float flYaw      = pData->m_Value.m_Float;
     float *flYaw_out = (float *) pOut;
+    int idx          = ((IClientEntity *) pStruct)->entindex();
 
-    if (!enable)
+    if (!enable || idx <= 0 || idx >= PLAYER_ARRAY_SIZE)
     {
         *flYaw_out = flYaw;
         return;
     }
-
-    auto client_ent   = (IClientEntity *) (pStruct);
-    CachedEntity *ent = ENTITY(client_ent->entindex());
-    if (CE_GOOD(ent))
-        *flYaw_out = resolveAngleYaw(flYaw, resolver_map[ent->player_info.friendsID]);
+    resolver.networked_yaw[idx] = flYaw;
+    *flYaw_out                  = resolvedYaw(idx, flYaw);
 }
 
 // *_ptr points to what we need to modify while *_ProxyFn holds the old value
@@ -8,11 +8,8 @@
 #include <settings/Bool.hpp>
 #include "common.hpp"
 #include "hack.hpp"
+#include "AutoBackstab.hpp"
 
-namespace hacks::tf2::autobackstab
-{
-extern bool angleCheck(CachedEntity *from, CachedEntity *to, std::optional<Vector> target_pos, Vector from_angle);
-}
 namespace hacks::tf2::antibackstab
 {
 static settings::Boolean enable{ "antibackstab.enable", "0" };
@@ -20,6 +17,9 @@ static settings::Float distance{ "antibackstab.distance", "200" };
 static settings::Boolean sayno{ "antibackstab.nope", "0" };
 bool noaa = false;
 
+// Same kernel autobackstab uses, with every threat as the attacker and us as the victim
+static autobackstab::stab_candidates_s threats;
+
 void SayNope()
 {
     static float last_say = 0.0f;
@@ -52,14 +52,13 @@ float GetAngle(CachedEntity *spy)
     return anglediff;
 }
 
-CachedEntity *ClosestSpy()
+// can_stab is true if the threat is behind and facing us, or is a heavy that kills from any side
+CachedEntity *ClosestSpy(bool &can_stab)
 {
-    CachedEntity *closest, *ent;
-    float closest_dist, dist;
-
-    closest      = nullptr;
-    closest_dist = 0.0f;
+    CachedEntity *ent;
+    Vector victim_forward = autobackstab::FlatForward(CE_VECTOR(LOCAL_E, netvar.m_angEyeAngles).y);
 
+    threats.Clear();
     for (int i = 1; i < PLAYER_ARRAY_SIZE && i < g_IEntityList->GetHighestEntityIndex(); i++)
     {
         ent = ENTITY(i);
@@ -90,39 +89,37 @@ CachedEntity *ClosestSpy()
             continue;
         if (IsPlayerInvisible(ent))
             continue;
-        dist = ent->m_flDistance();
         if ((ispyro && !isheavy && fabs(GetAngle(ent)) > 90.0f) || (isheavy && fabs(GetAngle(ent)) > 132.0f))
         {
             break;
             // logging::Info("Backstab???");
         }
-        if ((((!ispyro && dist < (float) distance)) || (ispyro && !isheavy && dist < 314.0f) || (isheavy && dist < 120.0f)) && (dist < closest_dist || !closest_dist))
-        {
-            closest_dist = dist;
-            closest      = ent;
-        }
+        float range = isheavy ? 120.0f : ispyro ? 314.0f : (float) distance;
+        threats.Add(LOCAL_E->m_vecOrigin() - ent->m_vecOrigin(), autobackstab::FlatForward(CE_VECTOR(ent, netvar.m_angEyeAngles).y), victim_forward, range, isheavy, i);
     }
-    return closest;
+    threats.Evaluate();
+
+    int best = threats.PopBest(false);
+    if (best == -1)
+        return nullptr;
+    can_stab = threats.stab[best];
+    return ENTITY(threats.entity[best]);
 }
 
 void CreateMove()
 {
     CachedEntity *spy;
-    Vector diff;
+    bool couldbebackstabbed = false;
 
     if (!enable || CE_BAD(LOCAL_E))
         return;
-    spy = ClosestSpy();
+    spy = ClosestSpy(couldbebackstabbed);
     if (spy)
     {
         noaa = true;
         if (current_user_cmd->buttons & IN_ATTACK)
             return;
-        Vector spy_angle;
-        spy_angle = CE_VECTOR(spy, netvar.m_angEyeAngles);
-        fClampAngle(spy_angle);
-        bool couldbebackstabbed = hacks::tf2::autobackstab::angleCheck(spy, LOCAL_E, std::nullopt, spy_angle);
-        if (couldbebackstabbed || CE_INT(spy, netvar.iClass) == tf_class::tf_heavy)
+        if (couldbebackstabbed)
             current_user_cmd->viewangles.x = 150.0f;
         g_pLocalPlayer->bUseSilentAngles = true;
         if (sayno)
@@ -8,11 +8,14 @@
 #include <hacks/ac/aimbot.hpp>
 #include <hacks/ac/antiaim.hpp>
 #include <hacks/ac/bhop.hpp>
+#include <hacks/ac/pipeline.hpp>
 #include <settings/Bool.hpp>
 #include "common.hpp"
 #include "PlayerTools.hpp"
 #include "hack.hpp"
 #include "angles.hpp"
+#include <atomic>
+#include <thread>
 
 namespace hacks::shared::anticheat
 {
@@ -21,12 +24,65 @@ static settings::Boolean accuse_chat{ "find-cheaters.accuse-in-chat", "0" };
 static settings::Boolean autorage{ "find-cheaters.auto-rage", "0" };
 static settings::Boolean skip_local{ "find-cheaters.ignore-local", "1" };
 
+// Single producer, single consumer
+template <typename T, size_t N> struct ring_s
+{
+    T items[N];
+    std::atomic<size_t> head{ 0 };
+    std::atomic<size_t> tail{ 0 };
+
+    // Producer side, nullptr while the ring is full
+    T *Claim()
+    {
+        size_t at = head.load(std::memory_order_relaxed);
+        return at - tail.load(std::memory_order_acquire) == N ? nullptr : &items[at % N];
+    }
+    void Commit()
+    {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    // Consumer side, nullptr while the ring is empty
+    T *Peek()
+    {
+        size_t at = tail.load(std::memory_order_relaxed);
+        return at == head.load(std::memory_order_acquire) ? nullptr : &items[at % N];
+    }
+    void Pop()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+struct verdict_s
+{
+    int idx;
+    bool rage;
+    const char *hack;
+    char details[192];
+};
+
+static ring_s<ac::tick_s, 32> ticks;
+static ring_s<verdict_s, 64> verdicts;
+static std::thread detector;
+static std::atomic<bool> stop{ false };
+static std::atomic<uint64_t> dropped_ticks{ 0 };
+static std::atomic<uint64_t> dropped_verdicts{ 0 };
+
+// Lands in the next tick that makes it into the ring
+static uint64_t pending_reset  = 0;
+static bool pending_reset_all  = false;
+static int pending_hit_count   = 0;
+static ac::hit_s pending_hits[16];
+
 void Accuse(int eid, const std::string &hack, const std::string &details)
 {
     player_info_s info;
+    CachedEntity *ent = ENTITY(eid);
+    // Verdicts come in a few ticks late, they might be gone already
+    if (CE_BAD(ent))
+        return;
     if (g_IEngine->GetPlayerInfo(eid, &info))
     {
-        CachedEntity *ent = ENTITY(eid);
         if (accuse_chat)
         {
             hack::command_stack().push(format("say \"", info.name, " (", classname(CE_INT(ent, netvar.iClass)), ") suspected ", hack, ": ", details, "\""));
@@ -46,88 +102,271 @@ void SetRage(player_info_t info)
         playerlist::ChangeState(info.friendsID, playerlist::k_EState::RAGE);
 }
 
-void CreateMove()
+static void Post(int idx, bool rage, const char *hack, const std::string &details)
 {
-    if (!enable)
+    verdict_s *verdict = verdicts.Claim();
+    if (!verdict)
+    {
+        dropped_verdicts++;
         return;
-    angles::Update();
-    ac::aimbot::player_orgs().clear();
-    for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
+    }
+    verdict->idx  = idx;
+    verdict->rage = rage;
+    verdict->hack = hack;
+    strncpy(verdict->details, details.c_str(), sizeof(verdict->details) - 1);
+    verdict->details[sizeof(verdict->details) - 1] = 0;
+    verdicts.Commit();
+}
+
+static std::vector<ac::detector_s> &Detectors()
+{
+    static std::vector<ac::detector_s> detectors;
+    return detectors;
+}
+
+// What the extractors remember between ticks, detector thread only
+struct extractor_state_s
+{
+    bool present;
+    bool on_ground;
+    int ground_ticks;
+    Vector origin;
+};
+static extractor_state_s extractors[PLAYER_ARRAY_SIZE]{};
+
+static void Extract(int idx, const ac::player_s &player, uint32_t wanted, ac::features_s &out)
+{
+    auto &state  = extractors[idx];
+    out.angles   = &angles::data_idx(idx);
+    out.velocity = {};
+    out.speed    = 0.0f;
+    out.landed   = false;
+    out.jumped   = false;
+    if (wanted & ac::feature_velocity && state.present)
     {
-        if (skip_local && (i == g_IEngine->GetLocalPlayer()))
-            continue;
-        CachedEntity *ent = ENTITY(i);
-        if (CE_GOOD(ent))
+        out.velocity = player.origin - state.origin;
+        out.speed    = out.velocity.Length();
+    }
+    if (wanted & ac::feature_ground)
+    {
+        bool was_on_ground = state.present && state.on_ground;
+        out.landed         = player.on_ground && !was_on_ground;
+        out.jumped         = !player.on_ground && was_on_ground;
+        if (player.on_ground)
+            state.ground_ticks = out.landed ? 1 : state.ground_ticks + 1;
+        // Still the count from before the jump on the tick they jumped
+        out.ground_ticks = state.ground_ticks;
+        if (!player.on_ground)
+            state.ground_ticks = 0;
+    }
+    state.present   = true;
+    state.on_ground = player.on_ground;
+    state.origin    = player.origin;
+}
+
+static void Process(const ac::tick_s &tick)
+{
+    auto &detectors = Detectors();
+    if (tick.reset_all)
+    {
+        for (auto &state : extractors)
+            state = extractor_state_s{};
+        for (auto &detector : detectors)
+            if (detector.reset_all)
+                detector.reset_all();
+    }
+    for (int i = 1; i < PLAYER_ARRAY_SIZE; i++)
+        if (tick.reset & (1ull << i))
+        {
+            extractors[i] = extractor_state_s{};
+            for (auto &detector : detectors)
+                if (detector.reset_player)
+                    detector.reset_player(i);
+        }
+    // Hits are compared against where everyone was last tick
+    for (auto &detector : detectors)
+    {
+        if (detector.hit)
+            for (int i = 0; i < tick.hit_count; i++)
+                detector.hit(tick.hits[i]);
+        if (detector.begin_tick)
+            detector.begin_tick();
+    }
+    // Only extract what some detector is going to look at
+    uint32_t wanted = 0;
+    for (auto &detector : detectors)
+        wanted |= detector.features;
+    for (int i = 1; i < PLAYER_ARRAY_SIZE; i++)
+    {
+        auto &player = tick.players[i];
+        angles::Update(i, player.present, player.angles);
+        if (!player.present)
         {
-            if (ent->m_bAlivePlayer())
-            {
-                if (player_tools::shouldTarget(ent) || ent == LOCAL_E)
-                {
-                    ac::aimbot::Update(ent);
-                    ac::antiaim::Update(ent);
-                    ac::bhop::Update(ent);
-                }
-            }
+            extractors[i].present = false;
+            continue;
         }
+        ac::features_s features;
+        Extract(i, player, wanted, features);
+        if (!player.check)
+            continue;
+        ac::frame_s frame{ tick, player, features };
+        for (auto &detector : detectors)
+            detector.update(i, frame);
     }
 }
 
-void ResetPlayer(int index)
+static void Run()
 {
-    ac::aimbot::ResetPlayer(index);
-    ac::antiaim::ResetPlayer(index);
-    ac::bhop::ResetPlayer(index);
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        ac::tick_s *tick = ticks.Peek();
+        if (!tick)
+        {
+            // Ticks come every 15ms, no point in waking the game thread up for this
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        Process(*tick);
+        ticks.Pop();
+    }
 }
 
-void ResetEverything()
+static void Publish()
 {
-    ac::aimbot::ResetEverything();
-    ac::antiaim::ResetEverything();
-    ac::bhop::ResetEverything();
+    ac::tick_s *tick = ticks.Claim();
+    if (!tick)
+    {
+        dropped_ticks++;
+        return;
+    }
+    tick->tickcount   = tickcount;
+    tick->reset       = pending_reset;
+    tick->reset_all   = pending_reset_all;
+    tick->hit_count   = pending_hit_count;
+    std::copy(pending_hits, pending_hits + pending_hit_count, tick->hits);
+    pending_reset     = 0;
+    pending_reset_all = false;
+    pending_hit_count = 0;
+
+    int max_clients = g_IEngine->GetMaxClients();
+    int local       = g_IEngine->GetLocalPlayer();
+    for (int i = 1; i < PLAYER_ARRAY_SIZE; i++)
+    {
+        auto &player      = tick->players[i];
+        CachedEntity *ent = ENTITY(i);
+        player.present    = i <= max_clients && CE_GOOD(ent) && !CE_BYTE(ent, netvar.iLifeState);
+        player.check      = false;
+        if (!player.present)
+            continue;
+        player.angles       = i == local ? current_user_cmd->viewangles : CE_VECTOR(ent, netvar.m_angEyeAngles);
+        player.check        = !(skip_local && i == local) && ent->m_bAlivePlayer() && (player_tools::shouldTarget(ent) || ent == LOCAL_E);
+        player.origin       = ent->m_vecOrigin();
+        player.on_ground    = CE_INT(ent, netvar.iFlags) & FL_ONGROUND;
+        player.conditions   = Conditions(ent);
+        CachedEntity *wep   = ENTITY(CE_INT(ent, netvar.hActiveWeapon) & 0xFFF);
+        player.weapon_class = CE_GOOD(wep) ? wep->m_iClassID() : -1;
+        player.weapon_name  = CE_GOOD(wep) ? RAW_ENT(wep)->GetClientClass()->GetName() : "[unknown]";
+    }
+    ticks.Commit();
 }
 
-class ACListener : public IGameEventListener
+static void Drain()
 {
-public:
-    virtual void FireGameEvent(KeyValues *event)
+    while (verdict_s *verdict = verdicts.Peek())
     {
-        if (!enable)
-            return;
-        std::string name(event->GetName());
-        if (name == "player_activate")
+        player_info_s info;
+        if (verdict->rage)
         {
-            int uid    = event->GetInt("userid");
-            int entity = g_IEngine->GetPlayerForUserID(uid);
-            ResetPlayer(entity);
-        }
-        else if (name == "player_disconnect")
-        {
-            int uid    = event->GetInt("userid");
-            int entity = g_IEngine->GetPlayerForUserID(uid);
-            ResetPlayer(entity);
+            if (g_IEngine->GetPlayerInfo(verdict->idx, &info))
+                SetRage(info);
         }
+        else
+            Accuse(verdict->idx, verdict->hack, verdict->details);
+        verdicts.Pop();
+    }
+}
 
-        ac::aimbot::Event(event);
+void CreateMove()
+{
+    if (!enable)
+        return;
+    if (!detector.joinable())
+    {
+        stop     = false;
+        detector = std::thread(Run);
     }
-};
+    Drain();
+    Publish();
+}
+
+void ResetPlayer(int index)
+{
+    if (index > 0 && index < PLAYER_ARRAY_SIZE)
+        pending_reset |= 1ull << index;
+}
+
+void ResetEverything()
+{
+    pending_reset_all = true;
+    pending_hit_count = 0;
+}
 
-ACListener listener;
+static void OnPlayerChanged(const game_events::event_s &event)
+{
+    if (enable && event.player)
+        ResetPlayer(event.player);
+}
+
+static void OnHit(const game_events::event_s &event)
+{
+    if (!enable || pending_hit_count == int(std::size(pending_hits)))
+        return;
+    int attacker = event.death ? event.death->attacker : event.hurt->attacker;
+    int weaponid = event.death ? event.death->weaponid : event.hurt->weaponid;
+    pending_hits[pending_hit_count++] = { attacker, event.player, weaponid };
+}
 
 void Init()
 {
-    g_IGameEventManager->AddListener(&listener, false);
+    game_events::Subscribe("player_activate", OnPlayerChanged);
+    game_events::Subscribe("player_disconnect", OnPlayerChanged);
+    game_events::Subscribe("player_death", OnHit);
+    game_events::Subscribe("player_hurt", OnHit);
 }
 
 void Shutdown()
 {
-    g_IGameEventManager->RemoveListener(&listener);
+    if (!detector.joinable())
+        return;
+    stop = true;
+    detector.join();
 }
 
+static CatCommand print_stats("ac_stats", "Show detector pipeline counters", []() { logging::Info("%zu ticks queued, %llu ticks dropped, %llu verdicts dropped", ticks.head.load() - ticks.tail.load(), (unsigned long long) dropped_ticks.load(), (unsigned long long) dropped_verdicts.load()); });
+
 static InitRoutine EC([]() {
-    EC::Register(EC::CreateMove, CreateMove, "cm_AntiCheat", EC::average);
+    EC::Register(EC::CreateMove, CreateMove, "cm_AntiCheat", enable, EC::average);
     EC::Register(EC::LevelInit, ResetEverything, "init_AntiCheat", EC::average);
     EC::Register(EC::LevelShutdown, ResetEverything, "reset_AntiCheat", EC::average);
     EC::Register(EC::Shutdown, Shutdown, "shutdown_AntiCheat", EC::average);
     Init();
 });
 } // namespace hacks::shared::anticheat
+
+namespace ac
+{
+void Register(const detector_s &detector)
+{
+    hacks::shared::anticheat::Detectors().push_back(detector);
+}
+
+void Accuse(int idx, const char *hack, const std::string &details)
+{
+    hacks::shared::anticheat::Post(idx, false, hack, details);
+}
+
+void Rage(int idx)
+{
+    hacks::shared::anticheat::Post(idx, true, nullptr, "");
+}
+} // namespace ac
@@ -9,6 +9,10 @@
 #include "PlayerTools.hpp"
 #include "Trigger.hpp"
 #include "Backtrack.hpp"
+#include "AutoBackstab.hpp"
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 
 namespace hacks::tf2::autobackstab
 {
@@ -34,13 +38,13 @@ int ClosestDistanceHitbox(CachedEntity *target)
     }
     return closest;
 }
-int ClosestDistanceHitbox(hacks::tf2::backtrack::BacktrackData btd)
+int ClosestDistanceHitbox(const hacks::tf2::backtrack::BacktrackData &btd)
 {
     int closest        = -1;
     float closest_dist = FLT_MAX, dist = 0.0f;
     for (int i = pelvis; i < spine_3; i++)
     {
-        dist = g_pLocalPlayer->v_Eye.DistTo(btd.hitboxes.at(i).center);
+        dist = g_pLocalPlayer->v_Eye.DistTo(btd.hitbox(i).center);
         if (dist < closest_dist)
         {
             closest      = i;
@@ -55,35 +59,107 @@ bool canFaceStab(CachedEntity *ent)
     return ent->m_iHealth() <= 40.0f;
 }
 
-bool angleCheck(CachedEntity *from, CachedEntity *to, std::optional<Vector> target_pos, Vector from_angle)
+Vector FlatForward(float yaw)
 {
-    Vector tarAngle = CE_VECTOR(to, netvar.m_angEyeAngles);
+    float rad = DEG2RAD(yaw);
+    return Vector(std::cos(rad), std::sin(rad), 0.0f);
+}
 
-    Vector vecToTarget;
-    if (target_pos)
-        vecToTarget = *target_pos - from->m_vecOrigin();
-    else
-        vecToTarget = to->m_vecOrigin() - from->m_vecOrigin();
-    vecToTarget.z = 0;
-    vecToTarget.NormalizeInPlace();
+bool stab_candidates_s::Add(const Vector &delta, const Vector &attacker_forward, const Vector &victim_forward, float max_distance, bool can_facestab, int entity_idx, const backtrack::BacktrackData *from_tick)
+{
+    if (count >= MAX)
+        return false;
+    int i         = count++;
+    dx[i]         = delta.x;
+    dy[i]         = delta.y;
+    dz[i]         = delta.z;
+    attacker_x[i] = attacker_forward.x;
+    attacker_y[i] = attacker_forward.y;
+    victim_x[i]   = victim_forward.x;
+    victim_y[i]   = victim_forward.y;
+    max_sq[i]     = max_distance * max_distance;
+    facestab[i]   = can_facestab ? 1.0f : 0.0f;
+    entity[i]     = entity_idx;
+    tick[i]       = from_tick;
+    return true;
+}
 
-    Vector vecOwnerForward;
-    AngleVectors2(VectorToQAngle(from_angle), &vecOwnerForward);
-    vecOwnerForward.z = 0;
-    vecOwnerForward.NormalizeInPlace();
+// Same checks as angleCheck. Comparing against the unnormalized delta leaves out every square root:
+// behind is dot(delta, victim) > 0, facing is dot(delta, attacker) > 0.5 * |delta|
+void stab_candidates_s::Evaluate()
+{
+    int padded = (count + 3) & ~3;
+    for (int i = count; i < padded; i++)
+    {
+        dx[i] = dy[i] = dz[i] = 0.0f;
+        attacker_x[i] = attacker_y[i] = victim_x[i] = victim_y[i] = 0.0f;
+        facestab[i] = 0.0f;
+        max_sq[i]   = -1.0f;
+    }
+#if defined(__SSE__)
+    for (int i = 0; i < padded; i += 4)
+    {
+        __m128 x        = _mm_load_ps(&dx[i]);
+        __m128 y        = _mm_load_ps(&dy[i]);
+        __m128 z        = _mm_load_ps(&dz[i]);
+        __m128 ax       = _mm_load_ps(&attacker_x[i]);
+        __m128 ay       = _mm_load_ps(&attacker_y[i]);
+        __m128 vx       = _mm_load_ps(&victim_x[i]);
+        __m128 vy       = _mm_load_ps(&victim_y[i]);
+        __m128 flat     = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+        __m128 dist     = _mm_add_ps(flat, _mm_mul_ps(z, z));
+        __m128 in_range = _mm_cmple_ps(dist, _mm_load_ps(&max_sq[i]));
+
+        __m128 behind = _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(x, vx), _mm_mul_ps(y, vy)), _mm_setzero_ps());
+        __m128 facing = _mm_add_ps(_mm_mul_ps(x, ax), _mm_mul_ps(y, ay));
+        facing        = _mm_and_ps(_mm_cmpgt_ps(facing, _mm_setzero_ps()), _mm_cmpgt_ps(_mm_mul_ps(facing, facing), _mm_mul_ps(flat, _mm_set1_ps(0.25f))));
+        __m128 view   = _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(ax, vx), _mm_mul_ps(ay, vy)), _mm_set1_ps(-0.3f));
+        __m128 angles = _mm_and_ps(behind, _mm_and_ps(facing, view));
+        __m128 can    = _mm_and_ps(in_range, _mm_or_ps(angles, _mm_cmpneq_ps(_mm_load_ps(&facestab[i]), _mm_setzero_ps())));
+
+        _mm_store_ps(&score[i], _mm_or_ps(_mm_and_ps(in_range, dist), _mm_andnot_ps(in_range, _mm_set1_ps(FLT_MAX))));
+        int mask = _mm_movemask_ps(can);
+        for (int j = 0; j < 4; j++)
+            stab[i + j] = mask & (1 << j);
+    }
+#else
+    for (int i = 0; i < padded; i++)
+    {
+        float flat    = dx[i] * dx[i] + dy[i] * dy[i];
+        float dist    = flat + dz[i] * dz[i];
+        bool in_range = dist <= max_sq[i];
+        bool behind   = dx[i] * victim_x[i] + dy[i] * victim_y[i] > 0.0f;
+        float facing  = dx[i] * attacker_x[i] + dy[i] * attacker_y[i];
+        bool view     = attacker_x[i] * victim_x[i] + attacker_y[i] * victim_y[i] > -0.3f;
+        bool angles   = behind && facing > 0.0f && facing * facing > 0.25f * flat && view;
+        score[i]      = in_range ? dist : FLT_MAX;
+        stab[i]       = in_range && (angles || facestab[i] != 0.0f);
+    }
+#endif
+}
 
-    Vector vecTargetForward;
-    AngleVectors2(VectorToQAngle(tarAngle), &vecTargetForward);
-    vecTargetForward.z = 0;
-    vecTargetForward.NormalizeInPlace();
+int stab_candidates_s::PopBest(bool stab_only)
+{
+    int best         = -1;
+    float best_score = FLT_MAX;
+    for (int i = 0; i < count; i++)
+        if (score[i] < best_score && (!stab_only || stab[i]))
+        {
+            best       = i;
+            best_score = score[i];
+        }
+    if (best != -1)
+        score[best] = FLT_MAX;
+    return best;
+}
 
-    if (DotProduct(vecToTarget, vecTargetForward) <= 0.0f)
-        return false;
-    if (DotProduct(vecToTarget, vecOwnerForward) <= 0.5f)
-        return false;
-    if (DotProduct(vecOwnerForward, vecTargetForward) <= -0.3f)
-        return false;
-    return true;
+static stab_candidates_s candidates;
+
+static Vector WorldSpaceCenter(CachedEntity *ent)
+{
+    Vector center;
+    VectorLerp(RAW_ENT(ent)->GetCollideable()->OBBMins(), RAW_ENT(ent)->GetCollideable()->OBBMaxs(), 0.5f, center);
+    return center + ent->m_vecOrigin();
 }
 
 static bool angleCheck(CachedEntity *target, std::optional<Vector> target_pos, Vector local_angle)
@@ -155,6 +231,8 @@ static bool doRageBackstab()
     float swingrange = re::C_TFWeaponBaseMelee::GetSwingRange(RAW_ENT(LOCAL_W));
     // AimAt Autobackstab
     {
+        candidates.Clear();
+        Vector local_worldspace = WorldSpaceCenter(LOCAL_E);
         for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
         {
             auto ent = ENTITY(i);
@@ -165,15 +243,26 @@ static bool doRageBackstab()
             auto hitbox = ClosestDistanceHitbox(ent);
             if (hitbox == -1)
                 continue;
-            auto angle = GetAimAtAngles(g_pLocalPlayer->v_Eye, ent->hitboxes.GetHitbox(hitbox)->center, LOCAL_E);
-            if (!angleCheck(ent, std::nullopt, angle) && !canFaceStab(ent))
-                continue;
+            // Aiming at the hitbox, so we face along the line from our eyes to it
+            Vector aim = ent->hitboxes.GetHitbox(hitbox)->center - g_pLocalPlayer->v_Eye;
+            aim.z      = 0.0f;
+            aim.NormalizeInPlace();
+            candidates.Add(WorldSpaceCenter(ent) - local_worldspace, aim, FlatForward(CE_VECTOR(ent, netvar.m_angEyeAngles).y), swingrange * 4, canFaceStab(ent), i);
+        }
+        candidates.Evaluate();
+
+        int best;
+        while ((best = candidates.PopBest(true)) != -1)
+        {
+            auto ent    = ENTITY(candidates.entity[best]);
+            auto hitbox = ClosestDistanceHitbox(ent);
+            auto angle  = GetAimAtAngles(g_pLocalPlayer->v_Eye, ent->hitboxes.GetHitbox(hitbox)->center, LOCAL_E);
 
             trace_t trace;
             Ray_t ray;
             trace::filter_default.SetSelf(RAW_ENT(g_pLocalPlayer->entity));
             ray.Init(g_pLocalPlayer->v_Eye, GetForwardVector(g_pLocalPlayer->v_Eye, angle, swingrange, LOCAL_E));
-            g_ITrace->TraceRay(ray, MASK_SOLID, &trace::filter_default, &trace);
+            trace::TraceRay(ray, MASK_SOLID, &trace::filter_default, &trace);
             if (trace.m_pEnt)
             {
                 int index = reinterpret_cast<IClientEntity *>(trace.m_pEnt)->entindex();
@@ -199,7 +288,7 @@ static bool doRageBackstab()
             Ray_t ray;
             trace::filter_default.SetSelf(RAW_ENT(g_pLocalPlayer->entity));
             ray.Init(g_pLocalPlayer->v_Eye, GetForwardVector(g_pLocalPlayer->v_Eye, newangle, swingrange, LOCAL_E));
-            g_ITrace->TraceRay(ray, MASK_SOLID, &trace::filter_default, &trace);
+            trace::TraceRay(ray, MASK_SOLID, &trace::filter_default, &trace);
             if (trace.m_pEnt)
             {
                 int index = reinterpret_cast<IClientEntity *>(trace.m_pEnt)->entindex();
@@ -224,79 +313,65 @@ static bool doRageBackstab()
     }
     return false;
 }
-// Make accessible to the filter
-static bool legit_stab = false;
-static Vector newangle_apply;
-
-bool backtrackFilter(CachedEntity *ent, hacks::tf2::backtrack::BacktrackData tick, std::optional<hacks::tf2::backtrack::BacktrackData> &best_tick)
-{
-    float swingrange = re::C_TFWeaponBaseMelee::GetSwingRange(RAW_ENT(LOCAL_W));
-
-    Vector target_worldspace;
-    VectorLerp(tick.m_vecMins, tick.m_vecMaxs, 0.5f, target_worldspace);
-    target_worldspace += tick.m_vecOrigin;
-    Vector distcheck = target_worldspace;
-    distcheck.z      = g_pLocalPlayer->v_Eye.z;
-
-    // Angle check
-    Vector newangle;
-    if (legit_stab)
-        newangle = g_pLocalPlayer->v_OrigViewangles;
-    else
-        newangle = GetAimAtAngles(g_pLocalPlayer->v_Eye, distcheck, LOCAL_E);
-    if (!angleCheck(ent, target_worldspace, newangle) && !canFaceStab(ent))
-        return false;
-
-    Vector min = tick.m_vecMins + tick.m_vecOrigin;
-    Vector max = tick.m_vecMaxs + tick.m_vecOrigin;
-    Vector hit;
-
-    // Check if we can hit the enemies hitbox
-    if (hacks::shared::triggerbot::CheckLineBox(min, max, g_pLocalPlayer->v_Eye, GetForwardVector(g_pLocalPlayer->v_Eye, newangle, swingrange * 0.95f), hit))
-    {
-        // Check if this tick is closer
-        if (!best_tick || (*best_tick).m_vecOrigin.DistTo(LOCAL_E->m_vecOrigin()) > tick.m_vecOrigin.DistTo(LOCAL_E->m_vecOrigin()))
-        {
-            newangle_apply = newangle;
-            return true;
-        }
-    }
-
-    return false;
-}
-
 static bool doBacktrackStab(bool legit = false)
 {
-    CachedEntity *stab_ent = nullptr;
-    hacks::tf2::backtrack::BacktrackData stab_data;
-    // Set for our filter
-    legit_stab = legit;
-    // Get the Best tick
+    float swingrange        = re::C_TFWeaponBaseMelee::GetSwingRange(RAW_ENT(LOCAL_W));
+    Vector local_worldspace = WorldSpaceCenter(LOCAL_E);
+    Vector legit_forward    = FlatForward(g_pLocalPlayer->v_OrigViewangles.y);
+
+    // Every usable tick of every target in one pass
+    candidates.Clear();
     for (int i = 0; i <= g_IEngine->GetMaxClients(); i++)
     {
         CachedEntity *ent = ENTITY(i);
         // Targeting checks
         if (CE_BAD(ent) || !ent->m_bAlivePlayer() || !ent->m_bEnemy() || !player_tools::shouldTarget(ent) || IsPlayerInvulnerable(ent))
             continue;
-
-        // Get the best tick for that ent
-        auto tick_data = hacks::tf2::backtrack::getBestTick(ent, backtrackFilter);
-
-        // We found something matching the criterias, break out
-        if (tick_data)
+        Vector victim_forward = FlatForward(CE_VECTOR(ent, netvar.m_angEyeAngles).y);
+        bool facestab         = canFaceStab(ent);
+        for (auto &tick : hacks::tf2::backtrack::getGoodTicks(i))
         {
-            stab_data = *tick_data;
-            stab_ent  = ent;
-            break;
+            Vector target_worldspace;
+            VectorLerp(tick.m_vecMins, tick.m_vecMaxs, 0.5f, target_worldspace);
+            target_worldspace += tick.m_vecOrigin;
+            Vector delta = target_worldspace - local_worldspace;
+            // The range is from our eyes, the swing can connect anywhere on the hull
+            delta.z      = target_worldspace.z - g_pLocalPlayer->v_Eye.z;
+            Vector aim   = legit_forward;
+            if (!legit)
+            {
+                aim   = target_worldspace - g_pLocalPlayer->v_Eye;
+                aim.z = 0.0f;
+                aim.NormalizeInPlace();
+            }
+            float reach = swingrange * 0.95f + (tick.m_vecMaxs - tick.m_vecMins).Length() * 0.5f;
+            if (!candidates.Add(delta, aim, victim_forward, reach, facestab, i, &tick))
+                break;
         }
     }
+    candidates.Evaluate();
 
-    // We found a good ent
-    if (stab_ent)
+    // Closest first, only a tick whose hull the swing actually reaches counts
+    int best;
+    while ((best = candidates.PopBest(true)) != -1)
     {
-        hacks::tf2::backtrack::SetBacktrackData(stab_ent, stab_data);
+        auto &tick = *candidates.tick[best];
+        Vector target_worldspace;
+        VectorLerp(tick.m_vecMins, tick.m_vecMaxs, 0.5f, target_worldspace);
+        target_worldspace += tick.m_vecOrigin;
+        Vector distcheck = target_worldspace;
+        distcheck.z      = g_pLocalPlayer->v_Eye.z;
+
+        Vector newangle = legit ? g_pLocalPlayer->v_OrigViewangles : GetAimAtAngles(g_pLocalPlayer->v_Eye, distcheck, LOCAL_E);
+        Vector min      = tick.m_vecMins + tick.m_vecOrigin;
+        Vector max      = tick.m_vecMaxs + tick.m_vecOrigin;
+        Vector hit;
+        if (!hacks::shared::triggerbot::CheckLineBox(min, max, g_pLocalPlayer->v_Eye, GetForwardVector(g_pLocalPlayer->v_Eye, newangle, swingrange * 0.95f), hit))
+            continue;
+
+        hacks::tf2::backtrack::SetBacktrackData(ENTITY(candidates.entity[best]), tick);
         current_user_cmd->buttons |= IN_ATTACK;
-        current_user_cmd->viewangles     = newangle_apply;
+        current_user_cmd->viewangles     = newangle;
         g_pLocalPlayer->bUseSilentAngles = true;
         *bSendPackets                    = true;
         return true;
@@ -356,5 +431,5 @@ void CreateMove()
     }
 }
 
-static InitRoutine EC([]() { EC::Register(EC::CreateMove, CreateMove, "autobackstab", EC::average); });
+static InitRoutine EC([]() { EC::Register(EC::CreateMove, CreateMove, "autobackstab", enabled, EC::average); });
 } // namespace hacks::tf2::autobackstab
@@ -54,27 +54,20 @@ static void CreateMove()
     else
         shouldm2 = false;
 
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
+    for (auto &proj : projectile_tracker::All())
     {
-        CachedEntity *ent = ENTITY(i);
-        if (CE_BAD(ent))
+        CachedEntity *ent = proj.entity;
+        if (proj.dormant)
             continue;
-        if (!IsProjectile(ent) && !ent->m_bGrenadeProjectile())
+        if (!IsProjectile(ent) && !proj.grenade)
             continue;
-        if (!ent->m_bEnemy())
+        if (!proj.enemy)
             continue;
-        if (ent->m_Type() != ENTITY_PROJECTILE)
-            continue;
-        Vector velocity;
-        if (velocity::EstimateAbsVelocity)
-            velocity::EstimateAbsVelocity(RAW_ENT(ent), velocity);
-        else
-            velocity = CE_VECTOR(ent, netvar.vVelocity);
-        if ((ent->m_vecOrigin() + velocity).DistTo(LOCAL_E->m_vecOrigin()) < (ent->m_vecOrigin()).DistTo(LOCAL_E->m_vecOrigin()))
+        if (proj.PositionAt(1.0f).DistTo(LOCAL_E->m_vecOrigin()) < proj.origin.DistTo(LOCAL_E->m_vecOrigin()))
             continue;
         if (!IsVectorVisible(g_pLocalPlayer->v_Eye, ent->m_vecOrigin()))
             continue;
-        if (ent->m_bCritProjectile() && ent->m_flDistance() <= 500.0f)
+        if (proj.crit && ent->m_flDistance() <= 500.0f)
         {
             shouldm2 = true;
             if (!CE_BYTE(LOCAL_E, netvar.m_bFeignDeathReady))
@@ -92,5 +85,5 @@ static void CreateMove()
     if (shouldm2 && CE_BYTE(LOCAL_E, netvar.m_bFeignDeathReady))
         current_user_cmd->buttons |= IN_ATTACK2;
 }
-static InitRoutine EC([]() { EC::Register(EC::CreateMove, CreateMove, "AutoDeadringer", EC::average); });
+static InitRoutine EC([]() { EC::Register(EC::CreateMove, CreateMove, "AutoDeadringer", enable, EC::average); });
 } // namespace hacks::shared::deadringer
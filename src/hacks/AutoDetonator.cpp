@@ -19,10 +19,11 @@ std::vector<CachedEntity *> flares;
 std::vector<CachedEntity *> targets;
 
 // Function to tell when an ent is the local players own flare
-bool IsFlare(CachedEntity *ent)
+bool IsFlare(const projectile_tracker::projectile_s &proj)
 {
+    CachedEntity *ent = proj.entity;
     // Check if ent is a flare
-    if (ent->m_iClassID() != CL_CLASS(CTFProjectile_Flare))
+    if (proj.dormant || proj.classid != CL_CLASS(CTFProjectile_Flare))
         return false;
 
     // Check if we're the owner of the flare
@@ -85,24 +86,19 @@ void CreateMove()
     targets.clear();
 
     // Cycle through the ents and search for valid ents
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
-    {
-        // Assign the for loops tick number to an ent
-        CachedEntity *ent = ENTITY(i);
-        // Check for dormancy and if valid
-        if (CE_BAD(ent))
-            continue;
-        // Check if ent is a flare or suitable target and push to respective
-        // arrays
-        if (IsFlare(ent))
-        {
-            flares.push_back(ent);
-        }
-        else if (IsTarget(ent))
+    for (auto &proj : projectile_tracker::All())
+        if (IsFlare(proj))
+            flares.push_back(proj.entity);
+    // Only players and buildings can be targets
+    for (auto type : { ENTITY_PLAYER, ENTITY_BUILDING })
+        for (CachedEntity *ent : entity_cache::OfType(type))
         {
-            targets.push_back(ent);
+            // Check for dormancy and if valid
+            if (CE_BAD(ent))
+                continue;
+            if (IsTarget(ent))
+                targets.push_back(ent);
         }
-    }
     for (auto flare : flares)
     {
         // Loop through every target
@@ -78,25 +78,31 @@ int vaccinator_change_timer = 0;
 std::array<Timer, PLAYER_ARRAY_SIZE> reset_cd{};
 std::vector<patient_data_s> data(PLAYER_ARRAY_SIZE);
 
-struct proj_data_s
-{
-    int eid;
-    Vector last_pos;
-};
-std::vector<proj_data_s> proj_data_array;
-
 int ChargeCount()
 {
     return (CE_FLOAT(LOCAL_W, netvar.m_flChargeLevel) / 0.25f);
 }
 
-// TODO Angle Checking
-int BulletDangerValue(CachedEntity *patient)
+// Enemies that can make a patient worth switching resistance for, gathered once per tick for every patient
+struct sniper_threat_s
 {
-    if (!vacc_sniper)
-        return 0;
-    bool any_zoomed_snipers = false;
-    // Find dangerous snipers in other team
+    CachedEntity *ent;
+    // Visible to us, the closest we get to knowing what they can see
+    bool visible;
+    bool rage;
+};
+struct pyro_threat_s
+{
+    CachedEntity *ent;
+    bool flamethrower;
+};
+static std::vector<sniper_threat_s> sniper_threats;
+static std::vector<pyro_threat_s> pyro_threats;
+
+void UpdateThreats()
+{
+    sniper_threats.clear();
+    pyro_threats.clear();
     for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
     {
         CachedEntity *ent = ENTITY(i);
@@ -104,34 +110,45 @@ int BulletDangerValue(CachedEntity *patient)
             continue;
         if (!ent->m_bAlivePlayer() || !ent->m_bEnemy())
             continue;
-        if (g_pPlayerResource->GetClass(ent) != tf_sniper)
-            continue;
-        if (!HasCondition<TFCond_Zoomed>(ent))
-            continue;
-        if (!player_tools::shouldTarget(ent))
-            continue;
-        any_zoomed_snipers = true;
-        if (*vacc_sniper == 2)
+        int clazz = g_pPlayerResource->GetClass(ent);
+        if (vacc_sniper && clazz == tf_sniper && HasCondition<TFCond_Zoomed>(ent))
         {
-            // If vacc_sniper == 2 ("Any zoomed") then return 2
-            // Why would you want this?????
-            return 2;
+            if (!player_tools::shouldTarget(ent))
+                continue;
+            // "Any zoomed" never needs the vischeck
+            bool visible = *vacc_sniper != 2 && IsEntityVisible(ent, head);
+            sniper_threats.push_back({ ent, visible, playerlist::AccessData(ent).state == playerlist::k_EState::RAGE });
         }
-        else
+        else if (auto_vacc_fire_checking && auto_vacc_pop_if_pyro && clazz == tf_pyro)
         {
-            if (IsEntityVisible(ent, head))
-            {
-                if (playerlist::AccessData(ent).state == playerlist::k_EState::RAGE)
-                    return 2;
-                else
-                {
-                    if (GetFov(ent->m_vecAngle(), ent->hitboxes.GetHitbox(head)->center, patient->hitboxes.GetHitbox(head)->center) < *vacc_sniper_fov)
-                        return 2;
-                }
-            }
+            if (!player_tools::shouldTarget(ent))
+                continue;
+            CachedEntity *weapon = ENTITY(HandleToIDX(CE_INT(ent, netvar.hActiveWeapon)));
+            pyro_threats.push_back({ ent, CE_GOOD(weapon) && weapon->m_iClassID() == CL_CLASS(CTFFlameThrower) });
         }
     }
-    return any_zoomed_snipers ? 1 : 0;
+}
+
+// TODO Angle Checking
+int BulletDangerValue(CachedEntity *patient)
+{
+    if (!vacc_sniper || sniper_threats.empty())
+        return 0;
+    // If vacc_sniper == 2 ("Any zoomed") then return 2
+    // Why would you want this?????
+    if (*vacc_sniper == 2)
+        return 2;
+    // Find dangerous snipers in other team
+    for (auto &sniper : sniper_threats)
+    {
+        if (!sniper.visible)
+            continue;
+        if (sniper.rage)
+            return 2;
+        if (GetFov(sniper.ent->m_vecAngle(), sniper.ent->hitboxes.GetHitbox(head)->center, patient->hitboxes.GetHitbox(head)->center) < *vacc_sniper_fov)
+            return 2;
+    }
+    return 1;
 }
 
 int FireDangerValue(CachedEntity *patient)
@@ -140,33 +157,18 @@ int FireDangerValue(CachedEntity *patient)
     if (!auto_vacc_fire_checking)
         return 0;
     uint8_t should_switch = 0;
-    if (auto_vacc_pop_if_pyro)
+    for (auto &pyro : pyro_threats)
     {
-        for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
+        if (patient->m_vecOrigin().DistTo(pyro.ent->m_vecOrigin()) > (int) auto_vacc_pyro_range)
+            continue;
+        if (*auto_vacc_pop_if_pyro == 2)
+            return 2;
+        if (pyro.flamethrower)
         {
-            CachedEntity *ent = ENTITY(i);
-            if (CE_BAD(ent))
-                continue;
-            if (!ent->m_bEnemy())
-                continue;
-            if (!ent->m_bAlivePlayer())
-                continue;
-            if (!player_tools::shouldTarget(ent))
-                continue;
-            if (g_pPlayerResource->GetClass(ent) != tf_pyro)
-                continue;
-            if (patient->m_vecOrigin().DistTo(ent->m_vecOrigin()) > (int) auto_vacc_pyro_range)
-                continue;
-            if (*auto_vacc_pop_if_pyro == 2)
+            if (HasCondition<TFCond_OnFire>(patient))
                 return 2;
-            CachedEntity *weapon = ENTITY(HandleToIDX(CE_INT(ent, netvar.hActiveWeapon)));
-            if (CE_GOOD(weapon) && weapon->m_iClassID() == CL_CLASS(CTFFlameThrower))
-            {
-                if (HasCondition<TFCond_OnFire>(patient))
-                    return 2;
-                else
-                    should_switch = 1;
-            }
+            else
+                should_switch = 1;
         }
     }
     if (*auto_vacc_check_on_fire && HasCondition<TFCond_OnFire>(patient))
@@ -186,25 +188,20 @@ int BlastDangerValue(CachedEntity *patient)
     // Check rockets for being closer
     bool hasCritRockets = false;
     bool hasRockets     = false;
-    for (auto it = proj_data_array.begin(); it != proj_data_array.end();)
+    for (auto &proj : projectile_tracker::All())
     {
-        const auto &d     = *it;
-        CachedEntity *ent = ENTITY(d.eid);
-        if (CE_GOOD(ent))
-        {
-            // Rocket is getting closer
-            if (patient->m_vecOrigin().DistToSqr(d.last_pos) > patient->m_vecOrigin().DistToSqr(ent->m_vecOrigin()))
-            {
-                if (ent->m_bCritProjectile())
-                    hasCritRockets = true;
-                hasRockets = true;
-            }
-            it++;
-        }
-        else
-        {
-            proj_data_array.erase(it);
-        }
+        if (proj.dormant || !proj.enemy)
+            continue;
+        if (proj.classid == CL_CLASS(CTFProjectile_Flare))
+            continue;
+        if (patient->m_vecOrigin().DistTo(proj.origin) > (int) auto_vacc_proj_danger_range)
+            continue;
+        // Rocket is getting closer
+        if (proj.TimeToClosestApproach(patient->m_vecOrigin()) <= 0.0f)
+            continue;
+        if (proj.crit)
+            hasCritRockets = true;
+        hasRockets = true;
     }
     if (hasRockets)
     {
@@ -214,22 +211,6 @@ int BlastDangerValue(CachedEntity *patient)
         }
         return 1;
     }
-    // Find rockets/pipes nearby
-    for (int i = PLAYER_ARRAY_SIZE; i <= HIGHEST_ENTITY; i++)
-    {
-        CachedEntity *ent = ENTITY(i);
-        if (CE_BAD(ent))
-            continue;
-        if (!ent->m_bEnemy())
-            continue;
-        if (ent->m_Type() != ENTITY_PROJECTILE)
-            continue;
-        if (ent->m_iClassID() == CL_CLASS(CTFProjectile_Flare))
-            continue;
-        if (patient->m_vecOrigin().DistTo(ent->m_vecOrigin()) > (int) auto_vacc_proj_danger_range)
-            continue;
-        proj_data_array.push_back(proj_data_s{ i, ent->m_vecOrigin() });
-    }
     return 0;
 }
 
@@ -240,31 +221,6 @@ int CurrentResistance()
     return CE_INT(LOCAL_W, netvar.m_nChargeResistType);
 }
 
-bool IsProjectile(CachedEntity *ent)
-{
-    return (ent->m_iClassID() == CL_CLASS(CTFProjectile_Rocket) || ent->m_iClassID() == CL_CLASS(CTFProjectile_Flare) || ent->m_iClassID() == CL_CLASS(CTFProjectile_EnergyBall) || ent->m_iClassID() == CL_CLASS(CTFProjectile_HealingBolt) || ent->m_iClassID() == CL_CLASS(CTFProjectile_Arrow) || ent->m_iClassID() == CL_CLASS(CTFProjectile_SentryRocket) || ent->m_iClassID() == CL_CLASS(CTFProjectile_Cleaver) || ent->m_iClassID() == CL_CLASS(CTFGrenadePipebombProjectile) || ent->m_iClassID() == CL_CLASS(CTFProjectile_EnergyRing));
-}
-
-int NearbyEntities()
-{
-    int ret = 0;
-    if (CE_BAD(LOCAL_E) || CE_BAD(LOCAL_W))
-        return ret;
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
-    {
-        CachedEntity *ent = ENTITY(i);
-        if (CE_BAD(ent))
-            continue;
-        if (ent == LOCAL_E)
-            continue;
-        if (!ent->m_bAlivePlayer())
-            continue;
-        if (ent->m_flDistance() <= 300.0f)
-            ret++;
-    }
-    return ret;
-}
-
 int OptimalResistance(CachedEntity *patient, bool *shouldPop)
 {
     int bd = BlastDangerValue(patient), fd = FireDangerValue(patient), hd = BulletDangerValue(patient);
@@ -605,6 +561,7 @@ void CreateMove()
     bool pop = false;
     if (IsVaccinator() && auto_vacc)
     {
+        UpdateThreats();
         DoResistSwitching();
         int my_opt = OptimalResistance(LOCAL_E, &pop);
         if (my_opt >= 0 && my_opt != CurrentResistance())
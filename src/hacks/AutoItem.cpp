@@ -66,6 +66,58 @@ std::unordered_map<int /*item_id*/, AchivementItem> ach_items;
 
 std::vector<std::vector<std::string>> craft_groups;
 
+// Item def index -> UUID of an item with it, rebuilt whenever the item count changes
+static std::unordered_map<int, unsigned long long> inventory_index;
+static int indexed_count = -1;
+
+// Requests of one run, sent together at the end of it
+struct equip_request_s
+{
+    int clazz;
+    int slot;
+    int id;
+};
+struct acquire_request_s
+{
+    int id;
+    bool rent;
+};
+static std::vector<equip_request_s> equip_queue;
+static std::vector<acquire_request_s> acquire_queue;
+// What we last equipped into each class and slot, so unchanged slots don't go to the GC again
+static std::map<std::pair<int, int>, unsigned long long> equipped;
+
+// Achievement id -> index, the list never changes while the game runs
+static std::unordered_map<int, int> achievement_index;
+
+static re::CTFPlayerInventory *Inventory()
+{
+    return re::CTFInventoryManager::GTFInventoryManager()->GTFPlayerInventory();
+}
+
+static void UpdateIndex()
+{
+    auto inv  = Inventory();
+    int count = inv->GetItemCount();
+    if (count == indexed_count)
+        return;
+    indexed_count = count;
+    inventory_index.clear();
+    // Something got added or removed, don't trust what we think is equipped either
+    equipped.clear();
+    for (int i = 0; i < count; i++)
+    {
+        auto item = inv->GetItem(i);
+        inventory_index.emplace(item->GetDefinitionIndex(), item->UUID());
+    }
+    Debug("Indexed %i items", count);
+}
+
+static bool hasItem(int id)
+{
+    return inventory_index.find(id) != inventory_index.end();
+}
+
 bool checkAchMgr()
 {
     if (!g_IAchievementMgr)
@@ -100,6 +152,15 @@ void Unlock()
     }
 }
 
+static int achievementIndex(int id)
+{
+    if (achievement_index.empty())
+        for (int i = 0; i < g_IAchievementMgr->GetAchievementCount(); i++)
+            achievement_index.emplace(g_IAchievementMgr->GetAchievementByIndex(i)->GetAchievementID(), i);
+    auto found = achievement_index.find(id);
+    return found != achievement_index.end() ? found->second : -1;
+}
+
 void unlockSingle(int achID)
 {
     if (!checkAchMgr())
@@ -117,26 +178,21 @@ AchivementItem *isAchItem(int id)
     return val != ach_items.end() ? &val->second : nullptr;
 }
 
+// Queued, see Flush()
 void getItem(int id, bool rent = true)
 {
-    Debug("Trying to get item, %i", id);
-    auto index = isAchItem(id);
-    if (index)
-    {
-        unlockSingle(index->achievement_id);
-        g_IEngine->ClientCmd_Unrestricted("cl_trigger_first_notification");
-    }
-    else if (rent)
-        Rent(id);
-    else
-        Debug("Failed to get item %i", id);
+    for (auto &request : acquire_queue)
+        if (request.id == id)
+        {
+            request.rent |= rent;
+            return;
+        }
+    acquire_queue.push_back({ id, rent });
 }
 
+// Queued too, the last request for a class and slot wins
 static bool equipItem(int clazz, int slot, int id, bool get = true, bool allowRent = false)
 {
-    auto invmng = re::CTFInventoryManager::GTFInventoryManager();
-    auto inv    = invmng->GTFPlayerInventory();
-
     // Slot correction for spy
     if (g_pLocalPlayer->clazz == tf_spy)
     {
@@ -145,23 +201,59 @@ static bool equipItem(int clazz, int slot, int id, bool get = true, bool allowRe
             slot = 6;
     }
 
-    if (get)
+    if (get && !hasItem(id))
     {
-        auto item_view = inv->GetFirstItemOfItemDef(id);
-        if (!item_view)
+        getItem(id, allowRent);
+        return false;
+    }
+    if (id != -1 && !hasItem(id))
+        return false;
+
+    for (auto &request : equip_queue)
+        if (request.clazz == clazz && request.slot == slot)
         {
-            getItem(id, allowRent);
-            return false;
+            request.id = id;
+            return true;
+        }
+    equip_queue.push_back({ clazz, slot, id });
+    return true;
+}
+
+static void Flush()
+{
+    bool notify = false;
+    for (auto &request : acquire_queue)
+    {
+        Debug("Trying to get item, %i", request.id);
+        auto index = isAchItem(request.id);
+        if (index)
+        {
+            unlockSingle(index->achievement_id);
+            notify = true;
         }
+        else if (request.rent)
+            Rent(request.id);
+        else
+            Debug("Failed to get item %i", request.id);
     }
-    if (id == -1)
-        return invmng->EquipItemInLoadout(clazz, slot, -1);
+    acquire_queue.clear();
 
-    auto item_view = inv->GetFirstItemOfItemDef(id);
-    if (item_view)
-        return invmng->EquipItemInLoadout(clazz, slot, item_view->UUID());
+    auto invmng = re::CTFInventoryManager::GTFInventoryManager();
+    for (auto &request : equip_queue)
+    {
+        unsigned long long uuid = request.id == -1 ? -1ull : inventory_index[request.id];
+        auto key                = std::make_pair(request.clazz, request.slot);
+        auto found              = equipped.find(key);
+        if (found != equipped.end() && found->second == uuid)
+            continue;
+        if (invmng->EquipItemInLoadout(request.clazz, request.slot, uuid))
+            equipped[key] = uuid;
+    }
+    equip_queue.clear();
 
-    return false;
+    // Once for everything the achievements gave us
+    if (notify)
+        g_IEngine->ClientCmd_Unrestricted("cl_trigger_first_notification");
 }
 
 void parseRvars()
@@ -184,9 +276,6 @@ bool use_fallback       = false;
 int first_item_attempts = 0;
 void getAndEquipWeapon(std::string str, int clazz, int slot)
 {
-    auto invmng = re::CTFInventoryManager::GTFInventoryManager();
-    auto inv    = invmng->GTFPlayerInventory();
-
     if (str == "-1")
     {
         equipItem(clazz, slot, -1, false, false);
@@ -218,12 +307,10 @@ void getAndEquipWeapon(std::string str, int clazz, int slot)
             return;
         }
 
-        auto item_view = inv->GetFirstItemOfItemDef(ids_split.at(0));
-
         // Try the first item 3 times before moving to fallback
         if (use_fallback)
         {
-            if (!item_view && first_item_attempts >= 3)
+            if (!hasItem(ids_split.at(0)) && first_item_attempts >= 3)
                 equipItem(clazz, slot, ids_split.at(1), true, true);
             else
             {
@@ -251,8 +338,7 @@ void getAndEquipWeapon(std::string str, int clazz, int slot)
                 return;
             }
 
-            auto item_view = inv->GetFirstItemOfItemDef(result);
-            if (item_view)
+            if (hasItem(result))
             {
                 equipItem(clazz, slot, result, false, false);
                 return;
@@ -301,8 +387,7 @@ void getAndEquipWeapon(std::string str, int clazz, int slot)
                     }
 
                     // In this loop id is a item id of 1 part of the crafting group
-                    auto item_view = inv->GetFirstItemOfItemDef(id);
-                    if (item_view)
+                    if (hasItem(id))
                         rec_req_amount_have++;
                     else
                     {
@@ -346,18 +431,28 @@ void getAndEquipWeapon(std::string str, int clazz, int slot)
 }
 
 static Timer t{};
+static int last_clazz = 0;
 void CreateMove()
 {
-    if (!enable || CE_BAD(LOCAL_E) || !t.test_and_set(*interval))
+    if (!enable || CE_BAD(LOCAL_E))
         return;
-
-    int clazz   = g_pLocalPlayer->clazz;
-    auto invmng = re::CTFInventoryManager::GTFInventoryManager();
-    auto inv    = invmng->GTFPlayerInventory();
+    int clazz = g_pLocalPlayer->clazz;
+    // Changing class gets its loadout right away instead of on the next interval
+    bool class_changed = clazz != last_clazz;
+    last_clazz         = clazz;
+    if (!t.test_and_set(*interval) && !class_changed)
+        return;
+    if (class_changed)
+    {
+        t.update();
+        // The loadout may have been changed by hand in the class menu, equip everything again
+        equipped.clear();
+    }
 
     // Only run if we are playing a valid class
     if (clazz != 0)
     {
+        UpdateIndex();
         if (weapons)
         {
             getAndEquipWeapon(*primary, clazz, 0);
@@ -374,10 +469,11 @@ void CreateMove()
             equipItem(clazz, slots[(offset + 2) % 3], *hat3);
             offset = (offset + 1) % 3;
         }
-        if (autoNoisemaker && inv->GetFirstItemOfItemDef(noisemaker_id))
+        if (autoNoisemaker && hasItem(noisemaker_id))
         {
             equipItem(clazz, 9, noisemaker_id, false, false);
         }
+        Flush();
     }
 }
 
@@ -427,18 +523,7 @@ CatCommand lock_single("achievement_lock_single", "Locks single achievement by I
         return;
     }
     auto *ach = reinterpret_cast<IAchievement *>(g_IAchievementMgr->GetAchievementByID(id));
-
-    int index = -1;
-    if (ach)
-        for (int i = 0; i < g_IAchievementMgr->GetAchievementCount(); i++)
-        {
-            auto ach2 = g_IAchievementMgr->GetAchievementByIndex(i);
-            if (ach2->GetAchievementID() == id)
-            {
-                index = i;
-                break;
-            }
-        }
+    int index = ach ? achievementIndex(id) : -1;
     if (ach && index != -1)
     {
         g_ISteamUserStats->RequestCurrentStats();
@@ -469,6 +554,9 @@ static InitRoutine init([]() {
     melee.installChangeCallback([](settings::VariableBase<std::string> &var, const std::string &after) { parseRvars(); });
 
     EC::Register(EC::CreateMove, CreateMove, "autoitem_cm");
+    // The GC can change the loadout while we're away, send everything again
+    EC::Register(
+        EC::LevelInit, []() { equipped.clear(); }, "autoitem_levelinit");
 
     std::time_t theTime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
     std::tm *aTime      = std::localtime(&theTime);
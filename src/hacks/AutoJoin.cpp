@@ -12,6 +12,7 @@
 #include "common.hpp"
 #include "hack.hpp"
 #include "MiscTemporary.hpp"
+#include "ipcscheduler.hpp"
 
 namespace hacks::shared::autojoin
 {
@@ -37,8 +38,16 @@ bool UnassignedClass()
     return g_pLocalPlayer->clazz != *autojoin_class;
 }
 
-static Timer autoteam_timer{};
 static Timer startqueue_timer{};
+// Other bots on the host may be loading a level right now, queue up after them
+static bool MayJoin()
+{
+#if ENABLE_IPC
+    return ipc::scheduler::TryBegin(ipc::scheduler::level_load, 60000);
+#else
+    return true;
+#endif
+}
 #if not ENABLE_VISUALS
 Timer queue_time{};
 #endif
@@ -59,18 +68,15 @@ void updateSearch()
         return;
     }
 
-    static uintptr_t addr    = gSignatures.GetClientSignature("C7 04 24 ? ? ? ? 8D 7D ? 31 F6");
-    static uintptr_t offset0 = uintptr_t(*(uintptr_t *) (addr + 0x3));
-    static uintptr_t offset1 = gSignatures.GetClientSignature("55 89 E5 83 EC ? 8B 45 ? 8B 80 ? ? ? ? 85 C0 74 ? C7 44 24 ? ? ? ? ? "
-                                                              "89 04 24 E8 ? ? ? ? 85 C0 74 ? 8B 40");
-    typedef int (*GetPendingInvites_t)(uintptr_t);
-    GetPendingInvites_t GetPendingInvites = GetPendingInvites_t(offset1);
-    int invites                           = GetPendingInvites(offset0);
-
-    re::CTFGCClientSystem *gc = re::CTFGCClientSystem::GTFGCClientSystem();
-    re::CTFPartyClient *pc    = re::CTFPartyClient::GTFPartyClient();
+    auto &state     = tfmm::queueState();
+    unsigned period = 5000 + tfmm::queueStagger();
+    // Nothing the GC said keeps us from queueing. Queueing refreshes the state, so a second call sees the first queue
+    auto can_queue = []() {
+        auto &now = tfmm::queueState();
+        return now.available && !now.connected_to_match && !now.live_match && !now.pending_invites && !now.in_queue;
+    };
 
-    if (current_user_cmd && gc && gc->BConnectedToMatchServer(false) && gc->BHaveLiveMatch())
+    if (current_user_cmd && state.connected_to_match && state.live_match)
     {
 #if not ENABLE_VISUALS
         queue_time.update();
@@ -84,24 +90,22 @@ void updateSearch()
 
     if (auto_requeue)
     {
-        if (startqueue_timer.check(5000) && gc && !gc->BConnectedToMatchServer(false) && !gc->BHaveLiveMatch() && !invites)
-            if (pc && !(pc->BInQueueForMatchGroup(tfmm::getQueue()) || pc->BInQueueForStandby()))
-            {
-                logging::Info("Starting queue for standby, Invites %d", invites);
-                tfmm::startQueueStandby();
-            }
+        if (startqueue_timer.check(period) && can_queue() && MayJoin())
+        {
+            logging::Info("Starting queue for standby, Invites %d", state.pending_invites);
+            tfmm::startQueueStandby();
+        }
     }
 
     if (auto_queue)
     {
-        if (startqueue_timer.check(5000) && gc && !gc->BConnectedToMatchServer(false) && !gc->BHaveLiveMatch() && !invites)
-            if (pc && !(pc->BInQueueForMatchGroup(tfmm::getQueue()) || pc->BInQueueForStandby()))
-            {
-                logging::Info("Starting queue, Invites %d", invites);
-                tfmm::startQueue();
-            }
+        if (startqueue_timer.check(period) && can_queue() && MayJoin())
+        {
+            logging::Info("Starting queue, Invites %d", state.pending_invites);
+            tfmm::startQueue();
+        }
     }
-    startqueue_timer.test_and_set(5000);
+    startqueue_timer.test_and_set(period);
 #if not ENABLE_VISUALS
     if (queue_time.test_and_set(1200000))
     {
@@ -109,19 +113,17 @@ void updateSearch()
     }
 #endif
 }
+// Runs every 5 seconds
 static void update()
 {
-    if (autoteam_timer.test_and_set(5000))
+    if (autojoin_team and UnassignedTeam())
     {
-        if (autojoin_team and UnassignedTeam())
-        {
-            hack::ExecuteCommand("autoteam");
-        }
-        else if (autojoin_class and UnassignedClass())
-        {
-            if (int(autojoin_class) < 10)
-                g_IEngine->ExecuteClientCmd(format("join_class ", classnames[int(autojoin_class) - 1]).c_str());
-        }
+        hack::ExecuteCommand("autoteam");
+    }
+    else if (autojoin_class and UnassignedClass())
+    {
+        if (int(autojoin_class) < 10)
+            g_IEngine->ExecuteClientCmd(format("join_class ", classnames[int(autojoin_class) - 1]).c_str());
     }
 }
 
@@ -134,7 +136,7 @@ void onShutdown()
 static CatCommand get_steamid("print_steamid", "Prints your SteamID", []() { g_ICvar->ConsoleColorPrintf(MENU_COLOR, "%u\n", g_ISteamUser->GetSteamID().GetAccountID()); });
 
 static InitRoutine init([]() {
-    EC::Register(EC::CreateMove, update, "cm_autojoin", EC::average);
+    EC::Register(EC::CreateMove, update, "cm_autojoin", EC::every_ms(5000), EC::average);
     EC::Register(EC::Paint, updateSearch, "paint_autojoin", EC::average);
     static BytePatch p{ gSignatures.GetClientSignature, "55 89 E5 53 83 EC 14 8B 45 08 8B 40 30", 0x00, { 0x31, 0xC0, 0x40, 0xC3 } };
     static BytePatch p2{ gSignatures.GetClientSignature, "55 89 E5 57 56 53 83 EC ? 8B 45 0C 8B 5D 08 8B 55 10 89 45 ? 8B 43", 0x00, { 0x31, 0xC0, 0x40, 0xC3 } };
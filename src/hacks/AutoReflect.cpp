@@ -36,16 +36,17 @@ static settings::Float fovcircle_opacity{ "autoreflect.draw-fov-opacity", "0.7"
 #endif
 
 // Function to determine whether an ent is good to reflect
-static bool ShouldReflect(CachedEntity *ent)
+static bool ShouldReflect(const projectile_tracker::projectile_s &proj)
 {
-    // Check if the entity is a projectile
-    if (ent->m_Type() != ENTITY_PROJECTILE)
+    CachedEntity *ent = proj.entity;
+    // Check if dormant
+    if (proj.dormant)
         return false;
 
     if (!teammates)
     {
         // Check if the projectile is your own teams
-        if (!ent->m_bEnemy())
+        if (!proj.enemy)
             return false;
     }
 
@@ -53,10 +54,7 @@ static bool ShouldReflect(CachedEntity *ent)
     if (!dodgeball)
     {
         // If projectile is already deflected, don't deflect it again.
-        if (CE_INT(ent, (ent->m_bGrenadeProjectile() ?
-                                                     /* NetVar for grenades */ netvar.Grenade_iDeflected
-                                                     :
-                                                     /* For rockets */ netvar.Rocket_iDeflected)))
+        if (proj.deflected)
             return false;
     }
 
@@ -66,7 +64,7 @@ static bool ShouldReflect(CachedEntity *ent)
     if (ent->m_iClassID() == CL_CLASS(CTFGrenadePipebombProjectile))
     {
         // Checks the demoman projectile type (both stickies and pipes are combined under PipeBombProjectile)
-        if (CE_INT(ent, netvar.iPipeType) == 1)
+        if (proj.sticky)
             return *stickies;
         if (CE_INT(ent, netvar.iPipeType) == 0)
             return *pipes;
@@ -119,40 +117,24 @@ void CreateMove()
     // Create some book-keeping vars
     float closest_dist = 0.0f;
     Vector closest_vec;
-    // Loop to find the closest entity
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
+    // Some extrapolating due to reflect timing being latency based
+    float latency = g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_INCOMING) + g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING);
+    // Loop to find the closest entity, only projectiles can be reflected
+    for (auto &proj : projectile_tracker::All())
     {
-
-        // Find an ent from the for loops current tick
-        CachedEntity *ent = ENTITY(i);
-
-        // Check if null or dormant
-        if (CE_BAD(ent))
-            continue;
-
         // Check if ent should be reflected
-        if (!ShouldReflect(ent))
+        if (!ShouldReflect(proj))
             continue;
 
-        // Some extrapolating due to reflect timing being latency based
-        // Grab latency
-        float latency = g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_INCOMING) + g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING);
-        // Create a vector variable to store our velocity
-        Vector velocity;
-        // Grab Velocity of projectile
-        velocity::EstimateAbsVelocity(RAW_ENT(ent), velocity);
         // Predict a vector for where the projectile will be
-        Vector predicted_proj = ent->m_vecOrigin() + (velocity * latency);
+        Vector predicted_proj = proj.PositionAt(latency);
 
         // Dont vischeck if ent is stickybomb or if dodgeball mode is enabled
-        if (ent->m_iClassID() == CL_CLASS(CTFGrenadePipebombProjectile) && !dodgeball)
+        if (proj.sticky && !dodgeball)
         {
-            if (CE_INT(ent, netvar.iPipeType) == 1)
-            {
-                // Vis check the predicted vector
-                if (!IsVectorVisible(g_pLocalPlayer->v_Origin, predicted_proj))
-                    continue;
-            }
+            // Vis check the predicted vector
+            if (!IsVectorVisible(g_pLocalPlayer->v_Origin, predicted_proj))
+                continue;
         }
 
         /*else {
@@ -23,16 +23,14 @@ static std::vector<CachedEntity *> bombs;
 static std::vector<CachedEntity *> targets;
 
 // Function to tell when an ent is the local players own bomb
-bool IsBomb(CachedEntity *ent)
+bool IsBomb(const projectile_tracker::projectile_s &proj)
 {
     // Check if ent is a stickybomb
-    if (ent->m_iClassID() != CL_CLASS(CTFGrenadePipebombProjectile))
-        return false;
-    if (CE_INT(ent, netvar.iPipeType) != 1)
+    if (!proj.sticky)
         return false;
 
     // Check if the stickybomb is the players own
-    if ((CE_INT(ent, netvar.hThrower) & 0xFFF) != g_pLocalPlayer->entity->m_IDX)
+    if (proj.owner != g_pLocalPlayer->entity->m_IDX)
         return false;
 
     // Check passed, return true
@@ -122,24 +120,19 @@ void CreateMove()
     targets.clear();
 
     // Cycle through the ents and search for valid ents
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
-    {
-        // Assign the for loops index to an ent
-        CachedEntity *ent = ENTITY(i);
-        // Check for dormancy and if valid
-        if (CE_INVALID(ent))
-            continue;
-        // Check if ent is a bomb or suitable target and push to respective
-        // arrays
-        if (IsBomb(ent))
-        {
-            bombs.push_back(ent);
-        }
-        else if (IsTarget(ent))
+    for (auto &proj : projectile_tracker::All())
+        if (IsBomb(proj))
+            bombs.push_back(proj.entity);
+    // Only players and buildings can be targets
+    for (auto type : { ENTITY_PLAYER, ENTITY_BUILDING })
+        for (CachedEntity *ent : entity_cache::OfType(type))
         {
-            targets.push_back(ent);
+            // Check for dormancy and if valid
+            if (CE_INVALID(ent))
+                continue;
+            if (IsTarget(ent))
+                targets.push_back(ent);
         }
-    }
 
     // Loop through every target for a given bomb
     bool found = false;
@@ -29,62 +29,54 @@ enum slots
 static bool in_taunt = false;
 static int prev_slot = -1;
 static Timer taunt_t{};
-class AutoTauntListener : public IGameEventListener2
+static void OnPlayerDeath(const game_events::event_s &event)
 {
-public:
-    virtual void FireGameEvent(IGameEvent *event)
+    if (!enable)
     {
-        if (!enable)
-        {
-            return;
-        }
-        if (g_IEngine->GetPlayerForUserID(event->GetInt("attacker")) == g_IEngine->GetLocalPlayer())
+        return;
+    }
+    if (event.death->attacker == g_IEngine->GetLocalPlayer())
+    {
+        bool nearby = false;
+        for (int i = 1; i <= HIGHEST_ENTITY; i++)
         {
-            bool nearby = false;
-            for (int i = 1; i <= HIGHEST_ENTITY; i++)
+            auto ent = ENTITY(i);
+            if (CE_VALID(ent) && (ent->m_Type() == ENTITY_PLAYER || ent->m_iClassID() == CL_CLASS(CObjectSentrygun)) && ent->m_bEnemy() && ent->m_bAlivePlayer())
             {
-                auto ent = ENTITY(i);
-                if (CE_VALID(ent) && (ent->m_Type() == ENTITY_PLAYER || ent->m_iClassID() == CL_CLASS(CObjectSentrygun)) && ent->m_bEnemy() && ent->m_bAlivePlayer())
+                if (!player_tools::shouldTarget(ent))
+                    continue;
+                if (ent->m_vecDormantOrigin() && ent->m_vecDormantOrigin()->DistTo(LOCAL_E->m_vecOrigin()) < *safety)
                 {
-                    if (!player_tools::shouldTarget(ent))
-                        continue;
-                    if (ent->m_vecDormantOrigin() && ent->m_vecDormantOrigin()->DistTo(LOCAL_E->m_vecOrigin()) < *safety)
-                    {
-                        nearby = true;
-                        break;
-                    }
+                    nearby = true;
+                    break;
                 }
             }
-            if (!nearby && RandomFloat(0, 100) <= float(chance))
+        }
+        if (!nearby && RandomFloat(0, 100) <= float(chance))
+        {
+            if (switch_weapon)
             {
-                if (switch_weapon)
+                if (CE_GOOD(LOCAL_E) && CE_GOOD(LOCAL_W))
                 {
-                    if (CE_GOOD(LOCAL_E) && CE_GOOD(LOCAL_W))
-                    {
-                        IClientEntity *weapon = RAW_ENT(LOCAL_W);
-                        // IsBaseCombatWeapon()
-                        if (re::C_BaseCombatWeapon::IsBaseCombatWeapon(weapon))
-                            prev_slot = re::C_BaseCombatWeapon::GetSlot(weapon);
-                        int new_slot = *switch_weapon;
-                        if (new_slot == disguise && g_pLocalPlayer->clazz != tf_spy && g_pLocalPlayer->clazz != tf_engineer)
-                            new_slot = primary;
-                        if (new_slot == destruct_pda && g_pLocalPlayer->clazz != tf_engineer)
-                            new_slot = primary;
-                        hack::ExecuteCommand(format("slot", new_slot));
-                        taunt_t.update();
-                    }
+                    IClientEntity *weapon = RAW_ENT(LOCAL_W);
+                    // IsBaseCombatWeapon()
+                    if (re::C_BaseCombatWeapon::IsBaseCombatWeapon(weapon))
+                        prev_slot = re::C_BaseCombatWeapon::GetSlot(weapon);
+                    int new_slot = *switch_weapon;
+                    if (new_slot == disguise && g_pLocalPlayer->clazz != tf_spy && g_pLocalPlayer->clazz != tf_engineer)
+                        new_slot = primary;
+                    if (new_slot == destruct_pda && g_pLocalPlayer->clazz != tf_engineer)
+                        new_slot = primary;
+                    hack::ExecuteCommand(format("slot", new_slot));
+                    taunt_t.update();
                 }
             }
         }
     }
-};
-
-AutoTauntListener listener;
+}
 
 InitRoutine init([]() {
-    g_IEventManager2->AddListener(&listener, "player_death", false);
-    EC::Register(
-        EC::Shutdown, []() { g_IEventManager2->RemoveListener(&listener); }, "Shutdown_Autotaunt");
+    game_events::Subscribe("player_death", OnPlayerDeath);
     EC::Register(
         EC::CreateMove,
         []() {
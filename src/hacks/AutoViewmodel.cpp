@@ -61,5 +61,5 @@ void CreateMove()
         cl_flipviewmodels->SetValue(defaults);
 }
 
-static InitRoutine init([]() { EC::Register(EC::CreateMove, CreateMove, "viewmodel_flip_cm"); });
+static InitRoutine init([]() { EC::Register(EC::CreateMove, CreateMove, "viewmodel_flip_cm", auto_viewmodel_flipper); });
 } // namespace hacks::tf2::autoviewmodel
@@ -12,6 +12,7 @@ namespace hooked_methods
 // Note that this is of the type CTFPlayerInventory *
 DEFINE_HOOKED_METHOD(GetMaxItemCount, int, int *)
 {
+    HOOK_SCOPE(GetMaxItemCount);
     // Max backpack slots ez gg
     return *slot_count;
 }
@@ -43,7 +44,7 @@ void Paint()
 
 static InitRoutine init([]() {
 #if !ENFORCE_STREAM_SAFETY
-    EC::Register(EC::Paint, Paint, "bpexpander_paint");
+    EC::Register(EC::Paint, Paint, "bpexpander_paint", enabled);
     EC::Register(
         EC::Shutdown, []() { hooks::inventory.Release(); }, "backpack_expander_shutdown");
     enabled.installChangeCallback([](settings::VariableBase<bool> &, bool after) {
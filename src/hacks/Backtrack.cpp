@@ -5,7 +5,8 @@
  */
 #include "Backtrack.hpp"
 #include "PlayerTools.hpp"
-#include "memory"
+#include "memtrack.hpp"
+#include "governor.hpp"
 
 namespace hacks::tf2::backtrack
 {
@@ -15,7 +16,68 @@ static settings::Boolean draw{ "backtrack.draw", "false" };
 
 static std::vector<CIncomingSequence> sequences;
 static int current_tickcount;
-static std::vector<std::unique_ptr<std::array<BacktrackData, 67>>> backtrack_data;
+// Per player ring buffer, allocated for every player on level init so recording never allocates
+struct BacktrackRecord
+{
+    std::array<BacktrackData, MAX_TICKS> ticks{};
+    // Box of each slot, and the union of those that can still be good ticks
+    std::array<TickBounds, MAX_TICKS> tick_bounds{};
+    TickBounds bounds{};
+    bool active{ false };
+};
+static std::vector<BacktrackRecord> backtrack_data;
+// Bone matrices of every (player, ring slot), each slot has room for MAXSTUDIOBONES
+static std::vector<matrix3x4_t> bone_slab;
+
+static matrix3x4_t *boneSlot(int record, int slot)
+{
+    return &bone_slab[((size_t) record * MAX_TICKS + slot) * MAXSTUDIOBONES];
+}
+
+// Every point of a hitbox is within the length of its furthest corner from the bone origin, no matter how the bone is rotated.
+// That bounds the hitboxes without transforming them
+static void addHitboxBounds(TickBounds &bounds, const BacktrackData &tick)
+{
+    if (!tick.bones || !tick.hitbox_set)
+        return;
+    int count = std::min(tick.hitbox_set->numhitboxes, 18);
+    for (int i = 0; i < count; i++)
+    {
+        mstudiobbox_t *box = tick.hitbox_set->pHitbox(i);
+        if (!box || box->bone < 0 || box->bone >= tick.numbones)
+            continue;
+        const matrix3x4_t &bone = tick.bones[box->bone];
+        Vector origin(bone[0][3], bone[1][3], bone[2][3]);
+        float radius = std::max(box->bbmin.Length(), box->bbmax.Length());
+        bounds.Add(origin - Vector(radius, radius, radius));
+        bounds.Add(origin + Vector(radius, radius, radius));
+    }
+}
+
+void BacktrackData::materializeHitboxes() const
+{
+    hitboxes_ready = true;
+    hitboxes.fill(hitboxData{});
+    if (!bones || !hitbox_set)
+        return;
+    int count = std::min(hitbox_set->numhitboxes, (int) hitboxes.size());
+    std::array<hitbox_cache::CachedHitbox, 18> transformed;
+    hitbox_cache::TransformHitboxes(bones, hitbox_set, count, transformed.data());
+    for (int i = 0; i < count; i++)
+    {
+        // Bad bone, stays zeroed like hitboxes the model doesn't have
+        if (!transformed[i].bbox)
+            continue;
+        hitboxes[i].center = transformed[i].center;
+        hitboxes[i].min    = transformed[i].min;
+        hitboxes[i].max    = transformed[i].max;
+    }
+}
+
+static bool hasRecord(int entidx)
+{
+    return entidx > 0 && entidx <= (int) backtrack_data.size() && backtrack_data[entidx - 1].active;
+}
 static int lastincomingsequence{ 0 };
 // Used to make transition smooth(er)
 static float latency_rampup = 0.0f;
@@ -27,7 +89,7 @@ static std::optional<BacktrackData> bt_data;
 static bool isEnabled();
 static float getLatency();
 static int getTicks();
-static bool getBestInternalTick(CachedEntity *, BacktrackData &, std::optional<BacktrackData> &);
+static bool getBestInternalTick(CachedEntity *, const BacktrackData &, const BacktrackData *);
 static void ApplyBacktrack();
 
 settings::Float latency{ "backtrack.latency", "0" };
@@ -37,6 +99,10 @@ settings::Boolean chams{ "backtrack.chams", "false" };
 settings::Int chams_ticks{ "backtrack.chams.ticks", "1" };
 settings::Rgba chams_color{ "backtrack.chams.color", "646464FF" };
 settings::Boolean chams_solid{ "backtrack.chams.color.solid", "false" };
+// 0 the tick backtrack aims at or the oldest, 1 the oldest, 2 the oldest backtrack.chams.ticks
+settings::Int chams_tick{ "backtrack.chams.tick", "0" };
+// Outlines of the hitboxes from the stored bones instead of drawing the model again
+settings::Boolean chams_hitboxes{ "backtrack.chams.hitboxes", "false" };
 #endif
 
 // Check if backtrack is enabled
@@ -44,6 +110,7 @@ bool isBacktrackEnabled;
 #if ENABLE_VISUALS
 // Drawing Backtrack chams
 bool isDrawing;
+int chams_drawn_frame[PLAYER_ARRAY_SIZE]{};
 #endif
 
 // Apply Backtrack
@@ -61,14 +128,14 @@ void ApplyBacktrack()
 }
 
 // Update tick to apply
-void SetBacktrackData(CachedEntity *ent, BacktrackData tick)
+void SetBacktrackData(CachedEntity *ent, const BacktrackData &tick)
 {
     bt_ent  = ent;
     bt_data = tick;
 }
 
 // Get Best tick for Backtrack (crosshair/fov based)
-bool getBestInternalTick(CachedEntity *, BacktrackData &data, std::optional<BacktrackData> &best_tick)
+bool getBestInternalTick(CachedEntity *, const BacktrackData &data, const BacktrackData *best_tick)
 {
     // Best Score
     float bestScore = FLT_MAX;
@@ -80,9 +147,9 @@ bool getBestInternalTick(CachedEntity *, BacktrackData &data, std::optional<Back
 
     // Get the FOV of the best tick if available
     if (best_tick)
-        bestScore = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, (*best_tick).hitboxes.at(head).center);
+        bestScore = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, best_tick->hitbox(head).center);
 
-    float FOVDistance = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, data.hitboxes.at(head).center);
+    float FOVDistance = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, data.hitbox(head).center);
     if (FOVDistance >= bestScore)
         return false;
 
@@ -90,7 +157,7 @@ bool getBestInternalTick(CachedEntity *, BacktrackData &data, std::optional<Back
     if (FOVDistance < bestScore)
     {
         // Vischeck check
-        if (!is_melee && !IsVectorVisible(g_pLocalPlayer->v_Eye, data.hitboxes.at(head).center, false))
+        if (!is_melee && !IsVectorVisible(g_pLocalPlayer->v_Eye, data.hitbox(head).center, false))
             return false;
         return true;
     }
@@ -196,23 +263,31 @@ void CreateMove()
             resetData(i);
             continue;
         }
-        auto &backtrack_ent = backtrack_data.at(i - 1);
+        if (i > (int) backtrack_data.size())
+            continue;
+        auto &backtrack_ent = backtrack_data[i - 1];
 
-        // Have no data, create it
-        if (!backtrack_ent)
-            backtrack_ent.reset(new std::array<BacktrackData, 67>);
+        // Reused record, throw away the old player's ticks
+        if (!backtrack_ent.active)
+        {
+            backtrack_ent.ticks.fill(BacktrackData{});
+            backtrack_ent.active = true;
+        }
 
         int current_index = current_user_cmd->tick_count % getTicks();
 
         // Our current tick
-        auto &current_tick = (*backtrack_ent).at(current_index);
+        auto &current_tick = backtrack_ent.ticks.at(current_index);
 
         // Previous tick
         int last_index = current_index - 1;
         if (last_index < 0)
             last_index = getTicks() - 1;
 
-        auto &previous_tick = (*backtrack_ent).at(last_index);
+        auto &previous_tick = backtrack_ent.ticks.at(last_index);
+
+        // Start over, this also drops the hitboxes materialized from the old bones
+        current_tick = BacktrackData{};
 
         // Update basics
         current_tick.tickcount = current_user_cmd->tick_count;
@@ -226,33 +301,21 @@ void CreateMove()
 
         current_tick.m_flSimulationTime = CE_FLOAT(ent, netvar.m_flSimulationTime);
 
-        // Update hitboxes
-        ent->hitboxes.InvalidateCache();
-        for (size_t i = 0; i < 18; i++)
-        {
-            current_tick.hitboxes[i].center = ent->hitboxes.GetHitbox(i)->center;
-            current_tick.hitboxes[i].min    = ent->hitboxes.GetHitbox(i)->min;
-            current_tick.hitboxes[i].max    = ent->hitboxes.GetHitbox(i)->max;
-        }
-
-        // Copy bones (for chams/glow)
+        // Copy bones (for chams/glow and the hitboxes)
         auto model = (const model_t *) RAW_ENT(ent)->GetModel();
         if (model)
         {
             auto shdr = g_IModelInfo->GetStudiomodel(model);
-            if (shdr)
+            if (shdr && shdr->numbones > 0)
             {
-                int numbones = shdr->numbones;
-                if (numbones != current_tick.bones.size())
-                    current_tick.bones.resize(numbones);
+                int numbones            = std::min(shdr->numbones, MAXSTUDIOBONES);
+                current_tick.bones      = boneSlot(i - 1, current_index);
+                current_tick.numbones   = numbones;
+                current_tick.hitbox_set = shdr->pHitboxSet(CE_INT(ent, netvar.iHitboxSet));
 
-                memcpy((void *) &current_tick.bones[0], (void *) &ent->hitboxes.bones[0], sizeof(matrix3x4_t) * numbones);
+                memcpy((void *) current_tick.bones, (void *) ent->hitboxes.GetBones(numbones), sizeof(matrix3x4_t) * numbones);
             }
-            else
-                current_tick.bones.resize(0);
         }
-        else
-            current_tick.bones.resize(0);
 
         // Check if tick updated or not (fakelag)
         current_tick.has_updated = !previous_tick.m_flSimulationTime || previous_tick.m_flSimulationTime != current_tick.m_flSimulationTime;
@@ -261,7 +324,7 @@ void CreateMove()
         // if the new tick is too far away all the other ones get marked as not updated and thus invalid
         if (current_tick.m_vecOrigin.AsVector2D().DistTo(previous_tick.m_vecOrigin.AsVector2D()) > 64)
         {
-            for (auto &tick : *backtrack_ent)
+            for (auto &tick : backtrack_ent.ticks)
             {
                 // Older than current tick, mark invalid
                 if (tick.tickcount < current_tick.tickcount)
@@ -269,10 +332,20 @@ void CreateMove()
             }
         }
 
+        // Update the bounds, ticks that didn't update are never good so they don't count
+        auto &current_bounds = backtrack_ent.tick_bounds[current_index];
+        current_bounds.Reset(current_tick.m_vecOrigin + current_tick.m_vecMins);
+        current_bounds.Add(current_tick.m_vecOrigin + current_tick.m_vecMaxs);
+        addHitboxBounds(current_bounds, current_tick);
+        backtrack_ent.bounds = current_bounds;
+        for (int j = 0; j < MAX_TICKS; j++)
+            if (backtrack_ent.ticks[j].has_updated)
+                backtrack_ent.bounds.Add(backtrack_ent.tick_bounds[j]);
+
         // Get best tick for this ent
         std::optional<BacktrackData> data = getBestTick(ent, getBestInternalTick);
         // Check if actually the best tick we have in total
-        if (data && (!best_data || getBestInternalTick(ent, *data, best_data)))
+        if (data && (!best_data || getBestInternalTick(ent, *data, &*best_data)))
         {
             best_data = data;
             best_ent  = ent;
@@ -288,14 +361,44 @@ void CreateMoveLate()
 
 #if ENABLE_VISUALS
 // Drawing
-void Draw()
+// Corners in the order the lines below expect, bottom face first
+static void makeCorners(const Vector &mins, const Vector &maxs, Vector (&corners)[8])
 {
-    if (!isBacktrackEnabled || !draw)
-        return;
+    corners[0] = mins;
+    corners[1] = Vector(maxs.x, mins.y, mins.z);
+    corners[2] = Vector(maxs.x, maxs.y, mins.z);
+    corners[3] = Vector(mins.x, maxs.y, mins.z);
+    corners[4] = Vector(mins.x, mins.y, maxs.z);
+    corners[5] = Vector(maxs.x, mins.y, maxs.z);
+    corners[6] = maxs;
+    corners[7] = Vector(mins.x, maxs.y, maxs.z);
+}
 
-    if (CE_BAD(LOCAL_E))
+// Every hitbox as a box around its bone, straight from the stored matrices
+static void drawHitboxes(const BacktrackData &tick, const rgba_t &color)
+{
+    if (!tick.bones || !tick.hitbox_set)
         return;
+    for (int i = 0; i < tick.hitbox_set->numhitboxes; i++)
+    {
+        mstudiobbox_t *box = tick.hitbox_set->pHitbox(i);
+        if (!box || box->bone < 0 || box->bone >= tick.numbones)
+            continue;
+        Vector corners[8], points[8];
+        makeCorners(box->bbmin, box->bbmax, corners);
+        if (!draw::WorldToScreenBatch(tick.bones[box->bone], corners, 8, points, nullptr))
+            continue;
+        for (int j = 1; j <= 4; j++)
+        {
+            draw::Line(points[j - 1].x, points[j - 1].y, points[j % 4].x - points[j - 1].x, points[j % 4].y - points[j - 1].y, color, 0.5f);
+            draw::Line(points[j - 1].x, points[j - 1].y, points[j + 3].x - points[j - 1].x, points[j + 3].y - points[j - 1].y, color, 0.5f);
+            draw::Line(points[j + 3].x, points[j + 3].y, points[j % 4 + 4].x - points[j + 3].x, points[j % 4 + 4].y - points[j + 3].y, color, 0.5f);
+        }
+    }
+}
 
+static void drawTicks()
+{
     for (int i = 0; i <= g_IEngine->GetMaxClients(); i++)
     {
         auto data = getGoodTicks(i);
@@ -303,9 +406,9 @@ void Draw()
             continue;
         for (auto &tick : data)
         {
-            auto hbpos = tick.hitboxes.at(head).center;
-            auto min   = tick.hitboxes.at(head).min;
-            auto max   = tick.hitboxes.at(head).max;
+            auto hbpos = tick.hitbox(head).center;
+            auto min   = tick.hitbox(head).min;
+            auto max   = tick.hitbox(head).max;
             if (!hbpos.x && !hbpos.y && !hbpos.z)
                 continue;
             Vector out;
@@ -326,12 +429,39 @@ void Draw()
         }
     }
 }
+
+void Draw()
+{
+    if (!isBacktrackEnabled)
+        return;
+
+    if (CE_BAD(LOCAL_E))
+        return;
+
+    if (draw && !governor::Degraded(governor::NO_VISUALISERS))
+        drawTicks();
+    if (chams && chams_hitboxes)
+    {
+        int local = g_IEngine->GetLocalPlayer();
+        for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
+        {
+            if (i == local)
+                continue;
+            for (auto &tick : getChamsTicks(i))
+                drawHitboxes(tick, *chams_color);
+        }
+    }
+}
 #endif
 
-// Resize our backtrackdata
+// Resize our backtrackdata, vectors keep their capacity so this only allocates when the player count grows
 void LevelInit()
 {
-    backtrack_data.resize(g_IEngine->GetMaxClients());
+    size_t players = g_IEngine->GetMaxClients();
+    backtrack_data.resize(players);
+    for (auto &record : backtrack_data)
+        record.active = false;
+    bone_slab.resize(players * MAX_TICKS * MAXSTUDIOBONES);
 }
 
 // Reset things
@@ -410,11 +540,12 @@ int getTicks()
 
 void resetData(int entidx)
 {
-    // Clear everything
-    backtrack_data.at(entidx - 1).reset();
+    // Keep the memory around, the record is cleared once it gets used again
+    if (entidx > 0 && entidx <= (int) backtrack_data.size())
+        backtrack_data[entidx - 1].active = false;
 }
 
-bool isGoodTick(BacktrackData &tick)
+bool isGoodTick(const BacktrackData &tick)
 {
     // This tick hasn't updated since the last one, Entity might be dropping packets
     if (!tick.has_updated)
@@ -429,52 +560,92 @@ bool isGoodTick(BacktrackData &tick)
     return false;
 }
 
-// Read only vector of good ticks
-std::vector<BacktrackData> getGoodTicks(int entidx)
+// Read only view of the good ticks
+GoodTicks getGoodTicks(int entidx)
 {
-    std::vector<BacktrackData> to_return;
+    GoodTicks to_return;
     // Invalid
-    if (entidx <= 0 || (int) backtrack_data.size() < entidx || !backtrack_data.at(entidx - 1))
+    if (!hasRecord(entidx))
         return to_return;
 
     // Check all ticks
-    for (auto &tick : *backtrack_data.at(entidx - 1))
+    for (auto &tick : backtrack_data[entidx - 1].ticks)
         if (isGoodTick(tick))
             to_return.push_back(tick);
 
     // Sort so that oldest ticks come first
-    std::sort(to_return.begin(), to_return.end(), [](BacktrackData &a, BacktrackData &b) { return a.tickcount < b.tickcount; });
+    to_return.sort();
 
+    if (governor::Degraded(governor::HALF_BACKTRACK))
+    {
+        // Every other tick counting back from the newest, which stays the closest to the real position
+        GoodTicks halved;
+        for (size_t i = to_return.size() % 2 ? 0 : 1; i < to_return.size(); i += 2)
+            halved.push_back(to_return[i]);
+        return halved;
+    }
     return to_return;
 }
 
-// This function is so other files can Easily get the best tick matching their criteria
-std::optional<BacktrackData> getBestTick(CachedEntity *ent, std::function<bool(CachedEntity *ent, BacktrackData &data, std::optional<BacktrackData> &best_tick)> callback)
+#if ENABLE_VISUALS
+GoodTicks getChamsTicks(int entidx)
 {
-    std::optional<BacktrackData> best_tick;
-
-    // No data recorded
-    if (ent->m_IDX <= 0 || backtrack_data.size() < ent->m_IDX || !backtrack_data.at(ent->m_IDX - 1))
-        return std::nullopt;
+    GoodTicks all = getGoodTicks(entidx), chosen;
+    if (all.empty())
+        return chosen;
+    switch (*chams_tick)
+    {
+    case 0:
+        // The one we're about to shoot at
+        if (bt_ent && bt_data && bt_ent->m_IDX == entidx)
+            for (auto &tick : all)
+                if (tick.tickcount == bt_data->tickcount)
+                {
+                    chosen.push_back(tick);
+                    return chosen;
+                }
+        [[fallthrough]];
+    case 1:
+        chosen.push_back(all[0]);
+        break;
+    default:
+        for (size_t i = 0; i < all.size() && i < (size_t) std::max(*chams_ticks, 1); i++)
+            chosen.push_back(all[i]);
+    }
+    return chosen;
+}
+#endif
 
-    // Let the callback do the lifting
-    for (auto &tick : getGoodTicks(ent->m_IDX))
-        // Call the callback, and if we have a new best tick assign it
-        if (callback(ent, tick, best_tick))
-            best_tick = tick;
+const TickBounds *getTickBounds(int entidx)
+{
+    if (!hasRecord(entidx))
+        return nullptr;
+    return &backtrack_data[entidx - 1].bounds;
+}
 
-    // Return best result
-    return best_tick;
+bool boundsInFov(int entidx, float fov)
+{
+    auto bounds = getTickBounds(entidx);
+    if (!bounds)
+        return false;
+    // Cone around the bounding sphere of the box
+    Vector center = (bounds->min + bounds->max) * 0.5f;
+    float radius  = bounds->min.DistTo(bounds->max) * 0.5f;
+    float dist    = g_pLocalPlayer->v_Eye.DistTo(center);
+    if (dist <= radius)
+        return true;
+    float cone = RAD2DEG(std::asin(radius / dist));
+    return GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, center) - cone <= fov;
 }
 
 // Default filter method. Checks for vischeck on Hitscan weapons.
-bool defaultTickFilter(CachedEntity *ent, BacktrackData tick)
+bool defaultTickFilter(CachedEntity *ent, const BacktrackData &tick)
 {
     // Not hitscan, no vischeck needed
     if (g_pLocalPlayer->weapon_mode != weapon_hitscan)
         return true;
     // Return visibility
-    return IsEntityVectorVisible(ent, tick.hitboxes.at(head).center, true, MASK_SHOT);
+    return IsEntityVectorVisible(ent, tick.hitbox(head).center, true, MASK_SHOT);
 }
 
 bool defaultEntFilter(CachedEntity *ent)
@@ -488,65 +659,6 @@ bool defaultEntFilter(CachedEntity *ent)
     return true;
 }
 
-// Get Closest tick of a specific entity
-std::optional<BacktrackData> getClosestEntTick(CachedEntity *ent, Vector vec, std::function<bool(CachedEntity *, BacktrackData)> tick_filter)
-{
-    std::optional<BacktrackData> return_value;
-    // No entry
-    if (ent->m_IDX <= 0 || backtrack_data.size() < ent->m_IDX || !backtrack_data.at(ent->m_IDX - 1))
-        return return_value;
-
-    float distance = FLT_MAX;
-
-    // Go through all Good ticks
-    for (auto &tick : getGoodTicks(ent->m_IDX))
-    {
-        // Found Closer tick
-        if (tick.m_vecOrigin.DistTo(vec) < distance)
-        {
-            // Does the tick pass the filter
-            if (tick_filter(ent, tick))
-            {
-                return_value = tick;
-                distance     = tick.m_vecOrigin.DistTo(vec);
-            }
-        }
-    }
-    return return_value;
-}
-
-// Get Closest tick of any (enemy) entity, Second Parameter is to allow custom filters for entity criteria, third for ticks. We provide defaults for vischecks + melee for the second one
-std::optional<std::pair<CachedEntity *, BacktrackData>> getClosestTick(Vector vec, std::function<bool(CachedEntity *)> ent_filter, std::function<bool(CachedEntity *, BacktrackData)> tick_filter)
-{
-    float distance         = FLT_MAX;
-    CachedEntity *best_ent = nullptr;
-    BacktrackData best_data;
-
-    std::optional<std::pair<CachedEntity *, BacktrackData>> return_val;
-
-    for (int i = 0; i <= g_IEngine->GetMaxClients(); i++)
-    {
-        CachedEntity *ent = ENTITY(i);
-        // These checks are always present
-        if (CE_INVALID(ent) || !ent->m_bAlivePlayer() || !ent->m_bEnemy())
-            continue;
-        // true = passes check
-        if (!ent_filter(ent))
-            continue;
-        auto closest_entdata = getClosestEntTick(ent, vec, tick_filter);
-        // Closer than the stuff we have
-        if (closest_entdata && (*closest_entdata).m_vecOrigin.DistTo(vec) <= distance)
-        {
-            distance  = (*closest_entdata).m_vecOrigin.DistTo(vec);
-            best_data = *closest_entdata;
-            best_ent  = ent;
-        }
-    }
-    if (best_ent)
-        return_val = std::pair<CachedEntity *, BacktrackData>(best_ent, best_data);
-    return return_val;
-}
-
 static InitRoutine init([]() {
     EC::Register(EC::CreateMove, CreateMove, "backtrack_cm", EC::early);
     EC::Register(EC::CreateMove, CreateMoveLate, "backtrack_cmlate", EC::very_late);
@@ -555,6 +667,7 @@ static InitRoutine init([]() {
 #endif
     EC::Register(EC::LevelShutdown, LevelShutdown, "backtrack_levelshutdown");
     EC::Register(EC::LevelInit, LevelInit, "backtrack_levelinit");
+    memtrack::Report(memtrack::tag_backtrack, []() -> size_t { return backtrack_data.capacity() * sizeof(BacktrackRecord) + bone_slab.capacity() * sizeof(matrix3x4_t) + sequences.capacity() * sizeof(CIncomingSequence); });
     LevelInit();
 });
 
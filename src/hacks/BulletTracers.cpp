@@ -52,13 +52,12 @@ const char *AppropiateBeam(int team)
 
 const char *GetParticleSystemNameFromIndex__detour(CEffectData &data)
 {
-
-    auto player       = g_IEntityList->GetClientEntityFromHandle(data.m_hEntity);
     auto wantedEffect = GetParticleSystemNameFromIndex_fn(data.m_iEffectId);
-    if (!enable || !player || player->entindex() == -1)
+    // Most effects aren't tracers, don't look anything up for those
+    if (!enable || (data.m_iEffectId != 0xDEADCA7 && !strstr(wantedEffect, "bullet_")))
         return wantedEffect;
-
-    if (!strstr(wantedEffect, "bullet_") && data.m_iEffectId != 0xDEADCA7)
+    auto player = g_IEntityList->GetClientEntityFromHandle(data.m_hEntity);
+    if (!player || player->entindex() == -1)
         return wantedEffect;
 
     // that player is a spy!
@@ -105,6 +104,26 @@ const char *GetParticleSystemNameFromIndex__detour(CEffectData &data)
     return AppropiateBeam(team);
 }
 
+// LookupAttachment searches the studio model by name, so only do it again once the weapon's model changes
+struct muzzle_cache_s
+{
+    const model_t *model{ nullptr };
+    int attachment{ 0 };
+};
+static muzzle_cache_s muzzle_cache[MAX_ENTITIES + 1]{};
+
+static int MuzzleAttachment(IClientEntity *weapon)
+{
+    auto &cached         = muzzle_cache[weapon->entindex()];
+    const model_t *model = weapon->GetModel();
+    if (cached.model != model)
+    {
+        cached.model      = model;
+        cached.attachment = vfunc<LookupAttachment_t>(weapon, 111, 0)(weapon, "muzzle");
+    }
+    return cached.attachment;
+}
+
 IClientEntity *GetActiveTFWeapon_detour(IClientEntity *this_ /* C_TFPlayer * */)
 {
     auto weapon = GetActiveTFWeapon_fn(this_);
@@ -152,8 +171,7 @@ IClientEntity *GetActiveTFWeapon_detour(IClientEntity *this_ /* C_TFPlayer * */)
 
     data.m_hEntity = this_->GetRefEHandle();
 
-    int attachment = vfunc<LookupAttachment_t>(weapon, 111, 0)(weapon, "muzzle");
-    vfunc<GetAttachment_t>(weapon, 113, 0)(weapon, attachment, data.m_vStart);
+    vfunc<GetAttachment_t>(weapon, 113, 0)(weapon, MuzzleAttachment(weapon), data.m_vStart);
 
     if (this_->entindex() == g_pLocalPlayer->entity_idx && g_pLocalPlayer->bZoomed)
         CalcZoomedMuzzleLocation_fn(this_, &g_pLocalPlayer->v_Eye, &data.m_vStart);
@@ -178,7 +196,7 @@ IClientEntity *GetActiveTFWeapon_detour(IClientEntity *this_ /* C_TFPlayer * */)
         forward *= 8192.0f;
         forward += eyePos;
         ray.Init(eyePos, forward);
-        g_ITrace->TraceRay(ray, MASK_SHOT, &trace::filter_default, &trace);
+        trace::TraceRay(ray, MASK_SHOT, &trace::filter_default, &trace);
         data.m_vEnd = trace.endpos;
     }
     data.m_iEffectId = 0xDEADCA7; // handled in other detour
@@ -276,5 +294,8 @@ static InitRoutine init([]() {
             }
         },
         "shutdown_bullettrace");
+    // Model pointers get reused by the next level
+    EC::Register(
+        EC::LevelShutdown, []() { std::fill(std::begin(muzzle_cache), std::end(muzzle_cache), muzzle_cache_s{}); }, "levelshutdown_bullettrace");
 });
 } // namespace hacks::tf2::bullettracers
@@ -14,6 +14,7 @@
 #include "NavBot.hpp"
 #include "navparser.hpp"
 #include "SettingCommands.hpp"
+#include "netmessages.hpp"
 #include "glob.h"
 
 namespace hacks::shared::catbot
@@ -480,51 +481,24 @@ void MvM_Autoupgrade(KeyValues *event)
     }
 }
 
-void SendNetMsg(INetMessage &msg)
+static bool SendNetMsg(net_messages::outgoing_s &message)
 {
-    if (!strcmp(msg.GetName(), "clc_CmdKeyValues"))
-    {
-        if ((KeyValues *) (((unsigned *) &msg)[4]))
-            MvM_Autoupgrade((KeyValues *) (((unsigned *) &msg)[4]));
-    }
+    if ((KeyValues *) (((unsigned *) &message.msg)[4]))
+        MvM_Autoupgrade((KeyValues *) (((unsigned *) &message.msg)[4]));
+    return false;
 }
 
-class CatBotEventListener : public IGameEventListener2
-{
-    void FireGameEvent(IGameEvent *event) override
-    {
-
-        int killer_id = g_IEngine->GetPlayerForUserID(event->GetInt("attacker"));
-        int victim_id = g_IEngine->GetPlayerForUserID(event->GetInt("userid"));
-
-        if (victim_id == g_IEngine->GetLocalPlayer())
-        {
-            on_killed_by(killer_id);
-            return;
-        }
-    }
-};
-
-CatBotEventListener &listener()
+static void OnPlayerDeath(const game_events::event_s &event)
 {
-    static CatBotEventListener object{};
-    return object;
+    if (event.death->victim == g_IEngine->GetLocalPlayer())
+        on_killed_by(event.death->attacker);
 }
 
-class CatBotEventListener2 : public IGameEventListener2
-{
-    void FireGameEvent(IGameEvent *) override
-    {
-        // vote for current map if catbot mode and autovote is on
-        if (catbotmode && autovote_map)
-            g_IEngine->ServerCmd("next_map_vote 0");
-    }
-};
-
-CatBotEventListener2 &listener2()
+static void OnVoteMapsChanged(const game_events::event_s &)
 {
-    static CatBotEventListener2 object{};
-    return object;
+    // vote for current map if catbot mode and autovote is on
+    if (catbotmode && autovote_map)
+        g_IEngine->ServerCmd("next_map_vote 0");
 }
 
 Timer timer_votekicks{};
@@ -621,6 +595,30 @@ CatCommand report_uid("report_steamid", "Report with steamid", [](const CCommand
 });
 
 Timer crouchcdr{};
+// Only the closest few enemies are worth asking, anyone further away gets their turn once the closer ones move
+constexpr int CROUCH_THREATS = 3;
+static Vector crouch_checked_at{};
+
+// An enemy we can't see whose head can see any part of us
+static bool crouchThreat(CachedEntity *ent)
+{
+    // Same hitbox questions the aimbot asks this tick, answered from the visibility cache
+    trace::Batch ours(ent, MASK_SHOT_HULL, false);
+    for (int j = 0; j < 18; j++)
+        ours.AddHitbox(j);
+    if (ours.AnyVisible() != -1)
+        return false;
+    const Vector &head = ent->hitboxes.GetHitbox(0)->center;
+    for (int j = 0; j < 18; j++)
+    {
+        auto box = LOCAL_E->hitboxes.GetHitbox(j);
+        // Check if they see my hitboxes
+        if (box && (IsVectorVisible(head, box->center) || IsVectorVisible(head, box->min) || IsVectorVisible(head, box->max)))
+            return true;
+    }
+    return false;
+}
+
 void smart_crouch()
 {
     if (g_Settings.bInvalid)
@@ -634,34 +632,35 @@ void smart_crouch()
             current_user_cmd->buttons &= ~IN_DUCK;
         return;
     }
-    bool foundtar      = false;
     static bool crouch = false;
-    if (crouchcdr.test_and_set(2000))
+    // Nothing changes for us while we stand still, walking far enough asks again early
+    bool moved = crouch_checked_at.DistToSqr(LOCAL_E->m_vecOrigin()) > 64.0f * 64.0f && crouchcdr.check(250);
+    if (moved || crouchcdr.check(2000))
     {
+        crouchcdr.update();
+        crouch_checked_at = LOCAL_E->m_vecOrigin();
+
+        std::pair<float, CachedEntity *> threats[CROUCH_THREATS];
+        int count = 0;
         for (int i = 0; i <= g_IEngine->GetMaxClients(); i++)
         {
             auto ent = ENTITY(i);
             if (CE_BAD(ent) || ent->m_Type() != ENTITY_PLAYER || ent->m_iTeam() == LOCAL_E->m_iTeam() || !(ent->hitboxes.GetHitbox(0)) || !(ent->m_bAlivePlayer()) || !player_tools::shouldTarget(ent) || should_ignore_player(ent))
                 continue;
-            bool failedvis = false;
-            for (int j = 0; j < 18; j++)
-                if (IsVectorVisible(g_pLocalPlayer->v_Eye, ent->hitboxes.GetHitbox(j)->center))
-                    failedvis = true;
-            if (failedvis)
+            std::pair<float, CachedEntity *> threat{ ent->m_flDistance(), ent };
+            if (count < CROUCH_THREATS)
+                threats[count++] = threat;
+            else if (threat.first < threats[CROUCH_THREATS - 1].first)
+                threats[CROUCH_THREATS - 1] = threat;
+            else
                 continue;
-            for (int j = 0; j < 18; j++)
-            {
-                if (!LOCAL_E->hitboxes.GetHitbox(j))
-                    continue;
-                // Check if they see my hitboxes
-                if (!IsVectorVisible(ent->hitboxes.GetHitbox(0)->center, LOCAL_E->hitboxes.GetHitbox(j)->center) && !IsVectorVisible(ent->hitboxes.GetHitbox(0)->center, LOCAL_E->hitboxes.GetHitbox(j)->min) && !IsVectorVisible(ent->hitboxes.GetHitbox(0)->center, LOCAL_E->hitboxes.GetHitbox(j)->max))
-                    continue;
-                foundtar = true;
-                crouch   = true;
-            }
+            // Keep them sorted, closest first
+            for (int j = count - 1; j > 0 && threats[j].first < threats[j - 1].first; j--)
+                std::swap(threats[j], threats[j - 1]);
         }
-        if (!foundtar && crouch)
-            crouch = false;
+        crouch = false;
+        for (int i = 0; i < count && !crouch; i++)
+            crouch = crouchThreat(threats[i].second);
     }
     if (crouch)
         current_user_cmd->buttons |= IN_DUCK;
@@ -676,8 +675,8 @@ CatCommand print_ammo("debug_print_ammo", "debug", []() {
 });
 static Timer disguise{};
 static Timer report_timer{};
-static std::string health = "Health: 0/0";
-static std::string ammo   = "Ammo: 0/0";
+static char health[64] = "Health: 0/0";
+static char ammo[64]   = "Ammo: 0/0";
 static int max_ammo;
 static CachedEntity *local_w;
 // TODO: add more stuffs
@@ -699,8 +698,8 @@ static void cm()
         int ammo2     = CE_INT(LOCAL_E, netvar.m_iClip1);
         if (ammo0 + ammo2 > max_ammo)
             max_ammo = ammo0 + ammo2;
-        health = format("Health: ", curr_hp, "/", max_hp);
-        ammo   = format("Ammo: ", ammo0 + ammo2, "/", max_ammo);
+        format_to(health, "Health: ", curr_hp, "/", max_hp);
+        format_to(ammo, "Ammo: ", ammo0 + ammo2, "/", max_ammo);
     }
     if (g_Settings.bInvalid)
         return;
@@ -912,8 +911,8 @@ void update()
 
 void init()
 {
-    g_IEventManager2->AddListener(&listener(), "player_death", false);
-    g_IEventManager2->AddListener(&listener2(), "vote_maps_changed", false);
+    game_events::Subscribe("player_death", OnPlayerDeath);
+    game_events::Subscribe("vote_maps_changed", OnVoteMapsChanged);
 }
 
 void level_init()
@@ -924,8 +923,6 @@ void level_init()
 
 void shutdown()
 {
-    g_IEventManager2->RemoveListener(&listener());
-    g_IEventManager2->RemoveListener(&listener2());
 }
 
 #if ENABLE_VISUALS
@@ -941,13 +938,14 @@ static void draw()
 #endif
 
 static InitRoutine runinit([]() {
-    EC::Register(EC::CreateMove, cm, "cm_catbot", EC::average);
+    EC::Register(EC::CreateMove, cm, "cm_catbot", catbotmode, EC::average);
     EC::Register(EC::CreateMove, update, "cm2_catbot", EC::average);
     EC::Register(EC::LevelInit, level_init, "levelinit_catbot", EC::average);
     EC::Register(EC::Shutdown, shutdown, "shutdown_catbot", EC::average);
 #if ENABLE_VISUALS
     EC::Register(EC::Draw, draw, "draw_catbot", EC::average);
 #endif
+    net_messages::Subscribe(clc_CmdKeyValues, SendNetMsg);
     init();
 });
 } // namespace hacks::shared::catbot
@@ -17,6 +17,7 @@
 #include "common.hpp"
 #include "ChatCommands.hpp"
 #include "MiscTemporary.hpp"
+#include <core/perfecthash.hpp>
 #include <iostream>
 
 namespace hacks::shared::ChatCommands
@@ -51,36 +52,42 @@ private:
 };
 
 static std::unordered_map<std::string, ChatCommand> commands;
+// Over the keys of commands, rebuilt whenever one gets added
+static perfect_hash<ChatCommand *> lookup;
 
-void handleChatMessage(std::string message, int senderid)
+static void RebuildLookup()
+{
+    std::vector<std::pair<std::string_view, ChatCommand *>> entries;
+    entries.reserve(commands.size());
+    for (auto &command : commands)
+        entries.emplace_back(command.first, &command.second);
+    lookup.Build(std::move(entries));
+}
+
+void handleChatMessage(std::string_view message, int senderid)
 {
     if (!enabled)
         return;
-    logging::Info("%s, %d", message.c_str(), senderid);
+    logging::Info("%.*s, %d", int(message.size()), message.data(), senderid);
 
-    std::string prefix;
+    std::string_view::size_type space_pos = message.find_first_of(" ");
+    std::string_view prefix               = message.substr(0, space_pos);
+    logging::Info("Prefix: %.*s", int(prefix.size()), prefix.data());
+
+    auto ccmd = lookup.Find(prefix);
+    // Check if its a registered command
+    if (!ccmd)
+        return;
+    // Only copied for messages that run something
     std::string all_params;
-    std::string::size_type space_pos = message.find_first_of(" ");
-    if (space_pos == message.npos)
+    if (space_pos != message.npos)
     {
-        prefix     = message;
-        all_params = "";
-    }
-    else
-    {
-        prefix     = message.substr(0, space_pos);
         all_params = message.substr(space_pos + 1);
         ReplaceString(all_params, "'", "`");
         ReplaceString(all_params, "\"", "`");
         ReplaceString(all_params, ";", ",");
     }
-    logging::Info("Prefix: %s", prefix.c_str());
-
-    auto ccmd = commands.find(prefix);
-    // Check if its a registered command
-    if (ccmd == commands.end())
-        return;
-    for (auto cmd : ccmd->second.getCommands())
+    for (auto cmd : (*ccmd)->getCommands())
     {
         player_info_s localinfo{};
         if (!g_IEngine->GetPlayerInfo(g_pLocalPlayer->entity_idx, &localinfo))
@@ -115,6 +122,7 @@ static CatCommand chatcommands_add("chatcommands_add", "chatcommands_add <chat c
 
     logging::Info("%s: %s", prefix.c_str(), command.c_str());
     chatcomamnd.addcommand(command);
+    RebuildLookup();
 });
 
 static CatCommand chatcommands_file("chatcommands_file", "chatcommands_add <chat command> <filename in " + paths::getDataPath() + "/chatcommands>", [](const CCommand &args) {
@@ -132,6 +140,7 @@ static CatCommand chatcommands_file("chatcommands_file", "chatcommands_add <chat
     std::string file = args.Arg(2);
 
     auto &chatcomamnd = commands[prefix];
+    RebuildLookup();
 
     if (!chatcomamnd.readFile(file))
     {
@@ -143,6 +152,7 @@ static CatCommand chatcommands_file("chatcommands_file", "chatcommands_add <chat
 
 static CatCommand chatcommands_reset_all("chatcommands_reset_all", "Clears all chatcommands", [](const CCommand &args) {
     commands.clear();
+    RebuildLookup();
     g_ICvar->ConsoleColorPrintf(MENU_COLOR, "Chat commands cleared!\n");
 });
 
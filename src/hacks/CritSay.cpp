@@ -30,7 +30,7 @@ static std::string lastmsg{};
 
 TextFile file{};
 
-std::string ComposeCritSay(IGameEvent *event)
+std::string ComposeCritSay(const game_events::player_death_s &death)
 {
     const std::vector<std::string> *source = nullptr;
     switch (*critsay_mode)
@@ -46,15 +46,11 @@ std::string ComposeCritSay(IGameEvent *event)
     }
     if (!source || source->empty())
         return "";
-    if (!event)
+    if (!(death.damagebits & (1 << 20)))
         return "";
-    if (!(event->GetInt("damagebits", 0) & (1 << 20)))
+    if (death.attacker_userid == death.victim_userid)
         return "";
-    int vid = event->GetInt("userid");
-    int kid = event->GetInt("attacker");
-    if (kid == vid)
-        return "";
-    if (g_IEngine->GetPlayerForUserID(kid) != g_IEngine->GetLocalPlayer())
+    if (death.attacker != g_IEngine->GetLocalPlayer())
         return "";
     std::string msg = source->at(rand() % source->size());
     //	checks if the killsays.txt file is not 1 line. 100% sure it's going
@@ -63,14 +59,14 @@ std::string ComposeCritSay(IGameEvent *event)
         msg = source->at(rand() % source->size());
     lastmsg = msg;
     player_info_s info{};
-    g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(vid), &info);
+    g_IEngine->GetPlayerInfo(death.victim, &info);
 
     ReplaceSpecials(msg);
-    CachedEntity *ent = ENTITY(g_IEngine->GetPlayerForUserID(vid));
+    CachedEntity *ent = ENTITY(death.victim);
     int clz           = g_pPlayerResource->GetClass(ent);
     ReplaceString(msg, "%class%", tf_classes_killsay[clz]);
     player_info_s infok{};
-    g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(kid), &infok);
+    g_IEngine->GetPlayerInfo(death.attacker, &infok);
     ReplaceString(msg, "%killer%", std::string(infok.name));
     ReplaceString(msg, "%team%", tf_teams_killsay[ent->m_iTeam() - 2]);
     ReplaceString(msg, "%myteam%", tf_teams_killsay[LOCAL_E->m_iTeam() - 2]);
@@ -79,22 +75,19 @@ std::string ComposeCritSay(IGameEvent *event)
     return msg;
 }
 
-class CritSayEventListener : public IGameEventListener2
+static void OnPlayerDeath(const game_events::event_s &event)
 {
-    void FireGameEvent(IGameEvent *event) override
+    if (!critsay_mode)
+        return;
+    std::string message = ComposeCritSay(*event.death);
+    if (!message.empty())
     {
-        if (!critsay_mode)
-            return;
-        std::string message = hacks::shared::critsay::ComposeCritSay(event);
-        if (!message.empty())
-        {
-            int vid                    = event->GetInt("userid");
-            critsay_storage[vid].delay = *delay;
-            critsay_storage[vid].timer.update();
-            critsay_storage[vid].message = message;
-        }
+        int vid                    = event.death->victim_userid;
+        critsay_storage[vid].delay = *delay;
+        critsay_storage[vid].timer.update();
+        critsay_storage[vid].message = message;
     }
-};
+}
 
 static void ProcessCritsay()
 {
@@ -112,8 +105,6 @@ static void ProcessCritsay()
     }
 }
 
-static CritSayEventListener listener{};
-
 void reload()
 {
     file.Load(*filename);
@@ -123,12 +114,11 @@ static CatCommand reload_command("critsay_reload", "Reload critsays", []() { rel
 
 void init()
 {
-    g_IEventManager2->AddListener(&listener, (const char *) "player_death", false);
+    game_events::Subscribe("player_death", OnPlayerDeath);
 }
 
 void shutdown()
 {
-    g_IEventManager2->RemoveListener(&listener);
 }
 
 static InitRoutine runinit([]() {
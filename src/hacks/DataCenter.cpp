@@ -30,8 +30,6 @@ static settings::Boolean enable_asia{ "dc.toggle-asia", "false" };
 static settings::Boolean enable_oceania{ "dc.toggle-oceania", "false" };
 static settings::Boolean enable_africa{ "dc.toggle-africa", "false" };
 
-typedef std::array<char, 5> CidStr_t;
-
 struct SteamNetworkingPOPID
 {
     unsigned v;
@@ -44,9 +42,25 @@ struct SteamNetworkingPOPID
         out[3] = char(v >> 24);
         out[4] = 0;
     }
+    /* Inverse of ToString, code must be at most 4 characters */
+    static unsigned FromString(const char *code)
+    {
+        unsigned char c[4]{};
+        for (int i = 0; i < 4 && code[i]; i++)
+            c[i] = code[i];
+        return unsigned(c[0]) << 16 | unsigned(c[1]) << 8 | unsigned(c[2]) | unsigned(c[3]) << 24;
+    }
 };
 
-static std::set<CidStr_t> regionsSet;
+/* Preferred POPs as sorted ids, so the ping hook never has to touch a string */
+struct pop_table_s
+{
+    std::vector<unsigned> preferred;
+};
+/* Swapped in whole whenever the regions change, whoever asks for a ping always sees a complete table */
+static std::atomic<const pop_table_s *> pop_table{ nullptr };
+/* Old tables stay around, the regions only change a handful of times per session */
+static std::vector<std::unique_ptr<pop_table_s>> pop_tables;
 
 static void *g_ISteamNetworkingUtils;
 
@@ -86,12 +100,12 @@ static std::map<std::string, std::string> dc_name_map{
     {"vie", "Vienna"},
     {"waw", "Warsaw"}};
 // clang-format on
-static std::vector<std::string> eu_datacenters            = { { "ams" }, { "fra" }, { "lhr" }, { "mad" }, { "par" }, { "sto" }, { "sto2" }, { "waw" }, { "lux" }, { "lux1" }, { "lux2" } };
-static std::vector<std::string> north_america_datacenters = { { "atl" }, { "eat" }, { "mwh" }, { "iad" }, { "lax" }, { "okc" }, { "ord" }, { "sea" } };
-static std::vector<std::string> south_america_datacenters = { { "gru" }, { "lim" }, { "scl" } };
-static std::vector<std::string> asia_datacenters          = { { "bom" }, { "dxb" }, { "gnrt" }, { "hkg" }, { "maa" }, { "man" }, { "sgp" }, { "tyo" }, { "tyo2" }, { "tyo1" } };
-static std::vector<std::string> oceana_datacenters        = { { "syd" }, { "vie" } };
-static std::vector<std::string> africa_datacenters        = { { "jnb" } };
+static const std::vector<std::string> eu_datacenters            = { { "ams" }, { "fra" }, { "lhr" }, { "mad" }, { "par" }, { "sto" }, { "sto2" }, { "waw" }, { "lux" }, { "lux1" }, { "lux2" } };
+static const std::vector<std::string> north_america_datacenters = { { "atl" }, { "eat" }, { "mwh" }, { "iad" }, { "lax" }, { "okc" }, { "ord" }, { "sea" } };
+static const std::vector<std::string> south_america_datacenters = { { "gru" }, { "lim" }, { "scl" } };
+static const std::vector<std::string> asia_datacenters          = { { "bom" }, { "dxb" }, { "gnrt" }, { "hkg" }, { "maa" }, { "man" }, { "sgp" }, { "tyo" }, { "tyo2" }, { "tyo1" } };
+static const std::vector<std::string> oceana_datacenters        = { { "syd" }, { "vie" } };
+static const std::vector<std::string> africa_datacenters        = { { "jnb" } };
 
 static CatCommand print("dc_print", "Print codes of all available data centers", []() {
     static auto GetPOPCount = *(int (**)(void *))(*(uintptr_t *) g_ISteamNetworkingUtils + 37);
@@ -133,9 +147,7 @@ static CatCommand force_refersh("dc_refresh", "Force refresh of ping data", Refr
 
 static void OnRegionsUpdate(std::string regions)
 {
-    CidStr_t region;
-
-    regionsSet.clear();
+    auto table = std::make_unique<pop_table_s>();
 
     std::vector<std::string> regions_vec;
     boost::split(regions_vec, regions, boost::is_any_of(","));
@@ -148,10 +160,12 @@ static void OnRegionsUpdate(std::string regions)
             logging::Info("Ignoring invalid region %s", region_str.c_str());
             continue;
         }
-        region.fill(0);
-        std::strcpy(region.data(), region_str.c_str());
-        regionsSet.emplace(region);
+        table->preferred.push_back(SteamNetworkingPOPID::FromString(region_str.c_str()));
     }
+    std::sort(table->preferred.begin(), table->preferred.end());
+    table->preferred.erase(std::unique(table->preferred.begin(), table->preferred.end()), table->preferred.end());
+    pop_table.store(table.get(), std::memory_order_release);
+    pop_tables.push_back(std::move(table));
     if (*enable)
         Refresh();
 }
@@ -159,14 +173,12 @@ static void OnRegionsUpdate(std::string regions)
 static int (*o_GetDirectPingToPOP)(void *self, SteamNetworkingPOPID cid);
 static int h_GetDirectPingToPOP(void *self, SteamNetworkingPOPID cid)
 {
-    CidStr_t cidStr;
+    const pop_table_s *table = pop_table.load(std::memory_order_acquire);
 
-    if (regionsSet.empty())
+    if (!table || table->preferred.empty())
         return UniformRandomInt(5, 30);
 
-    cid.ToString(cidStr.data());
-    auto it = regionsSet.find(cidStr);
-    if (it != regionsSet.end())
+    if (std::binary_search(table->preferred.begin(), table->preferred.end(), cid.v))
         return UniformRandomInt(5, 30);
 
     return *restrict ? UniformRandomInt(500, 800) : o_GetDirectPingToPOP(self, cid);
@@ -189,7 +201,7 @@ static void Hook(bool on)
 }
 
 // if add is false it will remove instead
-void manageRegions(std::vector<std::string> regions_vec, bool add)
+void manageRegions(const std::vector<std::string> &regions_vec, bool add)
 {
     std::set<std::string> regions_split;
     if ((*regions).length())
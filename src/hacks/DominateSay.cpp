@@ -49,7 +49,7 @@ std::string ComposeDominateSay(IGameEvent *event)
     int dnum = event->GetInt("dominations");
 
     //	this is actually impossible but just in case.
-    if (g_IEngine->GetPlayerForUserID(kid) != g_IEngine->GetLocalPlayer())
+    if (entity_cache::IndexForUserID(kid) != g_IEngine->GetLocalPlayer())
         return "";
 
     std::string msg = source->at(rand() % source->size());
@@ -59,15 +59,15 @@ std::string ComposeDominateSay(IGameEvent *event)
     lastmsg = msg;
     player_info_s info{};
 
-    g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(vid), &info);
+    g_IEngine->GetPlayerInfo(entity_cache::IndexForUserID(vid), &info);
     ReplaceSpecials(msg);
 
-    CachedEntity *ent = ENTITY(g_IEngine->GetPlayerForUserID(vid));
+    CachedEntity *ent = ENTITY(entity_cache::IndexForUserID(vid));
     int clz           = g_pPlayerResource->GetClass(ent);
 
     ReplaceString(msg, "%class%", tf_classes_dominatesay[clz]);
     player_info_s infok{};
-    g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(kid), &infok);
+    g_IEngine->GetPlayerInfo(entity_cache::IndexForUserID(kid), &infok);
 
     ReplaceString(msg, "%dominum%", std::to_string(dnum));
     ReplaceString(msg, "%killer%", std::string(infok.name));
@@ -78,19 +78,14 @@ std::string ComposeDominateSay(IGameEvent *event)
     return msg;
 }
 
-class DominateSayEventListener : public IGameEventListener2
+static void OnPlayerDomination(const game_events::event_s &event)
 {
-    void FireGameEvent(IGameEvent *event) override
-    {
-        if (!dominatesay_mode)
-            return;
-        std::string message = hacks::shared::dominatesay::ComposeDominateSay(event);
-        if (!message.empty())
-            chat_stack::Say(message, false);
-    }
-};
-
-static DominateSayEventListener listener{};
+    if (!dominatesay_mode)
+        return;
+    std::string message = ComposeDominateSay(event.raw);
+    if (!message.empty())
+        chat_stack::Say(message, false);
+}
 
 void reload()
 {
@@ -99,12 +94,11 @@ void reload()
 
 void init()
 {
-    g_IEventManager2->AddListener(&listener, (const char *) "player_domination", false);
+    game_events::Subscribe("player_domination", OnPlayerDomination);
 }
 
 void shutdown()
 {
-    g_IEventManager2->RemoveListener(&listener);
 }
 
 static CatCommand reload_command("dominatesay_reload", "Reload dominatesays", []() { reload(); });
@@ -5,11 +5,14 @@
  *      Author: nullifiedcat
  */
 
+#include <atomic>
 #include <hacks/ESP.hpp>
 #include <PlayerTools.hpp>
+#include "memtrack.hpp"
 #include <settings/Bool.hpp>
 #include "common.hpp"
 #include "soundcache.hpp"
+#include "governor.hpp"
 
 namespace hacks::shared::esp
 {
@@ -78,13 +81,40 @@ static settings::Boolean entity_info{ "esp.debug.entity", "false" };
 static settings::Boolean entity_model{ "esp.debug.model", "false" };
 static settings::Boolean entity_id{ "esp.debug.id", "true" };
 
-// Unknown
-std::mutex threadsafe_mutex;
-// Storage array for keeping strings and other data
+// Storage array for keeping strings and other data, only touched by CreateMove
 std::array<ESPData, 2048> data;
 // Storage vars for entities that need to be re-drawn
 std::vector<std::pair<int, float>> entities_need_repaint{};
-std::mutex entities_need_repaint_mutex{};
+
+// What Draw renders. CreateMove fills one frame and publishes it, Draw always takes the newest complete one.
+// Three of them so neither side ever waits, the middle one is swapped atomically
+struct esp_frame_s
+{
+    std::vector<std::pair<int, float>> entities_need_repaint;
+    // Same order as entities_need_repaint
+    std::vector<ESPData> entity_data;
+};
+static std::array<esp_frame_s, 3> frames{};
+// Index of the newest published frame, FRAME_FRESH stays set until Draw took it
+constexpr int FRAME_FRESH = 4;
+static std::atomic<int> published_frame{ 0 };
+// Owned by CreateMove
+static int write_frame = 1;
+// Owned by Draw
+static int read_frame = 2;
+
+static void Publish()
+{
+    auto &frame                 = frames[write_frame];
+    frame.entities_need_repaint = entities_need_repaint;
+    frame.entity_data.resize(entities_need_repaint.size());
+    for (size_t i = 0; i < entities_need_repaint.size(); i++)
+        frame.entity_data[i] = data[entities_need_repaint[i].first];
+    write_frame = published_frame.exchange(write_frame | FRAME_FRESH) & ~FRAME_FRESH;
+}
+
+// Draw only, measured widths of centered strings and the revision they belong to
+static std::array<std::array<std::pair<uint32_t, float>, 16>, 2048> string_widths{};
 
 // :b:one stuff needs to be up here as puting it in the header for sorting would
 // be a pain.
@@ -152,68 +182,57 @@ struct bonelist_s
         setup = true;
     }
 
-    void _FASTCALL DrawBoneList(const matrix3x4_t *bones, int *in, int size, const rgba_t &color)
-    {
-        Vector last_screen;
-        Vector current_screen;
-        for (int i = 0; i < size; i++)
-        {
-            const auto &bone = bones[in[i]];
-            Vector position(bone[0][3], bone[1][3], bone[2][3]);
-            if (!draw::WorldToScreen(position, current_screen))
-            {
-                return;
-            }
-            if (i > 0)
-            {
-                draw::Line(last_screen.x, last_screen.y, current_screen.x - last_screen.x, current_screen.y - last_screen.y, color, 0.5f);
-            }
-            last_screen = current_screen;
-        }
-    }
-
     void _FASTCALL Draw(CachedEntity *ent, const rgba_t &color)
     {
-        const model_t *model = RAW_ENT(ent)->GetModel();
-        if (not model)
-        {
-            return;
-        }
-
-        studiohdr_t *hdr = g_IModelInfo->GetStudiomodel(model);
-
-        if (!setup)
-        {
-            Setup(hdr);
-        }
         if (!success)
             return;
+        // Painting never sets bones up itself, only what CreateMove did this tick gets drawn
+        const matrix3x4_t *bones = ent->hitboxes.PreparedBones();
+        if (!bones)
+            return;
 
-        // ent->m_bBonesSetup = false;
-        const auto &bones = ent->hitboxes.GetBones();
-        DrawBoneList(bones, leg_r, 3, color);
-        DrawBoneList(bones, leg_l, 3, color);
-        DrawBoneList(bones, bottom, 3, color);
-        DrawBoneList(bones, spine, 7, color);
-        DrawBoneList(bones, arm_r, 3, color);
-        DrawBoneList(bones, arm_l, 3, color);
-        DrawBoneList(bones, up, 3, color);
-        /*for (int i = 0; i < hdr->numbones; i++) {
-            const auto& bone = ent->GetBones()[i];
-            Vector pos(bone[0][3], bone[1][3], bone[2][3]);
-            //pos += orig;
-            Vector screen;
-            if (draw::WorldToScreen(pos, screen)) {
-                if (hdr->pBone(i)->pszName()) {
-                    draw::FString(fonts::ESP, screen.x, screen.y, fg, 2, "%s
-        [%d]", hdr->pBone(i)->pszName(), i); } else draw::FString(fonts::ESP,
-        screen.x, screen.y, fg, 2, "%d", i);
+        constexpr int CHAINS           = 7;
+        constexpr int JOINTS           = 25;
+        const int *chains[CHAINS]      = { leg_r, leg_l, bottom, spine, arm_r, arm_l, up };
+        const int chain_length[CHAINS] = { 3, 3, 3, 7, 3, 3, 3 };
+        Vector world[JOINTS], screen[JOINTS];
+        uint8_t visible[JOINTS];
+        // Every joint but the first of a chain starts a segment
+        uint8_t pairs[(JOINTS - CHAINS) * 2];
+        int joints = 0, segments = 0;
+        for (int chain = 0; chain < CHAINS; chain++)
+            for (int i = 0; i < chain_length[chain]; i++)
+            {
+                const auto &bone = bones[chains[chain][i]];
+                world[joints].Init(bone[0][3], bone[1][3], bone[2][3]);
+                joints++;
             }
-        }*/
+        draw::WorldToScreenBatch(world, JOINTS, screen, visible);
+        joints = 0;
+        for (int chain = 0; chain < CHAINS; chain++)
+        {
+            for (int i = 1; i < chain_length[chain]; i++)
+            {
+                int joint = joints + i;
+                if (!visible[joint - 1] || !visible[joint])
+                    continue;
+                pairs[segments * 2]     = joint - 1;
+                pairs[segments * 2 + 1] = joint;
+                segments++;
+            }
+            joints += chain_length[chain];
+        }
+        draw::Lines(screen, pairs, segments, color, 0.5f);
     }
 };
 std::unordered_map<studiohdr_t *, bonelist_s> bonelist_map{};
 
+// Key for AddEntityStringFormat out of two values
+static uint64_t StringKey(uint32_t high, uint32_t low)
+{
+    return (uint64_t) high << 32 | low;
+}
+
 // These are strings that never change and should only be constructed once
 const std::string hoovy_str                = "Hoovy";
 const std::string dormant_str              = "*Dormant*";
@@ -233,7 +252,6 @@ const std::string invulnerable_str         = "*Invulnerable*";
 const std::string ready_ringer_str         = "*Dead Ringer Out*";
 const std::string cloaked_str              = "*Cloak*";
 const std::string in_ringer_str            = "*Dead Ringer*";
-const std::string botname_str              = "Bot #";
 const std::string tp_ready_str             = "Ready";
 const std::string sapped_str               = "*Sapped*";
 const std::string teleporter_str           = "Teleporter";
@@ -286,10 +304,13 @@ static void Draw()
     if (!enable)
         return;
     PROF_SECTION(DRAW_ESP_PERFORMANCE);
-    std::lock_guard<std::mutex> esp_lock(threadsafe_mutex);
-    for (auto &i : entities_need_repaint)
+    if (published_frame.load() & FRAME_FRESH)
+        read_frame = published_frame.exchange(read_frame) & ~FRAME_FRESH;
+    auto &frame = frames[read_frame];
+    for (size_t j = 0; j < frame.entities_need_repaint.size(); j++)
     {
-        ProcessEntityPT(ENTITY(i.first));
+        auto &i = frame.entities_need_repaint[j];
+        ProcessEntityPT(ENTITY(i.first), frame.entity_data[j]);
 #ifndef FEATURE_EMOJI_ESP_DISABLED
         emoji(ENTITY(i.first));
 #endif
@@ -305,17 +326,16 @@ static void cm()
     if (CE_BAD(LOCAL_E))
         return;
     PROF_SECTION(DRAW_CM_PERFORMANCE);
-    // Something
-    std::lock_guard<std::mutex> esp_lock(threadsafe_mutex);
 
     ResetEntityStrings();          // Clear any strings entities have
     entities_need_repaint.clear(); // Clear data on entities that need redraw
     int max_clients = g_IEngine->GetMaxClients();
     int limit       = HIGHEST_ENTITY;
+    bool extras     = (proj_esp || item_esp) && !governor::Degraded(governor::NO_ESP_EXTRAS);
 
     // If not using any other special esp, we lower the min to the max
     // clients
-    if (!buildings && !proj_esp && !item_esp)
+    if (!buildings && !extras)
         limit = std::min(max_clients, HIGHEST_ENTITY);
 
     { // Prof section ends when out of scope, these brackets here.
@@ -327,6 +347,8 @@ static void cm()
             CachedEntity *ent = ENTITY(i);
             if (CE_INVALID(ent) || !ent->m_bAlivePlayer())
                 continue;
+            if (!extras && i > max_clients && ent->m_Type() != ENTITY_BUILDING)
+                continue;
             ProcessEntity(ent);
             // Update Bones
             if (i <= MAX_PLAYERS)
@@ -348,7 +370,8 @@ static void cm()
                 // If snow distance, add string here
                 if (show_distance)
                 {
-                    AddEntityString(ent, format((int) ENTITY(i)->m_flDistance() / 64 * 1.22f, 'm'));
+                    int meters = (int) ENTITY(i)->m_flDistance() / 64 * 1.22f;
+                    AddEntityStringFormat(ent, meters, colors::empty, "%dm", meters);
                 }
             }
             // No idea, this is confusing
@@ -438,7 +461,7 @@ void _FASTCALL emoji(CachedEntity *ent)
     }
 }
 // Used when processing entitys with cached data from createmove in draw
-void _FASTCALL ProcessEntityPT(CachedEntity *ent)
+void _FASTCALL ProcessEntityPT(CachedEntity *ent, ESPData &ent_data)
 {
     PROF_SECTION(PT_esp_process_entity);
 
@@ -456,8 +479,6 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
 
     int classid     = ent->m_iClassID();
     EntityType type = ent->m_Type();
-    // Grab esp data
-    ESPData &ent_data = data[ent->m_IDX];
 
     // Get color of entity
     // TODO, check if we can move this after world to screen check
@@ -536,7 +557,7 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
             Ray_t ray;
             ray.Init(eye_position, forward);
             trace_t trace;
-            g_ITrace->TraceRay(ray, MASK_SOLID, &trace::filter_no_player, &trace);
+            trace::TraceRay(ray, MASK_SOLID, &trace::filter_no_player, &trace);
 
             // Screen vectors
             Vector scn1, scn2;
@@ -626,7 +647,7 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
                 fg.b *= 0.75f;
             }
             if (!box_3d_player && box_esp)
-                DrawBox(ent, fg);
+                DrawBox(ent, fg, ent_data);
             else if (box_3d_player)
                 Draw3DBox(ent, fg);
             break;
@@ -686,7 +707,7 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
                     draw::Triangle(screen[0].x, screen[0].y, screen[1].x, screen[1].y, screen[2].x, screen[2].y, fg);
             }
             if (!box_3d_building && box_esp)
-                DrawBox(ent, fg);
+                DrawBox(ent, fg, ent_data);
             else if (box_3d_building)
                 Draw3DBox(ent, fg);
             break;
@@ -701,13 +722,15 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
         if (transparent)
             bone_color = colors::Transparent(bone_color);
 
-        bonelist_s bl;
-        if (!CE_INVALID(ent) && ent->m_bAlivePlayer() && !RAW_ENT(ent)->IsDormant() && LOCAL_E->m_bAlivePlayer())
+        const model_t *model = RAW_ENT(ent)->GetModel();
+        if (model && !CE_INVALID(ent) && ent->m_bAlivePlayer() && !RAW_ENT(ent)->IsDormant() && LOCAL_E->m_bAlivePlayer())
         {
-            if (bones_color)
-                bl.Draw(ent, bone_color);
-            else
-                bl.Draw(ent, colors::white);
+            // Bone names are looked up once per model, not every frame
+            studiohdr_t *hdr = g_IModelInfo->GetStudiomodel(model);
+            bonelist_s &bl   = bonelist_map[hdr];
+            if (!bl.setup)
+                bl.Setup(hdr);
+            bl.Draw(ent, bones_color ? bone_color : colors::white);
         }
     }
 
@@ -720,7 +743,7 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
         {
 
             // Get collidable from the cache
-            if (GetCollide(ent))
+            if (GetCollide(ent, ent_data))
             {
 
                 // Pull the cached collide info
@@ -766,7 +789,7 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
         {
 
             // Get collidable from the cache
-            if (GetCollide(ent))
+            if (GetCollide(ent, ent_data))
             {
 
                 // Pull the cached collide info
@@ -812,7 +835,7 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
         {
 
             // Get collidable from the cache
-            if (GetCollide(ent))
+            if (GetCollide(ent, ent_data))
             {
 
                 // Pull the cached collide info
@@ -863,7 +886,7 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
         {
 
             // Get collidable from the cache
-            if (GetCollide(ent))
+            if (GetCollide(ent, ent_data))
             {
 
                 // Origin could change so we set to false
@@ -932,11 +955,16 @@ void _FASTCALL ProcessEntityPT(CachedEntity *ent)
                 // Above/Below text should be centered
                 if (*esp_text_position == 3 || *esp_text_position == 4)
                 {
-                    float w, h;
-                    fonts::esp->stringSize(string.data, &w, &h);
-                    draw_pointx_tmp -= w / 2.0f;
+                    auto &width = string_widths[ent->m_IDX][j];
+                    if (width.first != string.revision)
+                    {
+                        float h;
+                        fonts::esp->stringSize(string.data, &width.second, &h);
+                        width.first = string.revision;
+                    }
+                    draw_pointx_tmp -= width.second / 2.0f;
                 }
-                draw::String(draw_pointx_tmp, draw_point.y, color, string.data.c_str(), *fonts::esp);
+                draw::String(draw_pointx_tmp, draw_point.y, color, string.data, *fonts::esp);
             }
             else
             { /*
@@ -1019,16 +1047,16 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
     // Entity esp
     if (entity_info)
     {
-        AddEntityString(ent, format(RAW_ENT(ent)->GetClientClass()->m_pNetworkName, " [", classid, "]"));
+        AddEntityStringFormat(ent, classid, colors::empty, "%s [%d]", RAW_ENT(ent)->GetClientClass()->m_pNetworkName, classid);
         if (entity_id)
         {
-            AddEntityString(ent, std::to_string(ent->m_IDX));
+            AddEntityStringFormat(ent, ent->m_IDX, colors::empty, "%d", ent->m_IDX);
         }
         if (entity_model)
         {
             const model_t *model = RAW_ENT(ent)->GetModel();
             if (model)
-                AddEntityString(ent, std::string(g_IModelInfo->GetModelName(model)));
+                AddEntityString(ent, g_IModelInfo->GetModelName(model));
         }
     }
 
@@ -1162,7 +1190,7 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
         // Dropped weapon esp
         if (item_dropped_weapons && classid == CL_CLASS(CTFDroppedWeapon))
         {
-            AddEntityString(ent, std::string("Dropped Weapon"));
+            AddEntityString(ent, "Dropped Weapon");
         }
         // Gargoyle esp
         else if (item_gargoyle && classid == CL_CLASS(CHalloweenGiftPickup))
@@ -1229,13 +1257,13 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
             }
             else if (item_powerups && itemtype >= ITEM_POWERUP_FIRST && itemtype <= ITEM_POWERUP_LAST)
             {
-                AddEntityString(ent, std::string(powerups[itemtype - ITEM_POWERUP_FIRST]));
+                AddEntityString(ent, powerups[itemtype - ITEM_POWERUP_FIRST]);
 
                 // TF2C weapon spawner esp
             }
             else if (item_weapon_spawners && itemtype >= ITEM_TF2C_W_FIRST && itemtype <= ITEM_TF2C_W_LAST)
             {
-                AddEntityString(ent, std::string(tf2c_weapon_names[itemtype - ITEM_TF2C_W_FIRST]) + " Spawner");
+                AddEntityStringFormat(ent, itemtype, colors::empty, "%s Spawner", tf2c_weapon_names[itemtype - ITEM_TF2C_W_FIRST].c_str());
                 if (CE_BYTE(ent, netvar.bRespawning))
                     AddEntityString(ent, tf2c_spawner_respawn_str);
             }
@@ -1296,9 +1324,9 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
             bool IsMini             = CE_BYTE(ent, netvar.m_bMiniBuilding);
             bool IsSapped           = CE_BYTE(ent, netvar.m_bHasSapper);
             if (!IsMini)
-                AddEntityString(ent, format("Level ", level, ' ', name));
+                AddEntityStringFormat(ent, StringKey(classid, level), colors::empty, "Level %d %s", level, name.c_str());
             else
-                AddEntityString(ent, std::string("Mini ") + name);
+                AddEntityStringFormat(ent, classid, colors::empty, "Mini %s", name.c_str());
             if (IsSapped)
                 AddEntityString(ent, sapped_str);
             if (classid == CL_CLASS(CObjectTeleporter))
@@ -1307,17 +1335,18 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
                 float yaw_to_exit   = CE_FLOAT(ent, netvar.m_flTeleYawToExit);
                 if (yaw_to_exit)
                 {
-                    if (next_teleport < g_GlobalVars->curtime)
+                    float recharge = next_teleport - g_GlobalVars->curtime;
+                    if (recharge < 0.0f)
                         AddEntityString(ent, tp_ready_str);
                     else
-                        AddEntityString(ent, std::to_string(next_teleport - g_GlobalVars->curtime) + "s");
+                        AddEntityStringFormat(ent, (int) (recharge * 1000000.0f), colors::empty, "%fs", recharge);
                 }
             }
         }
         // If text health is true, then add a string with the health
         if (show_health)
         {
-            AddEntityString(ent, format(ent->m_iHealth(), '/', ent->m_iMaxHealth(), " HP"), colors::Health(ent->m_iHealth(), ent->m_iMaxHealth()));
+            AddEntityStringFormat(ent, StringKey(ent->m_iHealth(), ent->m_iMaxHealth()), colors::Health(ent->m_iHealth(), ent->m_iMaxHealth()), "%d/%d HP", ent->m_iHealth(), ent->m_iMaxHealth());
         }
         // Set the entity to repaint
         espdata.needs_paint = true;
@@ -1359,14 +1388,14 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
         {
             powerup_type power = GetPowerupOnPlayer(ent);
             if (power != not_powerup)
-                AddEntityString(ent, std::string("^ ") + powerups[power] + " ^");
+                AddEntityStringFormat(ent, power, colors::empty, "^ %s ^", powerups[power]);
         }
 
         if (ent->m_bEnemy() || teammates || player_tools::shouldAlwaysRenderEsp(ent))
         {
             // Playername
             if (show_name)
-                AddEntityString(ent, std::string(info.name));
+                AddEntityString(ent, info.name);
 
             // Player class
             if (show_class)
@@ -1383,7 +1412,7 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
                 {
                     if (!ipc::peer->memory->peer_data[i].free && ipc::peer->memory->peer_user_data[i].friendid == info.friendsID)
                     {
-                        AddEntityString(ent, botname_str + std::to_string(i));
+                        AddEntityStringFormat(ent, i, colors::empty, "Bot #%d", i);
                         break;
                     }
                 }
@@ -1394,7 +1423,7 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
             {
                 int health     = g_pPlayerResource->GetHealth(ent);
                 int max_health = g_pPlayerResource->GetMaxHealth(ent);
-                AddEntityString(ent, format(health, '/', max_health, " HP"), colors::Health(health, max_health));
+                AddEntityStringFormat(ent, StringKey(health, max_health), colors::Health(health, max_health), "%d/%d HP", health, max_health);
             }
             IF_GAME(IsTF())
             {
@@ -1413,14 +1442,15 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
                                 CachedEntity *weapon = ENTITY(eid);
                                 if (!CE_INVALID(weapon) && weapon->m_iClassID() == CL_CLASS(CWeaponMedigun) && weapon)
                                 {
-                                    std::string charge = std::to_string((int) floor(CE_FLOAT(weapon, netvar.m_flChargeLevel) * 100));
+                                    float charge_level = CE_FLOAT(weapon, netvar.m_flChargeLevel);
+                                    int charge         = floor(charge_level * 100);
 
                                     if (CE_INT(weapon, netvar.iItemDefinitionIndex) != 998)
                                     {
-                                        AddEntityString(ent, charge + "% Uber", colors::Health(floor(CE_FLOAT(weapon, netvar.m_flChargeLevel) * 100), 100));
+                                        AddEntityStringFormat(ent, charge, colors::Health(charge, 100), "%d%% Uber", charge);
                                     }
                                     else
-                                        AddEntityString(ent, charge + "% Uber | Charges: " + std::to_string(floor(CE_FLOAT(weapon, netvar.m_flChargeLevel) / 0.25f)), colors::Health((CE_FLOAT(weapon, netvar.m_flChargeLevel) * 100), 100));
+                                        AddEntityStringFormat(ent, StringKey(1, charge), colors::Health((charge_level * 100), 100), "%d%% Uber | Charges: %f", charge, floor(charge_level / 0.25f));
                                     break;
                                 }
                             }
@@ -1519,7 +1549,7 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
 
                         const char *weapon_name = re::C_BaseCombatWeapon::GetPrintName(RAW_ENT(weapon));
                         if (weapon_name)
-                            AddEntityString(ent, std::string(weapon_name));
+                            AddEntityString(ent, weapon_name);
                     }
                 }
             }
@@ -1531,6 +1561,72 @@ void _FASTCALL ProcessEntity(CachedEntity *ent)
     }
 }
 
+// Collision box corners relative to the collision origin. The box only changes with the model, its scale and ducking,
+// so every entity sharing those shares one set of corners
+struct box_key_s
+{
+    const model_t *model;
+    float scale;
+    uint8_t state;
+    bool operator==(const box_key_s &other) const
+    {
+        return model == other.model && scale == other.scale && state == other.state;
+    }
+};
+struct box_corners_s
+{
+    Vector corners[8];
+    // Spread by esp.expand for the 2D boxes
+    Vector expanded[8];
+    float expanded_by;
+};
+static std::vector<box_key_s> box_keys;
+static std::vector<box_corners_s> box_corners;
+
+// Corners in the order the box drawing expects, bottom face first
+static void MakeCorners(const Vector &mins, const Vector &maxs, Vector (&corners)[8])
+{
+    corners[0] = mins;
+    corners[1] = Vector(maxs.x, mins.y, mins.z);
+    corners[2] = Vector(maxs.x, maxs.y, mins.z);
+    corners[3] = Vector(mins.x, maxs.y, mins.z);
+    corners[4] = Vector(mins.x, mins.y, maxs.z);
+    corners[5] = Vector(maxs.x, mins.y, maxs.z);
+    corners[6] = maxs;
+    corners[7] = Vector(mins.x, maxs.y, maxs.z);
+}
+
+static const Vector *LocalBox(CachedEntity *ent, bool expand)
+{
+    box_key_s key{ RAW_ENT(ent)->GetModel(), 1.0f, 0 };
+    if (IsTF2())
+        key.scale = CE_FLOAT(ent, netvar.m_flModelScale);
+    if (ent->m_Type() == ENTITY_PLAYER)
+        key.state = CE_INT(ent, netvar.iFlags) & FL_DUCKING ? 1 : 0;
+    else if (ent->m_Type() == ENTITY_BUILDING)
+        key.state = CE_BYTE(ent, netvar.m_bMiniBuilding) ? 2 : 0;
+
+    size_t i = std::find(box_keys.begin(), box_keys.end(), key) - box_keys.begin();
+    if (i == box_keys.size())
+    {
+        auto collideable = RAW_ENT(ent)->GetCollideable();
+        box_keys.push_back(key);
+        box_corners.emplace_back();
+        MakeCorners(collideable->OBBMins(), collideable->OBBMaxs(), box_corners[i].corners);
+        box_corners[i].expanded_by = -1.0f;
+    }
+    box_corners_s &box = box_corners[i];
+    if (!expand)
+        return box.corners;
+    if (box.expanded_by != *esp_expand)
+    {
+        const Vector spread(*esp_expand, *esp_expand, *esp_expand);
+        MakeCorners(box.corners[0] - spread, box.corners[6] + spread, box.expanded);
+        box.expanded_by = *esp_expand;
+    }
+    return box.expanded;
+}
+
 // Draw 3D box around player/building
 void _FASTCALL Draw3DBox(CachedEntity *ent, const rgba_t &clr)
 {
@@ -1538,54 +1634,25 @@ void _FASTCALL Draw3DBox(CachedEntity *ent, const rgba_t &clr)
         return;
 
     Vector origin = RAW_ENT(ent)->GetCollideable()->GetCollisionOrigin();
-    Vector mins   = RAW_ENT(ent)->GetCollideable()->OBBMins();
-    Vector maxs   = RAW_ENT(ent)->GetCollideable()->OBBMaxs();
     // Dormant
     if (RAW_ENT(ent)->IsDormant())
     {
         auto vec = ent->m_vecDormantOrigin();
         if (!vec)
-            origin = *vec;
-        else
             return;
+        origin = *vec;
     }
 
-    // Create a array for storing box points
-    Vector corners[8]; // World vectors
-    Vector points[8];  // Screen vectors
-
-    // Create points for the box based on max and mins
-    float x    = maxs.x - mins.x;
-    float y    = maxs.y - mins.y;
-    float z    = maxs.z - mins.z;
-    corners[0] = mins;
-    corners[1] = mins + Vector(x, 0, 0);
-    corners[2] = mins + Vector(x, y, 0);
-    corners[3] = mins + Vector(0, y, 0);
-    corners[4] = mins + Vector(0, 0, z);
-    corners[5] = mins + Vector(x, 0, z);
-    corners[6] = mins + Vector(x, y, z);
-    corners[7] = mins + Vector(0, y, z);
-
-    // Rotate the box and check if any point of the box isnt on the screen
-    bool success = true;
-    for (int i = 0; i < 8; i++)
-    {
-        float yaw    = NET_VECTOR(RAW_ENT(ent), netvar.m_angEyeAngles).y;
-        float s      = sinf(DEG2RAD(yaw));
-        float c      = cosf(DEG2RAD(yaw));
-        float xx     = corners[i].x;
-        float yy     = corners[i].y;
-        corners[i].x = (xx * c) - (yy * s);
-        corners[i].y = (xx * s) + (yy * c);
-        corners[i] += origin;
-
-        if (!draw::WorldToScreen(corners[i], points[i]))
-            success = false;
-    }
+    // Rotate the box by the eye yaw, the projection moves the points into place
+    float yaw = NET_VECTOR(RAW_ENT(ent), netvar.m_angEyeAngles).y;
+    float s   = sinf(DEG2RAD(yaw));
+    float c   = cosf(DEG2RAD(yaw));
+    matrix3x4_t transform(Vector(c, s, 0), Vector(-s, c, 0), Vector(0, 0, 1), origin);
 
+    // Screen vectors
+    Vector points[8];
     // Don't continue if a point isn't on the screen
-    if (!success)
+    if (!draw::WorldToScreenBatch(transform, LocalBox(ent, false), 8, points, nullptr))
         return;
 
     rgba_t draw_clr = clr;
@@ -1599,7 +1666,7 @@ void _FASTCALL Draw3DBox(CachedEntity *ent, const rgba_t &clr)
 }
 
 // Draw a box around a player
-void _FASTCALL DrawBox(CachedEntity *ent, const rgba_t &clr)
+void _FASTCALL DrawBox(CachedEntity *ent, const rgba_t &clr, ESPData &ent_data)
 {
     PROF_SECTION(PT_esp_drawbox);
 
@@ -1608,11 +1675,10 @@ void _FASTCALL DrawBox(CachedEntity *ent, const rgba_t &clr)
         return;
 
     // Get our collidable bounds
-    if (!GetCollide(ent))
+    if (!GetCollide(ent, ent_data))
         return;
 
     // Pull the cached collide info
-    ESPData &ent_data = data[ent->m_IDX];
     int max_x         = ent_data.collide_max.x;
     int max_y         = ent_data.collide_max.y;
     int min_x         = ent_data.collide_min.x;
@@ -1669,7 +1735,7 @@ void BoxCorners(int minx, int miny, int maxx, int maxy, const rgba_t &color, boo
 }
 
 // Used for caching collidable bounds
-bool GetCollide(CachedEntity *ent)
+bool GetCollide(CachedEntity *ent, ESPData &ent_data)
 {
     PROF_SECTION(PT_esp_getcollide);
 
@@ -1677,9 +1743,6 @@ bool GetCollide(CachedEntity *ent)
     if (CE_INVALID(ent) || !ent->m_bAlivePlayer())
         return false;
 
-    // Grab esp data
-    ESPData &ent_data = data[ent->m_IDX];
-
     // If entity has cached collides, return it. Otherwise generate new bounds
     if (!ent_data.has_collide)
     {
@@ -1694,47 +1757,12 @@ bool GetCollide(CachedEntity *ent)
                 return false;
             origin = *vec;
         }
-        Vector mins = RAW_ENT(ent)->GetCollideable()->OBBMins() + origin;
-        Vector maxs = RAW_ENT(ent)->GetCollideable()->OBBMaxs() + origin;
-
-        // Create a array for storing box points
-        Vector points_r[8]; // World vectors
-        Vector points[8];   // Screen vectors
-
-        // If user setting for box expnad is true, spread the max and mins
-        if (esp_expand)
-        {
-            const float exp = *esp_expand;
-            maxs.x += exp;
-            maxs.y += exp;
-            maxs.z += exp;
-            mins.x -= exp;
-            mins.y -= exp;
-            mins.z -= exp;
-        }
+        // Screen vectors
+        Vector points[8];
+        matrix3x4_t transform(Vector(1, 0, 0), Vector(0, 1, 0), Vector(0, 0, 1), origin);
 
-        // Create points for the box based on max and mins
-        float x     = maxs.x - mins.x;
-        float y     = maxs.y - mins.y;
-        float z     = maxs.z - mins.z;
-        points_r[0] = mins;
-        points_r[1] = mins + Vector(x, 0, 0);
-        points_r[2] = mins + Vector(x, y, 0);
-        points_r[3] = mins + Vector(0, y, 0);
-        points_r[4] = mins + Vector(0, 0, z);
-        points_r[5] = mins + Vector(x, 0, z);
-        points_r[6] = mins + Vector(x, y, z);
-        points_r[7] = mins + Vector(0, y, z);
-
-        // Check if any point of the box isnt on the screen
-        bool success = true;
-        for (int i = 0; i < 8; i++)
-        {
-            if (!draw::WorldToScreen(points_r[i], points[i]))
-                success = false;
-        }
-        // If a point isnt on the screen, return here
-        if (!success)
+        // If a point of the box isnt on the screen, return here
+        if (!draw::WorldToScreenBatch(transform, LocalBox(ent, true), 8, points, nullptr))
             return false;
 
         // Get max and min of the box using the newly created screen vector
@@ -1771,15 +1799,35 @@ bool GetCollide(CachedEntity *ent)
 }
 
 // Use to add a esp string to an entity
-void AddEntityString(CachedEntity *entity, const std::string &string, const rgba_t &color)
+uint32_t NextStringRevision()
+{
+    static uint32_t revision = 0;
+    return ++revision;
+}
+
+ESPString *NextEntityString(CachedEntity *entity)
 {
     ESPData &entity_data = data[entity->m_IDX];
     if (entity_data.string_count >= 15)
-        return;
-    entity_data.strings[entity_data.string_count].data  = string;
-    entity_data.strings[entity_data.string_count].color = color;
-    entity_data.string_count++;
+        return nullptr;
     entity_data.needs_paint = true;
+    return &entity_data.strings[entity_data.string_count++];
+}
+
+void AddEntityString(CachedEntity *entity, const char *string, const rgba_t &color)
+{
+    ESPString *slot = NextEntityString(entity);
+    if (!slot)
+        return;
+    // Same text as last tick, Draw can keep the width it measured
+    if (slot->format || strncmp(slot->data, string, sizeof(slot->data) - 1))
+    {
+        strncpy(slot->data, string, sizeof(slot->data) - 1);
+        slot->data[sizeof(slot->data) - 1] = '\0';
+        slot->format                       = nullptr;
+        slot->revision                     = NextStringRevision();
+    }
+    slot->color = color;
 }
 
 // Function to reset entitys strings
@@ -1803,8 +1851,25 @@ void SetEntityColor(CachedEntity *entity, const rgba_t &color)
 
 static InitRoutine init([]() {
     EC::Register(EC::CreateMove, cm, "cm_esp", EC::average);
+    // Late so colors other features set this tick make it into the frame
+    EC::Register(EC::CreateMove, Publish, "cm_esp_publish", enable, EC::late);
+    // Model pointers don't survive the level
+    EC::Register(
+        EC::LevelShutdown,
+        []() {
+            box_keys.clear();
+            box_corners.clear();
+            bonelist_map.clear();
+        },
+        "esp_box_cache_shutdown");
+    memtrack::Report(memtrack::tag_esp, []() -> size_t {
+        size_t bytes = entities_need_repaint.capacity() * sizeof(entities_need_repaint[0]);
+        for (auto &frame : frames)
+            bytes += frame.entities_need_repaint.capacity() * sizeof(frame.entities_need_repaint[0]) + frame.entity_data.capacity() * sizeof(ESPData);
+        return bytes;
+    });
 #if ENABLE_VISUALS
-    EC::Register(EC::Draw, Draw, "draw_esp", EC::average);
+    EC::Register(EC::Draw, Draw, "draw_esp", enable, EC::average);
     Init();
 #endif
 });
@@ -21,43 +21,52 @@ namespace hacks::tf2::explosioncircles
 {
 static settings::Boolean enabled("explosionspheres.enabled", "false");
 
+// Every sphere is the same unit mesh, scaled and moved into place
+constexpr int AZIMUTHS      = 20;
+constexpr int STRIP_POINTS  = 11;
+constexpr int SPHERE_POINTS = AZIMUTHS * STRIP_POINTS;
+// Stickies drawn per frame, a demo can't have more than 14 out anyway
+constexpr int MAX_SPHERES = 64;
+
 // too lazy to make my own http://www.cplusplus.com/forum/general/65476/
-void draw_sphere(Vector center, double r, std::vector<Vector> &spherePoints)
+static const std::array<Vector, SPHERE_POINTS> &unit_sphere()
 {
-    Vector screen, screen2;
-    // Iterate through phi, theta then convert r,theta,phi to  XYZ
-    for (double phi = 0.; phi < 2 * PI; phi += PI / 10.) // Azimuth [0, 2PI]
-    {
-        spherePoints.clear();
-        for (double theta = 0.; theta < PI; theta += PI / 10.) // Elevation [0, PI]
-            spherePoints.emplace_back(r * cos(phi) * sin(theta) + center.x, r * sin(phi) * sin(theta) + center.y, r * cos(theta) + center.z);
-        // Add the missing point on the bottom
-        spherePoints.emplace_back(center.x, center.y, center.z - r);
-        int vecsize = spherePoints.size();
-        Vector prev = spherePoints.front();
-        for (int i = 1; i < vecsize; i++)
+    static std::array<Vector, SPHERE_POINTS> points = []() {
+        std::array<Vector, SPHERE_POINTS> out;
+        // Iterate through phi, theta then convert r,theta,phi to  XYZ
+        for (int i = 0; i < AZIMUTHS; i++) // Azimuth [0, 2PI]
         {
-            if (draw::WorldToScreen(prev, screen) && draw::WorldToScreen(spherePoints[i], screen2))
+            double phi = i * PI / 10.;
+            for (int j = 0; j < STRIP_POINTS - 1; j++) // Elevation [0, PI]
             {
-                draw::Line(screen.x, screen.y, screen2.x - screen.x, screen2.y - screen.y, colors::FromRGBA8(255, 120, 0, 50), 2);
+                double theta              = j * PI / 10.;
+                out[i * STRIP_POINTS + j] = Vector(cos(phi) * sin(theta), sin(phi) * sin(theta), cos(theta));
             }
-            prev = spherePoints[i];
+            // Add the missing point on the bottom
+            out[i * STRIP_POINTS + STRIP_POINTS - 1] = Vector(0.0f, 0.0f, -1.0f);
         }
-    }
-    return;
+        return out;
+    }();
+    return points;
 }
 
+static std::array<Vector, MAX_SPHERES * SPHERE_POINTS> world;
+static std::array<Vector, MAX_SPHERES * SPHERE_POINTS> screen;
+static std::array<uint8_t, MAX_SPHERES * SPHERE_POINTS> visible;
+
 void draw()
 {
     if (!enabled)
         return;
     if (!CE_GOOD(LOCAL_E))
         return;
-    std::vector<Vector> points;
-    Vector screen;
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
+    auto &sphere = unit_sphere();
+    int spheres  = 0;
+    Vector origin_screen;
+    for (auto ent : entity_cache::projectiles())
     {
-        auto ent = ENTITY(i);
+        if (spheres == MAX_SPHERES)
+            break;
         if (CE_BAD(ent))
             continue;
         if (!ent->m_bEnemy())
@@ -66,11 +75,31 @@ void draw()
             continue;
         if (CE_INT(ent, netvar.iPipeType) != 1)
             continue;
-        if (!draw::WorldToScreen(ent->m_vecOrigin(), screen))
+        if (!draw::WorldToScreen(ent->m_vecOrigin(), origin_screen))
             continue;
-        draw_sphere(ent->m_vecOrigin(), CE_FLOAT(ent, netvar.m_DmgRadius), points);
+        Vector center = ent->m_vecOrigin();
+        float radius  = CE_FLOAT(ent, netvar.m_DmgRadius);
+        Vector *out   = &world[spheres++ * SPHERE_POINTS];
+        for (int i = 0; i < SPHERE_POINTS; i++)
+            out[i] = sphere[i] * radius + center;
+    }
+    if (!spheres)
+        return;
+
+    // Every point of every sphere is projected in one go
+    draw::WorldToScreenBatch(world.data(), spheres * SPHERE_POINTS, screen.data(), visible.data());
+    for (int strip = 0; strip < spheres * AZIMUTHS; strip++)
+    {
+        int start = strip * STRIP_POINTS;
+        for (int i = start + 1; i < start + STRIP_POINTS; i++)
+        {
+            if (visible[i - 1] && visible[i])
+            {
+                draw::Line(screen[i - 1].x, screen[i - 1].y, screen[i].x - screen[i - 1].x, screen[i].y - screen[i - 1].y, colors::FromRGBA8(255, 120, 0, 50), 2);
+            }
+        }
     }
 }
 
-static InitRoutine init([]() { EC::Register(EC::Draw, draw, "draw_explosioncircles"); });
+static InitRoutine init([]() { EC::Register(EC::Draw, draw, "draw_explosioncircles", enabled); });
 } // namespace hacks::tf2::explosioncircles
@@ -13,6 +13,9 @@
 #include "soundcache.hpp"
 #include "playerresource.h"
 #include "PlayerTools.hpp"
+#include "ipcchannel.hpp"
+#include "governor.hpp"
+#include <map>
 
 namespace hacks::shared::followbot
 {
@@ -69,8 +72,88 @@ static CatCommand steam_debug("debug_steamid", "Print steamids", []() {
     }
 });
 
+// Fixed capacity ring of breadcrumbs, oldest first. Crumbs that barely bend the path get folded into their neighbours
+struct crumb_ring
+{
+    static constexpr size_t CAPACITY = 128;
+    // How far a folded crumb may be from the path that replaces it
+    static constexpr float TOLERANCE = 10.0f;
+
+    std::array<Vector, CAPACITY> crumbs;
+    size_t head{ 0 }, count{ 0 };
+    // Crumbs folded into back() since the one before it
+    std::array<Vector, 16> folded;
+    size_t folded_count{ 0 };
+
+    size_t size() const
+    {
+        return count;
+    }
+    bool empty() const
+    {
+        return !count;
+    }
+    Vector &operator[](size_t i)
+    {
+        return crumbs[(head + i) % CAPACITY];
+    }
+    Vector &back()
+    {
+        return (*this)[count - 1];
+    }
+    void clear()
+    {
+        head = count  = 0;
+        folded_count = 0;
+    }
+    void pop_front(size_t amount = 1)
+    {
+        amount = std::min(amount, count);
+        head   = (head + amount) % CAPACITY;
+        count -= amount;
+        folded_count = 0;
+    }
+    // Drops the oldest crumb when full
+    void push_back(const Vector &crumb)
+    {
+        if (count >= 2 && Fold(crumb))
+            return;
+        if (count == CAPACITY)
+            pop_front();
+        crumbs[(head + count) % CAPACITY] = crumb;
+        count++;
+        folded_count = 0;
+    }
+
+private:
+    static float SegmentDistance(const Vector &point, const Vector &a, const Vector &b)
+    {
+        Vector ab    = b - a;
+        float length = ab.LengthSqr();
+        if (length < 1.0f)
+            return point.DistTo(a);
+        float t = std::clamp((point - a).Dot(ab) / length, 0.0f, 1.0f);
+        return point.DistTo(a + ab * t);
+    }
+    // Replace back() with crumb if back() and everything folded into it stay close to the new segment
+    bool Fold(const Vector &crumb)
+    {
+        if (folded_count == folded.size())
+            return false;
+        Vector &start = (*this)[count - 2];
+        if (SegmentDistance(back(), start, crumb) > TOLERANCE)
+            return false;
+        for (size_t i = 0; i < folded_count; i++)
+            if (SegmentDistance(folded[i], start, crumb) > TOLERANCE)
+                return false;
+        folded[folded_count++] = back();
+        back()                 = crumb;
+        return true;
+    }
+};
+
 // Something to store breadcrumbs created by followed players
-static std::vector<Vector> breadcrumbs;
+static crumb_ring breadcrumbs;
 static constexpr int crumb_limit = 64; // limit
 
 static bool followcart{ false };
@@ -138,58 +221,84 @@ static void init()
     return;
 }
 
-// auto add checked crumbs for the walkbot to follow
+// auto add checked crumbs for the walkbot to follow. Straight lines only need their ends
 static void addCrumbs(CachedEntity *target, Vector corner = g_pLocalPlayer->v_Origin)
 {
     breadcrumbs.clear();
     if (g_pLocalPlayer->v_Origin != corner)
-    {
-        Vector dist       = corner - g_pLocalPlayer->v_Origin;
-        int maxiterations = floor(corner.DistTo(g_pLocalPlayer->v_Origin)) / 40;
-        for (int i = 0; i < maxiterations; i++)
-        {
-            breadcrumbs.push_back(g_pLocalPlayer->v_Origin + dist / vectorMax(vectorAbs(dist)) * 40.0f * (i + 1));
-        }
-    }
-
-    Vector dist       = target->m_vecOrigin() - corner;
-    int maxiterations = floor(corner.DistTo(target->m_vecOrigin())) / 40;
-    for (int i = 0; i < maxiterations; i++)
-    {
-        breadcrumbs.push_back(corner + dist / vectorMax(vectorAbs(dist)) * 40.0f * (i + 1));
-    }
+        breadcrumbs.push_back(corner);
+    breadcrumbs.push_back(target->m_vecOrigin());
 }
 
 static void addCrumbPair(CachedEntity *player1, CachedEntity *player2, std::pair<Vector, Vector> corners)
 {
-    Vector corner1 = corners.first;
-    Vector corner2 = corners.second;
+    breadcrumbs.push_back(corners.first);
+    breadcrumbs.push_back(corners.second);
+    breadcrumbs.push_back(player2->m_vecOrigin());
+}
+
+// Corner and wall solving for a (local cell, target cell) pair, so a target that stays around the same spot isn't
+// traced again every tick
+namespace corner_cache
+{
+constexpr float CELL_SIZE  = 64.0f;
+constexpr unsigned TIMEOUT = 3000;
+constexpr size_t MAX_SIZE  = 256;
+
+struct entry
+{
+    Timer created{};
+    bool corner_done{ false }, wall_done{ false };
+    Vector corner{};
+    std::pair<Vector, Vector> wall{};
+};
+typedef std::array<int, 6> key_t;
+static std::map<key_t, entry> entries;
+
+static entry &Get(CachedEntity *player, CachedEntity *target)
+{
+    auto cell = [](const Vector &v, int *out) {
+        out[0] = int(std::floor(v.x / CELL_SIZE));
+        out[1] = int(std::floor(v.y / CELL_SIZE));
+        out[2] = int(std::floor(v.z / CELL_SIZE));
+    };
+    key_t key;
+    cell(player->m_vecOrigin(), &key[0]);
+    cell(target->m_vecOrigin(), &key[3]);
+    if (entries.size() >= MAX_SIZE)
+        entries.clear();
+    auto &result = entries[key];
+    // New entries start out expired too
+    if (result.created.check(TIMEOUT))
+    {
+        result = entry{};
+        result.created.update();
+    }
+    return result;
+}
 
+static Vector Corner(CachedEntity *player, CachedEntity *target, float maxdist)
+{
+    auto &cached = Get(player, target);
+    if (!cached.corner_done)
     {
-        Vector dist       = corner1 - player1->m_vecOrigin();
-        int maxiterations = floor(corner1.DistTo(player1->m_vecOrigin())) / 40;
-        for (int i = 0; i < maxiterations; i++)
-        {
-            breadcrumbs.push_back(player1->m_vecOrigin() + dist / vectorMax(vectorAbs(dist)) * 40.0f * (i + 1));
-        }
-    }
-    {
-        Vector dist       = corner2 - corner1;
-        int maxiterations = floor(corner2.DistTo(corner1)) / 40;
-        for (int i = 0; i < maxiterations; i++)
-        {
-            breadcrumbs.push_back(corner1 + dist / vectorMax(vectorAbs(dist)) * 40.0f * (i + 1));
-        }
+        cached.corner      = VischeckCorner(player, target, maxdist, true);
+        cached.corner_done = true;
     }
+    return cached.corner;
+}
+
+static std::pair<Vector, Vector> Wall(CachedEntity *player, CachedEntity *target, float maxdist)
+{
+    auto &cached = Get(player, target);
+    if (!cached.wall_done)
     {
-        Vector dist       = player2->m_vecOrigin() - corner2;
-        int maxiterations = floor(corner2.DistTo(player2->m_vecOrigin())) / 40;
-        for (int i = 0; i < maxiterations; i++)
-        {
-            breadcrumbs.push_back(corner2 + dist / vectorMax(vectorAbs(dist)) * 40.0f * (i + 1));
-        }
+        cached.wall      = VischeckWall(player, target, maxdist, true);
+        cached.wall_done = true;
     }
+    return cached.wall;
 }
+} // namespace corner_cache
 /* Order:
  *   No Class = 0,
  *   tf_scout = 1,
@@ -236,14 +345,13 @@ static bool startFollow(CachedEntity *entity, bool useNavbot)
     {
         if (corneractivate)
         {
-            Vector indirectOrigin = VischeckCorner(LOCAL_E, entity, *follow_activation / 2,
-                                                   true); // get the corner location that the
+            Vector indirectOrigin = corner_cache::Corner(LOCAL_E, entity, *follow_activation / 2); // get the corner location that the
             // future target is visible from
             std::pair<Vector, Vector> corners;
             if (!indirectOrigin.z && entity->m_IDX == lastent) // if we couldn't find it, run
             // wallcheck instead
             {
-                corners = VischeckWall(LOCAL_E, entity, float(follow_activation) / 2, true);
+                corners = corner_cache::Wall(LOCAL_E, entity, float(follow_activation) / 2);
                 if (!corners.first.z || !corners.second.z)
                     return false;
                 // addCrumbs(LOCAL_E, corners.first);
@@ -601,18 +709,18 @@ static void cm()
 
     // Prune old and close crumbs that we wont need anymore, update idle
     // timer too
-    for (int i = 0; i < breadcrumbs.size(); i++)
+    for (size_t i = breadcrumbs.size(); i > 0; i--)
     {
-        if (loc_orig.DistTo(breadcrumbs.at(i)) < 60.f)
+        if (loc_orig.DistTo(breadcrumbs[i - 1]) < 60.f)
         {
             idle_time.update();
-            for (int j = 0; j <= i; j++)
-                breadcrumbs.erase(breadcrumbs.begin());
+            breadcrumbs.pop_front(i);
+            break;
         }
     }
 
     // New crumbs, we add one if its empty so we have something to follow
-    if (breadcrumbs.empty() || (tar_orig.DistTo(breadcrumbs.at(breadcrumbs.size() - 1)) > 40.0F && DistanceToGround(ENTITY(follow_target)) < 45))
+    if (breadcrumbs.empty() || (tar_orig.DistTo(breadcrumbs.back()) > 40.0F && DistanceToGround(ENTITY(follow_target)) < 45))
         breadcrumbs.push_back(tar_orig);
 
     // Tauntsync
@@ -707,21 +815,28 @@ static void cm()
 #if ENABLE_VISUALS
 static void draw()
 {
-    if (!enable || !draw_crumb)
+    if (!enable || !draw_crumb || governor::Degraded(governor::NO_VISUALISERS))
         return;
     if (breadcrumbs.size() < 2)
         return;
-    for (size_t i = 0; i < breadcrumbs.size() - 1; i++)
+    // The ring isn't contiguous, gather it so the whole trail is projected at once
+    static std::array<Vector, crumb_ring::CAPACITY> points, screen;
+    static std::array<uint8_t, crumb_ring::CAPACITY> visible;
+    size_t count = std::min(breadcrumbs.size(), points.size());
+    for (size_t i = 0; i < count; i++)
+        points[i] = breadcrumbs[i];
+    draw::WorldToScreenBatch(points.data(), count, screen.data(), visible.data());
+
+    for (size_t i = 0; i < count - 1; i++)
     {
-        Vector wts1, wts2;
-        if (draw::WorldToScreen(breadcrumbs[i], wts1) && draw::WorldToScreen(breadcrumbs[i + 1], wts2))
+        if (visible[i] && visible[i + 1])
         {
-            draw::Line(wts1.x, wts1.y, wts2.x - wts1.x, wts2.y - wts1.y, colors::white, 0.1f);
+            draw::Line(screen[i].x, screen[i].y, screen[i + 1].x - screen[i].x, screen[i + 1].y - screen[i].y, colors::white, 0.1f);
         }
     }
-    Vector wts;
-    if (!draw::WorldToScreen(breadcrumbs[0], wts))
+    if (!visible[0])
         return;
+    const Vector &wts = screen[0];
     draw::Rectangle(wts.x - 4, wts.y - 4, 8, 8, colors::white);
     draw::RectangleOutlined(wts.x - 4, wts.y - 4, 7, 7, colors::white, 1.0f);
 }
@@ -756,14 +871,7 @@ static CatCommand follow_me("fb_follow_me", "IPC connected bots will follow you"
     }
     // Construct the command
     std::string tmp = CON_PREFIX + follow_steam.name + " " + std::to_string(steam_id);
-    if (tmp.length() >= 63)
-    {
-        ipc::peer->SendMessage(0, -1, ipc::commands::execute_client_cmd_long, tmp.c_str(), tmp.length() + 1);
-    }
-    else
-    {
-        ipc::peer->SendMessage(tmp.c_str(), -1, ipc::commands::execute_client_cmd, 0, 0);
-    }
+    ipc::channel::SendCommand(-1, tmp);
 });
 #endif
 void rvarCallback(settings::VariableBase<int> &var, int after)
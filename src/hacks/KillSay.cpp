@@ -42,7 +42,7 @@ static std::string lastmsg{};
 
 TextFile file{};
 
-std::string ComposeKillSay(IGameEvent *event)
+std::string ComposeKillSay(const game_events::player_death_s &death)
 {
     const std::vector<std::string> *source = nullptr;
     switch (*killsay_mode)
@@ -62,13 +62,9 @@ std::string ComposeKillSay(IGameEvent *event)
     }
     if (!source || source->empty())
         return "";
-    if (!event)
+    if (death.attacker_userid == death.victim_userid)
         return "";
-    int vid = event->GetInt("userid");
-    int kid = event->GetInt("attacker");
-    if (kid == vid)
-        return "";
-    if (g_IEngine->GetPlayerForUserID(kid) != g_IEngine->GetLocalPlayer())
+    if (death.attacker != g_IEngine->GetLocalPlayer())
         return "";
     std::string msg = source->at(rand() % source->size());
     //	checks if the killsays.txt file is not 1 line. 100% sure it's going
@@ -77,14 +73,14 @@ std::string ComposeKillSay(IGameEvent *event)
         msg = source->at(rand() % source->size());
     lastmsg = msg;
     player_info_s info{};
-    g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(vid), &info);
+    g_IEngine->GetPlayerInfo(death.victim, &info);
 
     ReplaceSpecials(msg);
-    CachedEntity *ent = ENTITY(g_IEngine->GetPlayerForUserID(vid));
+    CachedEntity *ent = ENTITY(death.victim);
     int clz           = g_pPlayerResource->GetClass(ent);
     ReplaceString(msg, "%class%", tf_classes_killsay[clz]);
     player_info_s infok{};
-    g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(kid), &infok);
+    g_IEngine->GetPlayerInfo(death.attacker, &infok);
     ReplaceString(msg, "%killer%", std::string(infok.name));
     ReplaceString(msg, "%team%", tf_teams_killsay[ent->m_iTeam() - 2]);
     ReplaceString(msg, "%myteam%", tf_teams_killsay[LOCAL_E->m_iTeam() - 2]);
@@ -93,22 +89,19 @@ std::string ComposeKillSay(IGameEvent *event)
     return msg;
 }
 
-class KillSayEventListener : public IGameEventListener2
+static void OnPlayerDeath(const game_events::event_s &event)
 {
-    void FireGameEvent(IGameEvent *event) override
+    if (!killsay_mode)
+        return;
+    std::string message = ComposeKillSay(*event.death);
+    if (!message.empty())
     {
-        if (!killsay_mode)
-            return;
-        std::string message = hacks::shared::killsay::ComposeKillSay(event);
-        if (!message.empty())
-        {
-            int vid                    = event->GetInt("userid");
-            killsay_storage[vid].delay = *delay;
-            killsay_storage[vid].timer.update();
-            killsay_storage[vid].message = message;
-        }
+        int vid                    = event.death->victim_userid;
+        killsay_storage[vid].delay = *delay;
+        killsay_storage[vid].timer.update();
+        killsay_storage[vid].message = message;
     }
-};
+}
 
 static void ProcessKillsay()
 {
@@ -126,8 +119,6 @@ static void ProcessKillsay()
     }
 }
 
-static KillSayEventListener listener{};
-
 void reload()
 {
     file.Load(*filename);
@@ -138,12 +129,11 @@ static CatCommand reload_command("killsay_reload", "Reload killsays", []() { rel
 void init()
 {
     reload();
-    g_IEventManager2->AddListener(&listener, (const char *) "player_death", false);
+    game_events::Subscribe("player_death", OnPlayerDeath);
 }
 
 void shutdown()
 {
-    g_IEventManager2->RemoveListener(&listener);
 }
 
 static InitRoutine runinit([]() {
@@ -135,5 +135,5 @@ void init()
 {
 }
 
-static InitRoutine EC([]() { EC::Register(EC::Paint, apply_killstreaks, "killstreak", EC::average); });
+static InitRoutine EC([]() { EC::Register(EC::Paint, apply_killstreaks, "killstreak", enable, EC::average); });
 } // namespace hacks::tf2::killstreak
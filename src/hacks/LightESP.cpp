@@ -79,9 +79,9 @@ void draw()
 }
 
 static InitRoutine init([]() {
-    EC::Register(EC::CreateMove, cm, "cm_lightesp", EC::average);
+    EC::Register(EC::CreateMove, cm, "cm_lightesp", enable, EC::average);
 #if ENABLE_VISUALS
-    EC::Register(EC::Draw, draw, "draw_lightesp", EC::average);
+    EC::Register(EC::Draw, draw, "draw_lightesp", enable, EC::average);
 #endif
 });
 
@@ -16,7 +16,9 @@
 
 #include "core/sharedobj.hpp"
 #include "filesystem.h"
+#include "kvtemplate.hpp"
 #include "DetourHook.hpp"
+#include "governor.hpp"
 
 #include "hack.hpp"
 #include <thread>
@@ -82,7 +84,7 @@ static void updateAntiAfk()
         if (!vel.IsZero(1.0f))
         {
             anti_afk_timer.last += std::chrono::milliseconds(400);
-            if (anti_afk_timer.last > std::chrono::system_clock::now())
+            if (anti_afk_timer.last > Timer::Now())
                 anti_afk_timer.update();
         }
         static auto afk_timer = g_ICvar->FindVar("mp_idlemaxtime");
@@ -117,13 +119,13 @@ CatCommand fix_cursor("fix_cursor", "Fix the GUI cursor being visible", []() {
 
 // Use to send a autobalance request to the server that doesnt prevent you from
 // using it again, Allowing infinite use of it.
+static kv_template autobalance_kv("AutoBalanceVolunteerReply", [](KeyValues *kv) { kv->SetInt("response", 1); });
+
 void SendAutoBalanceRequest()
 { // Credits to blackfire
     if (!g_IEngine->IsInGame())
         return;
-    KeyValues *kv = new KeyValues("AutoBalanceVolunteerReply");
-    kv->SetInt("response", 1);
-    g_IEngine->ServerCmdKeyValues(kv);
+    autobalance_kv.Make().Send();
 }
 
 // Catcommand for above
@@ -189,7 +191,7 @@ void DrawWireframeHitbox(wireframe_data data)
 void CreateMove()
 {
 #if ENABLE_VISUALS
-    if (misc_drawhitboxes)
+    if (misc_drawhitboxes && !governor::Degraded(governor::NO_VISUALISERS))
     {
         for (int i = 0; i <= g_IEngine->GetMaxClients(); i++)
         {
@@ -323,7 +325,7 @@ void CreateMove()
 // Timer ussr{};
 void Draw()
 {
-    if (misc_drawhitboxes)
+    if (misc_drawhitboxes && !governor::Degraded(governor::NO_VISUALISERS))
     {
         for (auto &entry : wireframe_queue)
             DrawWireframeHitbox(entry);
@@ -364,25 +366,25 @@ void Draw()
     }
     if (show_spectators)
     {
-        for (int i = 0; i < PLAYER_ARRAY_SIZE; i++)
+        for (auto &spectator : spectators::Local())
         {
-            // Assign the for loops tick number to an ent
-            CachedEntity *ent = ENTITY(i);
             player_info_s info;
-            if (!CE_BAD(ent) && ent != LOCAL_E && ent->m_Type() == ENTITY_PLAYER && (CE_INT(ent, netvar.hObserverTarget) & 0xFFF) == LOCAL_E->m_IDX && CE_INT(ent, netvar.iObserverMode) >= 4 && g_IEngine->GetPlayerInfo(i, &info))
+            if (spectator.mode >= spectators::FIRSTPERSON && g_IEngine->GetPlayerInfo(spectator.idx, &info))
             {
                 auto observermode = "N/A";
-                switch (CE_INT(ent, netvar.iObserverMode))
+                switch (spectator.mode)
                 {
-                case 4:
+                case spectators::FIRSTPERSON:
                     observermode = "Firstperson";
                     break;
-                case 5:
+                case spectators::THIRDPERSON:
                     observermode = "Thirdperson";
                     break;
-                case 7:
+                case spectators::FREECAM:
                     observermode = "Freecam";
                     break;
+                default:
+                    break;
                 }
                 AddSideString(format(info.name, " ", observermode));
             }
@@ -390,27 +392,33 @@ void Draw()
     }
     if (!debug_info)
         return;
+    // Every line is written into the same stack buffer, the side string slots keep their own copy
+    auto side = [](const auto &... args) {
+        char line[128];
+        format_to(line, args...);
+        AddSideString(line);
+    };
     auto local = LOCAL_W;
     if (CE_GOOD(local))
     {
-        AddSideString(format("Slot: ", re::C_BaseCombatWeapon::GetSlot(RAW_ENT(local))));
-        AddSideString(format("Taunt Concept: ", CE_INT(LOCAL_E, netvar.m_iTauntConcept)));
-        AddSideString(format("Taunt Index: ", CE_INT(LOCAL_E, netvar.m_iTauntIndex)));
-        AddSideString(format("Sequence: ", CE_INT(LOCAL_E, netvar.m_nSequence)));
-        AddSideString(format("Velocity: ", LOCAL_E->m_vecVelocity.x, ' ', LOCAL_E->m_vecVelocity.y, ' ', LOCAL_E->m_vecVelocity.z));
-        AddSideString(format("Velocity3: ", LOCAL_E->m_vecVelocity.Length()));
-        AddSideString(format("Velocity2: ", LOCAL_E->m_vecVelocity.Length2D()));
+        side("Slot: ", re::C_BaseCombatWeapon::GetSlot(RAW_ENT(local)));
+        side("Taunt Concept: ", CE_INT(LOCAL_E, netvar.m_iTauntConcept));
+        side("Taunt Index: ", CE_INT(LOCAL_E, netvar.m_iTauntIndex));
+        side("Sequence: ", CE_INT(LOCAL_E, netvar.m_nSequence));
+        side("Velocity: ", LOCAL_E->m_vecVelocity.x, ' ', LOCAL_E->m_vecVelocity.y, ' ', LOCAL_E->m_vecVelocity.z);
+        side("Velocity3: ", LOCAL_E->m_vecVelocity.Length());
+        side("Velocity2: ", LOCAL_E->m_vecVelocity.Length2D());
         AddSideString("NetVar Velocity");
         Vector vel = CE_VECTOR(LOCAL_E, netvar.vVelocity);
-        AddSideString(format("Velocity: ", vel.x, ' ', vel.y, ' ', vel.z));
-        AddSideString(format("Velocity3: ", vel.Length()));
-        AddSideString(format("Velocity2: ", vel.Length2D()));
-        AddSideString(format("flSimTime: ", LOCAL_E->var<float>(netvar.m_flSimulationTime)));
+        side("Velocity: ", vel.x, ' ', vel.y, ' ', vel.z);
+        side("Velocity3: ", vel.Length());
+        side("Velocity2: ", vel.Length2D());
+        side("flSimTime: ", LOCAL_E->var<float>(netvar.m_flSimulationTime));
         if (current_user_cmd)
-            AddSideString(format("command_number: ", last_cmd_number));
-        AddSideString(format("clip: ", CE_INT(g_pLocalPlayer->weapon(), netvar.m_iClip1)));
+            side("command_number: ", last_cmd_number);
+        side("clip: ", CE_INT(g_pLocalPlayer->weapon(), netvar.m_iClip1));
         if (local->m_iClassID() == CL_CLASS(CTFMinigun))
-            AddSideString(format("Weapon state: ", CE_INT(local, netvar.iWeaponState)));
+            side("Weapon state: ", CE_INT(local, netvar.iWeaponState));
         /*AddSideString(colors::white, "Weapon: %s [%i]",
         RAW_ENT(g_pLocalPlayer->weapon())->GetClientClass()->GetName(),
         g_pLocalPlayer->weapon()->m_iClassID());
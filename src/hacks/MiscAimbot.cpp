@@ -51,7 +51,7 @@ std::pair<CachedEntity *, Vector> FindBestEnt(bool teammate, bool Predict, bool
                 target = ProjectilePrediction(ent, 1, sandwich_speed, grav, PlayerGravityMod(ent), initial_vel);
             else
                 target = ent->hitboxes.GetHitbox(1)->center;
-            if (!hacks::tf2::backtrack::isBacktrackEnabled && !IsEntityVectorVisible(ent, target))
+            if (!hacks::tf2::backtrack::isBacktrackEnabled && !(Predict ? IsEntityVectorVisible(ent, target) : aim_solution::PelvisVisible(ent)))
                 continue;
             if (zcheck && (ent->m_vecOrigin().z - LOCAL_E->m_vecOrigin().z) > 200.0f)
                 continue;
@@ -73,7 +73,7 @@ std::pair<CachedEntity *, Vector> FindBestEnt(bool teammate, bool Predict, bool
             {
                 if (scr >= range)
                     continue;
-                scr = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, ent->m_vecOrigin());
+                scr = aim_solution::Fov(ent);
                 // Don't turn too harshly
                 if (scr >= 90.0f)
                     continue;
@@ -109,7 +109,7 @@ std::pair<CachedEntity *, Vector> FindBestEnt(bool teammate, bool Predict, bool
             target = ProjectilePrediction(ent, 1, sandwich_speed, grav, PlayerGravityMod(ent));
         else
             target = ent->hitboxes.GetHitbox(1)->center;
-        if (!hacks::tf2::backtrack::isBacktrackEnabled && !IsEntityVectorVisible(ent, target))
+        if (!hacks::tf2::backtrack::isBacktrackEnabled && !(Predict ? IsEntityVectorVisible(ent, target) : aim_solution::PelvisVisible(ent)))
             continue;
         if (zcheck && (ent->m_vecOrigin().z - LOCAL_E->m_vecOrigin().z) > 200.0f)
             continue;
@@ -131,7 +131,7 @@ std::pair<CachedEntity *, Vector> FindBestEnt(bool teammate, bool Predict, bool
         {
             if (scr >= range)
                 continue;
-            scr = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, ent->m_vecOrigin());
+            scr = aim_solution::Fov(ent);
             // Don't turn too harshly
             if (scr >= 90.0f)
                 continue;
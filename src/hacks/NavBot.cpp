@@ -1,11 +1,15 @@
 #include "common.hpp"
+#include "core/levelarena.hpp"
 #include "navparser.hpp"
 #include "NavBot.hpp"
 #include "PlayerTools.hpp"
 #include "Aimbot.hpp"
 #include "Misc.hpp"
-#include "teamroundtimer.hpp"
+#include "objectives.hpp"
 #include "MiscAimbot.hpp"
+#include "governor.hpp"
+#include <optional>
+#include <set>
 
 namespace hacks::tf2::NavBot
 {
@@ -20,10 +24,12 @@ static settings::Float jump_distance("navbot.autojump.trigger-distance", "300");
 static settings::Boolean autojump("navbot.autojump.enabled", "false");
 static settings::Boolean primary_only("navbot.primary-only", "true");
 static settings::Int spy_ignore_time("navbot.spy-ignore-time", "5000");
+static settings::Boolean capture_objectives("navbot.capture-objectives", "false");
 
 // -Forward declarations-
 bool init(bool first_cm);
 static bool navToSniperSpot();
+static bool navToObjective();
 static bool navToBuildingSpot();
 static bool stayNear();
 static bool stayNearEngineer();
@@ -34,15 +40,15 @@ static void updateSlot();
 static void update_building_spots();
 static bool engineerLogic();
 static std::pair<CachedEntity *, float> getNearestPlayerDistance(bool vischeck = true);
+static void runBehaviours(bool blocking);
 using task::current_engineer_task;
 using task::current_task;
 
 // -Variables-
-static std::vector<std::pair<CNavArea *, Vector>> sniper_spots;
-static std::vector<std::pair<CNavArea *, Vector>> building_spots;
-static std::vector<CNavArea *> blacklisted_build_spots;
-// Our Buildings. We need this so we can remove them on object_destroyed.
-static std::vector<CachedEntity *> local_buildings;
+static level_arena::level<std::pmr::vector<std::pair<CNavArea *, Vector>>> sniper_spots;
+static level_arena::level<std::pmr::vector<CNavArea *>> blacklisted_build_spots;
+// Our placed buildings, refilled from the entity cache's building registry every tick
+static level_arena::level<std::pmr::vector<CachedEntity *>> local_buildings;
 // Needed for blacklisting
 static CNavArea *current_build_area;
 // How long should the bot wait until pathing again?
@@ -53,8 +59,6 @@ static Timer wait_until_path_engineer{};
 static std::array<Timer, PLAYER_ARRAY_SIZE> spy_cloak{};
 // Don't spam spy path thanks
 static Timer spy_path{};
-// Big wait between updating Engineer building spots
-static Timer engineer_update{};
 // Recheck Building Area
 static Timer engineer_recheck{};
 // Timer for resetting Build attempts
@@ -122,7 +126,7 @@ static void CreateMove()
     // Check if we should path at all
     if (!blocking || task::current_task == task::engineer)
     {
-        round_states round_state = g_pTeamRoundTimer->GetRoundState();
+        round_states round_state = objectives::Round().state;
         // Still in setuptime, if on fitting team, then do not path yet
         if (round_state == RT_STATE_SETUP && g_pLocalPlayer->team == TEAM_BLU)
         {
@@ -141,84 +145,34 @@ static void CreateMove()
     {
         if (CE_GOOD(LOCAL_E))
         {
-            for (int i = g_IEngine->GetMaxClients() + 1; i < MAX_ENTITIES; i++)
-            {
-                CachedEntity *ent = ENTITY(i);
-                if (!ent || CE_BAD(ent) || ent->m_bEnemy() || !ent->m_bAlivePlayer())
-                    continue;
-                if (HandleToIDX(CE_INT(ent, netvar.m_hBuilder)) != LOCAL_E->m_IDX)
-                    continue;
-                if (std::find(local_buildings.begin(), local_buildings.end(), ent) == local_buildings.end())
-                    local_buildings.push_back(ent);
-            }
+            local_buildings.clear();
+            for (auto building : entity_cache::our_buildings())
+                if (!building->placing && !building->dormant)
+                    local_buildings.push_back(building->ent);
             update_building_spots();
         }
     }
 
-    if (get_health)
-    {
-        int metal = -1;
-        if (engineer_mode && g_pLocalPlayer->clazz == tf_engineer)
-            metal = CE_INT(LOCAL_E, netvar.m_iAmmo + 12);
-        if ((dispenser_nav_timer.test_and_set(1000) && getDispenserHealthAndAmmo(metal)))
-            return;
-        if (getHealthAndAmmo(metal))
-            return;
-    }
-
-    // Engineer stuff
-    if (engineer_mode && g_pLocalPlayer->clazz == tf_engineer)
-    {
-        if (engineerLogic())
-            return;
-    }
     // Reset Engi task stuff if not engineer
-    else if (!engineer_mode && task::current_task == task::engineer)
+    if (!engineer_mode && task::current_task == task::engineer)
     {
         task::current_task          = task::none;
         task::current_engineer_task = task::nothing;
     }
 
-    if (blocking)
-        return;
-    // Spy can just walk into the enemy
-    if (spy_mode)
-    {
-        if (spy_path.check(1000))
-        {
-            auto nearest = getNearestPlayerDistance(false);
-            if (CE_VALID(nearest.first) && nearest.first->m_vecDormantOrigin())
-            {
-                if (current_task != task::stay_near)
-                {
-                    if (nav::navTo(*nearest.first->m_vecDormantOrigin(), 6, true, false))
-                    {
-                        spy_path.update();
-                        current_task = task::stay_near;
-                        return;
-                    }
-                }
-                else
-                {
-                    if (nav::navTo(*nearest.first->m_vecDormantOrigin(), 6, false, false))
-                    {
-                        spy_path.update();
-                        return;
-                    }
-                }
-            }
-        }
-        if (current_task == task::stay_near)
-            return;
-    }
-    // Try to stay near enemies to increase efficiency
-    if ((stay_near || heavy_mode) && !spy_mode)
-        if (stayNear())
-            return;
-    // We don't have anything else to do. Just nav to sniper spots.
-    if (navToSniperSpot())
-        return;
-    // Uhh... Just stand around I guess?
+#if ENABLE_IPC
+    // Keep our claim alive while we're still going for it
+    if (current_task == task::sniper_spot || current_task == task::health || current_task == task::ammo || (current_task == task::engineer && current_engineer_task == task::engineer_task::goto_build_spot))
+        ipc::claims::Refresh();
+    else
+        ipc::claims::Clear();
+#endif
+    runBehaviours(blocking);
+}
+
+namespace spot_scan
+{
+static void Reset();
 }
 
 bool init(bool first_cm)
@@ -233,6 +187,7 @@ bool init(bool first_cm)
     if (!inited)
     {
         blacklisted_build_spots.clear();
+        spot_scan::Reset();
         local_buildings.clear();
         sniper_spots.clear();
         // Add all sniper spots to vector
@@ -247,115 +202,190 @@ bool init(bool first_cm)
     return true;
 }
 
-struct area_struct
+// Building spots are scored a few vischecks per tick. Only areas in range of enemies that moved get scored again
+namespace spot_scan
 {
-    // The Area
-    CNavArea *navarea;
-    // Distance away from enemies
-    float min_distance;
-    // Valid enemies to area
-    std::vector<Vector *> enemy_list;
-};
+// Vischecks per tick
+constexpr int TRACE_BUDGET = 16;
+// Enemies that moved less than this keep their old position, the areas around them don't get rescored
+constexpr float MOVE_TOLERANCE = 150.0f;
+
+// Enemy positions the scores are based on
+static std::array<std::optional<Vector>, PLAYER_ARRAY_SIZE> enemies;
+// Lower is better, negative if the area can't be built on. Indexed by position in navfile->m_areas
+static std::vector<float> scores;
+// Usable areas, best first
+static std::set<std::pair<float, CNavArea *>> ranked;
+// Areas waiting to be scored
+static std::vector<unsigned> queue;
+static std::vector<bool> queued;
+static const bot_class_config *config = nullptr;
+static Timer refresh{};
+
+static void Reset()
+{
+    enemies.fill(std::nullopt);
+    scores.clear();
+    ranked.clear();
+    queue.clear();
+    queued.clear();
+    config = nullptr;
+}
 
-void update_building_spots()
+static void Set(unsigned index, float score)
 {
-    if (engineer_update.test_and_set(10000))
+    CNavArea *area = &nav::navfile->m_areas[index];
+    if (scores[index] >= 0.0f)
+        ranked.erase({ scores[index], area });
+    scores[index] = score;
+    if (score >= 0.0f)
+        ranked.insert({ score, area });
+}
+
+// Returns how many vischecks it took
+static int Score(unsigned index)
+{
+    CNavArea *area = &nav::navfile->m_areas[index];
+    // Blacklisted for building
+    if (std::find(blacklisted_build_spots.begin(), blacklisted_build_spots.end(), area) != blacklisted_build_spots.end())
     {
-        building_spots.clear();
-        // Store in here to reduce operations
-        std::vector<Vector> enemy_positions;
-        // Stores valid areas, the float is the minimum distance away from enemies, needed for sorting later
-        std::vector<area_struct> areas;
+        Set(index, -1.0f);
+        return 0;
+    }
 
-        for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
+    // Area Center
+    auto area_pos = area->m_center;
+    // Don't want to instantly hit the floor
+    area_pos.z += 42.0f;
+
+    // These positions we should vischeck
+    std::array<const Vector *, PLAYER_ARRAY_SIZE> vischeck_positions;
+    size_t vischeck_count = 0;
+    // Minimum distance the area was away from enemies
+    float min_dist_away = FLT_MAX;
+    // Found enemy below min/above max range away from area
+    bool enemy_found  = false;
+    bool out_of_reach = true;
+
+    for (auto &pos : enemies)
+    {
+        if (!pos)
+            continue;
+        auto dist = area_pos.DistTo(*pos);
+        if (dist < config->min)
         {
-            CachedEntity *ent = ENTITY(i);
-            // Grab only Enemies and only if they are in soundcache
-            if (!ent || CE_INVALID(ent) || !ent->m_bAlivePlayer() || !ent->m_bEnemy())
-                continue;
-            if (ent->m_vecDormantOrigin())
-                enemy_positions.push_back(*ent->m_vecDormantOrigin());
+            enemy_found = true;
+            break;
         }
-        auto config = &DIST_ENGINEER;
-        if (HasGunslinger(LOCAL_E))
-            config = &DIST_GUNSLINGER_ENGINEER;
-        for (auto &area : nav::navfile->m_areas)
+        // Found someone within min and max range
+        if (dist < config->max)
         {
-            // Blacklisted for building
-            if (std::find(blacklisted_build_spots.begin(), blacklisted_build_spots.end(), &area) != blacklisted_build_spots.end())
-                continue;
-
-            // These positions we should vischeck
-            std::vector<Vector *> vischeck_positions;
-
-            // Minimum distance the area was away from enemies
-            float min_dist_away = FLT_MAX;
-
-            // Area Center
-            auto area_pos = area.m_center;
-            // Don't want to instantly hit the floor
-            area_pos.z += 42.0f;
-
-            // Found enemy below min/above max range away from area
-            bool enemy_found  = false;
-            bool out_of_reach = true;
+            out_of_reach = false;
+            // Should vischeck this one
+            vischeck_positions[vischeck_count++] = &*pos;
+            if (dist < min_dist_away)
+                min_dist_away = dist;
+        }
+    }
+    // Too close/Too far away
+    if (enemy_found || out_of_reach)
+    {
+        Set(index, -1.0f);
+        return 0;
+    }
 
-            for (auto &pos : enemy_positions)
+    // Someone can see the area. Abort! (Gunslinger Engineer does not care)
+    int traces = 0;
+    if (config != &DIST_GUNSLINGER_ENGINEER)
+        for (size_t i = 0; i < vischeck_count; i++)
+        {
+            traces++;
+            if (IsVectorVisible(area_pos, *vischeck_positions[i]))
             {
-                auto dist = area_pos.DistTo(pos);
-                if (dist < config->min)
-                {
-                    enemy_found = true;
-                    break;
-                }
-                // Found someone within min and max range
-                if (dist < config->max)
-                {
-                    out_of_reach = false;
-                    // Should vischeck this one
-                    vischeck_positions.push_back(&pos);
-                    if (dist < min_dist_away)
-                        min_dist_away = dist;
-                }
+                Set(index, -1.0f);
+                return traces;
             }
-            // Too close/Too far away
-            if (enemy_found || out_of_reach)
-                continue;
-
-            // Area is valid (Distance wise)
-            areas.push_back({ &area, min_dist_away, vischeck_positions });
         }
+    // Be as close to preferred as possible
+    Set(index, std::abs(min_dist_away - config->preferred));
+    return traces;
+}
 
-        // Sort, be as close to preferred as possible
-        std::sort(areas.begin(), areas.end(), [&](area_struct a, area_struct b) { return std::abs(a.min_distance - config->preferred) < std::abs(b.min_distance - config->preferred); });
+// Picks up enemies that moved and queues the areas they affect
+static void Refresh()
+{
+    auto &areas     = nav::navfile->m_areas;
+    auto new_config = HasGunslinger(LOCAL_E) ? &DIST_GUNSLINGER_ENGINEER : &DIST_ENGINEER;
+    bool full       = scores.size() != areas.size() || new_config != config;
+    if (full)
+    {
+        Reset();
+        scores.assign(areas.size(), -1.0f);
+        queued.assign(areas.size(), false);
+    }
+    config = new_config;
 
-        // Still need to do vischeck stuff
-        for (auto &area : areas)
-        {
-            // Is the enemy able to see the area?
-            bool can_see_area = false;
-            // Area Center
-            auto area_pos = area.navarea->m_center;
-            // Don't want to instantly hit the floor
-            area_pos.z += 42.0f;
-            // Loop all valid enemies
-            for (auto pos : area.enemy_list)
+    // Old and new positions of everyone that moved
+    std::vector<Vector> moved;
+    for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
+    {
+        CachedEntity *ent = ENTITY(i);
+        std::optional<Vector> pos;
+        // Grab only Enemies and only if they are in soundcache
+        if (ent && !CE_INVALID(ent) && ent->m_bAlivePlayer() && ent->m_bEnemy() && ent->m_vecDormantOrigin())
+            pos = *ent->m_vecDormantOrigin();
+        auto &old = enemies[i];
+        if (pos.has_value() == old.has_value() && (!pos || pos->DistTo(*old) < MOVE_TOLERANCE))
+            continue;
+        if (old)
+            moved.push_back(*old);
+        if (pos)
+            moved.push_back(*pos);
+        old = pos;
+    }
+    if (!full && moved.empty())
+        return;
+
+    for (unsigned i = 0; i < areas.size(); i++)
+    {
+        if (queued[i])
+            continue;
+        bool affected = full;
+        for (auto &pos : moved)
+            if (areas[i].m_center.DistTo(pos) < config->max + MOVE_TOLERANCE)
             {
-                if (IsVectorVisible(area_pos, *pos))
-                {
-                    can_see_area = true;
-                    break;
-                }
+                affected = true;
+                break;
             }
-            // Someone can see the area. Abort! (Gunslinger Engineer does not care)
-            if (can_see_area && !HasGunslinger(LOCAL_E))
-                continue;
-            // All good!
-            building_spots.push_back(std::pair<CNavArea *, Vector>(area.navarea, area.navarea->m_center));
+        if (affected)
+        {
+            queued[i] = true;
+            queue.push_back(i);
         }
     }
 }
 
+static void Process()
+{
+    int traces = 0;
+    int limit  = governor::Degraded(governor::SLOW_NAVBOT_SCORING) ? TRACE_BUDGET / 4 : TRACE_BUDGET;
+    while (!queue.empty() && traces < limit)
+    {
+        unsigned index = queue.back();
+        queue.pop_back();
+        queued[index] = false;
+        traces += Score(index);
+    }
+}
+} // namespace spot_scan
+
+void update_building_spots()
+{
+    if (spot_scan::refresh.test_and_set(governor::Degraded(governor::SLOW_NAVBOT_SCORING) ? 3000 : 1000))
+        spot_scan::Refresh();
+    spot_scan::Process();
+}
+
 static bool navToSniperSpot()
 {
     // Don't path if you already have commands. But also don't error out.
@@ -372,15 +402,55 @@ static bool navToSniperSpot()
         // Check if spot is considered safe (no sentry, no sticky)
         if (!nav::isSafe(random.base()->first))
             continue;
+#if ENABLE_IPC
+        // Another bot is already going there
+        if (ipc::claims::ClaimedByOthers(ipc::claims::sniper_spot, random.base()->second, 200.0f))
+            continue;
+#endif
         // Try to nav there
         if (nav::navTo(random.base()->second, 1, true, true, false))
         {
             current_task = { task::sniper_spot, 1 };
+#if ENABLE_IPC
+            ipc::claims::Set(ipc::claims::sniper_spot, random.base()->second);
+#endif
+            return true;
         }
     }
     return false;
 }
 
+// Close enough to count as standing on the point or next to the cart
+constexpr float OBJECTIVE_RANGE = 100.0f;
+// The cart moved this far away from where the path goes, so go again
+constexpr float OBJECTIVE_REPATH_DISTANCE = 200.0f;
+
+static bool navToObjective()
+{
+    static Timer objective_path{};
+    static Vector goal;
+    auto &objective = objectives::Current();
+    if (objective.kind == objectives::OBJECTIVE_NONE)
+        return false;
+    if (current_task == task::objective)
+    {
+        if (goal.DistTo(objective.origin) < OBJECTIVE_REPATH_DISTANCE)
+            return true;
+    }
+    else if (current_task != task::none)
+        return false;
+    // Already there, hold it
+    if (g_pLocalPlayer->v_Origin.DistTo(objective.origin) < OBJECTIVE_RANGE)
+        return true;
+    if (!objective_path.test_and_set(1000))
+        return false;
+    if (!nav::navTo(objective.origin, 2, true, true, false))
+        return false;
+    goal         = objective.origin;
+    current_task = { task::objective, 2 };
+    return true;
+}
+
 static bool navToBuildingSpot()
 {
     // Don't path if you already have commands. But also don't error out.
@@ -390,18 +460,27 @@ static bool navToBuildingSpot()
     if (!wait_until_path_engineer.test_and_set(2000))
         return false;
     // Max 10 attempts
-    for (int attempts = 0; attempts < 10 && attempts < building_spots.size(); attempts++)
+    int attempts = 0;
+    for (auto it = spot_scan::ranked.begin(); attempts < 10 && it != spot_scan::ranked.end(); it++, attempts++)
     {
         // Get a Building spot
-        auto &area = building_spots[attempts];
+        CNavArea *area = it->second;
         // Check if spot is considered safe (no sentry, no sticky)
-        if (!nav::isSafe(area.first))
+        if (!nav::isSafe(area))
+            continue;
+#if ENABLE_IPC
+        // Leave it to the engineer that claimed it
+        if (ipc::claims::ClaimedByOthers(ipc::claims::building_spot, area->m_center, 300.0f))
             continue;
+#endif
         // Try to nav there
-        if (nav::navTo(area.second, 5, true, true, false))
+        if (nav::navTo(area->m_center, 5, true, true, false))
         {
+#if ENABLE_IPC
+            ipc::claims::Set(ipc::claims::building_spot, area->m_center);
+#endif
             current_task          = { task::engineer, 5 };
-            current_build_area    = area.first;
+            current_build_area    = area;
             current_engineer_task = task::engineer_task::goto_build_spot;
             return true;
         }
@@ -419,16 +498,8 @@ static Building selectBuilding()
         metal_sentry = 100;
 
     // Do we already have these?
-    bool sentry_built    = false;
-    bool dispenser_built = false;
-    // Loop all buildings
-    for (auto &building : local_buildings)
-    {
-        if (building->m_iClassID() == CL_CLASS(CObjectSentrygun))
-            sentry_built = true;
-        else if (building->m_iClassID() == CL_CLASS(CObjectDispenser))
-            dispenser_built = true;
-    }
+    bool sentry_built    = entity_cache::OurBuilding(entity_cache::BUILDING_SENTRY) != nullptr;
+    bool dispenser_built = entity_cache::OurBuilding(entity_cache::BUILDING_DISPENSER) != nullptr;
 
     if (metal >= metal_sentry && !sentry_built)
         return Sentry;
@@ -495,6 +566,8 @@ static success_build buildBuilding()
     if (build_attempts >= 14)
     {
         blacklisted_build_spots.push_back(current_build_area);
+        if (!spot_scan::scores.empty())
+            spot_scan::Set(current_build_area - nav::navfile->m_areas.data(), -1.0f);
         return Failure;
     }
     return Unknown;
@@ -531,12 +604,6 @@ static bool navToBuilding(CachedEntity *target = nullptr)
 
 static bool engineerLogic()
 {
-    std::vector<CachedEntity *> new_building_list;
-    for (auto &building : local_buildings)
-        if (CE_VALID(building) && !CE_INT(building, netvar.m_bPlacing))
-            new_building_list.push_back(building);
-    local_buildings = new_building_list;
-
     // Overwrites and Not yet running engineer task
     if ((current_task != task::engineer || current_engineer_task == task::engineer_task::nothing || current_engineer_task == task::engineer_task::staynear_engineer) && current_task != task::health && current_task != task::ammo)
     {
@@ -557,39 +624,32 @@ static bool engineerLogic()
             if (HasGunslinger(LOCAL_E))
             {
                 // Deconstruct too far away buildings
-                for (auto &building : local_buildings)
+                for (auto building : entity_cache::our_buildings())
                 {
                     // Too far away, destroy it
-                    if (building->m_vecOrigin().DistTo(LOCAL_E->m_vecOrigin()) >= 1800.0f)
+                    if (!building->placing && building->origin.DistTo(LOCAL_E->m_vecOrigin()) >= 1800.0f)
                     {
                         Building building_type = None;
-                        switch (building->m_iClassID())
-                        {
-                        case CL_CLASS(CObjectDispenser):
+                        switch (building->kind)
                         {
+                        case entity_cache::BUILDING_DISPENSER:
                             building_type = Dispenser;
                             break;
-                        }
-                        case CL_CLASS(CObjectTeleporter):
-                        {
-                            // We cannot reliably detect entrance and exit, so just destruct both but mark as "Entrance"
+                        case entity_cache::BUILDING_TELE_ENTRANCE:
                             building_type = TP_Entrace;
                             break;
-                        }
-                        case CL_CLASS(CObjectSentrygun):
-                        {
+                        case entity_cache::BUILDING_TELE_EXIT:
+                            building_type = TP_Exit;
+                            break;
+                        case entity_cache::BUILDING_SENTRY:
                             building_type = Sentry;
                             break;
-                        }
+                        default:
+                            break;
                         }
                         // If we have a valid building
                         if (building_type != None)
-                        {
-                            // Destroy exit too because we have no idea what is what
-                            if (building_type == TP_Entrace)
-                                g_IEngine->ClientCmd_Unrestricted("destroy 3");
                             g_IEngine->ClientCmd_Unrestricted(("destroy " + std::to_string(building_type)).c_str());
-                        }
                     }
                 }
                 stayNearEngineer();
@@ -1184,6 +1244,37 @@ static bool getDispenserHealthAndAmmo(int metal)
         return false;
 }
 
+// Available pickups of the given types, closest by path cost first. Ones without a path are left out
+static std::vector<Vector> findPickups(std::initializer_list<k_EItemType> types)
+{
+    std::vector<const entity_cache::pickup_s *> found;
+    std::vector<CNavArea *> areas;
+    for (auto type : types)
+        for (auto &pickup : entity_cache::pickups(type))
+            if (pickup.available)
+            {
+                found.push_back(&pickup);
+                areas.push_back(pickup.area);
+            }
+    // One search for all of them instead of trying navTo on each until one works
+    CNavArea *local              = nav::findArea(g_pLocalPlayer->v_Origin);
+    std::vector<float> distances = nav::pathDistances(local, areas);
+    std::vector<size_t> order;
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        // No nav mesh yet, fall back to straight distance
+        if (!local)
+            distances[i] = g_pLocalPlayer->v_Origin.DistTo(found[i]->origin);
+        if (std::isfinite(distances[i]))
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return distances[a] < distances[b]; });
+    std::vector<Vector> result;
+    for (size_t i : order)
+        result.push_back(found[i]->origin);
+    return result;
+}
+
 static bool getHealthAndAmmo(int metal)
 {
     float health = static_cast<float>(LOCAL_E->m_iHealth()) / LOCAL_E->m_iMaxHealth();
@@ -1221,44 +1312,37 @@ static bool getHealthAndAmmo(int metal)
 
             if (gethealth)
             {
-                std::vector<Vector> healthpacks;
-                for (int i = 1; i <= HIGHEST_ENTITY; i++)
-                {
-                    CachedEntity *ent = ENTITY(i);
-                    if (CE_BAD(ent))
-                        continue;
-                    if (ent->m_ItemType() != ITEM_HEALTH_SMALL && ent->m_ItemType() != ITEM_HEALTH_MEDIUM && ent->m_ItemType() != ITEM_HEALTH_LARGE)
-                        continue;
-                    healthpacks.push_back(ent->m_vecOrigin());
-                }
-                std::sort(healthpacks.begin(), healthpacks.end(), [](Vector &a, Vector &b) { return g_pLocalPlayer->v_Origin.DistTo(a) < g_pLocalPlayer->v_Origin.DistTo(b); });
+                std::vector<Vector> healthpacks = findPickups({ ITEM_HEALTH_SMALL, ITEM_HEALTH_MEDIUM, ITEM_HEALTH_LARGE });
+#if ENABLE_IPC
+                // Packs other bots are already going for come last
+                std::stable_partition(healthpacks.begin(), healthpacks.end(), [](const Vector &pack) { return !ipc::claims::ClaimedByOthers(ipc::claims::health, pack, 100.0f); });
+#endif
                 for (auto &pack : healthpacks)
                 {
                     if (nav::navTo(pack, health < 0.64f || lowAmmo ? 10 : 3, true, false))
                     {
                         current_task = { task::health, health < 0.64f ? 10 : 3 };
+#if ENABLE_IPC
+                        ipc::claims::Set(ipc::claims::health, pack);
+#endif
                         return true;
                     }
                 }
             }
             else
             {
-                std::vector<Vector> ammopacks;
-                for (int i = 1; i <= HIGHEST_ENTITY; i++)
-                {
-                    CachedEntity *ent = ENTITY(i);
-                    if (CE_BAD(ent))
-                        continue;
-                    if (ent->m_ItemType() != ITEM_AMMO_SMALL && ent->m_ItemType() != ITEM_AMMO_MEDIUM && ent->m_ItemType() != ITEM_AMMO_LARGE)
-                        continue;
-                    ammopacks.push_back(ent->m_vecOrigin());
-                }
-                std::sort(ammopacks.begin(), ammopacks.end(), [](Vector &a, Vector &b) { return g_pLocalPlayer->v_Origin.DistTo(a) < g_pLocalPlayer->v_Origin.DistTo(b); });
+                std::vector<Vector> ammopacks = findPickups({ ITEM_AMMO_SMALL, ITEM_AMMO_MEDIUM, ITEM_AMMO_LARGE });
+#if ENABLE_IPC
+                std::stable_partition(ammopacks.begin(), ammopacks.end(), [](const Vector &pack) { return !ipc::claims::ClaimedByOthers(ipc::claims::ammo, pack, 100.0f); });
+#endif
                 for (auto &pack : ammopacks)
                 {
                     if (nav::navTo(pack, health < 0.64f || lowAmmo ? 9 : 3, true, false))
                     {
                         current_task = { task::ammo, 10 };
+#if ENABLE_IPC
+                        ipc::claims::Set(ipc::claims::ammo, pack);
+#endif
                         return true;
                     }
                 }
@@ -1368,35 +1452,151 @@ static void updateSlot()
     }
 }
 
-class ObjectDestroyListener : public IGameEventListener2
+// Metal an engineer has, -1 if ammo should be judged by the weapons instead
+static int supplyMetal()
+{
+    if (engineer_mode && g_pLocalPlayer->clazz == tf_engineer)
+        return CE_INT(LOCAL_E, netvar.m_iAmmo + 12);
+    return -1;
+}
+
+static bool getSupplies()
+{
+    int metal = supplyMetal();
+    if ((dispenser_nav_timer.test_and_set(1000) && getDispenserHealthAndAmmo(metal)))
+        return true;
+    return getHealthAndAmmo(metal);
+}
+
+// Spy can just walk into the enemy
+static bool spyLogic()
+{
+    if (spy_path.check(1000))
+    {
+        auto nearest = getNearestPlayerDistance(false);
+        if (CE_VALID(nearest.first) && nearest.first->m_vecDormantOrigin())
+        {
+            if (current_task != task::stay_near)
+            {
+                if (nav::navTo(*nearest.first->m_vecDormantOrigin(), 6, true, false))
+                {
+                    spy_path.update();
+                    current_task = task::stay_near;
+                    return true;
+                }
+            }
+            else
+            {
+                if (nav::navTo(*nearest.first->m_vecDormantOrigin(), 6, false, false))
+                {
+                    spy_path.update();
+                    return true;
+                }
+            }
+        }
+    }
+    return current_task == task::stay_near;
+}
+
+// Behaviours compete for the bot. Scores are cheap and only refreshed every SCORE_RATE ms, the expensive execute
+// functions then run best first until one of them takes the tick
+namespace arbiter
+{
+constexpr unsigned SCORE_RATE = 250;
+// Added to the behaviour that took the bot last, so close scores don't flip between goals and repath every time
+constexpr float HYSTERESIS = 15.0f;
+
+struct behaviour
+{
+    const char *name;
+    // No traces or paths in here. 0 if it shouldn't run
+    float (*score)();
+    // True if it took control of the bot this tick
+    bool (*execute)();
+    // Runs even while a blocking task is active
+    bool runs_while_blocking;
+    float last_score;
+};
+
+static float supplyScore()
+{
+    if (!get_health)
+        return 0.0f;
+    float health = static_cast<float>(LOCAL_E->m_iHealth()) / LOCAL_E->m_iMaxHealth();
+    int metal    = supplyMetal();
+    bool lowAmmo = metal == -1 ? hasLowAmmo() : metal < 100 && selectBuilding() == None;
+    if (metal != -1 && current_engineer_task == task::engineer_task::upgradeorrepair_building)
+        lowAmmo = metal == 0;
+    if (health < 0.64f || lowAmmo)
+        return 100.0f;
+    if (current_task == task::health || current_task == task::ammo || current_task == task::dispenser)
+        return 60.0f;
+    if (health < 0.99f)
+        return 30.0f;
+    return 0.0f;
+}
+
+static behaviour behaviours[]{
+    { "supplies", supplyScore, getSupplies, true, 0.0f },
+    { "engineer", []() { return engineer_mode && g_pLocalPlayer->clazz == tf_engineer ? 50.0f : 0.0f; }, engineerLogic, true, 0.0f },
+    { "spy", []() { return spy_mode ? (current_task == task::stay_near ? 45.0f : 40.0f) : 0.0f; }, spyLogic, false, 0.0f },
+    { "stay near", []() { return (stay_near || heavy_mode) && !spy_mode ? (current_task == task::stay_near ? 45.0f : 20.0f) : 0.0f; }, stayNear, false, 0.0f },
+    { "objective", []() { return capture_objectives && objectives::Current().kind != objectives::OBJECTIVE_NONE ? 25.0f : 0.0f; }, navToObjective, false, 0.0f },
+    { "sniper spot", []() { return 10.0f; }, navToSniperSpot, false, 0.0f }
+};
+constexpr size_t BEHAVIOUR_COUNT = sizeof(behaviours) / sizeof(behaviours[0]);
+
+// Best first, behaviours that scored 0 are left out
+static std::array<behaviour *, BEHAVIOUR_COUNT> ranking{};
+static size_t ranked         = 0;
+static behaviour *last_taken = nullptr;
+static Timer score_timer{};
+
+static void Rank()
+{
+    ranked = 0;
+    for (auto &i : behaviours)
+    {
+        i.last_score = i.score();
+        if (i.last_score > 0.0f)
+            ranking[ranked++] = &i;
+    }
+    auto effective = [](behaviour *b) { return b->last_score + (b == last_taken ? HYSTERESIS : 0.0f); };
+    std::stable_sort(ranking.begin(), ranking.begin() + ranked, [&](behaviour *a, behaviour *b) { return effective(a) > effective(b); });
+}
+
+static void Run(bool blocking)
 {
-    virtual void FireGameEvent(IGameEvent *event)
+    if (score_timer.test_and_set(SCORE_RATE))
+        Rank();
+    for (size_t i = 0; i < ranked; i++)
     {
-        if (!isHackActive() || !engineer_mode)
+        behaviour *b = ranking[i];
+        if (blocking && !b->runs_while_blocking)
+            continue;
+        if (b->execute())
+        {
+            last_taken = b;
             return;
-        // Get index of destroyed object
-        int index = event->GetInt("index");
-        // Destroyed Entity
-        CachedEntity *ent = ENTITY(index);
-        // Get Entry in the vector
-        auto it = std::find(local_buildings.begin(), local_buildings.end(), ent);
-        // If found, erase
-        if (it != local_buildings.end())
-            local_buildings.erase(it);
+        }
     }
-};
+    // Uhh... Just stand around I guess?
+    last_taken = nullptr;
+}
+} // namespace arbiter
 
-ObjectDestroyListener &listener()
+static void runBehaviours(bool blocking)
 {
-    static ObjectDestroyListener object{};
-    return object;
+    arbiter::Run(blocking);
 }
 
+static CatCommand print_behaviours("navbot_debug_behaviours", "Print the last navbot behaviour scores", []() {
+    for (auto &i : arbiter::behaviours)
+        logging::Info("%s: %.1f%s", i.name, i.last_score, &i == arbiter::last_taken ? " (active)" : "");
+});
+
 static InitRoutine runinit([]() {
-    g_IEventManager2->AddListener(&listener(), "object_destroyed", false);
     EC::Register(EC::CreateMove, CreateMove, "navbot", EC::early);
-    EC::Register(
-        EC::Shutdown, []() { g_IEventManager2->RemoveListener(&listener()); }, "navbot_shutdown");
 });
 
 void change(settings::VariableBase<bool> &, bool)
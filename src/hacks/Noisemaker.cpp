@@ -7,6 +7,7 @@
 
 #include "common.hpp"
 #include <settings/Bool.hpp>
+#include "kvtemplate.hpp"
 
 namespace hacks::tf2::noisemaker
 {
@@ -18,16 +19,17 @@ static settings::Boolean enable{ "noisemaker-spam.enable", "true" };
 static settings::Boolean enable{ "noisemaker-spam.enable", "false" };
 #endif
 
+static kv_template plus_kv("+use_action_slot_item_server", [](KeyValues *) {});
+static kv_template minus_kv("-use_action_slot_item_server", [](KeyValues *) {});
+
 static void CreateMove()
 {
     if (enable && CE_GOOD(LOCAL_E))
     {
         if (g_GlobalVars->framecount % 100 == 0)
         {
-            KeyValues *kv = new KeyValues("+use_action_slot_item_server");
-            g_IEngine->ServerCmdKeyValues(kv);
-            KeyValues *kv2 = new KeyValues("-use_action_slot_item_server");
-            g_IEngine->ServerCmdKeyValues(kv2);
+            plus_kv.Make().Send();
+            minus_kv.Make().Send();
         }
     }
 }
@@ -37,14 +39,12 @@ FnCommandCallbackVoid_t minus_use_action_slot_item_original;
 
 void plus_use_action_slot_item_hook()
 {
-    KeyValues *kv = new KeyValues("+use_action_slot_item_server");
-    g_IEngine->ServerCmdKeyValues(kv);
+    plus_kv.Make().Send();
 }
 
 void minus_use_action_slot_item_hook()
 {
-    KeyValues *kv = new KeyValues("-use_action_slot_item_server");
-    g_IEngine->ServerCmdKeyValues(kv);
+    minus_kv.Make().Send();
 }
 
 static void init()
@@ -31,48 +31,54 @@ static settings::Boolean show_ammopacks{ "radar.show.ammo", "true" };
 
 static Timer invalid{};
 
-std::pair<int, int> WorldToRadar(int x, int y)
+// Everything WorldToRadar needs that is the same for every entity, rebuilt once per frame
+struct radar_view_s
 {
-    static int dx, dy, halfsize;
-    static float ry, nx, ny;
-    static QAngle angle;
-
-    if (!zoom)
-        return { 0, 0 };
-    dx = x - g_pLocalPlayer->v_Origin.x;
-    dy = y - g_pLocalPlayer->v_Origin.y;
-
-    dx /= (float) zoom;
-    dy /= (float) zoom;
+    float origin_x, origin_y;
+    float cos_ry, sin_ry;
+    float zoom;
+    int halfsize;
+    int icon_size;
+    int shape;
+};
+static radar_view_s view{};
 
+static void UpdateView()
+{
+    QAngle angle;
     g_IEngine->GetViewAngles(angle);
-    ry = DEG2RAD(angle.y) + PI / 2;
+    float ry       = DEG2RAD(angle.y) + PI / 2;
+    view.origin_x  = g_pLocalPlayer->v_Origin.x;
+    view.origin_y  = g_pLocalPlayer->v_Origin.y;
+    view.cos_ry    = std::cos(ry);
+    view.sin_ry    = std::sin(ry);
+    view.zoom      = *zoom;
+    view.halfsize  = (int) size / 2;
+    view.icon_size = *icon_size;
+    view.shape     = *shape;
+}
 
-    dx = -dx;
+std::pair<int, int> WorldToRadar(int x, int y)
+{
+    int dx, dy;
+    float nx, ny;
+    int halfsize = view.halfsize;
 
-    nx = dx * std::cos(ry) - dy * std::sin(ry);
-    ny = dx * std::sin(ry) + dy * std::cos(ry);
+    if (!view.zoom)
+        return { 0, 0 };
+    dx = x - view.origin_x;
+    dy = y - view.origin_y;
 
-    halfsize = (int) size / 2;
+    dx /= view.zoom;
+    dy /= view.zoom;
 
-    if (*shape == 0)
-    {
-        if (nx < -halfsize)
-            nx = -halfsize;
-        if (nx > halfsize)
-            nx = halfsize;
-        if (ny < -halfsize)
-            ny = -halfsize;
-        if (ny > halfsize)
-            ny = halfsize;
+    dx = -dx;
 
-        return { nx + halfsize - (int) icon_size / 2, ny + halfsize - (int) icon_size / 2 };
-    }
+    nx = dx * view.cos_ry - dy * view.sin_ry;
+    ny = dx * view.sin_ry + dy * view.cos_ry;
 
-    else if (*shape == 1)
+    if (view.shape == 1)
     {
-        float PI = 3.14159265;
-
         float theta = atan2(ny, nx);
 
         if (nx > halfsize * std::cos(theta) && nx > 0)
@@ -83,9 +89,19 @@ std::pair<int, int> WorldToRadar(int x, int y)
             ny = halfsize * std::sin(theta);
         if (ny < halfsize * std::sin(theta) && ny < 0)
             ny = halfsize * std::sin(theta);
-
-        return { nx + halfsize - (int) icon_size / 2, ny + halfsize - (int) icon_size / 2 };
     }
+    else
+    {
+        if (nx < -halfsize)
+            nx = -halfsize;
+        if (nx > halfsize)
+            nx = halfsize;
+        if (ny < -halfsize)
+            ny = -halfsize;
+        if (ny > halfsize)
+            ny = halfsize;
+    }
+    return { nx + halfsize - view.icon_size / 2, ny + halfsize - view.icon_size / 2 };
 }
 bool loaded = false;
 
@@ -95,7 +111,7 @@ static std::vector<textures::sprite> tx_items{};
 static std::vector<textures::sprite> tx_buildings{};
 static std::vector<textures::sprite> tx_sentry{};
 
-void DrawEntity(int x, int y, CachedEntity *ent)
+void DrawEntity(int x, int y, CachedEntity *ent, const std::pair<int, int> &wtr)
 {
     int idx = -1;
     rgba_t clr;
@@ -116,7 +132,6 @@ void DrawEntity(int x, int y, CachedEntity *ent)
                 return;
             if (!ent->m_vecDormantOrigin())
                 return;
-            const auto &wtr = WorldToRadar(ent->m_vecDormantOrigin()->x, ent->m_vecDormantOrigin()->y);
 
             if (use_icons)
             {
@@ -145,7 +160,6 @@ void DrawEntity(int x, int y, CachedEntity *ent)
             {
                 if (!ent->m_vecDormantOrigin())
                     return;
-                const auto &wtr = WorldToRadar(ent->m_vecDormantOrigin()->x, ent->m_vecDormantOrigin()->y);
                 tx_teams[CE_INT(ent, netvar.iTeamNum) - 2].draw(x + wtr.first, y + wtr.second, *icon_size * 1.5f, *icon_size * 1.5f, colors::white);
                 switch (ent->m_iClassID())
                 {
@@ -186,14 +200,12 @@ void DrawEntity(int x, int y, CachedEntity *ent)
                 return;
             if (show_healthpacks && (ent->m_ItemType() == ITEM_HEALTH_LARGE || ent->m_ItemType() == ITEM_HEALTH_MEDIUM || ent->m_ItemType() == ITEM_HEALTH_SMALL))
             {
-                const auto &wtr = WorldToRadar(ent->m_vecDormantOrigin()->x, ent->m_vecDormantOrigin()->y);
                 float sz        = *icon_size * 0.15f * 0.5f;
                 float sz2       = *icon_size * 0.85;
                 tx_items[0].draw(x + wtr.first + sz, y + wtr.second + sz, sz2, sz2, colors::white);
             }
             else if (show_ammopacks && (ent->m_ItemType() == ITEM_AMMO_LARGE || ent->m_ItemType() == ITEM_AMMO_MEDIUM || ent->m_ItemType() == ITEM_AMMO_SMALL))
             {
-                const auto &wtr = WorldToRadar(ent->m_vecDormantOrigin()->x, ent->m_vecDormantOrigin()->y);
                 float sz        = *icon_size * 0.15f * 0.5f;
                 float sz2       = *icon_size * 0.85;
                 tx_items[1].draw(x + wtr.first + sz, y + wtr.second + sz, sz2, sz2, colors::white);
@@ -235,8 +247,10 @@ void Draw()
         draw::Circle(center_x, center_y, half_size / 2, colors::Transparent(colors::black, *opacity), half_size, 100);
     }
 
-    if (enemies_over_teammates)
-        enemies.clear();
+    // Draw order: enemies over teammates when asked to, then sentries, the local player last
+    static std::vector<CachedEntity *> draw_order;
+    static std::vector<std::pair<int, int>> positions;
+    draw_order.clear();
     std::vector<CachedEntity *> sentries;
     for (int i = 1; i <= HIGHEST_ENTITY; i++)
     {
@@ -254,20 +268,31 @@ void Draw()
         if (ent->m_iClassID() == CL_CLASS(CObjectSentrygun))
             sentries.push_back(ent);
         else if (!enemies_over_teammates || !show_teammates || ent->m_Type() != ENTITY_PLAYER)
-            DrawEntity(x, y, ent);
+            draw_order.push_back(ent);
         else if (ent->m_bEnemy())
             enemies.push_back(ent);
         else
-            DrawEntity(x, y, ent);
+            draw_order.push_back(ent);
     }
     if (enemies_over_teammates && show_teammates)
-        for (auto enemy : enemies)
-            DrawEntity(x, y, enemy);
-    for (auto Sentry : sentries)
-        DrawEntity(x, y, Sentry);
+        draw_order.insert(draw_order.end(), enemies.begin(), enemies.end());
+    draw_order.insert(draw_order.end(), sentries.begin(), sentries.end());
+    if (CE_GOOD(LOCAL_E))
+        draw_order.push_back(LOCAL_E);
+
+    // Project everything with one view, entities without a known position get dropped by DrawEntity
+    UpdateView();
+    positions.resize(draw_order.size());
+    for (size_t i = 0; i < draw_order.size(); i++)
+    {
+        auto origin  = draw_order[i]->m_vecDormantOrigin();
+        positions[i] = origin ? WorldToRadar(origin->x, origin->y) : std::pair<int, int>{ 0, 0 };
+    }
+    for (size_t i = 0; i < draw_order.size(); i++)
+        DrawEntity(x, y, draw_order[i], positions[i]);
+
     if (CE_GOOD(LOCAL_E))
     {
-        DrawEntity(x, y, LOCAL_E);
         const auto &wtr = WorldToRadar(g_pLocalPlayer->v_Origin.x, g_pLocalPlayer->v_Origin.y);
         if (!use_icons)
             draw::RectangleOutlined(x + wtr.first, y + wtr.second, int(icon_size), int(icon_size), GUIColor(), 0.5f);
@@ -299,7 +324,7 @@ static InitRoutine init([]() {
     for (int i = 0; i < 4; i++)
         tx_sentry.push_back(textures::atlas().create_sprite(640 + i * 64, 256, 64, 64));
     logging::Info("Radar sprites loaded");
-    EC::Register(EC::Draw, Draw, "radar", EC::average);
+    EC::Register(EC::Draw, Draw, "radar", radar_enabled, EC::average);
 });
 } // namespace hacks::tf::radar
 
@@ -78,7 +78,7 @@ void CAttributeList::SetAttribute(int index, float value)
 {
     static ItemSchemaPtr_t schema   = GetItemSchema();
     AttributeDefinitionPtr_t attrib = GetAttributeDefinitionFn(schema, index);
-    SetRuntimeAttributeValueFn(this, attrib, value);
+    SetAttribute(attrib, value);
     // The code below actually is unused now - but I'll keep it just in case!
     // Let's check if attribute exists already. We don't want dupes.
     /*for (int i = 0; i < m_Attributes.Count(); i++) {
@@ -96,6 +96,26 @@ void CAttributeList::SetAttribute(int index, float value)
     */
 }
 
+void CAttributeList::SetAttribute(AttributeDefinitionPtr_t definition, float value)
+{
+    SetRuntimeAttributeValueFn(this, definition, value);
+}
+
+static bool ResolveFunctions()
+{
+    if (!SetRuntimeAttributeValueFn)
+    {
+        SetRuntimeAttributeValueFn = (SetRuntimeAttributeValue_t)(gSignatures.GetClientSignature((char *) sig_SetRuntimeAttributeValue));
+        logging::Info("SetRuntimeAttributeValue: 0x%08x", SetRuntimeAttributeValueFn);
+    }
+    if (!GetAttributeDefinitionFn)
+    {
+        GetAttributeDefinitionFn = (GetAttributeDefinition_t)(gSignatures.GetClientSignature((char *) sig_GetAttributeDefinition));
+        logging::Info("GetAttributeDefinition: 0x%08x", GetAttributeDefinitionFn);
+    }
+    return SetRuntimeAttributeValueFn && GetAttributeDefinitionFn;
+}
+
 static std::array<int, 46> australium_table{ 4, 7, 13, 14, 15, 16, 18, 19, 20, 21, 29, 36, 38, 45, 61, 132, 141, 194, 197, 200, 201, 202, 203, 205, 206, 207, 208, 211, 228, 424, 654, 658, 659, 662, 663, 664, 665, 669, 1000, 1004, 1006, 1007, 1078, 1082, 1085, 1149 };
 static std::array<std::pair<int, int>, 12> redirects{ std::pair{ 264, 1071 }, std::pair{ 18, 205 }, std::pair{ 13, 200 }, std::pair{ 21, 208 }, std::pair{ 19, 206 }, std::pair{ 20, 207 }, std::pair{ 15, 202 }, std::pair{ 7, 197 }, std::pair{ 29, 211 }, std::pair{ 14, 201 }, std::pair{ 16, 203 }, std::pair{ 4, 194 } };
 static CatCommand australize("australize", "Make everything australium", []() {
@@ -252,16 +272,8 @@ void FrameStageNotify(int stage)
     if (CE_BAD(LOCAL_E))
         return;
 
-    if (!SetRuntimeAttributeValueFn)
-    {
-        SetRuntimeAttributeValueFn = (SetRuntimeAttributeValue_t)(gSignatures.GetClientSignature((char *) sig_SetRuntimeAttributeValue));
-        logging::Info("SetRuntimeAttributeValue: 0x%08x", SetRuntimeAttributeValueFn);
-    }
-    if (!GetAttributeDefinitionFn)
-    {
-        GetAttributeDefinitionFn = (GetAttributeDefinition_t)(gSignatures.GetClientSignature((char *) sig_GetAttributeDefinition));
-        logging::Info("GetAttributeDefinition: 0x%08x", GetAttributeDefinitionFn);
-    }
+    if (!ResolveFunctions())
+        return;
 
     weapon_list   = (int *) ((unsigned) (RAW_ENT(LOCAL_E)) + netvar.hMyWeapons);
     my_weapon     = CE_INT(g_pLocalPlayer->entity, netvar.hActiveWeapon);
@@ -270,6 +282,9 @@ void FrameStageNotify(int stage)
         return;
     if (!re::C_BaseCombatWeapon::IsBaseCombatWeapon(my_weapon_ptr))
         return;
+    // Nothing changed since the last time we patched, which is almost every frame
+    if (my_weapon_ptr == last_weapon_out && cookie.Check())
+        return;
     for (int i = 0; i < 4; i++)
     {
         handle = weapon_list[i];
@@ -284,13 +299,12 @@ void FrameStageNotify(int stage)
         // or TODO PlatformOffset
         if (!re::C_BaseCombatWeapon::IsBaseCombatWeapon(entity))
             continue;
-        if ((my_weapon_ptr != last_weapon_out) || !cookie.Check())
-        {
-            GetModifier(NET_INT(entity, netvar.iItemDefinitionIndex)).Apply(eid);
-        }
+        // Weapons without modifiers don't need an entry
+        auto modifier = modifier_map.find(NET_INT(entity, netvar.iItemDefinitionIndex));
+        if (modifier != modifier_map.end())
+            modifier->second.Apply(eid);
     }
-    if ((my_weapon_ptr != last_weapon_out) || !cookie.Check())
-        cookie.Update(my_weapon & 0xFFF);
+    cookie.Update(my_weapon & 0xFFF);
     last_weapon_out = my_weapon_ptr;
 }
 
@@ -401,6 +415,7 @@ void Load(std::string filename, bool merge)
                 if (!modifier.Default())
                 {
                     modifier_map[defindex] = modifier;
+                    modifier_map[defindex].Invalidate();
                 }
             }
         }
@@ -429,6 +444,7 @@ void def_attribute_modifier::Set(int id, float value)
         return;
     }
     modifiers.push_back(attribute_s{ (uint16_t) id, value });
+    Invalidate();
     logging::Info("Added new attribute: %i %.2f (%i)", id, value, modifiers.size());
 }
 
@@ -493,6 +509,26 @@ void def_attribute_modifier::Remove(int id)
             ++it;
         }
     }
+    Invalidate();
+}
+
+void def_attribute_modifier::Invalidate()
+{
+    resolved = false;
+}
+
+bool def_attribute_modifier::Resolve()
+{
+    if (resolved)
+        return true;
+    if (!ResolveFunctions())
+        return false;
+    ItemSchemaPtr_t schema = GetItemSchema();
+    definitions.resize(modifiers.size());
+    for (size_t i = 0; i < modifiers.size(); i++)
+        definitions[i] = modifiers[i].defidx ? GetAttributeDefinitionFn(schema, modifiers[i].defidx) : nullptr;
+    resolved = true;
+    return true;
 }
 
 bool def_attribute_modifier::Default() const
@@ -518,27 +554,20 @@ void def_attribute_modifier::Apply(int entity)
         GetModifier(defidx_redirect).Apply(entity);
         return;
     }
+    if (!Resolve())
+        return;
     list = (CAttributeList *) ((uintptr_t) ent + netvar.AttributeList);
-    for (const auto &mod : modifiers)
+    for (size_t i = 0; i < modifiers.size(); i++)
     {
-        if (mod.defidx)
-        {
-            list->SetAttribute(mod.defidx, mod.value);
-        }
+        // Unknown to the schema, or an empty slot
+        if (definitions[i])
+            list->SetAttribute(definitions[i], modifiers[i].value);
     }
 }
 
 def_attribute_modifier &GetModifier(int idx)
 {
-    try
-    {
-        return modifier_map.at(idx);
-    }
-    catch (std::out_of_range &oor)
-    {
-        modifier_map.emplace(idx, def_attribute_modifier{});
-        return modifier_map.at(idx);
-    }
+    return modifier_map[idx];
 }
 // A map that maps an Item Definition Index to a modifier
 std::unordered_map<int, def_attribute_modifier> modifier_map{};
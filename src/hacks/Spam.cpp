@@ -10,6 +10,7 @@
 #include <settings/String.hpp>
 #include "common.hpp"
 #include "MiscTemporary.hpp"
+#include "jobs.hpp"
 
 namespace hacks::shared::spam
 {
@@ -24,7 +25,7 @@ static settings::Boolean team_only{ "spam.teamchat", "false" };
 
 static int last_index;
 
-std::chrono::time_point<std::chrono::system_clock> last_spam_point{};
+std::chrono::time_point<Timer::clock> last_spam_point{};
 
 int current_index{ 0 };
 TextFile file{};
@@ -339,9 +340,9 @@ void createMove()
     }
     if (!source || !source->size())
         return;
-    if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - last_spam_point).count() > int(spam_delay))
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(Timer::Now() - last_spam_point).count() > int(spam_delay))
     {
-        if (chat_stack::stack.empty())
+        if (!chat_stack::Pending())
         {
             if (current_index >= source->size())
                 current_index = 0;
@@ -356,10 +357,10 @@ void createMove()
             last_index             = current_index;
             std::string spamString = source->at(current_index);
             if (FormatSpamMessage(spamString))
-                chat_stack::Say(spamString, *team_only);
+                chat_stack::Say(spamString, *team_only, chat_stack::low);
             current_index++;
         }
-        last_spam_point = std::chrono::system_clock::now();
+        last_spam_point = Timer::Now();
     }
 }
 
@@ -373,10 +374,21 @@ bool isActive()
     return bool(spam_source);
 }
 
+// Read the file on the background pool and swap it in on the game thread
+static void reloadSpamFileAsync(std::string name)
+{
+    jobs::Background([name]() {
+        auto loaded = std::make_shared<TextFile>();
+        if (!loaded->TryLoad(name))
+            return;
+        jobs::Defer([loaded]() { file.lines = std::move(loaded->lines); });
+    });
+}
+
 void init()
 {
-    spam_source.installChangeCallback([](settings::VariableBase<int> &var, int after) { file.Load(*filename); });
-    filename.installChangeCallback([](settings::VariableBase<std::string> &var, std::string after) { file.TryLoad(after); });
+    spam_source.installChangeCallback([](settings::VariableBase<int> &var, int after) { reloadSpamFileAsync(*filename); });
+    filename.installChangeCallback([](settings::VariableBase<std::string> &var, std::string after) { reloadSpamFileAsync(after); });
     reloadSpamFile();
 }
 
@@ -80,7 +80,9 @@ void Draw()
             }
             if (voicemenu && lastVoicemenu.test_and_set(5000))
                 g_IEngine->ClientCmd_Unrestricted("voicemenu 1 1");
-            AddCenterString(format("BACKSTAB WARNING! ", (int) (closest_spy_distance / 64 * 1.22f), "m (", spy_count, ")"), colors::red);
+            char warning[64];
+            format_to(warning, "BACKSTAB WARNING! ", (int) (closest_spy_distance / 64 * 1.22f), "m (", spy_count, ")");
+            AddCenterString(warning, colors::red);
         }
         else if (closest_spy_distance < (float) distance_warning)
         {
@@ -96,7 +98,9 @@ void Draw()
             }
             if (voicemenu && lastVoicemenu.test_and_set(5000))
                 g_IEngine->ClientCmd_Unrestricted("voicemenu 1 1");
-            AddCenterString(format("Incoming spy! ", (int) (closest_spy_distance / 64 * 1.22f), "m (", spy_count, ")"), colors::yellow);
+            char warning[64];
+            format_to(warning, "Incoming spy! ", (int) (closest_spy_distance / 64 * 1.22f), "m (", spy_count, ")");
+            AddCenterString(warning, colors::yellow);
         }
     }
     else
@@ -12,6 +12,9 @@
 #include <PlayerTools.hpp>
 #include <settings/Bool.hpp>
 #include "Backtrack.hpp"
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 
 namespace hacks::shared::triggerbot
 {
@@ -40,8 +43,85 @@ float target_time = 0.0f;
 int last_hb_traced = 0;
 Vector forward;
 
+// Skip players whose stored ticks are nowhere near the crosshair line
+bool bounds_filter(CachedEntity *entity)
+{
+    if (!hacks::tf2::backtrack::defaultEntFilter(entity))
+        return false;
+    auto bounds = hacks::tf2::backtrack::getTickBounds(entity->m_IDX);
+    Vector hit;
+    return bounds && CheckLineBox(bounds->min, bounds->max, g_pLocalPlayer->v_Eye, forward, hit);
+}
+
+// Hitboxes of one tick in SoA layout, padded to a multiple of 4 with empty boxes
+struct box_set_s
+{
+    static constexpr int MAX_BOXES = 20;
+    alignas(16) float min[3][MAX_BOXES];
+    alignas(16) float max[3][MAX_BOXES];
+    int hitbox[MAX_BOXES];
+    int count;
+};
+
+// Slab test of the segment start -> end against every box in the set. t gets the entry fraction along the segment, or 2 on a miss
+static void IntersectBoxes(const Vector &start, const Vector &end, box_set_s &boxes, float *t)
+{
+    float origin[3] = { start.x, start.y, start.z };
+    float inv[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float delta = end[axis] - start[axis];
+        // Keep the reciprocal finite, a zero delta would turn the slab into NaNs
+        if (std::fabs(delta) < 1e-6f)
+            delta = delta < 0.0f ? -1e-6f : 1e-6f;
+        inv[axis] = 1.0f / delta;
+    }
+    int padded = (boxes.count + 3) & ~3;
+    for (int i = boxes.count; i < padded; i++)
+        for (int axis = 0; axis < 3; axis++)
+        {
+            boxes.min[axis][i] = 1.0f;
+            boxes.max[axis][i] = -1.0f;
+        }
+#if defined(__SSE__)
+    for (int i = 0; i < padded; i += 4)
+    {
+        __m128 tnear = _mm_setzero_ps();
+        __m128 tfar  = _mm_set1_ps(1.0f);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m128 o  = _mm_set1_ps(origin[axis]);
+            __m128 d  = _mm_set1_ps(inv[axis]);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&boxes.min[axis][i]), o), d);
+            __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(&boxes.max[axis][i]), o), d);
+            tnear     = _mm_max_ps(tnear, _mm_min_ps(t1, t2));
+            tfar      = _mm_min_ps(tfar, _mm_max_ps(t1, t2));
+        }
+        // Empty padding boxes have min > max on every axis, so they can never pass this
+        __m128 empty = _mm_cmpgt_ps(_mm_load_ps(&boxes.min[0][i]), _mm_load_ps(&boxes.max[0][i]));
+        __m128 hit   = _mm_andnot_ps(empty, _mm_cmple_ps(tnear, tfar));
+        _mm_storeu_ps(&t[i], _mm_or_ps(_mm_and_ps(hit, tnear), _mm_andnot_ps(hit, _mm_set1_ps(2.0f))));
+    }
+#else
+    for (int i = 0; i < padded; i++)
+    {
+        float tnear = 0.0f;
+        float tfar  = 1.0f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float t1 = (boxes.min[axis][i] - origin[axis]) * inv[axis];
+            float t2 = (boxes.max[axis][i] - origin[axis]) * inv[axis];
+            tnear    = std::max(tnear, std::min(t1, t2));
+            tfar     = std::min(tfar, std::max(t1, t2));
+        }
+        bool empty = boxes.min[0][i] > boxes.max[0][i];
+        t[i]       = !empty && tnear <= tfar ? tnear : 2.0f;
+    }
+#endif
+}
+
 // Filters for backtrack
-bool tick_filter(CachedEntity *entity, hacks::tf2::backtrack::BacktrackData tick)
+bool tick_filter(CachedEntity *entity, const hacks::tf2::backtrack::BacktrackData &tick)
 {
     // Check if it intersects any hitbox
     int num_hitboxes = 18;
@@ -49,11 +129,13 @@ bool tick_filter(CachedEntity *entity, hacks::tf2::backtrack::BacktrackData tick
     // Only need head hitbox
     if (HeadPreferable(entity))
         num_hitboxes = 1;
+    box_set_s boxes;
+    boxes.count = 0;
     for (int i = 0; i < num_hitboxes; i++)
     {
-        auto hitbox = tick.hitboxes.at(i);
-        auto min    = hitbox.min;
-        auto max    = hitbox.max;
+        auto &hitbox = tick.hitbox(i);
+        auto min     = hitbox.min;
+        auto max     = hitbox.max;
         // Get the min and max for the hitbox
         Vector minz(fminf(min.x, max.x), fminf(min.y, max.y), fminf(min.z, max.z));
         Vector maxz(fmaxf(min.x, max.x), fmaxf(min.y, max.y), fmaxf(min.z, max.z));
@@ -67,17 +149,32 @@ bool tick_filter(CachedEntity *entity, hacks::tf2::backtrack::BacktrackData tick
         minz += smod;
         maxz -= smod;
 
-        // Trace and test if it hits the smaller hitbox, if it hits we can return true
-        Vector hit;
-        // Found a good one
-        if (CheckLineBox(minz, maxz, g_pLocalPlayer->v_Eye, forward, hit))
+        for (int axis = 0; axis < 3; axis++)
         {
-            // Is tick visible
-            if (IsVectorVisible(g_pLocalPlayer->v_Eye, hitbox.center))
-                return true;
+            boxes.min[axis][boxes.count] = minz[axis];
+            boxes.max[axis][boxes.count] = maxz[axis];
         }
+        boxes.hitbox[boxes.count++] = i;
+    }
+
+    // Test the crosshair line against all of the smaller hitboxes at once
+    alignas(16) float t[box_set_s::MAX_BOXES];
+    IntersectBoxes(g_pLocalPlayer->v_Eye, forward, boxes, t);
+
+    // Only the nearest hit gets traced, the next one only if that is occluded
+    while (true)
+    {
+        int nearest = -1;
+        for (int i = 0; i < boxes.count; i++)
+            if (t[i] <= 1.0f && (nearest == -1 || t[i] < t[nearest]))
+                nearest = i;
+        if (nearest == -1)
+            return false;
+        // Is tick visible
+        if (IsVectorVisible(g_pLocalPlayer->v_Eye, tick.hitbox(boxes.hitbox[nearest]).center))
+            return true;
+        t[nearest] = 2.0f;
     }
-    return false;
 }
 
 // The main function of the triggerbot
@@ -106,7 +203,7 @@ void CreateMove()
         forward = GetForwardVector(EffectiveTargetingRange(), LOCAL_E);
 
         // Call closest tick with our Tick filter func
-        auto closest_data = hacks::tf2::backtrack::getClosestTick(g_pLocalPlayer->v_Eye, hacks::tf2::backtrack::defaultEntFilter, tick_filter);
+        auto closest_data = hacks::tf2::backtrack::getClosestTick(g_pLocalPlayer->v_Eye, bounds_filter, tick_filter);
 
         // No results, try to grab a building
         if (!closest_data)
@@ -194,7 +291,7 @@ bool ShouldShoot()
         if (IsPlayerInvisible(g_pLocalPlayer->entity, false))
             return false;
 
-        if (IsAmbassador(g_pLocalPlayer->weapon()))
+        if (g_pLocalPlayer->holdingAmbassador())
         {
             // Check if ambasador can headshot
             if (!AmbassadorCanHeadshot())
@@ -404,7 +501,7 @@ CachedEntity *FindEntInSight(float range, bool no_players)
     ray.Init(g_pLocalPlayer->v_Eye, forward);
 
     // Ray trace
-    g_ITrace->TraceRay(ray, 0x4200400B, &trace::filter_default, &trace);
+    trace::TraceRay(ray, 0x4200400B, &trace::filter_default, &trace);
 
     // Return an ent if that is what we hit
     if (trace.m_pEnt)
@@ -442,7 +539,7 @@ bool HeadPreferable(CachedEntity *target)
                 headonly = CanHeadshot();
                 // If player is using an ambassador, set headonly to true
             }
-            else if (IsAmbassador(g_pLocalPlayer->weapon()))
+            else if (g_pLocalPlayer->holdingAmbassador())
             {
                 headonly = true;
             }
@@ -561,7 +658,7 @@ bool UpdateAimkey()
 float EffectiveTargetingRange()
 {
     if (GetWeaponMode() == weapon_melee)
-        return re::C_TFWeaponBaseMelee::GetSwingRange(RAW_ENT(LOCAL_W));
+        return g_pLocalPlayer->melee_range;
     // Pyros only have so much untill their flames hit
     else if (g_pLocalPlayer->weapon()->m_iClassID() == CL_CLASS(CTFFlameThrower))
         return 300.0f;
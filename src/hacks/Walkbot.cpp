@@ -7,10 +7,15 @@
 
 #include "common.hpp"
 #include "hack.hpp"
+#include "memtrack.hpp"
 
 #include <boost/algorithm/string.hpp>
 #include <sys/dir.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <queue>
+#include "jobs.hpp"
 #include <hacks/hacklist.hpp>
 #include <settings/Bool.hpp>
 
@@ -26,18 +31,30 @@ static settings::Boolean draw_connection_flags{ "walkbot.draw.connection-flags",
 
 static settings::Boolean free_move{ "walkbot.free-move", "true" };
 static settings::Int spawn_distance{ "walkbot.edit.node-spawn-distance", "54" };
+static settings::Boolean adaptive_spawn{ "walkbot.edit.adaptive-spawn", "true" };
+static settings::Boolean simplify_recording{ "walkbot.edit.simplify-after-recording", "true" };
 static settings::Int max_distance{ "walkbot.node-max-distance", "100" };
 static settings::Int reach_distance{ "walkbot.node-reach-distance", "32" };
 static settings::Int force_slot{ "walkbot.force-slot", "0" };
 static settings::Boolean leave_if_empty{ "walkbot.leave-if-empty", "false" };
+// Seconds between saves to "autosave" while recording, 0 to disable
+static settings::Int autosave_interval{ "walkbot.autosave-interval", "30" };
 
 using index_t    = unsigned;
 using connection = uint8_t;
 
-constexpr unsigned VERSION           = 2;
+constexpr unsigned VERSION           = 3;
+constexpr unsigned VERSION_LEGACY    = 2;
+constexpr unsigned MAX_NODES         = 32768;
 constexpr index_t BAD_NODE           = unsigned(-1);
 constexpr connection MAX_CONNECTIONS = 6;
 constexpr connection BAD_CONNECTION  = uint8_t(-1);
+// Height change that makes recording spawn a node early, about a step
+constexpr float SPAWN_HEIGHT = 18.0f;
+// cos of the turn that does the same, 20 degrees
+constexpr float SPAWN_TURN_COS = 0.94f;
+// How far off the straight line between its neighbours a node may be and still get simplified away
+constexpr float SIMPLIFY_TOLERANCE = 8.0f;
 
 index_t CreateNode(const Vector &xyz);
 void DeleteNode(index_t node);
@@ -60,14 +77,27 @@ enum EWalkbotState
     WB_REPLAYING
 };
 
-struct walkbot_header_s
+// VERSION_LEGACY files, followed by the map and author strings and the nodes
+struct walkbot_header_legacy_s
 {
-    unsigned version{ VERSION };
+    unsigned version{ VERSION_LEGACY };
     size_t node_count{ 0 };
     size_t map_length{ 0 };
     size_t author_length{ 0 };
 };
 
+// Fixed size, directly followed by node_count nodes
+struct walkbot_header_s
+{
+    uint32_t version{ VERSION };
+    uint32_t node_size{ 0 };
+    uint32_t node_count{ 0 };
+    // CRC32 of the nodes
+    uint32_t crc{ 0 };
+    char map[128]{};
+    char author[64]{};
+};
+
 enum EConnectionFlags
 {
     CF_GOOD       = (1 << 0),
@@ -155,6 +185,16 @@ struct walkbot_node_s
             }
         }
     }
+
+    bool linked(index_t node) const
+    {
+        for (connection i = 0; i < MAX_CONNECTIONS; i++)
+        {
+            if (connections[i].good() and connections[i].node == node)
+                return true;
+        }
+        return false;
+    }
 }; // 40
 
 float distance_2d(Vector &xyz)
@@ -210,13 +250,15 @@ EWalkbotState state{ WB_DISABLED };
 
 // current_user_cmd->buttons state when last node was recorded
 int last_node_buttons{ 0 };
+// Node recorded before active_node, gives the direction the path went
+index_t recorded_before{ BAD_NODE };
 
 // Set to true when bot is moving to nearest node after dying/losing its active
 // node
 bool recovery{ true };
 
 // Time when bot started to move towards next point
-std::chrono::system_clock::time_point time{};
+Timer::clock::time_point time{};
 
 // A little bit too expensive function, finds next free node or creates one if
 // no free slots exist
@@ -236,6 +278,166 @@ index_t free_node()
 using state::node_good;
 using state::nodes;
 
+// Uniform XY grid over the good nodes, so nearest node lookups only visit nodes around the player
+struct node_grid
+{
+    static constexpr float CELL_SIZE = 256.0f;
+
+    float min_x{ 0.0f }, min_y{ 0.0f };
+    int width{ 0 }, height{ 0 };
+    // Nodes in cell c are entries[cell_start[c]] .. entries[cell_start[c + 1] - 1]
+    std::vector<unsigned> cell_start;
+    std::vector<index_t> entries;
+    // Created since the last rebuild, every lookup walks them so recording doesn't rebuild per node
+    static constexpr size_t MAX_RECENT = 256;
+    std::vector<index_t> recent;
+    // Set whenever nodes get deleted or loaded
+    bool dirty{ true };
+
+    void Insert(index_t node)
+    {
+        // Nothing to keep around an empty grid
+        if (!width)
+            dirty = true;
+        if (dirty)
+            return;
+        recent.push_back(node);
+        if (recent.size() > MAX_RECENT)
+            dirty = true;
+    }
+    void Update()
+    {
+        if (!dirty)
+            return;
+        dirty = false;
+        width = height = 0;
+        cell_start.clear();
+        entries.clear();
+        recent.clear();
+        float max_x = -FLT_MAX, max_y = -FLT_MAX;
+        min_x = min_y = FLT_MAX;
+        for (index_t i = 0; i < nodes.size(); i++)
+        {
+            if (!node_good(i))
+                continue;
+            min_x = std::min(min_x, nodes[i].x);
+            min_y = std::min(min_y, nodes[i].y);
+            max_x = std::max(max_x, nodes[i].x);
+            max_y = std::max(max_y, nodes[i].y);
+        }
+        if (min_x > max_x)
+            return;
+        width  = int((max_x - min_x) / CELL_SIZE) + 1;
+        height = int((max_y - min_y) / CELL_SIZE) + 1;
+
+        // Count, prefix sum, fill
+        cell_start.assign(width * height + 1, 0);
+        for (index_t i = 0; i < nodes.size(); i++)
+            if (node_good(i))
+                cell_start[Cell(i) + 1]++;
+        for (size_t i = 1; i < cell_start.size(); i++)
+            cell_start[i] += cell_start[i - 1];
+        entries.resize(cell_start.back());
+        std::vector<unsigned> fill(cell_start.begin(), cell_start.end() - 1);
+        for (index_t i = 0; i < nodes.size(); i++)
+            if (node_good(i))
+                entries[fill[Cell(i)]++] = i;
+    }
+    int CellX(float x) const
+    {
+        return std::clamp(int((x - min_x) / CELL_SIZE), 0, width - 1);
+    }
+    int CellY(float y) const
+    {
+        return std::clamp(int((y - min_y) / CELL_SIZE), 0, height - 1);
+    }
+    int Cell(index_t node) const
+    {
+        return CellY(nodes[node].y) * width + CellX(nodes[node].x);
+    }
+    template <typename F> void ForCell(int x, int y, F callback) const
+    {
+        if (x < 0 || y < 0 || x >= width || y >= height)
+            return;
+        int cell = y * width + x;
+        for (unsigned i = cell_start[cell]; i < cell_start[cell + 1]; i++)
+            callback(entries[i]);
+    }
+    template <typename F> void ForRecent(F callback) const
+    {
+        for (index_t node : recent)
+            if (node_good(node))
+                callback(node);
+    }
+    // Every node that can be within radius of origin in 2D, callers check the actual distance
+    template <typename F> void ForNear(const Vector &origin, float radius, F callback) const
+    {
+        ForRecent(callback);
+        if (!width)
+            return;
+        int x0 = CellX(origin.x - radius), x1 = CellX(origin.x + radius);
+        int y0 = CellY(origin.y - radius), y1 = CellY(origin.y + radius);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                ForCell(x, y, callback);
+    }
+    // Cells at chebyshev distance ring from (x, y), the recent nodes count as ring 0
+    template <typename F> void ForRing(int x, int y, int ring, F callback) const
+    {
+        if (!ring)
+        {
+            ForRecent(callback);
+            return ForCell(x, y, callback);
+        }
+        for (int i = -ring; i <= ring; i++)
+        {
+            ForCell(x + i, y - ring, callback);
+            ForCell(x + i, y + ring, callback);
+        }
+        for (int i = -ring + 1; i < ring; i++)
+        {
+            ForCell(x - ring, y + i, callback);
+            ForCell(x + ring, y + i, callback);
+        }
+    }
+};
+
+namespace state
+{
+node_grid grid{};
+
+// Planned route to a health/ammo connection, next node last
+std::vector<index_t> route{};
+// Connection flag the route leads to
+unsigned route_flag{ 0 };
+
+// Bumped by NodesChanged and NodesEdited, lets autosave skip rounds where nothing was recorded
+unsigned generation{ 0 };
+} // namespace state
+
+// Call after deleting or loading nodes
+void NodesChanged()
+{
+    state::grid.dirty = true;
+    state::route.clear();
+    state::generation++;
+}
+
+// Call after editing flags or links in place, nothing moved so the grid stays
+void NodesEdited()
+{
+    state::route.clear();
+    state::generation++;
+}
+
+// Cheaper NodesChanged for a single new node
+void NodeCreated(index_t node)
+{
+    state::grid.Insert(node);
+    state::route.clear();
+    state::generation++;
+}
+
 bool HasLowAmmo()
 {
     int *weapon_list = (int *) ((unsigned) (RAW_ENT(LOCAL_E)) + netvar.hMyWeapons);
@@ -274,18 +476,14 @@ void DeleteNode(index_t node)
         }
     }
     memset(&n, 0, sizeof(walkbot_node_s));
+    NodesChanged();
 }
 
-#define BINARY_FILE_WRITE(handle, data) handle.write(reinterpret_cast<const char *>(&data), sizeof(data))
 #define BINARY_FILE_READ(handle, data) handle.read(reinterpret_cast<char *>(&data), sizeof(data))
 
-void Save(std::string filename)
+// Directory holding the walkbot files of the current map, created if it's missing
+std::string LevelDirectory()
 {
-    if (g_Settings.bInvalid)
-    {
-        logging::Info("Not in-game, cannot save!");
-        return;
-    }
     {
         DIR *walkbot_dir = opendir(paths::getDataPath("/walkbot").c_str());
         if (!walkbot_dir)
@@ -307,75 +505,73 @@ void Save(std::string filename)
         else
             closedir(level_dir);
     }
-    logging::Info("Saving in %s", format(path, "/", filename).c_str());
-    try
-    {
-        std::ofstream file(format(path, "/", filename), std::ios::out | std::ios::binary);
-        if (not file)
-        {
-            logging::Info("Could not open file!");
-            return;
-        }
-        walkbot_header_s header;
-        header.node_count    = state::nodes.size();
-        const char *name     = g_ISteamFriends->GetPersonaName();
-        const char *map      = g_IEngine->GetLevelName();
-        size_t name_s        = strlen(name);
-        size_t map_s         = strlen(map);
-        header.author_length = name_s;
-        header.map_length    = map_s;
-        BINARY_FILE_WRITE(file, header);
-        file.write(map, map_s);
-        file.write(name, name_s);
-        file.write(reinterpret_cast<const char *>(state::nodes.data()), sizeof(walkbot_node_s) * header.node_count);
-        file.close();
-        logging::Info("Writing successful");
-    }
-    catch (std::exception &e)
-    {
-        logging::Info("Writing unsuccessful: %s", e.what());
-    }
+    return path;
 }
 
-bool Load(std::string filename)
+uint32_t NodesCRC(const walkbot_node_s *data, size_t count)
 {
+    CRC32_t crc;
+    CRC32_Init(&crc);
+    CRC32_ProcessBuffer(&crc, data, sizeof(walkbot_node_s) * count);
+    CRC32_Final(&crc);
+    return crc;
+}
+
+// Background saves in flight, autosave skips a round while one is still writing
+static std::atomic<int> saves_pending{ 0 };
+
+// Copies the nodes and writes them out on the job pool
+void Save(std::string filename)
+{
+    if (g_Settings.bInvalid)
     {
-        DIR *walkbot_dir = opendir(paths::getDataPath("/walkbot").c_str());
-        if (!walkbot_dir)
-        {
-            logging::Info("Walkbot directory doesn't exist!");
-            return false;
-        }
-        else
-            closedir(walkbot_dir);
+        logging::Info("Not in-game, cannot save!");
+        return;
     }
-    std::string path = paths::getDataPath("/walkbot/" + GetLevelName());
-    {
-        DIR *level_dir = opendir(path.c_str());
-        if (!level_dir)
+    std::string path = format(LevelDirectory(), "/", filename);
+    logging::Info("Saving in %s", path.c_str());
+
+    walkbot_header_s header;
+    header.node_size  = sizeof(walkbot_node_s);
+    header.node_count = state::nodes.size();
+    header.crc        = NodesCRC(state::nodes.data(), state::nodes.size());
+    std::strncpy(header.map, g_IEngine->GetLevelName(), sizeof(header.map) - 1);
+    std::strncpy(header.author, g_ISteamFriends->GetPersonaName(), sizeof(header.author) - 1);
+    auto data = std::make_shared<std::vector<walkbot_node_s>>(state::nodes);
+
+    static std::atomic<unsigned> temp_counter{ 0 };
+    std::string temp = format(path, ".tmp", temp_counter++);
+    saves_pending++;
+    jobs::Background([header, data, path, temp]() {
         {
-            logging::Info("Walkbot directory for %s doesn't exist, creating one!", GetLevelName().c_str());
-            mkdir(path.c_str(), S_IRWXU | S_IRWXG);
+            std::ofstream file(temp, std::ios::out | std::ios::binary);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(data->data()), sizeof(walkbot_node_s) * data->size());
+            file.close();
+            // Readers only ever see complete files
+            if (file && !std::rename(temp.c_str(), path.c_str()))
+                logging::Info("Writing successful");
+            else
+            {
+                logging::Info("Writing unsuccessful: %s", strerror(errno));
+                std::remove(temp.c_str());
+            }
         }
-        else
-            closedir(level_dir);
-    }
+        saves_pending--;
+    });
+}
+
+bool LoadLegacy(const std::string &path)
+{
     try
     {
-        std::ifstream file(format(path, "/", filename), std::ios::in | std::ios::binary);
+        std::ifstream file(path, std::ios::in | std::ios::binary);
         if (!file)
         {
             return false;
         }
-        walkbot_header_s header;
+        walkbot_header_legacy_s header;
         BINARY_FILE_READ(file, header);
-        // FIXME magic number: 1
-        if (header.version != VERSION)
-        {
-            logging::Info("Outdated/corrupted walkbot file! Cannot load this.");
-            file.close();
-            return false;
-        }
         if (header.author_length > 64 or header.map_length > 512 or (not header.author_length or not header.map_length))
         {
             logging::Info("Corrupted author/level data");
@@ -392,14 +588,15 @@ bool Load(std::string filename)
         }
         state::nodes.clear();
         logging::Info("Reading %i entries...", header.node_count);
-        if (header.node_count > 32768)
+        if (header.node_count > MAX_NODES)
         {
-            logging::Info("Read %d nodes, max is %d. Aborting.", header.node_count, 32768);
+            logging::Info("Read %d nodes, max is %d. Aborting.", header.node_count, MAX_NODES);
             return false;
         }
         state::nodes.resize(header.node_count);
         file.read(reinterpret_cast<char *>(state::nodes.data()), sizeof(walkbot_node_s) * header.node_count);
         file.close();
+        NodesChanged();
         logging::Info("Reading successful! Result: %i entries.", state::nodes.size());
         return true;
     }
@@ -410,6 +607,66 @@ bool Load(std::string filename)
     return false;
 }
 
+bool Load(std::string filename)
+{
+    {
+        DIR *walkbot_dir = opendir(paths::getDataPath("/walkbot").c_str());
+        if (!walkbot_dir)
+        {
+            logging::Info("Walkbot directory doesn't exist!");
+            return false;
+        }
+        else
+            closedir(walkbot_dir);
+    }
+    std::string path = format(LevelDirectory(), "/", filename);
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) || size_t(st.st_size) < sizeof(uint32_t))
+    {
+        close(fd);
+        logging::Info("Outdated/corrupted walkbot file! Cannot load this.");
+        return false;
+    }
+    void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    bool result = false;
+    uint32_t version;
+    std::memcpy(&version, mapping, sizeof(version));
+    if (version == VERSION_LEGACY)
+        result = LoadLegacy(path);
+    else if (version == VERSION && size_t(st.st_size) >= sizeof(walkbot_header_s))
+    {
+        walkbot_header_s header;
+        std::memcpy(&header, mapping, sizeof(header));
+        auto data = reinterpret_cast<const walkbot_node_s *>(static_cast<const char *>(mapping) + sizeof(header));
+        header.map[sizeof(header.map) - 1]       = 0;
+        header.author[sizeof(header.author) - 1] = 0;
+        if (header.node_size != sizeof(walkbot_node_s) || header.node_count > MAX_NODES || size_t(st.st_size) != sizeof(header) + sizeof(walkbot_node_s) * header.node_count)
+            logging::Info("Outdated/corrupted walkbot file! Cannot load this.");
+        else if (NodesCRC(data, header.node_count) != header.crc)
+            logging::Info("Walkbot file failed its checksum, not loading it.");
+        else
+        {
+            logging::Info("Walkbot navigation map for %s\nAuthor: %s", header.map, header.author);
+            state::nodes.assign(data, data + header.node_count);
+            NodesChanged();
+            logging::Info("Reading successful! Result: %i entries.", state::nodes.size());
+            result = true;
+        }
+    }
+    else
+        logging::Info("Outdated/corrupted walkbot file! Cannot load this.");
+    munmap(mapping, st.st_size);
+    return result;
+}
+
 static CatCommand save("wb_save", "Save", [](const CCommand &args) {
     logging::Info("Saving");
     std::string filename = "default";
@@ -437,17 +694,22 @@ index_t CreateNode(const Vector &xyz)
     memset(&n, 0, sizeof(n));
     n.xyz() = xyz;
     n.flags |= NF_GOOD;
+    NodeCreated(node);
     return node;
 }
 
-CatCommand c_start_recording("wb_record", "Start recording", []() { state::state = WB_RECORDING; });
-CatCommand c_start_editing("wb_edit", "Start editing", []() { state::state = WB_EDITING; });
+void SetState(EWalkbotState next);
+void Simplify();
+
+CatCommand c_start_recording("wb_record", "Start recording", []() { SetState(WB_RECORDING); });
+CatCommand c_start_editing("wb_edit", "Start editing", []() { SetState(WB_EDITING); });
 CatCommand c_start_replaying("wb_replay", "Start replaying", []() {
+    SetState(WB_REPLAYING);
     state::last_node   = state::active_node;
     state::active_node = state::closest_node;
-    state::state       = WB_REPLAYING;
 });
-CatCommand c_exit("wb_exit", "Exit", []() { state::state = WB_DISABLED; });
+CatCommand c_exit("wb_exit", "Exit", []() { SetState(WB_DISABLED); });
+CatCommand c_simplify("wb_simplify", "Remove nodes on straight lines between their neighbours", []() { Simplify(); });
 
 // Selects closest node, clears selection if node is selected
 CatCommand c_select_node("wb_select", "Select node", []() {
@@ -511,6 +773,7 @@ CatCommand c_connect_node("wb_connect", "Connect nodes", []() {
 
     a.link(state::closest_node);
     b.link(state::active_node);
+    NodesEdited();
 });
 // Makes a one-way connection
 CatCommand c_connect_single_node("wb_connect_single", "Connect nodes (one-way)", []() {
@@ -523,6 +786,7 @@ CatCommand c_connect_single_node("wb_connect_single", "Connect nodes (one-way)",
     auto &a = state::nodes[state::active_node];
 
     a.link(state::closest_node);
+    NodesEdited();
 });
 // Connects selected node to closest one
 CatCommand c_disconnect_node("wb_disconnect", "Disconnect nodes", []() {
@@ -537,6 +801,7 @@ CatCommand c_disconnect_node("wb_disconnect", "Disconnect nodes", []() {
 
     a.unlink(state::closest_node);
     b.unlink(state::active_node);
+    NodesEdited();
 });
 // Makes a one-way connection
 CatCommand c_disconnect_single_node("wb_disconnect_single", "Connect nodes (one-way)", []() {
@@ -549,6 +814,7 @@ CatCommand c_disconnect_single_node("wb_disconnect_single", "Connect nodes (one-
     auto &a = state::nodes[state::active_node];
 
     a.unlink(state::closest_node);
+    NodesEdited();
 });
 // Toggles jump flag on closest node
 CatCommand c_update_duck("wb_duck", "Toggle duck flag", []() {
@@ -561,6 +827,7 @@ CatCommand c_update_duck("wb_duck", "Toggle duck flag", []() {
         n.flags &= ~NF_DUCK;
     else
         n.flags |= NF_DUCK;
+    NodesEdited();
 });
 // Toggles jump flag on closest node
 CatCommand c_update_jump("wb_jump", "Toggle jump flag", []() {
@@ -573,6 +840,7 @@ CatCommand c_update_jump("wb_jump", "Toggle jump flag", []() {
         n.flags &= ~NF_JUMP;
     else
         n.flags |= NF_JUMP;
+    NodesEdited();
 });
 // Assuming node is good and conn is in range [0; MAX_CONNECTIONS)
 std::string DescribeConnection(index_t node, connection conn)
@@ -604,49 +872,21 @@ std::string DescribeConnection(index_t node, connection conn)
         {
             extra += "S";
         }
+        if (c.flags & CF_RED)
+        {
+            extra += "R";
+        }
+        if (c.flags & CF_BLU)
+        {
+            extra += "B";
+        }
     }
     std::string result = format(node, ' ', (broken ? "-x>" : (oneway ? "-->" : "<->")), ' ', c.node, ' ', extra);
     return result;
 }
-CatCommand c_toggle_cf_ammo("wb_conn_ammo", "Toggle 'ammo' flag on connection from ACTIVE to CLOSEST node", []() {
-    auto a = state::active();
-    auto b = state::closest();
-    if (not(a and b))
-        return;
-    for (connection i = 0; i < MAX_CONNECTIONS; i++)
-    {
-        auto &c = a->connections[i];
-        if (c.free())
-            continue;
-        if (c.node != state::closest_node)
-            continue;
-        // Actually flip the flag
-        if (c.flags & CF_LOW_AMMO)
-            c.flags &= ~CF_LOW_AMMO;
-        else
-            c.flags |= CF_LOW_AMMO;
-    }
-});
-CatCommand c_toggle_cf_health("wb_conn_health", "Toggle 'health' flag on connection from ACTIVE to CLOSEST node", []() {
-    auto a = state::active();
-    auto b = state::closest();
-    if (not(a and b))
-        return;
-    for (connection i = 0; i < MAX_CONNECTIONS; i++)
-    {
-        auto &c = a->connections[i];
-        if (c.free())
-            continue;
-        if (c.node != state::closest_node)
-            continue;
-        // Actually flip the flag
-        if (c.flags & CF_LOW_HEALTH)
-            c.flags &= ~CF_LOW_HEALTH;
-        else
-            c.flags |= CF_LOW_HEALTH;
-    }
-});
-CatCommand c_toggle_cf_sticky("wb_conn_sticky", "Toggle 'Sticky' flag on connection from ACTIVE to CLOSEST node", []() {
+// Toggles a flag on the connection from ACTIVE to CLOSEST node
+void ToggleConnectionFlag(unsigned flag)
+{
     auto a = state::active();
     auto b = state::closest();
     if (not(a and b))
@@ -659,12 +899,15 @@ CatCommand c_toggle_cf_sticky("wb_conn_sticky", "Toggle 'Sticky' flag on connect
         if (c.node != state::closest_node)
             continue;
         // Actually flip the flag
-        if (c.flags & CF_STICKYBOMB)
-            c.flags &= ~CF_STICKYBOMB;
-        else
-            c.flags |= CF_STICKYBOMB;
+        c.flags ^= flag;
     }
-});
+    NodesEdited();
+}
+CatCommand c_toggle_cf_ammo("wb_conn_ammo", "Toggle 'ammo' flag on connection from ACTIVE to CLOSEST node", []() { ToggleConnectionFlag(CF_LOW_AMMO); });
+CatCommand c_toggle_cf_health("wb_conn_health", "Toggle 'health' flag on connection from ACTIVE to CLOSEST node", []() { ToggleConnectionFlag(CF_LOW_HEALTH); });
+CatCommand c_toggle_cf_sticky("wb_conn_sticky", "Toggle 'Sticky' flag on connection from ACTIVE to CLOSEST node", []() { ToggleConnectionFlag(CF_STICKYBOMB); });
+CatCommand c_toggle_cf_red("wb_conn_red", "Toggle 'RED only' flag on connection from ACTIVE to CLOSEST node", []() { ToggleConnectionFlag(CF_RED); });
+CatCommand c_toggle_cf_blu("wb_conn_blu", "Toggle 'BLU only' flag on connection from ACTIVE to CLOSEST node", []() { ToggleConnectionFlag(CF_BLU); });
 // Displays all info about closest node and its connections
 CatCommand c_info("wb_dump", "Show info", []() {
     index_t node = state::closest_node;
@@ -720,7 +963,10 @@ CatCommand c_delete_region("wb_delete_region", "Delete region of nodes", []() {
     } while (state::node_good(current) and (current != a));*/
 });
 // Clears the state
-CatCommand c_clear("wb_clear", "Removes all nodes", []() { state::nodes.clear(); });
+CatCommand c_clear("wb_clear", "Removes all nodes", []() {
+    state::nodes.clear();
+    NodesChanged();
+});
 
 void Initialize()
 {
@@ -728,57 +974,140 @@ void Initialize()
 
 void UpdateClosestNode()
 {
-    float n_fov   = 360.0f;
+    // Same as the smallest GetFov, but without an angle calculation and acos per node every tick
+    static const float MAX_FOV_COS = cosf(DEG2RAD(10.0f));
+    Vector forward;
+    MakeVector(g_pLocalPlayer->v_OrigViewangles, forward);
+    float n_cos   = MAX_FOV_COS;
     index_t n_idx = BAD_NODE;
 
     for (index_t i = 0; i < state::nodes.size(); i++)
     {
         auto &node = state::nodes[i];
 
-        if (not node.flags & NF_GOOD)
+        if (not(node.flags & NF_GOOD))
             continue;
-        // Eclipse shits itself when it sees Vector& beung used as Vector in
-        // GetFov
-        float fov = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, node.xyz());
-        if (fov < n_fov)
-        {
-            n_fov = fov;
-            n_idx = i;
-        }
+        Vector delta = node.xyz() - g_pLocalPlayer->v_Eye;
+        float dot    = forward.Dot(delta);
+        // Behind us, or further off than the best one so far
+        if (dot <= 0.0f || dot * dot <= n_cos * n_cos * delta.LengthSqr())
+            continue;
+        n_cos = dot / delta.Length();
+        n_idx = i;
     }
 
     // Don't select a node if you don't even look at it
-    if (n_fov < 10)
-        state::closest_node = n_idx;
-    else
-        state::closest_node = BAD_NODE;
+    state::closest_node = n_idx;
 }
 
 // Finds nearest node by position, not FOV
 // Not to be confused with FindClosestNode
 index_t FindNearestNode(bool traceray)
 {
-    index_t r_node{ BAD_NODE };
-    float r_dist{ 65536.0f };
+    state::grid.Update();
+    if (!state::grid.width)
+        return BAD_NODE;
 
-    for (index_t i = 0; i < state::nodes.size(); i++)
+    const Vector &origin = g_pLocalPlayer->v_Origin;
+    int cell_x = state::grid.CellX(origin.x), cell_y = state::grid.CellY(origin.y);
+    int max_ring = std::max(state::grid.width, state::grid.height);
+    // Found but not checked yet, closest last
+    std::vector<std::pair<float, index_t>> pending;
+    for (int ring = 0; ring <= max_ring; ring++)
     {
-        if (state::node_good(i))
+        state::grid.ForRing(cell_x, cell_y, ring, [&](index_t i) {
+            float dist = distance_2d(nodes[i].xyz());
+            if (dist < 65536.0f)
+                pending.emplace_back(dist, i);
+        });
+        std::sort(pending.begin(), pending.end(), std::greater<std::pair<float, index_t>>());
+        // Nodes in cells further out are at least this far away, so everything closer can be checked in order
+        float bound = ring == max_ring ? FLT_MAX : ring * node_grid::CELL_SIZE;
+        while (!pending.empty() && pending.back().first <= bound)
         {
-            auto &n = state::nodes[i];
-            if (traceray and not IsVectorVisible(g_pLocalPlayer->v_Eye, n.xyz()))
+            index_t node = pending.back().second;
+            pending.pop_back();
+            if (not traceray or IsVectorVisible(g_pLocalPlayer->v_Eye, nodes[node].xyz()))
+                return node;
+        }
+    }
+    return BAD_NODE;
+}
+
+// Team restricted connections can only be used by that team
+bool TeamAllowed(unsigned flags)
+{
+    if ((flags & CF_RED) && g_pLocalPlayer->team != TEAM_RED)
+        return false;
+    if ((flags & CF_BLU) && g_pLocalPlayer->team != TEAM_BLU)
+        return false;
+    return true;
+}
+
+// Shortest route from a node to the closest connection with flag, next node last. Empty if there is none
+std::vector<index_t> PlanRoute(index_t from, unsigned flag)
+{
+    std::vector<float> dist(nodes.size(), INFINITY);
+    std::vector<index_t> parent(nodes.size(), BAD_NODE);
+    typedef std::pair<float, index_t> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    float best          = INFINITY;
+    index_t best_before = BAD_NODE, best_node = BAD_NODE;
+
+    dist[from] = 0.0f;
+    open.emplace(0.0f, from);
+    while (!open.empty())
+    {
+        auto [cost, current] = open.top();
+        open.pop();
+        if (cost >= best)
+            break;
+        if (cost > dist[current])
+            continue;
+        auto &n = nodes[current];
+        for (connection i = 0; i < MAX_CONNECTIONS; i++)
+        {
+            auto &c = n.connections[i];
+            if (c.free() or not node_good(c.node) or (c.flags & CF_STICKYBOMB) or not TeamAllowed(c.flags))
+                continue;
+            float next_cost = cost + n.xyz().DistTo(nodes[c.node].xyz());
+            // Health and ammo connections are only walked when they are needed
+            if (c.flags & (CF_LOW_AMMO | CF_LOW_HEALTH))
+            {
+                if ((c.flags & flag) && next_cost < best)
+                {
+                    best        = next_cost;
+                    best_before = current;
+                    best_node   = c.node;
+                }
                 continue;
-            float dist = distance_2d(n.xyz());
-            if (dist < r_dist)
+            }
+            if (next_cost < dist[c.node])
             {
-                r_dist = dist;
-                r_node = i;
+                dist[c.node]   = next_cost;
+                parent[c.node] = current;
+                open.emplace(next_cost, c.node);
             }
         }
     }
 
-    return r_node;
+    std::vector<index_t> route;
+    if (best_node == BAD_NODE)
+        return route;
+    route.push_back(best_node);
+    for (index_t i = best_before; i != from; i = parent[i])
+        route.push_back(i);
+    return route;
 }
+
+bool IsConnected(index_t from, index_t to)
+{
+    for (connection i = 0; i < MAX_CONNECTIONS; i++)
+        if (nodes[from].connections[i].good() and nodes[from].connections[i].node == to)
+            return true;
+    return false;
+}
+
 int begansticky = 0;
 index_t SelectNextNode()
 {
@@ -786,20 +1115,31 @@ index_t SelectNextNode()
     {
         return FindNearestNode(true);
     }
+    // Head for the closest ammo/health connection when we need one, instead of only taking it when it's right next to us
+    unsigned wanted = HasLowAmmo() ? CF_LOW_AMMO : (HasLowHealth() ? CF_LOW_HEALTH : 0);
+    if (wanted)
+    {
+        if (state::route_flag != wanted or state::route.empty() or not IsConnected(state::active_node, state::route.back()))
+        {
+            state::route      = PlanRoute(state::active_node, wanted);
+            state::route_flag = wanted;
+        }
+        if (not state::route.empty())
+        {
+            index_t next = state::route.back();
+            state::route.pop_back();
+            return next;
+        }
+    }
+    else
+        state::route.clear();
+
     auto &n = state::nodes[state::active_node];
     std::vector<index_t> chance{};
     for (index_t i = 0; i < MAX_CONNECTIONS; i++)
     {
-        if (n.connections[i].good() and n.connections[i].node != state::last_node and node_good(n.connections[i].node))
+        if (n.connections[i].good() and n.connections[i].node != state::last_node and node_good(n.connections[i].node) and TeamAllowed(n.connections[i].flags))
         {
-            if (HasLowAmmo() && (n.connections[i].flags & CF_LOW_AMMO))
-            {
-                return n.connections[i].node;
-            }
-            if (HasLowHealth() && (n.connections[i].flags & CF_LOW_HEALTH))
-            {
-                return n.connections[i].node;
-            }
             if (not(n.connections[i].flags & (CF_LOW_AMMO | CF_LOW_HEALTH)) && not(n.connections[i].flags & CF_STICKYBOMB))
                 chance.push_back(n.connections[i].node);
             if ((n.connections[i].flags & CF_STICKYBOMB) && g_pLocalPlayer->clazz == tf_demoman)
@@ -892,7 +1232,7 @@ void UpdateWalker()
         current_user_cmd->buttons |= IN_JUMP;
         jump_ticks--;
     }
-    bool timeout = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - state::time).count() > 1;
+    bool timeout = std::chrono::duration_cast<std::chrono::seconds>(Timer::Now() - state::time).count() > 1;
     if (not state::node_good(state::active_node) or timeout)
     {
         state::active_node = FindNearestNode(true);
@@ -918,7 +1258,7 @@ void UpdateWalker()
         index_t last       = state::active_node;
         state::active_node = SelectNextNode();
         state::last_node   = last;
-        state::time        = std::chrono::system_clock::now();
+        state::time        = Timer::Now();
         if (state::node_good(state::active_node))
         {
             if (state::nodes[state::active_node].flags & NF_JUMP)
@@ -953,24 +1293,71 @@ bool ShouldSpawnNode()
         return true;
 
     auto &node = state::nodes[state::active_node];
+    float dist = distance_2d(node.xyz());
 
-    if (distance_2d(node.xyz()) > *spawn_distance)
-    {
+    if (!adaptive_spawn)
+        return dist > *spawn_distance;
+    // Straight runs get longer segments, still short enough for replaying to not lose the next node
+    if (dist > std::max(*spawn_distance, *max_distance - *reach_distance))
         return true;
-    }
+    if (dist < *spawn_distance / 2)
+        return false;
+    // Stairs and ramps
+    if (fabsf(g_pLocalPlayer->v_Origin.z - node.z) > SPAWN_HEIGHT)
+        return true;
+    // Nothing to measure a turn against yet
+    if (not state::node_good(state::recorded_before))
+        return dist > *spawn_distance;
+
+    // Turning away from the direction the last segment went
+    auto &before = state::nodes[state::recorded_before];
+    Vector2D last(node.x - before.x, node.y - before.y);
+    Vector2D now(g_pLocalPlayer->v_Origin.x - node.x, g_pLocalPlayer->v_Origin.y - node.y);
+    float lengths = last.Length() * now.Length();
+    return lengths > 0.0f && last.Dot(now) < SPAWN_TURN_COS * lengths;
+}
 
-    return false;
+// Already recorded node we're standing on, so walking a route twice doesn't record it twice
+index_t FindRecordedNode(unsigned flags)
+{
+    index_t found        = BAD_NODE;
+    float best_dist      = *reach_distance;
+    const Vector &origin = g_pLocalPlayer->v_Origin;
+    state::grid.Update();
+    state::grid.ForNear(origin, best_dist, [&](index_t i) {
+        auto &n = nodes[i];
+        if (i == state::active_node || (n.flags & (NF_DUCK | NF_JUMP)) != flags || fabsf(n.z - origin.z) > SPAWN_HEIGHT)
+            return;
+        float dist = distance_2d(n.xyz());
+        if (dist < best_dist)
+        {
+            best_dist = dist;
+            found     = i;
+        }
+    });
+    // Same spot on the other side of a thin wall or floor
+    if (found != BAD_NODE && !IsVectorVisible(g_pLocalPlayer->v_Eye, nodes[found].xyz() + Vector(0, 0, SPAWN_HEIGHT), true))
+        return BAD_NODE;
+    return found;
 }
 
 void RecordNode()
 {
-    index_t node = CreateNode(g_pLocalPlayer->v_Origin);
-    auto &n      = state::nodes[node];
+    unsigned flags = 0;
     if (current_user_cmd->buttons & IN_DUCK)
-        n.flags |= NF_DUCK;
+        flags |= NF_DUCK;
     if (current_user_cmd->buttons & IN_JUMP)
-        n.flags |= NF_JUMP;
-    if (state::node_good(state::active_node))
+        flags |= NF_JUMP;
+    index_t node = FindRecordedNode(flags);
+    if (node != BAD_NODE)
+        logging::Info("[wb] Reusing node %u", node);
+    else
+    {
+        node = CreateNode(g_pLocalPlayer->v_Origin);
+        state::nodes[node].flags |= flags;
+    }
+    auto &n = state::nodes[node];
+    if (state::node_good(state::active_node) && !n.linked(state::active_node))
     {
         auto &c = state::nodes[state::active_node];
         n.link(state::active_node);
@@ -978,9 +1365,108 @@ void RecordNode()
         logging::Info("[wb] Node %u auto-linked to node %u at (%.2f %.2f %.2f)", node, state::active_node, c.x, c.y, c.z);
     }
     state::last_node_buttons = current_user_cmd->buttons;
+    state::recorded_before   = state::active_node;
     state::active_node       = node;
 }
 
+// Removes recorded nodes that sit on a straight, walkable line between their two neighbours
+void Simplify()
+{
+    float max_length = std::max(*spawn_distance, *max_distance - *reach_distance);
+    unsigned removed = 0;
+    // Nodes already removed from between the two ends of a new link. Later removals are checked against those too,
+    // otherwise a run of them could drift off the recorded path one tolerance at a time
+    std::map<std::pair<index_t, index_t>, std::vector<Vector>> collapsed;
+    auto edge = [](index_t x, index_t y) { return std::make_pair(std::min(x, y), std::max(x, y)); };
+    for (index_t i = 0; i < nodes.size(); i++)
+    {
+        auto &n = nodes[i];
+        // Jump and duck nodes mark where the buttons change
+        if (not node_good(i) or (n.flags & (NF_DUCK | NF_JUMP)))
+            continue;
+        index_t ends[2];
+        int count  = 0;
+        bool plain = true;
+        for (connection c = 0; c < MAX_CONNECTIONS; c++)
+        {
+            if (n.connections[c].free())
+                continue;
+            if (count == 2 or n.connections[c].flags != CF_GOOD)
+            {
+                plain = false;
+                break;
+            }
+            ends[count++] = n.connections[c].node;
+        }
+        if (not plain or count != 2 or ends[0] == ends[1] or not node_good(ends[0]) or not node_good(ends[1]) or nodes[ends[0]].linked(ends[1]))
+            continue;
+        auto &a = nodes[ends[0]];
+        auto &b = nodes[ends[1]];
+        // Connections back to us have to be plain as well, they get replaced
+        bool back_plain = true;
+        for (auto *end : { &a, &b })
+            for (connection c = 0; c < MAX_CONNECTIONS; c++)
+                if (end->connections[c].good() and end->connections[c].node == i and end->connections[c].flags != CF_GOOD)
+                    back_plain = false;
+        if (not back_plain or not a.linked(i) or not b.linked(i))
+            continue;
+
+        Vector ab    = b.xyz() - a.xyz();
+        float length = ab.Length();
+        if (length > max_length or length < 1.0f)
+            continue;
+        // The node and everything removed on either side of it have to stay close to the line between its neighbours
+        std::vector<Vector> chain{ n.xyz() };
+        for (index_t end : ends)
+        {
+            auto found = collapsed.find(edge(i, end));
+            if (found != collapsed.end())
+                chain.insert(chain.end(), found->second.begin(), found->second.end());
+        }
+        bool straight = true;
+        for (auto &point : chain)
+        {
+            float along = std::clamp((point - a.xyz()).Dot(ab) / (length * length), 0.0f, 1.0f);
+            if ((a.xyz() + ab * along).DistTo(point) > SIMPLIFY_TOLERANCE)
+            {
+                straight = false;
+                break;
+            }
+        }
+        if (not straight)
+            continue;
+        if (not IsVectorVisibleNavigation(a.xyz() + Vector(0, 0, SPAWN_HEIGHT), b.xyz() + Vector(0, 0, SPAWN_HEIGHT)))
+            continue;
+
+        a.unlink(i);
+        b.unlink(i);
+        a.link(ends[1]);
+        b.link(ends[0]);
+        collapsed.erase(edge(i, ends[0]));
+        collapsed.erase(edge(i, ends[1]));
+        collapsed[edge(ends[0], ends[1])] = std::move(chain);
+        memset(&n, 0, sizeof(walkbot_node_s));
+        removed++;
+    }
+    if (removed)
+    {
+        logging::Info("[wb] Simplified away %u nodes", removed);
+        // Their slots get reused by the next CreateNode
+        for (index_t *node : { &state::active_node, &state::last_node, &state::closest_node, &state::recorded_before })
+            if (not node_good(*node))
+                *node = BAD_NODE;
+        NodesChanged();
+    }
+}
+
+void SetState(EWalkbotState next)
+{
+    if (state::state == WB_RECORDING && next != WB_RECORDING && simplify_recording)
+        Simplify();
+    state::recorded_before = BAD_NODE;
+    state::state           = next;
+}
+
 #if ENABLE_VISUALS
 
 // Draws a single colored connection between 2 nodes
@@ -1139,11 +1625,13 @@ void OnLevelInit()
     if (leave_if_empty && state::state == WB_REPLAYING)
     {
         nodes.clear();
+        NodesChanged();
     }
 }
 
 Timer quit_timer{};
 Timer map_check{};
+Timer autosave_timer{};
 int erasedelay = 0;
 static void cm()
 {
@@ -1160,6 +1648,12 @@ static void cm()
         {
             RecordNode();
         }
+        static unsigned saved_generation = 0;
+        if (*autosave_interval > 0 && state::generation != saved_generation && !saves_pending && autosave_timer.test_and_set(*autosave_interval * 1000))
+        {
+            Save("autosave");
+            saved_generation = state::generation;
+        }
     }
     break;
     case WB_EDITING:
@@ -1221,6 +1715,7 @@ static void cm()
 static InitRoutine init([]() {
     EC::Register(EC::CreateMove, cm, "cm_walkbot", EC::average);
     EC::Register(EC::LevelInit, OnLevelInit, "init_walkbot", EC::average);
+    memtrack::Report(memtrack::tag_walkbot, []() -> size_t { return nodes.capacity() * sizeof(walkbot_node_s); });
 #if ENABLE_VISUALS
     EC::Register(EC::Draw, Draw, "draw_walkbot", EC::average);
 #endif
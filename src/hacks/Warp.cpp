@@ -14,6 +14,8 @@
 #include "DetourHook.hpp"
 #include "WeaponData.hpp"
 #include "MiscTemporary.hpp"
+#include "governor.hpp"
+#include "netmessages.hpp"
 
 namespace hacks::tf2::warp
 {
@@ -274,40 +276,49 @@ int GetMaxWarpTicks()
     return ticks;
 }
 
-// Approximate demoknight shield speed at a given tick
-float approximateSpeedAtTick(int ticks_since_start, float initial_speed, float max_speed)
+// Demoknight shield charge speed gained per tick since the start, the formula only holds up until like 20 ticks
+constexpr int CHARGE_RAMP_TICKS = 20;
+static constexpr std::array<float, CHARGE_RAMP_TICKS> charge_ramp = []() {
+    std::array<float, CHARGE_RAMP_TICKS> ramp{};
+    for (int i = 0; i < CHARGE_RAMP_TICKS; i++)
+        ramp[i] = i * (113.8f - 2.8f * i) + 1.0f;
+    return ramp;
+}();
+
+// Top charge speed of our loadout
+static float chargeMaxSpeed()
 {
-    // Formula only holds up until like 20 ticks
-    float speed = ticks_since_start >= 20 ? max_speed : (ticks_since_start * (113.8f - 2.8f * ticks_since_start) + 1.0f);
-    return std::min(max_speed * g_GlobalVars->interval_per_tick, initial_speed * g_GlobalVars->interval_per_tick + speed * g_GlobalVars->interval_per_tick);
-}
-
-// Approximate the amount of ticks needed for a given distance as demoknight
-int approximateTicksForDist(float distance, float initial_speed, int max_ticks)
-{
-    bool is_skullcutter = false;
-    bool has_booties    = false;
     if (CE_GOOD(LOCAL_E) && LOCAL_E->m_bAlivePlayer() && CE_GOOD(LOCAL_W))
     {
-        // We have a skullcutter, mark as such
+        // Compensate for the skullcutter (booties don't speed up, besides with skullcutter)
         if (CE_INT(LOCAL_W, netvar.iItemDefinitionIndex) == 172)
-            is_skullcutter = true;
-        // We have the Booties, mark as such
-        if (HasWeapon(LOCAL_E, 405) || HasWeapon(LOCAL_E, 608))
-            has_booties = true;
+            return HasWeapon(LOCAL_E, 405) || HasWeapon(LOCAL_E, 608) ? 701.0f : 637.0f;
     }
-    float travelled_dist = 0.0f;
-    for (int i = 0; i <= max_ticks; i++)
-    {
-        // Compensate for the skullcutter (booties don't speed up, besides with skullcutter)
-        travelled_dist += approximateSpeedAtTick(i, initial_speed, is_skullcutter ? (has_booties ? 701.0f : 637.0f) : 750.0f);
+    return 750.0f;
+}
 
+// Approximate the amount of ticks needed for a given distance as demoknight
+int approximateTicksForDist(float distance, float initial_speed, float max_speed, int max_ticks)
+{
+    // Everything in units per second, one tick covers each speed for interval_per_tick
+    float needed    = distance / g_GlobalVars->interval_per_tick;
+    float travelled = 0.0f;
+    int ramp_ticks  = std::min(CHARGE_RAMP_TICKS - 1, max_ticks);
+    for (int i = 0; i <= ramp_ticks; i++)
+    {
+        travelled += std::min(max_speed, initial_speed + charge_ramp[i]);
         // We hit the needed range
-        if (travelled_dist >= distance)
+        if (travelled >= needed)
             return i;
     }
+    if (ramp_ticks < CHARGE_RAMP_TICKS - 1 || max_speed <= 0.0f)
+        return -1;
+    // Flat out from here on
+    double ticks = (CHARGE_RAMP_TICKS - 1) + std::ceil((needed - travelled) / max_speed);
     // Not within Max range
-    return -1;
+    if (ticks > max_ticks)
+        return -1;
+    return int(ticks);
 }
 
 static bool move_last_tick     = true;
@@ -630,11 +641,14 @@ void warpLogic()
                     velocity::EstimateAbsVelocity(RAW_ENT(LOCAL_E), vel);
                     // +11 to account for the melee delay, the -40.0f is so we don't just aim for the center, which would
                     // Make our range artifically shorter
-                    int charge_ticks = approximateTicksForDist(distance - 40.0f, vel.Length(), GetMaxWarpTicks() + 11);
+                    float max_speed  = chargeMaxSpeed();
+                    int max_ticks    = GetMaxWarpTicks();
+                    max_ticks        = max_ticks > INT_MAX - 11 ? INT_MAX : max_ticks + 11;
+                    int charge_ticks = approximateTicksForDist(distance - 40.0f, vel.Length(), max_speed, max_ticks);
 
                     // Not in range, try again with melee range taken into compensation
                     if (charge_ticks <= 0)
-                        charge_ticks = approximateTicksForDist(distance - 128.0f, vel.Length(), GetMaxWarpTicks() + 11);
+                        charge_ticks = approximateTicksForDist(distance - 128.0f, vel.Length(), max_speed, max_ticks);
                     // Out of range
                     if (charge_ticks <= 0)
                     {
@@ -823,43 +837,40 @@ void CL_SendMove_hook()
 }
 
 // Called after CL_SendMove to transmit the clc_move message. We choke it if we want to charge warp.
-void SendNetMessage(INetMessage &msg)
+static bool SendNetMessage(net_messages::outgoing_s &message)
 {
     if (!enabled)
-        return;
+        return false;
 
-    // Credits to MrSteyk for this btw
-    if (msg.GetGroup() == INetChannelInfo::MOVE)
+    // Charge, credits to MrSteyk for this btw
+    if (should_charge && !charged)
     {
-        // Charge
-        if (should_charge && !charged)
+        int ticks    = GetMaxWarpTicks();
+        auto movemsg = (CLC_Move *) &message.msg;
+
+        // Just null it :shrug:
+        movemsg->m_nBackupCommands = 0;
+        movemsg->m_nNewCommands    = 0;
+        movemsg->m_DataOut.Reset();
+        movemsg->m_DataOut.m_nDataBits  = 0;
+        movemsg->m_DataOut.m_nDataBytes = 0;
+        movemsg->m_DataOut.m_iCurBit    = 0;
+
+        warp_amount++;
+        if (warp_amount >= ticks)
         {
-            int ticks    = GetMaxWarpTicks();
-            auto movemsg = (CLC_Move *) &msg;
-
-            // Just null it :shrug:
-            movemsg->m_nBackupCommands = 0;
-            movemsg->m_nNewCommands    = 0;
-            movemsg->m_DataOut.Reset();
-            movemsg->m_DataOut.m_nDataBits  = 0;
-            movemsg->m_DataOut.m_nDataBytes = 0;
-            movemsg->m_DataOut.m_iCurBit    = 0;
-
-            warp_amount++;
-            if (warp_amount >= ticks)
-            {
-                warp_amount = ticks;
-                charged     = true;
-            }
+            warp_amount = ticks;
+            charged     = true;
         }
     }
     should_charge = false;
+    return false;
 }
 
 #if ENABLE_VISUALS
 void Draw()
 {
-    if (!enabled || !draw)
+    if (!enabled || !draw || governor::Degraded(governor::NO_VISUALISERS))
         return;
     if (!g_IEngine->IsInGame())
         return;
@@ -887,48 +898,39 @@ void LevelShutdown()
     warp_amount = 0;
 }
 
-class WarpHurtListener : public IGameEventListener2
+static void OnPlayerHurt(const game_events::event_s &event)
 {
-public:
-    virtual void FireGameEvent(IGameEvent *event)
-    {
-        // Not enabled
-        if (!isHackActive() || !enabled || !warp_on_damage)
-            return;
-        // We have no warp
-        if (!warp_amount)
-            return;
-        // Store userids
-        int victim   = event->GetInt("userid");
-        int attacker = event->GetInt("attacker");
-        player_info_s kinfo{};
-        player_info_s vinfo{};
-
-        // Check if both are valid (Attacker & victim)
-        if (!g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(victim), &vinfo) || !g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(attacker), &kinfo))
-            return;
-        // Check if victim is local player
-        if (g_IEngine->GetPlayerForUserID(victim) != g_pLocalPlayer->entity_idx)
-            return;
+    // Not enabled
+    if (!isHackActive() || !enabled || !warp_on_damage)
+        return;
+    // We have no warp
+    if (!warp_amount)
+        return;
+    int victim   = event.hurt->victim;
+    int attacker = event.hurt->attacker;
+
+    // Check if both are valid (Attacker & victim)
+    if (!victim || !attacker)
+        return;
+    // Check if victim is local player
+    if (victim != g_pLocalPlayer->entity_idx)
+        return;
 
-        // Check if the entities are alive and valid
-        CachedEntity *att = ENTITY(attacker);
+    // Check if the entities are alive and valid
+    CachedEntity *att = ENTITY(attacker);
 
-        // Don't run if we (the victim) are invalid
-        if (CE_BAD(LOCAL_E) || !LOCAL_E->m_bAlivePlayer())
+    // Don't run if we (the victim) are invalid
+    if (CE_BAD(LOCAL_E) || !LOCAL_E->m_bAlivePlayer())
+        return;
+    // Don't check weapon mode if the attacker is invalid
+    if (!CE_INVALID(att) && att->m_bAlivePlayer())
+        // Ignore projectiles for now
+        if (GetWeaponMode(att) == weapon_projectile)
             return;
-        // Don't check weapon mode if the attacker is invalid
-        if (!CE_INVALID(att) && att->m_bAlivePlayer())
-            // Ignore projectiles for now
-            if (CE_VALID(ENTITY(attacker)) && GetWeaponMode(ENTITY(attacker)) == weapon_projectile)
-                return;
 
-        // We got hurt
-        was_hurt = true;
-    }
-};
-
-static WarpHurtListener listener;
+    // We got hurt
+    was_hurt = true;
+}
 
 void rvarCallback(settings::VariableBase<bool> &, bool)
 {
@@ -951,21 +953,17 @@ static InitRoutine init([]() {
     EC::Register(EC::CreateMove, CreateMoveFixPrediction, "warp_createmove_fixpred", EC::very_early);
     EC::Register(EC::CreateMove, CreateMove, "warp_createmove", EC::very_late);
     EC::Register(EC::CreateMoveEarly, CreateMoveEarly, "warp_createmove_early", EC::very_early);
-    g_IEventManager2->AddListener(&listener, "player_hurt", false);
+    game_events::Subscribe("player_hurt", OnPlayerHurt);
+    net_messages::Subscribe(clc_Move, SendNetMessage);
     EC::Register(
-        EC::Shutdown,
-        []() {
-            g_IEventManager2->RemoveListener(&listener);
-            cl_move_detour.Shutdown();
-        },
-        "warp_shutdown");
+        EC::Shutdown, []() { cl_move_detour.Shutdown(); }, "warp_shutdown");
     warp_forward.installChangeCallback(rvarCallback);
     warp_backwards.installChangeCallback(rvarCallback);
     warp_left.installChangeCallback(rvarCallback);
     warp_right.installChangeCallback(rvarCallback);
 
 #if ENABLE_VISUALS
-    EC::Register(EC::Draw, Draw, "warp_draw");
+    EC::Register(EC::Draw, Draw, "warp_draw", EC::per_tick);
 #endif
 });
 } // namespace hacks::tf2::warp
@@ -5,8 +5,7 @@
  *      Author: nullifiedcat
  */
 
-#include <hacks/ac/aimbot.hpp>
-#include <hacks/AntiCheat.hpp>
+#include <hacks/ac/pipeline.hpp>
 #include <settings/Float.hpp>
 #include "common.hpp"
 #include "angles.hpp"
@@ -17,109 +16,90 @@ static settings::Boolean enable{ "find-cheaters.aimbot.enable", "true" };
 static settings::Float detect_angle{ "find-cheaters.aimbot.angle", "30" };
 static settings::Int detections_warning{ "find-cheaters.aimbot.detections", "3" };
 
-ac_data data_table[MAX_PLAYERS];
-int amount[MAX_PLAYERS];
-std::unordered_map<int, Vector> Player_origs{};
-
-std::unordered_map<int, Vector> &player_orgs()
+struct ac_data
 {
-    return Player_origs;
-}
-void ResetEverything()
+    size_t detections;
+    int check_timer;
+    int last_weapon;
+};
+
+static ac_data data_table[MAX_PLAYERS];
+static int amount[MAX_PLAYERS];
+// Origins from the last tick, zero for players that weren't checked
+static Vector origins[PLAYER_ARRAY_SIZE]{};
+
+static void BeginTick();
+
+static void ResetEverything()
 {
     memset(&data_table, 0, sizeof(ac_data) * MAX_PLAYERS);
-    Player_origs.clear();
+    memset(amount, 0, sizeof(amount));
+    BeginTick();
 }
 
-void ResetPlayer(int idx)
+static void ResetPlayer(int idx)
 {
     memset(&data_table[idx - 1], 0, sizeof(ac_data));
-    Player_origs.clear();
+    amount[idx - 1] = 0;
+    BeginTick();
 }
 
-void Init()
+static void BeginTick()
 {
-    ResetEverything();
+    for (auto &origin : origins)
+        origin.Zero();
 }
 
-void Update(CachedEntity *player)
+static void Update(int idx, const frame_s &frame)
 {
-    if (!enable)
+    auto &player = frame.player;
+    if (!enable.load())
         return;
-    Player_origs[player->m_IDX] = player->m_vecOrigin();
-    auto &data                  = data_table[player->m_IDX - 1];
-    auto &am                    = amount[player->m_IDX - 1];
+    origins[idx] = player.origin;
+    auto &data   = data_table[idx - 1];
+    auto &am     = amount[idx - 1];
     if (data.check_timer)
     {
         data.check_timer--;
         if (!data.check_timer)
         {
-            auto &angles      = angles::data(player);
-            float deviation   = angles.deviation(2);
-            int widx          = CE_INT(player, netvar.hActiveWeapon) & 0xFFF;
-            CachedEntity *wep = ENTITY(widx);
-            if (!CE_GOOD(wep))
+            float deviation = frame.features.angles->snap;
+            if (player.weapon_class == -1)
                 return;
-            if (deviation > float(detect_angle) && wep->m_iClassID() != CL_CLASS(CTFFlameThrower))
+            if (deviation > detect_angle.load() && player.weapon_class != CL_CLASS(CTFFlameThrower))
             {
                 am++;
-                // logging::Info("[ac] %d deviation %.2f #%d", player->m_IDX,
+                // logging::Info("[ac] %d deviation %.2f #%d", idx,
                 // deviation, data.detections);
-                player_info_t info;
-                g_IEngine->GetPlayerInfo(player->m_IDX, &info);
                 if (am > 5)
                 {
-                    hacks::shared::anticheat::SetRage(info);
+                    Rage(idx);
                     am = 0;
                 }
-                if (++data.detections > int(detections_warning))
-                {
-
-                    const char *wp_name = "[unknown]";
-                    int widx            = CE_INT(player, netvar.hActiveWeapon) & 0xFFF;
-                    if (IDX_GOOD(widx))
-                    {
-                        CachedEntity *weapon = ENTITY(widx);
-                        wp_name              = weapon->InternalEntity()->GetClientClass()->GetName();
-                        /*logging::Info("%d", weapon->m_IDX);
-                        logging::Info("%s", );
-                        IClientEntity* e_weapon = RAW_ENT(weapon);
-                        if (CE_GOOD(weapon)) {
-                            const char* wname = vfunc<const
-                        char*(*)(IClientEntity*)>(e_weapon, 398, 0)(e_weapon);
-                            if (wname) wp_name = wname;
-                        }*/
-                    }
-                    hacks::shared::anticheat::Accuse(player->m_IDX, "Aimbot", format("Weapon: ", wp_name, " | Deviation: ", deviation, "° | ", data.detections));
-                }
+                if (++data.detections > detections_warning.load())
+                    Accuse(idx, "Aimbot", format("Weapon: ", player.weapon_name, " | Deviation: ", deviation, "° | ", data.detections));
             }
         }
     }
 }
 
-void Event(KeyValues *event)
+static void Hit(const hit_s &hit)
 {
-    if (!enable)
+    if (!enable.load())
         return;
-    if (!strcmp(event->GetName(), "player_death") || !strcmp(event->GetName(), "player_hurt"))
+    int eid = hit.attacker;
+    int vid = hit.victim;
+    if (eid > 0 && eid <= MAX_PLAYERS && vid > 0 && vid <= MAX_PLAYERS)
     {
-        int attacker = event->GetInt("attacker");
-        int victim   = event->GetInt("userid");
-        int eid      = g_IEngine->GetPlayerForUserID(attacker);
-        int vid      = g_IEngine->GetPlayerForUserID(victim);
-        if (eid > 0 && eid <= MAX_PLAYERS && vid > 0 && vid <= MAX_PLAYERS)
-        {
-            CachedEntity *victim   = ENTITY(vid);
-            CachedEntity *attacker = ENTITY(eid);
-            auto &Po_v             = Player_origs[vid];
-            auto &Po_e             = Player_origs[eid];
-            if (Po_v.z != 0 && Po_e.z != 0)
-                if (Po_v.DistTo(Po_e) > 250)
-                {
-                    data_table[eid - 1].check_timer = 1;
-                    data_table[eid - 1].last_weapon = event->GetInt("weaponid");
-                }
-        }
+        auto &Po_v = origins[vid];
+        auto &Po_e = origins[eid];
+        if (Po_v.z != 0 && Po_e.z != 0)
+            if (Po_v.DistTo(Po_e) > 250)
+            {
+                data_table[eid - 1].check_timer = 1;
+                data_table[eid - 1].last_weapon = hit.weaponid;
+            }
     }
 }
+static InitRoutine init([]() { Register({ "aimbot", 0, Update, ResetPlayer, ResetEverything, Hit, BeginTick }); });
 } // namespace ac::aimbot
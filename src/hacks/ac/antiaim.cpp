@@ -5,7 +5,7 @@
  *      Author: nullifiedcat
  */
 
-#include <hacks/AntiCheat.hpp>
+#include <hacks/ac/pipeline.hpp>
 #include <settings/Bool.hpp>
 #include "common.hpp"
 #include "angles.hpp"
@@ -14,32 +14,31 @@ namespace ac::antiaim
 {
 static settings::Boolean enable{ "find-cheaters.antiaim.enable", "true" };
 
-unsigned long last_accusation[MAX_PLAYERS]{ 0 };
+static unsigned long last_accusation[MAX_PLAYERS]{ 0 };
+static int amount[MAX_PLAYERS]{ 0 };
 
-void ResetEverything()
+static void ResetEverything()
 {
     memset(last_accusation, 0, sizeof(unsigned long) * MAX_PLAYERS);
+    memset(amount, 0, sizeof(amount));
 }
 
-void ResetPlayer(int idx)
+static void ResetPlayer(int idx)
 {
     last_accusation[idx - 1] = 0;
+    amount[idx - 1]          = 0;
 }
 
-void Init()
-{
-    ResetEverything();
-}
 
-void Update(CachedEntity *player)
+static void Update(int idx, const frame_s &frame)
 {
-    if (!enable)
+    auto &tick = frame.tick;
+    if (!enable.load())
         return;
-    int amount[MAX_PLAYERS];
-    auto &am = amount[player->m_IDX - 1];
-    if (tickcount - last_accusation[player->m_IDX - 1] < 60 * 60)
+    auto &am = amount[idx - 1];
+    if (tick.tickcount - last_accusation[idx - 1] < 60 * 60)
         return;
-    const auto &d = angles::data(player);
+    const auto &d = *frame.features.angles;
     if (d.angle_count)
     {
         int idx = d.angle_index - 1;
@@ -48,11 +47,9 @@ void Update(CachedEntity *player)
         if ((d.angles[idx].x < -89 || d.angles[idx].x > 89) && (d.angles[idx].x < 89.2941 || d.angles[idx].x > 89.2942))
         {
             am++;
-            player_info_t info;
-            g_IEngine->GetPlayerInfo(player->m_IDX, &info);
             if (am > 5)
             {
-                hacks::shared::anticheat::SetRage(info);
+                Rage(idx);
                 am = 0;
             }
             std::string reason = format("Pitch: ", d.angles[idx].x, " Yaw: ", d.angles[idx].y);
@@ -64,13 +61,10 @@ void Update(CachedEntity *player)
             {
                 reason += " (Fakedown)";
             }
-            hacks::shared::anticheat::Accuse(player->m_IDX, "AntiAim", reason);
-            last_accusation[player->m_IDX - 1] = tickcount;
+            Accuse(idx, "AntiAim", reason);
+            last_accusation[idx - 1] = tick.tickcount;
         }
     }
 }
-
-void Event(KeyValues *event)
-{
-}
+static InitRoutine init([]() { Register({ "antiaim", 0, Update, ResetPlayer, ResetEverything, nullptr, nullptr }); });
 } // namespace ac::antiaim
@@ -5,7 +5,7 @@
  *      Author: nullifiedcat
  */
 
-#include <hacks/AntiCheat.hpp>
+#include <hacks/ac/pipeline.hpp>
 #include <settings/Int.hpp>
 #include "common.hpp"
 
@@ -13,67 +13,48 @@ namespace ac::bhop
 {
 static settings::Int bhop_detect_count{ "find-cheaters.bunnyhop.detections", "4" };
 
-ac_data data_table[MAX_PLAYERS]{};
-
-void ResetEverything()
+struct ac_data
 {
-    memset(data_table, 0, sizeof(ac_data) * MAX_PLAYERS);
-}
+    int detections{ 0 };
+    unsigned long last_accusation{ 0 };
+};
+
+static ac_data data_table[MAX_PLAYERS]{};
 
-void ResetPlayer(int idx)
+static void ResetEverything()
 {
-    memset(&data_table[idx - 1], 0, sizeof(ac_data));
+    for (auto &data : data_table)
+        data = ac_data{};
 }
 
-void Init()
+static void ResetPlayer(int idx)
 {
-    ResetEverything();
+    data_table[idx - 1] = ac_data{};
 }
 
-void Update(CachedEntity *player)
+static void Update(int idx, const frame_s &frame)
 {
-    auto &data  = data_table[player->m_IDX - 1];
-    bool ground = player->var<int>(netvar.iFlags) & FL_ONGROUND;
-    if (ground)
+    if (!frame.features.jumped)
+        return;
+    auto &data = data_table[idx - 1];
+    // Jumped again on the very tick they landed
+    if (frame.features.ground_ticks != 1)
     {
-        if (!data.was_on_ground)
-        {
-            data.ticks_on_ground = 1;
-        }
-        else
-        {
-            data.ticks_on_ground++;
-        }
+        data.detections = 0;
+        return;
     }
-    else
+    data.detections++;
+    // TODO FIXME
+    if (data.detections >= bhop_detect_count.load())
     {
-        if (data.was_on_ground)
+        logging::Info("[%d] Suspected BHop: %d", idx, data.detections);
+        if ((frame.tick.tickcount - data.last_accusation) > 600)
         {
-            if (data.ticks_on_ground == 1)
-            {
-                data.detections++;
-                // TODO FIXME
-                if (data.detections >= int(bhop_detect_count))
-                {
-                    logging::Info("[%d] Suspected BHop: %d", player->m_IDX, data.detections);
-                    if ((tickcount - data.last_accusation) > 600)
-                    {
-                        hacks::shared::anticheat::Accuse(player->m_IDX, "Bunnyhop", format("Perfect jumps = ", data.detections));
-                        data.last_accusation = tickcount;
-                    }
-                }
-            }
-            else
-            {
-                data.detections = 0;
-            }
+            Accuse(idx, "Bunnyhop", format("Perfect jumps = ", data.detections));
+            data.last_accusation = frame.tick.tickcount;
         }
-        data.ticks_on_ground = 0;
     }
-    data.was_on_ground = ground;
 }
 
-void Event(KeyValues *event)
-{
-}
+static InitRoutine init([]() { Register({ "bunnyhop", feature_ground, Update, ResetPlayer, ResetEverything, nullptr, nullptr }); });
 } // namespace ac::bhop
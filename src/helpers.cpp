@@ -13,6 +13,10 @@
 #include "PlayerTools.hpp"
 #include "Ragdolls.hpp"
 #include "WeaponData.hpp"
+#include "viscache.hpp"
+#include "occlusion.hpp"
+#include "loadout.hpp"
+#include "projectiletable.hpp"
 
 static settings::Boolean tcm{ "debug.tcm", "true" };
 static settings::Boolean should_correct_punch{ "debug.correct-punch", "true" };
@@ -381,7 +385,7 @@ bool canReachVector(Vector loc, Vector dest)
                 ray.Init(vec, directionalLoc);
                 {
                     PROF_SECTION(IEVV_TraceRay);
-                    g_ITrace->TraceRay(ray, 0x4200400B, &trace::filter_no_player, &trace);
+                    trace::TraceRay(ray, 0x4200400B, &trace::filter_no_player, &trace);
                 }
                 // distance of trace < than 26
                 if (trace.startpos.DistTo(trace.endpos) < 26.0f)
@@ -424,7 +428,7 @@ bool canReachVector(Vector loc, Vector dest)
             ray.Init(loc, directionalLoc);
             {
                 PROF_SECTION(IEVV_TraceRay);
-                g_ITrace->TraceRay(ray, 0x4200400B, &trace::filter_no_player, &trace);
+                trace::TraceRay(ray, 0x4200400B, &trace::filter_no_player, &trace);
             }
             // distance of trace < than 26
             if (trace.startpos.DistTo(trace.endpos) < 26.0f)
@@ -504,11 +508,6 @@ const char *GetBuildingName(CachedEntity *ent)
     return "[NULL]";
 }
 
-void format_internal(std::stringstream &stream)
-{
-    (void) (stream);
-}
-
 void ReplaceString(std::string &input, const std::string &what, const std::string &with_what)
 {
     size_t index;
@@ -646,47 +645,15 @@ powerup_type GetPowerupOnPlayer(CachedEntity *player)
 // A function to find a weapon by WeaponID
 int getWeaponByID(CachedEntity *player, int weaponid)
 {
-    // Invalid player
-    if (CE_BAD(player))
-        return -1;
-    int *hWeapons = &CE_INT(player, netvar.hMyWeapons);
-    // Go through the handle array and search for the item
-    for (int i = 0; hWeapons[i]; i++)
-    {
-        if (IDX_BAD(HandleToIDX(hWeapons[i])))
-            continue;
-        // Get the weapon
-        CachedEntity *weapon = ENTITY(HandleToIDX(hWeapons[i]));
-        // if weapon is what we are looking for, return true
-        if (CE_VALID(weapon) && re::C_TFWeaponBase::GetWeaponID(RAW_ENT(weapon)) == weaponid)
-            return weapon->m_IDX;
-    }
-    // Nothing found
-    return -1;
+    const loadout::loadout_s *loadout = loadout::Get(player);
+    return loadout ? loadout->Find(weaponid) : -1;
 }
 
 // A function to tell if a player is using a specific weapon
 bool HasWeapon(CachedEntity *ent, int wantedId)
 {
-    if (CE_BAD(ent) || ent->m_Type() != ENTITY_PLAYER)
-        return false;
-    // Grab the handle and store it into the var
-    int *hWeapons = &CE_INT(ent, netvar.hMyWeapons);
-    if (!hWeapons)
-        return false;
-    // Go through the handle array and search for the item
-    for (int i = 0; hWeapons[i]; i++)
-    {
-        if (IDX_BAD(HandleToIDX(hWeapons[i])))
-            continue;
-        // Get the weapon
-        CachedEntity *weapon = ENTITY(HandleToIDX(hWeapons[i]));
-        // if weapon is what we are looking for, return true
-        if (CE_VALID(weapon) && CE_INT(weapon, netvar.iItemDefinitionIndex) == wantedId)
-            return true;
-    }
-    // We didnt find the weapon we needed, return false
-    return false;
+    const loadout::loadout_s *loadout = loadout::Get(ent);
+    return loadout && loadout->Has(wantedId);
 }
 
 CachedEntity *getClosestEntity(Vector vec)
@@ -839,7 +806,9 @@ void AngleVectors3(const QAngle &angles, Vector *forward, Vector *right, Vector
 
 bool isRapidFire(IClientEntity *wep)
 {
-    weapon_info info(wep);
+    const weapon_profile_s &profile = g_pLocalPlayer->weapon_profile;
+    if (wep == profile.raw && profile.tick == tickcount)
+        return profile.rapid_fire;
     bool ret = GetWeaponData(wep)->m_bUseRapidFireCrits;
     // Minigun changes mode once revved, so fix that
     return ret || wep->GetClientClass()->m_ClassID == CL_CLASS(CTFMinigun);
@@ -952,7 +921,7 @@ void FixMovement(CUserCmd &cmd, Vector &viewangles)
 
 bool AmbassadorCanHeadshot()
 {
-    if (IsAmbassador(g_pLocalPlayer->weapon()))
+    if (g_pLocalPlayer->holdingAmbassador())
     {
         if ((g_GlobalVars->curtime - CE_FLOAT(g_pLocalPlayer->weapon(), netvar.flLastFireTime)) <= 1.0)
         {
@@ -1010,14 +979,29 @@ bool IsEntityVectorVisible(CachedEntity *entity, Vector endpos, bool use_weapon_
     // Adjust for weapon offsets if needed
     if (use_weapon_offset)
         eye = getShootPos(GetAimAtAngles(eye, endpos, LOCAL_E));
+    // Callers that want the trace itself can't be served from the cache
+    bool cacheable = trace == &trace_object;
+    viscache::query query(eye, endpos, g_pLocalPlayer->entity_idx, entity->m_IDX, mask, viscache::FILTER_DEFAULT);
+    bool visible;
+    if (cacheable && viscache::Lookup(query, visible))
+        return visible;
+    // World is in the way no matter what, skip the trace
+    if (cacheable && occlusion::DefinitelyOccluded(eye, endpos))
+    {
+        viscache::Store(query, false);
+        return false;
+    }
     ray.Init(eye, endpos);
     {
         PROF_SECTION(IEVV_TraceRay);
         std::lock_guard<std::mutex> lock(trace_lock);
         if (!tcm || g_Settings.is_create_move)
-            g_ITrace->TraceRay(ray, mask, &trace::filter_default, trace);
+            trace::TraceRay(ray, mask, &trace::filter_default, trace);
     }
-    return (((IClientEntity *) trace->m_pEnt) == RAW_ENT(entity) || !trace->DidHit());
+    visible = (((IClientEntity *) trace->m_pEnt) == RAW_ENT(entity) || !trace->DidHit());
+    if (cacheable)
+        viscache::Store(query, visible);
+    return visible;
 }
 
 // For when you need to vis check something that isnt the local player
@@ -1030,20 +1014,21 @@ bool VisCheckEntFromEnt(CachedEntity *startEnt, CachedEntity *endEnt)
 
     // Setup the trace starting with the origin of the starting ent attemting to
     // hit the origin of the end ent
+    viscache::query query(startEnt->m_vecOrigin(), endEnt->m_vecOrigin(), startEnt->m_IDX, endEnt->m_IDX, MASK_SHOT_HULL, viscache::FILTER_DEFAULT);
+    bool visible;
+    if (viscache::Lookup(query, visible))
+        return visible;
     Ray_t ray;
     ray.Init(startEnt->m_vecOrigin(), endEnt->m_vecOrigin());
     {
         PROF_SECTION(IEVV_TraceRay);
-        g_ITrace->TraceRay(ray, MASK_SHOT_HULL, &trace::filter_default, &trace);
+        trace::TraceRay(ray, MASK_SHOT_HULL, &trace::filter_default, &trace);
     }
     // Is the entity that we hit our target ent? if so, the vis check passes
-    if (trace.m_pEnt)
-    {
-        if ((((IClientEntity *) trace.m_pEnt)) == RAW_ENT(endEnt))
-            return true;
-    }
     // Since we didnt hit our target ent, the vis check failed so return false
-    return false;
+    visible = trace.m_pEnt && ((IClientEntity *) trace.m_pEnt) == RAW_ENT(endEnt);
+    viscache::Store(query, visible);
+    return visible;
 }
 
 // Use when you need to vis check something but its not the ent origin that you
@@ -1057,20 +1042,21 @@ bool VisCheckEntFromEntVector(Vector startVector, CachedEntity *startEnt, Cached
 
     // Setup the trace starting with the origin of the starting ent attemting to
     // hit the origin of the end ent
+    viscache::query query(startVector, endEnt->m_vecOrigin(), startEnt->m_IDX, endEnt->m_IDX, MASK_SHOT_HULL, viscache::FILTER_DEFAULT);
+    bool visible;
+    if (viscache::Lookup(query, visible))
+        return visible;
     Ray_t ray;
     ray.Init(startVector, endEnt->m_vecOrigin());
     {
         PROF_SECTION(IEVV_TraceRay);
-        g_ITrace->TraceRay(ray, MASK_SHOT_HULL, &trace::filter_default, &trace);
+        trace::TraceRay(ray, MASK_SHOT_HULL, &trace::filter_default, &trace);
     }
     // Is the entity that we hit our target ent? if so, the vis check passes
-    if (trace.m_pEnt)
-    {
-        if ((((IClientEntity *) trace.m_pEnt)) == RAW_ENT(endEnt))
-            return true;
-    }
     // Since we didnt hit our target ent, the vis check failed so return false
-    return false;
+    visible = trace.m_pEnt && ((IClientEntity *) trace.m_pEnt) == RAW_ENT(endEnt);
+    viscache::Store(query, visible);
+    return visible;
 }
 
 Vector GetBuildingPosition(CachedEntity *ent)
@@ -1090,7 +1076,11 @@ bool IsBuildingVisible(CachedEntity *ent)
 
 int HandleToIDX(int handle)
 {
-    return handle & 0xFFF;
+    int idx = handle & 0xFFF;
+    // Invalid handles (0xFFFFFFFF) end up here, this is the only place that needs a range check
+    if (idx >= MAX_ENTITIES)
+        return -1;
+    return idx;
 }
 
 void fClampAngle(Vector &qaAng)
@@ -1216,125 +1206,39 @@ bool LineIntersectsBox(Vector &bmin, Vector &bmax, Vector &lmin, Vector &lmax)
 
 bool GetProjectileData(CachedEntity *weapon, float &speed, float &gravity, float &start_velocity)
 {
-    float rspeed, rgrav, rinitial_vel;
-
     IF_GAME(!IsTF()) return false;
 
     if (CE_BAD(weapon))
         return false;
-    rspeed       = 0.0f;
-    rgrav        = 0.0f;
-    rinitial_vel = 0.0f;
-    typedef float(GetProjectileData)(IClientEntity *);
-
-    switch (weapon->m_iClassID())
-    {
-    case CL_CLASS(CTFRocketLauncher_DirectHit):
-    {
-        rspeed = 1980.0f;
-        break;
-    }
-    case CL_CLASS(CTFParticleCannon):
-    case CL_CLASS(CTFRocketLauncher_AirStrike):
-    case CL_CLASS(CTFRocketLauncher):
-    {
-        rspeed = 1100.0f;
-        // Libery Launcher
-        if (CE_INT(weapon, netvar.iItemDefinitionIndex) == 414)
-            rspeed *= 1.4f;
-        break;
-    }
-    case CL_CLASS(CTFCannon):
-    {
-        rspeed = 1400.0f;
-        break;
-    }
-    case CL_CLASS(CTFGrenadeLauncher):
+    const weapon_profile_s &profile = g_pLocalPlayer->weapon_profile;
+    const projectile_table::params_s *params;
+    if (weapon->m_IDX == profile.idx && profile.tick == tickcount)
     {
-        rspeed       = 1200.0f;
-        rgrav        = 1.0f;
-        rinitial_vel = 200.0f;
-        IF_GAME(IsTF2())
+        if (!profile.charged)
         {
-            // Loch'n Load
-            if (CE_INT(weapon, netvar.iItemDefinitionIndex) == 308)
-                rspeed *= 1.25f;
+            speed          = profile.projectile_speed;
+            gravity        = profile.projectile_gravity;
+            start_velocity = profile.projectile_start_velocity;
+            return profile.projectile;
         }
-        break;
-    }
-    case CL_CLASS(CTFPipebombLauncher):
-    {
-        float chargetime = g_GlobalVars->curtime - CE_FLOAT(weapon, netvar.flChargeBeginTime);
-        if (!CE_FLOAT(weapon, netvar.flChargeBeginTime))
-            chargetime = 0.0f;
-        rspeed = RemapValClamped(chargetime, 0.0f, 4.0f, 900, 2400);
-        rgrav  = 0.4f;
-        break;
+        params = profile.projectile_params;
     }
-    case CL_CLASS(CTFCompoundBow):
-    {
-        float chargetime = g_GlobalVars->curtime - CE_FLOAT(weapon, netvar.flChargeBeginTime);
-        rspeed           = RemapValClamped(chargetime, 0.0f, 1.f, 1800, 2600);
-        rgrav            = RemapValClamped(chargetime, 0.0f, 1.f, 0.5, 0.1);
-        break;
-    }
-    case CL_CLASS(CTFBat_Giftwrap):
-    case CL_CLASS(CTFBat_Wood):
-    {
-        rspeed = 3000.0f;
-        rgrav  = 0.5f;
-        break;
-    }
-    case CL_CLASS(CTFFlareGun):
-    {
-        rspeed = 2000.0f;
-        rgrav  = 0.25f;
-        break;
-    }
-    case CL_CLASS(CTFSyringeGun):
-    {
-        rgrav  = 0.2f;
-        rspeed = 990.0f;
-        break;
-    }
-    case CL_CLASS(CTFCrossbow):
-    {
-        rgrav  = 0.2f;
-        rspeed = 2400.0f;
-        break;
-    }
-    case CL_CLASS(CTFShotgunBuildingRescue):
-    {
-        rgrav  = 0.2f;
-        rspeed = 2400.0f;
-        break;
-    }
-    case CL_CLASS(CTFDRGPomson):
-    {
-        rspeed = 1200.0f;
-        break;
-    }
-    case CL_CLASS(CTFWeaponFlameBall):
-    {
-        rspeed = 3000.0f;
-        break;
-    }
-    case CL_CLASS(CTFRaygun):
-    {
-        rspeed = 1200.0f;
-        break;
-    }
-    case CL_CLASS(CTFGrapplingHook):
+    else
+        params = projectile_table::Find(weapon);
+
+    if (!params)
     {
-        rspeed = 1500.0f;
-        break;
-    }
+        speed          = 0.0f;
+        gravity        = 0.0f;
+        start_velocity = 0.0f;
+        return false;
     }
-
-    speed          = rspeed;
-    gravity        = rgrav;
-    start_velocity = rinitial_vel;
-    return (rspeed || rgrav || rinitial_vel);
+    speed          = params->speed;
+    gravity        = params->gravity;
+    start_velocity = params->start_velocity;
+    if (params->Charged())
+        params->Charge(weapon, speed, gravity);
+    return true;
 }
 
 constexpr unsigned developer_list[] = { 306902159 };
@@ -1372,6 +1276,10 @@ netvar.iHealth));
 
 bool IsVectorVisible(Vector origin, Vector target, bool enviroment_only, CachedEntity *self, unsigned int mask)
 {
+    viscache::query query(origin, target, self ? self->m_IDX : -1, -1, mask, enviroment_only ? viscache::FILTER_NO_ENTITY : viscache::FILTER_NO_PLAYER);
+    bool visible;
+    if (viscache::Lookup(query, visible))
+        return visible;
     if (!enviroment_only)
     {
         trace_t trace_visible;
@@ -1380,8 +1288,8 @@ bool IsVectorVisible(Vector origin, Vector target, bool enviroment_only, CachedE
         trace::filter_no_player.SetSelf(RAW_ENT(self));
         ray.Init(origin, target);
         PROF_SECTION(IEVV_TraceRay);
-        g_ITrace->TraceRay(ray, mask, &trace::filter_no_player, &trace_visible);
-        return (trace_visible.fraction == 1.0f);
+        trace::TraceRay(ray, mask, &trace::filter_no_player, &trace_visible);
+        visible = (trace_visible.fraction == 1.0f);
     }
     else
     {
@@ -1391,20 +1299,28 @@ bool IsVectorVisible(Vector origin, Vector target, bool enviroment_only, CachedE
         trace::filter_no_entity.SetSelf(RAW_ENT(self));
         ray.Init(origin, target);
         PROF_SECTION(IEVV_TraceRay);
-        g_ITrace->TraceRay(ray, mask, &trace::filter_no_entity, &trace_visible);
-        return (trace_visible.fraction == 1.0f);
+        trace::TraceRay(ray, mask, &trace::filter_no_entity, &trace_visible);
+        visible = (trace_visible.fraction == 1.0f);
     }
+    viscache::Store(query, visible);
+    return visible;
 }
 
 bool IsVectorVisibleNavigation(Vector origin, Vector target, unsigned int mask)
 {
+    viscache::query query(origin, target, -1, -1, mask, viscache::FILTER_NAVIGATION);
+    bool visible;
+    if (viscache::Lookup(query, visible))
+        return visible;
     trace_t trace_visible;
     Ray_t ray;
 
     ray.Init(origin, target);
     PROF_SECTION(IEVV_TraceRay);
-    g_ITrace->TraceRay(ray, mask, &trace::filter_navigation, &trace_visible);
-    return (trace_visible.fraction == 1.0f);
+    trace::TraceRay(ray, mask, &trace::filter_navigation, &trace_visible);
+    visible = (trace_visible.fraction == 1.0f);
+    viscache::Store(query, visible);
+    return visible;
 }
 
 void WhatIAmLookingAt(int *result_eindex, Vector *result_pos)
@@ -1428,7 +1344,7 @@ void WhatIAmLookingAt(int *result_eindex, Vector *result_pos)
     ray.Init(g_pLocalPlayer->v_Eye, forward);
     {
         PROF_SECTION(IEVV_TraceRay);
-        g_ITrace->TraceRay(ray, 0x4200400B, &trace::filter_default, &trace);
+        trace::TraceRay(ray, 0x4200400B, &trace::filter_default, &trace);
     }
     if (result_pos)
         *result_pos = trace.endpos;
@@ -1466,6 +1382,9 @@ Vector GetForwardVector(float distance, CachedEntity *punch_entity)
 
 bool IsSentryBuster(CachedEntity *entity)
 {
+    // Already sorted out by the entity cache
+    if (entity_cache::mvm && entity_cache::SnapshotValid(entity->m_IDX))
+        return entity_cache::IsBuster(entity->m_IDX);
     return (entity->m_Type() == EntityType::ENTITY_PLAYER && CE_INT(entity, netvar.iClass) == tf_class::tf_demoman && g_pPlayerResource->GetMaxHealth(entity) == 2500);
 }
 
@@ -1480,22 +1399,27 @@ bool IsAmbassador(CachedEntity *entity)
 
 bool IsPlayerInvulnerable(CachedEntity *player)
 {
-    return HasConditionMask<KInvulnerabilityMask.cond_0, KInvulnerabilityMask.cond_1, KInvulnerabilityMask.cond_2, KInvulnerabilityMask.cond_3>(player);
+    IF_GAME(!IsTF()) return false;
+    return CondMaskCheck<KInvulnerabilityMask.cond_0, KInvulnerabilityMask.cond_1, KInvulnerabilityMask.cond_2, KInvulnerabilityMask.cond_3>(Conditions(player));
 }
 
 bool IsPlayerCritBoosted(CachedEntity *player)
 {
-    return HasConditionMask<KCritBoostMask.cond_0, KCritBoostMask.cond_1, KCritBoostMask.cond_2, KCritBoostMask.cond_3>(player);
+    IF_GAME(!IsTF()) return false;
+    return CondMaskCheck<KCritBoostMask.cond_0, KCritBoostMask.cond_1, KCritBoostMask.cond_2, KCritBoostMask.cond_3>(Conditions(player));
 }
 
 bool IsPlayerInvisible(CachedEntity *player, bool check_stealth)
 {
-    return HasConditionMask<KInvisibilityMask.cond_0, KInvisibilityMask.cond_1, KInvisibilityMask.cond_2, KInvisibilityMask.cond_3>(player) || (check_stealth && HasCondition<TFCond_Stealthed>(player));
+    IF_GAME(!IsTF()) return false;
+    condition_data_s conds = Conditions(player);
+    return CondMaskCheck<KInvisibilityMask.cond_0, KInvisibilityMask.cond_1, KInvisibilityMask.cond_2, KInvisibilityMask.cond_3>(conds) || (check_stealth && CondBitCheck<TFCond_Stealthed>(conds));
 }
 
 bool IsPlayerDisguised(CachedEntity *player)
 {
-    return HasConditionMask<KDisguisedMask.cond_0, KDisguisedMask.cond_1, KDisguisedMask.cond_2, KDisguisedMask.cond_3>(player);
+    IF_GAME(!IsTF()) return false;
+    return CondMaskCheck<KDisguisedMask.cond_0, KDisguisedMask.cond_1, KDisguisedMask.cond_2, KDisguisedMask.cond_3>(Conditions(player));
 }
 
 bool IsPlayerResistantToCurrentWeapon(CachedEntity *player)
@@ -1663,7 +1587,7 @@ bool IsEntityVisiblePenetration(CachedEntity *entity, int hb)
     ray.Init(g_pLocalPlayer->v_Origin + g_pLocalPlayer->v_ViewOffset, hit);
     {
         PROF_SECTION(IEVV_TraceRay);
-        g_ITrace->TraceRay(ray, MASK_SHOT_HULL, &trace::filter_penetration, &trace_visible);
+        trace::TraceRay(ray, MASK_SHOT_HULL, &trace::filter_penetration, &trace_visible);
     }
     correct_entity = false;
     if (trace_visible.m_pEnt)
@@ -1674,7 +1598,7 @@ bool IsEntityVisiblePenetration(CachedEntity *entity, int hb)
         return false;
     {
         PROF_SECTION(IEVV_TraceRay);
-        g_ITrace->TraceRay(ray, 0x4200400B, &trace::filter_default, &trace_visible);
+        trace::TraceRay(ray, 0x4200400B, &trace::filter_default, &trace_visible);
     }
     if (trace_visible.m_pEnt)
     {
@@ -1730,15 +1654,16 @@ void PrintChat(const char *fmt, ...)
     CHudBaseChat *chat = (CHudBaseChat *) g_CHUD->FindElement("CHudChat");
     if (chat)
     {
-        std::unique_ptr<char[]> buf(new char[1024]);
+        // Prefix and line formatted in one go, straight onto the stack
+        char str[1024];
+        int prefix = snprintf(str, sizeof(str), "\x07%06X[\x07%06XCAT\x07%06X]\x01 ", 0x5e3252, 0xba3d9a, 0x5e3252);
         va_list list;
         va_start(list, fmt);
-        vsprintf(buf.get(), fmt, list);
+        vsnprintf(str + prefix, sizeof(str) - prefix, fmt, list);
         va_end(list);
-        std::unique_ptr<char[]> str = std::move(strfmt("\x07%06X[\x07%06XCAT\x07%06X]\x01 %s", 0x5e3252, 0xba3d9a, 0x5e3252, buf.get()));
         // FIXME DEBUG LOG
-        logging::Info("%s", str.get());
-        chat->Printf(str.get());
+        logging::Info("%s", str);
+        chat->Printf(str);
     }
 #endif
 }
@@ -1809,7 +1734,7 @@ Vector getShootPos(Vector angle)
         trace::filter_default.SetSelf(RAW_ENT(g_pLocalPlayer->entity));
         ray.Init(eye, endpos);
         if (!tcm || g_Settings.is_create_move)
-            g_ITrace->TraceRay(ray, MASK_SOLID, &trace::filter_default, &tr);
+            trace::TraceRay(ray, MASK_SOLID, &trace::filter_default, &tr);
 
         // Replicate game behaviour, only use the offset if our trace has a big enough fraction
         if (tr.fraction <= 0.1)
@@ -1831,11 +1756,10 @@ Vector getShootPos(Vector angle)
 // does it on its own
 std::unique_ptr<char[]> strfmt(const char *fmt, ...)
 {
-    // char *buf = new char[1024];
     auto buf = std::make_unique<char[]>(1024);
     va_list list;
     va_start(list, fmt);
-    vsprintf(buf.get(), fmt, list);
+    vsnprintf(buf.get(), 1024, fmt, list);
     va_end(list);
     return buf;
 }
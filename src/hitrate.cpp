@@ -22,11 +22,30 @@ int count_hits_sniper{ 0 };
 int count_hits{ 0 };
 int count_hits_head{ 0 };
 
+metrics_s metrics{};
+
+template <size_t N> static void Clear(std::atomic<uint32_t> (&counters)[WEAPON_CLASSES][N])
+{
+    for (auto &row : counters)
+        for (auto &counter : row)
+            counter.store(0, std::memory_order_relaxed);
+}
+
+static void Add(std::atomic<uint32_t> &counter)
+{
+    // Single writer, no need for a locked add
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
 CatCommand clear_hirate("debug_hitrate_clear", "Clear hitrate", []() {
     count_shots       = 0;
     count_hits        = 0;
     count_hits_sniper = 0;
     count_hits_head   = 0;
+    Clear(metrics.shots);
+    Clear(metrics.hits);
+    Clear(metrics.headshots);
+    Clear(metrics.time_to_hit);
 });
 
 CatCommand debug_hitrate("debug_hitrate", "Debug hitrate", []() {
@@ -44,6 +63,20 @@ CatCommand debug_hitrate("debug_hitrate", "Debug hitrate", []() {
     logging::Info("%d / %d (%d%%)", count_hits_head, count_hits_sniper, p2);
 });
 
+CatCommand debug_hitrate_metrics("debug_hitrate_metrics", "Hits per weapon class and distance", []() {
+    static const char *names[WEAPON_CLASSES] = { "hitscan", "sniper", "projectile", "melee" };
+    for (int weapon = 0; weapon < WEAPON_CLASSES; weapon++)
+    {
+        std::string line;
+        for (int distance = 0; distance < DISTANCE_BUCKETS; distance++)
+            line += format(" ", metrics.hits[weapon][distance].load(std::memory_order_relaxed), "/", metrics.shots[weapon][distance].load(std::memory_order_relaxed), " (", metrics.headshots[weapon][distance].load(std::memory_order_relaxed), ")");
+        line += " |";
+        for (auto &bucket : metrics.time_to_hit[weapon])
+            line += format(" ", bucket.load(std::memory_order_relaxed));
+        logging::Info("%s:%s", names[weapon], line.c_str());
+    }
+});
+
 CatCommand debug_ammo("debug_ammo", "Debug ammo", []() {
     for (int i = 0; i < 4; i++)
     {
@@ -58,17 +91,53 @@ std::array<Timer, PLAYER_ARRAY_SIZE> resolve_timer{};
 static int aimbot_target_idx   = -1;
 static bool aimbot_target_body = false;
 static Timer aimbot_shot{};
+static weapon_class shot_class = class_hitscan;
+static int shot_distance       = 0;
+static int last_clip           = -1;
+static int last_weapon         = -1;
+
+static weapon_class Classify(CachedEntity *weapon)
+{
+    if (weapon->m_iClassID() == CL_CLASS(CTFSniperRifle) || weapon->m_iClassID() == CL_CLASS(CTFSniperRifleDecap))
+        return class_sniper;
+    switch (g_pLocalPlayer->weapon_mode)
+    {
+    case weapon_projectile:
+    case weapon_throwable:
+        return class_projectile;
+    case weapon_melee:
+        return class_melee;
+    default:
+        return class_hitscan;
+    }
+}
+
+static int DistanceBucket(float distance)
+{
+    int bucket = 0;
+    for (float limit = 256.0f; bucket < DISTANCE_BUCKETS - 1 && distance >= limit; limit *= 2.0f)
+        bucket++;
+    return bucket;
+}
+
+static int TimeBucket(int64_t ms)
+{
+    int bucket = 0;
+    for (int64_t limit = 16; bucket < TIME_BUCKETS - 1 && ms >= limit; limit *= 2)
+        bucket++;
+    return bucket;
+}
 
 void OnShot()
 {
     ++count_shots;
+    Add(metrics.shots[shot_class][shot_distance]);
     resolve_soon[aimbot_target_idx] = true;
     resolve_timer[aimbot_target_idx].update();
 }
 
 void OnHit(bool crit, int idx, bool is_sniper)
 {
-    idx = g_IEngine->GetPlayerForUserID(idx);
     count_hits++;
     if (is_sniper)
         count_hits_sniper++;
@@ -81,7 +150,7 @@ void OnHit(bool crit, int idx, bool is_sniper)
             auto ent = ENTITY(idx);
             if (CE_GOOD(ent))
             {
-                hacks::shared::anti_anti_aim::resolver_map[ent->player_info.friendsID].hits_in_a_row++;
+                hacks::shared::anti_anti_aim::registerHit(idx);
                 resolve_soon[idx] = false;
             }
         }
@@ -93,6 +162,10 @@ void AimbotShot(int idx, bool target_body)
     aimbot_shot.update();
     aimbot_target_idx  = idx;
     aimbot_target_body = target_body;
+    if (CE_GOOD(LOCAL_W))
+        shot_class = Classify(LOCAL_W);
+    auto ent      = ENTITY(idx);
+    shot_distance = CE_GOOD(ent) ? DistanceBucket(ent->m_flDistance()) : 0;
 }
 
 void Update()
@@ -125,34 +198,44 @@ void Update()
                 }
         }
     }
+    // Projectiles come out of the clip instead
+    if (CE_GOOD(weapon) && g_pLocalPlayer->weapon_mode == weapon_projectile)
+    {
+        int clip = CE_INT(weapon, netvar.m_iClip1);
+        if (weapon->m_IDX == last_weapon && clip < last_clip && !aimbot_shot.check(500) && aimbot_target_idx != -1)
+            Add(metrics.shots[shot_class][shot_distance]);
+        last_clip   = clip;
+        last_weapon = weapon->m_IDX;
+    }
+    else
+        last_weapon = -1;
 }
 
-class HurtListener : public IGameEventListener
+static void Record(const player_hurt_s &hurt)
 {
-public:
-    virtual void FireGameEvent(KeyValues *event)
-    {
-        if (strcmp("player_hurt", event->GetName()))
-            return;
-        if (g_IEngine->GetPlayerForUserID(event->GetInt("attacker")) == g_IEngine->GetLocalPlayer())
-        {
-            if (CE_GOOD(LOCAL_W) && (LOCAL_W->m_iClassID() == CL_CLASS(CTFSniperRifle) || LOCAL_W->m_iClassID() == CL_CLASS(CTFSniperRifleDecap)))
-                OnHit(event->GetBool("crit"), event->GetInt("userid"), true);
-            else if (CE_GOOD(LOCAL_W) && g_pLocalPlayer->weapon_mode == weapon_hitscan)
-                OnHit(false, event->GetInt("userid"), false);
-        }
-    }
-};
+    weapon_class weapon = Classify(LOCAL_W);
+    auto victim         = ENTITY(hurt.victim);
+    int distance        = hurt.victim == aimbot_target_idx ? shot_distance : CE_GOOD(victim) ? DistanceBucket(victim->m_flDistance()) : 0;
+    Add(metrics.hits[weapon][distance]);
+    if (hurt.crit && weapon == class_sniper)
+        Add(metrics.headshots[weapon][distance]);
+    // Only the aimbot tells us when a shot was fired
+    if (hurt.victim == aimbot_target_idx && !aimbot_shot.check(2000))
+        Add(metrics.time_to_hit[weapon][TimeBucket(std::chrono::duration_cast<std::chrono::milliseconds>(Timer::Now() - aimbot_shot.last).count())]);
+}
 
-HurtListener &listener()
+static void OnPlayerHurt(const game_events::event_s &event)
 {
-    static HurtListener l{};
-    return l;
+    if (event.hurt->attacker == g_IEngine->GetLocalPlayer())
+    {
+        if (CE_GOOD(LOCAL_W))
+            Record(*event.hurt);
+        if (CE_GOOD(LOCAL_W) && (LOCAL_W->m_iClassID() == CL_CLASS(CTFSniperRifle) || LOCAL_W->m_iClassID() == CL_CLASS(CTFSniperRifleDecap)))
+            OnHit(event.hurt->crit, event.hurt->victim, true);
+        else if (CE_GOOD(LOCAL_W) && g_pLocalPlayer->weapon_mode == weapon_hitscan)
+            OnHit(false, event.hurt->victim, false);
+    }
 }
 
-InitRoutine init([]() {
-    g_IGameEventManager->AddListener(&listener(), false);
-    EC::Register(
-        EC::Shutdown, []() { g_IGameEventManager->RemoveListener(&listener()); }, "shutdown_hitrate");
-});
+InitRoutine init([]() { game_events::Subscribe("player_hurt", OnPlayerHurt); });
 } // namespace hitrate
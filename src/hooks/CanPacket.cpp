@@ -8,8 +8,9 @@
 namespace hooked_methods
 {
 
-DEFINE_HOOKED_METHOD(CanPacket, bool, INetChannel *this_)
+DEFINE_HOT_HOOKED_METHOD(CanPacket, bool, INetChannel *this_)
 {
+    HOOK_SCOPE(CanPacket);
     return original::CanPacket(this_);
 }
 } // namespace hooked_methods
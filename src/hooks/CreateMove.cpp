@@ -15,6 +15,7 @@
 #include "NavBot.hpp"
 #include "HookTools.hpp"
 #include "teamroundtimer.hpp"
+#include "dormant.hpp"
 
 #include "HookedMethods.hpp"
 #include "nospread.hpp"
@@ -59,7 +60,7 @@ void RunEnginePrediction(IClientEntity *ent, CUserCmd *ucmd)
     }
 
     // Set Usercmd for prediction
-    NET_VAR(ent, 4188, CUserCmd *) = ucmd;
+    NET_VAR(ent, netvar.m_pCurrentCommand, CUserCmd *) = ucmd;
 
     // Set correct CURTIME
     g_GlobalVars->curtime   = g_GlobalVars->interval_per_tick * NET_INT(ent, netvar.nTickBase);
@@ -75,7 +76,7 @@ void RunEnginePrediction(IClientEntity *ent, CUserCmd *ucmd)
     g_IGameMovement->FinishTrackPredictionErrors(reinterpret_cast<CBasePlayer *>(ent));
 
     // Reset User CMD
-    NET_VAR(ent, 4188, CUserCmd *) = nullptr;
+    NET_VAR(ent, netvar.m_pCurrentCommand, CUserCmd *) = nullptr;
 
     g_GlobalVars->frametime = frameTime;
     g_GlobalVars->curtime   = curTime;
@@ -120,8 +121,10 @@ void PrecalculateCanShoot()
 static int attackticks = 0;
 namespace hooked_methods
 {
-DEFINE_HOOKED_METHOD(CreateMove, bool, void *this_, float input_sample_time, CUserCmd *cmd)
+DEFINE_HOT_HOOKED_METHOD(CreateMove, bool, void *this_, float input_sample_time, CUserCmd *cmd)
 {
+    HOOK_SCOPE(CreateMove);
+    Timer::Sample();
     g_Settings.is_create_move = true;
     bool time_replaced, ret, speedapplied;
     float curtime_old, servertime, speed, yaw;
@@ -235,6 +238,26 @@ DEFINE_HOOKED_METHOD(CreateMove, bool, void *this_, float input_sample_time, CUs
         PROF_SECTION(CM_LocalPlayer);
         g_pLocalPlayer->Update();
     }
+    {
+        PROF_SECTION(CM_Spectators);
+        spectators::Update();
+    }
+    {
+        PROF_SECTION(CM_Velocity);
+        velocity::Update();
+    }
+    {
+        PROF_SECTION(CM_Dormant);
+        dormant::Update();
+    }
+    {
+        PROF_SECTION(CM_ProjectileTracker);
+        projectile_tracker::Update();
+    }
+    {
+        PROF_SECTION(CM_PrepareBones);
+        hitbox_cache::PrepareBones();
+    }
     PrecalculateCanShoot();
     if (firstcm)
     {
@@ -332,17 +355,6 @@ DEFINE_HOOKED_METHOD(CreateMove, bool, void *this_, float input_sample_time, CUs
 
     // TODO Auto Steam Friend
 
-#if ENABLE_IPC
-    {
-        PROF_SECTION(CM_playerlist);
-        static Timer ipc_update_timer{};
-        //	playerlist::DoNotKillMe();
-        if (ipc_update_timer.test_and_set(1000 * 10))
-        {
-            ipc::UpdatePlayerlist();
-        }
-    }
-#endif
     if (CE_GOOD(g_pLocalPlayer->entity))
     {
         speedapplied = false;
@@ -432,8 +444,9 @@ void WriteCmd(IInput *input, CUserCmd *cmd, int sequence_nr)
 }
 
 // This gets called before the other CreateMove, but since we run original first in here all the stuff gets called after normal CreateMove is done
-DEFINE_HOOKED_METHOD(CreateMoveInput, void, IInput *this_, int sequence_nr, float input_sample_time, bool arg3)
+DEFINE_HOT_HOOKED_METHOD(CreateMoveInput, void, IInput *this_, int sequence_nr, float input_sample_time, bool arg3)
 {
+    HOOK_SCOPE(CreateMoveInput);
     bSendPackets = reinterpret_cast<bool *>((uintptr_t) __builtin_frame_address(1) - 8);
     // Call original function, includes Normal CreateMove
     original::CreateMoveInput(this_, sequence_nr, input_sample_time, arg3);
@@ -15,6 +15,7 @@
 #include <iomanip>
 #include "votelogger.hpp"
 #include "nospread.hpp"
+#include "usermessages.hpp"
 
 static settings::Boolean dispatch_log{ "debug.log-dispatch-user-msg", "false" };
 static settings::Boolean chat_filter_enable{ "chat.censor.enable", "false" };
@@ -65,11 +66,9 @@ template <typename T> void SplitName(std::vector<T> &ret, const T &name, int num
 static int anti_balance_attempts = 0;
 static std::string previous_name = "";
 static Timer reset_it{};
-static Timer wait_timer{};
+// Runs every second
 void Paint()
 {
-    if (!wait_timer.test_and_set(1000))
-        return;
     INetChannel *server = (INetChannel *) g_IEngine->GetNetChannelInfo();
     if (server)
         reset_it.update();
@@ -79,15 +78,17 @@ void Paint()
         previous_name         = "";
     }
 }
-static InitRoutine Autobalance([]() { EC::Register(EC::Paint, Paint, "paint_autobalance", EC::average); });
+static InitRoutine Autobalance([]() { EC::Register(EC::Paint, Paint, "paint_autobalance", EC::every_ms(1000), EC::average); });
 DEFINE_HOOKED_METHOD(DispatchUserMessage, bool, void *this_, int type, bf_read &buf)
 {
+    HOOK_SCOPE(DispatchUserMessage);
     if (!isHackActive())
         return original::DispatchUserMessage(this_, type, buf);
 
-    int s, i, j;
+    int i;
     char c;
-    const char *buf_data = reinterpret_cast<const char *>(buf.m_pData);
+    usermessages::message_s message;
+    bool decoded = usermessages::Decode(buf, type, message);
 
     /* Delayed print of name and message, censored by chat_filter
      * TO DO: Document type 47
@@ -98,60 +99,44 @@ DEFINE_HOOKED_METHOD(DispatchUserMessage, bool, void *this_, int type, bf_read &
         retrun = false;
     }
     // We should bail out
-    if (!hacks::tf2::nospread::DispatchUserMessage(&buf, type))
+    if (decoded && !hacks::tf2::nospread::DispatchUserMessage(message))
         return true;
-    std::string data;
-    switch (type)
+    switch (decoded ? type : -1)
     {
 
-    case 25:
+    case usermessages::VoiceSubtitle:
     {
         // DATA = [ 01 01 06  ] For "Charge me Doctor!"
-        // First Byte represents entityid
-        int ent_id = buf.ReadByte();
-        // Second Byte represents the voicemenu used for it
-        int voice_menu = buf.ReadByte();
-        // Third Byte represents the command in that voicemenu (starting from 0)
-        int command_id = buf.ReadByte();
-
-        if (voice_menu == 1 && command_id == 6)
-            hacks::tf::autoheal::called_medic.push_back(ent_id);
-        // If we don't .Seek(0) the game will have a bad  time reading
-        buf.Seek(0);
+        // Entity, voicemenu and the command in that voicemenu (starting from 0)
+        auto &voice = message.voice_subtitle;
+        if (voice.menu == 1 && voice.command == 6)
+            hacks::tf::autoheal::called_medic.push_back(voice.entity);
         break;
     }
-    // Hud message
-    case 26:
+    case usermessages::HudNotify:
     {
-        // Hud message type
-        auto message_type = buf.ReadByte();
-
         // Truce activated
-        if (message_type == 26)
+        if (message.hud_notify.type == 26)
             setTruce(true);
         // Truce deactivated
-        else if (message_type == 27)
+        else if (message.hud_notify.type == 27)
             setTruce(false);
-
-        buf.Seek(0);
         break;
     }
-    case 12:
+    case usermessages::VGUIMenu:
         if (hacks::shared::catbot::anti_motd && hacks::shared::catbot::catbotmode)
         {
-            data = std::string(buf_data);
-            if (data.find("class_") != data.npos)
+            if (strstr(message.vgui_menu.name, "class_"))
                 return false;
         }
         break;
-    case 5:
+    case usermessages::TextMsg:
     {
-        if (*anti_votekick && buf.GetNumBytesLeft() > 35)
+        if (*anti_votekick && message.size > 35)
         {
             INetChannel *server = (INetChannel *) g_IEngine->GetNetChannelInfo();
-            data                = std::string(buf_data);
-            logging::Info("%s", data.c_str());
-            if (data.find("TeamChangeP") != data.npos && CE_GOOD(LOCAL_E))
+            logging::Info("%s", message.text_msg.text);
+            if (strstr(message.text_msg.text, "TeamChangeP") && CE_GOOD(LOCAL_E))
             {
                 std::string server_name(server->GetAddress());
                 if (server_name != previous_name)
@@ -178,24 +163,16 @@ DEFINE_HOOKED_METHOD(DispatchUserMessage, bool, void *this_, int type, bf_read &
         }
         break;
     }
-    case 4:
+    case usermessages::SayText2:
     {
-        s = buf.GetNumBytesLeft();
-        if (s >= 256 || CE_BAD(LOCAL_E))
+        if (CE_BAD(LOCAL_E))
             break;
-
-        for (i = 0; i < s; i++)
-            data.push_back(buf_data[i]);
-        /* First byte is player ENT index
-         * Second byte is unindentified (equals to 0x01)
-         */
-        const char *p = data.c_str() + 2;
-        std::string event(p), name((p += event.size() + 1)), message(p + name.size() + 1);
-        if (chat_filter_enable && data[0] == LOCAL_E->m_IDX && event == "#TF_Name_Change")
+        auto &say = message.say_text2;
+        if (chat_filter_enable && say.entity == LOCAL_E->m_IDX && !strcmp(say.event, "#TF_Name_Change"))
         {
-            chat_stack::Say("\e" + clear, false);
+            chat_stack::Say("\e" + clear, false, chat_stack::high);
         }
-        else if (chat_filter_enable && data[0] != LOCAL_E->m_IDX && event.find("TF_Chat") == 0)
+        else if (chat_filter_enable && say.entity != LOCAL_E->m_IDX && !strncmp(say.event, "TF_Chat", 7))
         {
             player_info_s info{};
             g_IEngine->GetPlayerInfo(LOCAL_E->m_IDX, &info);
@@ -242,7 +219,7 @@ DEFINE_HOOKED_METHOD(DispatchUserMessage, bool, void *this_, int type, bf_read &
             SplitName(res, name1, 2);
             SplitName(res, name1, 3);
 
-            std::string message2(message);
+            std::string message2(say.message);
             boost::to_lower(message2);
 
             const char *toreplace[]   = { " ", "4", "3", "0", "6", "5", "7", "@", ".", ",", "-" };
@@ -254,19 +231,17 @@ DEFINE_HOOKED_METHOD(DispatchUserMessage, bool, void *this_, int type, bf_read &
             for (auto filter : res)
                 if (boost::contains(message2, filter))
                 {
-                    chat_stack::Say("\e" + clear, true);
+                    chat_stack::Say("\e" + clear, true, chat_stack::high);
                     retrun     = true;
-                    lastfilter = message;
-                    lastname   = format(name);
+                    lastfilter = say.message;
+                    lastname   = say.name;
                     gitgud.update();
                     break;
                 }
         }
-        if (event.find("TF_Chat") == 0)
-            hacks::shared::ChatCommands::handleChatMessage(message, data[0]);
-        chatlog::LogMessage(data[0], message);
-        buf = bf_read(data.c_str(), data.size());
-        buf.Seek(0);
+        if (!strncmp(say.event, "TF_Chat", 7))
+            hacks::shared::ChatCommands::handleChatMessage(say.message, say.entity);
+        chatlog::LogMessage(say.entity, say.message);
         break;
     }
     }
@@ -296,7 +271,8 @@ DEFINE_HOOKED_METHOD(DispatchUserMessage, bool, void *this_, int type, bf_read &
         }
         buf.Seek(0);
     }
-    votelogger::dispatchUserMessage(buf, type);
+    if (decoded)
+        votelogger::dispatchUserMessage(message);
     return original::DispatchUserMessage(this_, type, buf);
 }
 } // namespace hooked_methods
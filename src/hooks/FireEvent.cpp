@@ -16,6 +16,7 @@ namespace hooked_methods
 // TODO: maybe remove?
 DEFINE_HOOKED_METHOD(FireEvent, bool, IGameEventManager2 *this_, IGameEvent *event, bool no_broadcast)
 {
+    HOOK_SCOPE(FireEvent);
     // hacks::tf2::killstreak::fire_event(event);
     return original::FireEvent(this_, event, no_broadcast);
 }
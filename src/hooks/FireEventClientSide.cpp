@@ -27,6 +27,7 @@ static bool spam_blocked = true;
 
 DEFINE_HOOKED_METHOD(FireEventClientSide, bool, IGameEventManager2 *this_, IGameEvent *event)
 {
+    HOOK_SCOPE(FireEventClientSide);
     if (enable_antispam && strcmp(event->GetName(), "party_chat") == 0)
     {
         // Increase total count
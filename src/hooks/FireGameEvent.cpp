@@ -11,6 +11,7 @@ namespace hooked_methods
 
 DEFINE_HOOKED_METHOD(FireGameEvent, void, void *this_, IGameEvent *event)
 {
+    HOOK_SCOPE(FireGameEvent);
     const char *name = event->GetName();
     if (name)
     {
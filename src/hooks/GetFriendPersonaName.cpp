@@ -164,6 +164,7 @@ namespace hooked_methods
 std::string GetFriendPersonaName_name;
 DEFINE_HOOKED_METHOD(GetFriendPersonaName, const char *, ISteamFriends *this_, CSteamID steam_id)
 {
+    HOOK_SCOPE(GetFriendPersonaName);
     if (!isHackActive())
         GetFriendPersonaName_name = "";
     else
@@ -8,8 +8,9 @@
 namespace hooked_methods
 {
 
-DEFINE_HOOKED_METHOD(GetUserCmd, CUserCmd *, IInput *this_, int sequence_number)
+DEFINE_HOT_HOOKED_METHOD(GetUserCmd, CUserCmd *, IInput *this_, int sequence_number)
 {
+    HOOK_SCOPE(GetUserCmd);
     // We need to overwrite this if crithack is on
     if (criticals::isEnabled())
         return &GetCmds(this_)[sequence_number % VERIFIED_CMD_SIZE];
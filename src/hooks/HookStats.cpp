@@ -0,0 +1,68 @@
+#include "common.hpp"
+#include "HookedMethods.hpp"
+
+namespace hooked_methods
+{
+static settings::Boolean enable_stats{ "debug.hook-stats.enable", "false" };
+
+bool hook_stats_enabled = false;
+
+// Function static, the stats get constructed during static init in every hook's translation unit
+static std::vector<hook_stats_s *> &all_stats()
+{
+    static std::vector<hook_stats_s *> list;
+    return list;
+}
+
+hook_stats_s::hook_stats_s(const char *name) : name{ name }
+{
+    all_stats().push_back(this);
+}
+
+void HookScope::End()
+{
+    uint64_t ticks = profiler::Now() - m_start;
+    m_stats.calls.fetch_add(1, std::memory_order_relaxed);
+    m_stats.ticks.fetch_add(ticks, std::memory_order_relaxed);
+    uint64_t max = m_stats.max_ticks.load(std::memory_order_relaxed);
+    while (ticks > max && !m_stats.max_ticks.compare_exchange_weak(max, ticks, std::memory_order_relaxed))
+        ;
+}
+
+static void Reset()
+{
+    for (auto stats : all_stats())
+    {
+        stats->calls     = 0;
+        stats->skipped   = 0;
+        stats->ticks     = 0;
+        stats->max_ticks = 0;
+    }
+}
+
+static CatCommand print("debug_print_hooks", "Print call counts and time spent in every hook, needs debug.hook-stats.enable", []() {
+    double ns_per_tick = profiler::NsPerTick();
+    std::vector<hook_stats_s *> sorted(all_stats());
+    std::sort(sorted.begin(), sorted.end(), [](hook_stats_s *a, hook_stats_s *b) { return a->ticks > b->ticks; });
+    for (auto stats : sorted)
+    {
+        uint64_t calls = stats->calls;
+        if (!calls)
+            continue;
+        double total_us = stats->ticks * ns_per_tick / 1000.0;
+        logging::Info("%-24s %10llu calls (%llu skipped) %12.0fus total %8.2fus avg %8.0fus max", stats->name, (unsigned long long) calls, (unsigned long long) stats->skipped.load(), total_us, total_us / calls, stats->max_ticks * ns_per_tick / 1000.0);
+    }
+});
+
+static CatCommand reset("debug_reset_hooks", "Reset the hook statistics", Reset);
+
+static InitRoutine init([]() {
+    hook_stats_enabled = *enable_stats;
+    enable_stats.installChangeCallback([](settings::VariableBase<bool> &, bool after) {
+        // Counting from scratch, otherwise the averages mix both periods
+        if (after)
+            Reset();
+        hook_stats_enabled = after;
+    });
+});
+} // namespace hooked_methods
@@ -1,59 +1,583 @@
 #include "common.hpp"
 #include "HookTools.hpp"
+#include "settings/Settings.hpp"
+#include <condition_variable>
+#include <thread>
 
 namespace EC
 {
 
+static settings::Boolean monitor{ "debug.ec-monitor.enable", "false" };
+// Log the slowest callbacks whenever CreateMove or Draw take longer than this, 0 to disable
+static settings::Int monitor_budget{ "debug.ec-monitor.budget-us", "0" };
+// Threads that run declared stages next to the game thread, 0 runs everything on the game thread
+static settings::Int stage_workers{ "ec.stage-workers", "2" };
+
+static const char *const event_type_names[] = { "CreateMove", "CreateMoveLate", "CreateMove_NoEnginePred", "CreateMoveEarly",
+#if ENABLE_VISUALS
+                                                "Draw",
+#endif
+                                                "Paint", "LevelInit", "FirstCM", "LevelShutdown", "Shutdown" };
+static_assert(sizeof(event_type_names) / sizeof(event_type_names[0]) == EcTypesSize, "Every event type needs a name");
+
+struct callback_stats
+{
+    // Copy of the callback name, the registry may move while the event runs
+    std::string name;
+    ProfilerHistogram histogram;
+    uint64_t last_ns{ 0 };
+    // run_counter of the run last_ns belongs to
+    unsigned long last_run{ 0 };
+};
+
+// Whole event runs, each callback has its own in callback_stats
+static ProfilerHistogram event_histograms[ec_types::EcTypesSize];
+static Timer budget_log_timer{};
+
+struct rate_state
+{
+    run_rate rate;
+    // Staggers callbacks with the same rate
+    unsigned phase;
+    std::chrono::steady_clock::time_point next_run;
+
+    // Whether to run this time, counter is how many times the event has fired
+    bool ShouldRun(unsigned long counter)
+    {
+        if (rate.ticks && (counter + phase) % rate.ticks)
+            return false;
+        if (rate.ms)
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (now < next_run)
+                return false;
+            next_run = now + std::chrono::milliseconds(rate.ms);
+        }
+        return true;
+    }
+};
+
+// Everything but the function pointer is only needed when (un)registering or printing
 struct EventCallbackData
 {
-    explicit EventCallbackData(const EventFunction &function, std::string name, enum ec_priority priority) : function{ function }, priority{ int(priority) }, section(name), event_name{ name }
+    explicit EventCallbackData(EventFunction function, std::string name, enum ec_priority priority) : function{ function }, priority{ int(priority) }, section(std::make_unique<ProfilerSection>(name)), stats(std::make_unique<callback_stats>(callback_stats{ name })), event_name{ name }
     {
     }
     EventFunction function;
     int priority;
-    ProfilerSection section;
+    // Cleared while the controlling setting is off
+    bool active{ true };
+    // Unregistered while its event was running, erased once that run is done
+    bool removed{ false };
+    // Only set for rate limited callbacks, heap allocated for the same reason as section
+    std::unique_ptr<rate_state> rate;
+#if ENABLE_VISUALS
+    // Only set for per tick Draw callbacks
+    std::unique_ptr<draw::display_list> display_list;
+#endif
+    // Heap allocated so the dispatch table can point at it while the registry gets reordered
+    std::unique_ptr<ProfilerSection> section;
+    std::unique_ptr<callback_stats> stats;
     std::string event_name;
+    stage access{ res_all, res_all };
+
+    bool Concurrent() const
+    {
+        bool serial = (access.reads | access.writes) & (res_usercmd | res_engine);
+#if ENABLE_VISUALS
+        // Display lists record through the one global draw state
+        serial = serial || display_list;
+#endif
+        return !serial;
+    }
 };
 
 static std::vector<EventCallbackData> events[ec_types::EcTypesSize];
+
+// Frozen dispatch tables, contiguous and sorted by priority. Only rebuilt after the registry changed
+static std::vector<EventFunction> dispatch[ec_types::EcTypesSize];
+static std::vector<ProfilerSection *> dispatch_sections[ec_types::EcTypesSize];
+// nullptr for callbacks that run every time
+static std::vector<rate_state *> dispatch_rates[ec_types::EcTypesSize];
+static std::vector<callback_stats *> dispatch_stats[ec_types::EcTypesSize];
+#if ENABLE_VISUALS
+// nullptr for callbacks that draw every frame
+static std::vector<draw::display_list *> dispatch_lists[ec_types::EcTypesSize];
+#endif
+// Neighbours with the same nonzero group may run at the same time, 0 always runs alone
+static std::vector<unsigned> dispatch_groups[ec_types::EcTypesSize];
+static bool dispatch_dirty[ec_types::EcTypesSize];
+static unsigned long run_counter[ec_types::EcTypesSize];
+// How deep run() is in each event, the dispatch tables point into the registry while it's nonzero
+static unsigned running[ec_types::EcTypesSize];
+static bool removal_pending[ec_types::EcTypesSize];
+// Handed out to rate limited callbacks in registration order
+static unsigned rate_limited_count{ 0 };
+
 CatCommand evt_print("debug_print_events", "Print EC events", []() {
     for (int i = 0; i < int(ec_types::EcTypesSize); ++i)
     {
         logging::Info("%d events:", i);
 
         for (auto it = events[i].begin(); it != events[i].end(); ++it)
-            logging::Info("%s", it->event_name.c_str());
+            logging::Info("%s%s%s", it->event_name.c_str(), it->active ? "" : " (disabled)", it->Concurrent() ? " (stage)" : "");
         logging::Info("");
     }
 });
 
+// Nothing ever gets rendered in textmode, so Draw callbacks aren't even kept
+static bool Dropped(enum ec_types type)
+{
+#if ENABLE_TEXTMODE && ENABLE_VISUALS
+    return type == Draw;
+#else
+    return false;
+#endif
+}
+
 void Register(enum ec_types type, const EventFunction &function, const std::string &name, enum ec_priority priority)
 {
+    if (Dropped(type))
+        return;
     events[type].emplace_back(function, name, priority);
-    // Order vector to always keep priorities correct
-    std::sort(events[type].begin(), events[type].end(), [](EventCallbackData &a, EventCallbackData &b) { return a.priority < b.priority; });
+    dispatch_dirty[type] = true;
+}
+
+void Register(enum ec_types type, const EventFunction &function, const std::string &name, settings::VariableBase<bool> &gate, enum ec_priority priority)
+{
+    if (Dropped(type))
+        return;
+    Register(type, function, name, priority);
+    events[type].back().active = *gate;
+    // Callbacks can't be removed from settings, so look the entry up again instead of keeping a pointer into the vector
+    gate.installChangeCallback([type, name](settings::VariableBase<bool> &, bool after) {
+        for (auto &i : events[type])
+            if (i.event_name == name)
+            {
+                i.active             = after;
+                dispatch_dirty[type] = true;
+                break;
+            }
+    });
+}
+
+void Register(enum ec_types type, const EventFunction &function, const std::string &name, run_rate rate, enum ec_priority priority)
+{
+    if (Dropped(type))
+        return;
+    Register(type, function, name, priority);
+    auto state  = std::make_unique<rate_state>();
+    state->rate = rate;
+    // Spread them over the period, the multiplier keeps neighbours apart for small periods too
+    unsigned slot = rate_limited_count++ * 7;
+    state->phase  = rate.ticks ? slot % rate.ticks : 0;
+    if (rate.ms)
+        state->next_run = std::chrono::steady_clock::now() + std::chrono::milliseconds(slot * 13 % rate.ms);
+    events[type].back().rate = std::move(state);
+}
+
+#if ENABLE_VISUALS
+void Register(enum ec_types type, const EventFunction &function, const std::string &name, visual_update update, enum ec_priority priority)
+{
+    if (Dropped(type))
+        return;
+    Register(type, function, name, priority);
+    if (update == per_tick)
+        events[type].back().display_list = std::make_unique<draw::display_list>();
+}
+#endif
+
+void Declare(enum ec_types type, const std::string &name, stage access)
+{
+    for (auto &i : events[type])
+        if (i.event_name == name)
+        {
+            i.access             = access;
+            dispatch_dirty[type] = true;
+            return;
+        }
+    logging::Info("[EC] Declaring %s before registering it", name.c_str());
 }
 
 void Unregister(enum ec_types type, const std::string &name)
 {
     auto &e = events[type];
     for (auto it = e.begin(); it != e.end(); ++it)
-        if (it->event_name == name)
+        if (it->event_name == name && !it->removed)
         {
-            e.erase(it);
+            // The running dispatch table still points at its section and stats
+            if (running[type])
+            {
+                it->removed           = true;
+                removal_pending[type] = true;
+            }
+            else
+                e.erase(it);
+            dispatch_dirty[type] = true;
             break;
         }
 }
 
+static void finish_run(ec_types type)
+{
+    if (--running[type] || !removal_pending[type])
+        return;
+    auto &e = events[type];
+    e.erase(std::remove_if(e.begin(), e.end(), [](const EventCallbackData &i) { return i.removed; }), e.end());
+    removal_pending[type] = false;
+}
+
+static void rebuild(ec_types type)
+{
+    auto &e = events[type];
+    // Stable so callbacks with the same priority keep their registration order. Registration order across files
+    // is whatever static init did, so pulling the declared stages of a priority to its front breaks nothing
+    std::stable_sort(e.begin(), e.end(), [](const EventCallbackData &a, const EventCallbackData &b) { return a.priority < b.priority || (a.priority == b.priority && a.Concurrent() && !b.Concurrent()); });
+    dispatch[type].clear();
+    dispatch_groups[type].clear();
+    dispatch_sections[type].clear();
+    dispatch_rates[type].clear();
+    dispatch_stats[type].clear();
+#if ENABLE_VISUALS
+    dispatch_lists[type].clear();
+#endif
+    // Union of what the current group touches
+    unsigned group    = 0;
+    int group_prio    = 0;
+    stage group_usage = { 0, 0 };
+    for (auto &i : e)
+    {
+        if (!i.active || i.removed)
+            continue;
+        bool conflict = (i.access.writes & (group_usage.reads | group_usage.writes)) || (group_usage.writes & i.access.reads);
+        if (!i.Concurrent())
+            group = 0;
+        else if (!group || i.priority != group_prio || conflict)
+        {
+            group       = dispatch_groups[type].size() + 1;
+            group_prio  = i.priority;
+            group_usage = { 0, 0 };
+        }
+        if (group)
+        {
+            group_usage.reads |= i.access.reads;
+            group_usage.writes |= i.access.writes;
+        }
+        dispatch_groups[type].push_back(group);
+        dispatch[type].push_back(i.function);
+        dispatch_sections[type].push_back(i.section.get());
+        dispatch_rates[type].push_back(i.rate.get());
+        dispatch_stats[type].push_back(i.stats.get());
+#if ENABLE_VISUALS
+        dispatch_lists[type].push_back(i.display_list.get());
+#endif
+    }
+    dispatch_dirty[type] = false;
+}
+
+#if ENABLE_VISUALS
+static void run_visual(EventFunction function, draw::display_list *list)
+{
+    if (draw::Replay(*list))
+        return;
+    draw::BeginRecording(*list);
+    function();
+    draw::EndRecording();
+}
+#endif
+
+static void log_over_budget(ec_types type, unsigned long counter, uint64_t total_ns)
+{
+    // Rate limited to once a second, so allocating here is fine
+    const callback_stats *const *stats = dispatch_stats[type].data();
+    std::vector<size_t> ran;
+    for (size_t i = 0; i < dispatch_stats[type].size(); i++)
+        if (stats[i]->last_run == counter)
+            ran.push_back(i);
+    size_t found = std::min<size_t>(3, ran.size());
+    std::partial_sort(ran.begin(), ran.begin() + found, ran.end(), [&](size_t a, size_t b) { return stats[a]->last_ns > stats[b]->last_ns; });
+    std::string offenders;
+    for (size_t i = 0; i < found; i++)
+        offenders += strfmt(" %s %lluus", stats[ran[i]]->name.c_str(), (unsigned long long) stats[ran[i]]->last_ns / 1000).get();
+    logging::Info("[EC] %s took %lluus, budget is %dus:%s", event_type_names[type], (unsigned long long) total_ns / 1000, *monitor_budget, offenders.c_str());
+}
+
+// Same as the plain loop in run, but times every callback. Stage groups run one by one here, so the times don't include contention
+static void run_monitored(ec_types type, unsigned long counter)
+{
+    const EventFunction *functions = dispatch[type].data();
+    rate_state *const *rates       = dispatch_rates[type].data();
+    callback_stats *const *stats   = dispatch_stats[type].data();
+    size_t count                   = dispatch[type].size();
+    double ns_per_tick             = profiler::NsPerTick();
+#if ENABLE_VISUALS
+    draw::display_list *const *lists = dispatch_lists[type].data();
+#endif
+#if ENABLE_PROFILER
+    ProfilerSection *const *sections = dispatch_sections[type].data();
+#endif
+    uint64_t run_start = profiler::Now();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (rates[i] && !rates[i]->ShouldRun(counter))
+            continue;
+        uint64_t start = profiler::Now();
+        {
+#if ENABLE_PROFILER
+            volatile ProfilerNode node(*sections[i]);
+#endif
+#if ENABLE_VISUALS
+            if (lists[i])
+                run_visual(functions[i], lists[i]);
+            else
+#endif
+                functions[i]();
+        }
+        stats[i]->last_ns  = uint64_t((profiler::Now() - start) * ns_per_tick);
+        stats[i]->last_run = counter;
+        stats[i]->histogram.Record(stats[i]->last_ns);
+    }
+    uint64_t total_ns = uint64_t((profiler::Now() - run_start) * ns_per_tick);
+    event_histograms[type].Record(total_ns);
+
+    bool budgeted = type == CreateMove;
+#if ENABLE_VISUALS
+    budgeted = budgeted || type == Draw;
+#endif
+    if (budgeted && *monitor_budget > 0 && total_ns > uint64_t(*monitor_budget) * 1000 && budget_log_timer.test_and_set(1000))
+        log_over_budget(type, counter, total_ns);
+}
+
+std::vector<callback_latency> SlowestCallbacks(size_t count)
+{
+    std::vector<callback_latency> result;
+    for (int type = 0; type < int(EcTypesSize); type++)
+        for (auto &i : events[type])
+            if (i.stats->histogram.total)
+                result.push_back({ i.event_name, event_type_names[type], i.stats->histogram.Percentile(0.5f) / 1000.0f, i.stats->histogram.Percentile(0.99f) / 1000.0f });
+    std::sort(result.begin(), result.end(), [](const callback_latency &a, const callback_latency &b) { return a.p99_us > b.p99_us; });
+    if (result.size() > count)
+        result.resize(count);
+    return result;
+}
+
+size_t SlowestLastRun(enum ec_types type, callback_time *out, size_t count)
+{
+    if (!*monitor || !run_counter[type] || !count)
+        return 0;
+    unsigned long counter = run_counter[type] - 1;
+    size_t found          = 0;
+    for (auto *stats : dispatch_stats[type])
+    {
+        if (stats->last_run != counter)
+            continue;
+        uint32_t us = uint32_t(stats->last_ns / 1000);
+        if (found == count && us <= out[found - 1].us)
+            continue;
+        // Insertion into the sorted list, count is a handful
+        size_t at = found < count ? found++ : found - 1;
+        for (; at > 0 && out[at - 1].us < us; at--)
+            out[at] = out[at - 1];
+        out[at] = callback_time{ stats->name.c_str(), us };
+    }
+    return found;
+}
+
+static CatCommand print_latency("debug_print_event_latency", "Print p50/p95/p99 of every EC event and callback, needs debug.ec-monitor.enable", []() {
+    for (int type = 0; type < int(EcTypesSize); type++)
+    {
+        auto &total = event_histograms[type];
+        if (!total.total)
+            continue;
+        logging::Info("%s: p50 %lluus p95 %lluus p99 %lluus", event_type_names[type], (unsigned long long) total.Percentile(0.5f) / 1000, (unsigned long long) total.Percentile(0.95f) / 1000, (unsigned long long) total.Percentile(0.99f) / 1000);
+        for (auto &i : events[type])
+        {
+            auto &h = i.stats->histogram;
+            if (h.total)
+                logging::Info("    %-32s p50 %lluus p95 %lluus p99 %lluus", i.event_name.c_str(), (unsigned long long) h.Percentile(0.5f) / 1000, (unsigned long long) h.Percentile(0.95f) / 1000, (unsigned long long) h.Percentile(0.99f) / 1000);
+        }
+    }
+});
+
+// Fork/join for groups of declared stages, the game thread works on the group too and only returns once all of it ran
+namespace stages
+{
+struct item_s
+{
+    EventFunction function;
+    ProfilerSection *section;
+};
+
+static std::mutex lock;
+static std::condition_variable wake;
+static std::vector<std::thread> workers;
+static bool stopping       = false;
+static unsigned generation = 0;
+static const item_s *items = nullptr;
+static size_t item_count   = 0;
+static std::atomic<size_t> next{ 0 };
+static std::atomic<size_t> finished{ 0 };
+// Workers holding the current group, it must not change under them
+static std::atomic<unsigned> active{ 0 };
+
+static void Work(const item_s *batch, size_t count)
+{
+    size_t i;
+    while ((i = next.fetch_add(1, std::memory_order_relaxed)) < count)
+    {
+        {
+#if ENABLE_PROFILER
+            volatile ProfilerNode node(*batch[i].section);
+#endif
+            batch[i].function();
+        }
+        finished.fetch_add(1, std::memory_order_release);
+    }
+}
+
+static void Worker()
+{
+    unsigned seen = 0;
+    for (;;)
+    {
+        const item_s *batch;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&]() { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen  = generation;
+            batch = items;
+            count = item_count;
+            // Woke up after the game thread was done with it
+            if (!count)
+                continue;
+            active.fetch_add(1, std::memory_order_relaxed);
+        }
+        Work(batch, count);
+        active.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+static void Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+    workers.clear();
+    stopping = false;
+}
+
+static void Run(const item_s *batch, size_t count)
+{
+    if (count <= 1)
+    {
+        next.store(0, std::memory_order_relaxed);
+        return Work(batch, count);
+    }
+    size_t wanted = std::clamp(*stage_workers, 0, 8);
+    if (workers.size() != wanted)
+    {
+        Stop();
+        for (size_t i = 0; i < wanted; i++)
+            workers.emplace_back(Worker);
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        items      = batch;
+        item_count = count;
+        next.store(0, std::memory_order_relaxed);
+        finished.store(0, std::memory_order_relaxed);
+        generation++;
+    }
+    wake.notify_all();
+    Work(batch, count);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        item_count = 0;
+    }
+    // Whatever is left is mostly short, so spin instead of sleeping on another condition variable
+    while (finished.load(std::memory_order_acquire) < count || active.load(std::memory_order_acquire))
+        std::this_thread::yield();
+}
+} // namespace stages
+
+static InitRoutine init_stages([]() { Register(Shutdown, stages::Stop, "shutdown_ec_stages", very_late); });
+
 void run(ec_types type)
 {
-    auto &vector = events[type];
-    for (auto &i : vector)
+    // A nested run of the same event keeps the table the outer one is walking
+    if (dispatch_dirty[type] && !running[type])
+        rebuild(type);
+    // Callbacks may (un)register, which only touches the registry until the next run
+    running[type]++;
+    struct finish_guard
+    {
+        ec_types type;
+        ~finish_guard()
+        {
+            finish_run(type);
+        }
+    } guard{ type };
+    const EventFunction *functions = dispatch[type].data();
+    rate_state *const *rates       = dispatch_rates[type].data();
+    size_t count                   = dispatch[type].size();
+    unsigned long counter          = run_counter[type]++;
+    if (*monitor)
+        return run_monitored(type, counter);
+#if ENABLE_PROFILER
+    ProfilerSection *const *sections = dispatch_sections[type].data();
+#endif
+#if ENABLE_VISUALS
+    draw::display_list *const *lists = dispatch_lists[type].data();
+#endif
+    const unsigned *groups = dispatch_groups[type].data();
+    bool parallel          = *stage_workers > 0;
+    for (size_t i = 0; i < count; i++)
     {
+        if (parallel && groups[i] && i + 1 < count && groups[i + 1] == groups[i])
+        {
+            unsigned group = groups[i];
+            size_t end     = i;
+            while (end < count && groups[end] == group)
+                end++;
+            stages::item_s batch[64];
+            size_t batched = 0;
+            for (; i < end; i++)
+            {
+                if (rates[i] && !rates[i]->ShouldRun(counter))
+                    continue;
 #if ENABLE_PROFILER
-        volatile ProfilerNode node(i.section);
+                batch[batched++] = { functions[i], sections[i] };
+#else
+                batch[batched++] = { functions[i], nullptr };
+#endif
+                if (batched == std::size(batch))
+                {
+                    stages::Run(batch, batched);
+                    batched = 0;
+                }
+            }
+            stages::Run(batch, batched);
+            i = end - 1;
+            continue;
+        }
+        if (rates[i] && !rates[i]->ShouldRun(counter))
+            continue;
+#if ENABLE_PROFILER
+        volatile ProfilerNode node(*sections[i]);
+#endif
+#if ENABLE_VISUALS
+        if (lists[i])
+            run_visual(functions[i], lists[i]);
+        else
 #endif
-        i.function();
+            functions[i]();
     }
 }
 
@@ -11,8 +11,9 @@ static settings::Boolean enable_debug_servercmd{ "debug.servercmdkeyvalues", "fa
 namespace hooked_methods
 {
 std::vector<KeyValues *> Iterate(KeyValues *event, int depth);
-DEFINE_HOOKED_METHOD(IsPlayingTimeDemo, bool, void *_this)
+DEFINE_HOT_HOOKED_METHOD(IsPlayingTimeDemo, bool, void *_this)
 {
+    HOOK_SCOPE(IsPlayingTimeDemo);
     if (nolerp)
     {
         uintptr_t ret_addr      = (uintptr_t) __builtin_return_address(1);
@@ -25,6 +26,7 @@ DEFINE_HOOKED_METHOD(IsPlayingTimeDemo, bool, void *_this)
 
 DEFINE_HOOKED_METHOD(ServerCmdKeyValues, void, IVEngineClient013 *_this, KeyValues *kv)
 {
+    HOOK_SCOPE(ServerCmdKeyValues);
     if (!enable_debug_servercmd)
         return original::ServerCmdKeyValues(_this, kv);
     logging::Info("START SERVERCMD KEYVALUES");
@@ -26,6 +26,7 @@ namespace hooked_methods
 
 DEFINE_HOOKED_METHOD(LevelInit, void, void *this_, const char *name)
 {
+    HOOK_SCOPE(LevelInit);
     firstcm = true;
     // nav::init = false;
     playerlist::Save();
@@ -49,7 +50,7 @@ DEFINE_HOOKED_METHOD(LevelInit, void, void *this_, const char *name)
     else if (holiday->m_nValue == 2)
         holiday->SetValue(0);
 #endif
-    hacks::shared::anti_anti_aim::resolver_map.clear();
+    hacks::shared::anti_anti_aim::reset();
     g_IEngine->ClientCmd_Unrestricted("exec cat_matchexec");
     chat_stack::Reset();
     original::LevelInit(this_, name);
@@ -57,6 +58,7 @@ DEFINE_HOOKED_METHOD(LevelInit, void, void *this_, const char *name)
 #if ENABLE_IPC
     if (ipc::peer)
     {
+        ipc::publish_scope publish(ipc::peer->memory->peer_user_data[ipc::peer->client_id]);
         ipc::peer->memory->peer_user_data[ipc::peer->client_id].ts_connected = time(nullptr);
     }
 #endif
@@ -12,6 +12,7 @@ namespace hooked_methods
 
 DEFINE_HOOKED_METHOD(LevelShutdown, void, void *this_)
 {
+    HOOK_SCOPE(LevelShutdown);
     need_name_change = true;
     playerlist::Save();
     g_Settings.bInvalid = true;
@@ -22,6 +23,7 @@ DEFINE_HOOKED_METHOD(LevelShutdown, void, void *this_)
 #if ENABLE_IPC
     if (ipc::peer)
     {
+        ipc::publish_scope publish(ipc::peer->memory->peer_user_data[ipc::peer->client_id]);
         ipc::peer->memory->peer_user_data[ipc::peer->client_id].ts_disconnected = time(nullptr);
     }
 #endif
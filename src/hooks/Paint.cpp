@@ -14,12 +14,17 @@
 #include "drawmgr.hpp"
 #endif
 extern settings::Boolean die_if_vac;
+#if ENABLE_TEXTMODE
+extern settings::Boolean textmode_minimal_cpu;
+static unsigned long last_paint_tick = 0;
+#endif
 static Timer checkmmban{};
 namespace hooked_methods
 {
 
-DEFINE_HOOKED_METHOD(Paint, void, IEngineVGui *this_, PaintMode_t mode)
+DEFINE_HOT_HOOKED_METHOD(Paint, void, IEngineVGui *this_, PaintMode_t mode)
 {
+    HOOK_SCOPE(Paint);
     if (!isHackActive())
     {
         return original::Paint(this_, mode);
@@ -30,38 +35,21 @@ DEFINE_HOOKED_METHOD(Paint, void, IEngineVGui *this_, PaintMode_t mode)
 
     if (mode & PaintMode_t::PAINT_UIPANELS)
     {
+        profiler::FrameMark();
+        Timer::Sample();
         hitrate::Update();
-#if ENABLE_IPC
-        static Timer nametimer{};
-        if (nametimer.test_and_set(1000 * 10))
-        {
-            if (ipc::peer)
-            {
-                ipc::StoreClientData();
-            }
-        }
-        static Timer ipc_timer{};
-        if (ipc_timer.test_and_set(1000))
-        {
-            if (ipc::peer)
-            {
-                if (ipc::peer->HasCommands())
-                {
-                    ipc::peer->ProcessCommands();
-                }
-                ipc::Heartbeat();
-                ipc::UpdateTemporaryData();
-            }
-        }
-#endif
         if (!hack::command_stack().empty())
         {
             PROF_SECTION(PT_command_stack);
-            std::lock_guard<std::mutex> guard(hack::command_stack_mutex);
-            // logging::Info("executing %s",
-            //              hack::command_stack().top().c_str());
-            g_IEngine->ClientCmd_Unrestricted(hack::command_stack().top().c_str());
-            hack::command_stack().pop();
+            std::string command;
+            {
+                std::lock_guard<std::mutex> guard(hack::command_stack_mutex);
+                command = std::move(hack::command_stack().top());
+                hack::command_stack().pop();
+            }
+            // Our own commands may queue more, so run them without the lock
+            if (!DispatchCatCommands(command))
+                g_IEngine->ClientCmd_Unrestricted(command.c_str());
         }
 #if !ENABLE_VISUALS
         if (*die_if_vac && checkmmban.test_and_set(1000))
@@ -72,20 +60,24 @@ DEFINE_HOOKED_METHOD(Paint, void, IEngineVGui *this_, PaintMode_t mode)
 #endif
 
 #if ENABLE_TEXTMODE_STDIN == 1
-        static auto last_stdin = std::chrono::system_clock::from_time_t(0);
-        auto ms                = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - last_stdin).count();
-        if (ms > 500)
-        {
-            UpdateInput();
-            last_stdin = std::chrono::system_clock::now();
-        }
+        // Lines from the stdin reader thread, free when there are none
+        UpdateInput();
 #endif
         // MOVED BACK because glez and imgui flicker in painttraveerse
 #if ENABLE_IMGUI_DRAWING || ENABLE_GLEZ_DRAWING
         render_cheat_visuals();
 #endif
         // Call all paint functions
-        EC::run(EC::Paint);
+#if ENABLE_TEXTMODE
+        // Frames can still outrun ticks, nothing on Paint needs to run more often than that. Out of game there are no ticks
+        if (!*textmode_minimal_cpu || !g_IEngine->IsInGame() || last_paint_tick != tickcount)
+#endif
+        {
+#if ENABLE_TEXTMODE
+            last_paint_tick = tickcount;
+#endif
+            EC::run(EC::Paint);
+        }
     }
 
 #if ENABLE_TEXTMODE
@@ -6,31 +6,38 @@ namespace hacks::tf2::animfix
 DetourHook frameadvance_detour{};
 typedef float (*FrameAdvance_t)(IClientEntity *, float);
 
-std::vector<float> previous_simtimes;
+static float previous_simtimes[PLAYER_ARRAY_SIZE]{};
+// Bit n is set if player n was alive and not dormant in the newest entity snapshot
+static uint64_t alive_players = 0;
+static_assert(PLAYER_ARRAY_SIZE <= 64, "alive_players needs more bits");
+
+static void UpdateAlivePlayers()
+{
+    alive_players = 0;
+    for (auto ent : entity_cache::players())
+        if (entity_cache::snapshot.alive[ent->m_IDX] && !entity_cache::snapshot.dormant[ent->m_IDX])
+            alive_players |= 1ull << ent->m_IDX;
+}
 
 // Credits to Blackfire62 for telling me how this could be realized
 float FrameAdvance_hook(IClientEntity *self, float flInterval)
 {
     float newInterval = flInterval;
 
-    // Check if the entity is valid
-    if (self && IDX_GOOD(self->entindex()) && self->entindex() > 0 && self->entindex() <= (int) previous_simtimes.size())
+    // Props, viewmodels, cosmetics and ragdolls animate through here too, only alive players are ours
+    int idx = self ? self->entindex() : 0;
+    if (unsigned(idx - 1) < unsigned(MAX_PLAYERS) && (alive_players >> idx) & 1)
     {
-        // Check if they are an alive player
-        CachedEntity *ent = ENTITY(self->entindex());
         // Set new interval based on their simtime
-        if (CE_GOOD(ent) && ent->m_Type() == ENTITY_PLAYER && ent->m_bAlivePlayer())
-        {
-            float simtime = CE_FLOAT(ent, netvar.m_flSimulationTime);
-            // Calculate the time we need to animate by
-            float time_difference = simtime - previous_simtimes.at(ent->m_IDX - 1);
-            if (time_difference > 0.0f)
-                newInterval = time_difference;
-            previous_simtimes.at(ent->m_IDX - 1) = simtime;
-            // If the simtime didn't update we need to make sure that the original function also does not update
-            if (newInterval == 0.0f)
-                CE_FLOAT(ent, netvar.m_flAnimTime) = g_GlobalVars->curtime;
-        }
+        float simtime = NET_FLOAT(self, netvar.m_flSimulationTime);
+        // Calculate the time we need to animate by
+        float time_difference = simtime - previous_simtimes[idx];
+        if (time_difference > 0.0f)
+            newInterval = time_difference;
+        previous_simtimes[idx] = simtime;
+        // If the simtime didn't update we need to make sure that the original function also does not update
+        if (newInterval == 0.0f)
+            NET_FLOAT(self, netvar.m_flAnimTime) = g_GlobalVars->curtime;
     }
 
     FrameAdvance_t original = (FrameAdvance_t) frameadvance_detour.GetOriginalFunc();
@@ -41,14 +48,17 @@ float FrameAdvance_hook(IClientEntity *self, float flInterval)
 
 void LevelInit()
 {
-    previous_simtimes.clear();
-    previous_simtimes.resize(g_IEngine->GetMaxClients());
+    alive_players = 0;
+    for (auto &simtime : previous_simtimes)
+        simtime = 0.0f;
 }
 
 static InitRoutine init([]() {
     static auto FrameAdvance_signature = gSignatures.GetClientSignature("55 89 E5 57 56 53 83 EC 4C 8B 5D ? 80 BB ? ? ? ? 00 0F 85 ? ? ? ? 8B B3");
     frameadvance_detour.Init(FrameAdvance_signature, (void *) FrameAdvance_hook);
     EC::Register(EC::LevelInit, LevelInit, "levelinit_animfix");
+    // Once per tick, right after the entity cache got its snapshot
+    EC::Register(EC::CreateMove, UpdateAlivePlayers, "cm_animfix_alive", EC::very_early);
     LevelInit();
 
     EC::Register(
@@ -11,8 +11,9 @@ static settings::Boolean medal_flip{ "visual.medal-flip", "false" };
 namespace hooked_methods
 {
 
-DEFINE_HOOKED_METHOD(RandomInt, int, IUniformRandomStream *this_, int min, int max)
+DEFINE_HOT_HOOKED_METHOD(RandomInt, int, IUniformRandomStream *this_, int min, int max)
 {
+    HOOK_SCOPE(RandomInt);
     if (medal_flip && min == 0 && max == 9)
         return 0;
 
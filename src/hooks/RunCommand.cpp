@@ -7,8 +7,9 @@ int last_tick   = 0;
 int last_weapon = 0;
 
 // Credits to blackfire for telling me to do this :)
-DEFINE_HOOKED_METHOD(RunCommand, void, IPrediction *prediction, IClientEntity *entity, CUserCmd *usercmd, IMoveHelper *move)
+DEFINE_HOT_HOOKED_METHOD(RunCommand, void, IPrediction *prediction, IClientEntity *entity, CUserCmd *usercmd, IMoveHelper *move)
 {
+    HOOK_SCOPE(RunCommand);
     if (CE_GOOD(LOCAL_E) && CE_GOOD(LOCAL_W) && entity && entity->entindex() == g_pLocalPlayer->entity_idx && usercmd && usercmd->command_number)
     {
         original::RunCommand(prediction, entity, usercmd, move);
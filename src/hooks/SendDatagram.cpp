@@ -8,8 +8,9 @@
 #include "Backtrack.hpp"
 namespace hooked_methods
 {
-DEFINE_HOOKED_METHOD(SendDatagram, int, INetChannel *ch, bf_write *buf)
+DEFINE_HOT_HOOKED_METHOD(SendDatagram, int, INetChannel *ch, bf_write *buf)
 {
+    HOOK_SCOPE(SendDatagram);
     if (!isHackActive() || !ch || CE_BAD(LOCAL_E) || std::floor(*hacks::tf2::backtrack::latency) == 0)
         return original::SendDatagram(ch, buf);
 
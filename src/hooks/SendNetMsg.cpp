@@ -9,8 +9,9 @@
 #include <MiscTemporary.hpp>
 #include "nullnexus.hpp"
 #include "e8call.hpp"
-#include "Warp.hpp"
 #include "nospread.hpp"
+#include "kvtemplate.hpp"
+#include "netmessages.hpp"
 
 static settings::Int newlines_msg{ "chat.prefix-newlines", "0" };
 static settings::Boolean log_sent{ "debug.log-sent-chat", "false" };
@@ -20,24 +21,24 @@ constexpr int CAT_IDENTIFY   = 0xCA7;
 constexpr int CAT_REPLY      = 0xCA8;
 constexpr float AUTH_MESSAGE = 1234567.0f;
 
-namespace hacks::shared::catbot
-{
-void SendNetMsg(INetMessage &msg);
-}
 namespace hooked_methods
 {
 
 static bool send_drawline_reply{};
 static Timer reply_timer{};
 
-void sendDrawlineKv(float x_value, float y_value)
-{
-    KeyValues *kv = new KeyValues("cl_drawline");
+static kv_template drawline_kv("cl_drawline", [](KeyValues *kv) {
+    // Has to be this to get broadcasted
     kv->SetInt("panel", 2);
+    // "New" line
     kv->SetInt("line", 0);
-    kv->SetFloat("x", x_value);
-    kv->SetFloat("y", y_value);
-    g_IEngine->ServerCmdKeyValues(kv);
+    kv->SetFloat("x", 0.0f);
+    kv->SetFloat("y", 0.0f);
+});
+
+void sendDrawlineKv(float x_value, float y_value)
+{
+    drawline_kv.Make().Float("x", x_value).Float("y", y_value).Send();
 }
 
 void sendIdentifyMessage(bool reply)
@@ -45,17 +46,7 @@ void sendIdentifyMessage(bool reply)
     reply ? sendDrawlineKv(CAT_REPLY, AUTH_MESSAGE) : sendDrawlineKv(CAT_IDENTIFY, AUTH_MESSAGE);
 }
 
-static CatCommand debug_drawpanel("debug_drawline", "debug", []() {
-    KeyValues *kv = new KeyValues("cl_drawline");
-    // Has to be this to get broadcasted
-    kv->SetInt("panel", 2);
-    // "New" line
-    kv->SetInt("line", 0);
-
-    kv->SetFloat("x", CAT_IDENTIFY);
-    kv->SetFloat("y", AUTH_MESSAGE);
-    g_IEngine->ServerCmdKeyValues(kv);
-});
+static CatCommand debug_drawpanel("debug_drawline", "debug", []() { sendDrawlineKv(CAT_IDENTIFY, AUTH_MESSAGE); });
 
 void ProcessSendline(IGameEvent *kv)
 {
@@ -168,19 +159,14 @@ void ParseKeyValue(KeyValues *event)
     }
 }
 
-class IdentifyListener : public IGameEventListener2
+static void OnDrawline(const game_events::event_s &event)
 {
-    virtual void FireGameEvent(IGameEvent *event)
-    {
-        if (*identify)
-            ProcessSendline(event);
-    }
-}; // namespace hooked_methods
+    if (*identify)
+        ProcessSendline(event.raw);
+}
 
 static CatCommand send_identify("debug_send_identify", "debug", []() { sendIdentifyMessage(false); });
 
-static IdentifyListener event_listener{};
-
 static InitRoutine run_identify([]() {
     EC::Register(
         EC::CreateMove,
@@ -196,13 +182,12 @@ static InitRoutine run_identify([]() {
             sendIdentifyMessage(false);
         },
         "sendnetmsg_createmove");
-    g_IEventManager2->AddListener(&event_listener, "cl_drawline", false);
-    EC::Register(
-        EC::Shutdown, []() { g_IEventManager2->RemoveListener(&event_listener); }, "shutdown_event");
+    game_events::Subscribe("cl_drawline", OnDrawline);
 });
 
-DEFINE_HOOKED_METHOD(SendNetMsg, bool, INetChannel *this_, INetMessage &msg, bool force_reliable, bool voice)
+DEFINE_HOT_HOOKED_METHOD(SendNetMsg, bool, INetChannel *this_, INetMessage &msg, bool force_reliable, bool voice)
 {
+    HOOK_SCOPE(SendNetMsg);
     if (!isHackActive())
         return original::SendNetMsg(this_, msg, force_reliable, voice);
     size_t say_idx, say_team_idx;
@@ -210,15 +195,13 @@ DEFINE_HOOKED_METHOD(SendNetMsg, bool, INetChannel *this_, INetMessage &msg, boo
     std::string newlines{};
     NET_StringCmd stringcmd;
 
-    // Do we have to force reliable state?
-    if (hacks::tf2::nospread::SendNetMessage(&msg))
-        force_reliable = true;
-    // Don't use warp with nospread
-    else
-        hacks::tf2::warp::SendNetMessage(msg);
+    // Nospread can force the reliable state here, and keeps warp away from moves it does
+    net_messages::outgoing_s outgoing{ msg, msg.GetType(), force_reliable };
+    net_messages::Dispatch(outgoing);
+    force_reliable = outgoing.force_reliable;
+    int type       = outgoing.type;
 
-    // net_StringCmd
-    if (msg.GetType() == 4 && (newlines_msg || crypt_chat))
+    if (type == net_StringCmd && (newlines_msg || crypt_chat))
     {
         std::string str(msg.ToString());
         say_idx      = str.find("net_StringCmd: \"say \"");
@@ -268,7 +251,7 @@ DEFINE_HOOKED_METHOD(SendNetMsg, bool, INetChannel *this_, INetMessage &msg, boo
     }
     // SoonTM
     /*
-    if (msg.GetType() == 16)
+    if (type == clc_CmdKeyValues)
     {
         std::string message(msg.GetName());
         if (message.find("MVM_Upgrade"))
@@ -288,14 +271,12 @@ DEFINE_HOOKED_METHOD(SendNetMsg, bool, INetChannel *this_, INetMessage &msg, boo
             }
         }
     }*/
-    if (!strcmp(msg.GetName(), "clc_CmdKeyValues"))
-        hacks::shared::catbot::SendNetMsg(msg);
-    if (log_sent && msg.GetType() != 3 && msg.GetType() != 9)
+    if (log_sent && type != net_Tick && type != clc_Move)
     {
-        if (!strcmp(msg.GetName(), "clc_CmdKeyValues"))
+        if (type == clc_CmdKeyValues)
             if ((KeyValues *) (((unsigned *) &msg)[4]))
                 ParseKeyValue((KeyValues *) (((unsigned *) &msg)[4]));
-        logging::Info("=> %s [%i] %s", msg.GetName(), msg.GetType(), msg.ToString());
+        logging::Info("=> %s [%i] %s", msg.GetName(), type, msg.ToString());
         unsigned char buf[4096];
         bf_write buffer("cathook_debug_buffer", buf, 4096);
         logging::Info("Writing %i", msg.WriteToBuffer(buffer));
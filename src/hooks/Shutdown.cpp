@@ -21,6 +21,7 @@ namespace hooked_methods
 
 DEFINE_HOOKED_METHOD(Shutdown, void, INetChannel *this_, const char *reason)
 {
+    HOOK_SCOPE(Shutdown);
     g_Settings.bInvalid = true;
     logging::Info("Disconnect: %s", reason);
     if (strstr(reason, "banned") || (strstr(reason, "Generic_Kicked") && tfmm::isMMBanned()))
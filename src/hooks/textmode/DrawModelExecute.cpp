@@ -7,8 +7,9 @@
 namespace hooked_methods
 {
 
-DEFINE_HOOKED_METHOD(DrawModelExecute, void, IVModelRender *this_, const DrawModelState_t &state, const ModelRenderInfo_t &info, matrix3x4_t *bone)
+DEFINE_HOT_HOOKED_METHOD(DrawModelExecute, void, IVModelRender *this_, const DrawModelState_t &state, const ModelRenderInfo_t &info, matrix3x4_t *bone)
 {
+    HOOK_SCOPE(DrawModelExecute);
     return;
 }
 } // namespace hooked_methods
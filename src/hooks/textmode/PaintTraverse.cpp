@@ -2,8 +2,9 @@
 #include "HookedMethods.hpp"
 namespace hooked_methods
 {
-DEFINE_HOOKED_METHOD(PaintTraverse, void, vgui::IPanel *, unsigned int, bool, bool)
+DEFINE_HOT_HOOKED_METHOD(PaintTraverse, void, vgui::IPanel *, unsigned int, bool, bool)
 {
+    HOOK_SCOPE(PaintTraverse);
     return;
 }
 } // namespace hooked_methods
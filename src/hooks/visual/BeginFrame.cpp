@@ -8,8 +8,9 @@
 namespace hooked_methods
 {
 
-DEFINE_HOOKED_METHOD(BeginFrame, void, IStudioRender *this_)
+DEFINE_HOT_HOOKED_METHOD(BeginFrame, void, IStudioRender *this_)
 {
+    HOOK_SCOPE(BeginFrame);
     return original::BeginFrame(this_);
 }
 } // namespace hooked_methods
\ No newline at end of file
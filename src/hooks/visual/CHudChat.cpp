@@ -8,11 +8,13 @@ static settings::Boolean anti_spam{ "chat.anti-spam", "false" };
 
 DEFINE_HOOKED_METHOD(StartMessageMode, int, CHudBaseChat *_this, int mode)
 {
+    HOOK_SCOPE(StartMessageMode);
     ignoreKeys = true;
     return original::StartMessageMode(_this, mode);
 }
 DEFINE_HOOKED_METHOD(StopMessageMode, void *, CHudBaseChat *_this)
 {
+    HOOK_SCOPE(StopMessageMode);
     ignoreKeys = false;
     return original::StopMessageMode(_this);
 }
@@ -35,6 +37,7 @@ struct SpamClass
 std::array<std::vector<SpamClass>, MAX_PLAYERS> spam_storage;
 DEFINE_HOOKED_METHOD(ChatPrintf, void, CHudBaseChat *_this, int player_idx, int iFilter, const char *str, ...)
 {
+    HOOK_SCOPE(ChatPrintf);
     auto buf = std::make_unique<char[]>(1024);
     va_list list;
     va_start(list, str);
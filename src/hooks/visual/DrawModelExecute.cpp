@@ -33,6 +33,105 @@ static bool init_mat = false;
 static CMaterialReference mat_dme_chams;
 static CMaterialReference mat_dme_arm1_chams;
 static CMaterialReference mat_dme_arm_chams;
+
+// What a model is, only ever looked at by name once per level
+enum model_flags : uint8_t
+{
+    MODEL_ARMS       = 1 << 0,
+    MODEL_GUNSLINGER = 1 << 1,
+    MODEL_HAT        = 1 << 2,
+    // Set on every cached entry so a zero key can mean empty
+    MODEL_KNOWN = 1 << 7
+};
+
+// Open addressing on the model pointer, models live until the level ends
+constexpr size_t MODEL_CACHE_SIZE = 2048;
+static struct
+{
+    const model_t *model[MODEL_CACHE_SIZE];
+    uint8_t flags[MODEL_CACHE_SIZE];
+} model_cache{};
+
+static uint8_t ClassifyModel(const model_t *model)
+{
+    uint8_t flags    = MODEL_KNOWN;
+    const char *name = g_IModelInfo->GetModelName(model);
+    if (!name)
+        return flags;
+    if (strstr(name, "arms"))
+        flags |= MODEL_ARMS;
+    if (strstr(name, "c_engineer_gunslinger"))
+        flags |= MODEL_GUNSLINGER;
+    if (strstr(name, "player/items"))
+        flags |= MODEL_HAT;
+    return flags;
+}
+
+static uint8_t ModelFlags(const model_t *model)
+{
+    if (!model)
+        return MODEL_KNOWN;
+    size_t slot = (uintptr_t(model) >> 4) & (MODEL_CACHE_SIZE - 1);
+    for (size_t probe = 0; probe < 16; probe++, slot = (slot + 1) & (MODEL_CACHE_SIZE - 1))
+    {
+        if (model_cache.model[slot] == model)
+            return model_cache.flags[slot];
+        if (!model_cache.model[slot])
+        {
+            model_cache.model[slot] = model;
+            model_cache.flags[slot] = ClassifyModel(model);
+            return model_cache.flags[slot];
+        }
+    }
+    // Crowded neighbourhood, just look at the name every time
+    return ClassifyModel(model);
+}
+
+enum entity_flags : uint8_t
+{
+    // Alive player other than us, gets backtrack chams
+    ENTITY_BACKTRACK = 1 << 0,
+    ENTITY_SPECTATED = 1 << 1
+};
+
+// Rebuilt on the first draw of every frame, only holds what the enabled features care about
+static struct
+{
+    int framecount{ -1 };
+    uint8_t model_mask{ 0 };
+    uint8_t entity[PLAYER_ARRAY_SIZE]{};
+} frame;
+
+static void UpdateFrame()
+{
+    if (frame.framecount == g_GlobalVars->framecount)
+        return;
+    frame.framecount = g_GlobalVars->framecount;
+    frame.model_mask = 0;
+    if (no_arms)
+        frame.model_mask |= MODEL_ARMS;
+    if (arms_chams)
+        frame.model_mask |= MODEL_ARMS | MODEL_GUNSLINGER;
+    if (no_hats)
+        frame.model_mask |= MODEL_HAT;
+
+    memset(frame.entity, 0, sizeof(frame.entity));
+    // Hitbox outlines get drawn with the rest of the 2D stuff
+    if (hacks::tf2::backtrack::chams && !hacks::tf2::backtrack::chams_hitboxes && hacks::tf2::backtrack::isBacktrackEnabled)
+    {
+        int local       = g_IEngine->GetLocalPlayer();
+        int max_clients = std::min(g_IEngine->GetMaxClients(), PLAYER_ARRAY_SIZE - 1);
+        for (int i = 1; i <= max_clients; i++)
+        {
+            CachedEntity *ent = ENTITY(i);
+            if (i != local && CE_GOOD(ent) && ent->m_bAlivePlayer())
+                frame.entity[i] |= ENTITY_BACKTRACK;
+        }
+    }
+    if (spectator_target > 0 && spectator_target < PLAYER_ARRAY_SIZE)
+        frame.entity[spectator_target] |= ENTITY_SPECTATED;
+}
+
 static InitRoutine init_dme([]() {
     EC::Register(
         EC::LevelShutdown,
@@ -42,21 +141,34 @@ static InitRoutine init_dme([]() {
                 mat_dme_chams.Shutdown();
                 init_mat = false;
             }
+            model_cache      = {};
+            frame.framecount = -1;
         },
         "dme_lvl_shutdown");
 });
 bool aa_draw = false;
-DEFINE_HOOKED_METHOD(DrawModelExecute, void, IVModelRender *this_, const DrawModelState_t &state, const ModelRenderInfo_t &info, matrix3x4_t *bone)
+
+// Runs for every model drawn, props, world models and most viewmodels leave on the first lookup
+static bool Needed(const ModelRenderInfo_t &info)
 {
     if (!isHackActive())
-        return original::DrawModelExecute(this_, state, info, bone);
-
-    if (!(hacks::tf2::backtrack::isBacktrackEnabled /*|| (hacks::shared::antiaim::force_fakelag && hacks::shared::antiaim::isEnabled())*/ || blend_zoom || spectator_target || arms_chams || no_arms || no_hats || (*clean_screenshots && g_IEngine->IsTakingScreenshot()) || CE_BAD(LOCAL_E) || !LOCAL_E->m_bAlivePlayer()))
-    {
-        return original::DrawModelExecute(this_, state, info, bone);
-    }
+        return false;
+    // Glow and chams draw through us, those passes must stay untouched
     if (effect_glow::g_EffectGlow.drawing || effect_chams::g_EffectChams.drawing)
-        return original::DrawModelExecute(this_, state, info, bone);
+        return false;
+    UpdateFrame();
+    // Everything but the backtrack ticks gets hidden during that pass
+    if (hacks::tf2::backtrack::isDrawing)
+        return true;
+    if (unsigned(info.entity_index) < unsigned(PLAYER_ARRAY_SIZE) && frame.entity[info.entity_index])
+        return true;
+    return frame.model_mask && (ModelFlags(info.pModel) & frame.model_mask);
+}
+
+DEFINE_HOT_HOOKED_METHOD(DrawModelExecute, void, IVModelRender *this_, const DrawModelState_t &state, const ModelRenderInfo_t &info, matrix3x4_t *bone)
+{
+    HOOK_SCOPE(DrawModelExecute);
+    HOOK_SKIP_UNLESS(Needed(info), original::DrawModelExecute(this_, state, info, bone));
 
     PROF_SECTION(DrawModelExecute);
 
@@ -95,60 +207,53 @@ DEFINE_HOOKED_METHOD(DrawModelExecute, void, IVModelRender *this_, const DrawMod
         init_mat = true;
     }
 
-    if (info.pModel)
+    uint8_t model = ModelFlags(info.pModel);
+    if (model & (MODEL_ARMS | MODEL_GUNSLINGER))
     {
-        const char *name = g_IModelInfo->GetModelName(info.pModel);
-        if (name)
+        if (no_arms && model & MODEL_ARMS)
         {
-            std::string sname = name;
-            if (sname.find("arms") != std::string::npos || sname.find("c_engineer_gunslinger") != std::string::npos)
-            {
-                if (no_arms && sname.find("arms") != std::string::npos)
-                {
-                    return;
-                }
-
-                if (arms_chams)
-                {
-                    rgba_t original_color;
-
-                    g_IVRenderView->GetColorModulation(original_color);
-                    original_color.a = g_IVRenderView->GetBlend();
-
-                    g_IVModelRender->ForcedMaterialOverride(mat_dme_arm1_chams);
-                    g_IVRenderView->SetBlend((*arm_basechams_color).a);
-                    g_IVRenderView->SetColorModulation(*arm_basechams_color);
-                    original::DrawModelExecute(this_, state, info, bone);
-
-                    g_IVModelRender->ForcedMaterialOverride(mat_dme_arm_chams);
-                    g_IVRenderView->SetBlend((*arm_overlaychams_color).a);
-                    g_IVRenderView->SetColorModulation(*arm_overlaychams_color);
-                    original::DrawModelExecute(this_, state, info, bone);
-
-                    g_IVModelRender->ForcedMaterialOverride(nullptr);
-                    g_IVRenderView->SetColorModulation(original_color);
-                    g_IVRenderView->SetBlend(original_color.a);
-                    return;
-                }
-            }
+            return;
+        }
 
-            if (no_hats && sname.find("player/items") != std::string::npos)
-            {
-                return;
-            }
+        if (arms_chams)
+        {
+            rgba_t original_color;
 
-            /*
-            if(g_pLocalPlayer->bZoomed && sname.find("models/weapons") != std::string::npos)
-            {
-                g_IVModelRender->ForcedMaterialOverride(nullptr);
-                g_IVRenderView->SetBlend(0.2f);
-                original::DrawModelExecute(this_, state, info, bone);
-                return;
-            }
-            */
+            g_IVRenderView->GetColorModulation(original_color);
+            original_color.a = g_IVRenderView->GetBlend();
+
+            g_IVModelRender->ForcedMaterialOverride(mat_dme_arm1_chams);
+            g_IVRenderView->SetBlend((*arm_basechams_color).a);
+            g_IVRenderView->SetColorModulation(*arm_basechams_color);
+            original::DrawModelExecute(this_, state, info, bone);
+
+            g_IVModelRender->ForcedMaterialOverride(mat_dme_arm_chams);
+            g_IVRenderView->SetBlend((*arm_overlaychams_color).a);
+            g_IVRenderView->SetColorModulation(*arm_overlaychams_color);
+            original::DrawModelExecute(this_, state, info, bone);
+
+            g_IVModelRender->ForcedMaterialOverride(nullptr);
+            g_IVRenderView->SetColorModulation(original_color);
+            g_IVRenderView->SetBlend(original_color.a);
+            return;
         }
     }
 
+    if (no_hats && model & MODEL_HAT)
+    {
+        return;
+    }
+
+    /*
+    if(g_pLocalPlayer->bZoomed && sname.find("models/weapons") != std::string::npos)
+    {
+        g_IVModelRender->ForcedMaterialOverride(nullptr);
+        g_IVRenderView->SetBlend(0.2f);
+        original::DrawModelExecute(this_, state, info, bone);
+        return;
+    }
+    */
+
     // Used for fakes and for backtrack chams/glow
 
     // Maybe one day i'll get this working
@@ -181,62 +286,44 @@ DEFINE_HOOKED_METHOD(DrawModelExecute, void, IVModelRender *this_, const DrawMod
         aa_draw  = false;
         angles.y = backup;
     }*/
-    if (hacks::tf2::backtrack::chams && hacks::tf2::backtrack::isBacktrackEnabled)
+    // Filled in UpdateFrame only while backtrack chams are on
+    if (unsigned(info.entity_index) < unsigned(PLAYER_ARRAY_SIZE) && frame.entity[info.entity_index] & ENTITY_BACKTRACK)
     {
-        const char *name = g_IModelInfo->GetModelName(info.pModel);
-        if (name)
+        // Tick(s) to draw, with the bones stored when they were recorded so nothing gets set up again
+        auto ticks = hacks::tf2::backtrack::getChamsTicks(info.entity_index);
+
+        // Check if valid
+        if (!ticks.empty())
         {
-            std::string sname = name;
-            if (sname.find("models/player") || sname.find("models/weapons") || sname.find("models/workshop/player") || sname.find("models/workshop/weapons"))
-            {
-                if (IDX_GOOD(info.entity_index) && info.entity_index <= g_IEngine->GetMaxClients() && info.entity_index != g_IEngine->GetLocalPlayer())
-                {
-                    CachedEntity *ent = ENTITY(info.entity_index);
-                    if (CE_GOOD(ent) && ent->m_bAlivePlayer())
-                    {
-
-                        // Get Backtrack data for target entity
-                        auto good_ticks = hacks::tf2::backtrack::getGoodTicks(info.entity_index);
-
-                        // Check if valid
-                        if (!good_ticks.empty())
-                        {
-                            // Make our own Chamsish Material
-                            // Render Chams/Glow stuff
-                            CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
-                            // Backup Blend
-                            float orig_blend = g_IVRenderView->GetBlend();
-                            // Make Backtrack stuff Use chams alpha
-                            g_IVRenderView->SetBlend((*hacks::tf2::backtrack::chams_color).a);
-
-                            rgba_t mod_original;
-                            // Save color just in case, then set to team color
-                            g_IVRenderView->GetColorModulation(mod_original.rgba);
-                            g_IVRenderView->SetColorModulation(*hacks::tf2::backtrack::chams_color);
-                            // Important for Depth
-                            ptr->DepthRange(0.0f, 1.0f);
-                            // Apply our material
-                            if (hacks::tf2::backtrack::chams_solid)
-                                g_IVModelRender->ForcedMaterialOverride(mat_dme_chams);
-
-                            // Draw as many ticks as desired
-                            for (unsigned i = 0; i <= (unsigned) std::max(*hacks::tf2::backtrack::chams_ticks, 1); i++)
-                            {
-                                // Can't draw more than we have
-                                if (i >= good_ticks.size())
-                                    break;
-                                if (!good_ticks[i].bones.empty())
-                                    original::DrawModelExecute(this_, state, info, &good_ticks[i].bones[0]);
-                            }
-                            // Revert
-                            g_IVRenderView->SetColorModulation(mod_original.rgba);
-                            g_IVModelRender->ForcedMaterialOverride(nullptr);
-                            g_IVRenderView->SetBlend(orig_blend);
-                        }
-                    }
-                }
-            }
+            // Make our own Chamsish Material
+            // Render Chams/Glow stuff
+            CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
+            // Backup Blend
+            float orig_blend = g_IVRenderView->GetBlend();
+            // Make Backtrack stuff Use chams alpha
+            g_IVRenderView->SetBlend((*hacks::tf2::backtrack::chams_color).a);
+
+            rgba_t mod_original;
+            // Save color just in case, then set to team color
+            g_IVRenderView->GetColorModulation(mod_original.rgba);
+            g_IVRenderView->SetColorModulation(*hacks::tf2::backtrack::chams_color);
+            // Important for Depth
+            ptr->DepthRange(0.0f, 1.0f);
+            // Apply our material
+            if (hacks::tf2::backtrack::chams_solid)
+                g_IVModelRender->ForcedMaterialOverride(mat_dme_chams);
+
+            for (auto &tick : ticks)
+                if (tick.bones)
+                    original::DrawModelExecute(this_, state, info, tick.bones);
+            // Revert
+            g_IVRenderView->SetColorModulation(mod_original.rgba);
+            g_IVModelRender->ForcedMaterialOverride(nullptr);
+            g_IVRenderView->SetBlend(orig_blend);
         }
+        // The chams effect doesn't need to draw this one again
+        if (!hacks::tf2::backtrack::isDrawing)
+            hacks::tf2::backtrack::chams_drawn_frame[info.entity_index] = g_GlobalVars->framecount;
     }
     IClientUnknown *unk = info.pRenderable->GetIClientUnknown();
     if (unk)
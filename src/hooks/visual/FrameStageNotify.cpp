@@ -30,8 +30,9 @@ std::vector<std::string> gui_strings    = { "Other", "VGUI" };
 namespace hooked_methods
 {
 #include "reclasses.hpp"
-DEFINE_HOOKED_METHOD(FrameStageNotify, void, void *this_, ClientFrameStage_t stage)
+DEFINE_HOT_HOOKED_METHOD(FrameStageNotify, void, void *this_, ClientFrameStage_t stage)
 {
+    HOOK_SCOPE(FrameStageNotify);
     if (!isHackActive())
         return original::FrameStageNotify(this_, stage);
 
@@ -10,6 +10,7 @@ namespace hooked_methods
 
 DEFINE_HOOKED_METHOD(IN_KeyEvent, int, void *this_, int eventcode, ButtonCode_t keynum, const char *binding)
 {
+    HOOK_SCOPE(IN_KeyEvent);
     return original::IN_KeyEvent(this_, eventcode, keynum, binding);
 }
 } // namespace hooked_methods
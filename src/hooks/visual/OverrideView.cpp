@@ -17,6 +17,7 @@ namespace hooked_methods
 
 DEFINE_HOOKED_METHOD(OverrideView, void, void *this_, CViewSetup *setup)
 {
+    HOOK_SCOPE(OverrideView);
     original::OverrideView(this_, setup);
 
     if (!isHackActive() || g_Settings.bInvalid || CE_BAD(LOCAL_E))
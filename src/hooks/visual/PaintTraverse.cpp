@@ -36,8 +36,9 @@ CatCommand join("mm_join", "Join mm Match", []() {
 bool replaced = false;
 namespace hooked_methods
 {
-DEFINE_HOOKED_METHOD(PaintTraverse, void, vgui::IPanel *this_, vgui::VPANEL panel, bool force, bool allow_force)
+DEFINE_HOT_HOOKED_METHOD(PaintTraverse, void, vgui::IPanel *this_, vgui::VPANEL panel, bool force, bool allow_force)
 {
+    HOOK_SCOPE(PaintTraverse);
     if (!isHackActive())
         return original::PaintTraverse(this_, panel, force, allow_force);
 
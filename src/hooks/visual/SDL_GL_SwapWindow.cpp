@@ -12,6 +12,7 @@
 #include "clip.h"
 #if ENABLE_VISUALS
 #include "drawmgr.hpp"
+#include "visual/frametiming.hpp"
 #endif
 
 static bool swapwindow_init{ false };
@@ -30,13 +31,15 @@ namespace hooked_methods
 #if ENABLE_CLIP
 DEFINE_HOOKED_METHOD(SDL_SetClipboardText, int, const char *text)
 {
+    HOOK_SCOPE(SDL_SetClipboardText);
     clip::set_text(text);
     return 0;
 }
 #endif
 
-DEFINE_HOOKED_METHOD(SDL_GL_SwapWindow, void, SDL_Window *window)
+DEFINE_HOT_HOOKED_METHOD(SDL_GL_SwapWindow, void, SDL_Window *window)
 {
+    HOOK_SCOPE(SDL_GL_SwapWindow);
     if (!init_wminfo)
     {
         GetWindowWMInfo = *reinterpret_cast<SDL_GetWindowWMInfo_t *>(sharedobj::libsdl().Pointer(0xFD4D8));
@@ -71,8 +74,10 @@ DEFINE_HOOKED_METHOD(SDL_GL_SwapWindow, void, SDL_Window *window)
             swapwindow_init = true;
         }
         draw::BeginGL();
+        frame_timing::FlushBegin();
         DrawCache();
         draw::EndGL();
+        frame_timing::FlushEnd();
     }
     {
         PROF_SECTION(SWAPWINDOW_tf2);
@@ -9,16 +9,22 @@
 namespace hooked_methods
 {
 
-DEFINE_HOOKED_METHOD(SDL_PollEvent, int, SDL_Event *event)
+DEFINE_HOT_HOOKED_METHOD(SDL_PollEvent, int, SDL_Event *event)
 {
+    HOOK_SCOPE(SDL_PollEvent);
     auto ret = original::SDL_PollEvent(event);
 #if ENABLE_GUI
     if (!isHackActive())
         return ret;
-    static Timer waitfirst{};
+    // Nothing left this frame, event wasn't filled in
+    if (!ret)
+    {
+        gui::flushSdlEvents();
+        g_IEngine->GetScreenSize(draw::width, draw::height);
+        return ret;
+    }
     if (!ignoreKeys && gui::handleSdlEvent(event))
         return 0;
-    g_IEngine->GetScreenSize(draw::width, draw::height);
 #endif
     return ret;
 }
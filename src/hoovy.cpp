@@ -42,7 +42,7 @@ void UpdateHoovyList()
     if (CE_BAD(LOCAL_E))
         return;
 
-    static CachedEntity *ent;
+    CachedEntity *ent;
     for (int i = 1; i <= MAX_PLAYERS && i < g_IEntityList->GetHighestEntityIndex(); i++)
     {
         ent = ENTITY(i);
@@ -69,4 +69,8 @@ bool IsHoovy(CachedEntity *entity)
     return hoovy_list[entity->m_IDX - 1];
 }
 
-static InitRoutine init_heavy([]() { EC::Register(EC::CreateMove, UpdateHoovyList, "cm_hoovylist", EC::average); });
+static InitRoutine init_heavy([]() {
+    EC::Register(EC::CreateMove, UpdateHoovyList, "cm_hoovylist", EC::average);
+    // Only reads netvars, hoovy_list is its own
+    EC::Declare(EC::CreateMove, "cm_hoovylist", { EC::res_snapshot, 0 });
+});
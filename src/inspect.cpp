@@ -0,0 +1,281 @@
+/*
+ * Live inspection for headless bots. With debug.inspect.enable every process listens on its own unix socket,
+ * served from a thread of its own. Once per interval the game thread publishes a snapshot of the profiler,
+ * entity snapshot, nav stats, memory accounting and EC timings, connections only ever get the newest one.
+ *
+ *   echo "profiler nav" | socat - UNIX-CONNECT:/tmp/cathook-inspect-<pid>.sock
+ *
+ * An empty request or "all" gets every section, the answer is one line of JSON.
+ */
+
+#include "common.hpp"
+#include "navparser.hpp"
+#include "memtrack.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <thread>
+
+namespace inspect
+{
+static settings::Boolean enable{ "debug.inspect.enable", "false" };
+static settings::Int interval{ "debug.inspect.interval-ms", "1000" };
+
+enum section : uint8_t
+{
+    SEC_PROFILER = 0,
+    SEC_ENTITIES,
+    SEC_NAV,
+    SEC_MEMORY,
+    SEC_EVENTS,
+    SECTION_COUNT
+};
+static const char *const section_names[] = { "profiler", "entities", "nav", "memory", "events" };
+static_assert(sizeof(section_names) / sizeof(section_names[0]) == SECTION_COUNT, "Every section needs a name");
+
+struct snapshot_s
+{
+    // CLOCK_MONOTONIC
+    int64_t time_ns;
+    // Complete JSON values
+    std::string sections[SECTION_COUNT];
+};
+
+// Swapped in whole, the server thread never sees one that's still being built
+static std::shared_ptr<const snapshot_s> published{};
+static Timer publish_timer{};
+
+static std::thread server{};
+static std::atomic<bool> running{ false };
+static int listen_fd = -1;
+
+static int64_t Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static std::string SocketPath()
+{
+    return "/tmp/cathook-inspect-" + std::to_string(getpid()) + ".sock";
+}
+
+template <typename... Args> static void Format(std::string &out, const char *format, Args... args)
+{
+    char buffer[256];
+    int length = snprintf(buffer, sizeof(buffer), format, args...);
+    if (length > 0)
+        out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+}
+
+static void Escaped(std::string &out, const std::string &text)
+{
+    out.push_back('"');
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if ((unsigned char) c < 0x20)
+            Format(out, "\\u%04x", c);
+        else
+            out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+static std::string Profiler()
+{
+    std::vector<profiler::section_stats_s> sections;
+    profiler::CollectSections(sections);
+    std::string out;
+    Format(out, "{\"sample_rate\":%u,\"sections\":[", profiler::sample_mask + 1);
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        auto &section = sections[i];
+        out += i ? ",{\"name\":" : "{\"name\":";
+        Escaped(out, section.name);
+        out += ",\"parent\":";
+        Escaped(out, section.parent);
+        Format(out, ",\"calls\":%u,\"sum_ns\":%llu,\"min_ns\":%llu,\"max_ns\":%llu}", section.calls, (unsigned long long) section.sum_ns, (unsigned long long) section.min_ns, (unsigned long long) section.max_ns);
+    }
+    out += "]}";
+    return out;
+}
+
+static std::string Entities()
+{
+    using entity_cache::snapshot;
+    std::string out;
+    // Arrays instead of objects, a full server would be a few hundred KB otherwise
+    Format(out, "{\"tick\":%lu,\"max\":%d,\"fields\":[\"index\",\"class\",\"type\",\"team\",\"health\",\"alive\",\"dormant\",\"x\",\"y\",\"z\"],\"entities\":[", (unsigned long) tickcount, entity_cache::max);
+    bool first = true;
+    for (int i = 1; i <= entity_cache::max; i++)
+    {
+        if (!entity_cache::SnapshotValid(i))
+            continue;
+        Format(out, "%s[%d,%d,%d,%d,%d,%d,%d,%.0f,%.0f,%.0f]", first ? "" : ",", i, snapshot.class_id[i], int(snapshot.type[i]), snapshot.team[i], snapshot.health[i], int(snapshot.alive[i]), int(snapshot.dormant[i]), snapshot.origin[i].x, snapshot.origin[i].y, snapshot.origin[i].z);
+        first = false;
+    }
+    out += "]}";
+    return out;
+}
+
+static std::string Nav()
+{
+    std::string out;
+    Format(out, "{\"status\":%d,\"solves\":%llu,\"solve_ns\":%llu,\"repaths\":%llu,\"ignored\":%u}", int(nav::status.load()), (unsigned long long) nav::stats.solves.load(std::memory_order_relaxed), (unsigned long long) nav::stats.solve_ns.load(std::memory_order_relaxed), (unsigned long long) nav::stats.repaths.load(std::memory_order_relaxed), unsigned(nav::ignoredConnections()));
+    return out;
+}
+
+static std::string Memory()
+{
+    memtrack::Update();
+    std::string out = "{";
+    for (int i = 0; i < memtrack::TAG_COUNT; i++)
+    {
+        auto &stats = memtrack::stats[i];
+        Format(out, "%s\"%s\":{\"live\":%lld,\"peak\":%lld,\"allocations\":%llu}", i ? "," : "", memtrack::Name(memtrack::tag(i)), (long long) stats.Live(), (long long) stats.peak.load(std::memory_order_relaxed), (unsigned long long) stats.allocations.load(std::memory_order_relaxed));
+    }
+    out += "}";
+    return out;
+}
+
+static std::string Events()
+{
+    // Empty unless debug.ec-monitor.enable is on
+    auto callbacks  = EC::SlowestCallbacks(64);
+    std::string out = "[";
+    for (size_t i = 0; i < callbacks.size(); i++)
+    {
+        out += i ? ",{\"name\":" : "{\"name\":";
+        Escaped(out, callbacks[i].name);
+        Format(out, ",\"event\":\"%s\",\"p50_us\":%.1f,\"p99_us\":%.1f}", callbacks[i].event, callbacks[i].p50_us, callbacks[i].p99_us);
+    }
+    out += "]";
+    return out;
+}
+
+// The entity snapshot is only valid in CreateMove, so this runs at its end
+static void Publish()
+{
+    if (!running.load(std::memory_order_relaxed) || !publish_timer.test_and_set(std::max(*interval, 100)))
+        return;
+    auto next                    = std::make_shared<snapshot_s>();
+    next->time_ns                = Now();
+    next->sections[SEC_PROFILER] = Profiler();
+    next->sections[SEC_ENTITIES] = Entities();
+    next->sections[SEC_NAV]      = Nav();
+    next->sections[SEC_MEMORY]   = Memory();
+    next->sections[SEC_EVENTS]   = Events();
+    std::atomic_store(&published, std::shared_ptr<const snapshot_s>(std::move(next)));
+}
+
+// Server thread from here on
+static std::string Respond(const char *request)
+{
+    auto snapshot = std::atomic_load(&published);
+    if (!snapshot)
+        return "{\"error\":\"nothing published yet\"}\n";
+    bool wanted[SECTION_COUNT]{};
+    bool any = false;
+    for (int i = 0; i < SECTION_COUNT; i++)
+        if (strstr(request, section_names[i]))
+            wanted[i] = any = true;
+
+    std::string out;
+    Format(out, "{\"pid\":%d,\"age_ms\":%lld", int(getpid()), (long long) ((Now() - snapshot->time_ns) / 1000000));
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        if (any && !wanted[i])
+            continue;
+        Format(out, ",\"%s\":", section_names[i]);
+        out += snapshot->sections[i];
+    }
+    out += "}\n";
+    return out;
+}
+
+static void Serve(int fd)
+{
+    while (running.load(std::memory_order_relaxed))
+    {
+        pollfd listening{ fd, POLLIN, 0 };
+        if (poll(&listening, 1, 200) <= 0)
+            continue;
+        int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0)
+            continue;
+        // One client at a time, so a stuck one must not hold up the next
+        timeval timeout{ 0, 200000 };
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        char request[256];
+        ssize_t length = recv(client, request, sizeof(request) - 1, 0);
+        if (length < 0)
+            length = 0;
+        request[length] = '\0';
+
+        std::string response = Respond(request);
+        for (size_t sent = 0; sent < response.size();)
+        {
+            ssize_t written = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0)
+                break;
+            sent += written;
+        }
+        close(client);
+    }
+}
+
+static void Start()
+{
+    if (running.load())
+        return;
+    std::string path = SocketPath();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    // Left behind by a crashed process with a recycled pid
+    unlink(path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (sockaddr *) &address, sizeof(address)) < 0 || listen(fd, 4) < 0)
+    {
+        logging::Info("Inspect: can't listen on %s: %s", path.c_str(), strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+    listen_fd = fd;
+    running.store(true);
+    server = std::thread(Serve, fd);
+    logging::Info("Inspect: listening on %s", path.c_str());
+}
+
+static void Stop()
+{
+    if (!running.load())
+        return;
+    running.store(false);
+    server.join();
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(SocketPath().c_str());
+    std::atomic_store(&published, std::shared_ptr<const snapshot_s>());
+}
+
+static InitRoutine init([]() {
+    enable.installChangeCallback([](settings::VariableBase<bool> &, bool after) {
+        if (after)
+            Start();
+        else
+            Stop();
+    });
+    EC::Register(EC::CreateMove, Publish, "inspect_publish", enable, EC::very_late);
+    EC::Register(EC::Shutdown, Stop, "shutdown_inspect", EC::average);
+});
+} // namespace inspect
@@ -14,17 +14,50 @@
 #include "hitrate.hpp"
 #include "MiscTemporary.hpp"
 #include "GetFriendPersonaName.hpp"
+#include "settings/Profile.hpp"
+#include "ipcchannel.hpp"
+#include "ipctelemetry.hpp"
+#include "ipcscheduler.hpp"
+#include "ipcplayerlist.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
 
 #if ENABLE_IPC
 
 static settings::Boolean ipc_update_list{ "ipc.update-player-list", "true" };
-static settings::Int bot_chunks("ipc.bot-chunks", "1");
 
 namespace ipc
 {
 
 static settings::String server_name{ "ipc.server", "cathook_followbot_server" };
 
+// Applies a profile pushed by ipc_push_profile, peers map it straight from shared memory
+static void LoadSharedProfile(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0)
+    {
+        logging::Info("IPC: can't open profile %s", name);
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+    void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        logging::Info("IPC: can't map profile %s", name);
+        return;
+    }
+    if (settings::profile::Load(mapping, info.st_size))
+        logging::Info("IPC: loaded profile %s", name);
+    munmap(mapping, info.st_size);
+}
+
 CatCommand fix_deadlock("ipc_fix_deadlock", "Fix deadlock", []() {
     if (peer)
     {
@@ -45,20 +78,33 @@ CatCommand connect("ipc_connect", "Connect to IPC server", []() {
         logging::Info("peer count: %i", peer->memory->peer_count);
         logging::Info("magic number: 0x%08x", peer->memory->global_data.magic_number);
         logging::Info("magic number offset: 0x%08x", (uintptr_t) &peer->memory->global_data.magic_number - (uintptr_t) peer->memory);
+        // Peers of another build would read our slots with a different layout
+        unsigned magic = peer->memory->global_data.magic_number;
+        if (magic && magic != cathook_magic_number)
+            throw std::runtime_error(strfmt("IPC layout mismatch, server has 0x%08x and we need 0x%08x", magic, cathook_magic_number).get());
         peer->SetCommandHandler(commands::execute_client_cmd, [](cat_ipc::command_s &command, void *payload) { hack::command_stack().push(std::string((const char *) &command.cmd_data)); });
         peer->SetCommandHandler(commands::execute_client_cmd_long, [](cat_ipc::command_s &command, void *payload) { hack::command_stack().push(std::string((const char *) payload)); });
+        peer->SetCommandHandler(commands::load_profile, [](cat_ipc::command_s &command, void *payload) { LoadSharedProfile((const char *) payload); });
+        channel::SetHandler(commands::execute_client_cmd, [](const channel::message_s &message) { hack::ExecuteCommand(std::string(message.data, strnlen(message.data, message.size))); });
+        channel::Connect(*server_name);
+        telemetry::Connect(*server_name);
+        scheduler::Connect(*server_name);
+        shared_playerlist::Connect(*server_name);
         user_data_s &data = peer->memory->peer_user_data[peer->client_id];
 
         // Preserve accumulated data
         ipc::user_data_s::accumulated_t accumulated;
         memcpy(&accumulated, &data.accumulated, sizeof(accumulated));
+        // Readers still remember the old sequence of this slot, keep counting from there
+        uint32_t sequence = data.sequence;
         memset(&data, 0, sizeof(data));
         memcpy(&data.accumulated, &accumulated, sizeof(accumulated));
+        data.sequence = sequence;
 
         StoreClientData();
         Heartbeat();
         // Load a config depending on id
-        hack::command_stack().push("exec cat_autoexec_ipc_" + std::to_string(peer->client_id % std::max(1, *bot_chunks)));
+        hack::command_stack().push("exec cat_autoexec_ipc_" + std::to_string(scheduler::Chunk()));
     }
     catch (std::exception &error)
     {
@@ -68,6 +114,10 @@ CatCommand connect("ipc_connect", "Connect to IPC server", []() {
     }
 });
 CatCommand disconnect("ipc_disconnect", "Disconnect from IPC server", []() {
+    channel::Disconnect();
+    telemetry::Disconnect();
+    scheduler::Disconnect();
+    shared_playerlist::Disconnect();
     if (peer)
         delete peer;
     peer = nullptr;
@@ -95,28 +145,60 @@ CatCommand exec("ipc_exec", "Execute command (first argument = bot ID)", [](cons
     std::string command = std::string(args.ArgS());
     command             = command.substr(command.find(' ', 0) + 1);
     ReplaceString(command, " && ", " ; ");
-    if (command.length() >= 63)
-    {
-        peer->SendMessage(0, target_id, ipc::commands::execute_client_cmd_long, command.c_str(), command.length() + 1);
-    }
-    else
-    {
-        peer->SendMessage(command.c_str(), target_id, ipc::commands::execute_client_cmd, 0, 0);
-    }
+    channel::SendCommand(target_id, command);
 });
 CatCommand exec_all("ipc_exec_all", "Execute command (on every peer)", [](const CCommand &args) {
     std::string command = args.ArgS();
     ReplaceString(command, " && ", " ; ");
-    if (command.length() >= 63)
+    channel::SendCommand(-1, command);
+});
+// Every push gets its own object so peers still reading the last one never see it change
+static std::string pushed_profile{};
+static unsigned push_count{ 0 };
+
+CatCommand push_profile("ipc_push_profile", "Load a profile on every peer at once, no argument pushes the current settings", [](const CCommand &args) {
+    if (!peer)
+        return;
+    std::string data;
+    if (args.ArgC() > 1)
     {
-        peer->SendMessage(0, -1, ipc::commands::execute_client_cmd_long, command.c_str(), command.length() + 1);
+        std::ifstream file(paths::getConfigPath() + "/" + args.Arg(1) + ".catp", std::ios::in | std::ios::binary);
+        if (!file)
+        {
+            logging::Info("No such profile, compile one with cat_save_profile");
+            return;
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
     }
     else
+        data = settings::profile::Compile();
+
+    std::string name = "/cathook-ipc-profile-" + std::to_string(getpid()) + "-" + std::to_string(push_count++);
+    int fd           = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, data.data(), data.size()) != ssize_t(data.size()))
     {
-        peer->SendMessage(command.c_str(), -1, ipc::commands::execute_client_cmd, 0, 0);
+        logging::Info("Couldn't create %s", name.c_str());
+        if (fd >= 0)
+            close(fd);
+        shm_unlink(name.c_str());
+        return;
     }
+    close(fd);
+    // Peers handle commands in order, nobody needs the previous push any more once this one arrives
+    if (!pushed_profile.empty())
+        shm_unlink(pushed_profile.c_str());
+    pushed_profile = name;
+    peer->SendMessage(0, -1, ipc::commands::load_profile, name.c_str(), name.length() + 1);
+    logging::Info("Pushed %u bytes of profile to all peers", data.size());
 });
 
+static void ShutdownProfile()
+{
+    if (!pushed_profile.empty())
+        shm_unlink(pushed_profile.c_str());
+    pushed_profile.clear();
+}
+
 peer_t *peer{ nullptr };
 
 CatCommand debug_get_ingame_ipc("ipc_debug_dump_server", "Show other bots on server", []() {
@@ -152,6 +234,32 @@ CatCommand debug_get_ingame_ipc("ipc_debug_dump_server", "Show other bots on ser
     logging::Info("%d other IPC players on server", count);
 });
 
+publish_scope::publish_scope(user_data_s &data) : data(data)
+{
+    memcpy(&before, &data, sizeof(before));
+}
+
+#define FIELD_CHANGED(fields, first, last) (memcmp((const char *) &before + offsetof(user_data_s, first), (const char *) &data + offsetof(user_data_s, first), offsetof(user_data_s, last) + sizeof(user_data_s::last) - offsetof(user_data_s, first)) ? (fields) : 0u)
+
+publish_scope::~publish_scope()
+{
+    unsigned changed = 0;
+    changed |= FIELD_CHANGED(UD_IDENTITY, name, textmode);
+    changed |= FIELD_CHANGED(UD_IDENTITY, ts_injected, ts_injected);
+    changed |= FIELD_CHANGED(UD_CONNECTION, connected, connected);
+    changed |= FIELD_CHANGED(UD_CONNECTION, ts_connected, ts_disconnected);
+    changed |= FIELD_CHANGED(UD_ACCUMULATED, accumulated, accumulated);
+    changed |= FIELD_CHANGED(UD_INGAME, ingame, ingame);
+    changed |= FIELD_CHANGED(UD_CLAIM, claim, claim);
+    if (!changed)
+        return;
+    data.changed = changed;
+    // Readers pair this with an acquire fence after reading the sequence
+    std::atomic_thread_fence(std::memory_order_release);
+    data.sequence++;
+}
+#undef FIELD_CHANGED
+
 void UpdateServerAddress(bool shutdown)
 {
     if (not peer)
@@ -163,7 +271,8 @@ void UpdateServerAddress(bool shutdown)
     }
 
     user_data_s &data = peer->memory->peer_user_data[peer->client_id];
-    data.friendid     = g_ISteamUser->GetSteamID().GetAccountID();
+    publish_scope publish(data);
+    data.friendid = g_ISteamUser->GetSteamID().GetAccountID();
     strncpy(data.ingame.server, s_addr, sizeof(data.ingame.server));
 }
 
@@ -173,12 +282,14 @@ void update_mapname()
         return;
 
     user_data_s &data = peer->memory->peer_user_data[peer->client_id];
+    publish_scope publish(data);
     strncpy(data.ingame.mapname, GetLevelName().c_str(), sizeof(data.ingame.mapname));
 }
 float framerate = 0.0f;
 void UpdateTemporaryData()
 {
     user_data_s &data = peer->memory->peer_user_data[peer->client_id];
+    publish_scope publish(data);
 
     data.connected = g_IEngine->IsInGame();
     // TODO kills, deaths
@@ -212,17 +323,7 @@ void UpdateTemporaryData()
             data.ingame.y = g_pLocalPlayer->v_Origin.y;
             data.ingame.z = g_pLocalPlayer->v_Origin.z;
 
-            int players = 0;
-
-            for (int i = 1; i <= g_GlobalVars->maxClients; ++i)
-            {
-                if (g_IEntityList->GetClientEntity(i))
-                    ++players;
-                else
-                    continue;
-            }
-
-            data.ingame.player_count = players;
+            data.ingame.player_count = entity_cache::players().size();
             hacks::shared::catbot::update_ipc_data(data);
         }
         else
@@ -230,7 +331,7 @@ void UpdateTemporaryData()
             data.ingame.good = false;
         }
         if (g_IEngine->GetLevelName())
-            update_mapname();
+            strncpy(data.ingame.mapname, GetLevelName().c_str(), sizeof(data.ingame.mapname));
     }
 }
 
@@ -241,9 +342,10 @@ void StoreClientData()
 
     UpdateServerAddress();
     user_data_s &data = peer->memory->peer_user_data[peer->client_id];
-    data.friendid     = g_ISteamUser->GetSteamID().GetAccountID();
-    data.ts_injected  = time_injected;
-    data.textmode     = ENABLE_TEXTMODE;
+    publish_scope publish(data);
+    data.friendid    = g_ISteamUser->GetSteamID().GetAccountID();
+    data.ts_injected = time_injected;
+    data.textmode    = ENABLE_TEXTMODE;
     if (g_ISteamUser)
     {
         strncpy(data.name, GetNamestealName(g_ISteamUser->GetSteamID()).c_str(), sizeof(data.name));
@@ -258,17 +360,113 @@ void Heartbeat()
 
 void UpdatePlayerlist()
 {
+    // Sequence of each peer when we last looked at it, peers that didn't publish anything since are skipped
+    static uint32_t seen_sequence[cat_ipc::max_peers]{};
+    static unsigned seen_friendid[cat_ipc::max_peers]{};
     if (peer && ipc_update_list)
     {
         for (unsigned i = 0; i < cat_ipc::max_peers; i++)
         {
-            if (!peer->memory->peer_data[i].free)
+            if (peer->memory->peer_data[i].free)
             {
-                playerlist::ChangeState(peer->memory->peer_user_data[i].friendid, peer->memory->peer_user_data[i].textmode ? playerlist::k_EState::TEXTMODE : playerlist::k_EState::IPC);
+                seen_friendid[i] = 0;
+                continue;
             }
+            user_data_s &data = peer->memory->peer_user_data[i];
+            uint32_t sequence = data.sequence;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence == seen_sequence[i] && data.friendid == seen_friendid[i])
+                continue;
+            seen_sequence[i] = sequence;
+            seen_friendid[i] = data.friendid;
+            playerlist::ChangeState(data.friendid, data.textmode ? playerlist::k_EState::TEXTMODE : playerlist::k_EState::IPC);
+        }
+    }
+}
+
+namespace claims
+{
+// Claims that weren't refreshed for this long are from bots that stopped caring
+constexpr time_t CLAIM_TIME = 10;
+
+void Set(claim_type type, const Vector &location)
+{
+    if (!peer)
+        return;
+    publish_scope publish(peer->memory->peer_user_data[peer->client_id]);
+    auto &claim     = peer->memory->peer_user_data[peer->client_id].claim;
+    claim.type      = type;
+    claim.x         = location.x;
+    claim.y         = location.y;
+    claim.z         = location.z;
+    claim.refreshed = time(nullptr);
+}
+
+void Refresh()
+{
+    if (!peer)
+        return;
+    publish_scope publish(peer->memory->peer_user_data[peer->client_id]);
+    peer->memory->peer_user_data[peer->client_id].claim.refreshed = time(nullptr);
+}
+
+void Clear()
+{
+    if (!peer)
+        return;
+    publish_scope publish(peer->memory->peer_user_data[peer->client_id]);
+    peer->memory->peer_user_data[peer->client_id].claim.type = none;
+}
+
+bool ClaimedByOthers(claim_type type, const Vector &location, float radius)
+{
+    if (!peer)
+        return false;
+    user_data_s &own = peer->memory->peer_user_data[peer->client_id];
+    time_t now       = time(nullptr);
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        if (i == peer->client_id || peer->memory->peer_data[i].free)
+            continue;
+        user_data_s &data = peer->memory->peer_user_data[i];
+        if (data.claim.type != type || now - data.claim.refreshed > CLAIM_TIME)
+            continue;
+        if (!data.connected || data.ingame.team != own.ingame.team || strncmp(data.ingame.server, own.ingame.server, sizeof(own.ingame.server)))
+            continue;
+        if (location.DistTo(Vector(data.claim.x, data.claim.y, data.claim.z)) < radius)
+            return true;
+    }
+    return false;
+}
+} // namespace claims
+
+// Runs every 10 seconds
+static void PaintStoreClientData()
+{
+    if (peer)
+        StoreClientData();
+}
+
+// Runs every second
+static void PaintUpdate()
+{
+    if (peer)
+    {
+        if (peer->HasCommands())
+        {
+            peer->ProcessCommands();
         }
+        Heartbeat();
+        UpdateTemporaryData();
     }
 }
+
+static InitRoutine init_rates([]() {
+    EC::Register(EC::Paint, PaintStoreClientData, "paint_ipc_clientdata", EC::every_ms(10000));
+    EC::Register(EC::Paint, PaintUpdate, "paint_ipc_update", EC::every_ms(1000));
+    EC::Register(EC::CreateMove, UpdatePlayerlist, "cm_ipc_playerlist", EC::every_ms(10000));
+    EC::Register(EC::Shutdown, ShutdownProfile, "shutdown_ipc_profile", EC::average);
+});
 } // namespace ipc
 
 #endif
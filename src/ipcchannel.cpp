@@ -0,0 +1,268 @@
+#include "common.hpp"
+
+#if ENABLE_IPC
+
+#include "ipcchannel.hpp"
+#include "hack.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <thread>
+
+namespace ipc::channel
+{
+static segment_s *segment = nullptr;
+static std::unordered_map<uint16_t, handler_t> handlers{};
+
+static int64_t Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void batch_s::add(uint16_t type, const void *data, size_t size)
+{
+    if (size > MESSAGE_SIZE)
+    {
+        logging::Info("IPC channel: dropping %u byte message", size);
+        return;
+    }
+    messages.emplace_back();
+    auto &message = messages.back();
+    message.type  = type;
+    message.size  = size;
+    memcpy(message.data, data, size);
+}
+
+void SetHandler(uint16_t type, handler_t handler)
+{
+    handlers[type] = std::move(handler);
+}
+
+// Copies the next complete message out of our inbox, false once it's empty
+static bool Pop(inbox_s &inbox, message_s &out)
+{
+    slot_s &slot = inbox.slots[inbox.head & (RING_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != inbox.head + 1)
+        return false;
+    memcpy(&out, &slot.message, offsetof(message_s, data) + std::min<uint32_t>(slot.message.size, MESSAGE_SIZE));
+    // Frees the slot for the sender that wraps around to it next
+    slot.sequence.store(inbox.head + RING_SIZE, std::memory_order_release);
+    inbox.head++;
+    return true;
+}
+
+static bool Push(inbox_s &inbox, const message_s &message)
+{
+    uint32_t position = inbox.tail.load(std::memory_order_relaxed);
+    slot_s *slot;
+    while (true)
+    {
+        slot              = &inbox.slots[position & (RING_SIZE - 1)];
+        uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int32_t diff      = int32_t(sequence - position);
+        if (diff == 0)
+        {
+            if (inbox.tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        // The owner hasn't drained the slot from the last lap yet, inbox is full
+        else if (diff < 0)
+        {
+            inbox.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+            position = inbox.tail.load(std::memory_order_relaxed);
+    }
+    memcpy(&slot->message, &message, offsetof(message_s, data) + message.size);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    inbox.sent.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Connect(const std::string &server)
+{
+    Disconnect();
+    std::string name = "/cathook-channel-" + server;
+    int fd           = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0 || ftruncate(fd, sizeof(segment_s)) < 0)
+    {
+        logging::Info("IPC channel: couldn't create %s", name.c_str());
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, sizeof(segment_s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        logging::Info("IPC channel: couldn't map %s", name.c_str());
+        return false;
+    }
+    auto *shared = (segment_s *) mapping;
+
+    // Whoever maps the fresh segment first sets up the rings, everyone else waits for that
+    uint32_t state = 0;
+    if (shared->state.compare_exchange_strong(state, 1))
+    {
+        shared->magic   = MAGIC;
+        shared->version = VERSION;
+        for (auto &inbox : shared->inboxes)
+        {
+            inbox.owner.store(0, std::memory_order_relaxed);
+            inbox.tail.store(0, std::memory_order_relaxed);
+            inbox.head = 0;
+            for (uint32_t i = 0; i < RING_SIZE; i++)
+                inbox.slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        shared->state.store(2, std::memory_order_release);
+    }
+    else
+    {
+        for (int i = 0; i < 1000 && shared->state.load(std::memory_order_acquire) != 2; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (shared->state.load(std::memory_order_acquire) != 2 || shared->magic != MAGIC || shared->version != VERSION)
+    {
+        logging::Info("IPC channel: %s is from another version", name.c_str());
+        munmap(mapping, sizeof(segment_s));
+        return false;
+    }
+
+    segment        = shared;
+    inbox_s &inbox = segment->inboxes[peer->client_id];
+    // Whatever is left was meant for the last peer with our id
+    message_s discard;
+    while (Pop(inbox, discard))
+        ;
+    inbox.owner.store(getpid(), std::memory_order_release);
+    return true;
+}
+
+void Disconnect()
+{
+    if (!segment)
+        return;
+    if (peer)
+        segment->inboxes[peer->client_id].owner.store(0, std::memory_order_release);
+    munmap(segment, sizeof(segment_s));
+    segment = nullptr;
+}
+
+// Calls f for every inbox the message should go to, fallback for peers that can't be reached through the channel
+template <typename F, typename G> static void ForTargets(int target, F f, G fallback)
+{
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        if (target >= 0 ? i != unsigned(target) : i == peer->client_id)
+            continue;
+        if (peer->memory->peer_data[i].free)
+            continue;
+        if (segment && segment->inboxes[i].owner.load(std::memory_order_acquire))
+            f(i, segment->inboxes[i]);
+        else
+            fallback(i);
+    }
+}
+
+bool Send(int target, const batch_s &batch)
+{
+    if (!peer || batch.messages.empty())
+        return false;
+    bool success  = true;
+    auto messages = batch.messages;
+    int64_t now   = Now();
+    for (auto &message : messages)
+    {
+        message.sender  = peer->client_id;
+        message.sent_ns = now;
+    }
+    ForTargets(
+        target,
+        [&](unsigned, inbox_s &inbox) {
+            for (auto &message : messages)
+                success &= Push(inbox, message);
+        },
+        [&](unsigned) { success = false; });
+    return success;
+}
+
+bool Send(int target, uint16_t type, const void *data, size_t size)
+{
+    batch_s batch;
+    batch.add(type, data, size);
+    return !batch.messages.empty() && Send(target, batch);
+}
+
+void SendCommand(int target, const std::string &command)
+{
+    if (!peer)
+        return;
+    auto simple_ipc = [&command](unsigned id) {
+        if (command.length() >= 63)
+            peer->SendMessage(0, id, ipc::commands::execute_client_cmd_long, command.c_str(), command.length() + 1);
+        else
+            peer->SendMessage(command.c_str(), id, ipc::commands::execute_client_cmd, 0, 0);
+    };
+    message_s message;
+    bool fits = command.length() < MESSAGE_SIZE;
+    if (fits)
+    {
+        message.type    = ipc::commands::execute_client_cmd;
+        message.size    = command.length() + 1;
+        message.sender  = peer->client_id;
+        message.sent_ns = Now();
+        memcpy(message.data, command.c_str(), command.length() + 1);
+    }
+    ForTargets(
+        target,
+        [&](unsigned id, inbox_s &inbox) {
+            if (!fits || !Push(inbox, message))
+                simple_ipc(id);
+        },
+        simple_ipc);
+}
+
+static void Process()
+{
+    if (!segment || !peer)
+        return;
+    inbox_s &inbox = segment->inboxes[peer->client_id];
+    message_s message;
+    // Bounded so a flood of messages can't stall the frame
+    for (uint32_t i = 0; i < RING_SIZE && Pop(inbox, message); i++)
+    {
+        int64_t latency = Now() - message.sent_ns;
+        int64_t average = inbox.latency_ns.load(std::memory_order_relaxed);
+        inbox.latency_ns.store(average ? (average * 7 + latency) / 8 : latency, std::memory_order_relaxed);
+        inbox.delivered.fetch_add(1, std::memory_order_relaxed);
+        auto handler = handlers.find(message.type);
+        if (handler != handlers.end())
+            handler->second(message);
+    }
+}
+
+static CatCommand stats("ipc_channel_stats", "Show IPC channel counters for every peer", []() {
+    if (!segment || !peer)
+    {
+        logging::Info("IPC channel not connected");
+        return;
+    }
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        if (peer->memory->peer_data[i].free)
+            continue;
+        inbox_s &inbox = segment->inboxes[i];
+        logging::Info("%u%s: sent %llu, delivered %llu, dropped %llu, latency %lldus", i, inbox.owner.load() ? "" : " (no channel)", (unsigned long long) inbox.sent.load(), (unsigned long long) inbox.delivered.load(), (unsigned long long) inbox.dropped.load(), (long long) inbox.latency_ns.load() / 1000);
+    }
+});
+
+static InitRoutine init([]() {
+    EC::Register(EC::Paint, Process, "paint_ipc_channel", EC::average);
+    EC::Register(EC::Shutdown, Disconnect, "shutdown_ipc_channel", EC::average);
+});
+} // namespace ipc::channel
+
+#endif
@@ -0,0 +1,170 @@
+#include "common.hpp"
+
+#if ENABLE_IPC
+
+#include "ipcplayerlist.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <thread>
+
+namespace ipc::shared_playerlist
+{
+static settings::Boolean enable{ "ipc.shared-playerlist", "false" };
+
+static segment_s *segment = nullptr;
+// Segment revision at the last look and the slot revisions applied locally
+static uint32_t applied = 0;
+static uint32_t seen[CAPACITY]{};
+// Set while remote states get applied, they must not be published again
+static bool applying = false;
+
+bool Connect(const std::string &server)
+{
+    Disconnect();
+    if (!enable)
+        return false;
+    std::string name = "/cathook-playerlist-" + server;
+    int fd           = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0 || ftruncate(fd, sizeof(segment_s)) < 0)
+    {
+        logging::Info("IPC playerlist: couldn't create %s", name.c_str());
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, sizeof(segment_s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        logging::Info("IPC playerlist: couldn't map %s", name.c_str());
+        return false;
+    }
+    auto *shared = (segment_s *) mapping;
+
+    // A fresh segment is all zeroes, which already is an empty table
+    uint32_t state = 0;
+    if (shared->state.compare_exchange_strong(state, 1))
+    {
+        shared->magic   = MAGIC;
+        shared->version = VERSION;
+        shared->state.store(2, std::memory_order_release);
+    }
+    else
+    {
+        for (int i = 0; i < 1000 && shared->state.load(std::memory_order_acquire) != 2; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (shared->state.load(std::memory_order_acquire) != 2 || shared->magic != MAGIC || shared->version != VERSION)
+    {
+        logging::Info("IPC playerlist: %s is from another version", name.c_str());
+        munmap(mapping, sizeof(segment_s));
+        return false;
+    }
+    segment = shared;
+    // Everything other peers wrote before we came gets applied on the next tick
+    applied = segment->revision.load() - 1;
+    memset(seen, 0, sizeof(seen));
+
+    // Share what we already know, later changes are published as they happen
+    for (auto &entry : playerlist::data)
+        if (entry.first && entry.second.state != playerlist::k_EState::DEFAULT)
+            Publish(entry.first, int(entry.second.state));
+    return true;
+}
+
+void Disconnect()
+{
+    if (!segment)
+        return;
+    munmap(segment, sizeof(segment_s));
+    segment = nullptr;
+}
+
+// Slot of steamid, claimed if create is set. nullptr if it isn't there or the table is full
+static slot_s *Find(uint32_t steamid, bool create)
+{
+    uint32_t mask = CAPACITY - 1;
+    for (uint32_t i = 0, at = (steamid * 2654435761u) & mask; i < CAPACITY; i++, at = (at + 1) & mask)
+    {
+        slot_s &slot  = segment->slots[at];
+        uint32_t seen = slot.steamid.load(std::memory_order_acquire);
+        if (seen == steamid)
+            return &slot;
+        if (seen)
+            continue;
+        if (!create)
+            return nullptr;
+        if (slot.steamid.compare_exchange_strong(seen, steamid, std::memory_order_acq_rel) || seen == steamid)
+            return &slot;
+    }
+    return nullptr;
+}
+
+void Publish(unsigned steamid, int state)
+{
+    if (!segment || applying || !steamid)
+        return;
+    slot_s *slot = Find(steamid, true);
+    if (!slot)
+    {
+        logging::Info("IPC playerlist: table is full");
+        return;
+    }
+    slot->state.store(state, std::memory_order_relaxed);
+    slot->revision.fetch_add(1, std::memory_order_release);
+    // Only after the slot, whoever sees the new segment revision also sees the slot
+    segment->revision.fetch_add(1, std::memory_order_acq_rel);
+}
+
+static void Apply()
+{
+    if (!segment)
+        return;
+    uint32_t revision = segment->revision.load(std::memory_order_acquire);
+    if (revision == applied)
+        return;
+    applied  = revision;
+    applying = true;
+    for (uint32_t i = 0; i < CAPACITY; i++)
+    {
+        slot_s &slot     = segment->slots[i];
+        uint32_t steamid = slot.steamid.load(std::memory_order_acquire);
+        uint32_t written = slot.revision.load(std::memory_order_acquire);
+        if (!steamid || written == seen[i])
+            continue;
+        seen[i]    = written;
+        auto state = playerlist::k_EState(slot.state.load(std::memory_order_relaxed));
+        if (state > playerlist::k_EState::STATE_LAST)
+            continue;
+        playerlist::ChangeState(steamid, state, true);
+    }
+    applying = false;
+}
+
+static CatCommand print("ipc_playerlist", "Show the shared playerlist", []() {
+    if (!segment)
+    {
+        logging::Info("IPC playerlist not connected");
+        return;
+    }
+    unsigned used = 0;
+    for (auto &slot : segment->slots)
+    {
+        uint32_t steamid = slot.steamid.load();
+        if (!steamid)
+            continue;
+        used++;
+        uint32_t state = slot.state.load();
+        logging::Info("[U:1:%u] %s", steamid, state <= uint32_t(playerlist::k_EState::STATE_LAST) ? playerlist::k_pszNames[state] : "?");
+    }
+    logging::Info("%u of %u slots used, revision %u", used, CAPACITY, segment->revision.load());
+});
+
+static InitRoutine init([]() {
+    EC::Register(EC::Paint, Apply, "ipc_shared_playerlist", EC::early);
+    EC::Register(EC::Shutdown, Disconnect, "shutdown_ipc_shared_playerlist", EC::average);
+});
+} // namespace ipc::shared_playerlist
+
+#endif
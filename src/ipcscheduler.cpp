@@ -0,0 +1,336 @@
+#include "common.hpp"
+
+#if ENABLE_IPC
+
+#include "ipcscheduler.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <mutex>
+#include <thread>
+
+namespace ipc::scheduler
+{
+static settings::Int bot_chunks{ "ipc.bot-chunks", "1" };
+// 0 for no limit
+static settings::Int concurrent_loads{ "ipc.scheduler.concurrent-loads", "2" };
+static settings::Int concurrent_compiles{ "ipc.scheduler.concurrent-nav-compiles", "1" };
+// Connect to the least crowded server other peers are on whenever we aren't in game. Only works for servers that accept direct connects
+static settings::Boolean join_peers{ "ipc.scheduler.join-peers", "false" };
+static settings::Int bots_per_server{ "ipc.scheduler.bots-per-server", "0" };
+static settings::Int server_slots{ "ipc.scheduler.server-slots", "24" };
+
+// The job pool takes leases too, Disconnect must not unmap while it does
+static std::mutex segment_lock;
+static segment_s *segment = nullptr;
+static uint64_t held[OPERATION_COUNT]{};
+
+static int64_t NowMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool Live(unsigned id)
+{
+    return !peer->memory->peer_data[id].free && segment->peers[id].owner.load(std::memory_order_acquire);
+}
+
+// Live peers in each chunk, leaving out skip
+static std::vector<int> ChunkSizes(int chunks, unsigned skip)
+{
+    std::vector<int> sizes(chunks, 0);
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        if (i == skip || !Live(i))
+            continue;
+        int chunk = segment->peers[i].chunk.load(std::memory_order_relaxed);
+        if (chunk >= 0 && chunk < chunks)
+            sizes[chunk]++;
+    }
+    return sizes;
+}
+
+static void ExecChunk(int chunk)
+{
+    hack::command_stack().push("exec cat_autoexec_ipc_" + std::to_string(chunk));
+}
+
+bool Connect(const std::string &server)
+{
+    Disconnect();
+    std::string name = "/cathook-scheduler-" + server;
+    int fd           = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0 || ftruncate(fd, sizeof(segment_s)) < 0)
+    {
+        logging::Info("IPC scheduler: couldn't create %s", name.c_str());
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, sizeof(segment_s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        logging::Info("IPC scheduler: couldn't map %s", name.c_str());
+        return false;
+    }
+    auto *shared = (segment_s *) mapping;
+
+    // A fresh segment is all zeroes, no chunks assigned and every lease free
+    uint32_t state = 0;
+    if (shared->state.compare_exchange_strong(state, 1))
+    {
+        shared->magic   = MAGIC;
+        shared->version = VERSION;
+        shared->state.store(2, std::memory_order_release);
+    }
+    else
+    {
+        for (int i = 0; i < 1000 && shared->state.load(std::memory_order_acquire) != 2; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (shared->state.load(std::memory_order_acquire) != 2 || shared->magic != MAGIC || shared->version != VERSION)
+    {
+        logging::Info("IPC scheduler: %s is from another version", name.c_str());
+        munmap(mapping, sizeof(segment_s));
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(segment_lock);
+    segment    = shared;
+    peer_s &me = segment->peers[peer->client_id];
+    // Join the smallest chunk, ties go to the lowest one
+    int chunks             = std::max(1, *bot_chunks);
+    std::vector<int> sizes = ChunkSizes(chunks, peer->client_id);
+    me.chunk.store(std::min_element(sizes.begin(), sizes.end()) - sizes.begin(), std::memory_order_relaxed);
+    me.target_until_ms.store(0, std::memory_order_relaxed);
+    me.owner.store(getpid(), std::memory_order_release);
+    return true;
+}
+
+void Disconnect()
+{
+    for (int op = 0; op < OPERATION_COUNT; op++)
+        End(operation(op));
+    std::lock_guard<std::mutex> lock(segment_lock);
+    if (!segment)
+        return;
+    if (peer)
+        segment->peers[peer->client_id].owner.store(0, std::memory_order_release);
+    munmap(segment, sizeof(segment_s));
+    segment = nullptr;
+}
+
+int Chunk()
+{
+    int chunks = std::max(1, *bot_chunks);
+    if (!segment || !peer)
+        return peer ? peer->client_id % chunks : 0;
+    return segment->peers[peer->client_id].chunk.load(std::memory_order_relaxed) % chunks;
+}
+
+static int Limit(operation op)
+{
+    int limit = op == level_load ? *concurrent_loads : *concurrent_compiles;
+    return limit <= 0 ? 0 : std::min<int>(limit, MAX_LEASES);
+}
+
+static bool TryBeginLocked(operation op, unsigned hold_ms)
+{
+    int limit = Limit(op);
+    if (!segment || !peer || !limit)
+        return true;
+    int64_t now   = NowMs();
+    uint64_t mine = (uint64_t(now + hold_ms) << 16) | (peer->client_id + 1);
+    for (int i = 0; i < limit; i++)
+    {
+        auto &lease   = segment->leases[op][i];
+        uint64_t seen = lease.load(std::memory_order_acquire);
+        // Ours already, extend it
+        bool ours = held[op] && seen == held[op];
+        if (seen && !ours && int64_t(seen >> 16) > now)
+            continue;
+        if (lease.compare_exchange_strong(seen, mine, std::memory_order_acq_rel))
+        {
+            held[op] = mine;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TryBegin(operation op, unsigned hold_ms)
+{
+    std::lock_guard<std::mutex> lock(segment_lock);
+    return TryBeginLocked(op, hold_ms);
+}
+
+void Begin(operation op, unsigned hold_ms, unsigned timeout_ms)
+{
+    for (unsigned waited = 0; waited < timeout_ms; waited += 100)
+    {
+        if (TryBegin(op, hold_ms))
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    logging::Info("IPC scheduler: waited %ums for operation %d, going ahead anyway", timeout_ms, op);
+}
+
+void End(operation op)
+{
+    std::lock_guard<std::mutex> lock(segment_lock);
+    if (!held[op])
+        return;
+    if (segment)
+        for (auto &lease : segment->leases[op])
+        {
+            uint64_t expected = held[op];
+            if (lease.compare_exchange_strong(expected, 0, std::memory_order_acq_rel))
+                break;
+        }
+    held[op] = 0;
+}
+
+// The biggest chunk hands its highest peer to the smallest one whenever they differ by more than one
+static void Rebalance()
+{
+    int chunks     = std::max(1, *bot_chunks);
+    peer_s &me     = segment->peers[peer->client_id];
+    int chunk      = me.chunk.load(std::memory_order_relaxed);
+    bool misplaced = chunk < 0 || chunk >= chunks;
+    if (!misplaced)
+    {
+        for (unsigned i = peer->client_id + 1; i < cat_ipc::max_peers; i++)
+            if (Live(i) && segment->peers[i].chunk.load(std::memory_order_relaxed) == chunk)
+                return;
+    }
+    std::vector<int> sizes = ChunkSizes(chunks, peer->client_id);
+    int smallest           = std::min_element(sizes.begin(), sizes.end()) - sizes.begin();
+    if (!misplaced && sizes[chunk] <= sizes[smallest])
+        return;
+    logging::Info("IPC scheduler: moving from chunk %d to %d", chunk, smallest);
+    me.chunk.store(smallest, std::memory_order_relaxed);
+    ExecChunk(smallest);
+}
+
+struct server_load
+{
+    std::string address;
+    int bots{ 0 };
+    int players{ 0 };
+};
+
+// Servers our peers play on or are connecting to, by how many of our bots are there
+static std::vector<server_load> ServerLoads()
+{
+    std::vector<server_load> servers;
+    auto count = [&](const char *address, int size, int players) {
+        std::string name(address, strnlen(address, size));
+        if (name.empty() || name == "0.0.0.0" || name == "loopback")
+            return;
+        auto found = std::find_if(servers.begin(), servers.end(), [&](const server_load &load) { return load.address == name; });
+        if (found == servers.end())
+        {
+            servers.push_back(server_load{ name });
+            found = servers.end() - 1;
+        }
+        found->bots++;
+        found->players = std::max(found->players, players);
+    };
+    int64_t now = NowMs();
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        if (i == peer->client_id || !Live(i))
+            continue;
+        auto &data = peer->memory->peer_user_data[i];
+        auto &plan = segment->peers[i];
+        if (data.connected && data.ingame.good)
+            count(data.ingame.server, sizeof(data.ingame.server), data.ingame.player_count);
+        else if (plan.target_until_ms.load(std::memory_order_acquire) > now)
+            count(plan.target, sizeof(plan.target), 0);
+    }
+    // Bots from other hosts only show up in bot_count
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        if (i == peer->client_id || !Live(i))
+            continue;
+        auto &data = peer->memory->peer_user_data[i];
+        if (!data.connected || !data.ingame.good)
+            continue;
+        std::string name(data.ingame.server, strnlen(data.ingame.server, sizeof(data.ingame.server)));
+        for (auto &load : servers)
+            if (load.address == name)
+                load.bots = std::max(load.bots, data.ingame.bot_count);
+    }
+    return servers;
+}
+
+static void JoinPeers()
+{
+    if (g_IEngine->IsInGame() || g_IEngine->IsConnected())
+        return;
+    auto servers            = ServerLoads();
+    const server_load *best = nullptr;
+    for (auto &load : servers)
+    {
+        if (load.players >= *server_slots || (*bots_per_server > 0 && load.bots >= *bots_per_server))
+            continue;
+        if (!best || load.bots < best->bots || (load.bots == best->bots && load.players > best->players))
+            best = &load;
+    }
+    if (!best || !TryBeginLocked(level_load, 30000))
+        return;
+    peer_s &me = segment->peers[peer->client_id];
+    me.target_until_ms.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    strncpy(me.target, best->address.c_str(), sizeof(me.target));
+    me.target_until_ms.store(NowMs() + 30000, std::memory_order_release);
+    logging::Info("IPC scheduler: joining %s, %d of our bots and %d players there", best->address.c_str(), best->bots, best->players);
+    g_IEngine->ClientCmd_Unrestricted(("connect " + best->address).c_str());
+}
+
+static void Update()
+{
+    std::lock_guard<std::mutex> lock(segment_lock);
+    if (!segment || !peer)
+        return;
+    Rebalance();
+    if (join_peers)
+        JoinPeers();
+}
+
+static CatCommand print("ipc_scheduler", "Show chunks and leases of every peer", []() {
+    std::lock_guard<std::mutex> lock(segment_lock);
+    if (!segment || !peer)
+    {
+        logging::Info("IPC scheduler not connected");
+        return;
+    }
+    int64_t now = NowMs();
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        if (!Live(i))
+            continue;
+        std::string leases;
+        for (int op = 0; op < OPERATION_COUNT; op++)
+            for (auto &lease : segment->leases[op])
+            {
+                uint64_t value = lease.load();
+                if ((value & 0xFFFF) == i + 1 && int64_t(value >> 16) > now)
+                    leases += format(" ", op == level_load ? "level_load" : "nav_compile", " (", (int64_t(value >> 16) - now) / 1000, "s)");
+            }
+        logging::Info("%u: chunk %d%s", i, segment->peers[i].chunk.load(), leases.c_str());
+    }
+});
+
+static InitRoutine init([]() {
+    EC::Register(EC::Paint, Update, "ipc_scheduler", EC::every_ms(2000));
+    // Loaded in, whoever waits for a level_load lease can go
+    EC::Register(EC::FirstCM, []() { End(level_load); }, "firstcm_ipc_scheduler");
+    EC::Register(EC::Shutdown, Disconnect, "shutdown_ipc_scheduler", EC::average);
+});
+} // namespace ipc::scheduler
+
+#endif
@@ -0,0 +1,266 @@
+#include "common.hpp"
+
+#if ENABLE_IPC
+
+#include "ipctelemetry.hpp"
+#include "navparser.hpp"
+#include "governor.hpp"
+#if ENABLE_VISUALS
+#include "visual/frametiming.hpp"
+#endif
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <thread>
+
+namespace ipc::telemetry
+{
+static settings::Boolean enable{ "ipc.telemetry.enable", "true" };
+static settings::Int interval{ "ipc.telemetry.interval-ms", "1000" };
+
+static segment_s *segment = nullptr;
+static Timer publish_timer{};
+
+// Collected on the game thread between two samples
+static ProfilerHistogram tick_times{};
+static uint64_t tick_start    = 0;
+static uint64_t tick_max_ns   = 0;
+static uint32_t ticks         = 0;
+static uint32_t tick_rays     = 0;
+static uint32_t traces_max    = 0;
+static uint8_t quality_max    = 0;
+static int64_t last_sample_ns = 0;
+// Totals at the last sample, the samples only hold the difference
+static uint64_t last_solves   = 0;
+static uint64_t last_solve_ns = 0;
+static uint64_t last_repaths  = 0;
+static uint32_t last_rays     = 0;
+static hitrate::metrics_s last_hitrate{};
+
+static int64_t Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+#if defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 33)
+#define HAVE_MALLINFO2 1
+#endif
+#endif
+
+// Straight from malloc's own bookkeeping, /proc would cost us a few syscalls every sample
+static uint64_t HeapBytes()
+{
+#if HAVE_MALLINFO2
+    struct mallinfo2 info = mallinfo2();
+    return uint64_t(info.uordblks) + uint64_t(info.hblkhd);
+#else
+    // Wraps at 4GB, still good enough to spot a leak
+    struct mallinfo info = mallinfo();
+    return uint64_t(unsigned(info.uordblks)) + uint64_t(unsigned(info.hblkhd));
+#endif
+}
+
+bool Connect(const std::string &server)
+{
+    Disconnect();
+    std::string name = SegmentName(server);
+    int fd           = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0 || ftruncate(fd, sizeof(segment_s)) < 0)
+    {
+        logging::Info("IPC telemetry: couldn't create %s", name.c_str());
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+    void *mapping = mmap(nullptr, sizeof(segment_s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        logging::Info("IPC telemetry: couldn't map %s", name.c_str());
+        return false;
+    }
+    auto *shared = (segment_s *) mapping;
+
+    // A fresh segment is all zeroes, which already is a valid empty ring for every peer
+    uint32_t state = 0;
+    if (shared->state.compare_exchange_strong(state, 1))
+    {
+        shared->magic   = MAGIC;
+        shared->version = VERSION;
+        shared->state.store(2, std::memory_order_release);
+    }
+    else
+    {
+        for (int i = 0; i < 1000 && shared->state.load(std::memory_order_acquire) != 2; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (shared->state.load(std::memory_order_acquire) != 2 || shared->magic != MAGIC || shared->version != VERSION)
+    {
+        logging::Info("IPC telemetry: %s is from another version", name.c_str());
+        munmap(mapping, sizeof(segment_s));
+        return false;
+    }
+
+    segment = shared;
+    // Samples keep counting up from the last peer with our id, so a collector can tell them apart by owner alone
+    segment->rings[peer->client_id].owner.store(getpid(), std::memory_order_release);
+    last_sample_ns = Now();
+    publish_timer.update();
+    return true;
+}
+
+void Disconnect()
+{
+    if (!segment)
+        return;
+    if (peer)
+        segment->rings[peer->client_id].owner.store(0, std::memory_order_release);
+    munmap(segment, sizeof(segment_s));
+    segment = nullptr;
+}
+
+static void TickStart()
+{
+    tick_start = profiler::Now();
+}
+
+static void TickEnd()
+{
+    // CreateMove bailed out before the normal events this tick
+    if (!tick_start)
+        return;
+    uint64_t ns = uint64_t((profiler::Now() - tick_start) * profiler::NsPerTick());
+    tick_start  = 0;
+    tick_times.Record(ns);
+    tick_max_ns = std::max(tick_max_ns, ns);
+    ticks++;
+
+    uint32_t rays = trace::rays.load(std::memory_order_relaxed);
+    traces_max    = std::max(traces_max, rays - tick_rays);
+    tick_rays     = rays;
+    quality_max   = std::max(quality_max, governor::Level());
+}
+
+template <size_t N> static void Difference(std::atomic<uint32_t> (&now)[hitrate::WEAPON_CLASSES][N], std::atomic<uint32_t> (&last)[hitrate::WEAPON_CLASSES][N], uint16_t (&out)[hitrate::WEAPON_CLASSES][N])
+{
+    for (int weapon = 0; weapon < hitrate::WEAPON_CLASSES; weapon++)
+        for (size_t i = 0; i < N; i++)
+        {
+            uint32_t value    = now[weapon][i].load(std::memory_order_relaxed);
+            uint32_t previous = last[weapon][i].load(std::memory_order_relaxed);
+            // debug_hitrate_clear ran since the last sample
+            uint32_t since = value >= previous ? value - previous : value;
+            out[weapon][i] = std::min<uint32_t>(since, UINT16_MAX);
+            last[weapon][i].store(value, std::memory_order_relaxed);
+        }
+}
+
+static void Publish()
+{
+    if (!segment || !peer || !enable || !publish_timer.test_and_set(std::max(*interval, 100)))
+        return;
+    int64_t now     = Now();
+    uint64_t solves = nav::stats.solves.load(std::memory_order_relaxed);
+    uint64_t solve  = nav::stats.solve_ns.load(std::memory_order_relaxed);
+    uint64_t repath = nav::stats.repaths.load(std::memory_order_relaxed);
+    uint32_t rays   = trace::rays.load(std::memory_order_relaxed);
+
+    sample_s sample;
+    sample.time_ns         = now;
+    sample.interval_ms     = uint32_t((now - last_sample_ns) / 1000000);
+    sample.ticks           = ticks;
+    sample.tick_p50_us     = ticks ? tick_times.Percentile(0.5f) / 1000 : 0;
+    sample.tick_p90_us     = ticks ? tick_times.Percentile(0.9f) / 1000 : 0;
+    sample.tick_p99_us     = ticks ? tick_times.Percentile(0.99f) / 1000 : 0;
+    sample.tick_max_us     = tick_max_ns / 1000;
+    sample.players         = entity_cache::players().size();
+    sample.entities        = std::max(entity_cache::max, 0);
+    sample.projectiles     = entity_cache::projectiles().size();
+    sample.buildings       = entity_cache::buildings().size();
+    sample.path_solves     = solves - last_solves;
+    sample.path_solve_us   = (solve - last_solve_ns) / 1000;
+    sample.repaths         = repath - last_repaths;
+    sample.traces          = rays - last_rays;
+    sample.traces_max_tick = traces_max;
+    sample.heap_bytes      = HeapBytes();
+    memtrack::Update();
+    for (int i = 0; i < memtrack::TAG_COUNT; i++)
+        sample.memory_kb[i] = uint32_t(std::max<int64_t>(memtrack::stats[i].Live(), 0) / 1024);
+    sample.ingame          = g_IEngine->IsInGame();
+    sample.quality_level   = governor::Level();
+    sample.quality_max     = std::max(quality_max, sample.quality_level);
+    Difference(hitrate::metrics.shots, last_hitrate.shots, sample.shots);
+    Difference(hitrate::metrics.hits, last_hitrate.hits, sample.hits);
+    Difference(hitrate::metrics.headshots, last_hitrate.headshots, sample.headshots);
+    Difference(hitrate::metrics.time_to_hit, last_hitrate.time_to_hit, sample.time_to_hit);
+#if ENABLE_VISUALS
+    frame_timing::summary_s frame_times;
+    frame_timing::Collect(frame_times);
+    static_assert(frame_timing::STAGE_COUNT == sizeof(sample.frame_p50_us) / sizeof(uint32_t), "telemetry stages are out of date");
+    sample.frames             = frame_times.frames;
+    sample.frames_over_budget = frame_times.over_budget;
+    for (int i = 0; i < frame_timing::STAGE_COUNT; i++)
+    {
+        sample.frame_p50_us[i] = frame_times.p50_us[i];
+        sample.frame_p99_us[i] = frame_times.p99_us[i];
+    }
+#else
+    sample.frames             = 0;
+    sample.frames_over_budget = 0;
+    memset(sample.frame_p50_us, 0, sizeof(sample.frame_p50_us));
+    memset(sample.frame_p99_us, 0, sizeof(sample.frame_p99_us));
+#endif
+
+    ring_s &ring      = segment->rings[peer->client_id];
+    uint64_t index    = ring.written.load(std::memory_order_relaxed);
+    record_s &record  = ring.records[index & (RING_SIZE - 1)];
+    uint32_t sequence = record.sequence.load(std::memory_order_relaxed);
+    record.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.index  = index;
+    record.sample = sample;
+    record.sequence.store(sequence + 2, std::memory_order_release);
+    ring.written.store(index + 1, std::memory_order_release);
+
+    tick_times.Reset();
+    tick_max_ns    = 0;
+    ticks          = 0;
+    traces_max     = 0;
+    quality_max    = 0;
+    last_sample_ns = now;
+    last_solves    = solves;
+    last_solve_ns  = solve;
+    last_repaths   = repath;
+    last_rays      = rays;
+}
+
+static CatCommand print("ipc_telemetry", "Show the newest telemetry sample of every peer", []() {
+    if (!segment || !peer)
+    {
+        logging::Info("IPC telemetry not connected");
+        return;
+    }
+    for (unsigned i = 0; i < cat_ipc::max_peers; i++)
+    {
+        ring_s &ring = segment->rings[i];
+        uint64_t written;
+        sample_s sample;
+        if (!ring.owner.load() || !(written = ring.written.load()) || !Read(ring, written - 1, sample))
+            continue;
+        logging::Info("%u: %u ticks, p50 %uus, p99 %uus, max %uus, %u players, %u paths in %uus, %u repaths, %u traces (%u/tick max), %llukB heap, quality level %u", i, sample.ticks, sample.tick_p50_us, sample.tick_p99_us, sample.tick_max_us, sample.players, sample.path_solves, sample.path_solve_us, sample.repaths, sample.traces, sample.traces_max_tick, (unsigned long long) sample.heap_bytes / 1024, sample.quality_level);
+    }
+});
+
+static InitRoutine init([]() {
+    EC::Register(EC::CreateMoveEarly, TickStart, "telemetry_tick_start", EC::very_early);
+    EC::Register(EC::CreateMove, TickEnd, "telemetry_tick_end", EC::very_late);
+    EC::Register(EC::Paint, Publish, "telemetry_publish", EC::very_late);
+    EC::Register(EC::Shutdown, Disconnect, "shutdown_ipc_telemetry", EC::average);
+});
+} // namespace ipc::telemetry
+
+#endif
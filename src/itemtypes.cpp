@@ -185,6 +185,18 @@ void ItemManager::RegisterSpecialMapping(ItemCheckerFn fn, k_EItemType type)
 }
 
 k_EItemType ItemManager::GetItemType(CachedEntity *ent)
+{
+    const model_t *model = RAW_ENT(ent)->GetModel();
+    if (!model)
+        return Classify(ent);
+    uint64_t key = (uint64_t(uintptr_t(model)) << 16) ^ uint16_t(ent->m_iClassID());
+    auto found   = cache.find(key);
+    if (found != cache.end())
+        return found->second;
+    return cache[key] = Classify(ent);
+}
+
+k_EItemType ItemManager::Classify(CachedEntity *ent)
 {
     for (const auto &it : specials)
     {
@@ -208,31 +220,13 @@ void ItemModelMapper::RegisterItem(std::string modelpath, k_EItemType type)
 k_EItemType ItemModelMapper::GetItemType(CachedEntity *entity)
 {
     const uintptr_t model = (uintptr_t) RAW_ENT(entity)->GetModel();
-    if (model)
-    {
-        for (const auto &it : map)
-        {
-            if (it.first == model)
-                return it.second;
-        }
-        std::string path(g_IModelInfo->GetModelName((const model_t *) model));
-        bool set = false;
-        for (const auto &it : models)
-        {
-            // logging::Info("comparing [%s] to [%s]", path.c_str(),
-            // it.first.c_str());
-            if (it.first == path)
-            {
-                // logging::Info("Found %s!", path.c_str());
-                map.emplace(model, it.second);
-                set = true;
-                break;
-            }
-        }
-        if (!set)
-            map.emplace(model, k_EItemType::ITEM_NONE);
-    }
-    return k_EItemType::ITEM_NONE;
+    if (!model)
+        return k_EItemType::ITEM_NONE;
+    auto cached = map.find(model);
+    if (cached != map.end())
+        return cached->second;
+    auto found = models.find(g_IModelInfo->GetModelName((const model_t *) model));
+    return map[model] = found != models.end() ? found->second : k_EItemType::ITEM_NONE;
 }
 
 ItemManager g_ItemManager;
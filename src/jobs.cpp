@@ -0,0 +1,95 @@
+#include "common.hpp"
+#include "settings/Int.hpp"
+#include "jobs.hpp"
+#include <thread>
+#include <condition_variable>
+#include <deque>
+
+namespace jobs
+{
+static settings::Int main_budget{ "jobs.main-budget-us", "1000" };
+
+constexpr int POOL_SIZE = 2;
+
+static std::mutex deferred_lock;
+static std::deque<job_t> deferred;
+
+static std::mutex pool_lock;
+static std::condition_variable pool_cv;
+static std::deque<job_t> pool_queue;
+static std::vector<std::thread> pool;
+static bool pool_stop{ false };
+
+void Defer(job_t job)
+{
+    std::lock_guard<std::mutex> lock(deferred_lock);
+    deferred.push_back(std::move(job));
+}
+
+static void worker()
+{
+    while (true)
+    {
+        job_t job;
+        {
+            std::unique_lock<std::mutex> lock(pool_lock);
+            pool_cv.wait(lock, []() { return pool_stop || !pool_queue.empty(); });
+            if (pool_stop)
+                return;
+            job = std::move(pool_queue.front());
+            pool_queue.pop_front();
+        }
+        job();
+    }
+}
+
+void Background(job_t job)
+{
+    std::lock_guard<std::mutex> lock(pool_lock);
+    if (pool_stop)
+        return;
+    // Started on first use, most sessions never need them
+    if (pool.empty())
+        for (int i = 0; i < POOL_SIZE; i++)
+            pool.emplace_back(worker);
+    pool_queue.push_back(std::move(job));
+    pool_cv.notify_one();
+}
+
+void Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_lock);
+        pool_stop = true;
+        pool_queue.clear();
+    }
+    pool_cv.notify_all();
+    for (auto &thread : pool)
+        if (thread.joinable())
+            thread.join();
+    pool.clear();
+    std::lock_guard<std::mutex> lock(deferred_lock);
+    deferred.clear();
+}
+
+static void Paint()
+{
+    PROF_SECTION(PT_jobs);
+    auto start = std::chrono::steady_clock::now();
+    do
+    {
+        job_t job;
+        {
+            std::lock_guard<std::mutex> lock(deferred_lock);
+            if (deferred.empty())
+                return;
+            job = std::move(deferred.front());
+            deferred.pop_front();
+        }
+        // Jobs may Defer() more work, so they run without the lock held
+        job();
+    } while (std::chrono::steady_clock::now() - start < std::chrono::microseconds(*main_budget));
+}
+
+static InitRoutine init([]() { EC::Register(EC::Paint, Paint, "paint_jobs", EC::very_late); });
+} // namespace jobs
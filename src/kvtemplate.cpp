@@ -0,0 +1,71 @@
+#include "common.hpp"
+#include "kvtemplate.hpp"
+
+kv_template::kv_template(const char *name, std::function<void(KeyValues *)> build) : m_name{ name }, m_build{ std::move(build) }
+{
+}
+
+kv_template::~kv_template()
+{
+    if (m_template)
+        m_template->deleteThis();
+}
+
+kv_template::message kv_template::Make()
+{
+    // KeyValuesSystem isn't around during static init
+    if (!m_template)
+    {
+        m_template = new KeyValues(m_name);
+        m_build(m_template);
+        for (KeyValues *key = m_template->GetFirstSubKey(); key; key = key->GetNextKey())
+            m_key_names.push_back(key->GetName());
+        if (m_key_names.size() > 16)
+            logging::Info("KeyValues template %s has %u keys, only the first 16 can be patched", m_name, unsigned(m_key_names.size()));
+    }
+    return message(*this, m_template->MakeCopy());
+}
+
+int kv_template::Index(const char *key) const
+{
+    for (size_t i = 0; i < m_key_names.size() && i < 16; i++)
+        if (!strcmp(m_key_names[i], key))
+            return int(i);
+    return -1;
+}
+
+kv_template::message::message(const kv_template &owner, KeyValues *root) : m_owner(owner), m_root{ root }, m_keys{}
+{
+    int i = 0;
+    for (KeyValues *key = root->GetFirstSubKey(); key && i < 16; key = key->GetNextKey())
+        m_keys[i++] = key;
+}
+
+kv_template::message::~message()
+{
+    if (m_root)
+        m_root->deleteThis();
+}
+
+// A null key name makes the setters write the node itself instead of looking a subkey up
+kv_template::message &kv_template::message::Int(const char *key, int value)
+{
+    int index = m_owner.Index(key);
+    if (index >= 0)
+        m_keys[index]->SetInt(nullptr, value);
+    return *this;
+}
+
+kv_template::message &kv_template::message::Float(const char *key, float value)
+{
+    int index = m_owner.Index(key);
+    if (index >= 0)
+        m_keys[index]->SetFloat(nullptr, value);
+    return *this;
+}
+
+void kv_template::message::Send()
+{
+    g_IEngine->ServerCmdKeyValues(m_root);
+    m_root = nullptr;
+}
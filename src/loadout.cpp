@@ -0,0 +1,82 @@
+#include "common.hpp"
+#include "loadout.hpp"
+
+namespace loadout
+{
+static loadout_s loadouts[PLAYER_ARRAY_SIZE]{};
+
+static inline unsigned FilterBit(int item_definition)
+{
+    return unsigned(item_definition) % FILTER_BITS;
+}
+
+bool loadout_s::Has(int wanted) const
+{
+    unsigned bit = FilterBit(wanted);
+    if (!(item_filter[bit / 64] & (1ull << (bit % 64))))
+        return false;
+    return std::find(item_definition, item_definition + count, wanted) != item_definition + count;
+}
+
+int loadout_s::Find(int wanted) const
+{
+    for (int i = 0; i < count; i++)
+        if (weapon_id[i] == wanted)
+            return idx[i];
+    return -1;
+}
+
+static void Rebuild(loadout_s &loadout, const int *handles, int handle_count)
+{
+    loadout.handle_count = handle_count;
+    loadout.incomplete   = false;
+    loadout.count        = 0;
+    std::fill(loadout.item_filter, loadout.item_filter + FILTER_BITS / 64, 0);
+    for (int i = 0; i < handle_count; i++)
+    {
+        loadout.handles[i] = handles[i];
+        int idx            = HandleToIDX(handles[i]);
+        if (IDX_BAD(idx))
+            continue;
+        CachedEntity *weapon = ENTITY(idx);
+        if (CE_INVALID(weapon))
+        {
+            loadout.incomplete = true;
+            continue;
+        }
+        int at                      = loadout.count++;
+        int item_definition         = CE_INT(weapon, netvar.iItemDefinitionIndex);
+        loadout.idx[at]             = idx;
+        loadout.item_definition[at] = item_definition;
+        loadout.weapon_id[at]       = re::C_TFWeaponBase::GetWeaponID(RAW_ENT(weapon));
+        unsigned bit                = FilterBit(item_definition);
+        loadout.item_filter[bit / 64] |= 1ull << (bit % 64);
+    }
+}
+
+const loadout_s *Get(CachedEntity *player)
+{
+    if (CE_BAD(player) || player->m_Type() != ENTITY_PLAYER || player->m_IDX <= 0 || player->m_IDX >= PLAYER_ARRAY_SIZE)
+        return nullptr;
+    loadout_s &loadout = loadouts[player->m_IDX];
+    if (loadout.tick == tickcount)
+        return &loadout;
+    loadout.tick = tickcount;
+
+    const int *handles = &CE_INT(player, netvar.hMyWeapons);
+    int count          = 0;
+    bool changed       = loadout.incomplete;
+    for (; count < MAX_WEAPONS && handles[count]; count++)
+        changed |= handles[count] != loadout.handles[count];
+    changed |= count != loadout.handle_count;
+    if (changed)
+        Rebuild(loadout, handles, count);
+    return &loadout;
+}
+
+static InitRoutine init([]() {
+    // Handles are only unique within a map
+    EC::Register(
+        EC::LevelShutdown, []() { std::fill(loadouts, loadouts + PLAYER_ARRAY_SIZE, loadout_s{}); }, "levelshutdown_loadout");
+});
+} // namespace loadout
@@ -7,6 +7,7 @@
 
 #include "common.hpp"
 #include "AntiAim.hpp"
+#include "projectiletable.hpp"
 
 CatCommand printfov("fov_print", "Dump achievements to file (development)", []() {
     if (CE_GOOD(LOCAL_E))
@@ -74,6 +75,33 @@ weaponmode GetWeaponModeloc()
         return weaponmode::weapon_hitscan;
     }
 }
+void LocalPlayer::UpdateWeaponProfile(CachedEntity *wep)
+{
+    int handle          = CE_INT(entity, netvar.hActiveWeapon);
+    int item_definition = CE_INT(wep, netvar.iItemDefinitionIndex);
+    if (weapon_profile.handle != handle || weapon_profile.item_definition != item_definition)
+    {
+        weapon_profile_s profile;
+        profile.handle            = handle;
+        profile.item_definition   = item_definition;
+        profile.idx               = wep->m_IDX;
+        profile.class_id          = wep->m_iClassID();
+        profile.raw               = RAW_ENT(wep);
+        profile.mode              = GetWeaponModeloc();
+        profile.projectile_params = projectile_table::Find(wep);
+        profile.charged           = profile.projectile_params && profile.projectile_params->Charged();
+        profile.sniper_rifle      = profile.class_id == CL_CLASS(CTFSniperRifle) || profile.class_id == CL_CLASS(CTFSniperRifleDecap);
+        profile.ambassador        = IsAmbassador(wep);
+        profile.sapper            = profile.class_id == CL_CLASS(CTFWeaponBuilder) || profile.class_id == CL_CLASS(CTFWeaponSapper);
+        // Both still see the old tick, so they compute everything live
+        profile.rapid_fire = isRapidFire(profile.raw);
+        if (!profile.charged)
+            profile.projectile = GetProjectileData(wep, profile.projectile_speed, profile.projectile_gravity, profile.projectile_start_velocity);
+        weapon_profile = profile;
+    }
+    weapon_profile.tick = tickcount;
+}
+
 void LocalPlayer::Update()
 {
     CachedEntity *wep;
@@ -82,20 +110,23 @@ void LocalPlayer::Update()
     entity     = ENTITY(entity_idx);
     if (CE_BAD(entity))
     {
-        team = 0;
+        team           = 0;
+        weapon_profile = {};
         return;
     }
     holding_sniper_rifle     = false;
     holding_sapper           = false;
     weapon_melee_damage_tick = false;
+    melee_range              = 0.0f;
     wep                      = weapon();
     if (CE_GOOD(wep))
     {
-        weapon_mode = GetWeaponModeloc();
-        if (wep->m_iClassID() == CL_CLASS(CTFSniperRifle) || wep->m_iClassID() == CL_CLASS(CTFSniperRifleDecap))
-            holding_sniper_rifle = true;
-        if (wep->m_iClassID() == CL_CLASS(CTFWeaponBuilder) || wep->m_iClassID() == CL_CLASS(CTFWeaponSapper))
-            holding_sapper = true;
+        UpdateWeaponProfile(wep);
+        weapon_mode          = weapon_profile.mode;
+        holding_sniper_rifle = weapon_profile.sniper_rifle;
+        holding_sapper       = weapon_profile.sapper;
+        if (weapon_mode == weapon_melee)
+            melee_range = re::C_TFWeaponBaseMelee::GetSwingRange(RAW_ENT(wep));
         // Detect when a melee hit will result in damage, useful for aimbot and antiaim
         if (CE_FLOAT(wep, netvar.flNextPrimaryAttack) > g_GlobalVars->curtime && weapon_mode == weapon_melee)
         {
@@ -111,6 +142,8 @@ void LocalPlayer::Update()
         else
             melee_damagetick = 0;
     }
+    else
+        weapon_profile = {};
     team                   = CE_INT(entity, netvar.iTeamNum);
     life_state             = CE_BYTE(entity, netvar.iLifeState);
     v_ViewOffset           = CE_VECTOR(entity, netvar.vViewOffset);
@@ -130,30 +163,6 @@ void LocalPlayer::Update()
     {
         flZoomBegin = 0.0f;
     }
-    // Alive
-    if (!life_state)
-    {
-        spectator_state = NONE;
-        for (int i = 0; i < PLAYER_ARRAY_SIZE; i++)
-        {
-            // Assign the for loops tick number to an ent
-            CachedEntity *ent = ENTITY(i);
-            if (!CE_BAD(ent) && (CE_INT(ent, netvar.hObserverTarget) & 0xFFF) == LOCAL_E->m_IDX)
-            {
-                auto mode = CE_INT(ent, netvar.iObserverMode);
-                if (mode == 4)
-                {
-                    spectator_state = FIRSTPERSON;
-                    // FIRSTPERSON is the "worst" state, exit
-                    return;
-                }
-                if (mode == 5)
-                {
-                    spectator_state = THIRDPERSON;
-                }
-            }
-        }
-    }
 }
 
 void LocalPlayer::UpdateEnd()
@@ -176,4 +185,14 @@ CachedEntity *LocalPlayer::weapon()
     return ENTITY(eid);
 }
 
+bool LocalPlayer::holdingAmbassador()
+{
+    CachedEntity *wep = weapon();
+    if (CE_BAD(wep))
+        return false;
+    if (weapon_profile.tick == tickcount && weapon_profile.idx == wep->m_IDX)
+        return weapon_profile.ambassador;
+    return IsAmbassador(wep);
+}
+
 LocalPlayer *g_pLocalPlayer = 0;
@@ -0,0 +1,98 @@
+#include "common.hpp"
+#include "memtrack.hpp"
+
+namespace memtrack
+{
+stats_s stats[TAG_COUNT];
+
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    explicit counting_resource(stats_s &stats) : m_stats(stats)
+    {
+    }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        void *memory = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        int64_t live = m_stats.tracked.fetch_add(bytes, std::memory_order_relaxed) + bytes + m_stats.reported.load(std::memory_order_relaxed);
+        m_stats.allocations.fetch_add(1, std::memory_order_relaxed);
+        m_stats.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        int64_t peak = m_stats.peak.load(std::memory_order_relaxed);
+        while (live > peak && !m_stats.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            ;
+        return memory;
+    }
+    void do_deallocate(void *memory, size_t bytes, size_t alignment) override
+    {
+        m_stats.tracked.fetch_sub(bytes, std::memory_order_relaxed);
+        std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    stats_s &m_stats;
+};
+
+std::pmr::memory_resource *resource(tag t)
+{
+    // Built on first use, the level arena asks for its upstream during static init. Never destroyed,
+    // the arena's pool gives its chunks back during static destruction
+    static counting_resource *const *resources = []() {
+        static counting_resource *list[TAG_COUNT];
+        for (int i = 0; i < TAG_COUNT; i++)
+            list[i] = new counting_resource(stats[i]);
+        return list;
+    }();
+    return resources[t];
+}
+
+static std::vector<std::pair<tag, size_t (*)()>> &reporters()
+{
+    static std::vector<std::pair<tag, size_t (*)()>> list;
+    return list;
+}
+
+void Report(tag t, size_t (*bytes)())
+{
+    reporters().emplace_back(t, bytes);
+}
+
+void Update()
+{
+    int64_t reported[TAG_COUNT]{};
+    for (auto &reporter : reporters())
+        reported[reporter.first] += reporter.second();
+    for (int i = 0; i < TAG_COUNT; i++)
+    {
+        stats[i].reported.store(reported[i], std::memory_order_relaxed);
+        int64_t live = stats[i].Live();
+        if (live > stats[i].peak.load(std::memory_order_relaxed))
+            stats[i].peak.store(live, std::memory_order_relaxed);
+    }
+}
+
+static CatCommand print("debug_memory", "Show live and peak bytes and the allocation rate of every subsystem", []() {
+    static Timer last{};
+    static uint64_t last_allocations[TAG_COUNT]{};
+    static uint64_t last_bytes[TAG_COUNT]{};
+    float seconds = std::max(std::chrono::duration<float>(Timer::Now() - last.last).count(), 0.001f);
+    Update();
+    int64_t total = 0;
+    for (int i = 0; i < TAG_COUNT; i++)
+    {
+        auto &stat     = stats[i];
+        uint64_t count = stat.allocations.load(std::memory_order_relaxed);
+        uint64_t bytes = stat.allocated_bytes.load(std::memory_order_relaxed);
+        total += stat.Live();
+        logging::Info("%-10s %8lldkB live (%lldkB reported) %8lldkB peak, %.1f allocations/s %.1fkB/s since the last call", Name(tag(i)), (long long) stat.Live() / 1024, (long long) stat.reported.load() / 1024, (long long) stat.peak.load() / 1024, (count - last_allocations[i]) / seconds, (bytes - last_bytes[i]) / 1024.0f / seconds);
+        last_allocations[i] = count;
+        last_bytes[i]       = bytes;
+    }
+    logging::Info("%lldkB in tagged subsystems", (long long) total / 1024);
+    last.update();
+});
+} // namespace memtrack
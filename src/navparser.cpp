@@ -1,11 +1,22 @@
 #include "common.hpp"
+#include "core/levelarena.hpp"
 #include "navparser.hpp"
+#include "asynctrace.hpp"
+#include "jobs.hpp"
+#include "ipcscheduler.hpp"
+#include "governor.hpp"
 #include <thread>
 #include "micropather.h"
 #include <pwd.h>
-#include <boost/functional/hash.hpp>
 #include <boost/container/flat_set.hpp>
 #include <chrono>
+#include <queue>
+#include <tuple>
+#include <climits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
 #include <CNavFile.h>
 #include "MiscAimbot.hpp"
 #include "Aimbot.hpp"
@@ -22,9 +33,25 @@ static settings::Boolean look{ "misc.pathing.look-at-path", "false" };
 static settings::Int stuck_time{ "misc.pathing.stuck-time", "4000" };
 static settings::Int unreachable_time{ "misc.pathing.unreachable-time", "1000" };
 static settings::Boolean log_pathing{ "misc.pathing.log", "false" };
+// 0 = micropather, 1 = incremental (D* Lite), falls back to micropather if it gives up
+static settings::Int planner{ "misc.pathing.planner", "0" };
+// Repaths get solved on the job pool while the bot keeps following the old crumbs
+static settings::Boolean async_repath{ "misc.pathing.async-repath", "true" };
+// Keep the compiled graph of every navfile in the data directory and map it instead of rebuilding it
+static settings::Boolean nav_cache{ "misc.pathing.nav-cache", "true" };
 
-// Score based on how much the area was used by other players, in seconds
-static std::unordered_map<int, float> area_score;
+stats_s stats{};
+
+static void countSolve(long long ns)
+{
+    stats.solves.fetch_add(1, std::memory_order_relaxed);
+    stats.solve_ns.fetch_add(ns, std::memory_order_relaxed);
+}
+
+// Score based on how much the area was used by other players, in seconds. Indexed by position in navfile->m_areas
+static level_arena::level<std::pmr::vector<float>> area_score;
+// Area each player was last seen on
+static std::array<CNavArea *, MAX_PLAYERS + 1> player_areas{};
 static std::vector<CNavArea *> crumbs;
 static Vector startPoint, endPoint;
 
@@ -41,9 +68,7 @@ enum ignore_status : uint8_t
     // No LOS between areas
     vischeck_failed,
     // Failed to actually walk thru connection
-    explicit_ignored,
-    // Danger like sentry gun or sticky
-    danger_found
+    explicit_ignored
 };
 
 void ResetPather();
@@ -96,7 +121,165 @@ float getZBetweenAreas(CNavArea *start, CNavArea *end)
     return z2 - z1;
 }
 
-static std::unordered_map<std::pair<CNavArea *, CNavArea *>, ignoredata, boost::hash<std::pair<CNavArea *, CNavArea *>>> ignores;
+// How much cheaper a connection gets for an area that was used by players
+static float scoreFactor(float score)
+{
+    // Formula to calculate by how much % to reduce the distance by (https://xaktly.com/LogisticFunctions.html)
+    float multiplier = 2.0f * ((0.9f) / (1.0f + exp(-0.8f * score)) - 0.45f);
+    return 1.0f - multiplier;
+}
+
+// Nav areas and connections flattened into arrays after load, so path finding only does array reads
+// Read only array that either owns its storage or points into a mapped nav cache
+template <typename T> struct flat_array
+{
+    std::vector<T> owned;
+    const T *data{ nullptr };
+    size_t count{ 0 };
+
+    flat_array() = default;
+    flat_array(flat_array &&) = default;
+    flat_array &operator=(flat_array &&) = default;
+    // Copies would keep pointing at the storage of the original
+    flat_array(const flat_array &) = delete;
+    flat_array &operator=(const flat_array &) = delete;
+
+    void Own(std::vector<T> &&values)
+    {
+        owned = std::move(values);
+        data  = owned.data();
+        count = owned.size();
+    }
+    void View(const T *values, size_t size)
+    {
+        owned.clear();
+        data  = values;
+        count = size;
+    }
+    const T &operator[](size_t i) const
+    {
+        return data[i];
+    }
+    size_t size() const
+    {
+        return count;
+    }
+    const T *begin() const
+    {
+        return data;
+    }
+    const T *end() const
+    {
+        return data + count;
+    }
+};
+
+enum edge_flags : uint8_t
+{
+    // Too high to walk up, never usable
+    EDGE_STEEP = 1 << 0
+};
+
+// The nav areas and their connections as flat arrays, indexed by position in navfile->m_areas
+struct nav_graph
+{
+    CNavArea *base{ nullptr };
+    // Connections of area a are edges edge_start[a] .. edge_start[a + 1] - 1
+    flat_array<unsigned> edge_start;
+    flat_array<unsigned> edge_source;
+    flat_array<unsigned> edge_target;
+    // Edges into area a are pred_edge[pred_start[a]] .. pred_edge[pred_start[a + 1] - 1]
+    flat_array<unsigned> pred_start;
+    flat_array<unsigned> pred_edge;
+    // Distance between the area centers
+    flat_array<float> edge_length;
+    flat_array<uint8_t> edge_flags;
+    // Ignore state of every connection
+    std::vector<ignoredata> edge_data;
+    // How many danger sources (sentries, stickies) can see each area
+    std::vector<uint16_t> area_danger;
+    // scoreFactor of every area
+    std::vector<float> area_factor;
+    // Set whenever a cost the pather may have cached changed
+    bool costs_changed{ false };
+
+    void Build(std::vector<CNavArea> &areas)
+    {
+        base = areas.data();
+        std::vector<unsigned> starts(1, 0), sources, targets;
+        std::vector<float> lengths;
+        std::vector<uint8_t> flags;
+        for (auto &area : areas)
+        {
+            for (auto &i : area.m_connections)
+            {
+                sources.push_back(Index(&area));
+                targets.push_back(Index(i.area));
+                lengths.push_back(area.m_center.DistTo(i.area->m_center));
+                // No z check Should be done for stairs as they can go very far up
+                flags.push_back(getZBetweenAreas(&area, i.area) > 70 ? EDGE_STEEP : 0);
+            }
+            starts.push_back(targets.size());
+        }
+        // Reverse of the above, for searches that run from the goal
+        std::vector<unsigned> preds_start(areas.size() + 1, 0);
+        for (unsigned target : targets)
+            preds_start[target + 1]++;
+        for (size_t i = 1; i < preds_start.size(); i++)
+            preds_start[i] += preds_start[i - 1];
+        std::vector<unsigned> preds(targets.size());
+        std::vector<unsigned> fill(preds_start.begin(), preds_start.end() - 1);
+        for (unsigned e = 0; e < targets.size(); e++)
+            preds[fill[targets[e]]++] = e;
+
+        edge_start.Own(std::move(starts));
+        edge_source.Own(std::move(sources));
+        edge_target.Own(std::move(targets));
+        pred_start.Own(std::move(preds_start));
+        pred_edge.Own(std::move(preds));
+        edge_length.Own(std::move(lengths));
+        edge_flags.Own(std::move(flags));
+        InitState(areas);
+    }
+    // Per process state, also needed when the topology comes from the nav cache
+    void InitState(std::vector<CNavArea> &areas)
+    {
+        base = areas.data();
+        edge_data.assign(edge_target.size(), ignoredata{});
+        area_danger.assign(areas.size(), 0);
+        area_factor.assign(areas.size(), scoreFactor(0.0f));
+        costs_changed = false;
+    }
+    unsigned Index(const CNavArea *area) const
+    {
+        return area - base;
+    }
+    // nullptr if begin has no connection to end
+    ignoredata *EdgeData(const CNavArea *begin, const CNavArea *end)
+    {
+        unsigned index = Index(begin), target = Index(end);
+        if (index >= area_danger.size())
+            return nullptr;
+        for (unsigned e = edge_start[index]; e < edge_start[index + 1]; e++)
+            if (edge_target[e] == target)
+                return &edge_data[e];
+        return nullptr;
+    }
+    // Areas of an old navfile or none loaded yet count as safe
+    bool IsDangerous(const CNavArea *area) const
+    {
+        unsigned index = Index(area);
+        return index < area_danger.size() && area_danger[index];
+    }
+    void SetStatus(ignoredata &data, ignore_status status)
+    {
+        if (data.status != status)
+            costs_changed = true;
+        data.status = status;
+    }
+};
+static nav_graph graph;
+
 namespace ignoremanager
 {
 static ignore_status vischeck(CNavArea *begin, CNavArea *end)
@@ -116,30 +299,108 @@ static ignore_status vischeck(CNavArea *begin, CNavArea *end)
     }
     return vischeck_failed;
 }
-static ignore_status runIgnoreChecks(CNavArea *begin, CNavArea *end)
+static ignore_status runIgnoreChecks(unsigned edge, CNavArea *begin, CNavArea *end)
 {
-    // No z check Should be done for stairs as they can go very far up
-    if (getZBetweenAreas(begin, end) > 70)
+    if (graph.edge_flags[edge] & EDGE_STEEP)
         return const_ignored;
     if (!vischecks)
         return vischeck_success;
     return vischeck(begin, end);
 }
-static void updateDanger()
+
+// Something that shoots at everything it can see within range. Rasterized into the areas once, only redone when it moves
+struct danger_source
+{
+    Vector loc;
+    float range;
+    const CNavArea *graph_base;
+    // Areas it can see, complete once pending is 0
+    std::vector<unsigned> visible;
+    int pending{ 0 };
+    // Whether visible is currently counted in area_danger
+    bool applied{ false };
+    bool seen{ false };
+};
+static level_arena::level<std::pmr::unordered_map<int, std::shared_ptr<danger_source>>> danger_sources;
+
+static void applyDanger(danger_source &source, bool apply)
+{
+    if (source.applied == apply || source.graph_base != graph.base)
+        return;
+    source.applied = apply;
+    for (unsigned area : source.visible)
+    {
+        uint16_t &count = graph.area_danger[area];
+        // Only going between safe and dangerous changes path costs
+        if (apply ? !count++ : !--count)
+            graph.costs_changed = true;
+    }
+}
+
+static std::shared_ptr<danger_source> rasterizeDanger(const Vector &loc, float range)
 {
-    for (size_t i = 0; i <= HIGHEST_ENTITY; i++)
+    auto source        = std::make_shared<danger_source>();
+    source->loc        = loc;
+    source->range      = range;
+    source->graph_base = graph.base;
+    if (!grid.width)
+        return source;
+
+    // Candidates from the grid cells the range touches
+    std::vector<unsigned> candidates;
+    int x0 = grid.CellX(loc.x - range), x1 = grid.CellX(loc.x + range);
+    int y0 = grid.CellY(loc.y - range), y1 = grid.CellY(loc.y + range);
+    for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++)
+            grid.ForCell(x, y, [&](CNavArea *area) { candidates.push_back(graph.Index(area)); });
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::weak_ptr<danger_source> weak = source;
+    for (unsigned index : candidates)
     {
-        CachedEntity *ent = ENTITY(i);
-        if (CE_INVALID(ent))
+        Vector area = graph.base[index].m_center;
+        area.z += 41.5f;
+        if (loc.DistTo(area) > range)
             continue;
-        if (ent->m_iClassID() == CL_CLASS(CObjectSentrygun))
+        source->pending++;
+        asynctrace::Submit(loc, area, true, MASK_SHOT_HULL, [weak, index](bool visible) {
+            // Source is gone or moved since
+            auto source = weak.lock();
+            if (!source)
+                return;
+            if (visible)
+                source->visible.push_back(index);
+            source->pending--;
+        });
+    }
+    return source;
+}
+
+static void updateDanger()
+{
+    for (auto &i : danger_sources)
+        i.second->seen = false;
+    auto track = [](int idx, const Vector &loc, float range) {
+        auto &source = danger_sources[idx];
+        // Small moves don't change what it can see
+        if (!source || source->range != range || source->loc.DistTo(loc) > 16.0f || source->graph_base != graph.base)
         {
-            if (!ent->m_bEnemy())
-                continue;
-            if (HasCondition<TFCond_Disguised>(LOCAL_E))
+            if (source)
+                applyDanger(*source, false);
+            source = rasterizeDanger(loc, range);
+        }
+        source->seen = true;
+    };
+    // Sentries don't care about us while we're disguised
+    if (!HasCondition<TFCond_Disguised>(LOCAL_E))
+        for (auto &building : entity_cache::building_registry())
+        {
+            CachedEntity *ent = building.ent;
+            if (building.kind != entity_cache::BUILDING_SENTRY || !ent->m_bEnemy())
                 continue;
             Vector loc = GetBuildingPosition(ent);
-            if (RAW_ENT(ent)->IsDormant())
+            if (building.dormant)
             {
                 auto vec = ent->m_vecDormantOrigin();
                 if (vec)
@@ -151,99 +412,43 @@ static void updateDanger()
                     continue;
             }
             // It's still building, ignore
-            else if (CE_BYTE(ent, netvar.m_bBuilding) || CE_BYTE(ent, netvar.m_bPlacing))
+            else if (building.building || building.placing)
                 continue;
 
-            // Keep track of good spots
-            std::vector<CNavArea *> spot_list{};
-
-            // Don't blacklist if local player is standing in it
-            bool local_player_in_range = false;
-
-            // Local player's nav area
-            auto local_area = findClosestNavSquare(LOCAL_E->m_vecOrigin());
-
-            // Actual building check
-            for (auto &i : navfile->m_areas)
-            {
-                Vector area = i.m_center;
-                area.z += 41.5f;
-                if (loc.DistTo(area) > 1100)
-                    continue;
-                // Check if sentry can see us
-                if (!IsVectorVisible(loc, area, true))
-                    continue;
-                // local player's nav area?
-                if (local_area == &i)
-                {
-                    local_player_in_range = true;
-                    break;
-                }
-                spot_list.push_back(&i);
-            }
-
-            // Local player is in the sentry range, let him nav
-            if (local_player_in_range)
-                continue;
-
-            // Ignore these
-            for (auto &i : spot_list)
-            {
-                ignoredata &data = ignores[{ i, nullptr }];
-                data.status      = danger_found;
-                data.ignoreTimeout.update();
-                data.ignoreTimeout.last -= std::chrono::seconds(17);
-            }
+            // Sentry range
+            track(ent->m_IDX, loc, 1100);
         }
-        else if (ent->m_iClassID() == CL_CLASS(CTFGrenadePipebombProjectile))
-        {
-            if (!ent->m_bEnemy())
-                continue;
-            if (CE_INT(ent, netvar.iPipeType) == 1)
-                continue;
-            Vector loc = ent->m_vecOrigin();
-
-            // Keep track of good spots
-            std::vector<CNavArea *> spot_list{};
-
-            // Don't blacklist if local player is standing in it
-            bool local_player_in_range = false;
-
-            // Local player's nav area
-            auto local_area = findClosestNavSquare(LOCAL_E->m_vecOrigin());
-
-            // Actual Sticky check
-            for (auto &i : navfile->m_areas)
-            {
-                Vector area = i.m_center;
-                area.z += 41.5f;
-                if (loc.DistTo(area) > 130)
-                    continue;
-                // Check if in Sticky vis range
-                if (!IsVectorVisible(loc, area, true))
-                    continue;
-                // local player's nav area?
-                if (local_area == &i)
-                {
-                    local_player_in_range = true;
-                    break;
-                }
-                spot_list.push_back(&i);
-            }
-
-            // Local player is in the sentry range, let him nav
-            if (local_player_in_range)
-                continue;
+    for (auto ent : entity_cache::projectiles())
+    {
+        if (ent->m_iClassID() != CL_CLASS(CTFGrenadePipebombProjectile) || !ent->m_bEnemy())
+            continue;
+        if (CE_INT(ent, netvar.iPipeType) == 1)
+            continue;
+        Vector loc = ent->m_vecOrigin();
 
-            // Ignore these
-            for (auto &i : spot_list)
-            {
-                ignoredata &data = ignores[{ i, nullptr }];
-                data.status      = danger_found;
-                data.ignoreTimeout.update();
-                data.ignoreTimeout.last -= std::chrono::seconds(17);
-            }
+        // Sticky vis range
+        track(ent->m_IDX, loc, 130);
+    }
+    // Busters go off next to sentries, anything that can see them then gets hit
+    for (auto ent : entity_cache::busters())
+        if (ent->m_bAlivePlayer() && ent->m_bEnemy())
+            track(ent->m_IDX, ent->m_vecOrigin(), 300);
+
+    // Don't blacklist if local player is standing in it, let him nav out
+    CNavArea *local_area = findClosestNavSquare(LOCAL_E->m_vecOrigin());
+    unsigned local_index = local_area ? graph.Index(local_area) : UINT_MAX;
+    for (auto it = danger_sources.begin(); it != danger_sources.end();)
+    {
+        danger_source &source = *it->second;
+        if (!source.seen)
+        {
+            applyDanger(source, false);
+            it = danger_sources.erase(it);
+            continue;
         }
+        if (!source.pending)
+            applyDanger(source, std::find(source.visible.begin(), source.visible.end(), local_index) == source.visible.end());
+        ++it;
     }
 }
 
@@ -257,7 +462,10 @@ static void checkPath()
         CNavArea *end   = crumbs[i + 1];
         if (!begin || !end)
             continue;
-        ignoredata &data = ignores[{ begin, end }];
+        ignoredata *edge = graph.EdgeData(begin, end);
+        if (!edge)
+            continue;
+        ignoredata &data = *edge;
         if (data.status == vischeck_failed)
             return;
         if (data.status == vischeck_blockedentity && vischeckBlock)
@@ -265,17 +473,17 @@ static void checkPath()
         auto vis_status = vischeck(begin, end);
         if (vis_status == vischeck_failed)
         {
-            data.status = vischeck_failed;
+            graph.SetStatus(data, vischeck_failed);
             data.ignoreTimeout.update();
             perform_repath = true;
         }
         else if (vis_status == vischeck_blockedentity && vischeckBlock)
         {
-            data.status = vischeck_blockedentity;
+            graph.SetStatus(data, vischeck_blockedentity);
             data.ignoreTimeout.update();
             perform_repath = true;
         }
-        else if (ignores[{ end, nullptr }].status == danger_found)
+        else if (graph.IsDangerous(end))
         {
             perform_repath = true;
         }
@@ -284,13 +492,8 @@ static void checkPath()
         repath();
 }
 // 0 = Not ignored, 1 = low priority, 2 = ignored
-static int isIgnored(CNavArea *begin, CNavArea *end)
+static int ignoreLevel(ignore_status status)
 {
-    if (ignores[{ end, nullptr }].status == danger_found)
-        return 2;
-    ignore_status status = ignores[{ begin, end }].status;
-    if (status == unknown)
-        status = runIgnoreChecks(begin, end);
     if (status == vischeck_success)
         return 0;
     else if (status == vischeck_blockedentity && !vischeckBlock)
@@ -298,17 +501,45 @@ static int isIgnored(CNavArea *begin, CNavArea *end)
     else
         return 2;
 }
+static int isIgnored(unsigned edge, CNavArea *begin, CNavArea *end)
+{
+    if (graph.area_danger[graph.edge_target[edge]])
+        return 2;
+    ignoredata &data     = graph.edge_data[edge];
+    ignore_status status = data.status;
+    // Remember the result, it expires like any other status
+    if (status == unknown)
+    {
+        status      = runIgnoreChecks(edge, begin, end);
+        data.status = status;
+        data.ignoreTimeout.update();
+    }
+    return ignoreLevel(status);
+}
+// Same as isIgnored, but assumes unchecked connections can be seen through, for when tracing isn't possible
+static int isIgnoredUnchecked(unsigned edge)
+{
+    if (graph.area_danger[graph.edge_target[edge]])
+        return 2;
+    ignore_status status = graph.edge_data[edge].status;
+    if (status == unknown)
+        status = graph.edge_flags[edge] & EDGE_STEEP ? const_ignored : vischeck_success;
+    return ignoreLevel(status);
+}
 static bool addTime(ignoredata &connection, ignore_status status)
 {
-    connection.status = status;
+    graph.SetStatus(connection, status);
     connection.ignoreTimeout.update();
 
     return true;
 }
 static bool addTime(CNavArea *begin, CNavArea *end, ignore_status status)
 {
+    ignoredata *connection = graph.EdgeData(begin, end);
+    if (!connection)
+        return false;
     logging::Info("Ignored Connection %i-%i", begin->m_id, end->m_id);
-    return addTime(ignores[{ begin, end }], status);
+    return addTime(*connection, status);
 }
 static bool addTime(CNavArea *begin, CNavArea *end, Timer &time)
 {
@@ -320,13 +551,15 @@ static bool addTime(CNavArea *begin, CNavArea *end, Timer &time)
         return true;
     }
     using namespace std::chrono;
-    // Check if connection is already known
-    if (ignores.find({ begin, end }) == ignores.end())
+    ignoredata *edge = graph.EdgeData(begin, end);
+    if (!edge)
     {
-        ignores[{ begin, end }] = {};
+        // Not connected, nothing to ignore
+        clearInstructions();
+        return true;
     }
-    ignoredata &connection = ignores[{ begin, end }];
-    connection.stucktime += duration_cast<milliseconds>(system_clock::now() - time.last).count();
+    ignoredata &connection = *edge;
+    connection.stucktime += duration_cast<milliseconds>(Timer::Now() - time.last).count();
     if (connection.stucktime >= *stuck_time)
     {
         logging::Info("Ignored Connection %i-%i", begin->m_id, end->m_id);
@@ -336,7 +569,10 @@ static bool addTime(CNavArea *begin, CNavArea *end, Timer &time)
 }
 static void reset()
 {
-    ignores.clear();
+    std::fill(graph.edge_data.begin(), graph.edge_data.end(), ignoredata{});
+    for (auto &i : danger_sources)
+        applyDanger(*i.second, false);
+    danger_sources.clear();
     ResetPather();
 }
 static void updateIgnores()
@@ -349,36 +585,29 @@ static void updateIgnores()
     updateDanger();
     if (crumbs.empty())
     {
-        for (auto &i : ignores)
+        for (auto &i : graph.edge_data)
         {
-            switch (i.second.status)
+            switch (i.status)
             {
             case explicit_ignored:
-                if (i.second.ignoreTimeout.check(60000))
+                if (i.ignoreTimeout.check(60000))
                 {
-                    i.second.status    = unknown;
-                    i.second.stucktime = 0;
-                    reset_pather       = true;
+                    i.status     = unknown;
+                    i.stucktime  = 0;
+                    reset_pather = true;
                 }
                 break;
             case unknown:
                 break;
-            case danger_found:
-                if (i.second.ignoreTimeout.check(20000))
-                {
-                    i.second.status = unknown;
-                    reset_pather    = true;
-                }
-                break;
             case vischeck_failed:
             case vischeck_blockedentity:
             case vischeck_success:
             default:
-                if (i.second.ignoreTimeout.check(30000))
+                if (i.ignoreTimeout.check(30000))
                 {
-                    i.second.status    = unknown;
-                    i.second.stucktime = 0;
-                    reset_pather       = true;
+                    i.status     = unknown;
+                    i.stucktime  = 0;
+                    reset_pather = true;
                 }
                 break;
             }
@@ -394,10 +623,296 @@ static void updateIgnores()
 }
 static bool isSafe(CNavArea *area)
 {
-    return !(ignores[{ area, nullptr }].status == danger_found);
+    return !area || !graph.IsDangerous(area);
 }
 }; // namespace ignoremanager
 
+size_t ignoredConnections()
+{
+    size_t count = 0;
+    for (auto &data : graph.edge_data)
+        if (data.status == const_ignored || data.status == vischeck_failed || data.status == explicit_ignored)
+            count++;
+    return count;
+}
+
+// Cost of walking along edge, negative if it can't be used. Runs the ignore checks of unchecked connections unless told not to
+static float edgeCost(unsigned e, bool run_checks = true)
+{
+    unsigned target = graph.edge_target[e];
+    int isIgnored   = run_checks ? ignoremanager::isIgnored(e, graph.base + graph.edge_source[e], graph.base + target) : ignoremanager::isIgnoredUnchecked(e);
+    if (isIgnored == 2)
+        return -1.0f;
+    if (isIgnored == 1)
+        return graph.edge_length[e] + 2000;
+    // Check priority based on usage
+    return graph.edge_length[e] * graph.area_factor[target];
+}
+
+// D* Lite (Koenig, Likhachev 2002). Searches backwards from the goal, so a moved start and a handful of
+// changed connections only update the areas around them instead of redoing the whole search
+struct incremental_planner
+{
+    enum result
+    {
+        solved,
+        no_path,
+        // Hit the expansion limit, use micropather instead
+        gave_up
+    };
+    struct open_entry
+    {
+        float k1, k2;
+        unsigned area;
+        bool operator>(const open_entry &other) const
+        {
+            return k1 > other.k1 || (k1 == other.k1 && k2 > other.k2);
+        }
+    };
+
+    std::vector<float> g, rhs;
+    // Key each area is queued with, entries in queue that don't match are stale
+    std::vector<std::pair<float, float>> key;
+    std::vector<uint8_t> open;
+    std::priority_queue<open_entry, std::vector<open_entry>, std::greater<open_entry>> queue;
+    // Edge cost the search saw last, NAN if it never looked at the edge
+    std::vector<float> seen;
+    const CNavArea *graph_base{ nullptr };
+    unsigned start{ 0 }, goal{ 0 };
+    float km{ 0.0f };
+    bool valid{ false };
+
+    float H(unsigned a, unsigned b) const
+    {
+        return graph.base[a].m_center.DistTo(graph.base[b].m_center);
+    }
+    std::pair<float, float> CalcKey(unsigned s) const
+    {
+        float m = std::min(g[s], rhs[s]);
+        return { m + H(start, s) + km, m };
+    }
+    float Cost(unsigned e)
+    {
+        float cost = edgeCost(e);
+        if (cost < 0.0f)
+            cost = INFINITY;
+        seen[e] = cost;
+        return cost;
+    }
+    void Queue(unsigned s)
+    {
+        key[s]  = CalcKey(s);
+        open[s] = true;
+        queue.push({ key[s].first, key[s].second, s });
+    }
+    void UpdateVertex(unsigned u)
+    {
+        if (u != goal)
+        {
+            float best = INFINITY;
+            for (unsigned e = graph.edge_start[u]; e < graph.edge_start[u + 1]; e++)
+                best = std::min(best, Cost(e) + g[graph.edge_target[e]]);
+            rhs[u] = best;
+        }
+        if (g[u] != rhs[u])
+            Queue(u);
+        else
+            open[u] = false;
+    }
+    void Init(unsigned new_start, unsigned new_goal)
+    {
+        size_t areas = graph.area_danger.size();
+        g.assign(areas, INFINITY);
+        rhs.assign(areas, INFINITY);
+        key.assign(areas, { 0.0f, 0.0f });
+        open.assign(areas, false);
+        seen.assign(graph.edge_target.size(), NAN);
+        queue      = {};
+        start      = new_start;
+        goal       = new_goal;
+        km         = 0.0f;
+        graph_base = graph.base;
+        rhs[goal]  = 0.0f;
+        Queue(goal);
+        valid = true;
+    }
+    // Connections that changed since the last search need their source updated
+    void ApplyChanges()
+    {
+        for (unsigned e = 0; e < seen.size(); e++)
+        {
+            if (std::isnan(seen[e]))
+                continue;
+            // Unchecked again after a timeout, UpdateVertex will check it
+            if (graph.edge_data[e].status == unknown)
+            {
+                UpdateVertex(graph.edge_source[e]);
+                continue;
+            }
+            float cost = edgeCost(e);
+            if (cost < 0.0f)
+                cost = INFINITY;
+            if (cost != seen[e])
+                UpdateVertex(graph.edge_source[e]);
+        }
+    }
+    bool ComputeShortestPath()
+    {
+        size_t limit = 4 * g.size();
+        for (size_t expansions = 0; !queue.empty();)
+        {
+            open_entry top = queue.top();
+            if (!open[top.area] || key[top.area] != std::make_pair(top.k1, top.k2))
+            {
+                queue.pop();
+                continue;
+            }
+            auto start_key = CalcKey(start);
+            if (!(std::make_pair(top.k1, top.k2) < start_key) && rhs[start] == g[start])
+                break;
+            if (++expansions > limit)
+                return false;
+            queue.pop();
+            unsigned u   = top.area;
+            auto new_key = CalcKey(u);
+            if (std::make_pair(top.k1, top.k2) < new_key)
+                Queue(u);
+            else if (g[u] > rhs[u])
+            {
+                g[u]    = rhs[u];
+                open[u] = false;
+                for (unsigned i = graph.pred_start[u]; i < graph.pred_start[u + 1]; i++)
+                    UpdateVertex(graph.edge_source[graph.pred_edge[i]]);
+            }
+            else
+            {
+                g[u] = INFINITY;
+                for (unsigned i = graph.pred_start[u]; i < graph.pred_start[u + 1]; i++)
+                    UpdateVertex(graph.edge_source[graph.pred_edge[i]]);
+                UpdateVertex(u);
+            }
+        }
+        // Lazy deletion leaves stale entries behind, drop them once they outnumber the areas
+        if (queue.size() > 4 * g.size())
+        {
+            queue = {};
+            for (unsigned s = 0; s < g.size(); s++)
+                if (open[s])
+                    queue.push({ key[s].first, key[s].second, s });
+        }
+        return true;
+    }
+    result Plan(CNavArea *from, CNavArea *to, std::vector<CNavArea *> &path)
+    {
+        unsigned new_start = graph.Index(from), new_goal = graph.Index(to);
+        if (!valid || new_goal != goal || graph_base != graph.base || g.size() != graph.area_danger.size())
+            Init(new_start, new_goal);
+        else
+        {
+            km += H(start, new_start);
+            start = new_start;
+            ApplyChanges();
+        }
+        if (!ComputeShortestPath())
+        {
+            // Search state is half updated, start over next time
+            valid = false;
+            return gave_up;
+        }
+        if (g[start] == INFINITY)
+            return no_path;
+
+        // Walk down the gradient
+        path.clear();
+        unsigned current = start;
+        path.push_back(graph.base + current);
+        while (current != goal)
+        {
+            if (path.size() > g.size())
+            {
+                valid = false;
+                return gave_up;
+            }
+            float best    = INFINITY;
+            unsigned next = current;
+            for (unsigned e = graph.edge_start[current]; e < graph.edge_start[current + 1]; e++)
+            {
+                float cost = Cost(e) + g[graph.edge_target[e]];
+                if (cost < best)
+                {
+                    best = cost;
+                    next = graph.edge_target[e];
+                }
+            }
+            if (best == INFINITY)
+                return no_path;
+            current = next;
+            path.push_back(graph.base + current);
+        }
+        return solved;
+    }
+};
+static incremental_planner dstar;
+
+// Everything a path search needs, copied on the game thread so the job pool never touches live nav state
+struct plan_request
+{
+    unsigned generation;
+    unsigned start, goal;
+    const CNavArea *graph_base;
+    Vector destination;
+    std::vector<unsigned> edge_start;
+    std::vector<unsigned> edge_target;
+    // Negative if the connection can't be used
+    std::vector<float> edge_cost;
+    std::vector<Vector> centers;
+    // Filled by the job, start to goal. Empty if there is no path
+    std::vector<unsigned> path;
+
+    void Solve()
+    {
+        // Plain A* with the same costs and estimate micropather uses
+        size_t areas = centers.size();
+        std::vector<float> g(areas, INFINITY);
+        std::vector<unsigned> parent(areas, UINT_MAX);
+        typedef std::tuple<float, float, unsigned> entry;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+        g[start] = 0.0f;
+        open.emplace(centers[start].DistTo(centers[goal]), 0.0f, start);
+        while (!open.empty())
+        {
+            auto [f, cost, u] = open.top();
+            open.pop();
+            if (u == goal)
+                break;
+            if (cost > g[u])
+                continue;
+            for (unsigned e = edge_start[u]; e < edge_start[u + 1]; e++)
+            {
+                if (edge_cost[e] < 0.0f)
+                    continue;
+                unsigned v = edge_target[e];
+                float next = cost + edge_cost[e];
+                if (next >= g[v])
+                    continue;
+                g[v]      = next;
+                parent[v] = u;
+                open.emplace(next + centers[v].DistTo(centers[goal]), next, v);
+            }
+        }
+        if (g[goal] == INFINITY)
+            return;
+        for (unsigned i = goal; i != UINT_MAX; i = parent[i])
+            path.push_back(i);
+        std::reverse(path.begin(), path.end());
+    }
+};
+// Bumped by every path change, results of older requests are dropped
+static unsigned plan_generation = 0;
+// Generation of the async repath still being solved, 0 if there is none
+static unsigned pending_repath = 0;
+static bool setPath(std::vector<CNavArea *> path, const Vector &destination, int priority, bool should_repath, bool nav_to_local, bool is_repath);
+
 struct Graph : public micropather::Graph
 {
     std::unique_ptr<micropather::MicroPather> pather;
@@ -412,25 +927,13 @@ struct Graph : public micropather::Graph
     void AdjacentCost(void *state, MP_VECTOR<micropather::StateCost> *adjacent) override
     {
         CNavArea *center = static_cast<CNavArea *>(state);
-        for (auto &i : center->m_connections)
+        unsigned index   = graph.Index(center);
+        for (unsigned e = graph.edge_start[index]; e < graph.edge_start[index + 1]; e++)
         {
-            CNavArea *neighbour = i.area;
-            int isIgnored       = ignoremanager::isIgnored(center, neighbour);
-            if (isIgnored == 2)
+            float distance = edgeCost(e);
+            if (distance < 0.0f)
                 continue;
-            float distance = center->m_center.DistTo(i.area->m_center);
-            if (isIgnored == 1)
-                distance += 2000;
-            // Check priority based on usage
-            else
-            {
-                float score = area_score[neighbour->m_id];
-                // Formula to calculate by how much % to reduce the distance by (https://xaktly.com/LogisticFunctions.html)
-                float multiplier = 2.0f * ((0.9f) / (1.0f + exp(-0.8f * score)) - 0.45f);
-                distance *= 1.0f - multiplier;
-            }
-
-            adjacent->emplace_back(micropather::StateCost{ reinterpret_cast<void *>(neighbour), distance });
+            adjacent->emplace_back(micropather::StateCost{ reinterpret_cast<void *>(graph.base + graph.edge_target[e]), distance });
         }
     }
     float LeastCostEstimate(void *stateStart, void *stateEnd) override
@@ -444,6 +947,269 @@ struct Graph : public micropather::Graph
     }
 };
 
+// Uniform XY grid over the nav areas, so lookups only visit areas near the query point
+struct area_grid
+{
+    static constexpr float CELL_SIZE = 256.0f;
+
+    CNavArea *base{ nullptr };
+    float min_x{ 0.0f }, min_y{ 0.0f };
+    int width{ 0 }, height{ 0 };
+    // Areas overlapping cell c are base + areas[cell_start[c]] .. base + areas[cell_start[c + 1] - 1]
+    flat_array<unsigned> cell_start;
+    flat_array<unsigned> areas;
+
+    void Build(std::vector<CNavArea> &nav_areas)
+    {
+        base  = nav_areas.data();
+        width = height = 0;
+        cell_start.Own({});
+        areas.Own({});
+        if (nav_areas.empty())
+            return;
+        float max_x = -FLT_MAX, max_y = -FLT_MAX;
+        min_x = min_y = FLT_MAX;
+        for (auto &i : nav_areas)
+        {
+            min_x = std::min({ min_x, i.m_nwCorner.x, i.m_seCorner.x });
+            min_y = std::min({ min_y, i.m_nwCorner.y, i.m_seCorner.y });
+            max_x = std::max({ max_x, i.m_nwCorner.x, i.m_seCorner.x });
+            max_y = std::max({ max_y, i.m_nwCorner.y, i.m_seCorner.y });
+        }
+        width  = int((max_x - min_x) / CELL_SIZE) + 1;
+        height = int((max_y - min_y) / CELL_SIZE) + 1;
+
+        // Count, prefix sum, fill
+        std::vector<unsigned> starts(width * height + 1, 0);
+        auto for_each_cell = [&](CNavArea &area, auto callback) {
+            int x0 = CellX(std::min(area.m_nwCorner.x, area.m_seCorner.x)), x1 = CellX(std::max(area.m_nwCorner.x, area.m_seCorner.x));
+            int y0 = CellY(std::min(area.m_nwCorner.y, area.m_seCorner.y)), y1 = CellY(std::max(area.m_nwCorner.y, area.m_seCorner.y));
+            for (int y = y0; y <= y1; y++)
+                for (int x = x0; x <= x1; x++)
+                    callback(y * width + x);
+        };
+        for (auto &i : nav_areas)
+            for_each_cell(i, [&](int cell) { starts[cell + 1]++; });
+        for (size_t i = 1; i < starts.size(); i++)
+            starts[i] += starts[i - 1];
+        std::vector<unsigned> entries(starts.back());
+        std::vector<unsigned> fill(starts.begin(), starts.end() - 1);
+        for (size_t i = 0; i < nav_areas.size(); i++)
+            for_each_cell(nav_areas[i], [&](int cell) { entries[fill[cell]++] = i; });
+        cell_start.Own(std::move(starts));
+        areas.Own(std::move(entries));
+    }
+    int CellX(float x) const
+    {
+        return std::clamp(int((x - min_x) / CELL_SIZE), 0, width - 1);
+    }
+    int CellY(float y) const
+    {
+        return std::clamp(int((y - min_y) / CELL_SIZE), 0, height - 1);
+    }
+    template <typename F> void ForCell(int x, int y, F callback) const
+    {
+        if (x < 0 || y < 0 || x >= width || y >= height)
+            return;
+        int cell = y * width + x;
+        for (unsigned i = cell_start[cell]; i < cell_start[cell + 1]; i++)
+            callback(base + areas[i]);
+    }
+    // Cells at chebyshev distance ring from (x, y)
+    template <typename F> void ForRing(int x, int y, int ring, F callback) const
+    {
+        if (!ring)
+            return ForCell(x, y, callback);
+        for (int i = -ring; i <= ring; i++)
+        {
+            ForCell(x + i, y - ring, callback);
+            ForCell(x + i, y + ring, callback);
+        }
+        for (int i = -ring + 1; i < ring; i++)
+        {
+            ForCell(x - ring, y + i, callback);
+            ForCell(x + ring, y + i, callback);
+        }
+    }
+};
+static area_grid grid;
+
+// Read only mapping of a whole file
+struct mapped_file
+{
+    const uint8_t *data{ nullptr };
+    size_t size{ 0 };
+
+    mapped_file() = default;
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+    ~mapped_file()
+    {
+        if (data)
+            munmap(const_cast<uint8_t *>(data), size);
+    }
+    bool Open(const char *path)
+    {
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) || st.st_size <= 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+        data = static_cast<const uint8_t *>(mapping);
+        size = st.st_size;
+        return true;
+    }
+};
+
+// Compiled graph and grid of a navfile, keyed by its contents. Mapped read only, so every bot on the map shares the pages
+namespace navcache
+{
+constexpr uint32_t MAGIC   = 0x4e544143; // "CATN"
+constexpr uint32_t VERSION = 1;
+
+struct header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t nav_hash;
+    uint32_t areas;
+    uint32_t edges;
+    float min_x, min_y;
+    int32_t width, height;
+    uint32_t grid_entries;
+    uint32_t reserved;
+};
+static_assert(sizeof(header) == 48, "Nav cache header layout changed");
+
+// Followed by edge_start, edge_source, edge_target, pred_start, pred_edge, edge_length, cell_start, grid areas and edge_flags
+static size_t FileSize(const header &h)
+{
+    size_t words = 2 * (size_t(h.areas) + 1) + 4 * size_t(h.edges) + size_t(h.width) * h.height + 1 + h.grid_entries;
+    return sizeof(header) + words * 4 + h.edges;
+}
+
+// The graph and grid point into this while it's loaded
+static std::unique_ptr<mapped_file> mapping;
+
+// FNV-1a
+static uint64_t Hash(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+static std::string Path(const char *level, uint64_t hash)
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "-%016llx.bin", (unsigned long long) hash);
+    return paths::getDataPath("/navcache/") + level + name;
+}
+
+template <typename T> static void Take(flat_array<T> &array, const uint8_t *&cursor, size_t count)
+{
+    array.View(reinterpret_cast<const T *>(cursor), count);
+    cursor += count * sizeof(T);
+}
+
+static bool Load(const std::string &path, uint64_t hash, std::vector<CNavArea> &areas, nav_graph &out_graph, area_grid &out_grid)
+{
+    auto file = std::make_unique<mapped_file>();
+    if (!file->Open(path.c_str()) || file->size < sizeof(header))
+        return false;
+    header h;
+    std::memcpy(&h, file->data, sizeof(h));
+    size_t edges = 0;
+    for (auto &area : areas)
+        edges += area.m_connections.size();
+    if (h.magic != MAGIC || h.version != VERSION || h.nav_hash != hash || h.areas != areas.size() || h.edges != edges || h.width <= 0 || h.height <= 0 || file->size != FileSize(h))
+        return false;
+
+    const uint8_t *cursor = file->data + sizeof(header);
+    Take(out_graph.edge_start, cursor, h.areas + 1);
+    Take(out_graph.edge_source, cursor, h.edges);
+    Take(out_graph.edge_target, cursor, h.edges);
+    Take(out_graph.pred_start, cursor, h.areas + 1);
+    Take(out_graph.pred_edge, cursor, h.edges);
+    Take(out_graph.edge_length, cursor, h.edges);
+    Take(out_grid.cell_start, cursor, size_t(h.width) * h.height + 1);
+    Take(out_grid.areas, cursor, h.grid_entries);
+    Take(out_graph.edge_flags, cursor, h.edges);
+    if (out_graph.edge_start[h.areas] != h.edges || out_graph.pred_start[h.areas] != h.edges || out_grid.cell_start[size_t(h.width) * h.height] != h.grid_entries)
+        return false;
+
+    out_graph.InitState(areas);
+    out_grid.base   = areas.data();
+    out_grid.min_x  = h.min_x;
+    out_grid.min_y  = h.min_y;
+    out_grid.width  = h.width;
+    out_grid.height = h.height;
+    mapping         = std::move(file);
+    return true;
+}
+
+// Held while loading or compiling a map, so bots joining the same map at once only compile it once
+struct build_lock
+{
+    int fd{ -1 };
+
+    explicit build_lock(const std::string &path)
+    {
+        if (path.empty())
+            return;
+        mkdir(paths::getDataPath("/navcache").c_str(), S_IRWXU | S_IRWXG);
+        fd = ::open((path + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0660);
+        // Released by the kernel if the bot holding it dies
+        if (fd >= 0 && flock(fd, LOCK_EX))
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    build_lock(const build_lock &) = delete;
+    build_lock &operator=(const build_lock &) = delete;
+    ~build_lock()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+};
+
+static void Save(const std::string &path, uint64_t hash, const nav_graph &from_graph, const area_grid &from_grid)
+{
+    // Other bots may be writing the same file, only ever rename complete ones into place
+    std::string temp = path + "." + std::to_string(getpid());
+    std::ofstream out(temp, std::ios::binary);
+    header h{ MAGIC, VERSION, hash, uint32_t(from_graph.area_danger.size()), uint32_t(from_graph.edge_target.size()), from_grid.min_x, from_grid.min_y, from_grid.width, from_grid.height, uint32_t(from_grid.areas.size()), 0 };
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    auto put = [&](auto &array) { out.write(reinterpret_cast<const char *>(array.begin()), array.size() * sizeof(array[0])); };
+    put(from_graph.edge_start);
+    put(from_graph.edge_source);
+    put(from_graph.edge_target);
+    put(from_graph.pred_start);
+    put(from_graph.pred_edge);
+    put(from_graph.edge_length);
+    put(from_grid.cell_start);
+    put(from_grid.areas);
+    put(from_graph.edge_flags);
+    out.close();
+    if (!out || std::rename(temp.c_str(), path.c_str()))
+    {
+        logging::Info("Pather: Failed to write nav cache %s", path.c_str());
+        std::remove(temp.c_str());
+    }
+}
+} // namespace navcache
+
 // Navfile containing areas
 std::unique_ptr<CNavFile> navfile;
 // Status
@@ -480,19 +1246,76 @@ void initThread()
         status = unavailable;
         return;
     }
-    logging::Info("Pather: Initing with %i Areas", navfile->m_areas.size());
+    auto &areas = navfile->m_areas;
+    logging::Info("Pather: Initing with %i Areas", areas.size());
+
+    std::string cache_path;
+    uint64_t nav_hash = 0;
+    if (nav_cache && !areas.empty())
+    {
+        mapped_file contents;
+        if (contents.Open(nav_path))
+        {
+            nav_hash   = navcache::Hash(contents.data, contents.size);
+            p          = std::strrchr(lvl_name, '/');
+            cache_path = navcache::Path(p ? p + 1 : lvl_name, nav_hash);
+        }
+    }
+    area_grid new_grid;
+    nav_graph new_graph;
+    {
+        // The first bot on the map compiles it, the others wait here and map its file
+        navcache::build_lock lock(cache_path);
+        if (!cache_path.empty() && navcache::Load(cache_path, nav_hash, areas, new_graph, new_grid))
+            logging::Info("Pather: Loaded compiled nav from %s", cache_path.c_str());
+        else
+        {
+#if ENABLE_IPC
+            // Bots on other maps compile at the same time after a map change, take turns instead. Fine to wait here,
+            // this isn't a pool worker
+            ipc::scheduler::Begin(ipc::scheduler::nav_compile, 30000, 20000);
+#endif
+            new_grid.Build(areas);
+            new_graph.Build(areas);
+            if (!cache_path.empty())
+                navcache::Save(cache_path, nav_hash, new_graph, new_grid);
+#if ENABLE_IPC
+            ipc::scheduler::End(ipc::scheduler::nav_compile);
+#endif
+        }
+    }
+    grid  = std::move(new_grid);
+    graph = std::move(new_graph);
+    area_score.assign(areas.size(), 0.0f);
     status = on;
 }
 
+// initThread can wait on another bot's compile and the nav_compile lease for a long time, so it gets its own
+// thread instead of holding up a pool worker
+static std::thread init_worker;
+
+static void JoinInit()
+{
+    if (init_worker.joinable())
+        init_worker.join();
+}
+
 void init()
 {
+    // Only ever one build, the previous one writes the same globals
+    JoinInit();
     area_score.clear();
+    // Points into the old navfile
+    grid  = area_grid();
+    graph = nav_graph();
+    navcache::mapping.reset();
+    dstar.valid = false;
+    ignoremanager::danger_sources.clear();
+    player_areas.fill(nullptr);
     endPoint.Invalidate();
     ignoremanager::reset();
-    status = initing;
-    std::thread thread;
-    thread = std::thread(initThread);
-    thread.detach();
+    status      = initing;
+    init_worker = std::thread(initThread);
 }
 
 bool prepare()
@@ -509,6 +1332,31 @@ bool prepare()
     return false;
 }
 
+// Search outwards until no unvisited cell can hold anything closer
+static CNavArea *closestCenter(const Vector &vec, CNavArea *skip)
+{
+    int cell_x = grid.CellX(vec.x), cell_y = grid.CellY(vec.y);
+    CNavArea *best = nullptr;
+    float bestDist = FLT_MAX;
+    int max_ring   = std::max(grid.width, grid.height);
+    for (int ring = 0; ring <= max_ring; ring++)
+    {
+        if (best && bestDist <= (ring - 1) * area_grid::CELL_SIZE)
+            break;
+        grid.ForRing(cell_x, cell_y, ring, [&](CNavArea *area) {
+            if (area == skip)
+                return;
+            float dist = area->m_center.DistTo(vec);
+            if (dist < bestDist)
+            {
+                bestDist = dist;
+                best     = area;
+            }
+        });
+    }
+    return best;
+}
+
 // This prevents the bot from gettings completely stuck in some cases
 static std::vector<CNavArea *> findClosestNavSquare_localAreas(6);
 
@@ -518,38 +1366,45 @@ CNavArea *findClosestNavSquare(const Vector &vec)
     bool isLocal = vec == g_pLocalPlayer->v_Origin;
     if (isLocal && findClosestNavSquare_localAreas.size() > 5)
         findClosestNavSquare_localAreas.erase(findClosestNavSquare_localAreas.begin());
+    if (!grid.width)
+        return nullptr;
 
-    float ovBestDist = FLT_MAX, bestDist = FLT_MAX;
-    // If multiple candidates for LocalNav have been found, pick the closest
-    CNavArea *ovBestSquare = nullptr, *bestSquare = nullptr;
-    for (auto &i : navfile->m_areas)
-    {
-        // Make sure we're not stuck on the same area for too long
-        if (isLocal && std::count(findClosestNavSquare_localAreas.begin(), findClosestNavSquare_localAreas.end(), &i) >= 3)
-        {
-            continue;
-        }
-        float dist = i.m_center.DistTo(vec);
-        if (dist < bestDist)
-        {
-            bestDist   = dist;
-            bestSquare = &i;
-        }
-        // Check if we are within x and y bounds of an area
-        if (ovBestDist >= dist || !i.IsOverlapping(vec) || !IsVectorVisibleNavigation(vec, i.m_center, MASK_PLAYERSOLID))
+    // Make sure we're not stuck on the same area for too long. The history holds at most 5 areas, so at most one can be there 3 times
+    CNavArea *stuck_area = nullptr;
+    if (isLocal)
+        for (auto area : findClosestNavSquare_localAreas)
+            if (std::count(findClosestNavSquare_localAreas.begin(), findClosestNavSquare_localAreas.end(), area) >= 3)
+            {
+                stuck_area = area;
+                break;
+            }
+
+    int cell_x = grid.CellX(vec.x), cell_y = grid.CellY(vec.y);
+
+    // Areas we are within x and y bounds of all share our cell. If multiple are found, pick the closest visible one
+    std::array<std::pair<float, CNavArea *>, 16> overlapping;
+    size_t overlapping_count = 0;
+    grid.ForCell(cell_x, cell_y, [&](CNavArea *area) {
+        if (area != stuck_area && overlapping_count < overlapping.size() && area->IsOverlapping(vec))
+            overlapping[overlapping_count++] = { area->m_center.DistTo(vec), area };
+    });
+    std::sort(overlapping.begin(), overlapping.begin() + overlapping_count, [](const std::pair<float, CNavArea *> &a, const std::pair<float, CNavArea *> &b) { return a.first < b.first; });
+    CNavArea *bestSquare = nullptr;
+    for (size_t i = 0; i < overlapping_count; i++)
+        if (IsVectorVisibleNavigation(vec, overlapping[i].second->m_center, MASK_PLAYERSOLID))
         {
-            continue;
+            bestSquare = overlapping[i].second;
+            break;
         }
-        ovBestDist   = dist;
-        ovBestSquare = &i;
-    }
-    if (!ovBestSquare)
-        ovBestSquare = bestSquare;
+
+    // Otherwise the closest center
+    if (!bestSquare)
+        bestSquare = closestCenter(vec, stuck_area);
 
     if (isLocal)
-        findClosestNavSquare_localAreas.push_back(ovBestSquare);
+        findClosestNavSquare_localAreas.push_back(bestSquare);
 
-    return ovBestSquare;
+    return bestSquare;
 }
 
 std::vector<CNavArea *> findPath(const Vector &start, const Vector &end)
@@ -572,8 +1427,23 @@ std::vector<CNavArea *> findPath(const Vector &start, const Vector &end)
     std::vector<CNavArea *> pathNodes;
 
     time_point begin_pathing = high_resolution_clock::now();
-    int result               = Map.pather->Solve(reinterpret_cast<void *>(local), reinterpret_cast<void *>(dest), reinterpret_cast<std::vector<void *> *>(&pathNodes), &cost);
-    long long timetaken      = duration_cast<nanoseconds>(high_resolution_clock::now() - begin_pathing).count();
+    if (*planner == 1)
+    {
+        auto result         = dstar.Plan(local, dest, pathNodes);
+        long long timetaken = duration_cast<nanoseconds>(high_resolution_clock::now() - begin_pathing).count();
+        if (log_pathing)
+            logging::Info("Pathing: Incremental result: %i. Time taken (NS): %lld", result, timetaken);
+        if (result == incremental_planner::solved || result == incremental_planner::no_path)
+            countSolve(timetaken);
+        if (result == incremental_planner::solved)
+            return pathNodes;
+        if (result == incremental_planner::no_path)
+            return {};
+        pathNodes.clear();
+    }
+    int result          = Map.pather->Solve(reinterpret_cast<void *>(local), reinterpret_cast<void *>(dest), reinterpret_cast<std::vector<void *> *>(&pathNodes), &cost);
+    long long timetaken = duration_cast<nanoseconds>(high_resolution_clock::now() - begin_pathing).count();
+    countSolve(timetaken);
     if (log_pathing)
         logging::Info("Pathing: Pather result: %i. Time taken (NS): %lld", result, timetaken);
     // If no result found, return empty Vector
@@ -601,6 +1471,13 @@ bool navTo(const Vector &destination, int priority, bool should_repath, bool nav
         clearInstructions();
         return false;
     }
+    return setPath(std::move(path), destination, priority, should_repath, nav_to_local, is_repath);
+}
+
+static bool setPath(std::vector<CNavArea *> path, const Vector &destination, int priority, bool should_repath, bool nav_to_local, bool is_repath)
+{
+    // Whatever is still being planned is outdated now
+    plan_generation++;
     auto crumb = crumbs.begin();
     if (crumb != crumbs.end() && ignoremanager::addTime(last_area, *crumb, inactivity))
         ResetPather();
@@ -625,6 +1502,61 @@ bool navTo(const Vector &destination, int priority, bool should_repath, bool nav
     return true;
 }
 
+static void repathAsync(const Vector &destination)
+{
+    // Every stuck tick asks again, a new request would only throw away the one that is almost done
+    if (pending_repath && pending_repath == plan_generation)
+        return;
+    CNavArea *local, *dest;
+    if (!(local = findClosestNavSquare(g_pLocalPlayer->v_Origin)) || !(dest = findClosestNavSquare(destination)))
+    {
+        clearInstructions();
+        return;
+    }
+    auto request         = std::make_shared<plan_request>();
+    request->generation  = ++plan_generation;
+    pending_repath       = request->generation;
+    request->start       = graph.Index(local);
+    request->goal        = graph.Index(dest);
+    request->graph_base  = graph.base;
+    request->destination = destination;
+    request->edge_start.assign(graph.edge_start.begin(), graph.edge_start.end());
+    request->edge_target.assign(graph.edge_target.begin(), graph.edge_target.end());
+    request->edge_cost.resize(graph.edge_target.size());
+    // Unchecked connections count as visible, checkPath vischecks the crumbs once we follow them
+    for (unsigned e = 0; e < graph.edge_target.size(); e++)
+        request->edge_cost[e] = edgeCost(e, false);
+    request->centers.reserve(navfile->m_areas.size());
+    for (auto &i : navfile->m_areas)
+        request->centers.push_back(i.m_center);
+    int priority = curr_priority;
+    // Give the solve the full stuck time before it counts as stuck again
+    inactivity.update();
+
+    jobs::Background([request, priority]() {
+        auto begin = std::chrono::steady_clock::now();
+        request->Solve();
+        countSolve(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+        jobs::Defer([request, priority]() {
+            if (request->generation == pending_repath)
+                pending_repath = 0;
+            // Replaced by navTo, cancelled, or the level changed while solving
+            if (request->generation != plan_generation || request->graph_base != graph.base || status != on)
+                return;
+            if (request->path.empty())
+            {
+                clearInstructions();
+                return;
+            }
+            std::vector<CNavArea *> path;
+            path.reserve(request->path.size());
+            for (unsigned i : request->path)
+                path.push_back(graph.base + i);
+            setPath(std::move(path), request->destination, priority, true, true, true);
+        });
+    });
+}
+
 void repath()
 {
     if (!ensureArrival)
@@ -638,43 +1570,310 @@ void repath()
     else
         return;
 
+    stats.repaths.fetch_add(1, std::memory_order_relaxed);
+    if (*async_repath)
+    {
+        // Keep walking the old crumbs until the new ones are published
+        repathAsync(last);
+        return;
+    }
     clearInstructions();
     ResetPather();
     navTo(last, curr_priority, true, true, true);
 }
 
+// Whether someone standing at origin is on area, with some room for jumping and slopes
+static bool isOnArea(CNavArea *area, const Vector &origin)
+{
+    return area->IsOverlapping(origin) && origin.z >= std::min(area->m_nwCorner.z, area->m_seCorner.z) - 18.0f && origin.z <= std::max(area->m_nwCorner.z, area->m_seCorner.z) + 72.0f;
+}
+
+// Players mostly stay on their area or walk onto a neighbour, so only look further when that fails
+static CNavArea *trackArea(CNavArea *previous, const Vector &origin)
+{
+    if (previous)
+    {
+        if (isOnArea(previous, origin))
+            return previous;
+        for (auto &i : previous->m_connections)
+            if (isOnArea(i.area, origin))
+                return i.area;
+    }
+    CNavArea *found = nullptr;
+    grid.ForCell(grid.CellX(origin.x), grid.CellY(origin.y), [&](CNavArea *area) {
+        if (!found && isOnArea(area, origin))
+            found = area;
+    });
+    return found;
+}
+
+CNavArea *findArea(const Vector &origin, CNavArea *previous)
+{
+    if (!grid.width || status != on)
+        return nullptr;
+    CNavArea *area = trackArea(previous, origin);
+    return area ? area : closestCenter(origin, nullptr);
+}
+
+CNavArea *findAreaOn(const Vector &origin, CNavArea *previous)
+{
+    if (!grid.width || status != on)
+        return nullptr;
+    return trackArea(previous, origin);
+}
+
+std::vector<float> pathDistances(CNavArea *start, const std::vector<CNavArea *> &targets)
+{
+    std::vector<float> result(targets.size(), INFINITY);
+    if (status != on || !start || graph.Index(start) >= graph.area_factor.size())
+        return result;
+    // Dijkstra from start until every target is settled
+    size_t remaining = 0;
+    std::unordered_map<unsigned, std::vector<size_t>> wanted;
+    for (size_t i = 0; i < targets.size(); i++)
+        if (targets[i])
+        {
+            wanted[graph.Index(targets[i])].push_back(i);
+            remaining++;
+        }
+    std::vector<float> dist(graph.area_factor.size(), INFINITY);
+    std::priority_queue<std::pair<float, unsigned>, std::vector<std::pair<float, unsigned>>, std::greater<std::pair<float, unsigned>>> queue;
+    dist[graph.Index(start)] = 0.0f;
+    queue.push({ 0.0f, graph.Index(start) });
+    while (!queue.empty() && remaining)
+    {
+        auto [d, area] = queue.top();
+        queue.pop();
+        if (d > dist[area])
+            continue;
+        auto found = wanted.find(area);
+        if (found != wanted.end())
+        {
+            for (size_t i : found->second)
+                result[i] = d;
+            remaining -= found->second.size();
+            wanted.erase(found);
+        }
+        for (unsigned e = graph.edge_start[area]; e < graph.edge_start[area + 1]; e++)
+        {
+            // No vischecks for the connections we haven't tried yet, this runs for every candidate at once
+            float cost = edgeCost(e, false);
+            if (cost < 0.0f)
+                continue;
+            unsigned target = graph.edge_target[e];
+            if (d + cost < dist[target])
+            {
+                dist[target] = d + cost;
+                queue.push({ dist[target], target });
+            }
+        }
+    }
+    return result;
+}
+
 // Track pather resets
 static Timer reset_pather_timer{};
+// Ticks between updateAreaScore runs
+constexpr unsigned AREA_SCORE_RATE = 6;
 // Update area score to prefer paths used by actual players a bit more
 void updateAreaScore()
 {
-    for (int i = 1; i <= g_IEngine->GetMaxClients(); i++)
+    if (!enabled || status != on)
+        return;
+    int max_clients = std::min(g_IEngine->GetMaxClients(), MAX_PLAYERS);
+    for (int i = 1; i <= max_clients; i++)
     {
         CachedEntity *ent = ENTITY(i);
         if (i == g_pLocalPlayer->entity_idx || CE_INVALID(ent) || !g_pPlayerResource->isAlive(i))
+        {
+            player_areas[i] = nullptr;
+            continue;
+        }
+        auto origin = ent->m_vecDormantOrigin();
+        if (!origin)
             continue;
 
-        // Get area
-        CNavArea *closest_area = nullptr;
-        if (ent->m_vecDormantOrigin())
-            findClosestNavSquare(*ent->m_vecDormantOrigin());
-
+        player_areas[i] = trackArea(player_areas[i], *origin);
         // Add usage to area if valid
-        if (closest_area)
-            area_score[closest_area->m_id] += g_GlobalVars->interval_per_tick;
+        if (player_areas[i])
+        {
+            unsigned index = graph.Index(player_areas[i]);
+            area_score[index] += g_GlobalVars->interval_per_tick * AREA_SCORE_RATE;
+            float factor = scoreFactor(area_score[index]);
+            // Tiny changes aren't worth throwing the cached paths away for
+            if (std::fabs(factor - graph.area_factor[index]) > 0.01f)
+            {
+                graph.area_factor[index] = factor;
+                graph.costs_changed      = true;
+            }
+        }
     }
-    if (reset_pather_timer.test_and_set(10000))
+    if (graph.costs_changed && reset_pather_timer.test_and_set(10000))
         ResetPather();
 }
 
+// Local avoidance for players and buildings standing in the way, so transient blockages don't cost a full repath
+namespace steering
+{
+static settings::Boolean enabled{ "misc.pathing.steering", "true" };
+// How long a dynamic blockage may hold up the stuck detection before the planner takes over
+static settings::Int hold_time{ "misc.pathing.steering.hold-time", "1500" };
+
+constexpr float RANGE   = 200.0f;
+constexpr float RADIUS  = 24.0f;
+constexpr float HORIZON = 1.0f;
+constexpr float SPEED   = 300.0f;
+// Candidate headings get tested in both directions in these steps
+constexpr float STEP        = 15.0f;
+constexpr int MAX_STEPS     = 6;
+constexpr int MAX_OBSTACLES = 16;
+
+struct obstacle
+{
+    Vector2D pos;
+    Vector2D vel;
+    float radius;
+};
+static std::array<obstacle, MAX_OBSTACLES> obstacles;
+static int obstacle_count = 0;
+
+// Dynamic blockage episode, started when the direct heading runs into an obstacle
+static bool blocked    = false;
+static bool deferred   = false;
+static Timer blocked_since{};
+static unsigned avoided   = 0;
+static unsigned escalated = 0;
+
+static void Gather(const Vector &origin)
+{
+    obstacle_count = 0;
+    for (int i = 1; i <= HIGHEST_ENTITY && obstacle_count < MAX_OBSTACLES; i++)
+    {
+        CachedEntity *ent = ENTITY_UNCHECKED(i);
+        if (ent == LOCAL_E || CE_BAD(ent))
+            continue;
+        auto type = ent->m_Type();
+        if (type != ENTITY_PLAYER && type != ENTITY_BUILDING)
+            continue;
+        if (type == ENTITY_PLAYER && !ent->m_bAlivePlayer())
+            continue;
+        const Vector &pos = ent->m_vecOrigin();
+        if (std::fabs(pos.z - origin.z) > 72.0f || pos.AsVector2D().DistTo(origin.AsVector2D()) > RANGE)
+            continue;
+
+        obstacle &o = obstacles[obstacle_count++];
+        o.pos       = pos.AsVector2D() - origin.AsVector2D();
+        o.vel.Init();
+        o.radius = RADIUS * 2.0f;
+        if (type == ENTITY_PLAYER)
+        {
+            Vector vel;
+            velocity::Get(ent, vel);
+            o.vel = vel.AsVector2D();
+        }
+        // Sentries and dispensers are a lot wider than a player
+        else if (type == ENTITY_BUILDING)
+            o.radius += 16.0f;
+    }
+}
+
+// Does moving along dir put us inside an obstacle's velocity obstacle within the horizon?
+static bool Collides(const Vector2D &dir)
+{
+    for (int i = 0; i < obstacle_count; i++)
+    {
+        const obstacle &o = obstacles[i];
+        Vector2D rel      = dir * SPEED - o.vel;
+        float speed       = rel.Length();
+        if (speed < 1.0f)
+            continue;
+        rel /= speed;
+        float along = o.pos.Dot(rel);
+        if (along < 0.0f || along - o.radius > speed * HORIZON)
+            continue;
+        Vector2D closest = rel * along - o.pos;
+        if (closest.LengthSqr() < o.radius * o.radius)
+            return true;
+    }
+    return false;
+}
+
+// Returns the point WalkTo should head for instead of the crumb
+static Vector Steer(const Vector &target)
+{
+    const Vector &origin = g_pLocalPlayer->v_Origin;
+    Vector2D delta       = target.AsVector2D() - origin.AsVector2D();
+    float dist           = delta.Length();
+    if (!enabled || dist < 1.0f)
+    {
+        blocked = false;
+        return target;
+    }
+    Gather(origin);
+    Vector2D dir = delta / dist;
+    if (!obstacle_count || !Collides(dir))
+    {
+        if (blocked && deferred)
+        {
+            // Got around it without the planner, so the stuck detection starts over
+            avoided++;
+            inactivity.update();
+        }
+        blocked = false;
+        return target;
+    }
+    if (!blocked)
+    {
+        blocked  = true;
+        deferred = false;
+        blocked_since.update();
+    }
+    float base = RAD2DEG(std::atan2(dir.y, dir.x));
+    for (int step = 1; step <= MAX_STEPS; step++)
+    {
+        for (int side = -1; side <= 1; side += 2)
+        {
+            float yaw = DEG2RAD(base + side * step * STEP);
+            Vector2D candidate(std::cos(yaw), std::sin(yaw));
+            if (Collides(candidate))
+                continue;
+            return { origin.x + candidate.x * dist, origin.y + candidate.y * dist, target.z };
+        }
+    }
+    // Boxed in, wait for them to move
+    return target;
+}
+
+// Should the stuck detection wait for the local avoidance to sort things out?
+static bool Hold()
+{
+    if (!blocked || blocked_since.check(*hold_time))
+        return false;
+    deferred = true;
+    return true;
+}
+
+static void Escalate()
+{
+    if (blocked)
+        escalated++;
+    blocked  = false;
+    deferred = false;
+}
+
+static void Reset()
+{
+    blocked  = false;
+    deferred = false;
+}
+} // namespace steering
+
 static Timer last_jump{};
 // Main movement function, gets path from NavTo
 static void cm()
 {
     if (!enabled || status != on)
         return;
-    // Run the logic for Nav area score
-    updateAreaScore();
 
     if (CE_BAD(LOCAL_E) || CE_BAD(LOCAL_W))
         return;
@@ -751,14 +1950,18 @@ static void cm()
             flip_action = !flip_action;
         }
     }
-    // Walk to next crumb
-    WalkTo(*crumb_vec);
+    // Walk to next crumb, around whoever is standing in the way
+    WalkTo(steering::Steer(*crumb_vec));
     /* If can't go through for some time (doors aren't instantly opening)
      * ignore that connection
      * Or if inactive for too long
      */
     if (inactivity.check(*stuck_time) || (inactivity.check(*unreachable_time) && !IsVectorVisible(g_pLocalPlayer->v_Origin, *crumb_vec + Vector(.0f, .0f, 41.5f), false, LOCAL_E, MASK_PLAYERSOLID)))
     {
+        // Players and buildings move or die, give the local avoidance a chance first
+        if (steering::Hold())
+            return;
+        steering::Escalate();
         /* crumb is invalid if endPoint is used */
         if (crumb_vec != &endPoint)
             ignoremanager::addTime(last_area, *crumb, inactivity);
@@ -771,7 +1974,7 @@ static void cm()
 #if ENABLE_VISUALS
 static void drawcrumbs()
 {
-    if (!enabled || !draw)
+    if (!enabled || !draw || governor::Degraded(governor::NO_VISUALISERS))
         return;
     if (CE_BAD(LOCAL_E) || CE_BAD(LOCAL_W))
         return;
@@ -779,28 +1982,28 @@ static void drawcrumbs()
         return;
     if (crumbs.size() < 2)
         return;
-    for (size_t i = 0; i < crumbs.size(); i++)
+    // Project the whole path at once, the end point closes it if there is one
+    static std::vector<Vector> points, screen;
+    static std::vector<uint8_t> visible;
+    points.clear();
+    for (auto crumb : crumbs)
+        points.push_back(crumb->m_center);
+    if (endPoint.IsValid())
+        points.push_back(endPoint);
+    screen.resize(points.size());
+    visible.resize(points.size());
+    draw::WorldToScreenBatch(points.data(), points.size(), screen.data(), visible.data());
+
+    for (size_t i = 0; i + 1 < points.size(); i++)
     {
-        Vector wts1, wts2, *o1, *o2;
-        if (crumbs.size() - 1 == i)
-        {
-            if (!endPoint.IsValid())
-                break;
-
-            o2 = &endPoint;
-        }
-        else
-            o2 = &crumbs[i + 1]->m_center;
-
-        o1 = &crumbs[i]->m_center;
-        if (draw::WorldToScreen(*o1, wts1) && draw::WorldToScreen(*o2, wts2))
+        if (visible[i] && visible[i + 1])
         {
-            draw::Line(wts1.x, wts1.y, wts2.x - wts1.x, wts2.y - wts1.y, colors::white, 0.3f);
+            draw::Line(screen[i].x, screen[i].y, screen[i + 1].x - screen[i].x, screen[i + 1].y - screen[i].y, colors::white, 0.3f);
         }
     }
-    Vector wts;
-    if (!draw::WorldToScreen(crumbs[0]->m_center, wts))
+    if (!visible[0])
         return;
+    const Vector &wts = screen[0];
     draw::Rectangle(wts.x - 4, wts.y - 4, 8, 8, colors::white);
     draw::RectangleOutlined(wts.x - 4, wts.y - 4, 7, 7, colors::white, 1.0f);
 }
@@ -808,6 +2011,11 @@ static void drawcrumbs()
 
 static InitRoutine runinit([]() {
     EC::Register(EC::CreateMove, cm, "cm_navparser", EC::average);
+    EC::Register(EC::Shutdown, JoinInit, "shutdown_navparser");
+    // Runs before cm_navparser on the ticks it runs, same as when it was called from there
+    EC::Register(EC::CreateMove, updateAreaScore, "cm_navparser_areascore", EC::every_ticks(AREA_SCORE_RATE), EC::early);
+    // Dormant origins come from the sound cache, which expires entries as they get read
+    EC::Declare(EC::CreateMove, "cm_navparser_areascore", { EC::res_snapshot | EC::res_nav | EC::res_sounds, EC::res_nav | EC::res_sounds });
 #if ENABLE_VISUALS
     EC::Register(EC::Draw, drawcrumbs, "draw_navparser", EC::average);
 #endif
@@ -815,6 +2023,7 @@ static InitRoutine runinit([]() {
 
 void ResetPather()
 {
+    graph.costs_changed = false;
     Map.pather->Reset();
 }
 
@@ -853,9 +2062,13 @@ static CatCommand nav_reset_ignores("nav_reset_ignores", "Reset all ignores.", [
 
 void clearInstructions()
 {
+    plan_generation++;
     crumbs.clear();
     endPoint.Invalidate();
     curr_priority = 0;
+    steering::Reset();
 }
 static CatCommand nav_stop("nav_cancel", "Cancel Navigation", []() { clearInstructions(); });
+
+static CatCommand nav_steering_stats("nav_steering_stats", "Show how many stuck events local avoidance resolved", []() { logging::Info("Avoided: %u, escalated to the planner: %u", steering::avoided, steering::escalated); });
 } // namespace nav
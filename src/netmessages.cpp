@@ -0,0 +1,41 @@
+#include "common.hpp"
+#include "netmessages.hpp"
+
+namespace net_messages
+{
+// Covers every message type the engine has
+constexpr int TYPE_COUNT = 32;
+
+struct subscriber_s
+{
+    enum EC::ec_priority priority;
+    callback_t callback;
+};
+
+static std::vector<subscriber_s> &Subscribers(int type)
+{
+    static std::vector<subscriber_s> table[TYPE_COUNT]{};
+    return table[type];
+}
+
+void Subscribe(int type, callback_t callback, enum EC::ec_priority priority)
+{
+    if (type < 0 || type >= TYPE_COUNT)
+    {
+        logging::Info("net_messages: can't subscribe to type %d", type);
+        return;
+    }
+    auto &subscribers = Subscribers(type);
+    subscribers.push_back({ priority, std::move(callback) });
+    std::stable_sort(subscribers.begin(), subscribers.end(), [](const subscriber_s &a, const subscriber_s &b) { return a.priority < b.priority; });
+}
+
+void Dispatch(outgoing_s &message)
+{
+    if (message.type < 0 || message.type >= TYPE_COUNT)
+        return;
+    for (auto &subscriber : Subscribers(message.type))
+        if (subscriber.callback(message))
+            return;
+}
+} // namespace net_messages
@@ -23,12 +23,11 @@
 #include "common.hpp"
 #include "crits.hpp"
 #include "DetourHook.hpp"
-#include <regex>
-#include <boost/algorithm/string.hpp>
 #include "usercmd.hpp"
 #include "MiscTemporary.hpp"
 #include "AntiAim.hpp"
 #include "WeaponData.hpp"
+#include "netmessages.hpp"
 
 namespace hacks::tf2::nospread
 {
@@ -60,12 +59,12 @@ bool shouldNoSpread(bool _projectile)
         break;
     // Disable if being spectated in first person
     case 1:
-        if (g_pLocalPlayer->spectator_state == g_pLocalPlayer->FIRSTPERSON)
+        if (spectators::LocalState() == spectators::FIRSTPERSON)
             return false;
         break;
     // Disable if being spectated
     case 2:
-        if (g_pLocalPlayer->spectator_state != g_pLocalPlayer->NONE)
+        if (spectators::LocalState() != spectators::NONE)
             return false;
     };
     return _projectile ? *projectile : *bullet;
@@ -368,9 +367,8 @@ typedef void (*FX_FireBullets_t)(IClientEntity *, int, Vector *, Vector *, int,
 // DetourHook net_sendpacket_detour;
 // typedef int (*NET_SendPacket_t)(INetChannel *, int, const netadr_t &, const unsigned char *, int, bf_write *, bool);
 
-// false == unchanged, true == Force reliable
-// We force the clc_move as a reliable message here to ensure its arrival before we call the original
-bool SendNetMessage(INetMessage *data)
+// Only sees clc_Move. We force it as a reliable message here to ensure its arrival before we call the original
+static bool SendNetMessage(net_messages::outgoing_s &message)
 {
     if (!bullet)
         return false;
@@ -378,20 +376,13 @@ bool SendNetMessage(INetMessage *data)
     // if we send clc_move with playerperf command or corrected angles, we must ensure it will be sent via reliable stream
     if (should_update_time)
     {
-        if (data->GetType() != clc_Move)
-            return false;
-
         // and wait for post call
         waiting_for_post_SNM = true;
 
-        // Force reliable
+        // Force reliable, and don't let warp touch it
+        message.force_reliable = true;
         return true;
     }
-    else if (no_spread_synced)
-    {
-        if (data->GetType() != clc_Move)
-            return false;
-    }
     return false;
 }
 
@@ -433,71 +424,105 @@ CatCommand debug_flows("debug_flows", "debug", []() { logging::Info("Incoming: %
 
 // false == don't call original, true == call original
 // This function is used to parse the playerperf data
-bool DispatchUserMessage(bf_read *buf, int type)
+// Digits '.' digits, the way playerperf prints floats
+static bool ParseDecimal(const char *&at, const char *end, double *out = nullptr)
+{
+    const char *begin = at;
+    while (at < end && isdigit(*at))
+        at++;
+    if (at == begin || at == end || *at != '.')
+        return false;
+    const char *fraction = ++at;
+    while (at < end && isdigit(*at))
+        at++;
+    if (at == fraction)
+        return false;
+    if (out)
+        *out = std::strtod(begin, nullptr);
+    return true;
+}
+
+// One or two digits
+static bool ParseSmall(const char *&at, const char *end)
+{
+    const char *begin = at;
+    while (at < end && at - begin < 3 && isdigit(*at))
+        at++;
+    return at - begin == 1 || at - begin == 2;
+}
+
+static bool ParseLiteral(const char *&at, const char *end, const char *literal)
+{
+    size_t length = strlen(literal);
+    if (size_t(end - at) < length || strncmp(at, literal, length))
+        return false;
+    at += length;
+    return true;
+}
+
+enum perf_line
+{
+    perf_none,
+    // "<time> <n> <n>", what we sync on
+    perf_primary,
+    // "<time> <n> <n> <float> <float> vel <float>", playerperf output we just hide
+    perf_backup
+};
+
+static perf_line ParsePerfLine(const char *at, const char *end, double &server_time)
+{
+    if (!ParseDecimal(at, end, &server_time) || !ParseLiteral(at, end, " ") || !ParseSmall(at, end) || !ParseLiteral(at, end, " ") || !ParseSmall(at, end))
+        return perf_none;
+    if (at == end)
+        return perf_primary;
+    if (ParseLiteral(at, end, " ") && ParseDecimal(at, end) && ParseLiteral(at, end, " ") && ParseDecimal(at, end) && ParseLiteral(at, end, " vel ") && ParseDecimal(at, end) && at == end)
+        return perf_backup;
+    return perf_none;
+}
+
+bool DispatchUserMessage(const usermessages::message_s &message)
 {
     bool should_call_original = true;
     if ((!waiting_perf_data && !last_was_player_perf) || !bullet)
         return should_call_original;
 
     // We are looking for TextMsg
-    if (type != 5)
+    if (message.type != usermessages::TextMsg)
         return should_call_original;
 
-    int message_dest = buf->ReadByte();
-
     // Not send to us
-    if (message_dest != 2)
-    {
-        buf->Seek(0);
+    if (message.text_msg.dest != 2)
         return should_call_original;
-    }
 
     double start_time = Plat_FloatTime();
 
-    char msg_str[256];
-    buf->ReadString(msg_str, sizeof(msg_str));
-    buf->Seek(0);
-
-    std::vector<std::string> lines;
-    boost::split(lines, msg_str, boost::is_any_of("\n"), boost::token_compress_on);
-
-    // Regex to find the playerperf data we want/need
-    static std::regex primary_regex("^(([0-9]+\\.[0-9]+) ([0-9]{1,2}) ([0-9]{1,2}))$");
+    // Only the first and how many there are matter
+    double first_time = 0.0;
+    int entries       = 0;
 
-    std::vector<double> vData;
-
-    for (auto sStr : lines)
+    for (const char *line = message.text_msg.text; *line;)
     {
-        std::smatch sMatch;
-
-        if (!std::regex_match(sStr, sMatch, primary_regex) || sMatch.size() != 5)
-        {
-            static std::regex backup_regex("^(([0-9]+\\.[0-9]+) ([0-9]{1,2}) ([0-9]{1,2}) ([0-9]+\\.[0-9]+) ([0-9]+\\.[0-9]+) vel ([0-9]+\\.[0-9]+))$");
-            std::smatch sMatch2;
-            if (std::regex_match(sStr, sMatch2, backup_regex) && sMatch2.size() > 5)
-            {
-                last_was_player_perf = true;
-                should_call_original = false;
-            }
-            continue;
-        }
-
-        std::string server_time = sMatch[2].str();
-
-        char *tmp;
-        try
-        {
-            vData.push_back(std::strtod(server_time.c_str(), &tmp));
-        }
-        // Shouldn't happen
-        catch (std::invalid_argument)
+        const char *end = strchrnul(line, '\n');
+        double server_time;
+        switch (ParsePerfLine(line, end, server_time))
         {
+        case perf_primary:
+            if (!entries++)
+                first_time = server_time;
+            break;
+        case perf_backup:
+            last_was_player_perf = true;
+            should_call_original = false;
+            break;
+        default:
+            break;
         }
+        line = *end ? end + 1 : end;
     }
 
-    if (vData.size() < 2)
+    if (entries < 2)
     {
-        if (!vData.size())
+        if (!entries)
             last_was_player_perf = false;
         // Still do not call original, we don't want the playerperf spewing everywhere
         else
@@ -506,7 +531,7 @@ bool DispatchUserMessage(bf_read *buf, int type)
     }
 
     // Less than 1 in step size is literally impossible to predict, although 1 is already pushing it
-    if (CalculateMantissaStep(vData[0] * 1000.0) < 1.0)
+    if (CalculateMantissaStep(first_time * 1000.0) < 1.0)
     {
         if (waiting_perf_data)
             g_ICvar->ConsoleColorPrintf(MENU_COLOR, "Couldn't sync nospread: server uptime too low.\n");
@@ -534,13 +559,13 @@ bool DispatchUserMessage(bf_read *buf, int type)
         double total_latency = (client_time - (client_time - start_time)) - sent_client_floattime;
 
         // Second compensate latency and get delta time (this might be negative, so be careful!)
-        float_time_delta = vData[0] - sent_client_floattime;
+        float_time_delta = first_time - sent_client_floattime;
 
         // We got time with latency included, but only outgoing, so compensate
         float_time_delta -= (total_latency / 2.0);
 
         if (debug_nospread)
-            g_ICvar->ConsoleColorPrintf(MENU_COLOR, "Assumed delta time: %.10f calculated based on %i entries.\n", float_time_delta, (int) vData.size() - 1);
+            g_ICvar->ConsoleColorPrintf(MENU_COLOR, "Assumed delta time: %.10f calculated based on %i entries.\n", float_time_delta, entries - 1);
 
         // we need only first output which is latest
         waiting_perf_data = false;
@@ -552,7 +577,7 @@ bool DispatchUserMessage(bf_read *buf, int type)
     else if (no_spread_synced != SYNCED)
     {
         // Now sync and Correct
-        double time_difference = sent_client_floattime - vData[0];
+        double time_difference = sent_client_floattime - first_time;
 
         double mantissa_step = CalculateMantissaStep(sent_client_floattime * 1000.0);
         // Apply correction
@@ -854,6 +879,9 @@ static InitRoutine init_bulletnospread([]() {
     /*static auto net_sendpacket_addr = gSignatures.GetEngineSignature("55 89 E5 57 56 53 81 EC EC 20 00 00 C7 85 ? ? ? ? 00 00 00 00 8B 45");
     net_sendpacket_detour.Init(net_sendpacket_addr, (void *) NET_SendPacket_hook);*/
 
+    // Ahead of warp, which has to leave the move alone while we force it
+    net_messages::Subscribe(clc_Move, SendNetMessage, EC::very_early);
+
     // Register Event callbacks
     EC::Register(
         EC::CreateMove,
@@ -4,6 +4,8 @@
 #include "libnullnexus/nullnexus.hpp"
 #include "nullnexus.hpp"
 #include "netadr.h"
+#include "jobs.hpp"
+#include <condition_variable>
 #if ENABLE_VISUALS
 #include "colors.hpp"
 #include "MiscTemporary.hpp"
@@ -95,7 +97,7 @@ void updateServer(NullNexus::UserSettings &settings)
     INetChannel *ch = (INetChannel *) g_IEngine->GetNetChannelInfo();
     // Additional currently inactive security measure, may be activated at any time
     static int *gHostSpawnCount = *reinterpret_cast<int **>(gSignatures.GetEngineSignature("A3 ? ? ? ? A1 ? ? ? ? 8B 10 89 04 24 FF 52 ? 83 C4 2C") + sizeof(char));
-    if (ch && *authenticate)
+    if (ch && authenticate.load())
     {
         auto addr = ch->GetRemoteAddress();
         // Local address! Don't send that to nullnexus.
@@ -121,35 +123,190 @@ void updateServer(NullNexus::UserSettings &settings)
     settings.tf2server = { false };
 }
 
-// Update info about the current server we are on.
-void updateServer()
+// Everything we tell nullnexus about ourselves, put together on the game thread
+static NullNexus::UserSettings snapshotData()
 {
-    NullNexus::UserSettings settings;
-    updateServer(settings);
-    nexus.changeData(settings);
-}
-
-void updateData()
-{
-    std::optional<std::string> username = std::nullopt;
-    std::optional<int> newcolour        = std::nullopt;
-    username                            = *anon ? "anon" : g_ISteamFriends->GetPersonaName();
+    std::optional<int> newcolour = std::nullopt;
 #if ENABLE_VISUALS
-    if ((*colour).r || (*colour).g || (*colour).b)
+    rgba_t user_colour = colour.load();
+    if (user_colour.r || user_colour.g || user_colour.b)
     {
-        int r     = (*colour).r * 255;
-        int g     = (*colour).g * 255;
-        int b     = (*colour).b * 255;
+        int r     = user_colour.r * 255;
+        int g     = user_colour.g * 255;
+        int b     = user_colour.b * 255;
         newcolour = (r << 16) + (g << 8) + b;
     }
 #endif
     NullNexus::UserSettings settings;
-    settings.username = *username;
+    settings.username = anon.load() ? "anon" : g_ISteamFriends->GetPersonaName();
     settings.colour   = newcolour;
     // Tell nullnexus about the current server we are connected to.
     updateServer(settings);
+    return settings;
+}
+
+struct connection_s
+{
+    bool enabled;
+    bool proxy;
+    std::string socket;
+    std::string address;
+    std::string port;
+    std::string endpoint;
+};
+
+static connection_s snapshotConnection()
+{
+    return { enabled.load(), proxyenabled.load(), proxysocket.load(), address.load(), port.load(), endpoint.load() };
+}
+
+/*
+ * One long lived thread does all the talking to libnullnexus. The game thread and the settings callbacks only leave
+ * work here: settings changes within the debounce window collapse into one update and one reconnect, chat goes out
+ * with the next wakeup, and reconnects that keep coming back to back back off up to a minute apart
+ */
+namespace worker
+{
+constexpr auto DEBOUNCE    = std::chrono::milliseconds(500);
+constexpr auto BACKOFF_MIN = std::chrono::seconds(1);
+constexpr auto BACKOFF_MAX = std::chrono::seconds(60);
+// Reconnects further apart than this start over at BACKOFF_MIN
+constexpr auto STABLE = std::chrono::seconds(30);
+
+typedef std::chrono::steady_clock clock;
+
+static std::mutex lock;
+static std::condition_variable wake;
+static std::thread thread;
+// Guarded by lock
+static std::optional<NullNexus::UserSettings> pending_data;
+static std::optional<connection_s> pending_connection;
+static std::vector<std::string> outbox;
+static clock::time_point due{};
+static bool stop = false;
+
+// Worker thread only
+static clock::time_point last_connect{};
+static clock::duration backoff = BACKOFF_MIN;
+
+static void apply(const connection_s &connection)
+{
+    if (!connection.enabled)
+    {
+        nexus.disconnect();
+        return;
+    }
+    auto now     = clock::now();
+    backoff      = now - last_connect < STABLE ? std::min<clock::duration>(backoff * 2, BACKOFF_MAX) : clock::duration(BACKOFF_MIN);
+    last_connect = now;
+    if (connection.proxy)
+        nexus.connectunix(connection.socket, connection.endpoint, true);
+    else
+        nexus.connect(connection.address, connection.port, connection.endpoint, true);
+}
+
+static void run()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while (!stop)
+    {
+        if (!pending_data && !pending_connection && outbox.empty())
+        {
+            wake.wait(guard);
+            continue;
+        }
+        auto now = clock::now();
+        // Settings wait for the debounce, chat doesn't
+        if (now < due && outbox.empty())
+        {
+            wake.wait_until(guard, due);
+            continue;
+        }
+        std::vector<std::string> messages;
+        messages.swap(outbox);
+        std::optional<NullNexus::UserSettings> data;
+        std::optional<connection_s> connection;
+        if (now >= due)
+        {
+            data.swap(pending_data);
+            // Too soon after the last one, keep it until the backoff is over
+            if (pending_connection && (!pending_connection->enabled || now >= last_connect + backoff))
+                connection.swap(pending_connection);
+            else if (pending_connection)
+                due = last_connect + backoff;
+        }
+        guard.unlock();
+
+        if (data)
+            nexus.changeData(*data);
+        if (connection)
+            apply(*connection);
+        for (auto &msg : messages)
+            if (!nexus.sendChat(msg))
+                jobs::Defer([]() { printmsgcopy("Cathook", "Error! Couldn't send message."); });
 
-    nexus.changeData(settings);
+        guard.lock();
+    }
+    guard.unlock();
+    nexus.disconnect();
+}
+
+static void start()
+{
+    if (!thread.joinable())
+        thread = std::thread(run);
+}
+
+// Game thread. A reconnect also pushes the data again
+static void queue(bool reconnect, clock::duration delay)
+{
+    NullNexus::UserSettings data = snapshotData();
+    std::optional<connection_s> connection;
+    if (reconnect)
+        connection = snapshotConnection();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        start();
+        pending_data = std::move(data);
+        if (connection)
+            pending_connection = std::move(connection);
+        due = clock::now() + delay;
+    }
+    wake.notify_one();
+}
+
+static void send(std::string msg)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        start();
+        outbox.push_back(std::move(msg));
+    }
+    wake.notify_one();
+}
+
+static void shutdown()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!thread.joinable())
+            return;
+        stop = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+} // namespace worker
+
+// Update info about the current server we are on.
+void updateServer()
+{
+    worker::queue(false, std::chrono::milliseconds(0));
+}
+
+void updateData()
+{
+    worker::queue(false, worker::DEBOUNCE);
 }
 
 bool sendmsg(std::string &msg)
@@ -159,41 +316,21 @@ bool sendmsg(std::string &msg)
         printmsgcopy("Cathook", "Error! Nullnexus is disabled!");
         return false;
     }
-    if (nexus.sendChat(msg))
-        return true;
-    printmsgcopy("Cathook", "Error! Couldn't send message.");
-    return false;
+    worker::send(msg);
+    return true;
 }
 
 template <typename T> void rvarCallback(settings::VariableBase<T> &, T)
 {
-    std::thread reload([]() {
-        std::this_thread::sleep_for(std::chrono_literals::operator""ms(500));
-        updateData();
-        if (*enabled)
-        {
-            if (*proxyenabled)
-                nexus.connectunix(*proxysocket, *endpoint, true);
-            else
-                nexus.connect(*address, *port, *endpoint, true);
-        }
-        else
-            nexus.disconnect();
-    });
-    reload.detach();
+    worker::queue(true, worker::DEBOUNCE);
 }
 
 template <typename T> void rvarDataCallback(settings::VariableBase<T> &, T)
 {
-    std::thread reload([]() {
-        std::this_thread::sleep_for(std::chrono_literals::operator""ms(500));
-        updateData();
-    });
-    reload.detach();
+    updateData();
 }
 
 static InitRoutine init([]() {
-    updateData();
     enabled.installChangeCallback(rvarCallback<bool>);
     address.installChangeCallback(rvarCallback<std::string>);
     port.installChangeCallback(rvarCallback<std::string>);
@@ -211,15 +348,11 @@ static InitRoutine init([]() {
     nexus.setHandlerChat(handlers::message);
     nexus.setHandlerAuthedplayers(handlers::authedplayers);
     if (*enabled)
-    {
-        if (*proxyenabled)
-            nexus.connectunix(*proxysocket, *endpoint, true);
-        else
-            nexus.connect(*address, *port, *endpoint, true);
-    }
+        worker::queue(true, std::chrono::milliseconds(0));
+    else
+        updateServer();
 
-    EC::Register(
-        EC::Shutdown, []() { nexus.disconnect(); }, "shutdown_nullnexus");
+    EC::Register(EC::Shutdown, worker::shutdown, "shutdown_nullnexus");
     EC::Register(
         EC::FirstCM, []() { updateServer(); }, "firstcm_nullnexus");
     EC::Register(
@@ -0,0 +1,282 @@
+#include "common.hpp"
+#include "objectives.hpp"
+#include "navparser.hpp"
+
+namespace objectives
+{
+control_point_s control_points[MAX_CONTROL_POINTS]{};
+int control_point_count = 0;
+std::vector<cart_s> carts;
+round_s round_info{ RT_STATE_NORMAL, -1.0f, -1, 0 };
+objective_s current_objective{};
+
+// Points that have to be held first, per point and team
+constexpr int MAX_PREVIOUS_POINTS = 3;
+
+// Entities found by the last Identify(), 0 if the map has none
+static int resource = 0;
+static std::vector<int> timers;
+static bool identified = false;
+// Maps without some of them would otherwise get scanned every tick
+static Timer retry{};
+// Nav mesh the cached areas belong to
+static const CNavFile *areas_navfile = nullptr;
+
+static bool IsClass(int idx, int classid)
+{
+    return idx > 0 && entity_cache::SnapshotValid(idx) && entity_cache::snapshot.class_id[idx] == classid;
+}
+
+static bool IsResource(int idx)
+{
+    return IsClass(idx, CL_CLASS(CTFObjectiveResource)) || IsClass(idx, CL_CLASS(CBaseTeamObjectiveResource));
+}
+
+static void Identify()
+{
+    identified = true;
+    retry.update();
+    resource = 0;
+    timers.clear();
+    carts.clear();
+    for (int i = 1; i <= entity_cache::max; i++)
+    {
+        if (!entity_cache::SnapshotValid(i))
+            continue;
+        int classid = entity_cache::snapshot.class_id[i];
+        if (!resource && IsResource(i))
+            resource = i;
+        else if (classid == CL_CLASS(CTeamRoundTimer))
+            timers.push_back(i);
+        else if (classid == CL_CLASS(CObjectCartDispenser))
+            carts.push_back(cart_s{ ENTITY(i), entity_cache::snapshot.team[i], entity_cache::snapshot.origin[i], nullptr });
+    }
+}
+
+// Everything Identify() found must still be there, otherwise the round changed under us
+static bool StillValid()
+{
+    if (resource && !IsResource(resource))
+        return false;
+    for (int timer : timers)
+        if (!IsClass(timer, CL_CLASS(CTeamRoundTimer)))
+            return false;
+    for (auto &cart : carts)
+        if (!IsClass(cart.ent->m_IDX, CL_CLASS(CObjectCartDispenser)))
+            return false;
+    return true;
+}
+
+static CNavArea *AreaFor(const Vector &origin, const Vector &previous_origin, CNavArea *previous)
+{
+    if (areas_navfile != nav::navfile.get())
+        return nav::navfile ? nav::findArea(origin) : nullptr;
+    if (previous && previous_origin == origin)
+        return previous;
+    return nav::navfile ? nav::findArea(origin, previous) : nullptr;
+}
+
+static void UpdateRound()
+{
+    int timer = 0;
+    if (resource)
+    {
+        int shown = NET_INT(RAW_ENT(ENTITY(resource)), netvar.cp_iTimerToShowInHUD);
+        if (IsClass(shown, CL_CLASS(CTeamRoundTimer)))
+            timer = shown;
+    }
+    if (!timer && !timers.empty())
+        timer = timers.front();
+    round_info.timer = timer;
+    if (!timer)
+    {
+        round_info.state        = RT_STATE_NORMAL;
+        round_info.time_left    = -1.0f;
+        round_info.setup_length = -1;
+        return;
+    }
+    auto *ent               = RAW_ENT(ENTITY(timer));
+    round_info.state        = NET_INT(ent, netvar.m_nState) == 1 ? RT_STATE_NORMAL : RT_STATE_SETUP;
+    round_info.setup_length = NET_INT(ent, netvar.m_nSetupTimeLength);
+    if (NET_BYTE(ent, netvar.m_bTimerPaused))
+        round_info.time_left = NET_FLOAT(ent, netvar.m_flTimeRemaining);
+    else
+        round_info.time_left = std::max(NET_FLOAT(ent, netvar.m_flTimerEndTime) - g_GlobalVars->curtime, 0.0f);
+}
+
+static void UpdateControlPoints()
+{
+    if (!resource)
+    {
+        control_point_count = 0;
+        return;
+    }
+    auto *ent           = RAW_ENT(ENTITY(resource));
+    control_point_count = std::clamp(NET_INT(ent, netvar.cp_iNumControlPoints), 0, MAX_CONTROL_POINTS);
+    auto *positions     = &NET_VECTOR(ent, netvar.cp_vCPPositions);
+    auto *owners        = &NET_INT(ent, netvar.cp_iOwner);
+    auto *capping       = &NET_INT(ent, netvar.cp_iCappingTeam);
+    auto *locked        = &NET_BYTE(ent, netvar.cp_bCPLocked);
+    auto *can_cap       = &NET_BYTE(ent, netvar.cp_bTeamCanCap);
+    auto *previous      = &NET_INT(ent, netvar.cp_iPreviousPoints);
+    for (int i = 0; i < control_point_count; i++)
+    {
+        auto &point        = control_points[i];
+        point.area         = AreaFor(positions[i], point.origin, point.area);
+        point.origin       = positions[i];
+        point.owner        = owners[i];
+        point.capping_team = capping[i];
+        point.locked       = locked[i];
+    }
+    // Second pass, the owners of the points before these have to be known
+    for (int i = 0; i < control_point_count; i++)
+    {
+        auto &point         = control_points[i];
+        point.capturable_by = 0;
+        if (point.locked)
+            continue;
+        for (int team = TEAM_RED; team <= TEAM_BLU; team++)
+        {
+            if (point.owner == team || !can_cap[i + team * MAX_CONTROL_POINTS])
+                continue;
+            bool held = true;
+            for (int j = 0; j < MAX_PREVIOUS_POINTS; j++)
+            {
+                int before = previous[j + i * MAX_PREVIOUS_POINTS + team * MAX_CONTROL_POINTS * MAX_PREVIOUS_POINTS];
+                if (before >= 0 && before < control_point_count && control_points[before].owner != team)
+                    held = false;
+            }
+            if (held)
+                point.capturable_by |= 1 << team;
+        }
+    }
+}
+
+static void UpdateCarts()
+{
+    for (auto &cart : carts)
+    {
+        // Out of the entity list for good gets caught by StillValid(), dormant ones keep their last position
+        if (cart.ent->m_bDormant())
+            continue;
+        Vector origin = entity_cache::snapshot.origin[cart.ent->m_IDX];
+        cart.area     = AreaFor(origin, cart.origin, cart.area);
+        cart.origin   = origin;
+        cart.team     = entity_cache::snapshot.team[cart.ent->m_IDX];
+    }
+}
+
+static bool CanCapture(const control_point_s &point, int team)
+{
+    return point.capturable_by & (1 << team);
+}
+
+static bool MustDefend(const control_point_s &point, int team)
+{
+    return point.owner == team && (point.capturable_by & ~(1 << team));
+}
+
+// Closest point matching, the current objective wins while it still does so the bot doesn't flip between two
+static int PickPoint(objective_kind kind, bool (*matches)(const control_point_s &, int team), int team)
+{
+    if (current_objective.kind == kind && current_objective.index < control_point_count && matches(control_points[current_objective.index], team))
+        return current_objective.index;
+    int best        = -1;
+    float best_dist = FLT_MAX;
+    for (int i = 0; i < control_point_count; i++)
+    {
+        if (!matches(control_points[i], team))
+            continue;
+        float dist = control_points[i].origin.DistToSqr(g_pLocalPlayer->v_Origin);
+        if (dist < best_dist)
+        {
+            best      = i;
+            best_dist = dist;
+        }
+    }
+    return best;
+}
+
+static void UpdateCurrent()
+{
+    int team  = g_pLocalPlayer->team;
+    int enemy = team == TEAM_RED ? TEAM_BLU : TEAM_RED;
+    if (team != TEAM_RED && team != TEAM_BLU)
+    {
+        current_objective = objective_s{};
+        return;
+    }
+
+    // Payload maps have control points as checkpoints, the cart is what matters there
+    const cart_s *ours = nullptr, *theirs = nullptr;
+    for (auto &cart : carts)
+    {
+        if (cart.team == team && !ours)
+            ours = &cart;
+        else if (cart.team == enemy && !theirs)
+            theirs = &cart;
+    }
+    if (ours || theirs)
+    {
+        const cart_s &cart = ours ? *ours : *theirs;
+        current_objective  = objective_s{ ours ? OBJECTIVE_PUSH : OBJECTIVE_BLOCK, cart.ent->m_IDX, cart.origin, cart.area };
+        return;
+    }
+
+    int point           = PickPoint(OBJECTIVE_CAPTURE, CanCapture, team);
+    objective_kind kind = OBJECTIVE_CAPTURE;
+    if (point < 0)
+    {
+        point = PickPoint(OBJECTIVE_DEFEND, MustDefend, team);
+        kind  = OBJECTIVE_DEFEND;
+    }
+    if (point < 0)
+    {
+        current_objective = objective_s{};
+        return;
+    }
+    current_objective = objective_s{ kind, point, control_points[point].origin, control_points[point].area };
+}
+
+static void Reset()
+{
+    identified          = false;
+    resource            = 0;
+    control_point_count = 0;
+    areas_navfile       = nullptr;
+    timers.clear();
+    carts.clear();
+    round_info        = round_s{ RT_STATE_NORMAL, -1.0f, -1, 0 };
+    current_objective = objective_s{};
+}
+
+static void Update()
+{
+    if (!identified || !StillValid() || ((!resource || timers.empty()) && retry.check(5000)))
+        Identify();
+    UpdateRound();
+    UpdateControlPoints();
+    UpdateCarts();
+    areas_navfile = nav::navfile.get();
+    UpdateCurrent();
+}
+
+static CatCommand print("debug_objectives", "Show the round state and every objective", []() {
+    logging::Info("Round: %s, %.0fs left, setup %ds, timer %d. %d control points, %u carts", round_info.state == RT_STATE_SETUP ? "setup" : "normal", round_info.time_left, round_info.setup_length, round_info.timer, control_point_count, (unsigned) carts.size());
+    for (int i = 0; i < control_point_count; i++)
+    {
+        auto &point = control_points[i];
+        logging::Info("Point %d: owner %d, capping %d, %s, capturable by %x, area %p", i, point.owner, point.capping_team, point.locked ? "locked" : "unlocked", point.capturable_by, (void *) point.area);
+    }
+    for (auto &cart : carts)
+        logging::Info("Cart %d: team %d at %.0f %.0f %.0f, area %p", cart.ent->m_IDX, cart.team, cart.origin.x, cart.origin.y, cart.origin.z, (void *) cart.area);
+    logging::Info("Current objective: kind %d, index %d", current_objective.kind, current_objective.index);
+});
+
+static InitRoutine init([]() {
+    EC::Register(EC::CreateMove, Update, "update_objectives", EC::very_early);
+    EC::Register(EC::LevelInit, Reset, "reset_objectives");
+    // New round, new entities
+    game_events::Subscribe("teamplay_round_start", [](const game_events::event_s &) { identified = false; });
+});
+} // namespace objectives
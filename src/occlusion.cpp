@@ -0,0 +1,96 @@
+#include "common.hpp"
+#include "settings/Bool.hpp"
+#include "occlusion.hpp"
+#include "jobs.hpp"
+#include <atomic>
+
+namespace occlusion
+{
+static settings::Boolean enabled{ "debug.pvs-occlusion", "true" };
+
+// One row of cluster bits per cluster, as the engine decompresses it
+struct pvs_table
+{
+    int clusters{ 0 };
+    int row_bytes{ 0 };
+    std::vector<unsigned char> bits;
+};
+
+// Only touched by the main thread
+static std::unique_ptr<pvs_table> table;
+
+// Handoff from the background job
+static std::mutex build_lock;
+static unsigned build_generation{ 0 };
+static std::unique_ptr<pvs_table> pending;
+static std::atomic<bool> pending_ready{ false };
+
+static void buildTable(unsigned generation)
+{
+    auto result      = std::make_unique<pvs_table>();
+    result->clusters = g_IEngine->GetClusterCount();
+    if (result->clusters <= 0)
+    {
+        logging::Info("Occlusion: Map has no vis data");
+        return;
+    }
+    result->row_bytes = (result->clusters + 7) / 8;
+    result->bits.resize((size_t) result->clusters * result->row_bytes);
+    // The vis data is read only once the map is loaded, so reading it from here is fine
+    for (int i = 0; i < result->clusters; i++)
+        g_IEngine->GetPVSForCluster(i, result->row_bytes, &result->bits[(size_t) i * result->row_bytes]);
+
+    std::lock_guard<std::mutex> lock(build_lock);
+    // Level changed while we were busy
+    if (generation != build_generation)
+        return;
+    logging::Info("Occlusion: Built PVS table for %d clusters (%u bytes)", result->clusters, (unsigned) result->bits.size());
+    pending       = std::move(result);
+    pending_ready = true;
+}
+
+static void invalidate()
+{
+    std::lock_guard<std::mutex> lock(build_lock);
+    build_generation++;
+    pending.reset();
+    pending_ready = false;
+    table.reset();
+}
+
+static void LevelInit()
+{
+    invalidate();
+    unsigned generation;
+    {
+        std::lock_guard<std::mutex> lock(build_lock);
+        generation = build_generation;
+    }
+    jobs::Background([generation]() { buildTable(generation); });
+}
+
+bool DefinitelyOccluded(const Vector &a, const Vector &b)
+{
+    if (!*enabled)
+        return false;
+    if (pending_ready)
+    {
+        std::lock_guard<std::mutex> lock(build_lock);
+        table         = std::move(pending);
+        pending_ready = false;
+    }
+    if (!table)
+        return false;
+    int from = g_IEngine->GetClusterForOrigin(a);
+    int to   = g_IEngine->GetClusterForOrigin(b);
+    // Inside solid or outside the map, the PVS can't tell us anything
+    if (from < 0 || to < 0 || from >= table->clusters || to >= table->clusters)
+        return false;
+    return !(table->bits[(size_t) from * table->row_bytes + to / 8] & (1 << (to & 7)));
+}
+
+static InitRoutine init([]() {
+    EC::Register(EC::LevelInit, LevelInit, "levelinit_occlusion");
+    EC::Register(EC::LevelShutdown, invalidate, "levelshutdown_occlusion");
+});
+} // namespace occlusion
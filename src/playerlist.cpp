@@ -7,16 +7,23 @@
 
 #include "playerlist.hpp"
 #include "common.hpp"
+#if ENABLE_IPC
+#include "ipcplayerlist.hpp"
+#endif
 
 #include <stdint.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <boost/algorithm/string.hpp>
 
 namespace playerlist
 {
 
 std::unordered_map<unsigned, userdata> data{};
+unsigned generation = 0;
 
 const std::string k_Names[]                                     = { "DEFAULT", "FRIEND", "RAGE", "IPC", "TEXTMODE", "CAT", "PARTY" };
 const char *const k_pszNames[]                                  = { "DEFAULT", "FRIEND", "RAGE", "IPC", "TEXTMODE", "CAT", "PARTY" };
@@ -33,6 +40,15 @@ bool ShouldSave(const userdata &data)
     return data.state == k_EState::FRIEND || data.state == k_EState::RAGE;
 }
 
+// The plist file is SERIALIZE_VERSION, the record count and then the records back to back
+struct __attribute__((packed)) record_s
+{
+    unsigned steamid;
+    userdata data;
+};
+static_assert(sizeof(record_s) == sizeof(unsigned) + sizeof(userdata), "plist records must not have padding");
+constexpr size_t HEADER_SIZE = sizeof(SERIALIZE_VERSION) + sizeof(int);
+
 void Save()
 {
     DIR *cathook_directory = opendir(paths::getDataPath().c_str());
@@ -44,36 +60,41 @@ void Save()
     }
     else
         closedir(cathook_directory);
-    try
+
+    // Build the whole file first so it goes out in a single write
+    std::vector<char> buffer(HEADER_SIZE);
+    int size = 0;
+    for (const auto &item : data)
     {
-        std::ofstream file(paths::getDataPath("/plist"), std::ios::out | std::ios::binary);
-        file.write(reinterpret_cast<const char *>(&SERIALIZE_VERSION), sizeof(SERIALIZE_VERSION));
-        int size = 0;
-        for (const auto &item : data)
-        {
-            if (ShouldSave(item.second))
-                size++;
-        }
-        file.write(reinterpret_cast<const char *>(&size), sizeof(size));
-        for (const auto &item : data)
-        {
-            if (!ShouldSave(item.second))
-                continue;
-            file.write(reinterpret_cast<const char *>(&item.first), sizeof(item.first));
-            file.write(reinterpret_cast<const char *>(&item.second), sizeof(item.second));
-        }
-        file.close();
-        logging::Info("Writing successful");
+        if (!ShouldSave(item.second))
+            continue;
+        record_s record{ item.first, item.second };
+        buffer.insert(buffer.end(), (const char *) &record, (const char *) &record + sizeof(record));
+        size++;
     }
-    catch (std::exception &e)
+    memcpy(&buffer[0], &SERIALIZE_VERSION, sizeof(SERIALIZE_VERSION));
+    memcpy(&buffer[sizeof(SERIALIZE_VERSION)], &size, sizeof(size));
+
+    // Written next to it and renamed over, a crash mid-write must not cost the whole list
+    std::string path = paths::getDataPath("/plist");
+    std::string temp = path + ".tmp";
+    int fd           = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool written     = fd >= 0 && write(fd, buffer.data(), buffer.size()) == ssize_t(buffer.size());
+    if (fd >= 0)
+        close(fd);
+    if (!written || rename(temp.c_str(), path.c_str()))
     {
-        logging::Info("Writing unsuccessful: %s", e.what());
+        logging::Info("Writing unsuccessful: %s", strerror(errno));
+        unlink(temp.c_str());
+        return;
     }
+    logging::Info("Writing successful");
 }
 
 void Load()
 {
     data.clear();
+    generation++;
     DIR *cathook_directory = opendir(paths::getDataPath().c_str());
     if (!cathook_directory)
     {
@@ -83,40 +104,45 @@ void Load()
     }
     else
         closedir(cathook_directory);
-    try
+
+    int fd = open(paths::getDataPath("/plist").c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) || size_t(st.st_size) < HEADER_SIZE)
     {
-        std::ifstream file(paths::getDataPath("/plist"), std::ios::in | std::ios::binary);
-        int file_serialize = 0;
-        file.read(reinterpret_cast<char *>(&file_serialize), sizeof(file_serialize));
-        if (file_serialize != SERIALIZE_VERSION)
-        {
-            logging::Info("Outdated/corrupted playerlist file! Cannot load this.");
-            file.close();
-            return;
-        }
-        int count = 0;
-        file.read(reinterpret_cast<char *>(&count), sizeof(count));
-        logging::Info("Reading %i entries...", count);
-        for (int i = 0; i < count; i++)
-        {
-            int steamid;
-            userdata udata;
-            file.read(reinterpret_cast<char *>(&steamid), sizeof(steamid));
-            file.read(reinterpret_cast<char *>(&udata), sizeof(udata));
-            data.emplace(steamid, udata);
-        }
-        file.close();
-        logging::Info("Reading successful!");
+        logging::Info("Outdated/corrupted playerlist file! Cannot load this.");
+        if (fd >= 0)
+            close(fd);
+        return;
     }
-    catch (std::exception &e)
+    void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
     {
-        logging::Info("Reading unsuccessful: %s", e.what());
+        logging::Info("Reading unsuccessful: %s", strerror(errno));
+        return;
     }
+    auto file = (const char *) mapping;
+    int file_serialize, count;
+    memcpy(&file_serialize, file, sizeof(file_serialize));
+    memcpy(&count, file + sizeof(file_serialize), sizeof(count));
+    if (file_serialize != SERIALIZE_VERSION || count < 0 || size_t(st.st_size) < HEADER_SIZE + size_t(count) * sizeof(record_s))
+    {
+        logging::Info("Outdated/corrupted playerlist file! Cannot load this.");
+        munmap(mapping, st.st_size);
+        return;
+    }
+    logging::Info("Reading %i entries...", count);
+    auto records = (const record_s *) (file + HEADER_SIZE);
+    data.reserve(count);
+    for (int i = 0; i < count; i++)
+        data.emplace(records[i].steamid, records[i].data);
+    munmap(mapping, st.st_size);
+    logging::Info("Reading successful!");
 }
+
 #if ENABLE_VISUALS
-rgba_t Color(unsigned steamid)
+static rgba_t Color(const userdata &pl)
 {
-    const auto &pl = AccessData(steamid);
     if (pl.state == k_EState::CAT)
         return colors::RainbowCurrent();
     else if (pl.color.a)
@@ -129,10 +155,15 @@ rgba_t Color(unsigned steamid)
     return colors::empty;
 }
 
+rgba_t Color(unsigned steamid)
+{
+    return Color(AccessData(steamid));
+}
+
 rgba_t Color(CachedEntity *player)
 {
     if (CE_GOOD(player))
-        return Color(player->player_info.friendsID);
+        return Color(AccessData(player));
     return colors::empty;
 }
 #endif
@@ -145,36 +176,49 @@ userdata &AccessData(unsigned steamid)
 userdata &AccessData(CachedEntity *player)
 {
     if (player && player->player_info.friendsID)
+    {
+        // Players have their entry cached by the entity cache
+        if (player->m_IDX > 0 && player->m_IDX < PLAYER_ARRAY_SIZE)
+            return entity_cache::PlayerlistEntry(player->m_IDX);
         return AccessData(player->player_info.friendsID);
+    }
     return AccessData(0U);
 }
 
-bool IsDefault(unsigned steamid)
+static bool IsDefault(const userdata &data)
 {
-    const userdata &data = AccessData(steamid);
 #if ENABLE_VISUALS
     return data.state == k_EState::DEFAULT && !data.color.a;
 #endif
     return data.state == k_EState ::DEFAULT;
 }
 
+bool IsDefault(unsigned steamid)
+{
+    return IsDefault(AccessData(steamid));
+}
+
 bool IsDefault(CachedEntity *entity)
 {
     if (entity && entity->player_info.friendsID)
-        return IsDefault(entity->player_info.friendsID);
+        return IsDefault(AccessData(entity));
     return true;
 }
 
-bool IsFriend(unsigned steamid)
+static bool IsFriend(const userdata &data)
 {
-    const userdata &data = AccessData(steamid);
     return data.state == k_EState::PARTY || data.state == k_EState::FRIEND;
 }
 
+bool IsFriend(unsigned steamid)
+{
+    return IsFriend(AccessData(steamid));
+}
+
 bool IsFriend(CachedEntity *entity)
 {
     if (entity && entity->player_info.friendsID)
-        return IsFriend(entity->player_info.friendsID);
+        return IsFriend(AccessData(entity));
     return false;
 }
 
@@ -184,6 +228,9 @@ bool ChangeState(unsigned int steamid, k_EState state, bool force)
     if (force)
     {
         data.state = state;
+#if ENABLE_IPC
+        ipc::shared_playerlist::Publish(steamid, int(state));
+#endif
         return true;
     }
     switch (data.state)
@@ -275,7 +322,7 @@ CatCommand pl_add_id("pl_add_id", "Sets state for steamid", [](const CCommand &a
     for (int i = 0; i <= int(k_EState::STATE_LAST); ++i)
         if (k_Names[i] == state)
         {
-            AccessData(id).state = k_EState(i);
+            ChangeState(id, k_EState(i), true);
             return;
         }
 
@@ -293,6 +340,7 @@ static void pl_cleanup()
 
         ++counter;
         data.erase(it);
+        generation++;
         /* Start all over again. Iterator is invalidated once erased. */
         it = data.begin();
     }
@@ -336,7 +384,7 @@ CatCommand pl_set_state("pl_set_state", "cat_pl_set_state [playername] [state] (
     for (int i = 0; i <= int(k_EState::STATE_LAST); ++i)
         if (k_Names[i] == state)
         {
-            AccessData(info.friendsID).state = k_EState(i);
+            ChangeState(info.friendsID, k_EState(i), true);
             return;
         }
 
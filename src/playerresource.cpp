@@ -11,190 +11,157 @@
 
 void TFPlayerResource::Update()
 {
-    IClientEntity *ent;
+    IClientEntity *ent = g_IEntityList->GetClientEntity(entity);
 
-    entity = 0;
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
+    // It stays in the same slot for the whole level, only search again once it's gone
+    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
     {
-        ent = g_IEntityList->GetClientEntity(i);
-        if (ent && ent->GetClientClass()->m_ClassID == RCC_PLAYERRESOURCE)
+        ent    = nullptr;
+        entity = 0;
+        for (int i = 0; i <= HIGHEST_ENTITY; i++)
         {
-            entity = i;
-            return;
+            IClientEntity *candidate = g_IEntityList->GetClientEntity(i);
+            if (candidate && candidate->GetClientClass()->m_ClassID == RCC_PLAYERRESOURCE)
+            {
+                ent    = candidate;
+                entity = i;
+                break;
+            }
         }
     }
+    data.valid = ent != nullptr;
+    if (!ent)
+        return;
+    auto base = (const char *) ent;
+    auto copy = [&](int *out, unsigned offset) { memcpy(out, base + offset, sizeof(int) * SLOTS); };
+    copy(data.health, netvar.m_iHealth_Resource);
+    copy(data.max_health, netvar.res_iMaxHealth);
+    copy(data.max_buffed_health, netvar.res_iMaxBuffedHealth);
+    copy(data.player_class, netvar.res_iPlayerClass);
+    copy(data.team, netvar.res_iTeam);
+    copy(data.score, netvar.m_iTotalScore_Resource);
+    copy(data.kills, netvar.m_iKills_Resource);
+    copy(data.deaths, netvar.m_iDeaths_Resource);
+    copy(data.level, netvar.m_iPlayerLevel_Resource);
+    copy(data.damage, netvar.m_iDamage_Resource);
+    copy(data.ping, netvar.m_iPing_Resource);
+    memcpy(data.alive, base + netvar.res_bAlive, sizeof(data.alive));
 }
 
 int TFPlayerResource::GetHealth(CachedEntity *player)
 {
-    IClientEntity *ent;
     int idx;
     /* :thinking */
     IF_GAME(!IsTF()) return 100;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (!data.valid)
         return 0;
     idx = player->m_IDX;
     if (idx >= 64 || idx < 0)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.m_iHealth_Resource + 4 * idx);
+    return data.health[idx];
 }
 
 int TFPlayerResource::GetMaxHealth(CachedEntity *player)
 {
-    IClientEntity *ent;
     int idx;
     /* :thinking */
     IF_GAME(!IsTF()) return 100;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (!data.valid)
         return 0;
     idx = player->m_IDX;
     if (idx >= 64 || idx < 0)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.res_iMaxHealth + 4 * idx);
+    return data.max_health[idx];
 }
 
 int TFPlayerResource::GetMaxBuffedHealth(CachedEntity *player)
 {
-    IClientEntity *ent;
     int idx;
 
     IF_GAME(!IsTF()) return GetMaxHealth(player);
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (!data.valid)
         return 0;
     idx = player->m_IDX;
     if (idx >= 64 || idx < 0)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.res_iMaxBuffedHealth + 4 * idx);
+    return data.max_buffed_health[idx];
 }
 
 int TFPlayerResource::GetTeam(int idx)
 {
-    IClientEntity *ent;
-
-    if (idx >= MAX_PLAYERS || idx < 0)
-        return 0;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (idx >= MAX_PLAYERS || idx < 0 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.res_iTeam + 4 * idx);
+    return data.team[idx];
 }
 
 int TFPlayerResource::GetScore(int idx)
 {
-    IClientEntity *ent;
-
-    if (idx >= MAX_PLAYERS || idx < 1)
-        return 0;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (idx >= MAX_PLAYERS || idx < 1 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.m_iTotalScore_Resource + 4 * idx);
+    return data.score[idx];
 }
 
 int TFPlayerResource::GetKills(int idx)
 {
-    IClientEntity *ent;
-
-    if (idx >= MAX_PLAYERS || idx < 1)
+    if (idx >= MAX_PLAYERS || idx < 1 || !data.valid)
         return 0;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
-        return 0;
-    return *(int *) ((unsigned) ent + netvar.m_iKills_Resource + 4 * idx);
+    return data.kills[idx];
 }
 
 int TFPlayerResource::GetDeaths(int idx)
 {
-    IClientEntity *ent;
-
-    if (idx >= MAX_PLAYERS || idx < 1)
+    if (idx >= MAX_PLAYERS || idx < 1 || !data.valid)
         return 0;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
-        return 0;
-    return *(int *) ((unsigned) ent + netvar.m_iDeaths_Resource + 4 * idx);
+    return data.deaths[idx];
 }
 
 int TFPlayerResource::GetLevel(int idx)
 {
-    IClientEntity *ent;
-
-    if (idx >= MAX_PLAYERS || idx < 1)
-        return 0;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (idx >= MAX_PLAYERS || idx < 1 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.m_iPlayerLevel_Resource + 4 * idx);
+    return data.level[idx];
 }
 
 int TFPlayerResource::GetDamage(int idx)
 {
-    IClientEntity *ent;
-
-    if (idx >= MAX_PLAYERS || idx < 1)
-        return 0;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (idx >= MAX_PLAYERS || idx < 1 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.m_iDamage_Resource + 4 * idx);
+    return data.damage[idx];
 }
 int TFPlayerResource::GetPing(int idx)
 {
-    IClientEntity *ent;
-
-    if (idx >= MAX_PLAYERS || idx < 1)
-        return 0;
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
+    if (idx >= MAX_PLAYERS || idx < 1 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.m_iPing_Resource + 4 * idx);
+    return data.ping[idx];
 }
 
 int TFPlayerResource::GetClass(CachedEntity *player)
 {
-    IClientEntity *ent;
-    int idx;
-
-    ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
-        return 0;
-    idx = player->m_IDX;
-    if (idx >= MAX_PLAYERS || idx < 0)
+    int idx = player->m_IDX;
+    if (idx >= MAX_PLAYERS || idx < 0 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.res_iPlayerClass + 4 * idx);
+    return data.player_class[idx];
 }
 
 bool TFPlayerResource::isAlive(int idx)
 {
-    IClientEntity *ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
-        return 0;
-    if (idx >= MAX_PLAYERS || idx < 0)
+    if (idx >= MAX_PLAYERS || idx < 0 || !data.valid)
         return false;
-    return *(bool *) ((unsigned) ent + netvar.res_bAlive + idx);
+    return data.alive[idx];
 }
 
 int TFPlayerResource::getClass(int idx)
 {
-    IClientEntity *ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
-        return 0;
-    if (idx >= MAX_PLAYERS || idx < 0)
+    if (idx >= MAX_PLAYERS || idx < 0 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.res_iPlayerClass + 4 * idx);
+    return data.player_class[idx];
 }
 
 int TFPlayerResource::getTeam(int idx)
 {
-    IClientEntity *ent = g_IEntityList->GetClientEntity(entity);
-    if (!ent || ent->GetClientClass()->m_ClassID != RCC_PLAYERRESOURCE)
-        return 0;
-    if (idx >= MAX_PLAYERS || idx < 0)
+    if (idx >= MAX_PLAYERS || idx < 0 || !data.valid)
         return 0;
-    return *(int *) ((unsigned) ent + netvar.res_iTeam + 4 * idx);
+    return data.team[idx];
 }
 
 TFPlayerResource *g_pPlayerResource{ nullptr };
@@ -6,6 +6,9 @@
  */
 #include "common.hpp"
 #include <settings/Bool.hpp>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 
 static settings::Boolean debug_pp_extrapolate{ "debug.pp-extrapolate", "false" };
 static settings::Boolean debug_pp_draw{ "debug.pp-draw", "false" };
@@ -19,7 +22,7 @@ Vector SimpleLatencyPrediction(CachedEntity *ent, int hb)
     GetHitbox(ent, hb, result);
     float latency = g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_INCOMING);
     Vector velocity;
-    velocity::EstimateAbsVelocity(RAW_ENT(ent), velocity);
+    velocity::Get(ent, velocity);
     result += velocity * latency;
     return result;
 }
@@ -44,18 +47,6 @@ bool PerformProjectilePrediction(CachedEntity *target, int hitbox)
     return true;
 }
 
-Vector Predict(Vector &pos, Vector &vel, Vector acceleration, std::optional<float> grounddistance, float &time)
-{
-    PROF_SECTION(PredictNew);
-    Vector result = pos;
-    result += (acceleration / 2.0f) * pow(time, 2) + vel * time;
-    vel += acceleration * time;
-    if (grounddistance)
-        if (result.z < pos.z - *grounddistance)
-            result.z = pos.z - *grounddistance;
-    return result;
-}
-
 Vector PredictStep(Vector pos, Vector &vel, Vector acceleration, std::pair<Vector, Vector> &minmax, float time, float steplength, bool vischeck, std::optional<float> grounddistance)
 {
     PROF_SECTION(PredictNew)
@@ -76,7 +67,7 @@ Vector PredictStep(Vector pos, Vector &vel, Vector acceleration, std::pair<Vecto
             Ray_t ray;
             trace_t trace;
             ray.Init(modify, low, minmax.first, minmax.second);
-            g_ITrace->TraceRay(ray, MASK_PLAYERSOLID, &trace::filter_no_player, &trace);
+            trace::TraceRay(ray, MASK_PLAYERSOLID, &trace::filter_no_player, &trace);
 
             float dist = pos.z - trace.endpos.z;
             if (trace.m_pEnt && std::fabs(dist) < 63.0f)
@@ -89,143 +80,265 @@ Vector PredictStep(Vector pos, Vector &vel, Vector acceleration, std::pair<Vecto
     return result;
 }
 
-std::vector<Vector> Predict(Vector pos, float offset, Vector vel, Vector acceleration, std::pair<Vector, Vector> minmax, float time, int count, bool vischeck)
+// Unclamped positions at start + i * steplength, four steps per iteration
+static void PredictKinematics(const Vector &pos, const Vector &vel, const Vector &acceleration, float start, float steplength, int count, Vector *out)
+{
+    int i = 0;
+#if defined(__SSE__)
+    __m128 t    = _mm_setr_ps(start, start + steplength, start + 2.0f * steplength, start + 3.0f * steplength);
+    __m128 step = _mm_set1_ps(4.0f * steplength);
+    __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= count; i += 4, t = _mm_add_ps(t, step))
+    {
+        __m128 half_t2 = _mm_mul_ps(half, _mm_mul_ps(t, t));
+        alignas(16) float result[3][4];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            __m128 p = _mm_add_ps(_mm_set1_ps(pos[axis]), _mm_mul_ps(_mm_set1_ps(vel[axis]), t));
+            _mm_store_ps(result[axis], _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(acceleration[axis]), half_t2)));
+        }
+        for (int j = 0; j < 4; j++)
+            out[i + j] = Vector(result[0][j], result[1][j], result[2][j]);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float time = start + i * steplength;
+        out[i]     = pos + vel * time + acceleration * (0.5f * time * time);
+    }
+}
+
+// Height of the ground below pos, nullopt if there is none
+static std::optional<float> PredictGround(const Vector &pos, const std::pair<Vector, Vector> &minmax)
 {
-    std::vector<Vector> positions;
-    positions.reserve(count);
-    Vector prev;
+    PROF_SECTION(PredictTraces)
+    // Standing Player height is 83
+    Vector high(pos.x, pos.y, pos.z + 83.0f);
+    Vector low = high;
+    low.z -= 8912.0f;
+    Ray_t ray;
+    trace_t trace;
+    ray.Init(high, low, minmax.first, minmax.second);
+    trace::TraceRay(ray, MASK_PLAYERSOLID, &trace::filter_no_player, &trace);
+    if (!trace.m_pEnt)
+        return std::nullopt;
+    return trace.endpos.z;
+}
 
-    pos.z -= offset;
+// Steps on the ground between checks for ledges and stairs
+constexpr int GROUND_RECHECK = 8;
+// Anything lower than this below the feet is a ledge rather than a step
+constexpr float STEP_HEIGHT = 18.0f;
 
-    float dist = DistanceToGround(pos, minmax.first, minmax.second);
-    Vector prediction;
+void PredictPath(const Vector &pos, const Vector &vel, const Vector &acceleration, const std::pair<Vector, Vector> &minmax, float start, float steplength, int count, Vector *out, bool vischeck, std::optional<float> grounddistance)
+{
+    PROF_SECTION(PredictNew)
+    if (count <= 0)
+        return;
+    PredictKinematics(pos, vel, acceleration, start, steplength, count, out);
 
+    std::optional<float> ground;
+    if (grounddistance)
+        ground = pos.z - *grounddistance;
+    else if (vischeck)
+        ground = PredictGround(pos, minmax);
+    // Once the ground stops the fall, z follows it and only gets rechecked every few steps
+    int landed_at  = -1;
+    float previous = pos.z;
     for (int i = 0; i < count; i++)
     {
-        time += 1.0f * g_GlobalVars->interval_per_tick;
-        if (positions.size() > 0)
+        if (landed_at >= 0)
         {
-            prev = positions.back();
-            if (vischeck)
-                prediction = PredictStep(prediction, vel, acceleration, minmax, time);
-            else
-                prediction = PredictStep(prediction, vel, acceleration, minmax, time, g_GlobalVars->interval_per_tick, false, dist);
-            positions.push_back({ prediction.x, prediction.y, prediction.z + offset });
+            if (vischeck && (i - landed_at) % GROUND_RECHECK == 0)
+                ground = PredictGround({ out[i].x, out[i].y, previous }, minmax);
+            if (ground && *ground >= previous - STEP_HEIGHT)
+            {
+                out[i].z = *ground;
+                previous = out[i].z;
+                continue;
+            }
+            // Walked off a ledge, fall from the last step on the ground
+            float fall_start = start + (i - 1) * steplength;
+            for (int j = i; j < count; j++)
+            {
+                float time = start + j * steplength - fall_start;
+                out[j].z   = previous + 0.5f * acceleration.z * time * time;
+            }
+            landed_at = -1;
         }
-        else
+        // Only crossing the known ground height needs a trace, everything above it is free flight
+        if (ground && out[i].z < *ground)
         {
-            prediction = Predict(pos, vel, acceleration, dist, time);
-            prediction.z += offset;
-            positions.push_back(prediction);
+            if (vischeck)
+                ground = PredictGround({ out[i].x, out[i].y, previous }, minmax);
+            if (ground && out[i].z < *ground)
+            {
+                out[i].z  = *ground;
+                landed_at = i;
+            }
         }
+        previous = out[i].z;
     }
-    return positions;
 }
 
 #if ENABLE_VISUALS
+// Paths for the debug drawing. They get predicted in CreateMove so drawing never traces, frames in between just skip what already passed
+namespace prediction_draw
+{
+constexpr int STEPS = 32;
+struct path_s
+{
+    std::array<Vector, STEPS> points;
+    float realtime{ 0.0f };
+    bool valid{ false };
+};
+static std::array<path_s, PLAYER_ARRAY_SIZE> paths{};
+
+static void CreateMove()
+{
+    if (!debug_pp_draw)
+        return;
+    static ConVar *sv_gravity = g_ICvar->FindVar("sv_gravity");
+    if (!sv_gravity)
+        return;
+    int max_clients = std::min(g_GlobalVars->maxClients, MAX_PLAYERS);
+    for (int i = 1; i <= max_clients; i++)
+    {
+        auto ent   = ENTITY(i);
+        auto &path = paths[i];
+        path.valid = false;
+        if (CE_BAD(ent) || !ent->m_bAlivePlayer())
+            continue;
+        Vector velocity;
+        velocity::Get(ent, velocity);
+        auto minmax = std::make_pair(RAW_ENT(ent)->GetCollideable()->OBBMins(), RAW_ENT(ent)->GetCollideable()->OBBMaxs());
+        PredictPath(ent->m_vecOrigin(), velocity, Vector(0, 0, -sv_gravity->GetFloat()), minmax, g_GlobalVars->interval_per_tick, g_GlobalVars->interval_per_tick, STEPS, path.points.data(), true, DistanceToGround(ent->m_vecOrigin(), minmax.first, minmax.second));
+        path.realtime = g_GlobalVars->realtime;
+        path.valid    = true;
+    }
+}
+
+static InitRoutine init([]() { EC::Register(EC::CreateMove, CreateMove, "prediction_draw_cm"); });
+} // namespace prediction_draw
+
 void Prediction_PaintTraverse()
 {
     if (g_Settings.bInvalid)
         return;
-    if (debug_pp_draw)
+    if (!debug_pp_draw)
+        return;
+    int max_clients = std::min(g_GlobalVars->maxClients, MAX_PLAYERS);
+    for (int i = 1; i <= max_clients; i++)
     {
-        static ConVar *sv_gravity = g_ICvar->FindVar("sv_gravity");
-        if (!sv_gravity)
-        {
-            sv_gravity = g_ICvar->FindVar("sv_gravity");
-            if (!sv_gravity)
-                return;
-        }
-        for (int i = 1; i <= g_GlobalVars->maxClients; i++)
+        auto ent         = ENTITY(i);
+        const auto &path = prediction_draw::paths[i];
+        if (!path.valid || CE_BAD(ent) || !ent->m_bAlivePlayer())
+            continue;
+        // Points that are already in the past get replaced by where the player is drawn right now
+        int first = (g_GlobalVars->realtime - path.realtime) / g_GlobalVars->interval_per_tick;
+        if (first >= prediction_draw::STEPS)
+            continue;
+        Vector previous_screen;
+        if (!draw::WorldToScreen(ent->m_vecOrigin(), previous_screen))
+            continue;
+        first = std::max(first, 0);
+        std::array<Vector, prediction_draw::STEPS> screen;
+        std::array<uint8_t, prediction_draw::STEPS> visible;
+        draw::WorldToScreenBatch(path.points.data() + first, prediction_draw::STEPS - first, screen.data(), visible.data());
+        rgba_t color = colors::FromRGBA8(255, 0, 0, 255);
+        for (int j = 0; j < prediction_draw::STEPS - first; j++)
         {
-            auto ent = ENTITY(i);
-            if (CE_BAD(ent) || !ent->m_bAlivePlayer())
-                continue;
-            Vector velocity;
-            velocity::EstimateAbsVelocity(RAW_ENT(ent), velocity);
-            auto data = Predict(ent->m_vecOrigin(), 0.0f, velocity, Vector(0, 0, -sv_gravity->GetFloat()), std::make_pair(RAW_ENT(ent)->GetCollideable()->OBBMins(), RAW_ENT(ent)->GetCollideable()->OBBMaxs()), 0.0f, 32);
-            Vector previous_screen;
-            if (!draw::WorldToScreen(ent->m_vecOrigin(), previous_screen))
-                continue;
-            rgba_t color = colors::FromRGBA8(255, 0, 0, 255);
-            for (int j = 0; j < data.size(); j++)
-            {
-                Vector screen;
-                if (draw::WorldToScreen(data[j], screen))
-                {
-                    draw::Line(screen.x, screen.y, previous_screen.x - screen.x, previous_screen.y - screen.y, color, 2);
-                    previous_screen = screen;
-                }
-                else
-                {
-                    break;
-                }
-                color.r -= 1.0f / 20.0f;
-            }
+            if (!visible[j])
+                break;
+            draw::Line(screen[j].x, screen[j].y, previous_screen.x - screen[j].x, previous_screen.y - screen[j].y, color, 2);
+            previous_screen = screen[j];
+            color.r -= 1.0f / 20.0f;
         }
     }
 }
 #endif
-Vector EnginePrediction(CachedEntity *entity, float time)
+typedef void (*SetupMoveFn)(IPrediction *, IClientEntity *, CUserCmd *, class IMoveHelper *, CMoveData *);
+typedef void (*FinishMoveFn)(IPrediction *, IClientEntity *, CUserCmd *, CMoveData *);
+static SetupMoveFn oSetupMove   = nullptr;
+static FinishMoveFn oFinishMove = nullptr;
+// Only ever used by one session at a time, on the game thread
+static CMoveData move_data{};
+
+EnginePredictionSession::EnginePredictionSession(CachedEntity *entity) : entity(entity)
 {
-    Vector result      = entity->m_vecOrigin();
+    if (!oSetupMove)
+    {
+        void **predictionVtable = *((void ***) g_IPrediction);
+        oSetupMove              = (SetupMoveFn)(*(unsigned *) (predictionVtable + 19));
+        oFinishMove             = (FinishMoveFn)(*(unsigned *) (predictionVtable + 20));
+    }
     IClientEntity *ent = RAW_ENT(entity);
 
-    typedef void (*SetupMoveFn)(IPrediction *, IClientEntity *, CUserCmd *, class IMoveHelper *, CMoveData *);
-    typedef void (*FinishMoveFn)(IPrediction *, IClientEntity *, CUserCmd *, CMoveData *);
-
-    void **predictionVtable  = *((void ***) g_IPrediction);
-    SetupMoveFn oSetupMove   = (SetupMoveFn)(*(unsigned *) (predictionVtable + 19));
-    FinishMoveFn oFinishMove = (FinishMoveFn)(*(unsigned *) (predictionVtable + 20));
-
-    // CMoveData *pMoveData = (CMoveData*)(sharedobj::client->lmap->l_addr +
-    // 0x1F69C0C);  CMoveData movedata {};
-    auto pMoveData = std::make_unique<CMoveData>();
-
-    float frameTime = g_GlobalVars->frametime;
-    float curTime   = g_GlobalVars->curtime;
-
-    CUserCmd fakecmd{};
-    memset(&fakecmd, 0, sizeof(CUserCmd));
+    old_frametime = g_GlobalVars->frametime;
+    old_curtime   = g_GlobalVars->curtime;
 
+    memset(&cmd, 0, sizeof(CUserCmd));
     Vector vel;
-    velocity::EstimateAbsVelocity(RAW_ENT(entity), vel);
-    fakecmd.command_number = last_cmd_number;
-    fakecmd.forwardmove    = vel.x;
-    fakecmd.sidemove       = -vel.y;
-    Vector oldangles       = CE_VECTOR(entity, netvar.m_angEyeAngles);
-    static Vector zerov{ 0, 0, 0 };
-    CE_VECTOR(entity, netvar.m_angEyeAngles) = zerov;
+    velocity::Get(entity, vel);
+    cmd.command_number = last_cmd_number;
+    cmd.forwardmove    = vel.x;
+    cmd.sidemove       = -vel.y;
 
-    CUserCmd *original_cmd = NET_VAR(ent, 4188, CUserCmd *);
+    old_angles                               = CE_VECTOR(entity, netvar.m_angEyeAngles);
+    CE_VECTOR(entity, netvar.m_angEyeAngles) = Vector(0.0f, 0.0f, 0.0f);
 
-    NET_VAR(ent, 4188, CUserCmd *) = &fakecmd;
+    original_cmd                                       = NET_VAR(ent, netvar.m_pCurrentCommand, CUserCmd *);
+    NET_VAR(ent, netvar.m_pCurrentCommand, CUserCmd *) = &cmd;
 
-    g_GlobalVars->curtime   = g_GlobalVars->interval_per_tick * NET_INT(ent, netvar.nTickBase);
-    g_GlobalVars->frametime = time;
+    g_GlobalVars->curtime = g_GlobalVars->interval_per_tick * NET_INT(ent, netvar.nTickBase);
 
-    Vector old_origin      = entity->m_vecOrigin();
-    NET_VECTOR(ent, 0x354) = entity->m_vecOrigin();
+    old_origin                             = entity->m_vecOrigin();
+    NET_VECTOR(ent, netvar.m_vecAbsOrigin) = old_origin;
 
     *g_PredictionRandomSeed = MD5_PseudoRandom(current_user_cmd->command_number) & 0x7FFFFFFF;
-    g_IGameMovement->StartTrackPredictionErrors(reinterpret_cast<CBasePlayer *>(ent));
-    oSetupMove(g_IPrediction, ent, &fakecmd, nullptr, pMoveData.get());
-    g_IGameMovement->ProcessMovement(reinterpret_cast<CBasePlayer *>(ent), pMoveData.get());
-    oFinishMove(g_IPrediction, ent, &fakecmd, pMoveData.get());
-    g_IGameMovement->FinishTrackPredictionErrors(reinterpret_cast<CBasePlayer *>(ent));
+}
 
-    NET_VAR(entity, 4188, CUserCmd *) = original_cmd;
+Vector EnginePredictionSession::Step(float steplength, int count, Vector *out)
+{
+    IClientEntity *ent      = RAW_ENT(entity);
+    auto player             = reinterpret_cast<CBasePlayer *>(ent);
+    g_GlobalVars->frametime = steplength;
+    Vector result           = ent->GetAbsOrigin();
+    for (int i = 0; i < count; i++)
+    {
+        g_IGameMovement->StartTrackPredictionErrors(player);
+        oSetupMove(g_IPrediction, ent, &cmd, nullptr, &move_data);
+        g_IGameMovement->ProcessMovement(player, &move_data);
+        oFinishMove(g_IPrediction, ent, &cmd, &move_data);
+        g_IGameMovement->FinishTrackPredictionErrors(player);
+        g_GlobalVars->curtime += steplength;
+
+        result = ent->GetAbsOrigin();
+        if (out)
+            out[i] = result;
+    }
+    return result;
+}
 
-    g_GlobalVars->frametime = frameTime;
-    g_GlobalVars->curtime   = curTime;
+EnginePredictionSession::~EnginePredictionSession()
+{
+    IClientEntity *ent = RAW_ENT(entity);
 
-    result                                    = ent->GetAbsOrigin();
-    NET_VECTOR(ent, 0x354)                    = old_origin;
-    CE_VECTOR(entity, netvar.m_angEyeAngles)  = oldangles;
+    NET_VAR(ent, netvar.m_pCurrentCommand, CUserCmd *) = original_cmd;
+
+    g_GlobalVars->frametime = old_frametime;
+    g_GlobalVars->curtime   = old_curtime;
+
+    NET_VECTOR(ent, netvar.m_vecAbsOrigin)    = old_origin;
+    CE_VECTOR(entity, netvar.m_angEyeAngles)  = old_angles;
     const_cast<Vector &>(ent->GetAbsOrigin()) = old_origin;
-    const_cast<QAngle &>(ent->GetAbsAngles()) = VectorToQAngle(oldangles);
+    const_cast<QAngle &>(ent->GetAbsAngles()) = VectorToQAngle(old_angles);
+}
 
-    return result;
+Vector EnginePrediction(CachedEntity *entity, float time)
+{
+    EnginePredictionSession session(entity);
+    return session.Step(time);
 }
 
 Vector ProjectilePrediction_Engine(CachedEntity *ent, int hb, float speed, float gravitymod, float entgmod /* ignored */, float proj_startvelocity)
@@ -260,10 +373,15 @@ Vector ProjectilePrediction_Engine(CachedEntity *ent, int hb, float speed, float
     float steplength = ((float) (2 * range) / (float) maxsteps);
     Vector ent_mins  = RAW_ENT(ent)->GetCollideable()->OBBMins();
     Vector ent_maxs  = RAW_ENT(ent)->GetCollideable()->OBBMaxs();
+    std::array<Vector, 40> path;
+    {
+        // Restores the entity once it goes out of scope
+        EnginePredictionSession session(ent);
+        session.Step(steplength, maxsteps, path.data());
+    }
     for (int steps = 0; steps < maxsteps; steps++, currenttime += steplength)
     {
-        ent->m_vecOrigin() = current;
-        current            = EnginePrediction(ent, steplength);
+        current = path[steps];
 
         if (onground)
         {
@@ -281,8 +399,6 @@ Vector ProjectilePrediction_Engine(CachedEntity *ent, int hb, float speed, float
             mindelta = fabs(rockettime - currenttime);
         }
     }
-    const_cast<Vector &>(RAW_ENT(ent)->GetAbsOrigin()) = origin;
-    CE_VECTOR(ent, 0x354)                              = origin;
     // Compensate for ping
     besttime += g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + cl_interp->GetFloat();
     bestpos.z += (sv_gravity->GetFloat() / 2.0f * besttime * besttime * gravitymod - proj_startvelocity * besttime);
@@ -292,59 +408,119 @@ Vector ProjectilePrediction_Engine(CachedEntity *ent, int hb, float speed, float
                   result.y - origin.y, result.z - origin.z);*/
     return result;
 }
-Vector BuildingPrediction(CachedEntity *building, Vector vec, float speed, float gravity, float proj_startvelocity)
+// Aimbot, MiscAimbot and friends tend to ask for the same target with the same weapon in one tick, so they share results.
+// Cleared at the start of every CreateMove
+namespace prediction_cache
 {
-    if (!vec.z || CE_BAD(building))
-        return Vector();
-    Vector result = vec;
-    // if (not debug_pp_extrapolate) {
-    //} else {
-    //        result = SimpleLatencyPrediction(ent, hb);
-    //
-    //}
+struct entry
+{
+    int entity;
+    int hitbox;
+    float speed;
+    float gravity;
+    float start_velocity;
+    // Gravity of the target itself, 0 for buildings
+    float entity_gravity;
+    // Point the caller aims at on a building, players go by hitbox instead
+    Vector aim;
+    Vector position;
+    float flight_time;
+};
+static std::vector<entry> entries;
+
+static const entry *Find(int entity, int hitbox, float speed, float gravity, float start_velocity, float entity_gravity, const Vector &aim)
+{
+    for (auto &cached : entries)
+        if (cached.entity == entity && cached.hitbox == hitbox && cached.speed == speed && cached.gravity == gravity && cached.start_velocity == start_velocity && cached.entity_gravity == entity_gravity && cached.aim == aim)
+            return &cached;
+    return nullptr;
+}
 
-    if (speed == 0.0f)
-        return Vector();
-    static ConVar *sv_gravity = g_ICvar->FindVar("sv_gravity");
-    trace::filter_no_player.SetSelf(RAW_ENT(building));
-    float dtg = DistanceToGround(vec, RAW_ENT(building)->GetCollideable()->OBBMins(), RAW_ENT(building)->GetCollideable()->OBBMaxs());
-    // TODO ProjAim
-    float medianTime  = g_pLocalPlayer->v_Eye.DistTo(result) / speed;
-    float range       = 1.5f;
-    float currenttime = medianTime - range;
-    if (currenttime <= 0.0f)
-        currenttime = 0.01f;
-    float besttime = currenttime;
+static const Vector &Store(int entity, int hitbox, float speed, float gravity, float start_velocity, float entity_gravity, const Vector &aim, const Vector &position, float flight_time)
+{
+    entries.push_back({ entity, hitbox, speed, gravity, start_velocity, entity_gravity, aim, position, flight_time });
+    return entries.back().position;
+}
+
+static InitRoutine init([]() { EC::Register(EC::CreateMove, []() { entries.clear(); }, "prediction_cache_reset", EC::very_early); });
+} // namespace prediction_cache
+
+// Solves |eye - position(t)| / speed + delay == t for the time the target gets hit, position(t) has to be a closed form path.
+// Safeguarded Newton, every step that leaves the bracket gets replaced by a bisection step
+template <typename Position, typename Velocity> static float SolveIntercept(const Vector &eye, float speed, float delay, float max_time, Position &&position, Velocity &&velocity)
+{
+    auto error = [&](float time) { return eye.DistTo(position(time)) / speed + delay - time; };
+    float low  = 0.0f;
+    float high = max_time;
+    // Target outruns the projectile, the end of the window is as close as it gets
+    if (error(high) > 0.0f)
+        return high;
+    float time = std::clamp(eye.DistTo(position(0.0f)) / speed + delay, low, high);
+    for (int i = 0; i < 8; i++)
+    {
+        float value = error(time);
+        if (std::fabs(value) < 0.0005f)
+            break;
+        if (value > 0.0f)
+            low = time;
+        else
+            high = time;
+        Vector delta     = position(time) - eye;
+        float distance   = delta.Length();
+        float derivative = (distance > 0.0f ? delta.Dot(velocity(time)) / (distance * speed) : 0.0f) - 1.0f;
+        float next       = derivative != 0.0f ? time - value / derivative : high;
+        time             = next > low && next < high ? next : (low + high) / 2.0f;
+    }
+    return time;
+}
+
+// Fallback for paths the closed form can't describe, samples the window and takes the best match
+static float StepIntercept(const Vector &eye, float speed, float delay, float start, float steplength, const Vector *path, int count, Vector &best)
+{
+    float besttime = start;
     float mindelta = 65536.0f;
-    Vector bestpos = result;
-    int maxsteps   = 300;
-    for (int steps = 0; steps < maxsteps; steps++, currenttime += ((float) (2 * range) / (float) maxsteps))
+    best           = path[0];
+    for (int i = 0; i < count; i++)
     {
-        Vector curpos = result;
-        if (dtg > 0.0f)
-        {
-            if (curpos.z < result.z - dtg)
-                curpos.z = result.z - dtg;
-        }
-        float rockettime = g_pLocalPlayer->v_Eye.DistTo(curpos) / speed;
-        // Compensate for ping
-        rockettime += g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + cl_interp->GetFloat();
-        if (fabs(rockettime - currenttime) < mindelta)
+        float time  = start + i * steplength;
+        float delta = std::fabs(eye.DistTo(path[i]) / speed + delay - time);
+        if (delta < mindelta)
         {
-            besttime = currenttime;
-            bestpos  = curpos;
-            mindelta = fabs(rockettime - currenttime);
+            besttime = time;
+            best     = path[i];
+            mindelta = delta;
         }
     }
+    return besttime;
+}
+
+Vector BuildingPrediction(CachedEntity *building, Vector vec, float speed, float gravity, float proj_startvelocity)
+{
+    if (!vec.z || CE_BAD(building))
+        return Vector();
+    if (speed == 0.0f)
+        return Vector();
+    // Buildings have no hitboxes
+    if (auto cached = prediction_cache::Find(building->m_IDX, -1, speed, gravity, proj_startvelocity, 0.0f, vec))
+        return cached->position;
+    static ConVar *sv_gravity = g_ICvar->FindVar("sv_gravity");
+    float latency             = g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + cl_interp->GetFloat();
+
+    // Buildings don't move, so this converges right away
+    float medianTime = g_pLocalPlayer->v_Eye.DistTo(vec) / speed;
+    float besttime   = SolveIntercept(g_pLocalPlayer->v_Eye, speed, latency, medianTime + 1.5f, [&](float) { return vec; }, [](float) { return Vector(); });
     // Compensate for ping
-    besttime += g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + cl_interp->GetFloat();
+    besttime += latency;
+    Vector bestpos = vec;
     bestpos.z += (sv_gravity->GetFloat() / 2.0f * besttime * besttime * gravity - proj_startvelocity * besttime);
     // S = at^2/2 ; t = sqrt(2S/a)*/
-    return bestpos;
+    return prediction_cache::Store(building->m_IDX, -1, speed, gravity, proj_startvelocity, 0.0f, vec, bestpos, besttime);
 }
 
 Vector ProjectilePrediction(CachedEntity *ent, int hb, float speed, float gravitymod, float entgmod, float proj_startvelocity)
 {
+    if (auto cached = prediction_cache::Find(ent->m_IDX, hb, speed, gravitymod, proj_startvelocity, entgmod, Vector()))
+        return cached->position;
     Vector origin = ent->m_vecOrigin();
     Vector hitbox;
     GetHitbox(ent, hb, hitbox);
@@ -353,18 +529,9 @@ Vector ProjectilePrediction(CachedEntity *ent, int hb, float speed, float gravit
     if (speed == 0.0f)
         return Vector();
 
-    // TODO ProjAim
-    float medianTime  = g_pLocalPlayer->v_Eye.DistTo(hitbox) / speed;
-    float range       = 1.5f;
-    float currenttime = medianTime - range;
-    if (currenttime <= 0.0f)
-        currenttime = 0.01f;
-    float besttime = currenttime;
-    float mindelta = 65536.0f;
-    Vector bestpos = origin;
-    Vector current = origin;
-    int maxsteps   = 40;
-    bool onground  = false;
+    float medianTime = g_pLocalPlayer->v_Eye.DistTo(hitbox) / speed;
+    float range      = 1.5f;
+    bool onground    = false;
     if (ent->m_Type() == ENTITY_PLAYER)
     {
         if (CE_INT(ent, netvar.iFlags) & FL_ONGROUND)
@@ -372,48 +539,47 @@ Vector ProjectilePrediction(CachedEntity *ent, int hb, float speed, float gravit
     }
 
     Vector velocity;
-    velocity::EstimateAbsVelocity(RAW_ENT(ent), velocity);
+    velocity::Get(ent, velocity);
     static ConVar *sv_gravity = g_ICvar->FindVar("sv_gravity");
     Vector acceleration       = { 0.0f, 0.0f, -(sv_gravity->GetFloat() * entgmod) };
-    float steplength          = ((float) (2 * range) / (float) maxsteps);
-    auto minmax               = std::make_pair(RAW_ENT(ent)->GetCollideable()->OBBMins(), RAW_ENT(ent)->GetCollideable()->OBBMaxs());
-
-    float dist_to_ground = DistanceToGround(origin, minmax.first, minmax.second);
-
-    Vector last = origin;
+    float latency             = g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + cl_interp->GetFloat();
+    const Vector &eye         = g_pLocalPlayer->v_Eye;
 
-    for (int steps = 0; steps < maxsteps; steps++, currenttime += steplength)
+    float besttime;
+    Vector bestpos;
+    if (onground)
     {
-        if (steps == 0)
-            last = Predict(last, velocity, acceleration, dist_to_ground, currenttime);
-        else
-            last = PredictStep(last, velocity, acceleration, minmax, currenttime, steplength);
-
-        current = last;
-        if (onground)
-        {
-            float toground = DistanceToGround(current, minmax.first, minmax.second);
-            current.z -= toground;
-        }
-
-        float rockettime = g_pLocalPlayer->v_Eye.DistTo(current) / speed;
-        // Compensate for ping
-        rockettime += g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + cl_interp->GetFloat();
-        if (fabs(rockettime - currenttime) < mindelta)
+        // Walking, straight line along the ground
+        Vector ground_velocity(velocity.x, velocity.y, 0.0f);
+        besttime = SolveIntercept(eye, speed, latency, medianTime + range, [&](float time) { return origin + ground_velocity * time; }, [&](float) { return ground_velocity; });
+        bestpos = origin + ground_velocity * besttime;
+    }
+    else
+    {
+        // In the air, a simple ballistic path until it hits the ground
+        auto position = [&](float time) { return origin + velocity * time + acceleration * (0.5f * time * time); };
+        besttime      = SolveIntercept(eye, speed, latency, medianTime + range, position, [&](float time) { return velocity + acceleration * time; });
+        bestpos = position(besttime);
+
+        auto minmax          = std::make_pair(RAW_ENT(ent)->GetCollideable()->OBBMins(), RAW_ENT(ent)->GetCollideable()->OBBMaxs());
+        float dist_to_ground = DistanceToGround(origin, minmax.first, minmax.second);
+        // Lands before the projectile arrives, step through the landing instead
+        if (bestpos.z < origin.z - dist_to_ground)
         {
-            besttime = currenttime;
-            bestpos  = current;
-            mindelta = fabs(rockettime - currenttime);
+            constexpr int maxsteps = 40;
+            float currenttime      = std::max(medianTime - range, 0.01f);
+            float steplength       = (2 * range) / maxsteps;
+            std::array<Vector, maxsteps> path;
+            PredictPath(origin, velocity, acceleration, minmax, currenttime, steplength, maxsteps, path.data(), true, dist_to_ground);
+            besttime = StepIntercept(eye, speed, latency, currenttime, steplength, path.data(), maxsteps, bestpos);
         }
     }
     // Compensate for ping
-    besttime += g_IEngine->GetNetChannelInfo()->GetLatency(FLOW_OUTGOING) + cl_interp->GetFloat();
+    besttime += latency;
     bestpos.z += (sv_gravity->GetFloat() / 2.0f * besttime * besttime * gravitymod - proj_startvelocity * besttime);
     // S = at^2/2 ; t = sqrt(2S/a)*/
     Vector result = bestpos + hitbox_offset;
-    /*logging::Info("[Pred][%d] delta: %.2f   %.2f   %.2f", result.x - origin.x,
-                  result.y - origin.y, result.z - origin.z);*/
-    return result;
+    return prediction_cache::Store(ent->m_IDX, hb, speed, gravitymod, proj_startvelocity, entgmod, Vector(), result, besttime);
 }
 
 float DistanceToGround(CachedEntity *ent)
@@ -431,7 +597,7 @@ float DistanceToGround(Vector origin, Vector mins, Vector maxs)
     Vector endpos = origin;
     endpos.z -= 8192;
     ray.Init(origin, endpos, mins, maxs);
-    g_ITrace->TraceRay(ray, MASK_PLAYERSOLID, &trace::filter_no_player, &ground_trace);
+    trace::TraceRay(ray, MASK_PLAYERSOLID, &trace::filter_no_player, &ground_trace);
     return std::fabs(origin.z - ground_trace.endpos.z);
 }
 
@@ -442,6 +608,6 @@ float DistanceToGround(Vector origin)
     Vector endpos = origin;
     endpos.z -= 8192;
     ray.Init(origin, endpos);
-    g_ITrace->TraceRay(ray, MASK_PLAYERSOLID, &trace::filter_no_player, &ground_trace);
+    trace::TraceRay(ray, MASK_PLAYERSOLID, &trace::filter_no_player, &ground_trace);
     return std::fabs(origin.z - ground_trace.endpos.z);
 }
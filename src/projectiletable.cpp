@@ -0,0 +1,68 @@
+#include "common.hpp"
+#include "projectiletable.hpp"
+
+namespace projectile_table
+{
+static std::vector<params_s> table{};
+
+// Class ids are only known at runtime when they're dynamic, so the table gets filled on first use
+static void Build()
+{
+    // clang-format off
+    table = {
+        //  class                                     item   speed    grav  start   charge  charged speed/grav  zero
+        { CL_CLASS(CTFRocketLauncher_DirectHit),       -1, 1980.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        // Liberty Launcher
+        { CL_CLASS(CTFRocketLauncher),                414, 1540.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFRocketLauncher_AirStrike),      414, 1540.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFParticleCannon),                414, 1540.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFRocketLauncher),                 -1, 1100.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFRocketLauncher_AirStrike),       -1, 1100.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFParticleCannon),                 -1, 1100.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFCannon),                         -1, 1400.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFGrenadeLauncher),                -1, 1200.0f, 1.0f, 200.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFPipebombLauncher),               -1,  900.0f, 0.4f,   0.0f,  4.0f, 2400.0f, 0.4f, true  },
+        { CL_CLASS(CTFCompoundBow),                    -1, 1800.0f, 0.5f,   0.0f,  1.0f, 2600.0f, 0.1f, false },
+        { CL_CLASS(CTFBat_Giftwrap),                   -1, 3000.0f, 0.5f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFBat_Wood),                       -1, 3000.0f, 0.5f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFFlareGun),                       -1, 2000.0f, 0.25f,  0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFSyringeGun),                     -1,  990.0f, 0.2f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFCrossbow),                       -1, 2400.0f, 0.2f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFShotgunBuildingRescue),          -1, 2400.0f, 0.2f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFDRGPomson),                      -1, 1200.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFWeaponFlameBall),                -1, 3000.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFRaygun),                         -1, 1200.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+        { CL_CLASS(CTFGrapplingHook),                  -1, 1500.0f, 0.0f,   0.0f,  0.0f,    0.0f, 0.0f, false },
+    };
+    // clang-format on
+    // Loch'n Load, only TF2 has it
+    IF_GAME(IsTF2())
+    {
+        table.insert(table.begin(), { CL_CLASS(CTFGrenadeLauncher), 308, 1500.0f, 1.0f, 200.0f, 0.0f, 0.0f, 0.0f, false });
+    }
+}
+
+void params_s::Charge(CachedEntity *weapon, float &speed, float &gravity) const
+{
+    float begin  = CE_FLOAT(weapon, netvar.flChargeBeginTime);
+    float charge = zero_uncharged && !begin ? 0.0f : g_GlobalVars->curtime - begin;
+    speed        = RemapValClamped(charge, 0.0f, charge_time, this->speed, charged_speed);
+    gravity      = RemapValClamped(charge, 0.0f, charge_time, this->gravity, charged_gravity);
+}
+
+const params_s *Find(CachedEntity *weapon)
+{
+    IF_GAME(!IsTF()) return nullptr;
+    if (CE_BAD(weapon))
+        return nullptr;
+    if (table.empty())
+        Build();
+    int class_id        = weapon->m_iClassID();
+    int item_definition = CE_INT(weapon, netvar.iItemDefinitionIndex);
+    // Item specific entries come first
+    for (auto &params : table)
+        if (params.class_id == class_id && (params.item_definition == -1 || params.item_definition == item_definition))
+            return &params;
+    return nullptr;
+}
+} // namespace projectile_table
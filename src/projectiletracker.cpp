@@ -0,0 +1,56 @@
+#include "projectiletracker.hpp"
+#include "common.hpp"
+
+namespace projectile_tracker
+{
+static std::vector<projectile_s> projectiles;
+
+float projectile_s::TimeToClosestApproach(const Vector &pos) const
+{
+    float speed_sqr = velocity.LengthSqr();
+    if (speed_sqr < 1.0f)
+        return 0.0f;
+    return std::max(0.0f, (pos - origin).Dot(velocity) / speed_sqr);
+}
+
+float projectile_s::ClosestApproach(const Vector &pos, float max_time) const
+{
+    return PositionAt(std::min(TimeToClosestApproach(pos), max_time)).DistTo(pos);
+}
+
+void Update()
+{
+    projectiles.clear();
+    if (CE_BAD(LOCAL_E))
+        return;
+    for (CachedEntity *ent : entity_cache::projectiles())
+    {
+        if (CE_INVALID(ent))
+            continue;
+        projectile_s projectile;
+        projectile.entity  = ent;
+        projectile.classid = ent->m_iClassID();
+        projectile.enemy   = ent->m_bEnemy();
+        projectile.crit    = ent->m_bCritProjectile();
+        projectile.grenade = ent->m_bGrenadeProjectile();
+        projectile.sticky  = projectile.classid == CL_CLASS(CTFGrenadePipebombProjectile) && CE_INT(ent, netvar.iPipeType) == 1;
+        int owner            = HandleToIDX(CE_INT(ent, projectile.grenade ? netvar.hThrower : netvar.m_hOwnerEntity));
+        projectile.owner     = owner > 0 && owner <= MAX_PLAYERS ? owner : -1;
+        projectile.deflected = CE_INT(ent, projectile.grenade ? netvar.Grenade_iDeflected : netvar.Rocket_iDeflected);
+        projectile.dormant   = RAW_ENT(ent)->IsDormant();
+        projectile.origin    = ent->m_vecOrigin();
+        if (projectile.dormant)
+            projectile.velocity.Zero();
+        else if (velocity::EstimateAbsVelocity)
+            velocity::EstimateAbsVelocity(RAW_ENT(ent), projectile.velocity);
+        else
+            projectile.velocity = CE_VECTOR(ent, netvar.vVelocity);
+        projectiles.push_back(projectile);
+    }
+}
+
+const std::vector<projectile_s> &All()
+{
+    return projectiles;
+}
+} // namespace projectile_tracker
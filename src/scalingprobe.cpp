@@ -0,0 +1,149 @@
+/*
+ * Buckets the per-tick cost of every profiler section and the tracked memory by how many entities are valid, so a
+ * busy server shows which stage grows the fastest with entity count.
+ *
+ * debug_scaling_probe <seconds> writes a csv to /tmp with one row per bucket and section:
+ *   entities,ticks,players,section,avg_us,max_us
+ * entities is the lower bound of the bucket. Memory rows use "mem:<tag>" as the section and bytes instead of us.
+ *
+ * There's no synthetic scene behind this. The snapshot, vischeck, backtrack, prediction and planner all read the
+ * engine, so the curves only cover the entity counts a real server reached during the probe.
+ */
+#include "common.hpp"
+#include "jobs.hpp"
+#include "memtrack.hpp"
+#include <pwd.h>
+
+namespace scaling_probe
+{
+constexpr int BUCKET_SIZE = 32;
+// Memory goes through the reporters, once a second is plenty
+constexpr int MEMORY_INTERVAL = 66;
+
+struct section_s
+{
+    uint64_t sum_ns{ 0 };
+    uint64_t max_ns{ 0 };
+};
+
+struct bucket_s
+{
+    unsigned ticks{ 0 };
+    uint64_t players{ 0 };
+    std::unordered_map<std::string, section_s> sections;
+    int64_t memory[memtrack::TAG_COUNT]{};
+};
+
+static std::map<int, bucket_s> buckets;
+// Section sums at the last tick, the profiler only keeps running totals
+static std::unordered_map<std::string, uint64_t> last_sum;
+// Latest memory sample, every bucket a tick lands in gets it, not just the one that was current when it was taken
+static int64_t memory_live[memtrack::TAG_COUNT]{};
+static std::vector<profiler::section_stats_s> sections;
+static int ticks_left       = 0;
+static unsigned saved_mask  = 0;
+static int memory_countdown = 0;
+
+static void Finish()
+{
+    profiler::sample_mask = saved_mask;
+    passwd *pwd           = getpwuid(getuid());
+    std::string path      = strfmt("/tmp/cathook-%s-%d-scaling-%ld.csv", pwd->pw_name, getpid(), (long) time(nullptr)).get();
+    auto data             = std::make_shared<std::map<int, bucket_s>>(std::move(buckets));
+    buckets.clear();
+    last_sum.clear();
+    jobs::Background([path, data]() {
+        std::ofstream out(path);
+        out << "entities,ticks,players,section,avg_us,max_us\n";
+        for (auto &[entities, bucket] : *data)
+        {
+            float players = float(bucket.players) / bucket.ticks;
+            for (auto &[name, section] : bucket.sections)
+                out << entities << ',' << bucket.ticks << ',' << players << ',' << name << ',' << section.sum_ns / 1000.0 / bucket.ticks << ',' << section.max_ns / 1000.0 << '\n';
+            for (int i = 0; i < memtrack::TAG_COUNT; i++)
+                out << entities << ',' << bucket.ticks << ',' << players << ",mem:" << memtrack::Name(memtrack::tag(i)) << ',' << bucket.memory[i] << ',' << bucket.memory[i] << '\n';
+        }
+        logging::Info("[SP] Wrote %u buckets to %s", unsigned(data->size()), path.c_str());
+    });
+}
+
+static void CreateMove()
+{
+    if (!ticks_left || CE_BAD(LOCAL_E))
+        return;
+    size_t entities = 0;
+    for (int type = 0; type < ENTITY_TYPE_COUNT; type++)
+        entities += entity_cache::valid_by_type[type].size();
+    bucket_s &bucket = buckets[int(entities) / BUCKET_SIZE * BUCKET_SIZE];
+    bucket.ticks++;
+    bucket.players += entity_cache::players().size();
+
+    // Whatever finished since the last tick, which includes the end of the previous CreateMove and its frames
+    sections.clear();
+    profiler::CollectSections(sections);
+    for (auto &section : sections)
+    {
+        uint64_t &last = last_sum[section.name];
+        // Sums start over after a spew
+        uint64_t delta = section.sum_ns >= last ? section.sum_ns - last : section.sum_ns;
+        last           = section.sum_ns;
+        if (!delta)
+            continue;
+        auto &stats = bucket.sections[section.name];
+        stats.sum_ns += delta;
+        stats.max_ns = std::max(stats.max_ns, delta);
+    }
+
+    if (--memory_countdown <= 0)
+    {
+        memory_countdown = MEMORY_INTERVAL;
+        memtrack::Update();
+        for (int i = 0; i < memtrack::TAG_COUNT; i++)
+            memory_live[i] = memtrack::stats[i].Live();
+    }
+    for (int i = 0; i < memtrack::TAG_COUNT; i++)
+        bucket.memory[i] = std::max(bucket.memory[i], memory_live[i]);
+
+    if (!--ticks_left)
+        Finish();
+}
+
+static void Abort()
+{
+    if (!ticks_left)
+        return;
+    logging::Info("[SP] Level changed, probe stopped");
+    ticks_left = 0;
+    Finish();
+}
+
+static CatCommand probe("debug_scaling_probe", "Bucket every section's per-tick cost by entity count for <seconds>, written to /tmp", [](const CCommand &args) {
+    if (ticks_left)
+    {
+        logging::Info("[SP] Already running, %d ticks left", ticks_left);
+        return;
+    }
+    int seconds = args.ArgC() > 1 ? atoi(args.Arg(1)) : 60;
+    if (seconds <= 0)
+        return;
+    buckets.clear();
+    last_sum.clear();
+    // Otherwise the first tick would count everything since the last spew
+    sections.clear();
+    profiler::CollectSections(sections);
+    for (auto &section : sections)
+        last_sum[section.name] = section.sum_ns;
+    // Every node, a sampled profile would have most ticks at 0
+    saved_mask            = profiler::sample_mask;
+    profiler::sample_mask = 0;
+    memory_countdown      = 0;
+    ticks_left            = int(seconds / g_GlobalVars->interval_per_tick);
+    logging::Info("[SP] Probing for %d ticks", ticks_left);
+});
+
+static InitRoutine init([]() {
+    // Last, so this tick's stages are already in the sums
+    EC::Register(EC::CreateMove, CreateMove, "cm_scaling_probe", EC::very_late);
+    EC::Register(EC::LevelShutdown, Abort, "levelshutdown_scaling_probe");
+});
+} // namespace scaling_probe
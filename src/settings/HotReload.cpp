@@ -0,0 +1,112 @@
+#include <settings/HotReload.hpp>
+#include <settings/SettingsIO.hpp>
+#include <settings/Bool.hpp>
+#include <settings/Int.hpp>
+#include <hooks/HookTools.hpp>
+#include <init.hpp>
+#include <pathio.hpp>
+#include <timer.hpp>
+#include <jobs.hpp>
+#include "core/logging.hpp"
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+
+namespace settings::hot_reload
+{
+static settings::Boolean enable{ "settings.hot-reload", "false" };
+static settings::Int interval{ "settings.hot-reload.interval-ms", "500" };
+
+static int inotify_fd = -1;
+// inotify isn't there at all, don't keep trying
+static bool unavailable = false;
+// Empty until cat_load loaded something
+static std::string watched{};
+// A poll is on the job pool, the fd belongs to it until it's done
+static std::atomic<bool> polling{ false };
+static Timer poll_timer{};
+
+void Watch(const std::string &name)
+{
+    watched = name;
+}
+
+static bool Open()
+{
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Our own saves and most tools rename a temporary file over the config, editors writing in place close it
+    if (inotify_fd < 0 || inotify_add_watch(inotify_fd, paths::getConfigPath().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        logging::Info("Hot reload: can't watch %s, disabled", paths::getConfigPath().c_str());
+        if (inotify_fd >= 0)
+            close(inotify_fd);
+        inotify_fd  = -1;
+        unavailable = true;
+        return false;
+    }
+    return true;
+}
+
+// Runs on the job pool
+static bool Changed(int fd, const std::string &name)
+{
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *at = buffer; at < buffer + length;)
+        {
+            auto *event = reinterpret_cast<inotify_event *>(at);
+            if (event->len && name == event->name)
+                changed = true;
+            at += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+static void Apply(const std::string &name, const SettingsReader::values_t &values)
+{
+    polling.store(false, std::memory_order_release);
+    // cat_load switched to another file while this one was parsed
+    if (name != watched)
+        return;
+    SettingsReader reader{ Manager::instance() };
+    size_t changed = reader.applyValues(values);
+    logging::Info("Hot reload: %s changed, %u variables updated", name.c_str(), unsigned(changed));
+}
+
+static void Poll()
+{
+    if (watched.empty() || unavailable || polling.load(std::memory_order_acquire) || !poll_timer.test_and_set(std::max(*interval, 100)))
+        return;
+    if (inotify_fd < 0 && !Open())
+        return;
+    polling.store(true, std::memory_order_relaxed);
+    jobs::Background([fd = inotify_fd, name = watched, path = paths::getConfigPath() + "/" + watched]() {
+        auto values = std::make_shared<SettingsReader::values_t>();
+        SettingsReader reader{ Manager::instance() };
+        if (!Changed(fd, name) || !reader.parseFile(path, *values))
+        {
+            polling.store(false, std::memory_order_release);
+            return;
+        }
+        jobs::Defer([name, values]() { Apply(name, *values); });
+    });
+}
+
+static InitRoutine init([]() {
+    EC::Register(EC::Paint, Poll, "settings_hot_reload", enable, EC::average);
+    EC::Register(
+        EC::Shutdown,
+        []() {
+            // A poll still running keeps using the fd, the process closes it when it's gone
+            if (inotify_fd >= 0 && !polling.load())
+                close(inotify_fd);
+            inotify_fd = -1;
+        },
+        "shutdown_settings_hot_reload");
+});
+} // namespace settings::hot_reload
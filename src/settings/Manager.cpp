@@ -4,6 +4,7 @@
 
 #include "logging.hpp"
 #include <settings/Manager.hpp>
+#include <algorithm>
 
 namespace settings
 {
@@ -22,6 +23,7 @@ void Manager::add(IVariable &me, std::string name)
         throw std::runtime_error("Double registering variable: " + name);
     }
     registered.emplace(name, me);
+    index_dirty = true;
 }
 
 void Manager::add(IVariable &me, std::string name, std::string value)
@@ -32,6 +34,7 @@ void Manager::add(IVariable &me, std::string name, std::string value)
         throw std::runtime_error("Double registering variable: " + name);
     }
     registered.emplace(name, Manager::VariableDescriptor{ me, value });
+    index_dirty = true;
 }
 
 IVariable *Manager::lookup(const std::string &string)
@@ -42,16 +45,48 @@ IVariable *Manager::lookup(const std::string &string)
     return nullptr;
 }
 
+const std::vector<Manager::index_entry> &Manager::sorted()
+{
+    if (index_dirty)
+    {
+        index.clear();
+        index.reserve(registered.size());
+        for (auto &v : registered)
+            index.emplace_back(&v.first, &v.second);
+        std::sort(index.begin(), index.end(), [](const index_entry &a, const index_entry &b) { return *a.first < *b.first; });
+        index_dirty = false;
+    }
+    return index;
+}
+
+std::pair<Manager::index_iterator, Manager::index_iterator> Manager::withPrefix(std::string_view prefix)
+{
+    auto &all  = sorted();
+    auto begin = std::lower_bound(all.begin(), all.end(), prefix, [](const index_entry &entry, std::string_view prefix) { return std::string_view(*entry.first) < prefix; });
+    auto end   = begin;
+    while (end != all.end() && std::string_view(*end->first).substr(0, prefix.size()) == prefix)
+        ++end;
+    return { begin, end };
+}
+
+void Manager::resetToDefaults()
+{
+    for (auto &v : registered)
+        v.second.variable.resetToDefault();
+}
+
 Manager::VariableDescriptor::VariableDescriptor(IVariable &variable) : variable(variable)
 {
     type     = variable.getType();
     defaults = variable.toString();
+    variable.storeDefault();
 }
 
 Manager::VariableDescriptor::VariableDescriptor(IVariable &variable, std::string value) : variable(variable)
 {
     type     = variable.getType();
     defaults = value;
+    variable.storeDefault();
 }
 
 bool Manager::VariableDescriptor::isChanged()
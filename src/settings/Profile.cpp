@@ -0,0 +1,248 @@
+#include <settings/Profile.hpp>
+#include <settings/Settings.hpp>
+#include <settings/Manager.hpp>
+#include <core/sdk.hpp>
+#include <core/cvwrapper.hpp>
+#include <init.hpp>
+#include <MiscTemporary.hpp>
+#include "core/logging.hpp"
+#include <cstring>
+#include <fstream>
+
+namespace settings::profile
+{
+// FNV-1a
+static uint64_t Hash(uint64_t hash, const void *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ ((const uint8_t *) data)[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+uint64_t Schema()
+{
+    static uint64_t schema    = 0;
+    static size_t schema_size = 0;
+    auto &all                 = Manager::instance().sorted();
+    if (schema_size != all.size())
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (auto &v : all)
+        {
+            uint8_t type = uint8_t(v.second->type);
+            // Keeps the terminator so "a" + "bc" and "ab" + "c" differ
+            hash = Hash(hash, v.first->c_str(), v.first->size() + 1);
+            hash = Hash(hash, &type, sizeof(type));
+        }
+        schema      = hash;
+        schema_size = all.size();
+    }
+    return schema;
+}
+
+template <typename T> static void Put(std::string &out, const T &value)
+{
+    out.append((const char *) &value, sizeof(T));
+}
+
+std::string Compile()
+{
+    auto &all = Manager::instance().sorted();
+    std::string out(sizeof(header_s), '\0');
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < all.size(); i++)
+    {
+        auto &descriptor = *all[i].second;
+        if (!descriptor.isChanged())
+            continue;
+        IVariable &variable = descriptor.variable;
+        Put(out, i);
+        switch (descriptor.type)
+        {
+        case VariableType::BOOL:
+            Put(out, uint8_t(*static_cast<Variable<bool> &>(variable)));
+            break;
+        case VariableType::INT:
+            Put(out, int32_t(*static_cast<Variable<int> &>(variable)));
+            break;
+        case VariableType::FLOAT:
+            Put(out, *static_cast<Variable<float> &>(variable));
+            break;
+#if ENABLE_VISUALS
+        case VariableType::COLOR:
+            Put(out, (*static_cast<Variable<rgba_t> &>(variable)).rgba);
+            break;
+#endif
+        // Strings and keys, keys only have a stable string form
+        default:
+        {
+            const std::string &string = variable.toString();
+            Put(out, uint32_t(string.size()));
+            out.append(string);
+            break;
+        }
+        }
+        count++;
+    }
+    header_s header{ MAGIC, VERSION, Schema(), count, uint32_t(out.size() - sizeof(header_s)) };
+    memcpy(&out[0], &header, sizeof(header));
+    return out;
+}
+
+struct reader_s
+{
+    const char *at;
+    const char *end;
+
+    template <typename T> bool get(T &out)
+    {
+        if (size_t(end - at) < sizeof(T))
+            return false;
+        memcpy(&out, at, sizeof(T));
+        at += sizeof(T);
+        return true;
+    }
+};
+
+// Runs once without applying anything to validate, so a broken profile can't leave half a config behind
+static bool Walk(const void *data, size_t size, bool apply)
+{
+    reader_s reader{ (const char *) data, (const char *) data + size };
+    header_s header;
+    if (!reader.get(header) || header.magic != MAGIC || header.version != VERSION)
+    {
+        logging::Info("Profile: not a profile or wrong version");
+        return false;
+    }
+    if (header.schema != Schema())
+    {
+        logging::Info("Profile: compiled for a different set of variables, recompile it from the .conf");
+        return false;
+    }
+    if (header.size != size_t(reader.end - reader.at))
+    {
+        logging::Info("Profile: truncated");
+        return false;
+    }
+
+    auto &all = Manager::instance().sorted();
+    std::string string{};
+    for (uint32_t n = 0; n < header.count; n++)
+    {
+        uint32_t index;
+        if (!reader.get(index) || index >= all.size())
+            return false;
+        IVariable &variable = all[index].second->variable;
+        switch (all[index].second->type)
+        {
+        case VariableType::BOOL:
+        {
+            uint8_t value;
+            if (!reader.get(value))
+                return false;
+            if (apply)
+                static_cast<Variable<bool> &>(variable) = bool(value);
+            break;
+        }
+        case VariableType::INT:
+        {
+            int32_t value;
+            if (!reader.get(value))
+                return false;
+            if (apply)
+                static_cast<Variable<int> &>(variable) = int(value);
+            break;
+        }
+        case VariableType::FLOAT:
+        {
+            float value;
+            if (!reader.get(value))
+                return false;
+            if (apply)
+                static_cast<Variable<float> &>(variable) = value;
+            break;
+        }
+#if ENABLE_VISUALS
+        case VariableType::COLOR:
+        {
+            float value[4];
+            if (!reader.get(value))
+                return false;
+            if (apply)
+                static_cast<Variable<rgba_t> &>(variable) = rgba_t(value[0], value[1], value[2], value[3]);
+            break;
+        }
+#endif
+        default:
+        {
+            uint32_t length;
+            if (!reader.get(length) || size_t(reader.end - reader.at) < length)
+                return false;
+            if (apply)
+            {
+                string.assign(reader.at, length);
+                variable.fromString(string);
+            }
+            reader.at += length;
+            break;
+        }
+        }
+    }
+    return reader.at == reader.end;
+}
+
+bool Load(const void *data, size_t size)
+{
+    if (!Walk(data, size, false))
+        return false;
+    CallbackBatch batch{};
+    Manager::instance().resetToDefaults();
+    Walk(data, size, true);
+    return true;
+}
+
+bool SaveTo(const std::string &path)
+{
+    std::string data = Compile();
+    std::string temp = path + ".tmp";
+    std::ofstream file(temp, std::ios::out | std::ios::binary);
+    file.write(data.data(), data.size());
+    file.close();
+    if (file && !std::rename(temp.c_str(), path.c_str()))
+        return true;
+    std::remove(temp.c_str());
+    return false;
+}
+
+bool LoadFrom(const std::string &path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    std::string data(size_t(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(data.data(), data.size());
+    return file && Load(data.data(), data.size());
+}
+
+static std::string ProfilePath(const CCommand &args)
+{
+    return paths::getConfigPath() + "/" + (args.ArgC() > 1 ? args.Arg(1) : "default") + ".catp";
+}
+
+static CatCommand save_profile("save_profile", "Compile the current settings into a profile", [](const CCommand &args) {
+    std::string path = ProfilePath(args);
+    if (SaveTo(path))
+        g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_save_profile: Saved %s\n", path.c_str());
+    else
+        g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_save_profile: Can't write %s!\n", path.c_str());
+});
+
+static CatCommand load_profile("load_profile", "Load a profile written by cat_save_profile", [](const CCommand &args) {
+    std::string path = ProfilePath(args);
+    if (LoadFrom(path))
+        g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_load_profile: Successfully loaded profile!\n");
+    else
+        g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_load_profile: Can't load %s, see the log!\n", path.c_str());
+});
+} // namespace settings::profile
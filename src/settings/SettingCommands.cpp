@@ -3,6 +3,7 @@
 #include <settings/Manager.hpp>
 #include <init.hpp>
 #include <settings/SettingsIO.hpp>
+#include <settings/HotReload.hpp>
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -133,33 +134,30 @@ static CatCommand save("save", "", [](const CCommand &args) {
         mkdir(paths::getConfigPath().c_str(), S_IRWXU | S_IRWXG);
     }
 
+    // New configs only show up once the write finished
+    auto sort_configs = [](bool) {
+        logging::Info("cat_save: Sorting configs...");
+        getAndSortAllConfigs();
+    };
     if (args.ArgC() == 1)
     {
-        writer.saveTo((paths::getConfigPath() + "/default.conf").c_str());
+        writer.saveTo((paths::getConfigPath() + "/default.conf").c_str(), false, sort_configs);
     }
     else
     {
-        writer.saveTo(paths::getConfigPath() + "/" + args.Arg(1) + ".conf");
+        writer.saveTo(paths::getConfigPath() + "/" + args.Arg(1) + ".conf", false, sort_configs);
     }
-    logging::Info("cat_save: Sorting configs...");
-    getAndSortAllConfigs();
     logging::Info("cat_save: Closing dir...");
     closedir(config_directory);
 });
 
 static CatCommand load("load", "", [](const CCommand &args) {
     settings::SettingsReader loader{ settings::Manager::instance() };
-    if (args.ArgC() == 1)
-    {
-        loader.loadFrom((paths::getConfigPath() + "/default.conf").c_str());
-    }
-    else
-    {
-        loader.loadFrom(paths::getConfigPath() + "/" + args.Arg(1) + ".conf");
-    }
+    std::string name = args.ArgC() == 1 ? "default.conf" : std::string(args.Arg(1)) + ".conf";
+    if (loader.loadFrom(paths::getConfigPath() + "/" + name))
+        settings::hot_reload::Watch(name);
 });
 
-static std::vector<std::string> sortedVariables{};
 #if ENABLE_VISUALS
 static CatCommand list_missing("list_missing", "List rvars missing in menu", []() {
     auto *sv = zerokernel::Menu::instance->wm->getElementById("special-variables");
@@ -168,24 +166,12 @@ static CatCommand list_missing("list_missing", "List rvars missing in menu", [](
         logging::Info("Special Variables tab missing!");
         return;
     }
-    for (auto &var : sortedVariables)
-        if (!zerokernel::special::SettingsManagerList::isVariableMarked(var))
-            logging::Info("%s", var.c_str());
+    for (auto &var : settings::Manager::instance().sorted())
+        if (!zerokernel::special::SettingsManagerList::isVariableMarked(*var.first))
+            logging::Info("%s", var.first->c_str());
 });
 #endif
 
-static void getAndSortAllVariables()
-{
-    for (auto &v : settings::Manager::instance().registered)
-    {
-        sortedVariables.push_back(v.first);
-    }
-
-    std::sort(sortedVariables.begin(), sortedVariables.end());
-
-    logging::Info("Sorted %u variables\n", sortedVariables.size());
-}
-
 std::vector<std::string> sortedConfigs{};
 
 static void getAndSortAllConfigs()
@@ -203,6 +189,9 @@ static void getAndSortAllConfigs()
     while ((ent = readdir(config_directory)))
     {
         std::string s(ent->d_name);
+        // Compiled profiles, cat_load can't read those
+        if (s.size() > 5 && !s.compare(s.size() - 5, 5, ".catp"))
+            continue;
         s = s.substr(0, s.find_last_of("."));
         if (s != "autosaves")
             sortedConfigs.push_back(s);
@@ -221,8 +210,9 @@ static CatCommand cat_find("find", "Find a command by name", [](const CCommand &
         return logging::Info("Usage: cat_find (name)");
     // Store all found rvars
     std::vector<std::string> found_rvars;
-    for (const auto &s : sortedVariables)
+    for (auto &var : settings::Manager::instance().sorted())
     {
+        const std::string &s = *var.first;
         // Store std::tolower'd rvar
         std::string lowered_str;
         for (auto &i : s)
@@ -288,21 +278,16 @@ static int cat_completionCallback(const char *c_partial, char commands[COMMAND_C
         return count;
     }
 
-    for (const auto &s : sortedVariables)
+    auto range = settings::Manager::instance().withPrefix(parts.at(1));
+    for (auto it = range.first; it != range.second; ++it)
     {
-        if (s.find(parts.at(1)) == 0)
-        {
-            auto variable = settings::Manager::instance().lookup(s);
-            if (variable)
-            {
-                if (s.compare(parts.at(1)))
-                    snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat %s %s", parts.at(0).c_str(), s.c_str());
-                else
-                    snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat %s %s %s", parts.at(0).c_str(), s.c_str(), variable->toString().c_str());
-                if (count == COMMAND_COMPLETION_MAXITEMS)
-                    break;
-            }
-        }
+        const std::string &s = *it->first;
+        if (s.compare(parts.at(1)))
+            snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat %s %s", parts.at(0).c_str(), s.c_str());
+        else
+            snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat %s %s %s", parts.at(0).c_str(), s.c_str(), it->second->variable.toString().c_str());
+        if (count == COMMAND_COMPLETION_MAXITEMS)
+            break;
     }
     return count;
 }
@@ -409,27 +394,26 @@ static int toggle_CompletionCallback(const char *c_partial, char commands[COMMAN
         }
     }
 
-    for (const auto &s : sortedVariables)
+    auto range = settings::Manager::instance().withPrefix(parts.at(0));
+    for (auto it = range.first; it != range.second; ++it)
     {
-        if (s.find(parts.at(0)) == 0)
-        {
-            if (parts.at(1) == "")
-                snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat_toggle %s", s.c_str());
-            else if (parts.at(2) == "")
-                snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat_toggle %s %s", s.c_str(), parts.at(1).c_str());
-            else
-                snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat_toggle %s %s %s", s.c_str(), parts.at(1).c_str(), parts.at(2).c_str());
-
-            if (count == COMMAND_COMPLETION_MAXITEMS)
-                break;
-        }
+        const std::string &s = *it->first;
+        if (parts.at(1) == "")
+            snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat_toggle %s", s.c_str());
+        else if (parts.at(2) == "")
+            snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat_toggle %s %s", s.c_str(), parts.at(1).c_str());
+        else
+            snprintf(commands[count++], COMMAND_COMPLETION_ITEM_LENGTH - 1, "cat_toggle %s %s %s", s.c_str(), parts.at(1).c_str(), parts.at(2).c_str());
+
+        if (count == COMMAND_COMPLETION_MAXITEMS)
+            break;
     }
 
     return count;
 }
 
 static InitRoutine init([]() {
-    getAndSortAllVariables();
+    logging::Info("Sorted %u variables\n", settings::Manager::instance().sorted().size());
     getAndSortAllConfigs();
     cat.cmd->m_bHasCompletionCallback    = true;
     cat.cmd->m_fnCompletionCallback      = cat_completionCallback;
@@ -7,4 +7,33 @@
 namespace settings
 {
 std::atomic<bool> cathook_disabled{ false };
+
+int CallbackBatch::depth{ 0 };
+std::vector<IVariable *> CallbackBatch::pending{};
+
+CallbackBatch::CallbackBatch()
+{
+    depth++;
+}
+
+CallbackBatch::~CallbackBatch()
+{
+    if (--depth)
+        return;
+    // Callbacks may change other variables, those run right away now that the batch is over
+    auto variables = std::move(pending);
+    pending.clear();
+    for (auto variable : variables)
+        variable->firePendingCallbacks();
+}
+
+bool CallbackBatch::active()
+{
+    return depth > 0;
+}
+
+void CallbackBatch::defer(IVariable &variable)
+{
+    pending.push_back(&variable);
 }
+} // namespace settings
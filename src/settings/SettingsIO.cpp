@@ -9,76 +9,134 @@
 #include "interfaces.hpp"
 #include "icvar.h"
 #include "MiscTemporary.hpp"
+#include "jobs.hpp"
+#include <mutex>
+#include <unordered_map>
+#include <cstring>
 
 settings::SettingsWriter::SettingsWriter(settings::Manager &manager) : manager(manager)
 {
 }
 
-bool settings::SettingsWriter::saveTo(std::string path, bool autosave)
+// Summed variable versions each path was last written at, only touched on the game thread
+static std::unordered_map<std::string, uint64_t> saved_versions{};
+
+// Newest save queued per path. Older saves still waiting for the lock are dropped so a slow write can't overwrite a newer one
+static std::mutex write_lock{};
+static std::unordered_map<std::string, uint64_t> queued_saves{};
+
+static bool writeConfig(const std::string &path, const std::string &data)
+{
+    static std::atomic<unsigned> temp_counter{ 0 };
+    std::string temp = path + ".tmp" + std::to_string(temp_counter++);
+    std::ofstream file(temp, std::ios::out | std::ios::binary);
+    file.write(data.data(), data.size());
+    file.close();
+    // Readers only ever see complete configs
+    if (file && !std::rename(temp.c_str(), path.c_str()))
+        return true;
+    logging::File("cat_save: FATAL! Writing %s failed: %s", path.c_str(), strerror(errno));
+    std::remove(temp.c_str());
+    return false;
+}
+
+bool settings::SettingsWriter::saveTo(std::string path, bool autosave, std::function<void(bool)> done)
 {
+    uint64_t version = 0;
+    for (auto &v : manager.registered)
+        version += v.second.variable.version;
     if (autosave)
+    {
+        auto saved = saved_versions.find(path);
+        if (saved != saved_versions.end() && saved->second == version)
+        {
+            if (done)
+                done(true);
+            return true;
+        }
         logging::File("cat_save: Saving to %s", path.c_str());
+    }
     else
     {
         logging::Info("cat_save: Saving to %s", path.c_str());
     }
     this->only_changed = true;
 
-    stream.open(path, std::ios::out);
-
-    if (!stream || stream.bad() || !stream.is_open() || stream.fail())
-    {
-        logging::File("cat_save: FATAL! FAILED to create stream!");
-        if (!autosave)
-            g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_save: Can't create config file!\n");
-        return false;
-    }
-
-    using pair_type = std::pair<std::string, settings::IVariable *>;
+    using pair_type = std::pair<const std::string *, settings::IVariable *>;
     std::vector<pair_type> all_registered{};
-    logging::File("cat_save: Getting variable references...");
-    for (auto &v : settings::Manager::instance().registered)
+    all_registered.reserve(manager.registered.size());
+    for (auto &v : manager.registered)
     {
         if (!only_changed || v.second.isChanged())
-            all_registered.emplace_back(std::make_pair(v.first, &v.second.variable));
+            all_registered.emplace_back(&v.first, &v.second.variable);
     }
-    logging::File("cat_save: Sorting...");
-    std::sort(all_registered.begin(), all_registered.end(), [](const pair_type &a, const pair_type &b) -> bool { return a.first.compare(b.first) < 0; });
-    logging::File("cat_save: Writing...");
+    std::sort(all_registered.begin(), all_registered.end(), [](const pair_type &a, const pair_type &b) -> bool { return a.first->compare(*b.first) < 0; });
+    buffer.clear();
     for (auto &v : all_registered)
-        if (!v.first.empty())
+        if (!v.first->empty())
+            write(*v.first, v.second);
+
+    saved_versions[path] = version;
+    uint64_t serial;
+    {
+        std::lock_guard<std::mutex> lock(write_lock);
+        serial = ++queued_saves[path];
+    }
+
+    auto finish = [path, version, autosave, done](bool success) {
+        if (!success)
         {
-            write(v.first, v.second);
-            stream.flush();
+            // Retry on the next autosave
+            auto saved = saved_versions.find(path);
+            if (saved != saved_versions.end() && saved->second == version)
+                saved_versions.erase(saved);
         }
-    if (!stream || stream.bad() || stream.fail())
-    {
         if (!autosave)
-            g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_save: Failed to save config!\n");
-        logging::File("cat_save: FATAL! Stream bad!");
+        {
+            if (success)
+                g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_save: Successfully saved config!\n");
+            else
+                g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_save: Failed to save config!\n");
+        }
+        if (done)
+            done(success);
+    };
+
+    // The job pool is gone while shutting down, write it out right here
+    if (settings::cathook_disabled.load())
+    {
+        bool success = writeConfig(path, buffer);
+        finish(success);
+        return success;
     }
-    else if (!autosave)
-        g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_save: Successfully saved config!\n");
-    stream.close();
-    if (stream.fail())
-        logging::File("cat_save: FATAL! Stream bad (2)!");
+
+    jobs::Background([path, serial, data = std::move(buffer), finish]() {
+        bool success;
+        {
+            std::lock_guard<std::mutex> lock(write_lock);
+            if (queued_saves[path] != serial)
+                return;
+            success = writeConfig(path, data);
+        }
+        jobs::Defer([finish, success]() { finish(success); });
+    });
     return true;
 }
 
-void settings::SettingsWriter::write(std::string name, IVariable *variable)
+void settings::SettingsWriter::write(const std::string &name, IVariable *variable)
 {
     writeEscaped(name);
-    stream << "=";
+    buffer.push_back('=');
     if (variable)
         writeEscaped(variable->toString());
     else
     {
         logging::Info("cat_save: FATAL! Variable invalid! %s", name.c_str());
     }
-    stream << std::endl;
+    buffer.push_back('\n');
 }
 
-void settings::SettingsWriter::writeEscaped(std::string str)
+void settings::SettingsWriter::writeEscaped(const std::string &str)
 {
     for (auto c : str)
     {
@@ -88,12 +146,12 @@ void settings::SettingsWriter::writeEscaped(std::string str)
         case '\n':
         case '=':
         case '\\':
-            stream << '\\';
+            buffer.push_back('\\');
             break;
         default:
             break;
         }
-        stream << c;
+        buffer.push_back(c);
     }
 }
 
@@ -103,7 +161,7 @@ settings::SettingsReader::SettingsReader(settings::Manager &manager) : manager(m
 
 bool settings::SettingsReader::loadFrom(std::string path)
 {
-    stream.open(path, std::ios::in | std::ios::binary);
+    stream.open(path, std::ios::in | std::ios::binary | std::ios::ate);
 
     if (stream.fail())
     {
@@ -112,33 +170,92 @@ bool settings::SettingsReader::loadFrom(std::string path)
         return false;
     }
 
-    for (auto &v : settings::Manager::instance().registered)
-    {
-        v.second.variable.fromString(v.second.defaults);
-    }
-
-    while (!stream.fail())
-    {
-        char c;
-        stream.read(&c, 1);
-        if (stream.eof())
-            break;
-        pushChar(c);
-    }
-    if (stream.fail() && !stream.eof())
+    // Whole file in one read, configs are a few hundred KB at most
+    std::string data(size_t(stream.tellg()), '\0');
+    stream.seekg(0);
+    stream.read(data.data(), data.size());
+    if (stream.fail())
     {
         logging::Info("cat_load: FATAL: Read failed!");
         g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_load: Failed to read config!\n");
         return false;
     }
+    stream.close();
+
+    {
+        CallbackBatch batch{};
+        manager.resetToDefaults();
+        parse(data);
+    }
 
     logging::Info("cat_load: Read Success!");
     g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_load: Successfully loaded config!\n");
-    finishString(true);
 
     return true;
 }
 
+bool settings::SettingsReader::parseFile(const std::string &path, values_t &out)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (file.fail())
+        return false;
+    std::string data(size_t(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(data.data(), data.size());
+    if (file.fail())
+        return false;
+    collect = &out;
+    parse(data);
+    collect = nullptr;
+    return true;
+}
+
+size_t settings::SettingsReader::applyValues(const values_t &values)
+{
+    // Later lines win, same as when loading
+    std::unordered_map<std::string, const std::string *> wanted{};
+    for (auto &value : values)
+    {
+        // Migrate like loading would, against what the file set so far instead of the live values
+        std::string key = value.first;
+        auto target     = migrationTarget(key);
+        if (target)
+        {
+            auto set = wanted.find(target->first);
+            if (set == wanted.end() || *set->second == target->second.defaults)
+                key = target->first;
+        }
+        if (manager.registered.find(key) == manager.registered.end())
+            printf("Could not find variable %s\n", key.c_str());
+        else
+            wanted[std::move(key)] = &value.second;
+    }
+
+    size_t changed = 0;
+    CallbackBatch batch{};
+    for (auto &v : manager.registered)
+    {
+        auto &variable = v.second.variable;
+        auto it        = wanted.find(v.first);
+        if (it == wanted.end())
+        {
+            if (!v.second.isChanged())
+                continue;
+            variable.resetToDefault();
+            changed++;
+        }
+        else if (variable.toString() != *it->second)
+        {
+            std::string before = variable.toString();
+            variable.fromString(*it->second);
+            // "1" and "true" only differ as text
+            if (variable.toString() != before)
+                changed++;
+        }
+    }
+    return changed;
+}
+
 bool settings::SettingsReader::loadFromString(std::string stream)
 {
     settings::SettingsReader loader{ settings::Manager::instance() };
@@ -149,23 +266,35 @@ bool settings::SettingsReader::loadFromString(std::string stream)
         return false;
     }
 
-    for (auto &v : settings::Manager::instance().registered)
-    {
-        v.second.variable.fromString(v.second.defaults);
-    }
-
-    for (auto &c : stream)
     {
-        loader.pushChar(c);
+        CallbackBatch batch{};
+        manager.resetToDefaults();
+        loader.parse(stream);
     }
 
     logging::Info("cat_load: Read Success!");
     g_ICvar->ConsoleColorPrintf(MENU_COLOR, "CAT: cat_load: Successfully loaded config!\n");
-    loader.finishString(true);
 
     return true;
 }
 
+void settings::SettingsReader::parse(std::string_view data)
+{
+    oss.reserve(64);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        // Skip the rest of a comment in one go
+        if (comment)
+        {
+            i = data.find('\n', i);
+            if (i == std::string_view::npos)
+                break;
+        }
+        pushChar(data[i]);
+    }
+    finishString(true);
+}
+
 void settings::SettingsReader::pushChar(char c)
 {
     if (comment)
@@ -245,16 +374,8 @@ void settings::SettingsReader::finishString(bool complete)
     oss.clear();
     if (reading_key)
     {
-        stored_key = std::move(str);
-        for (auto &migration : migrations)
-            if (stored_key == migration.from)
-                for (auto &var : settings::Manager::instance().registered)
-                    if (var.first == migration.to)
-                    {
-                        if (var.second.isChanged())
-                            break;
-                        stored_key = migration.to;
-                    }
+        // Migrating looks at the variables, collected keys get migrated when they're applied
+        stored_key = collect ? std::move(str) : migrate(std::move(str));
     }
     else
     {
@@ -265,9 +386,33 @@ void settings::SettingsReader::finishString(bool complete)
     temporary_spaces.clear();
 }
 
-void settings::SettingsReader::onReadKeyValue(std::string key, std::string value)
+settings::SettingsReader::registered_t *settings::SettingsReader::migrationTarget(const std::string &key)
 {
-    printf("Read: '%s' = '%s'\n", key.c_str(), value.c_str());
+    for (auto &migration : migrations)
+        if (key == migration.from)
+        {
+            auto var = manager.registered.find(migration.to);
+            return var != manager.registered.end() ? &*var : nullptr;
+        }
+    return nullptr;
+}
+
+std::string settings::SettingsReader::migrate(std::string key)
+{
+    // Loading starts from defaults, so a changed target was set earlier in the same file
+    auto target = migrationTarget(key);
+    if (target && !target->second.isChanged())
+        return target->first;
+    return key;
+}
+
+void settings::SettingsReader::onReadKeyValue(const std::string &key, const std::string &value)
+{
+    if (collect)
+    {
+        collect->emplace_back(key, value);
+        return;
+    }
     auto v = manager.lookup(key);
     if (v == nullptr)
     {
@@ -275,5 +420,4 @@ void settings::SettingsReader::onReadKeyValue(std::string key, std::string value
         return;
     }
     v->fromString(value);
-    printf("Set:  '%s' = '%s'\n", key.c_str(), v->toString().c_str());
 }
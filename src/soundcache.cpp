@@ -1,61 +1,90 @@
 #include "common.hpp"
 #include "soundcache.hpp"
 
-struct CSndInfo_t
+namespace soundcache
 {
-    Vector m_pOrigin;
-};
+constexpr int64_t EXPIRETIME = 10000;
 
-struct SoundStruct
+// The EmitSound hooks keep the cache current, this only catches sounds that keep playing or were emitted without an origin
+static settings::Int reconcile_interval{ "soundcache.reconcile-interval-ms", "250" };
+
+struct sound_entry
 {
-    CSndInfo_t sound;
-    Timer last_update;
+    Vector origin;
+    // steady clock ms of the last sound, 0 if there never was one
+    int64_t updated_ms;
 };
 
-static std::map<int, SoundStruct> sound_cache;
+// Sources are entity indices, so this is a plain array. Entries expire on lookup instead of in a sweep
+static sound_entry sound_cache[MAX_ENTITIES];
+// Reused every sweep so GetActiveSounds doesn't allocate
+static CUtlVector<SndInfo_t> sound_list;
+static Timer reconcile_timer{};
+// A sound without an origin went out, only the sound engine knows where it plays from
+static bool sweep_pending = false;
 
-namespace soundcache
+static int64_t NowMs()
 {
-constexpr unsigned int EXPIRETIME = 10000;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 void cache_sound(const Vector *Origin, int source)
 {
     // Just in case
+    if (source < 0 || source >= MAX_ENTITIES)
+        return;
     if (!Origin)
+    {
+        sweep_pending = true;
         return;
-    sound_cache[source].sound.m_pOrigin = *Origin;
-    sound_cache[source].last_update.update();
+    }
+    sound_cache[source].origin     = *Origin;
+    sound_cache[source].updated_ms = NowMs();
 }
 
 static void CreateMove()
 {
     if (CE_BAD(LOCAL_E))
         return;
-    CUtlVector<SndInfo_t> sound_list;
+    if (!sweep_pending && !reconcile_timer.test_and_set(std::max(*reconcile_interval, 0)))
+        return;
+    sweep_pending = false;
+    reconcile_timer.update();
+    sound_list.RemoveAll();
     g_ISoundEngine->GetActiveSounds(sound_list);
-    for (auto i : sound_list)
-        cache_sound(i.m_pOrigin, i.m_nSoundSource);
-
-    for (auto it = sound_cache.cbegin(); it != sound_cache.cend();)
-    {
-        if (it->second.last_update.check(EXPIRETIME) || (it->first <= g_IEngine->GetMaxClients() && !g_pPlayerResource->isAlive(it->first)))
-            it = sound_cache.erase(it);
-        else
-            ++it;
-    }
+    for (int i = 0; i < sound_list.Count(); i++)
+        cache_sound(sound_list[i].m_pOrigin, sound_list[i].m_nSoundSource);
 }
 
-std::optional<Vector> GetSoundLocation(int entid)
+std::optional<Vector> GetSoundLocation(int entid, float *age, int64_t *stamp)
 {
-    auto it = sound_cache.find(entid);
-    if (it == sound_cache.end())
+    if (entid < 0 || entid >= MAX_ENTITIES)
         return std::nullopt;
-    return it->second.sound.m_pOrigin;
+    auto &entry = sound_cache[entid];
+    if (!entry.updated_ms)
+        return std::nullopt;
+    // Dead players don't make sounds, whatever they made before is where they died
+    int64_t elapsed = NowMs() - entry.updated_ms;
+    if (elapsed >= EXPIRETIME || (entid <= g_IEngine->GetMaxClients() && !g_pPlayerResource->isAlive(entid)))
+    {
+        entry.updated_ms = 0;
+        return std::nullopt;
+    }
+    if (age)
+        *age = elapsed / 1000.0f;
+    if (stamp)
+        *stamp = entry.updated_ms;
+    return entry.origin;
 }
 
 static InitRoutine init([]() {
     EC::Register(EC::CreateMove, CreateMove, "CM_SoundCache");
     EC::Register(
-        EC::LevelInit, []() { sound_cache.clear(); }, "soundcache_levelinit");
+        EC::LevelInit,
+        []() {
+            memset(sound_cache, 0, sizeof(sound_cache));
+            sweep_pending = false;
+        },
+        "soundcache_levelinit");
 });
 } // namespace soundcache
@@ -0,0 +1,74 @@
+#include "common.hpp"
+#include "spectators.hpp"
+
+namespace spectators
+{
+static std::vector<spectator_s> all;
+static std::vector<spectator_s> local;
+static observer_mode local_state = NONE;
+static int targets[PLAYER_ARRAY_SIZE];
+
+void Update()
+{
+    all.clear();
+    local.clear();
+    local_state = NONE;
+    std::fill(targets, targets + PLAYER_ARRAY_SIZE, -1);
+    if (CE_BAD(LOCAL_E))
+        return;
+    bool alive = !g_pLocalPlayer->life_state;
+    for (CachedEntity *ent : entity_cache::players())
+    {
+        if (CE_BAD(ent) || ent == LOCAL_E || ent->m_IDX >= PLAYER_ARRAY_SIZE)
+            continue;
+        int target = HandleToIDX(CE_INT(ent, netvar.hObserverTarget));
+        int at     = CE_INT(ent, netvar.iObserverMode);
+        if (at == NONE || target <= 0 || target >= PLAYER_ARRAY_SIZE)
+            continue;
+        spectator_s spectator{ ent->m_IDX, target, observer_mode(at) };
+        targets[ent->m_IDX] = target;
+        all.push_back(spectator);
+        if (target != LOCAL_E->m_IDX)
+            continue;
+        local.push_back(spectator);
+        if (!alive)
+            continue;
+        // FIRSTPERSON is the "worst" state
+        if (at == FIRSTPERSON)
+            local_state = FIRSTPERSON;
+        else if (at == THIRDPERSON && local_state != FIRSTPERSON)
+            local_state = THIRDPERSON;
+    }
+}
+
+const std::vector<spectator_s> &All()
+{
+    return all;
+}
+
+const std::vector<spectator_s> &Local()
+{
+    return local;
+}
+
+observer_mode LocalState()
+{
+    return local_state;
+}
+
+int TargetOf(int idx)
+{
+    return idx > 0 && idx < PLAYER_ARRAY_SIZE ? targets[idx] : -1;
+}
+
+static InitRoutine init([]() {
+    EC::Register(
+        EC::LevelShutdown,
+        []() {
+            all.clear();
+            local.clear();
+            local_state = NONE;
+        },
+        "levelshutdown_spectators");
+});
+} // namespace spectators
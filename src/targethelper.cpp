@@ -6,7 +6,7 @@
  */
 
 #include "common.hpp"
-#include "hacks/Backtrack.hpp"
+#include "targethelper.hpp"
 
 /*
  * Targeting priorities:
@@ -17,84 +17,213 @@
  * spies
  */
 
-/* Assuming given entity is a valid target range 0 to 100 */
-int GetScoreForEntity(CachedEntity *entity)
+namespace target_score
 {
-    if (!entity)
-        return 0;
-    // TODO
-    if (entity->m_Type() == ENTITY_BUILDING)
+constexpr int CLASSES    = tf_engineer + 1;
+constexpr int CONDITIONS = 4;
+
+struct condition_bonus_s
+{
+    condition_data_s mask;
+    // By tf_class, added if any condition of mask is set
+    float bonus[CLASSES];
+};
+
+// Everything is indexed by tf_class, 0 is anything that isn't a TF class
+struct table_s
+{
+    const char *name;
+    float base[CLASSES];
+    // Points at 1 unit away, falling off with distance
+    float distance[CLASSES];
+    // Points at 1 health, falling off with health up to health_cap
+    float health[CLASSES];
+    // Added inside of close_range
+    float close[CLASSES];
+    // Replaces the whole score if >= 0
+    float fixed[CLASSES];
+    condition_bonus_s conditions[CONDITIONS];
+    float health_cap;
+    float close_range;
+    float cap;
+};
+
+constexpr condition_data_s KBulletResistMask = CreateConditionMask(TFCond_SmallBulletResist);
+constexpr condition_data_s KZoomedMask       = CreateConditionMask(TFCond_Zoomed);
+constexpr condition_data_s KBlastJumpMask    = CreateConditionMask(TFCond_BlastJumping);
+
+// clang-format off
+static const table_s tables[] = {
+    // What this always did. Snipers and spies only score by class, medics always win (TODO only for mvm) unless they
+    // have bullet resist, that case is handled after the table
+    { "default",
+      //  ?      scout  sniper soldier demo  medic  heavy  pyro   spy    engi
+      {   0,     0,     25,    0,     0,     50,    0,     0,     20,    0     },
+      {   16384, 16384, 0,     16384, 16384, 16384, 16384, 16384, 0,     16384 },
+      {   1800,  1800,  0,     1800,  1800,  1800,  1800,  1800,  0,     1800  },
+      {   0,     0,     0,     0,     0,     0,     0,     0,     60,    0     },
+      {   -1,    -1,    -1,    -1,    -1,    999,   -1,    -1,    -1,    -1    },
+      { { KBulletResistMask, { 50, 50, 0,  50, 50, 50, 50, 50, 0,  50 } },
+        { KCritBoostMask,    { 99, 99, 0,  99, 99, 99, 99, 99, 0,  99 } },
+        { KZoomedMask,       { 0,  0,  50, 0,  0,  0,  0,  0,  0,  0  } },
+        { KBlastJumpMask,    { 0,  0,  0,  30, 0,  0,  0,  0,  0,  0  } } },
+      30, 400, 99 },
+    // Whatever can kill us fastest, zoomed snipers, close spies, crit boosted players and incoming soldiers
+    { "threats",
+      {   0,     10,    20,    15,    15,    10,    15,    10,    10,    5     },
+      {   8192,  8192,  0,     8192,  8192,  8192,  8192,  8192,  0,     8192  },
+      {   0,     0,     0,     0,     0,     0,     0,     0,     0,     0     },
+      {   0,     20,    0,     10,    10,    0,     10,    25,    70,    0     },
+      {   -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1    },
+      { { KCritBoostMask,    { 60, 60, 60, 60, 60, 60, 60, 60, 60, 60 } },
+        { KZoomedMask,       { 0,  0,  70, 0,  0,  0,  0,  0,  0,  0  } },
+        { KBlastJumpMask,    { 0,  0,  0,  40, 30, 0,  0,  0,  0,  0  } },
+        { KBulletResistMask, { 0,  0,  0,  0,  0,  20, 0,  0,  0,  0  } } },
+      0, 500, 99 },
+    // Whatever dies fastest, low health first and medics and snipers before the rest
+    { "picks",
+      {   0,     5,     20,    5,     5,     25,    0,     5,     10,    10    },
+      {   4096,  4096,  4096,  4096,  4096,  4096,  4096,  4096,  4096,  4096  },
+      {   4500,  4500,  4500,  4500,  4500,  4500,  4500,  4500,  4500,  4500  },
+      {   0,     0,     0,     0,     0,     0,     0,     0,     0,     0     },
+      {   -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1    },
+      { { KBulletResistMask, { -20, -20, -20, -20, -20, -20, -20, -20, -20, -20 } },
+        { KZoomedMask,       { 0,   0,   20,  0,   0,   0,   0,   0,   0,   0   } },
+        { KCritBoostMask,    { 10,  10,  10,  10,  10,  10,  10,  10,  10,  10  } },
+        { condition_data_s{}, {} } },
+      50, 0, 99 }
+};
+// clang-format on
+constexpr int TABLES = sizeof(tables) / sizeof(*tables);
+
+// 0 default, 1 threats, 2 picks. Only used by smart priority
+static settings::Int preset{ "aimbot.priority-preset", "0" };
+
+// Per candidate copy of what the scoring needs, laid out so the loop below only does plain array math
+struct batch_s
+{
+    std::vector<int> clazz;
+    std::vector<float> health;
+    std::vector<float> dx, dy, dz;
+    std::vector<uint32_t> conditions[4];
+
+    void resize(int count)
     {
-        if (entity->m_iClassID() == CL_CLASS(CObjectSentrygun))
-        {
-            return 1;
-        }
-        return 0;
+        clazz.resize(count);
+        health.resize(count);
+        dx.resize(count);
+        dy.resize(count);
+        dz.resize(count);
+        for (auto &bits : conditions)
+            bits.resize(count);
     }
-    int clazz      = CE_INT(entity, netvar.iClass);
-    int health     = CE_INT(entity, netvar.iHealth);
-    float distance = (g_pLocalPlayer->v_Origin - entity->m_vecOrigin()).Length();
-    bool zoomed    = HasCondition<TFCond_Zoomed>(entity);
-    bool pbullet   = HasCondition<TFCond_SmallBulletResist>(entity);
-    bool special   = false;
-    bool kritz     = IsPlayerCritBoosted(entity);
-    int total      = 0;
-    switch (clazz)
+};
+static batch_s batch;
+
+static void Gather(CachedEntity *const *entities, int count)
+{
+    batch.resize(count);
+    const Vector &local = g_pLocalPlayer->v_Origin;
+    for (int i = 0; i < count; i++)
     {
-    case tf_sniper:
-        total += 25;
-        if (zoomed)
+        CachedEntity *ent = entities[i];
+        int idx           = ent->m_IDX;
+        int clazz         = 0;
+        condition_data_s conds{};
+        if (ent->m_Type() == ENTITY_PLAYER)
         {
-            total += 50;
+            IF_GAME(IsTF())
+            {
+                clazz = entity_cache::SnapshotValid(idx) && idx < PLAYER_ARRAY_SIZE ? entity_cache::snapshot.player_class[idx] : CE_INT(ent, netvar.iClass);
+                conds = Conditions(ent);
+            }
         }
-        special = true;
-        break;
-    case tf_medic:
-        total += 50;
-        if (pbullet)
-            return 100;
-        break;
-    case tf_spy:
-        total += 20;
-        if (distance < 400)
-            total += 60;
-        special = true;
-        break;
-    case tf_soldier:
-        if (HasCondition<TFCond_BlastJumping>(entity))
-            total += 30;
-        break;
+        Vector origin          = ent->m_vecOrigin();
+        batch.clazz[i]         = clazz >= 0 && clazz < CLASSES ? clazz : 0;
+        batch.health[i]        = ent->m_iHealth();
+        batch.dx[i]            = origin.x - local.x;
+        batch.dy[i]            = origin.y - local.y;
+        batch.dz[i]            = origin.z - local.z;
+        batch.conditions[0][i] = conds.cond_0;
+        batch.conditions[1][i] = conds.cond_1;
+        batch.conditions[2][i] = conds.cond_2;
+        batch.conditions[3][i] = conds.cond_3;
     }
-    if (!special)
+}
+
+// No calls and no branches per candidate, just table lookups and selects
+static void Evaluate(const table_s &table, int count, float *scores)
+{
+    const int *clazz     = batch.clazz.data();
+    const float *health  = batch.health.data();
+    const float *dx      = batch.dx.data();
+    const float *dy      = batch.dy.data();
+    const float *dz      = batch.dz.data();
+    const uint32_t *c0   = batch.conditions[0].data();
+    const uint32_t *c1   = batch.conditions[1].data();
+    const uint32_t *c2   = batch.conditions[2].data();
+    const uint32_t *c3   = batch.conditions[3].data();
+    float close_range_sq = table.close_range * table.close_range;
+    for (int i = 0; i < count; i++)
     {
-        if (pbullet)
+        int c       = clazz[i];
+        float dist2 = dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i];
+        float score = table.base[c];
+        for (int j = 0; j < CONDITIONS; j++)
         {
-            total += 50;
+            const condition_data_s &mask = table.conditions[j].mask;
+            bool set                     = (c0[i] & mask.cond_0) | (c1[i] & mask.cond_1) | (c2[i] & mask.cond_2) | (c3[i] & mask.cond_3);
+            score += set ? table.conditions[j].bonus[c] : 0.0f;
         }
-        if (kritz)
+        score += dist2 < close_range_sq ? table.close[c] : 0.0f;
+        // Right on top of us is as good as the cap anyway
+        float distance = std::sqrt(std::max(dist2, 1.0f));
+        score += std::min(table.distance[c] / distance, table.cap);
+        score += health[i] > 0.0f ? std::min(table.health[c] / health[i], table.health_cap) : 0.0f;
+        score     = std::min(score, table.cap);
+        scores[i] = table.fixed[c] >= 0.0f ? table.fixed[c] : score;
+    }
+}
+} // namespace target_score
+
+void GetScoresForEntities(CachedEntity *const *entities, int count, float *scores)
+{
+    using namespace target_score;
+    if (count <= 0)
+        return;
+    Gather(entities, count);
+    int selected = std::clamp(*preset, 0, TABLES - 1);
+    Evaluate(tables[selected], count, scores);
+    // Rare cases that don't fit a table
+    for (int i = 0; i < count; i++)
+    {
+        CachedEntity *ent = entities[i];
+        if (ent->m_Type() == ENTITY_BUILDING)
         {
-            total += 99;
+            scores[i] = ent->m_iClassID() == CL_CLASS(CObjectSentrygun) ? 1.0f : 0.0f;
+            continue;
         }
-        if (distance != 0)
+        if (ent->m_Type() != ENTITY_PLAYER)
+            continue;
+        // The old rules returned 100 for a bullet resist medic before rage or anything else was looked at
+        if (selected == 0 && batch.clazz[i] == tf_medic && (batch.conditions[0][i] & KBulletResistMask.cond_0 || batch.conditions[1][i] & KBulletResistMask.cond_1 || batch.conditions[2][i] & KBulletResistMask.cond_2 || batch.conditions[3][i] & KBulletResistMask.cond_3))
         {
-            int distance_factor = (4096 / distance) * 4;
-            total += distance_factor;
-            if (health != 0)
-            {
-                int health_factor = (450 / health) * 4;
-                if (health_factor > 30)
-                    health_factor = 30;
-                total += health_factor;
-            }
+            scores[i] = 100.0f;
+            continue;
         }
+        if (playerlist::AccessData(ent).state == playerlist::k_EState::RAGE)
+            scores[i] = 999.0f;
+        if (batch.clazz[i] == tf_demoman && IsSentryBuster(ent))
+            scores[i] = 0.0f;
     }
-    if (total > 99)
-        total = 99;
-    if (playerlist::AccessData(entity).state == playerlist::k_EState::RAGE)
-        total = 999;
-    if (IsSentryBuster(entity))
-        total = 0;
-    if (clazz == tf_medic)
-        total = 999; // TODO only for mvm
-    return total;
+}
+
+/* Assuming given entity is a valid target range 0 to 100 */
+int GetScoreForEntity(CachedEntity *entity)
+{
+    if (!entity)
+        return 0;
+    float score;
+    GetScoresForEntities(&entity, 1, &score);
+    return score;
 }
@@ -1,5 +1,6 @@
 #include "common.hpp"
 #include "teamroundtimer.hpp"
+#include "objectives.hpp"
 
 int CTeamRoundTimer::GetSetupTimeLength()
 {
@@ -20,20 +21,10 @@ round_states CTeamRoundTimer::GetRoundState()
     return state == 1 ? RT_STATE_NORMAL : RT_STATE_SETUP;
 };
 
+// The objective tracker finds it once per round and follows the one the HUD shows
 void CTeamRoundTimer::Update()
 {
-    IClientEntity *ent;
-
-    entity = 0;
-    for (int i = 0; i <= HIGHEST_ENTITY; i++)
-    {
-        ent = g_IEntityList->GetClientEntity(i);
-        if (ent && ent->GetClientClass()->m_ClassID == CL_CLASS(CTeamRoundTimer))
-        {
-            entity = i;
-            return;
-        }
-    }
+    entity = objectives::Round().timer;
 }
 CTeamRoundTimer *g_pTeamRoundTimer{ nullptr };
 
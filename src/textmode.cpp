@@ -6,6 +6,11 @@
  */
 
 #include "common.hpp"
+#if ENABLE_TEXTMODE_STDIN
+#include <poll.h>
+#include <deque>
+#include <thread>
+#endif
 
 bool *allowSecureServers{ nullptr };
 
@@ -34,28 +39,148 @@ void EXPOSED_Epic_VACBypass_1337_DoNotSteal_xXx_$1_xXx_MLG()
 
 CatCommand fixvac("fixvac", "Lemme in to secure servers", []() { EXPOSED_Epic_VACBypass_1337_DoNotSteal_xXx_$1_xXx_MLG(); });
 
+#if ENABLE_TEXTMODE
+// Runs Paint callbacks once per tick, skips eager bone setup and keeps fps_max at the tick rate
+settings::Boolean textmode_minimal_cpu{ "textmode.minimal-cpu", "true" };
+
+static void LimitFramerate()
+{
+    if (!textmode_minimal_cpu)
+        return;
+    static ConVar *fps_max = g_ICvar->FindVar("fps_max");
+    // Same as the default autoexec, one above the tick rate so no tick ever waits for a frame
+    int target = int(1.0f / g_GlobalVars->interval_per_tick + 0.5f) + 1;
+    if (fps_max && fps_max->GetInt() != target)
+        fps_max->SetValue(target);
+}
+#endif
+
+#if ENABLE_TEXTMODE_STDIN
+namespace stdin_reader
+{
+// Longer lines are thrown away instead of being executed in pieces
+constexpr size_t MAX_LINE = 4096;
+// Executed per Paint, whatever is left waits for the next one
+constexpr int MAX_PER_FRAME = 64;
+
+static std::thread thread;
+// Written to by Stop to wake the thread up
+static int wake_pipe[2]{ -1, -1 };
+static std::mutex queue_lock;
+static std::deque<std::string> queue;
+static std::atomic<bool> pending{ false };
+
+static void Push(std::string &line)
+{
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+    if (line.empty())
+        return;
+    std::lock_guard<std::mutex> lock(queue_lock);
+    queue.push_back(std::move(line));
+    pending.store(true, std::memory_order_release);
+}
+
+static void Run()
+{
+    std::string line;
+    bool overlong = false;
+    char buffer[4096];
+    while (true)
+    {
+        pollfd fds[2] = { { 0, POLLIN, 0 }, { wake_pipe[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (fds[1].revents)
+            return;
+        ssize_t bytes = read(0, buffer, sizeof(buffer));
+        if (bytes < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        // Closed, nothing more is coming
+        if (bytes <= 0)
+            break;
+        for (ssize_t i = 0; i < bytes; i++)
+        {
+            if (buffer[i] != '\n')
+            {
+                if (line.size() < MAX_LINE)
+                    line += buffer[i];
+                else
+                    overlong = true;
+                continue;
+            }
+            if (overlong)
+                logging::Info("[TEXTMODE] Dropped a command longer than %u characters", MAX_LINE);
+            else
+                Push(line);
+            line.clear();
+            overlong = false;
+        }
+    }
+    // Whatever came without a newline before the end
+    if (!overlong)
+        Push(line);
+}
+
+static void Start()
+{
+    if (thread.joinable() || pipe2(wake_pipe, O_CLOEXEC) < 0)
+        return;
+    thread = std::thread(Run);
+}
+
+static void Stop()
+{
+    if (!thread.joinable())
+        return;
+    char wake = 0;
+    if (write(wake_pipe[1], &wake, 1) < 0)
+        logging::Info("[TEXTMODE] Couldn't wake the stdin reader");
+    thread.join();
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    wake_pipe[0] = wake_pipe[1] = -1;
+}
+} // namespace stdin_reader
+#endif
+
 static InitRoutine init_textmode([]() {
 #if ENABLE_TEXTMODE_STDIN
     logging::Info("[TEXTMODE] Setting up input handling");
     int flags = fcntl(0, F_GETFL, 0);
     flags |= O_NONBLOCK;
     fcntl(0, F_SETFL, flags);
-    logging::Info("[TEXTMODE] stdin is now non-blocking");
+    stdin_reader::Start();
+    EC::Register(EC::Shutdown, stdin_reader::Stop, "shutdown_stdin_reader");
+    logging::Info("[TEXTMODE] Reading commands from stdin");
 #endif
 #if ENABLE_VAC_BYPASS
     EXPOSED_Epic_VACBypass_1337_DoNotSteal_xXx_$1_xXx_MLG();
 #endif
+#if ENABLE_TEXTMODE
+    EC::Register(EC::Paint, LimitFramerate, "textmode_framerate", EC::every_ms(1000));
+#endif
 });
 
 #if ENABLE_TEXTMODE_STDIN
 void UpdateInput()
 {
-    char buffer[256];
-    int bytes = read(0, buffer, 255);
-    if (bytes > 0)
+    // Nearly always empty, don't take the lock for nothing
+    if (!stdin_reader::pending.load(std::memory_order_acquire))
+        return;
+    std::deque<std::string> lines;
     {
-        buffer[bytes] = '\0';
-        g_IEngine->ExecuteClientCmd(buffer);
+        std::lock_guard<std::mutex> lock(stdin_reader::queue_lock);
+        size_t count = std::min<size_t>(stdin_reader::queue.size(), stdin_reader::MAX_PER_FRAME);
+        lines.insert(lines.end(), std::make_move_iterator(stdin_reader::queue.begin()), std::make_move_iterator(stdin_reader::queue.begin() + count));
+        stdin_reader::queue.erase(stdin_reader::queue.begin(), stdin_reader::queue.begin() + count);
+        stdin_reader::pending.store(!stdin_reader::queue.empty(), std::memory_order_release);
     }
+    for (auto &line : lines)
+        g_IEngine->ExecuteClientCmd(line.c_str());
 }
 #endif
@@ -72,6 +72,55 @@ namespace tfmm
 {
 int queuecount = 0;
 
+static queue_state_s queue_state{};
+static Timer queue_state_timer{};
+static bool queue_state_dirty = true;
+
+static void invalidateQueueState()
+{
+    queue_state_dirty = true;
+}
+
+static int getPendingInvites()
+{
+    static uintptr_t addr    = gSignatures.GetClientSignature("C7 04 24 ? ? ? ? 8D 7D ? 31 F6");
+    static uintptr_t offset0 = uintptr_t(*(uintptr_t *) (addr + 0x3));
+    static uintptr_t offset1 = gSignatures.GetClientSignature("55 89 E5 83 EC ? 8B 45 ? 8B 80 ? ? ? ? 85 C0 74 ? C7 44 24 ? ? ? ? ? "
+                                                              "89 04 24 E8 ? ? ? ? 85 C0 74 ? 8B 40");
+    typedef int (*GetPendingInvites_t)(uintptr_t);
+    GetPendingInvites_t GetPendingInvites = GetPendingInvites_t(offset1);
+    return GetPendingInvites(offset0);
+}
+
+const queue_state_s &queueState()
+{
+    if (!queue_state_dirty && !queue_state_timer.test_and_set(1000))
+        return queue_state;
+    queue_state_dirty = false;
+    queue_state_timer.update();
+
+    re::CTFGCClientSystem *gc = re::CTFGCClientSystem::GTFGCClientSystem();
+    re::CTFPartyClient *pc    = re::CTFPartyClient::GTFPartyClient();
+    queue_state               = {};
+    if (!gc || !pc)
+        return queue_state;
+    queue_state.available          = true;
+    queue_state.connected_to_match = gc->BConnectedToMatchServer(false);
+    queue_state.live_match         = gc->BHaveLiveMatch();
+    queue_state.in_queue           = pc->BInQueueForMatchGroup(getQueue()) || pc->BInQueueForStandby();
+    queue_state.pending_invites    = getPendingInvites();
+    return queue_state;
+}
+
+unsigned queueStagger()
+{
+#if ENABLE_IPC
+    if (ipc::peer)
+        return (ipc::peer->client_id % 8) * 625;
+#endif
+    return 0;
+}
+
 static bool old_isMMBanned()
 {
     auto client = re::CTFPartyClient::GTFPartyClient();
@@ -128,6 +177,7 @@ void startQueue()
         client->RequestQueueForMatch((int) queue);
         // client->RequestQueueForStandby();
         queuecount++;
+        invalidateQueueState();
     }
     else
         logging::Info("queue_start: CTFPartyClient == null!");
@@ -138,13 +188,17 @@ void startQueueStandby()
     if (client)
     {
         client->RequestQueueForStandby();
+        invalidateQueueState();
     }
 }
 void leaveQueue()
 {
     re::CTFPartyClient *client = re::CTFPartyClient::GTFPartyClient();
     if (client)
+    {
         client->RequestLeaveForMatch((int) queue);
+        invalidateQueueState();
+    }
     else
         logging::Info("queue_start: CTFPartyClient == null!");
 }
@@ -158,6 +212,7 @@ void disconnectAndAbandon()
 void abandon()
 {
     re::CTFGCClientSystem *gc = re::CTFGCClientSystem::GTFGCClientSystem();
+    invalidateQueueState();
     if (gc && gc->BConnectedToMatchServer(false))
         gc->AbandonCurrentMatch();
     else if (!gc)
@@ -186,6 +241,10 @@ void friend_party()
     }
 }
 
-static InitRoutine init([]() { EC::Register(EC::Paint, friend_party, "paint_friendparty"); });
+static InitRoutine init([]() {
+    EC::Register(EC::Paint, friend_party, "paint_friendparty");
+    EC::Register(EC::LevelInit, invalidateQueueState, "levelinit_tfmm");
+    EC::Register(EC::LevelShutdown, invalidateQueueState, "levelshutdown_tfmm");
+});
 
 } // namespace tfmm
@@ -0,0 +1,137 @@
+/*
+ * Records per-tick game state to a binary file, so target selection and
+ * path finding changes can be compared on the exact same input offline.
+ *
+ * File layout, all little endian:
+ *   header: "CATR" u32 version
+ *   tick:   u32 tickcount, i32 local_idx, Vector eye, Vector viewangles, u16 entity_count
+ *     entity: u16 idx, i32 class_id, u8 type, i32 team, i32 health, Vector origin, u8 flags (1 alive, 2 dormant),
+ *             u16 numbones, matrix3x4_t bones[numbones] (players with bones set up this tick only)
+ */
+#include "common.hpp"
+#include "jobs.hpp"
+#include <pwd.h>
+
+namespace tickrecorder
+{
+constexpr uint32_t VERSION = 1;
+
+static std::vector<char> buffer;
+static int ticks_left     = 0;
+static int ticks_recorded = 0;
+
+template <typename T> static void Put(const T &value)
+{
+    const char *data = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), data, data + sizeof(T));
+}
+
+static void Finish()
+{
+    passwd *pwd      = getpwuid(getuid());
+    std::string path = strfmt("/tmp/cathook-%s-%d-ticks-%ld.bin", pwd->pw_name, getpid(), (long) time(nullptr)).get();
+    auto data        = std::make_shared<std::vector<char>>(std::move(buffer));
+    int ticks        = ticks_recorded;
+    buffer.clear();
+    ticks_recorded = 0;
+    // Some megabytes for a few seconds of recording, keep the write off the game thread
+    jobs::Background([path, data, ticks]() {
+        std::ofstream out(path, std::ios::binary);
+        out.write(data->data(), data->size());
+        logging::Info("[TR] Wrote %d ticks (%u bytes) to %s", ticks, (unsigned) data->size(), path.c_str());
+    });
+}
+
+static void RecordEntity(CachedEntity *ent)
+{
+    int idx = ent->m_IDX;
+    Put<uint16_t>(idx);
+    Put<int32_t>(entity_cache::snapshot.class_id[idx]);
+    Put<uint8_t>(entity_cache::snapshot.type[idx]);
+    Put<int32_t>(entity_cache::snapshot.team[idx]);
+    Put<int32_t>(entity_cache::snapshot.health[idx]);
+    Put(entity_cache::snapshot.origin[idx]);
+    Put<uint8_t>((entity_cache::snapshot.alive[idx] ? 1 : 0) | (entity_cache::snapshot.dormant[idx] ? 2 : 0));
+
+    // Only copy bones that PrepareBones already set up this tick, recording shouldn't change what gets computed.
+    // bones_setup can be left over from an older tick, GetBones() would set those up again
+    auto &hitboxes              = ent->hitboxes;
+    bool fresh                  = hitboxes.bones_setup && hitboxes.bones_generation == hitbox_cache::bone_arena.generation;
+    const matrix3x4_t *prepared = fresh && entity_cache::snapshot.type[idx] == ENTITY_PLAYER ? hitboxes.PreparedBones() : nullptr;
+    int numbones                = 0;
+    if (prepared)
+    {
+        auto model = (const model_t *) RAW_ENT(ent)->GetModel();
+        auto shdr  = model ? g_IModelInfo->GetStudiomodel(model) : nullptr;
+        if (shdr && shdr->numbones > 0)
+            numbones = std::min(shdr->numbones, MAXSTUDIOBONES);
+    }
+    Put<uint16_t>(numbones);
+    if (numbones)
+    {
+        auto bones = reinterpret_cast<const char *>(prepared);
+        buffer.insert(buffer.end(), bones, bones + sizeof(matrix3x4_t) * numbones);
+    }
+}
+
+static void CreateMove()
+{
+    if (!ticks_left || CE_BAD(LOCAL_E))
+        return;
+    PROF_SECTION(CM_TickRecorder);
+    Put<uint32_t>(tickcount);
+    Put<int32_t>(g_pLocalPlayer->entity_idx);
+    Put(g_pLocalPlayer->v_Eye);
+    Put(current_user_cmd->viewangles);
+
+    // Patched once the entities are written
+    size_t count_offset = buffer.size();
+    Put<uint16_t>(0);
+    uint16_t count = 0;
+    for (int i = 1; i <= HIGHEST_ENTITY; i++)
+    {
+        CachedEntity *ent = ENTITY_UNCHECKED(i);
+        if (!entity_cache::SnapshotValid(i) || entity_cache::snapshot.type[i] == ENTITY_GENERIC)
+            continue;
+        RecordEntity(ent);
+        count++;
+    }
+    memcpy(&buffer[count_offset], &count, sizeof(count));
+
+    ticks_recorded++;
+    if (!--ticks_left)
+        Finish();
+}
+
+static void Abort()
+{
+    if (ticks_left)
+        logging::Info("[TR] Level changed, recording stopped");
+    ticks_left = 0;
+    if (ticks_recorded)
+        Finish();
+}
+
+static CatCommand record("debug_record_ticks", "Record the next <ticks> ticks of entity state to /tmp", [](const CCommand &args) {
+    if (ticks_left)
+    {
+        logging::Info("[TR] Already recording, %d ticks left", ticks_left);
+        return;
+    }
+    int ticks = args.ArgC() > 1 ? atoi(args.Arg(1)) : 66;
+    if (ticks <= 0)
+        return;
+    buffer.clear();
+    buffer.insert(buffer.end(), { 'C', 'A', 'T', 'R' });
+    Put(VERSION);
+    ticks_recorded = 0;
+    ticks_left     = ticks;
+    logging::Info("[TR] Recording %d ticks", ticks);
+});
+
+static InitRoutine init([]() {
+    // Late, so everything has read the snapshot and bones by the time they get recorded
+    EC::Register(EC::CreateMove, CreateMove, "cm_tickrecorder", EC::very_late);
+    EC::Register(EC::LevelShutdown, Abort, "levelshutdown_tickrecorder");
+});
+} // namespace tickrecorder
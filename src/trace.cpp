@@ -9,89 +9,120 @@
 
 // This file is a mess. I need to fix it. TODO
 
-/* Default Filter */
+/* Shared helpers */
 
-trace::FilterDefault::FilterDefault()
+// The engine hands us IHandleEntity pointers, one virtual call gets us the index and the rest comes from the snapshot
+static inline int FilterClassID(IClientEntity *entity, int idx)
 {
-    m_pSelf = nullptr;
+    if (idx >= 0 && idx < MAX_ENTITIES && entity_cache::SnapshotValid(idx))
+        return entity_cache::snapshot.class_id[idx];
+    return entity->GetClientClass()->m_ClassID;
 }
 
-trace::FilterDefault::~FilterDefault()
+static inline int FilterTeam(int idx)
 {
+    if (idx < 0 || idx >= MAX_ENTITIES)
+        return -1;
+    if (entity_cache::SnapshotValid(idx))
+        return entity_cache::snapshot.team[idx];
+    CachedEntity *ent = ENTITY(idx);
+    return CE_VALID(ent) ? ent->m_iTeam() : -1;
 }
 
-void trace::FilterDefault::SetSelf(IClientEntity *self)
+/* Bitmask filter */
+
+trace::FilterMask::FilterMask(unsigned flags)
+{
+    m_pSelf        = nullptr;
+    m_pIgnoreFirst = nullptr;
+    m_flags        = flags;
+    m_iSelfTeam    = -1;
+    m_bSelfSniper  = false;
+}
+
+trace::FilterMask::~FilterMask()
+{
+}
+
+void trace::FilterMask::SetSelf(IClientEntity *self)
 {
     if (self == nullptr)
     {
-        logging::Info("nullptr in FilterDefault::SetSelf");
+        logging::Info("nullptr in FilterMask::SetSelf");
+    }
+    m_pSelf       = self;
+    m_iSelfTeam   = -1;
+    m_bSelfSniper = false;
+    if (!self || !(m_flags & FILTER_SNIPER_TEAMMATES))
+        return;
+    // Work this out once per trace instead of for every teammate the ray touches
+    auto ent = ENTITY(self->entindex());
+    if (CE_GOOD(ent) && ent->m_bAlivePlayer())
+    {
+        m_iSelfTeam = ent->m_iTeam();
+        // Get held weapon
+        auto weapon_idx = CE_INT(ent, netvar.hActiveWeapon) & 0xFFF;
+        // Check if weapon is valid
+        if (IDX_GOOD(weapon_idx))
+        {
+            auto weapon = ENTITY(weapon_idx);
+            // If holding sniper rifle
+            m_bSelfSniper = weapon->m_iClassID() == CL_CLASS(CTFSniperRifle) || weapon->m_iClassID() == CL_CLASS(CTFSniperRifleDecap);
+        }
     }
-    m_pSelf = self;
 }
 
-bool trace::FilterDefault::ShouldHitEntity(IHandleEntity *handle, int mask)
+void trace::FilterMask::Reset()
 {
-    IClientEntity *entity;
-    ClientClass *clazz;
+    m_pIgnoreFirst = nullptr;
+}
 
+bool trace::FilterMask::ShouldHitEntity(IHandleEntity *handle, int mask)
+{
     if (!handle)
         return false;
-    entity = (IClientEntity *) handle;
-    clazz  = entity->GetClientClass();
+    auto entity = (IClientEntity *) handle;
+    int idx     = entity->entindex();
+    int classid = FilterClassID(entity, idx);
+    auto &entry = classinfo::GetClassEntry(classid);
+
+    if (m_flags & FILTER_WORLD_ONLY)
+        return entry.flags & classinfo::CF_WORLD;
     /* Ignore invisible entities that we don't wanna hit */
-    switch (clazz->m_ClassID)
-    {
-    // TODO magic numbers: invisible entity ids
-    case CL_CLASS(CFuncRespawnRoomVisualizer):
-    case CL_CLASS(CTFMedigunShield):
-    case CL_CLASS(CFuncAreaPortalWindow):
+    if ((m_flags & FILTER_IGNORE_INVISIBLE) && (entry.flags & classinfo::CF_TRACE_INVISIBLE))
+        return false;
+    if ((m_flags & FILTER_IGNORE_PLAYERS) && (entry.type == ENTITY_PLAYER || (entry.flags & classinfo::CF_PLAYER_RESOURCE)))
         return false;
-    // Sniper rifles can shoot through teammates!
-    case CL_CLASS(CTFPlayer):
+    if (entry.type == ENTITY_PLAYER)
     {
-        if (m_pSelf)
-        {
-            // If what we hit is an enemy it does not matter
-            if (entity && CE_VALID(ENTITY(entity->entindex())) && ENTITY(entity->entindex())->m_iTeam() == ENTITY(m_pSelf->entindex())->m_iTeam())
-            {
-                auto ent = ENTITY(m_pSelf->entindex());
-                if (CE_GOOD(ent) && ent->m_bAlivePlayer())
-                {
-                    // Get held weapon
-                    auto weapon_idx = CE_INT(ent, netvar.hActiveWeapon) & 0xFFF;
-                    // Check if weapon is valid
-                    if (IDX_GOOD(weapon_idx))
-                    {
-                        auto weapon = ENTITY(weapon_idx);
-                        // If holding sniper rifle
-                        if (weapon->m_iClassID() == CL_CLASS(CTFSniperRifle) || weapon->m_iClassID() == CL_CLASS(CTFSniperRifleDecap))
-                            return false;
-                    }
-                }
-            }
-        }
-        break;
-    }
+        // Sniper rifles can shoot through teammates!
+        if (m_bSelfSniper && FilterTeam(idx) == m_iSelfTeam)
+            return false;
+        if ((m_flags & FILTER_IGNORE_FIRST_PLAYER) && !m_pIgnoreFirst && entity != m_pSelf)
+            m_pIgnoreFirst = entity;
     }
     /* Do not hit yourself. Idiot. */
-    if (entity == m_pSelf)
+    if ((m_flags & FILTER_IGNORE_SELF) && entity == m_pSelf)
+        return false;
+    if ((m_flags & FILTER_IGNORE_FIRST_PLAYER) && entity == m_pIgnoreFirst)
         return false;
     return true;
 }
 
-TraceType_t trace::FilterDefault::GetTraceType() const
+TraceType_t trace::FilterMask::GetTraceType() const
 {
     return TRACE_EVERYTHING;
 }
 
-/* No-Player filter */
+/* Presets */
 
-trace::FilterNoPlayer::FilterNoPlayer()
+trace::FilterDefault::FilterDefault() : FilterMask(FILTER_IGNORE_SELF | FILTER_IGNORE_INVISIBLE | FILTER_SNIPER_TEAMMATES)
 {
-    m_pSelf = nullptr;
 }
 
-trace::FilterNoPlayer::~FilterNoPlayer(){};
+trace::FilterNoPlayer::FilterNoPlayer() : FilterMask(FILTER_IGNORE_SELF | FILTER_IGNORE_INVISIBLE | FILTER_IGNORE_PLAYERS)
+{
+}
 
 void trace::FilterNoPlayer::SetSelf(IClientEntity *self)
 {
@@ -100,39 +131,16 @@ void trace::FilterNoPlayer::SetSelf(IClientEntity *self)
         logging::Info("nullptr in FilterNoPlayer::SetSelf");
         return;
     }
-    m_pSelf = self;
+    FilterMask::SetSelf(self);
 }
 
-bool trace::FilterNoPlayer::ShouldHitEntity(IHandleEntity *handle, int mask)
+// Hit doors, carts, etc
+trace::FilterNoEntity::FilterNoEntity() : FilterMask(FILTER_WORLD_ONLY)
 {
-    IClientEntity *entity;
-    ClientClass *clazz;
-
-    if (!handle)
-        return false;
-    entity = (IClientEntity *) handle;
-    clazz  = entity->GetClientClass();
-
-    /* Ignore invisible entities that we don't wanna hit */
-    switch (clazz->m_ClassID)
-    {
-    // TODO magic numbers: invisible entity ids
-    case CL_CLASS(CTFPlayerResource):
-    case CL_CLASS(CTFPlayer):
-    case CL_CLASS(CFuncRespawnRoomVisualizer):
-    case CL_CLASS(CTFMedigunShield):
-    case CL_CLASS(CFuncAreaPortalWindow):
-        return false;
-    }
-    /* Do not hit yourself. Idiot. */
-    if (entity == m_pSelf)
-        return false;
-    return true;
 }
 
-TraceType_t trace::FilterNoPlayer::GetTraceType() const
+trace::FilterPenetration::FilterPenetration() : FilterMask(FILTER_IGNORE_SELF | FILTER_IGNORE_INVISIBLE | FILTER_IGNORE_FIRST_PLAYER)
 {
-    return TRACE_EVERYTHING;
 }
 
 /* Navigation filter */
@@ -147,18 +155,18 @@ trace::FilterNavigation::~FilterNavigation(){};
 bool trace::FilterNavigation::ShouldHitEntity(IHandleEntity *handle, int mask)
 {
     IClientEntity *entity;
-    ClientClass *clazz;
 
     if (!handle)
         return false;
-    entity = (IClientEntity *) handle;
-    clazz  = entity->GetClientClass();
+    entity      = (IClientEntity *) handle;
+    int idx     = entity->entindex();
+    int classid = FilterClassID(entity, idx);
 
     // Ignore everything that is not the world or a CBaseEntity
-    if (entity->entindex() != 0 && clazz->m_ClassID != CL_CLASS(CBaseEntity))
+    if (idx != 0 && classid != CL_CLASS(CBaseEntity))
     {
         // Besides respawn room areas, we want to explicitly ignore those if they are not on our team
-        if (clazz->m_ClassID == CL_CLASS(CFuncRespawnRoomVisualizer))
+        if (classid == CL_CLASS(CFuncRespawnRoomVisualizer))
             if (CE_GOOD(LOCAL_E) && (g_pLocalPlayer->team == TEAM_RED || g_pLocalPlayer->team == TEAM_BLU))
             {
                 // If we can't collide, hit it
@@ -175,113 +183,101 @@ TraceType_t trace::FilterNavigation::GetTraceType() const
     return TRACE_EVERYTHING;
 }
 
-/* No-Entity filter */
-
-trace::FilterNoEntity::FilterNoEntity()
-{
-    m_pSelf = nullptr;
-}
+trace::FilterDefault trace::filter_default{};
+trace::FilterNoPlayer trace::filter_no_player{};
+trace::FilterNavigation trace::filter_navigation{};
+trace::FilterNoEntity trace::filter_no_entity{};
+trace::FilterPenetration trace::filter_penetration{};
 
-trace::FilterNoEntity::~FilterNoEntity(){};
+std::atomic<uint32_t> trace::rays{ 0 };
 
-void trace::FilterNoEntity::SetSelf(IClientEntity *self)
+void trace::TraceRay(const Ray_t &ray, unsigned int mask, ITraceFilter *filter, trace_t *trace)
 {
-    if (self == nullptr)
-    {
-        logging::Info("nullptr in FilterNoPlayer::SetSelf");
-        return;
-    }
-    m_pSelf = self;
+    rays.fetch_add(1, std::memory_order_relaxed);
+    g_ITrace->TraceRay(ray, mask, filter, trace);
 }
 
-bool trace::FilterNoEntity::ShouldHitEntity(IHandleEntity *handle, int mask)
-{
-    IClientEntity *entity;
-    ClientClass *clazz;
-
-    if (!handle)
-        return false;
-    entity = (IClientEntity *) handle;
-    clazz  = entity->GetClientClass();
+/* Batched visibility queries */
 
-    // Hit doors, carts, etc
-    switch (clazz->m_ClassID)
-    {
-    case CL_CLASS(CWorld):
-    case CL_CLASS(CPhysicsProp):
-    case CL_CLASS(CDynamicProp):
-    case CL_CLASS(CBaseDoor):
-    case CL_CLASS(CBaseEntity):
-        return true;
-    }
-    return false;
+trace::Batch::Batch(CachedEntity *target, unsigned mask, bool use_weapon_offset) : m_target(target), m_mask(mask), m_use_weapon_offset(use_weapon_offset)
+{
 }
 
-TraceType_t trace::FilterNoEntity::GetTraceType() const
+void trace::Batch::Add(const Vector &end, int id, bool pinned)
 {
-    return TRACE_EVERYTHING;
+    if (m_count >= MAX_QUERIES)
+        return;
+    m_queries[m_count++] = Query{ end, id, false, pinned, 0.0f, false, false };
+    m_sorted             = false;
 }
-/* Penetration Filter */
 
-trace::FilterPenetration::FilterPenetration()
+void trace::Batch::AddHitbox(int hitbox, bool pinned)
 {
-    m_pSelf = nullptr;
+    auto box = m_target->hitboxes.GetHitbox(hitbox);
+    if (!box || m_count >= MAX_QUERIES)
+        return;
+    m_queries[m_count++] = Query{ box->center, hitbox, true, pinned, 0.0f, false, false };
+    m_sorted             = false;
 }
 
-trace::FilterPenetration::~FilterPenetration(){};
-
-void trace::FilterPenetration::SetSelf(IClientEntity *self)
+void trace::Batch::Sort()
 {
-    if (self == nullptr)
+    if (m_sorted)
+        return;
+    m_sorted = true;
+    // A few trig ops are nothing compared to a trace
+    for (int i = 0; i < m_count; i++)
+        m_queries[i].fov = GetFov(g_pLocalPlayer->v_OrigViewangles, g_pLocalPlayer->v_Eye, m_queries[i].end);
+    int last_visible = m_target->hitboxes.last_visible_hitbox;
+    auto before      = [last_visible](const Query &a, const Query &b) {
+        if (a.pinned != b.pinned)
+            return a.pinned;
+        if (a.pinned)
+            return false;
+        bool a_last = a.hitbox && a.id == last_visible;
+        bool b_last = b.hitbox && b.id == last_visible;
+        if (a_last != b_last)
+            return a_last;
+        return a.fov < b.fov;
+    };
+    // Stable insertion sort, there's only a handful of queries and this never allocates
+    for (int i = 1; i < m_count; i++)
     {
-        logging::Info("nullptr in FilterPenetration::SetSelf");
+        Query query = m_queries[i];
+        int j       = i - 1;
+        for (; j >= 0 && before(query, m_queries[j]); j--)
+            m_queries[j + 1] = m_queries[j];
+        m_queries[j + 1] = query;
     }
-    m_pSelf = self;
 }
 
-bool trace::FilterPenetration::ShouldHitEntity(IHandleEntity *handle, int mask)
+bool trace::Batch::Run(Query &query)
 {
-    IClientEntity *entity;
-    ClientClass *clazz;
-
-    if (!handle)
-        return false;
-    entity = (IClientEntity *) handle;
-    clazz  = entity->GetClientClass();
-    /* Ignore invisible entities that we don't wanna hit */
-    switch (clazz->m_ClassID)
-    {
-    // TODO magic numbers: invisible entity ids
-    case CL_CLASS(CFuncRespawnRoomVisualizer):
-    case CL_CLASS(CTFMedigunShield):
-    case CL_CLASS(CFuncAreaPortalWindow):
-        return false;
-    case CL_CLASS(CTFPlayer):
-        if (!m_pIgnoreFirst && (entity != m_pSelf))
-        {
-            m_pIgnoreFirst = entity;
-        }
-    }
-    /* Do not hit yourself. Idiot. */
-    if (entity == m_pSelf)
-        return false;
-    if (entity == m_pIgnoreFirst)
-        return false;
-    return true;
+    if (query.done)
+        return query.visible;
+    query.done = true;
+    // Same question VisibilityCheck() asks, so let it memoize the answer
+    if (query.hitbox && m_use_weapon_offset && m_mask == MASK_SHOT_HULL)
+        query.visible = m_target->hitboxes.VisibilityCheck(query.id);
+    else
+        query.visible = IsEntityVectorVisible(m_target, query.end, m_use_weapon_offset, m_mask);
+    if (query.visible && query.hitbox)
+        m_target->hitboxes.last_visible_hitbox = query.id;
+    return query.visible;
 }
 
-TraceType_t trace::FilterPenetration::GetTraceType() const
+int trace::Batch::AnyVisible()
 {
-    return TRACE_EVERYTHING;
+    Sort();
+    for (int i = 0; i < m_count; i++)
+        if (Run(m_queries[i]))
+            return m_queries[i].id;
+    return -1;
 }
 
-void trace::FilterPenetration::Reset()
+void trace::Batch::All()
 {
-    m_pIgnoreFirst = 0;
+    Sort();
+    for (int i = 0; i < m_count; i++)
+        Run(m_queries[i]);
 }
-
-trace::FilterDefault trace::filter_default{};
-trace::FilterNoPlayer trace::filter_no_player{};
-trace::FilterNavigation trace::filter_navigation{};
-trace::FilterNoEntity trace::filter_no_entity{};
-trace::FilterPenetration trace::filter_penetration{};
@@ -0,0 +1,86 @@
+#include "common.hpp"
+#include "usermessages.hpp"
+
+namespace usermessages
+{
+// Copies the next string into raw at used, always terminated. Truncated strings still get skipped entirely
+static const char *String(bf_read &buf, message_s &out, size_t &used)
+{
+    char *at = out.raw + used;
+    int length;
+    buf.ReadString(at, sizeof(out.raw) - used, false, &length);
+    used = std::min(sizeof(out.raw) - 1, used + length + 1);
+    return at;
+}
+
+static bool DecodeSayText2(bf_read &buf, message_s &out)
+{
+    // Everything past the strings is fine to lose, the hook only looks at two arguments
+    if (out.size >= int(sizeof(out.raw)))
+        return false;
+    auto &say   = out.say_text2;
+    say.entity  = buf.ReadByte();
+    say.chat    = buf.ReadByte();
+    size_t used = 0;
+    say.event   = String(buf, out, used);
+    say.name    = String(buf, out, used);
+    say.message = String(buf, out, used);
+    return true;
+}
+
+static void DecodeVoteStart(bf_read &buf, message_s &out)
+{
+    auto &vote  = out.vote_start;
+    vote.team   = buf.ReadByte();
+    vote.caller = buf.ReadByte();
+    size_t used = 0;
+    vote.reason = String(buf, out, used);
+    vote.name   = String(buf, out, used);
+    // Low bit is whether it's a yes/no vote
+    vote.target = (unsigned char) buf.ReadByte() >> 1;
+}
+
+bool Decode(bf_read &buf, int type, message_s &out)
+{
+    out.type    = type;
+    out.size    = buf.GetNumBytesLeft();
+    out.raw[0]  = 0;
+    size_t used = 0;
+    bool good   = true;
+    switch (type)
+    {
+    case SayText2:
+        good = DecodeSayText2(buf, out);
+        break;
+    case TextMsg:
+        out.text_msg.dest = buf.ReadByte();
+        out.text_msg.text = String(buf, out, used);
+        break;
+    case VGUIMenu:
+        out.vgui_menu.name = String(buf, out, used);
+        break;
+    case VoiceSubtitle:
+        out.voice_subtitle.entity  = buf.ReadByte();
+        out.voice_subtitle.menu    = buf.ReadByte();
+        out.voice_subtitle.command = buf.ReadByte();
+        break;
+    case HudNotify:
+        out.hud_notify.type = buf.ReadByte();
+        break;
+    case VoteStart:
+        DecodeVoteStart(buf, out);
+        break;
+    // Nothing we need in these
+    case CallVoteFailed:
+    case VotePass:
+    case VoteFailed:
+    case VoteSetup:
+        break;
+    default:
+        return false;
+    }
+    good = good && !buf.IsOverflowed();
+    buf.Seek(0);
+    return good;
+}
+} // namespace usermessages
@@ -14,6 +14,106 @@ namespace velocity
 
 EstimateAbsVelocity_t EstimateAbsVelocity{};
 
+// Origins of the last few server updates per player
+constexpr int HISTORY = 8;
+// Velocity is averaged over up to this many updates
+constexpr int WINDOW = 4;
+struct history_s
+{
+    std::array<Vector, HISTORY> origin;
+    std::array<float, HISTORY> time;
+    int head{ 0 };
+    int count{ 0 };
+};
+static std::array<history_s, PLAYER_ARRAY_SIZE> history{};
+
+static const Vector &Origin(const history_s &h, int age)
+{
+    return h.origin[(h.head - age + HISTORY) % HISTORY];
+}
+static float Time(const history_s &h, int age)
+{
+    return h.time[(h.head - age + HISTORY) % HISTORY];
+}
+
+static void Push(history_s &h, const Vector &origin, float time)
+{
+    // Respawns, teleports and simulation time going backwards all make the old samples useless
+    if (h.count && (time < Time(h, 0) || origin.DistTo(Origin(h, 0)) > 256.0f))
+        h.count = 0;
+    h.head           = (h.head + 1) % HISTORY;
+    h.origin[h.head] = origin;
+    h.time[h.head]   = time;
+    h.count          = std::min(h.count + 1, HISTORY);
+}
+
+void Get(CachedEntity *ent, Vector &out)
+{
+    if (ent->velocity_is_valid)
+        out = ent->m_vecVelocity;
+    else if (EstimateAbsVelocity)
+        EstimateAbsVelocity(RAW_ENT(ent), out);
+    else
+        out.Zero();
+}
+
+void Update()
+{
+    int max_clients = std::min(g_IEngine->GetMaxClients(), MAX_PLAYERS);
+    for (int i = 1; i <= max_clients; i++)
+    {
+        CachedEntity *ent = ENTITY(i);
+        history_s &h      = history[i];
+        if (CE_BAD(ent) || ent->m_Type() != ENTITY_PLAYER || !ent->m_bAlivePlayer())
+        {
+            h.count                = 0;
+            ent->velocity_is_valid = false;
+            continue;
+        }
+        // Engine prediction moves the local player mid tick, it has its own velocity netvar anyways
+        if (i == g_pLocalPlayer->entity_idx)
+        {
+            ent->velocity_is_valid = false;
+            continue;
+        }
+        float simtime = CE_FLOAT(ent, netvar.m_flSimulationTime);
+        // Only actual server updates count, choked ticks would read as standing still
+        if (!h.count || simtime != Time(h, 0))
+            Push(h, ent->m_vecOrigin(), simtime);
+
+        int window = std::min(h.count - 1, WINDOW);
+        float dt   = window > 0 ? Time(h, 0) - Time(h, window) : 0.0f;
+        if (dt <= 0.0f)
+        {
+            // Not enough history yet, let the game guess
+            if (EstimateAbsVelocity)
+                EstimateAbsVelocity(RAW_ENT(ent), ent->m_vecVelocity);
+            ent->m_vecAcceleration.Zero();
+            ent->velocity_is_valid = true;
+            continue;
+        }
+        ent->m_vecVelocity = (Origin(h, 0) - Origin(h, window)) / dt;
+
+        // Difference between the velocity of the newer and the older half of the history
+        if (h.count >= 3)
+        {
+            int half     = std::max(1, (h.count - 1) / 2);
+            int oldest   = std::min(h.count - 1, 2 * half);
+            float dt_new = Time(h, 0) - Time(h, half);
+            float dt_old = Time(h, half) - Time(h, oldest);
+            if (dt_new > 0.0f && dt_old > 0.0f)
+            {
+                Vector newer           = (Origin(h, 0) - Origin(h, half)) / dt_new;
+                Vector older           = (Origin(h, half) - Origin(h, oldest)) / dt_old;
+                ent->m_vecAcceleration = (newer - older) / ((dt_new + dt_old) / 2.0f);
+            }
+        }
+        else
+            ent->m_vecAcceleration.Zero();
+        ent->velocity_is_valid = true;
+    }
+}
+
 void Init()
 {
     EstimateAbsVelocity = (void (*)(IClientEntity *, Vector &)) gSignatures.GetClientSignature("55 89 E5 56 53 83 EC 20 8B 5D 08 8B 75 0C E8 ? ? ? ? 39 D8 74 79 "
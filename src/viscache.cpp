@@ -0,0 +1,94 @@
+#include "common.hpp"
+#include "settings/Bool.hpp"
+#include "viscache.hpp"
+
+namespace viscache
+{
+static settings::Boolean enabled{ "debug.vischeck-cache", "true" };
+
+// Open addressing, entries from older ticks count as empty so nothing has to be cleared
+constexpr unsigned TABLE_SIZE = 1024;
+constexpr unsigned MAX_PROBES = 8;
+
+struct entry
+{
+    query key;
+    unsigned long tick;
+    bool visible;
+};
+
+static entry table[TABLE_SIZE]{};
+static ProfilerCounter counter("VisCheckCache");
+
+query::query(const Vector &start, const Vector &end, int self, int target, unsigned mask, filter_type filter)
+{
+    this->start[0] = (int) floorf(start.x);
+    this->start[1] = (int) floorf(start.y);
+    this->start[2] = (int) floorf(start.z);
+    this->end[0]   = end.x;
+    this->end[1]   = end.y;
+    this->end[2]   = end.z;
+    this->self     = self;
+    this->target   = target;
+    this->mask     = mask;
+    this->filter   = filter;
+}
+
+static unsigned Hash(const query &q)
+{
+    // FNV-1a
+    unsigned hash = 2166136261u;
+    auto bytes    = (const unsigned char *) &q;
+    for (size_t i = 0; i < sizeof(query); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Entities move between CreateMoves, so only trust results from inside the current one
+static bool IsUsable()
+{
+    return *enabled && g_Settings.is_create_move;
+}
+
+bool Lookup(const query &q, bool &visible)
+{
+    if (!IsUsable())
+        return false;
+    unsigned hash = Hash(q);
+    for (unsigned i = 0; i < MAX_PROBES; i++)
+    {
+        auto &e = table[(hash + i) % TABLE_SIZE];
+        if (e.tick != tickcount)
+            break;
+        if (!memcmp(&e.key, &q, sizeof(query)))
+        {
+            counter.Hit();
+            visible = e.visible;
+            return true;
+        }
+    }
+    counter.Miss();
+    return false;
+}
+
+void Store(const query &q, bool visible)
+{
+    if (!IsUsable())
+        return;
+    unsigned hash = Hash(q);
+    for (unsigned i = 0; i < MAX_PROBES; i++)
+    {
+        auto &e = table[(hash + i) % TABLE_SIZE];
+        if (e.tick == tickcount && memcmp(&e.key, &q, sizeof(query)))
+            continue;
+        e.key     = q;
+        e.tick    = tickcount;
+        e.visible = visible;
+        return;
+    }
+    // Probe chain is full, just don't cache this one
+}
+} // namespace viscache
@@ -312,34 +312,65 @@ void EffectChams::RenderChamsRecursive(IClientEntity *entity)
 #endif
 }
 
-void EffectChams::RenderChams(IClientEntity *entity)
+// Who gets chams this frame and in what color, sorted by color so every pass only switches color once per group
+struct chams_entry_s
+{
+    IClientEntity *entity;
+    rgba_t color;
+};
+static std::vector<chams_entry_s> render_plan;
+
+static bool ColorLess(const rgba_t &a, const rgba_t &b)
+{
+    return std::lexicographical_compare(a.rgba, a.rgba + 4, b.rgba, b.rgba + 4);
+}
+
+void EffectChams::BuildRenderPlan()
+{
+    render_plan.clear();
+    for (int i = 1; i <= HIGHEST_ENTITY; i++)
+    {
+        IClientEntity *entity = g_IEntityList->GetClientEntity(i);
+        if (!entity || entity->IsDormant() || CE_BAD(ENTITY(i)))
+            continue;
+        if (ShouldRenderChams(entity))
+            render_plan.push_back(chams_entry_s{ entity, ChamsColor(entity) });
+    }
+    std::stable_sort(render_plan.begin(), render_plan.end(), [](const chams_entry_s &a, const chams_entry_s &b) { return ColorLess(a.color, b.color); });
+}
+
+void EffectChams::RenderPass(float brightness)
+{
+    for (size_t i = 0; i < render_plan.size(); i++)
+    {
+        if (!i || render_plan[i].color != render_plan[i - 1].color)
+            g_IVRenderView->SetColorModulation(render_plan[i].color * brightness);
+        RenderChamsRecursive(render_plan[i].entity);
+    }
+}
+
+void EffectChams::RenderPlan()
 {
 #if !ENFORCE_STREAM_SAFETY
-    if (!isHackActive() || !*effect_chams::enable)
+    if (!isHackActive() || !*effect_chams::enable || render_plan.empty())
         return;
     CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
-    if (ShouldRenderChams(entity))
+    if (!legit)
     {
-        rgba_t color   = ChamsColor(entity);
-        rgba_t color_2 = color * 0.6f;
-        if (!legit)
-        {
-            mat_unlit_z->AlphaModulate(1.0f);
-            ptr->DepthRange(0.0f, 0.01f);
-            g_IVRenderView->SetColorModulation(color_2);
-            g_IVModelRender->ForcedMaterialOverride(flat ? mat_unlit_z : mat_lit_z);
-            RenderChamsRecursive(entity);
-        }
+        mat_unlit_z->AlphaModulate(1.0f);
+        ptr->DepthRange(0.0f, 0.01f);
+        g_IVModelRender->ForcedMaterialOverride(flat ? mat_unlit_z : mat_lit_z);
+        RenderPass(0.6f);
+    }
 
-        if (legit || !singlepass)
-        {
-            mat_unlit->AlphaModulate(1.0f);
-            g_IVRenderView->SetColorModulation(color);
-            ptr->DepthRange(0.0f, 1.0f);
-            g_IVModelRender->ForcedMaterialOverride(flat ? mat_unlit : mat_lit);
-            RenderChamsRecursive(entity);
-        }
+    if (legit || !singlepass)
+    {
+        mat_unlit->AlphaModulate(1.0f);
+        ptr->DepthRange(0.0f, 1.0f);
+        g_IVModelRender->ForcedMaterialOverride(flat ? mat_unlit : mat_lit);
+        RenderPass(1.0f);
     }
+    ptr->DepthRange(0.0f, 1.0f);
 #endif
 }
 void EffectChams::Render(int x, int y, int w, int h)
@@ -356,7 +387,7 @@ void EffectChams::Render(int x, int y, int w, int h)
         Init();
     if (!isHackActive() || (g_IEngine->IsTakingScreenshot() && clean_screenshots))
         return;
-    if (hacks::tf2::backtrack::chams && hacks::tf2::backtrack::isBacktrackEnabled)
+    if (hacks::tf2::backtrack::chams && !hacks::tf2::backtrack::chams_hitboxes && hacks::tf2::backtrack::isBacktrackEnabled)
     {
         CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
         BeginRenderChams();
@@ -367,6 +398,9 @@ void EffectChams::Render(int x, int y, int w, int h)
             CachedEntity *ent = ENTITY(i);
             if (CE_BAD(ent) || i == g_IEngine->GetLocalPlayer() || !ent->m_bAlivePlayer() || ent->m_Type() != ENTITY_PLAYER)
                 continue;
+            // Already drawn along with the model this frame, doing it again would set up its bones a second time
+            if (i < PLAYER_ARRAY_SIZE && hacks::tf2::backtrack::chams_drawn_frame[i] == g_GlobalVars->framecount)
+                continue;
             // Entity won't draw in some cases so help the chams a bit
             hacks::tf2::backtrack::isDrawing = true;
             RAW_ENT(ent)->DrawModel(1);
@@ -378,13 +412,8 @@ void EffectChams::Render(int x, int y, int w, int h)
         return;
     CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
     BeginRenderChams();
-    for (int i = 1; i <= HIGHEST_ENTITY; i++)
-    {
-        IClientEntity *entity = g_IEntityList->GetClientEntity(i);
-        if (!entity || entity->IsDormant() || CE_BAD(ENTITY(i)))
-            continue;
-        RenderChams(entity);
-    }
+    BuildRenderPlan();
+    RenderPlan();
     EndRenderChams();
 #endif
 }
@@ -43,6 +43,8 @@ static settings::Boolean weapons_white{ "glow.white-weapons", "true" };
 static settings::Boolean glowself{ "glow.self", "true" };
 static settings::Boolean rainbow{ "glow.self-rainbow", "true" };
 static settings::Int blur_scale{ "glow.blur-scale", "5" };
+// 1, 2 or 4, glow buffers are rendered at screen size divided by this and stretched back up bilinearly
+static settings::Int resolution_divider{ "glow.resolution-divider", "1" };
 // https://puu.sh/vobH4/5da8367aef.png
 static settings::Int solid_when{ "glow.solid-when", "0" };
 settings::Boolean enable{ "glow.enable", "false" };
@@ -85,11 +87,19 @@ struct ShaderStencilState_t
     }
 };
 
-static CTextureReference buffers[4]{};
+// One set per resolution divider, index 0 is full resolution
+static CTextureReference buffers[3][4]{};
 
-ITexture *GetBuffer(int i)
+static int DividerIndex(int divider)
 {
-    if (!buffers[i])
+    return divider >= 4 ? 2 : divider >= 2 ? 1 : 0;
+}
+
+ITexture *GetBuffer(int i, int divider = 1)
+{
+    int index = DividerIndex(divider);
+    divider   = 1 << index;
+    if (!buffers[index][i])
     {
         ITexture *fullframe;
         IF_GAME(IsTF2())
@@ -97,9 +107,12 @@ ITexture *GetBuffer(int i)
         else fullframe = g_IMaterialSystemHL->FindTexture("_rt_FullFrameFB", TEXTURE_GROUP_RENDER_TARGET);
         // char *newname    = new char[32];
         std::unique_ptr<char[]> newname(new char[32]);
-        std::string name = format("_cathook_buff", i);
+        // Full resolution keeps the names the materials are created with
+        std::string name = index ? format("_cathook_buff", i, "_", divider) : format("_cathook_buff", i);
         strncpy(newname.get(), name.c_str(), 30);
-        logging::Info("Creating new buffer %d with size %dx%d %s", i, fullframe->GetActualWidth(), fullframe->GetActualHeight(), newname.get());
+        int width  = fullframe->GetActualWidth() / divider;
+        int height = fullframe->GetActualHeight() / divider;
+        logging::Info("Creating new buffer %d with size %dx%d %s", i, width, height, newname.get());
 
         int textureFlags      = TEXTUREFLAGS_CLAMPS | TEXTUREFLAGS_CLAMPT | TEXTUREFLAGS_EIGHTBITALPHA;
         int renderTargetFlags = CREATERENDERTARGETFLAGS_HDR;
@@ -107,17 +120,22 @@ ITexture *GetBuffer(int i)
         ITexture *texture;
         IF_GAME(IsTF2())
         {
-            texture = g_IMaterialSystem->CreateNamedRenderTargetTextureEx(newname.get(), fullframe->GetActualWidth(), fullframe->GetActualHeight(), RT_SIZE_LITERAL, IMAGE_FORMAT_RGBA8888, MATERIAL_RT_DEPTH_SEPARATE, textureFlags, renderTargetFlags);
+            texture = g_IMaterialSystem->CreateNamedRenderTargetTextureEx(newname.get(), width, height, RT_SIZE_LITERAL, IMAGE_FORMAT_RGBA8888, MATERIAL_RT_DEPTH_SEPARATE, textureFlags, renderTargetFlags);
         }
         else
         {
-            texture = g_IMaterialSystemHL->CreateNamedRenderTargetTextureEx(newname.get(), fullframe->GetActualWidth(), fullframe->GetActualHeight(), RT_SIZE_LITERAL, IMAGE_FORMAT_RGBA8888, MATERIAL_RT_DEPTH_SEPARATE, textureFlags, renderTargetFlags);
+            texture = g_IMaterialSystemHL->CreateNamedRenderTargetTextureEx(newname.get(), width, height, RT_SIZE_LITERAL, IMAGE_FORMAT_RGBA8888, MATERIAL_RT_DEPTH_SEPARATE, textureFlags, renderTargetFlags);
         }
-        buffers[i].Init(texture);
+        buffers[index][i].Init(texture);
     }
-    return buffers[i];
+    return buffers[index][i];
 }
 
+// Divider of the buffers the blur and blit materials currently sample, and the viewport glow renders into
+static int bound_divider   = 1;
+static int current_divider = 1;
+static int glow_x, glow_y, glow_w, glow_h;
+
 static ShaderStencilState_t SS_NeverSolid{};
 static ShaderStencilState_t SS_SolidInvisible{};
 static ShaderStencilState_t SS_Null{};
@@ -134,6 +152,8 @@ void EffectGlow::Init()
     if (init)
         return;
     logging::Info("Init Glow...");
+    // The materials below start out sampling the full resolution buffers
+    bound_divider = 1;
     {
         KeyValues *kv = new KeyValues("UnlitGeneric");
         kv->SetString("$basetexture", "vgui/white_additive");
@@ -328,7 +348,8 @@ void EffectGlow::BeginRenderGlow()
     CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
     ptr->ClearColor4ub(0, 0, 0, 0);
     ptr->PushRenderTargetAndViewport();
-    ptr->SetRenderTarget(GetBuffer(1));
+    ptr->SetRenderTarget(GetBuffer(1, current_divider));
+    ptr->Viewport(glow_x, glow_y, glow_w, glow_h);
     ptr->OverrideAlphaWriteEnable(true, true);
     g_IVRenderView->SetBlend(0.99f);
     ptr->ClearBuffers(true, false);
@@ -436,13 +457,43 @@ void EffectGlow::DrawEntity(IClientEntity *entity)
 #endif
 }
 
-void EffectGlow::RenderGlow(IClientEntity *entity)
+// Who glows this frame and in what color, shared by the glow and the stencil pass.
+// Sorted by color so the glow pass only switches color once per group
+struct glow_entry_s
+{
+    IClientEntity *entity;
+    rgba_t color;
+};
+static std::vector<glow_entry_s> render_plan;
+
+void EffectGlow::BuildRenderPlan()
+{
+    render_plan.clear();
+    for (int i = 1; i <= HIGHEST_ENTITY; i++)
+    {
+        IClientEntity *entity = g_IEntityList->GetClientEntity(i);
+        if (!entity || entity->IsDormant() || !ShouldRenderGlow(entity))
+            continue;
+        // Off screen entities would only cost fill in the buffers and the stencil
+        Vector mins, maxs;
+        entity->GetRenderBoundsWorldspace(mins, maxs);
+        if (g_IEngine->CullBox(mins, maxs))
+            continue;
+        render_plan.push_back(glow_entry_s{ entity, GlowColor(entity) });
+    }
+    std::stable_sort(render_plan.begin(), render_plan.end(), [](const glow_entry_s &a, const glow_entry_s &b) { return std::lexicographical_compare(a.color.rgba, a.color.rgba + 4, b.color.rgba, b.color.rgba + 4); });
+}
+
+void EffectGlow::RenderPlan()
 {
 #if !ENFORCE_STREAM_SAFETY
-    CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
-    g_IVRenderView->SetColorModulation(GlowColor(entity));
     g_IVModelRender->ForcedMaterialOverride(mat_unlit_z);
-    DrawEntity(entity);
+    for (size_t i = 0; i < render_plan.size(); i++)
+    {
+        if (!i || render_plan[i].color != render_plan[i - 1].color)
+            g_IVRenderView->SetColorModulation(render_plan[i].color);
+        DrawEntity(render_plan[i].entity);
+    }
 #endif
 }
 
@@ -454,44 +505,43 @@ void EffectGlow::Render(int x, int y, int w, int h)
     if (!isHackActive() || (clean_screenshots && g_IEngine->IsTakingScreenshot()) || g_Settings.bInvalid || disable_visuals)
         return;
     static ITexture *orig;
-    static IClientEntity *ent;
     static IMaterialVar *blury_bloomamount;
     if (!init)
         Init();
     CMatRenderContextPtr ptr(GET_RENDER_CONTEXT);
     orig = ptr->GetRenderTarget();
-    BeginRenderGlow();
-    for (int i = 1; i <= HIGHEST_ENTITY; i++)
+    BuildRenderPlan();
+    current_divider = 1 << DividerIndex(*resolution_divider);
+    glow_x          = x / current_divider;
+    glow_y          = y / current_divider;
+    glow_w          = w / current_divider;
+    glow_h          = h / current_divider;
+    if (bound_divider != current_divider)
     {
-        ent = g_IEntityList->GetClientEntity(i);
-        if (ent && !ent->IsDormant() && ShouldRenderGlow(ent))
-        {
-            RenderGlow(ent);
-        }
+        mat_blit->FindVar("$basetexture", nullptr)->SetTextureValue(GetBuffer(1, current_divider));
+        mat_blur_x->FindVar("$basetexture", nullptr)->SetTextureValue(GetBuffer(1, current_divider));
+        mat_blur_y->FindVar("$basetexture", nullptr)->SetTextureValue(GetBuffer(2, current_divider));
+        bound_divider = current_divider;
     }
+    BeginRenderGlow();
+    RenderPlan();
     EndRenderGlow();
     if (*solid_when != 1)
     {
         ptr->ClearStencilBufferRectangle(x, y, w, h, 0);
         StartStenciling();
-        for (int i = 1; i <= HIGHEST_ENTITY; i++)
-        {
-            ent = g_IEntityList->GetClientEntity(i);
-            if (ent && !ent->IsDormant() && ShouldRenderGlow(ent))
-            {
-                DrawToStencil(ent);
-            }
-        }
+        for (auto &entry : render_plan)
+            DrawToStencil(entry.entity);
         EndStenciling();
     }
-    ptr->SetRenderTarget(GetBuffer(2));
-    ptr->Viewport(x, y, w, h);
+    ptr->SetRenderTarget(GetBuffer(2, current_divider));
+    ptr->Viewport(glow_x, glow_y, glow_w, glow_h);
     ptr->ClearBuffers(true, false);
-    ptr->DrawScreenSpaceRectangle(mat_blur_x, x, y, w, h, 0, 0, w - 1, h - 1, w, h);
-    ptr->SetRenderTarget(GetBuffer(1));
+    ptr->DrawScreenSpaceRectangle(mat_blur_x, glow_x, glow_y, glow_w, glow_h, 0, 0, glow_w - 1, glow_h - 1, glow_w, glow_h);
+    ptr->SetRenderTarget(GetBuffer(1, current_divider));
     blury_bloomamount = mat_blur_y->FindVar("$bloomamount", nullptr);
     blury_bloomamount->SetIntValue(*blur_scale);
-    ptr->DrawScreenSpaceRectangle(mat_blur_y, x, y, w, h, 0, 0, w - 1, h - 1, w, h);
+    ptr->DrawScreenSpaceRectangle(mat_blur_y, glow_x, glow_y, glow_w, glow_h, 0, 0, glow_w - 1, glow_h - 1, glow_w, glow_h);
     ptr->Viewport(x, y, w, h);
     ptr->SetRenderTarget(orig);
     g_IVRenderView->SetBlend(0.0f);
@@ -499,7 +549,8 @@ void EffectGlow::Render(int x, int y, int w, int h)
     {
         SS_Drawing.SetStencilState(ptr);
     }
-    ptr->DrawScreenSpaceRectangle(mat_blit, x, y, w, h, 0, 0, w - 1, h - 1, w, h);
+    // Stretched back to the screen, the buffers sample bilinearly
+    ptr->DrawScreenSpaceRectangle(mat_blit, x, y, w, h, 0, 0, glow_w - 1, glow_h - 1, glow_w, glow_h);
     if (*solid_when != -1)
     {
         SS_Null.SetStencilState(ptr);
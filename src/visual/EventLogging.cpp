@@ -8,6 +8,7 @@
 #if ENABLE_VISUALS
 #include <colors.hpp>
 #include <init.hpp>
+#include <gameevents.hpp>
 #include "KeyValues.h"
 #include "HookTools.hpp"
 
@@ -26,108 +27,95 @@ static settings::Boolean event_vote{ "chat.log-events.vote", "false" };
 static settings::Boolean debug_events{ "debug.log-events", "false" };
 static settings::String debug_name{ "debug.log-events.name", "" };
 
-static void handlePlayerConnectClient(KeyValues *kv)
+static void handlePlayerConnectClient(const game_events::event_s &event)
 {
-    PrintChat("\x07%06X%s\x01 \x07%06X%s\x01 joining", 0xa06ba0, kv->GetString("name"), 0x914e65, kv->GetString("networkid"));
+    PrintChat("\x07%06X%s\x01 \x07%06X%s\x01 joining", 0xa06ba0, event.raw->GetString("name"), 0x914e65, event.raw->GetString("networkid"));
 }
 
-static void handlePlayerActivate(KeyValues *kv)
+static void handlePlayerActivate(const game_events::event_s &event)
 {
-    int uid    = kv->GetInt("userid");
-    int entity = g_IEngine->GetPlayerForUserID(uid);
     player_info_s info{};
-    if (g_IEngine->GetPlayerInfo(entity, &info))
+    if (event.player && g_IEngine->GetPlayerInfo(event.player, &info))
         PrintChat("\x07%06X%s\x01 connected", 0xa06ba0, info.name);
 }
 
-static void handlePlayerDisconnect(KeyValues *kv)
+static void handlePlayerDisconnect(const game_events::event_s &event)
 {
-    CachedEntity *player = ENTITY(g_IEngine->GetPlayerForUserID(kv->GetInt("userid")));
-    if (player == nullptr || RAW_ENT(player) == nullptr)
+    CachedEntity *player = ENTITY(event.player);
+    if (!event.player || RAW_ENT(player) == nullptr)
         return;
-    PrintChat("\x07%06X%s\x01 \x07%06X%s\x01 disconnected", colors::chat::team(player->m_iTeam()), kv->GetString("name"), 0x914e65, kv->GetString("networkid"));
+    PrintChat("\x07%06X%s\x01 \x07%06X%s\x01 disconnected", colors::chat::team(player->m_iTeam()), event.raw->GetString("name"), 0x914e65, event.raw->GetString("networkid"));
 }
 
-static void handlePlayerTeam(KeyValues *kv)
+static void handlePlayerTeam(const game_events::event_s &event)
 {
-    if (kv->GetBool("disconnect"))
+    if (event.raw->GetBool("disconnect"))
         return;
 
-    int oteam           = kv->GetInt("oldteam");
-    int nteam           = kv->GetInt("team");
+    int oteam           = event.raw->GetInt("oldteam");
+    int nteam           = event.raw->GetInt("team");
     const char *oteam_s = teamname(oteam);
     const char *nteam_s = teamname(nteam);
     PrintChat("\x07%06X%s\x01 changed team (\x07%06X%s\x01 -> "
               "\x07%06X%s\x01)",
-              0xa06ba0, kv->GetString("name"), colors::chat::team(oteam), oteam_s, colors::chat::team(nteam), nteam_s);
+              0xa06ba0, event.raw->GetString("name"), colors::chat::team(oteam), oteam_s, colors::chat::team(nteam), nteam_s);
 }
 
-static void handlePlayerHurt(KeyValues *kv)
+// Both players still need to be around for their names and teams
+static bool VictimAndAttacker(int victim, int attacker, player_info_s &vinfo, player_info_s &kinfo)
 {
-    int victim   = kv->GetInt("userid");
-    int attacker = kv->GetInt("attacker");
-    int health   = kv->GetInt("health");
+    if (!victim || !attacker || !g_IEngine->GetPlayerInfo(victim, &vinfo) || !g_IEngine->GetPlayerInfo(attacker, &kinfo))
+        return false;
+    return RAW_ENT(ENTITY(victim)) != nullptr && RAW_ENT(ENTITY(attacker)) != nullptr;
+}
+
+static void handlePlayerHurt(const game_events::event_s &event)
+{
+    auto &hurt = *event.hurt;
     player_info_s kinfo{};
     player_info_s vinfo{};
-    if (!g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(victim), &vinfo) || !g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(attacker), &kinfo))
+    if (!VictimAndAttacker(hurt.victim, hurt.attacker, vinfo, kinfo))
         return;
-    CachedEntity *vic = ENTITY(g_IEngine->GetPlayerForUserID(victim));
-    CachedEntity *att = ENTITY(g_IEngine->GetPlayerForUserID(attacker));
-
-    if (vic == nullptr || att == nullptr || RAW_ENT(vic) == nullptr || RAW_ENT(att) == nullptr)
-        return;
-
-    PrintChat("\x07%06X%s\x01 hurt \x07%06X%s\x01 down to \x07%06X%d\x01hp", colors::chat::team(att->m_iTeam()), kinfo.name, colors::chat::team(vic->m_iTeam()), vinfo.name, 0x2aaf18, health);
+    PrintChat("\x07%06X%s\x01 hurt \x07%06X%s\x01 down to \x07%06X%d\x01hp", colors::chat::team(ENTITY(hurt.attacker)->m_iTeam()), kinfo.name, colors::chat::team(ENTITY(hurt.victim)->m_iTeam()), vinfo.name, 0x2aaf18, hurt.health);
 }
 
-static void handlePlayerDeath(KeyValues *kv)
+static void handlePlayerDeath(const game_events::event_s &event)
 {
-    int victim   = kv->GetInt("userid");
-    int attacker = kv->GetInt("attacker");
+    auto &death = *event.death;
     player_info_s kinfo{};
     player_info_s vinfo{};
-    if (!g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(victim), &vinfo) || !g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(attacker), &kinfo))
+    if (!VictimAndAttacker(death.victim, death.attacker, vinfo, kinfo))
         return;
-    CachedEntity *vic = ENTITY(g_IEngine->GetPlayerForUserID(victim));
-    CachedEntity *att = ENTITY(g_IEngine->GetPlayerForUserID(attacker));
-
-    if (vic == nullptr || att == nullptr || RAW_ENT(vic) == nullptr || RAW_ENT(att) == nullptr)
-        return;
-
-    PrintChat("\x07%06X%s\x01 killed \x07%06X%s\x01", colors::chat::team(att->m_iTeam()), kinfo.name, colors::chat::team(vic->m_iTeam()), vinfo.name);
+    PrintChat("\x07%06X%s\x01 killed \x07%06X%s\x01", colors::chat::team(ENTITY(death.attacker)->m_iTeam()), kinfo.name, colors::chat::team(ENTITY(death.victim)->m_iTeam()), vinfo.name);
 }
 
-static void handlePlayerSpawn(KeyValues *kv)
+static void handlePlayerSpawn(const game_events::event_s &event)
 {
-    int id = kv->GetInt("userid");
     player_info_s info{};
-    if (!g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(id), &info))
+    if (!event.player || !g_IEngine->GetPlayerInfo(event.player, &info))
         return;
-    CachedEntity *player = ENTITY(g_IEngine->GetPlayerForUserID(id));
-    if (player == nullptr || RAW_ENT(player) == nullptr)
+    CachedEntity *player = ENTITY(event.player);
+    if (RAW_ENT(player) == nullptr)
         return;
     PrintChat("\x07%06X%s\x01 (re)spawned", colors::chat::team(player->m_iTeam()), info.name);
 }
 
-static void handlePlayerChangeClass(KeyValues *kv)
+static void handlePlayerChangeClass(const game_events::event_s &event)
 {
-    int id = kv->GetInt("userid");
-    if (id > PLAYER_ARRAY_SIZE || id < 0)
-        return;
     player_info_s info{};
-    if (!g_IEngine->GetPlayerInfo(g_IEngine->GetPlayerForUserID(id), &info))
+    if (!event.player || !g_IEngine->GetPlayerInfo(event.player, &info))
         return;
-    CachedEntity *player = ENTITY(g_IEngine->GetPlayerForUserID(id));
-    if (player == nullptr || RAW_ENT(player) == nullptr)
+    CachedEntity *player = ENTITY(event.player);
+    if (RAW_ENT(player) == nullptr)
         return;
-    PrintChat("\x07%06X%s\x01 changed to \x07%06X%s\x01", colors::chat::team(player->m_iTeam()), info.name, 0xa06ba0, classname(kv->GetInt("class")));
+    PrintChat("\x07%06X%s\x01 changed to \x07%06X%s\x01", colors::chat::team(player->m_iTeam()), info.name, 0xa06ba0, classname(event.raw->GetInt("class")));
 }
 
-static void handleVoteCast(KeyValues *kv)
+static void handleVoteCast(const game_events::event_s &event)
 {
-    int vote_option = kv->GetInt("vote_option");
-    int team        = kv->GetInt("team");
-    int idx         = kv->GetInt("entityid");
+    int vote_option = event.raw->GetInt("vote_option");
+    int team        = event.raw->GetInt("team");
+    int idx         = event.raw->GetInt("entityid");
     player_info_s info{};
     const char *team_s = teamname(team);
     if (g_IEngine->GetPlayerInfo(idx, &info))
@@ -150,114 +138,121 @@ std::vector<KeyValues *> Iterate(KeyValues *event, int depth)
     return peer_list;
 }
 
-class LoggingEventListener : public IGameEventListener
+// Dumps every event, only listening while debug.log-events is on
+class DebugEventListener : public IGameEventListener
 {
 public:
     void FireGameEvent(KeyValues *event) override
     {
-        if (debug_events)
+        std::string event_name = event->GetName();
+        if (*debug_name != "" && event_name.find(*debug_name) == event_name.npos)
         {
-            std::string event_name = event->GetName();
-            if (*debug_name != "" && event_name.find(*debug_name) == event_name.npos)
-            {
-            }
-            else
+        }
+        else
+        {
+            auto peer_list = Iterate(event, 10);
+            // loop through all our peers
+            for (KeyValues *dat : peer_list)
             {
-                auto peer_list = Iterate(event, 10);
-                // loop through all our peers
-                for (KeyValues *dat : peer_list)
+                auto data_type = dat->m_iDataType;
+                auto name      = dat->GetName();
+                logging::Info("%s", name, data_type);
+                switch (dat->m_iDataType)
                 {
-                    auto data_type = dat->m_iDataType;
-                    auto name      = dat->GetName();
-                    logging::Info("%s", name, data_type);
-                    switch (dat->m_iDataType)
-                    {
-                    case KeyValues::types_t::TYPE_NONE:
-                    {
-                        logging::Info("%s is typeless", name);
-                        break;
-                    }
-                    case KeyValues::types_t::TYPE_STRING:
+                case KeyValues::types_t::TYPE_NONE:
+                {
+                    logging::Info("%s is typeless", name);
+                    break;
+                }
+                case KeyValues::types_t::TYPE_STRING:
+                {
+                    if (dat->m_sValue && *(dat->m_sValue))
                     {
-                        if (dat->m_sValue && *(dat->m_sValue))
-                        {
-                            logging::Info("%s is String: %s", name, dat->m_sValue);
-                        }
-                        else
-                        {
-                            logging::Info("%s is String: %s", name, "");
-                        }
-                        break;
+                        logging::Info("%s is String: %s", name, dat->m_sValue);
                     }
-                    case KeyValues::types_t::TYPE_WSTRING:
+                    else
                     {
-                        break;
+                        logging::Info("%s is String: %s", name, "");
                     }
+                    break;
+                }
+                case KeyValues::types_t::TYPE_WSTRING:
+                {
+                    break;
+                }
 
-                    case KeyValues::types_t::TYPE_INT:
-                    {
-                        logging::Info("%s is int: %d", name, dat->m_iValue);
-                        break;
-                    }
+                case KeyValues::types_t::TYPE_INT:
+                {
+                    logging::Info("%s is int: %d", name, dat->m_iValue);
+                    break;
+                }
 
-                    case KeyValues::types_t::TYPE_UINT64:
-                    {
-                        logging::Info("%s is double: %f", name, *(double *) dat->m_sValue);
-                        break;
-                    }
+                case KeyValues::types_t::TYPE_UINT64:
+                {
+                    logging::Info("%s is double: %f", name, *(double *) dat->m_sValue);
+                    break;
+                }
 
-                    case KeyValues::types_t::TYPE_FLOAT:
-                    {
-                        logging::Info("%s is float: %f", name, dat->m_flValue);
-                        break;
-                    }
-                    case KeyValues::types_t::TYPE_COLOR:
-                    {
-                        logging::Info("%s is Color: { %u %u %u %u}", name, dat->m_Color[0], dat->m_Color[1], dat->m_Color[2], dat->m_Color[3]);
-                        break;
-                    }
-                    case KeyValues::types_t::TYPE_PTR:
-                    {
-                        logging::Info("%s is Pointer: %x", name, dat->m_pValue);
-                        break;
-                    }
+                case KeyValues::types_t::TYPE_FLOAT:
+                {
+                    logging::Info("%s is float: %f", name, dat->m_flValue);
+                    break;
+                }
+                case KeyValues::types_t::TYPE_COLOR:
+                {
+                    logging::Info("%s is Color: { %u %u %u %u}", name, dat->m_Color[0], dat->m_Color[1], dat->m_Color[2], dat->m_Color[3]);
+                    break;
+                }
+                case KeyValues::types_t::TYPE_PTR:
+                {
+                    logging::Info("%s is Pointer: %x", name, dat->m_pValue);
+                    break;
+                }
 
-                    default:
-                        break;
-                    }
+                default:
+                    break;
                 }
             }
         }
-        if (!enable)
-            return;
-        const char *name = event->GetName();
-        if (!strcmp(name, "player_connect_client") && event_connect)
-            handlePlayerConnectClient(event);
-        else if (!strcmp(name, "player_activate") && event_activate)
-            handlePlayerActivate(event);
-        else if (!strcmp(name, "player_disconnect") && event_disconnect)
-            handlePlayerDisconnect(event);
-        else if (!strcmp(name, "player_team") && event_team)
-            handlePlayerTeam(event);
-        else if (!strcmp(name, "player_hurt") && event_hurt)
-            handlePlayerHurt(event);
-        else if (!strcmp(name, "player_death") && event_death)
-            handlePlayerDeath(event);
-        else if (!strcmp(name, "player_spawn") && event_spawn)
-            handlePlayerSpawn(event);
-        else if (!strcmp(name, "player_changeclass") && event_changeclass)
-            handlePlayerChangeClass(event);
-        else if (!strcmp(name, "vote_cast") && event_vote)
-            handleVoteCast(event);
     }
 };
 
-static LoggingEventListener event_listener{};
+static DebugEventListener debug_listener{};
+static bool debug_listening = false;
+
+static void Listen(bool listen)
+{
+    if (listen == debug_listening)
+        return;
+    if (listen)
+        g_IGameEventManager->AddListener(&debug_listener, false);
+    else
+        g_IGameEventManager->RemoveListener(&debug_listener);
+    debug_listening = listen;
+}
+
+// Subscribed for good, the settings can change any time so they get checked per event
+static void On(const char *name, settings::Boolean &setting, void (*handler)(const game_events::event_s &))
+{
+    game_events::Subscribe(name, [&setting, handler](const game_events::event_s &event) {
+        if (enable && setting)
+            handler(event);
+    });
+}
 
 InitRoutine init([]() {
-    g_IGameEventManager->AddListener(&event_listener, false);
+    On("player_connect_client", event_connect, handlePlayerConnectClient);
+    On("player_activate", event_activate, handlePlayerActivate);
+    On("player_disconnect", event_disconnect, handlePlayerDisconnect);
+    On("player_team", event_team, handlePlayerTeam);
+    On("player_hurt", event_hurt, handlePlayerHurt);
+    On("player_death", event_death, handlePlayerDeath);
+    On("player_spawn", event_spawn, handlePlayerSpawn);
+    On("player_changeclass", event_changeclass, handlePlayerChangeClass);
+    On("vote_cast", event_vote, handleVoteCast);
+    debug_events.installChangeCallback([](settings::VariableBase<bool> &, bool after) { Listen(after); });
     EC::Register(
-        EC::Shutdown, []() { g_IGameEventManager->RemoveListener(&event_listener); }, "shutdown_eventlogger");
+        EC::Shutdown, []() { Listen(false); }, "shutdown_eventlogger");
 });
 
 bool isEnabled()
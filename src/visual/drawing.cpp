@@ -24,9 +24,14 @@
 #include <SDLHooks.hpp>
 #include "soundcache.hpp"
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 // String -> Wstring
 #include <codecvt>
 #include <locale>
+#include <unordered_map>
 
 #if EXTERNAL_DRAWING
 #include "xoverlay.h"
@@ -52,11 +57,24 @@ void ResetStrings()
     center_strings_count = 0;
 }
 
+// Assigning into the slot reuses its capacity, after the first few frames nothing here allocates anymore
+template <typename T> static void AddString(std::array<std::string, 32> &strings, std::array<rgba_t, 32> &colors, size_t &count, const T &string, const rgba_t &color)
+{
+    if (count >= strings.size())
+        return;
+    strings[count] = string;
+    colors[count]  = color;
+    ++count;
+}
+
 void AddSideString(const std::string &string, const rgba_t &color)
 {
-    side_strings[side_strings_count]        = string;
-    side_strings_colors[side_strings_count] = color;
-    ++side_strings_count;
+    AddString(side_strings, side_strings_colors, side_strings_count, string, color);
+}
+
+void AddSideString(const char *string, const rgba_t &color)
+{
+    AddString(side_strings, side_strings_colors, side_strings_count, string, color);
 }
 
 void DrawStrings()
@@ -80,36 +98,149 @@ void DrawStrings()
 
 void AddCenterString(const std::string &string, const rgba_t &color)
 {
-    center_strings[center_strings_count]        = string;
-    center_strings_colors[center_strings_count] = color;
-    ++center_strings_count;
+    AddString(center_strings, center_strings_colors, center_strings_count, string, color);
+}
+
+void AddCenterString(const char *string, const rgba_t &color)
+{
+    AddString(center_strings, center_strings_colors, center_strings_count, string, color);
+}
+
+namespace fonts
+{
+// Advance of every glyph a font was asked about, per font size. Widths become a table lookup per glyph
+struct glyph_cache_s
+{
+    const font *owner;
+    int size;
+    std::array<float, 128> ascii;
+    std::unordered_map<uint32_t, float> other;
+};
+static std::vector<glyph_cache_s> glyph_caches;
+
+static glyph_cache_s &GlyphCache(font &font)
+{
+    for (auto &cache : glyph_caches)
+        if (cache.owner == &font && cache.size == font.size)
+            return cache;
+    glyph_caches.push_back(glyph_cache_s{ &font, font.size, {}, {} });
+    glyph_caches.back().ascii.fill(-1.0f);
+    return glyph_caches.back();
+}
+
+// Decodes one UTF-8 code point and advances text past it, stray bytes come out as themselves
+static uint32_t NextCodepoint(const char *&text)
+{
+    auto byte = (unsigned char) *text++;
+    int extra = byte >= 0xF0 ? 3 : byte >= 0xE0 ? 2 : byte >= 0xC0 ? 1 : 0;
+    if (!extra)
+        return byte;
+    uint32_t codepoint = byte & (0x3F >> extra);
+    for (int i = 0; i < extra; i++)
+    {
+        if (((unsigned char) *text & 0xC0) != 0x80)
+            return byte;
+        codepoint = (codepoint << 6) | (*text++ & 0x3F);
+    }
+    return codepoint;
+}
+
+// Negative if the font can't measure yet
+static float MeasureGlyph(font &font, uint32_t codepoint)
+{
+#if ENABLE_ENGINE_DRAWING
+    int a, b, c;
+    g_ISurface->GetCharABCwide(font, codepoint, a, b, c);
+    return a + b + c;
+#else
+    char utf8[5]{};
+    if (codepoint < 0x80)
+        utf8[0] = codepoint;
+    else if (codepoint < 0x800)
+    {
+        utf8[0] = 0xC0 | (codepoint >> 6);
+        utf8[1] = 0x80 | (codepoint & 0x3F);
+    }
+    else if (codepoint < 0x10000)
+    {
+        utf8[0] = 0xE0 | (codepoint >> 12);
+        utf8[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+        utf8[2] = 0x80 | (codepoint & 0x3F);
+    }
+    else
+    {
+        utf8[0] = 0xF0 | (codepoint >> 18);
+        utf8[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+        utf8[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+        utf8[3] = 0x80 | (codepoint & 0x3F);
+    }
+    float x = -1.0f;
+    font.stringSize(utf8, &x, nullptr);
+    return x;
+#endif
+}
+
+static float GlyphAdvance(glyph_cache_s &cache, font &font, uint32_t codepoint)
+{
+    if (codepoint < cache.ascii.size())
+    {
+        float &advance = cache.ascii[codepoint];
+        if (advance < 0.0f)
+            advance = MeasureGlyph(font, codepoint);
+        return std::max(advance, 0.0f);
+    }
+    auto it = cache.other.find(codepoint);
+    if (it != cache.other.end())
+        return it->second;
+    float advance = MeasureGlyph(font, codepoint);
+    if (advance < 0.0f)
+        return 0.0f;
+    cache.other.emplace(codepoint, advance);
+    return advance;
+}
+
+float TextWidth(font &font, const char *text)
+{
+    auto &cache = GlyphCache(font);
+    float width = 0.0f;
+    while (*text)
+        width += GlyphAdvance(cache, font, NextCodepoint(text));
+    return width;
 }
 
+// Byte length and width of the text up to the end of every glyph
+static void PrefixWidths(font &font, const char *text, std::vector<std::pair<size_t, float>> &out)
+{
+    auto &cache       = GlyphCache(font);
+    const char *start = text;
+    float width       = 0.0f;
+    out.clear();
+    while (*text)
+    {
+        width += GlyphAdvance(cache, font, NextCodepoint(text));
+        out.emplace_back(text - start, width);
+    }
+}
+} // namespace fonts
+
 std::string ShrinkString(std::string data, int max_x, fonts::font &font)
 {
-    int padding = 5;
-    float x, y;
-    font.stringSize("..", &x, &y);
-    int dotdot_with = x;
+    int padding     = 5;
+    int dotdot_with = fonts::TextWidth(font, "..");
 
     if (padding + dotdot_with > max_x)
         return std::string();
 
     if (!data.empty())
     {
-        font.stringSize(data, &x, &y);
-        if (x + padding > max_x)
+        static std::vector<std::pair<size_t, float>> prefix;
+        fonts::PrefixWidths(font, data.c_str(), prefix);
+        if (prefix.back().second + padding > max_x)
         {
-            while (true)
-            {
-                font.stringSize(data, &x, &y);
-                if (x + padding + dotdot_with > max_x)
-                {
-                    data = data.substr(0, data.size() - 1);
-                }
-                else
-                    break;
-            }
+            // Keep the longest prefix that still fits together with the dots
+            float limit = max_x - padding - dotdot_with;
+            auto fit    = std::upper_bound(prefix.begin(), prefix.end(), limit, [](float width, const std::pair<size_t, float> &glyph) { return width < glyph.second; });
+            data.resize(fit == prefix.begin() ? 0 : (fit - 1)->first);
             data.append("..");
             return data;
         }
@@ -140,18 +271,14 @@ void font::Init()
     g_ISurface->SetFontGlyphSet(size_map[size], filename.c_str(), size, 500, 0, 0, flag);
     g_ISurface->AddCustomFontFile(filename.c_str(), path.c_str());
 }
-void font::stringSize(std::string string, float *x, float *y)
+void font::stringSize(const std::string &string, float *x, float *y)
 {
     if (!size_map[size])
         Init();
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t> > converter;
-    std::wstring ws = converter.from_bytes(string.c_str());
-    int w, h;
-    g_ISurface->GetTextSize(size_map[size], ws.c_str(), w, h);
     if (x)
-        *x = w;
+        *x = TextWidth(*this, string.c_str());
     if (y)
-        *y = h;
+        *y = g_ISurface->GetFontTall(size_map[size]);
 }
 void font::changeSize(int new_font_size)
 {
@@ -221,7 +348,7 @@ void Initialize()
 #endif
 }
 
-void String(int x, int y, rgba_t rgba, const char *text, fonts::font &font)
+static void SubmitString(int x, int y, rgba_t rgba, const char *text, fonts::font &font)
 {
 #if ENABLE_IMGUI_DRAWING
     im_renderer::draw::string(x, y, rgba, text, font);
@@ -229,6 +356,9 @@ void String(int x, int y, rgba_t rgba, const char *text, fonts::font &font)
     rgba = rgba * 255.0f;
     // Fix text being too low
     y -= 2;
+    // Converted once for the outline and the text itself
+    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t> > converter;
+    std::wstring ws = converter.from_bytes(text);
     // Outline magic
     if (font.outline)
     {
@@ -242,8 +372,6 @@ void String(int x, int y, rgba_t rgba, const char *text, fonts::font &font)
             g_ISurface->DrawSetTextFont(font);
             g_ISurface->DrawSetTextColor(0, 0, 0, rgba.a);
 
-            std::wstring_convert<std::codecvt_utf8_utf16<wchar_t> > converter;
-            std::wstring ws = converter.from_bytes(text);
             g_ISurface->DrawPrintText(ws.c_str(), ws.size() + 1);
 
             // Y Shift draw
@@ -251,7 +379,6 @@ void String(int x, int y, rgba_t rgba, const char *text, fonts::font &font)
             g_ISurface->DrawSetTextFont(font);
             g_ISurface->DrawSetTextColor(0, 0, 0, rgba.a);
 
-            ws = converter.from_bytes(text);
             g_ISurface->DrawPrintText(ws.c_str(), ws.size() + 1);
         }
     }
@@ -259,17 +386,13 @@ void String(int x, int y, rgba_t rgba, const char *text, fonts::font &font)
     g_ISurface->DrawSetTextFont(font);
     g_ISurface->DrawSetTextColor(rgba.r, rgba.g, rgba.b, rgba.a);
 
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t> > converter;
-    std::wstring ws = converter.from_bytes(text);
-
     g_ISurface->DrawPrintText(ws.c_str(), ws.size() + 1);
 #else
     glez::draw::outlined_string(x, y, text, font, rgba, colors::black, nullptr, nullptr);
 #endif
 }
 
-// x2_offset and y2_offset are an OFFSET, meaning you need to pass coordinate 2 - coordinate 1 for it to work, x2_offset is aded to x1
-void Line(float x1, float y1, float x2_offset, float y2_offset, rgba_t color, float thickness)
+static void SubmitLine(float x1, float y1, float x2_offset, float y2_offset, rgba_t color, float thickness)
 {
 #if ENABLE_IMGUI_DRAWING
     im_renderer::draw::line(x1, y1, x2_offset, y2_offset, color, thickness);
@@ -325,7 +448,7 @@ void Line(float x1, float y1, float x2_offset, float y2_offset, rgba_t color, fl
 #endif
 }
 
-void Rectangle(float x, float y, float w, float h, rgba_t color)
+static void SubmitRectangle(float x, float y, float w, float h, rgba_t color)
 {
 #if ENABLE_IMGUI_DRAWING
     im_renderer::draw::rectangle(x, y, w, h, color);
@@ -346,7 +469,7 @@ void Rectangle(float x, float y, float w, float h, rgba_t color)
 #endif
 }
 
-void Triangle(float x, float y, float x2, float y2, float x3, float y3, rgba_t color)
+static void SubmitTriangle(float x, float y, float x2, float y2, float x3, float y3, rgba_t color)
 {
 #if ENABLE_IMGUI_DRAWING
     im_renderer::draw::triangle(x, y, x2, y2, x3, y3, color);
@@ -366,28 +489,376 @@ void Triangle(float x, float y, float x2, float y2, float x3, float y3, rgba_t c
 #endif
 }
 
+// Defined with RectangleTextured below
+static void SubmitRectangleTextured(float x, float y, float w, float h, rgba_t color, Texture &texture, float tx, float ty, float tw, float th, float angle);
+
+#if !ENABLE_IMGUI_DRAWING
+// Primitives get recorded while a frame is open and submitted per layer, geometry first in the order it came in,
+// then one run per texture and font. ImGui does the same with draw list channels in im_renderer
+namespace draw_list
+{
+enum command_type : uint8_t
+{
+    CMD_LINE,
+    CMD_RECTANGLE,
+    CMD_TRIANGLE,
+    CMD_TEXTURED,
+    CMD_STRING
+};
+
+struct command_s
+{
+    command_type type;
+    float p[6];
+    rgba_t color;
+    float thickness;
+    // tx, ty, tw, th and angle of textured rectangles
+    float tex[5];
+    // Offset of the text in the arena
+    uint32_t text;
+};
+
+struct bucket_s
+{
+    // Font or texture every command in here uses
+    void *resource;
+    std::vector<command_s> commands;
+};
+
+static bool recording = false;
+static std::vector<command_s> geometry;
+static std::vector<bucket_s> buckets;
+static std::vector<char> text_arena;
+static frame_stats current_stats{};
+static frame_stats last_stats{};
+
+static std::vector<command_s> &Bucket(void *resource)
+{
+    for (auto &bucket : buckets)
+        if (bucket.resource == resource)
+            return bucket.commands;
+    buckets.push_back(bucket_s{ resource, {} });
+    return buckets.back().commands;
+}
+
+static void Flush()
+{
+    if (!geometry.empty())
+        current_stats.draw_calls++;
+    for (auto &cmd : geometry)
+    {
+        switch (cmd.type)
+        {
+        case CMD_LINE:
+            SubmitLine(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.color, cmd.thickness);
+            current_stats.vertices += cmd.thickness > 1.0f ? 4 : 2;
+            break;
+        case CMD_RECTANGLE:
+            SubmitRectangle(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.color);
+            current_stats.vertices += 4;
+            break;
+        case CMD_TRIANGLE:
+            SubmitTriangle(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.p[4], cmd.p[5], cmd.color);
+            current_stats.vertices += 3;
+            break;
+        default:
+            break;
+        }
+    }
+    geometry.clear();
+    for (auto &bucket : buckets)
+    {
+        if (bucket.commands.empty())
+            continue;
+        current_stats.draw_calls++;
+        for (auto &cmd : bucket.commands)
+        {
+            if (cmd.type == CMD_TEXTURED)
+            {
+                SubmitRectangleTextured(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.color, *(Texture *) bucket.resource, cmd.tex[0], cmd.tex[1], cmd.tex[2], cmd.tex[3], cmd.tex[4]);
+                current_stats.vertices += 4;
+            }
+            else
+            {
+                const char *text = text_arena.data() + cmd.text;
+                SubmitString(cmd.p[0], cmd.p[1], cmd.color, text, *(fonts::font *) bucket.resource);
+                current_stats.vertices += 4 * strlen(text);
+            }
+        }
+        bucket.commands.clear();
+    }
+    text_arena.clear();
+}
+} // namespace draw_list
+#endif
+
+void BeginFrame()
+{
+#if !ENABLE_IMGUI_DRAWING
+    draw_list::recording     = true;
+    draw_list::current_stats = {};
+#endif
+}
+
+void NextLayer()
+{
+#if ENABLE_IMGUI_DRAWING
+    im_renderer::bufferLayer();
+#else
+    draw_list::Flush();
+#endif
+}
+
+void EndFrame()
+{
+#if ENABLE_IMGUI_DRAWING
+    im_renderer::bufferEnd();
+#else
+    draw_list::Flush();
+    draw_list::recording  = false;
+    draw_list::last_stats = draw_list::current_stats;
+#endif
+}
+
+const frame_stats &LastFrameStats()
+{
+#if ENABLE_IMGUI_DRAWING
+    return im_renderer::lastFrameStats();
+#else
+    return draw_list::last_stats;
+#endif
+}
+
+static display_list *recording_list = nullptr;
+
+// Stores one public call, draw:: calls it makes itself are part of it and don't get stored again
+struct record_scope_s
+{
+    display_list *list;
+    record_scope_s() : list{ recording_list }
+    {
+        recording_list = nullptr;
+    }
+    ~record_scope_s()
+    {
+        recording_list = list;
+    }
+};
+
+bool Replay(display_list &list)
+{
+    // The age check catches ticks stalling, e.g. after leaving a server
+    if (!list.valid || list.tick != tickcount || list.screen_width != width || list.screen_height != height || list.recorded.check(100))
+        return false;
+    Play(list);
+    return true;
+}
+
+void Play(const display_list &list)
+{
+    for (auto &cmd : list.commands)
+    {
+        switch (cmd.type)
+        {
+        case display_list::CMD_LINE:
+            Line(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.color, cmd.thickness);
+            break;
+        case display_list::CMD_STRING:
+            String(cmd.p[0], cmd.p[1], cmd.color, list.text.data() + cmd.text, *(fonts::font *) cmd.resource);
+            break;
+        case display_list::CMD_RECTANGLE:
+            Rectangle(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.color);
+            break;
+        case display_list::CMD_TRIANGLE:
+            Triangle(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.p[4], cmd.p[5], cmd.color);
+            break;
+        case display_list::CMD_RECTANGLE_OUTLINED:
+            RectangleOutlined(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.color, cmd.thickness);
+            break;
+        case display_list::CMD_TEXTURED:
+            RectangleTextured(cmd.p[0], cmd.p[1], cmd.p[2], cmd.p[3], cmd.color, *(Texture *) cmd.resource, cmd.tex[0], cmd.tex[1], cmd.tex[2], cmd.tex[3], cmd.tex[4]);
+            break;
+        case display_list::CMD_CIRCLE:
+            Circle(cmd.p[0], cmd.p[1], cmd.p[2], cmd.color, cmd.p[3], int(cmd.thickness));
+            break;
+        }
+    }
+}
+
+void BeginRecording(display_list &list)
+{
+    list.commands.clear();
+    list.text.clear();
+    list.tick          = tickcount;
+    list.screen_width  = width;
+    list.screen_height = height;
+    list.valid         = true;
+    list.recorded.update();
+    recording_list = &list;
+}
+
+void EndRecording()
+{
+    recording_list = nullptr;
+}
+
+void String(int x, int y, rgba_t rgba, const char *text, fonts::font &font)
+{
+    if (recording_list)
+    {
+        display_list::command_s cmd{ display_list::CMD_STRING, { float(x), float(y) }, rgba };
+        cmd.resource = &font;
+        cmd.text     = recording_list->text.size();
+        recording_list->text.insert(recording_list->text.end(), text, text + strlen(text) + 1);
+        recording_list->commands.push_back(cmd);
+    }
+    record_scope_s scope;
+#if !ENABLE_IMGUI_DRAWING
+    if (draw_list::recording)
+    {
+        draw_list::command_s cmd{ draw_list::CMD_STRING, { float(x), float(y) }, rgba };
+        cmd.text = draw_list::text_arena.size();
+        draw_list::text_arena.insert(draw_list::text_arena.end(), text, text + strlen(text) + 1);
+        draw_list::Bucket(&font).push_back(cmd);
+        return;
+    }
+#endif
+    SubmitString(x, y, rgba, text, font);
+}
+
+// x2_offset and y2_offset are an OFFSET, meaning you need to pass coordinate 2 - coordinate 1 for it to work, x2_offset is aded to x1
+void Line(float x1, float y1, float x2_offset, float y2_offset, rgba_t color, float thickness)
+{
+    if (recording_list)
+        recording_list->commands.push_back(display_list::command_s{ display_list::CMD_LINE, { x1, y1, x2_offset, y2_offset }, color, thickness });
+    record_scope_s scope;
+#if !ENABLE_IMGUI_DRAWING
+    if (draw_list::recording)
+    {
+        draw_list::geometry.push_back(draw_list::command_s{ draw_list::CMD_LINE, { x1, y1, x2_offset, y2_offset }, color, thickness });
+        return;
+    }
+#endif
+    SubmitLine(x1, y1, x2_offset, y2_offset, color, thickness);
+}
+
+void Lines(const Vector *points, const uint8_t *pairs, int count, rgba_t color, float thickness)
+{
+    if (recording_list)
+    {
+        recording_list->commands.reserve(recording_list->commands.size() + count);
+        for (int i = 0; i < count; i++)
+        {
+            const Vector &a = points[pairs[i * 2]], &b = points[pairs[i * 2 + 1]];
+            recording_list->commands.push_back(display_list::command_s{ display_list::CMD_LINE, { a.x, a.y, b.x - a.x, b.y - a.y }, color, thickness });
+        }
+    }
+    record_scope_s scope;
+#if !ENABLE_IMGUI_DRAWING
+    if (draw_list::recording)
+    {
+        draw_list::geometry.reserve(draw_list::geometry.size() + count);
+        for (int i = 0; i < count; i++)
+        {
+            const Vector &a = points[pairs[i * 2]], &b = points[pairs[i * 2 + 1]];
+            draw_list::geometry.push_back(draw_list::command_s{ draw_list::CMD_LINE, { a.x, a.y, b.x - a.x, b.y - a.y }, color, thickness });
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < count; i++)
+    {
+        const Vector &a = points[pairs[i * 2]], &b = points[pairs[i * 2 + 1]];
+        SubmitLine(a.x, a.y, b.x - a.x, b.y - a.y, color, thickness);
+    }
+}
+
+void Rectangle(float x, float y, float w, float h, rgba_t color)
+{
+    if (recording_list)
+        recording_list->commands.push_back(display_list::command_s{ display_list::CMD_RECTANGLE, { x, y, w, h }, color });
+    record_scope_s scope;
+#if !ENABLE_IMGUI_DRAWING
+    if (draw_list::recording)
+    {
+        draw_list::geometry.push_back(draw_list::command_s{ draw_list::CMD_RECTANGLE, { x, y, w, h }, color });
+        return;
+    }
+#endif
+    SubmitRectangle(x, y, w, h, color);
+}
+
+void Triangle(float x, float y, float x2, float y2, float x3, float y3, rgba_t color)
+{
+    if (recording_list)
+        recording_list->commands.push_back(display_list::command_s{ display_list::CMD_TRIANGLE, { x, y, x2, y2, x3, y3 }, color });
+    record_scope_s scope;
+#if !ENABLE_IMGUI_DRAWING
+    if (draw_list::recording)
+    {
+        draw_list::geometry.push_back(draw_list::command_s{ draw_list::CMD_TRIANGLE, { x, y, x2, y2, x3, y3 }, color });
+        return;
+    }
+#endif
+    SubmitTriangle(x, y, x2, y2, x3, y3, color);
+}
+
+void RectangleTextured(float x, float y, float w, float h, rgba_t color, Texture &texture, float tx, float ty, float tw, float th, float angle)
+{
+    if (recording_list)
+        recording_list->commands.push_back(display_list::command_s{ display_list::CMD_TEXTURED, { x, y, w, h }, color, 0.0f, { tx, ty, tw, th, angle }, &texture });
+    record_scope_s scope;
+#if !ENABLE_IMGUI_DRAWING
+    if (draw_list::recording)
+    {
+        draw_list::Bucket(&texture).push_back(draw_list::command_s{ draw_list::CMD_TEXTURED, { x, y, w, h }, color, 0.0f, { tx, ty, tw, th, angle } });
+        return;
+    }
+#endif
+    SubmitRectangleTextured(x, y, w, h, color, texture, tx, ty, tw, th, angle);
+}
+
 void Circle(float x, float y, float radius, rgba_t color, float thickness, int steps)
 {
+    if (recording_list)
+        recording_list->commands.push_back(display_list::command_s{ display_list::CMD_CIRCLE, { x, y, radius, thickness }, color, float(steps) });
+    record_scope_s scope;
 #if ENABLE_IMGUI_DRAWING
     im_renderer::draw::circle(x, y, radius, color, thickness, steps);
 #else
-    float px = 0;
-    float py = 0;
-    for (int i = 0; i <= steps; i++)
+    // Unit circle of the last step count, the radar draws the same circles every frame
+    static std::vector<std::pair<float, float>> unit;
+    if (steps <= 0)
+        return;
+    if ((int) unit.size() != steps + 1)
     {
-        float ang = 2 * float(M_PI) * (float(i) / steps);
-        if (!i)
-            ang = 2 * float(M_PI);
-        if (i)
-            draw::Line(px, py, x - px + radius * cos(ang), y - py + radius * sin(ang), color, thickness);
-        px = x + radius * cos(ang);
-        py = y + radius * sin(ang);
+        unit.resize(steps + 1);
+        for (int i = 0; i <= steps; i++)
+        {
+            float ang = 2 * float(M_PI) * (float(i) / steps);
+            if (!i)
+                ang = 2 * float(M_PI);
+            unit[i] = { cos(ang), sin(ang) };
+        }
+    }
+    float px = x + radius * unit[0].first;
+    float py = y + radius * unit[0].second;
+    for (int i = 1; i <= steps; i++)
+    {
+        float nx = x + radius * unit[i].first;
+        float ny = y + radius * unit[i].second;
+        draw::Line(px, py, nx - px, ny - py, color, thickness);
+        px = nx;
+        py = ny;
     }
 #endif
 }
 
 void RectangleOutlined(float x, float y, float w, float h, rgba_t color, float thickness)
 {
+    if (recording_list)
+        recording_list->commands.push_back(display_list::command_s{ display_list::CMD_RECTANGLE_OUTLINED, { x, y, w, h }, color, thickness });
+    record_scope_s scope;
 #if ENABLE_IMGUI_DRAWING
     im_renderer::draw::rectangleOutlined(x, y, w, h, color, thickness);
 #else
@@ -398,7 +869,7 @@ void RectangleOutlined(float x, float y, float w, float h, rgba_t color, float t
 #endif
 }
 
-void RectangleTextured(float x, float y, float w, float h, rgba_t color, Texture &texture, float tx, float ty, float tw, float th, float angle)
+static void SubmitRectangleTextured(float x, float y, float w, float h, rgba_t color, Texture &texture, float tx, float ty, float tw, float th, float angle)
 {
 #if ENABLE_IMGUI_DRAWING
     im_renderer::draw::rectangleTextured(x, y, w, h, color, texture, tx, ty, tw, th, angle);
@@ -493,6 +964,91 @@ bool WorldToScreen(const Vector &origin, Vector &screen)
         return true;
     return false;
 }
+
+// Rows 0, 1 and 3 of a world to screen matrix, row 2 (depth) is never needed
+typedef float projection_t[3][4];
+
+static bool Project(const projection_t &m, const Vector *world, int count, Vector *screen, uint8_t *visible)
+{
+    bool all_visible = true;
+    const float hw   = draw::width / 2;
+    const float hh   = draw::height / 2;
+    const float sx   = 0.5f * draw::width;
+    const float sy   = 0.5f * draw::height;
+    int i            = 0;
+#if defined(__SSE__)
+    const __m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]), m03 = _mm_set1_ps(m[0][3]);
+    const __m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]), m13 = _mm_set1_ps(m[1][3]);
+    const __m128 m30 = _mm_set1_ps(m[2][0]), m31 = _mm_set1_ps(m[2][1]), m32 = _mm_set1_ps(m[2][2]), m33 = _mm_set1_ps(m[2][3]);
+    const __m128 vhw = _mm_set1_ps(hw), vhh = _mm_set1_ps(hh), vsx = _mm_set1_ps(sx), vsy = _mm_set1_ps(sy);
+    const __m128 half = _mm_set1_ps(0.5f), min_w = _mm_set1_ps(0.001f);
+    // Four points per pass, transposed so every lane holds one point
+    for (; i + 4 <= count; i += 4)
+    {
+        const Vector *p = world + i;
+        __m128 x        = _mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x);
+        __m128 y        = _mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y);
+        __m128 z        = _mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z);
+
+        __m128 w  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m30, x), _mm_mul_ps(m31, y)), _mm_add_ps(_mm_mul_ps(m32, z), m33));
+        __m128 cx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03));
+        __m128 cy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13));
+
+        __m128 odw = _mm_div_ps(_mm_set1_ps(1.0f), w);
+        __m128 rx  = _mm_add_ps(vhw, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cx, odw), vsx), half));
+        __m128 ry  = _mm_sub_ps(vhh, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cy, odw), vsy), half));
+        int mask   = _mm_movemask_ps(_mm_cmpgt_ps(w, min_w));
+
+        alignas(16) float out_x[4], out_y[4];
+        _mm_store_ps(out_x, rx);
+        _mm_store_ps(out_y, ry);
+        for (int j = 0; j < 4; j++)
+        {
+            screen[i + j].x = out_x[j];
+            screen[i + j].y = out_y[j];
+            screen[i + j].z = 0;
+            if (visible)
+                visible[i + j] = (mask >> j) & 1;
+        }
+        all_visible &= mask == 0xF;
+    }
+#endif
+    for (; i < count; i++)
+    {
+        const Vector &origin = world[i];
+        float w              = m[2][0] * origin[0] + m[2][1] * origin[1] + m[2][2] * origin[2] + m[2][3];
+        float odw            = 1.0f / w;
+        screen[i].x          = hw + ((m[0][0] * origin[0] + m[0][1] * origin[1] + m[0][2] * origin[2] + m[0][3]) * odw * sx + 0.5f);
+        screen[i].y          = hh - ((m[1][0] * origin[0] + m[1][1] * origin[1] + m[1][2] * origin[2] + m[1][3]) * odw * sy + 0.5f);
+        screen[i].z          = 0;
+        bool on_screen       = w > 0.001f;
+        if (visible)
+            visible[i] = on_screen;
+        all_visible &= on_screen;
+    }
+    return all_visible;
+}
+bool WorldToScreenBatch(const Vector *world, int count, Vector *screen, uint8_t *visible)
+{
+    const projection_t m = { { wts[0][0], wts[0][1], wts[0][2], wts[0][3] }, { wts[1][0], wts[1][1], wts[1][2], wts[1][3] }, { wts[3][0], wts[3][1], wts[3][2], wts[3][3] } };
+    return Project(m, world, count, screen, visible);
+}
+
+bool WorldToScreenBatch(const matrix3x4_t &transform, const Vector *local, int count, Vector *screen, uint8_t *visible)
+{
+    // Folding the transform into the projection once costs less than moving every point
+    static constexpr int rows[3] = { 0, 1, 3 };
+    projection_t m;
+    for (int r = 0; r < 3; r++)
+    {
+        const int row = rows[r];
+        for (int c = 0; c < 4; c++)
+            m[r][c] = wts[row][0] * transform[0][c] + wts[row][1] * transform[1][c] + wts[row][2] * transform[2][c];
+        m[r][3] += wts[row][3];
+    }
+    return Project(m, local, count, screen, visible);
+}
+
 #if ENABLE_ENGINE_DRAWING
 bool Texture::load()
 {
@@ -23,24 +23,33 @@
 #include "hack.hpp"
 #include "menu/menu/Menu.hpp"
 #include "drawmgr.hpp"
+#include "visual/frametiming.hpp"
 
 static settings::Boolean info_text{ "hack-info.enable", "true" };
 static settings::Boolean info_text_min{ "hack-info.minimal", "false" };
+// Needs debug.ec-monitor.enable to have anything to show
+static settings::Boolean ec_overlay{ "debug.ec-monitor.overlay", "false" };
+static settings::Boolean draw_stats{ "debug.draw-stats", "false" };
 
 void render_cheat_visuals()
 {
+    Timer::Sample();
+    uint64_t begin = profiler::Now();
     {
         PROF_SECTION(BeginCheatVisuals);
         BeginCheatVisuals();
     }
+    uint64_t draw = profiler::Now();
     {
         PROF_SECTION(DrawCheatVisuals);
         DrawCheatVisuals();
     }
+    uint64_t end = profiler::Now();
     {
         PROF_SECTION(EndCheatVisuals);
         EndCheatVisuals();
     }
+    frame_timing::Visuals(begin, draw, end, profiler::Now());
 }
 #if ENABLE_GLEZ_DRAWING
 glez::record::Record bufferA{};
@@ -57,6 +66,7 @@ void BeginCheatVisuals()
 #elif ENABLE_GLEZ_DRAWING
     buffers[currentBuffer]->begin();
 #endif
+    draw::BeginFrame();
     ResetStrings();
 }
 
@@ -94,6 +104,29 @@ void DrawCheatVisuals()
             }
         }
     }
+    if (ec_overlay)
+    {
+        PROF_SECTION(DRAW_ec_overlay);
+        static std::vector<EC::callback_latency> slowest;
+        static Timer refresh{};
+        if (refresh.test_and_set(500))
+            slowest = EC::SlowestCallbacks(8);
+        AddSideString("Slowest callbacks (p50 / p99):", GUIColor());
+        for (auto &i : slowest)
+        {
+            char line[128];
+            format_to(line, i.event, " ", i.name, ": ", int(i.p50_us), "us / ", int(i.p99_us), "us");
+            AddSideString(line, i.p99_us > 1000.0f ? colors::red : colors::white);
+        }
+    }
+    if (draw_stats)
+    {
+        auto &stats = draw::LastFrameStats();
+        char line[64];
+        format_to(line, "Draw calls: ", stats.draw_calls, " Vertices: ", stats.vertices);
+        AddSideString(line, GUIColor());
+    }
+    frame_timing::DrawOverlay();
     if (spectator_target)
     {
         AddCenterString("Press SPACE to stop spectating");
@@ -118,6 +151,8 @@ void DrawCheatVisuals()
 #if ENABLE_GUI
     {
         PROF_SECTION(DRAW_GUI);
+        // Menu stays above the visuals no matter what it draws
+        draw::NextLayer();
         gui::draw();
     }
 #endif
@@ -125,6 +160,7 @@ void DrawCheatVisuals()
 
 void EndCheatVisuals()
 {
+    draw::EndFrame();
 #if ENABLE_GLEZ_DRAWING
     buffers[currentBuffer]->end();
 #endif
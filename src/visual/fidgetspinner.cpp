@@ -27,30 +27,18 @@ static float angle          = 0;
 { spinning_speed += 100.0f;
 });*/
 
-class SpinnerListener : public IGameEventListener
+static void OnPlayerDeath(const game_events::event_s &event)
 {
-public:
-    void FireGameEvent(KeyValues *event) override
+    if (event.death->attacker == g_IEngine->GetLocalPlayer())
     {
-        std::string name(event->GetName());
-        if (name == "player_death")
-        {
-            int attacker = event->GetInt("attacker");
-            int eid      = g_IEngine->GetPlayerForUserID(attacker);
-            if (eid == g_IEngine->GetLocalPlayer())
-            {
-                spinning_speed += 300.0f;
-                // logging::Info("Spinning %.2f", spinning_speed);
-            }
-        }
+        spinning_speed += 300.0f;
+        // logging::Info("Spinning %.2f", spinning_speed);
     }
-};
-
-static SpinnerListener spinner_listener;
+}
 
 void InitSpinner()
 {
-    g_IGameEventManager->AddListener(&spinner_listener, false);
+    game_events::Subscribe("player_death", OnPlayerDeath);
 }
 
 static Timer retrytimer{};
@@ -87,8 +75,6 @@ void DrawSpinner()
 static InitRoutine init([]() {
     InitSpinner();
     EC::Register(EC::Draw, DrawSpinner, "spinner");
-    EC::Register(
-        EC::Shutdown, []() { g_IGameEventManager->RemoveListener(&spinner_listener); }, "shutdown_spinner");
 });
 
 #endif
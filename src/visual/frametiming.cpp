@@ -0,0 +1,253 @@
+#include "common.hpp"
+#include "visual/frametiming.hpp"
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <SDL2/SDL_video.h>
+#include <mutex>
+
+namespace frame_timing
+{
+static settings::Boolean overlay{ "debug.frame-timing.overlay", "false" };
+// Visuals and flush together, the graph is scaled to twice this
+static settings::Int budget_us{ "debug.frame-timing.budget-us", "2000" };
+
+static const char *const stage_names[STAGE_COUNT] = { "begin", "draw", "end", "flush", "gpu" };
+static const rgba_t stage_colors[STAGE_COUNT]     = { colors::blu, colors::green, colors::yellow, colors::orange, colors::pink };
+
+// Last frames for the graph, slot is the frame number modulo HISTORY
+constexpr int HISTORY = 128;
+struct frame_s
+{
+    uint64_t number;
+    float us[STAGE_COUNT];
+    // Counted against the budget yet, waits for the GPU time if there is going to be one
+    bool judged;
+};
+
+static std::mutex lock;
+static frame_s history[HISTORY]{};
+static uint64_t frame_number = 1;
+// Since the last Collect()
+static ProfilerHistogram histograms[STAGE_COUNT]{};
+static uint32_t frames      = 0;
+static uint32_t over_budget = 0;
+// Newest visuals from the game thread, they belong to whichever frame gets flushed next
+static float visuals_us[FLUSH_CPU]{};
+
+static ProfilerSection gpu_section("SWAPWINDOW_gpu");
+
+// GL_ARB_timer_query by hand, the context may be older than 3.3 and there's no glew with imgui drawing
+static PFNGLGENQUERIESPROC GenQueries;
+static PFNGLBEGINQUERYPROC BeginQuery;
+static PFNGLENDQUERYPROC EndQuery;
+static PFNGLGETQUERYOBJECTIVPROC GetQueryObjectiv;
+static PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v;
+// 0 not tried yet, -1 unsupported
+static int gpu_state = 0;
+
+// Results are read once the GPU got to them, usually two frames later, never waited for
+constexpr int QUERIES = 4;
+struct query_s
+{
+    GLuint id;
+    uint64_t frame;
+    uint64_t start;
+    bool pending;
+};
+static query_s queries[QUERIES]{};
+static int next_query    = 0;
+static query_s *active   = nullptr;
+static uint64_t flush_at = 0;
+
+static bool LoadQueries()
+{
+    if (gpu_state)
+        return gpu_state > 0;
+    gpu_state = -1;
+    if (!SDL_GL_ExtensionSupported("GL_ARB_timer_query"))
+    {
+        logging::Info("Frame timing: no GL_ARB_timer_query, GPU times unavailable");
+        return false;
+    }
+    GenQueries          = (PFNGLGENQUERIESPROC) SDL_GL_GetProcAddress("glGenQueries");
+    BeginQuery          = (PFNGLBEGINQUERYPROC) SDL_GL_GetProcAddress("glBeginQuery");
+    EndQuery            = (PFNGLENDQUERYPROC) SDL_GL_GetProcAddress("glEndQuery");
+    GetQueryObjectiv    = (PFNGLGETQUERYOBJECTIVPROC) SDL_GL_GetProcAddress("glGetQueryObjectiv");
+    GetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC) SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+    if (!GenQueries || !BeginQuery || !EndQuery || !GetQueryObjectiv || !GetQueryObjectui64v)
+        return false;
+    GLuint ids[QUERIES];
+    GenQueries(QUERIES, ids);
+    for (int i = 0; i < QUERIES; i++)
+        queries[i].id = ids[i];
+    gpu_state = 1;
+    return true;
+}
+
+static float FrameUs(const frame_s &frame)
+{
+    float total = 0.0f;
+    for (float us : frame.us)
+        total += us;
+    return total;
+}
+
+static void Judge(frame_s &frame)
+{
+    frame.judged = true;
+    if (FrameUs(frame) > *budget_us)
+        over_budget++;
+}
+
+static void ReadQueries()
+{
+    double ns_per_tick = profiler::NsPerTick();
+    for (auto &query : queries)
+    {
+        if (!query.pending)
+            continue;
+        GLint available = 0;
+        GetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 ns = 0;
+        GetQueryObjectui64v(query.id, GL_QUERY_RESULT, &ns);
+        query.pending = false;
+        if (gpu_section.m_enabled)
+            gpu_section.Add(query.start, query.start + uint64_t(ns / ns_per_tick));
+
+        std::lock_guard<std::mutex> guard(lock);
+        histograms[FLUSH_GPU].Record(ns);
+        auto &frame = history[query.frame % HISTORY];
+        if (frame.number != query.frame)
+            continue;
+        frame.us[FLUSH_GPU] = ns / 1000.0f;
+        if (!frame.judged)
+            Judge(frame);
+    }
+}
+
+void Visuals(uint64_t begin, uint64_t draw, uint64_t end, uint64_t done)
+{
+    double ns_per_tick             = profiler::NsPerTick();
+    uint64_t stamps[FLUSH_CPU + 1] = { begin, draw, end, done };
+    std::lock_guard<std::mutex> guard(lock);
+    for (int i = BEGIN_VISUALS; i < FLUSH_CPU; i++)
+    {
+        uint64_t ns = uint64_t((stamps[i + 1] - stamps[i]) * ns_per_tick);
+        histograms[i].Record(ns);
+        visuals_us[i] = ns / 1000.0f;
+    }
+}
+
+void FlushBegin()
+{
+    flush_at = profiler::Now();
+    if (!LoadQueries())
+        return;
+    ReadQueries();
+    // GPU is more than QUERIES frames behind, this frame goes without
+    if (queries[next_query].pending)
+        return;
+    active = &queries[next_query];
+    BeginQuery(GL_TIME_ELAPSED, active->id);
+}
+
+void FlushEnd()
+{
+    uint64_t ns = uint64_t((profiler::Now() - flush_at) * profiler::NsPerTick());
+    bool timed  = active != nullptr;
+    if (active)
+    {
+        EndQuery(GL_TIME_ELAPSED);
+        active->frame   = frame_number;
+        active->start   = flush_at;
+        active->pending = true;
+        next_query      = (next_query + 1) % QUERIES;
+        active          = nullptr;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    histograms[FLUSH_CPU].Record(ns);
+    auto &frame  = history[frame_number % HISTORY];
+    frame.number = frame_number;
+    for (int i = BEGIN_VISUALS; i < FLUSH_CPU; i++)
+        frame.us[i] = visuals_us[i];
+    frame.us[FLUSH_CPU] = ns / 1000.0f;
+    frame.us[FLUSH_GPU] = 0.0f;
+    frame.judged        = false;
+    if (!timed)
+        Judge(frame);
+    frames++;
+    frame_number++;
+}
+
+void DrawOverlay()
+{
+    if (!overlay)
+        return;
+    constexpr float BAR    = 2.0f;
+    constexpr float HEIGHT = 80.0f;
+    float x                = 10.0f;
+    float y                = draw::height - HEIGHT - 60.0f;
+    float budget           = std::max(*budget_us, 1);
+    // Twice the budget fills the graph
+    float scale = HEIGHT / (budget * 2.0f);
+
+    float sums[STAGE_COUNT]{};
+    int counted = 0;
+    draw::Rectangle(x, y, HISTORY * BAR, HEIGHT, colors::Transparent(colors::black, 0.6f));
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (int i = 0; i < HISTORY; i++)
+        {
+            // Oldest on the left
+            uint64_t number = frame_number - HISTORY + i;
+            auto &frame     = history[number % HISTORY];
+            if (number >= frame_number || frame.number != number)
+                continue;
+            float bottom = y + HEIGHT;
+            for (int stage = 0; stage < STAGE_COUNT; stage++)
+            {
+                float height = std::min(frame.us[stage] * scale, bottom - y);
+                if (height > 0.0f)
+                    draw::Rectangle(x + i * BAR, bottom - height, BAR, height, stage_colors[stage]);
+                bottom -= height;
+                sums[stage] += frame.us[stage];
+            }
+            counted++;
+        }
+    }
+    draw::Line(x, y + HEIGHT / 2.0f, HISTORY * BAR, 0.0f, colors::red, 1.0f);
+
+    float text_x = x + HISTORY * BAR + 6.0f;
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        char line[32];
+        format_to(line, stage_names[stage], " ", int(counted ? sums[stage] / counted : 0.0f), "us");
+        draw::String(text_x, y + stage * 14.0f, stage_colors[stage], line, *fonts::esp);
+    }
+}
+
+void Collect(summary_s &out)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    out.frames      = frames;
+    out.over_budget = over_budget;
+    for (int i = 0; i < STAGE_COUNT; i++)
+    {
+        out.p50_us[i] = histograms[i].Percentile(0.5f) / 1000;
+        out.p99_us[i] = histograms[i].Percentile(0.99f) / 1000;
+        histograms[i].Reset();
+    }
+    frames      = 0;
+    over_budget = 0;
+}
+
+static CatCommand print("debug_frame_timing", "Show p50/p99 of every frame stage since the last telemetry sample", []() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (int i = 0; i < STAGE_COUNT; i++)
+        logging::Info("%-6s p50 %6lluus p99 %6lluus", stage_names[i], (unsigned long long) histograms[i].Percentile(0.5f) / 1000, (unsigned long long) histograms[i].Percentile(0.99f) / 1000);
+    logging::Info("%u frames, %u over the %dus budget%s", frames, over_budget, *budget_us, gpu_state < 0 ? ", no GPU times" : "");
+});
+} // namespace frame_timing
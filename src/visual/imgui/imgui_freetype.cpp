@@ -645,6 +645,69 @@ bool ImGuiFreeType::BuildFontAtlas(ImFontAtlas *atlas, unsigned int extra_flags)
     return ret;
 }
 
+struct ImGuiFreeType::GlyphRasterizer::Impl
+{
+    FT_MemoryRec_ MemoryRec;
+    FT_Library Library;
+    FreeTypeFont Font;
+    unsigned char MultiplyTable[256];
+    bool Multiply;
+    ImVector<unsigned char> Pixels;
+};
+
+ImGuiFreeType::GlyphRasterizer::~GlyphRasterizer()
+{
+    if (!impl)
+        return;
+    impl->Font.CloseFont();
+    if (impl->Library)
+        FT_Done_Library(impl->Library);
+    IM_DELETE(impl);
+}
+
+bool ImGuiFreeType::GlyphRasterizer::Init(const ImFontConfig &cfg, unsigned int extra_flags)
+{
+    IM_ASSERT(!impl);
+    impl = IM_NEW(Impl)();
+    memset(&impl->MemoryRec, 0, sizeof(impl->MemoryRec));
+    impl->Library           = NULL;
+    impl->Font.Face         = NULL;
+    impl->MemoryRec.alloc   = &FreeType_Alloc;
+    impl->MemoryRec.free    = &FreeType_Free;
+    impl->MemoryRec.realloc = &FreeType_Realloc;
+    if (FT_New_Library(&impl->MemoryRec, &impl->Library) != 0)
+    {
+        impl->Library = NULL;
+        return false;
+    }
+    FT_Add_Default_Modules(impl->Library);
+    if (!impl->Font.InitFont(impl->Library, cfg, extra_flags))
+        return false;
+    impl->Multiply = cfg.RasterizerMultiply != 1.0f;
+    if (impl->Multiply)
+        ImFontAtlasBuildMultiplyCalcLookupTable(impl->MultiplyTable, cfg.RasterizerMultiply);
+    return true;
+}
+
+bool ImGuiFreeType::GlyphRasterizer::Rasterize(unsigned int codepoint, GlyphBitmap &out)
+{
+    if (!impl || !impl->Font.Face || !impl->Font.LoadGlyph(codepoint))
+        return false;
+    GlyphInfo info;
+    const FT_Bitmap *ft_bitmap = impl->Font.RenderGlyphAndGetInfo(&info);
+    if (!ft_bitmap)
+        return false;
+    impl->Pixels.resize(ImMax(info.Width * info.Height, 1));
+    impl->Font.BlitGlyph(ft_bitmap, impl->Pixels.Data, (uint32_t) info.Width, impl->Multiply ? impl->MultiplyTable : NULL);
+    out.Width    = info.Width;
+    out.Height   = info.Height;
+    out.OffsetX  = info.OffsetX;
+    out.OffsetY  = info.OffsetY;
+    out.AdvanceX = info.AdvanceX;
+    out.Pixels   = impl->Pixels.Data;
+    return true;
+}
+
 void ImGuiFreeType::SetAllocatorFunctions(void *(*alloc_func)(size_t sz, void *user_data), void (*free_func)(void *ptr, void *user_data), void *user_data)
 {
     GImFreeTypeAllocFunc         = alloc_func;
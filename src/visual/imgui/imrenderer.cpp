@@ -6,6 +6,7 @@
  */
 
 #include "visual/imgui/imrenderer.hpp"
+#include "config.h"
 #include "core/logging.hpp"
 #include "visual/SDLHooks.hpp"
 #include "visual/colors.hpp"
@@ -13,10 +14,25 @@
 #include "visual/imgui/imgui_freetype.h"
 #include "visual/imgui/imgui_impl.h"
 #include "visual/imgui/imgui_internal.h"
+#if EXTERNAL_DRAWING
+#include "visual/imgui/overlaytransport.hpp"
+#endif
 #include "visual/picopng.hpp"
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "visual/imgui/imstb_rect_pack.h"
 #include <fstream>           // Loading files
 #include <mathlib/mathlib.h> // SinCos
 #include <stack>             // Loading textures
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <future> // Decoding textures
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
 
 ImDrawListSharedData shared{};
 ImDrawList bufferA{ &shared };
@@ -37,6 +53,392 @@ std::stack<Texture *> &textures()
     return stack;
 }
 
+// Laid out text of recently used strings, quads are relative to the pen position.
+// Static text like the info lines then skips glyph lookups and measuring every frame
+struct glyph_quad_s
+{
+    ImVec2 min, max;
+    ImVec2 uv_min, uv_max;
+};
+
+// Glyphs outside the ranges baked into a font's atlas, CJK player names mostly. They get rasterized the first time
+// some text needs them, into fixed size cells of one texture per font that starts small and doubles when full.
+// Once it can't grow anymore the least recently drawn glyph gives up its cell
+struct glyph_page_s
+{
+    static constexpr int MIN_SIZE = 256;
+    static constexpr int MAX_SIZE = 1024;
+
+    struct glyph_s
+    {
+        // -1 if the font has no glyph for the code point, the fallback glyph gets drawn then
+        int cell;
+        ImVec2 min, max;
+        float advance;
+        // In the GL texture, until then text leaves it out and gets laid out again
+        bool uploaded;
+    };
+
+    bool usable{ false };
+    ImGuiFreeType::GlyphRasterizer rasterizer{};
+    int cell_size{ 0 };
+    // The texture is size * size, uploaded_size is what the GL texture currently has
+    int size{ 0 };
+    int uploaded_size{ 0 };
+    unsigned int texture{ 0 };
+    // RGBA, kept so growing and the overlay can copy everything again
+    std::vector<uint32_t> pixels{};
+    std::unordered_map<unsigned int, glyph_s> glyphs{};
+    std::vector<int> cell_x{}, cell_y{};
+    std::vector<unsigned int> cell_codepoint{};
+    std::vector<uint32_t> cell_used{};
+    std::vector<int> free_cells{};
+    // Rasterized but not uploaded yet
+    std::vector<int> dirty{};
+};
+
+// Shaping runs in the draw calls, uploading on the render thread
+static std::mutex glyph_lock;
+static std::unordered_map<ImFont *, std::unique_ptr<glyph_page_s>> glyph_pages;
+static uint32_t glyph_frame = 1;
+// New glyphs per frame, a page full of new names then spreads over a few frames instead of stalling one
+static constexpr int GLYPH_FRAME_BUDGET = 16;
+static int glyphs_rasterized            = 0;
+// Cell contents or texture coordinates changed, laid out text is wrong now
+static std::atomic<bool> text_runs_stale{ false };
+
+struct text_run_s
+{
+    ImFont *font;
+    std::string text;
+    std::vector<glyph_quad_s> quads;
+    ImVec2 size;
+    // Quads drawn from the font's glyph page and the cells they use
+    glyph_page_s *page{ nullptr };
+    std::vector<glyph_quad_s> page_quads{};
+    std::vector<int> page_cells{};
+    // A glyph wasn't ready yet, shaped again on the next lookup
+    bool incomplete{ false };
+};
+
+static constexpr size_t TEXT_RUN_CACHE_SIZE = 256;
+static std::list<text_run_s> text_runs;
+static std::unordered_map<uint64_t, std::list<text_run_s>::iterator> text_run_index;
+
+static glyph_page_s *glyphPage(ImFont *font)
+{
+    auto &page = glyph_pages[font];
+    if (!page)
+    {
+        page            = std::make_unique<glyph_page_s>();
+        page->cell_size = (int) ImCeil(font->FontSize) + 2;
+        page->usable    = font->ConfigData && page->rasterizer.Init(*font->ConfigData, 0);
+    }
+    return page->usable ? page.get() : nullptr;
+}
+
+// Doubles the page, cells keep their pixels but every texture coordinate changes
+static bool growPage(glyph_page_s &page)
+{
+    int old_size = page.size;
+    int new_size = old_size ? old_size * 2 : glyph_page_s::MIN_SIZE;
+    if (new_size > glyph_page_s::MAX_SIZE)
+        return false;
+    std::vector<uint32_t> pixels(new_size * new_size, IM_COL32(255, 255, 255, 0));
+    for (int y = 0; y < old_size; y++)
+        memcpy(&pixels[y * new_size], &page.pixels[y * old_size], old_size * sizeof(uint32_t));
+    page.pixels.swap(pixels);
+    page.size = new_size;
+
+    int old_cells = old_size / page.cell_size;
+    int new_cells = new_size / page.cell_size;
+    for (int row = 0; row < new_cells; row++)
+        for (int col = 0; col < new_cells; col++)
+        {
+            if (row < old_cells && col < old_cells)
+                continue;
+            page.free_cells.push_back(page.cell_x.size());
+            page.cell_x.push_back(col * page.cell_size);
+            page.cell_y.push_back(row * page.cell_size);
+            page.cell_codepoint.push_back(0);
+            page.cell_used.push_back(0);
+        }
+    // Goes up again as a whole texture
+    for (auto &glyph : page.glyphs)
+        if (glyph.second.cell >= 0)
+        {
+            glyph.second.uploaded = false;
+            page.dirty.push_back(glyph.second.cell);
+        }
+    text_runs_stale = true;
+    return true;
+}
+
+static int allocateCell(glyph_page_s &page)
+{
+    if (page.free_cells.empty() && !growPage(page))
+    {
+        // Least recently drawn glyph goes, text still using it gets laid out again
+        int oldest = 0;
+        for (size_t i = 1; i < page.cell_used.size(); i++)
+            if (page.cell_used[i] < page.cell_used[oldest])
+                oldest = i;
+        page.glyphs.erase(page.cell_codepoint[oldest]);
+        page.free_cells.push_back(oldest);
+        text_runs_stale = true;
+    }
+    if (page.free_cells.empty())
+        return -1;
+    int cell = page.free_cells.back();
+    page.free_cells.pop_back();
+    return cell;
+}
+
+static const glyph_page_s::glyph_s *pageGlyph(glyph_page_s &page, unsigned int codepoint, bool &pending)
+{
+    auto found = page.glyphs.find(codepoint);
+    if (found != page.glyphs.end())
+        return &found->second;
+    if (glyphs_rasterized >= GLYPH_FRAME_BUDGET)
+    {
+        pending = true;
+        return nullptr;
+    }
+    glyphs_rasterized++;
+    glyph_page_s::glyph_s glyph{ -1, {}, {}, 0.0f, false };
+    ImGuiFreeType::GlyphBitmap bitmap;
+    int cell;
+    if (page.rasterizer.Rasterize(codepoint, bitmap) && (cell = allocateCell(page)) >= 0)
+    {
+        int width  = ImMin(bitmap.Width, page.cell_size - 1);
+        int height = ImMin(bitmap.Height, page.cell_size - 1);
+        int x      = page.cell_x[cell];
+        int y      = page.cell_y[cell];
+        for (int row = 0; row < page.cell_size; row++)
+        {
+            uint32_t *dst = &page.pixels[(y + row) * page.size + x];
+            for (int col = 0; col < page.cell_size; col++)
+                dst[col] = IM_COL32(255, 255, 255, row < height && col < width ? bitmap.Pixels[row * bitmap.Width + col] : 0);
+        }
+        glyph.cell    = cell;
+        glyph.min     = ImVec2(bitmap.OffsetX, bitmap.OffsetY);
+        glyph.max     = ImVec2(bitmap.OffsetX + width, bitmap.OffsetY + height);
+        glyph.advance = bitmap.AdvanceX;
+        page.cell_codepoint[cell] = codepoint;
+        page.cell_used[cell]      = glyph_frame;
+        page.dirty.push_back(cell);
+    }
+    return &page.glyphs.emplace(codepoint, glyph).first->second;
+}
+
+// Lays out a code point the atlas doesn't have. Returns false if the fallback glyph should be used instead
+static bool shapePageGlyph(text_run_s &run, unsigned int c, float &x, float y, float &line_width)
+{
+    std::lock_guard<std::mutex> guard(glyph_lock);
+    glyph_page_s *page = glyphPage(run.font);
+    if (!page)
+        return false;
+    bool pending = false;
+    auto glyph   = pageGlyph(*page, c, pending);
+    if (!glyph)
+    {
+        // Over the budget, keep the spacing and try again next frame
+        run.incomplete = true;
+        x += run.font->FallbackAdvanceX;
+        line_width += run.font->FallbackAdvanceX;
+        return true;
+    }
+    if (glyph->cell < 0)
+        return false;
+    if (!glyph->uploaded)
+        run.incomplete = true;
+    else
+    {
+        float baseline = y + ImFloor(run.font->Ascent + 0.5f);
+        float uv       = 1.0f / page->size;
+        ImVec2 uv_min(page->cell_x[glyph->cell] * uv, page->cell_y[glyph->cell] * uv);
+        run.page = page;
+        run.page_quads.push_back(glyph_quad_s{ ImVec2(x + glyph->min.x, baseline + glyph->min.y), ImVec2(x + glyph->max.x, baseline + glyph->max.y), uv_min, uv_min + (glyph->max - glyph->min) * uv });
+        run.page_cells.push_back(glyph->cell);
+    }
+    x += glyph->advance;
+    line_width += glyph->advance;
+    return true;
+}
+
+static void shapeText(text_run_s &run)
+{
+    ImFont *font     = run.font;
+    const char *s    = run.text.c_str();
+    const char *end  = s + run.text.size();
+    float x          = font->DisplayOffset.x;
+    float y          = font->DisplayOffset.y;
+    float line_width = 0.0f;
+    run.quads.clear();
+    run.page = nullptr;
+    run.page_quads.clear();
+    run.page_cells.clear();
+    run.incomplete = false;
+    run.size       = ImVec2(0.0f, 0.0f);
+    while (s < end)
+    {
+        unsigned int c = (unsigned int) *s;
+        if (c < 0x80)
+            s += 1;
+        else
+        {
+            s += ImTextCharFromUtf8(&c, s, end);
+            if (c == 0)
+                break;
+        }
+        if (c == '\n')
+        {
+            run.size.x = ImMax(run.size.x, line_width);
+            run.size.y += font->FontSize;
+            line_width = 0.0f;
+            x          = font->DisplayOffset.x;
+            y += font->FontSize;
+            continue;
+        }
+        if (c == '\r')
+            continue;
+        const ImFontGlyph *glyph = c <= 0xFFFF ? font->FindGlyphNoFallback((ImWchar) c) : nullptr;
+        if (!glyph && c >= 0x80 && shapePageGlyph(run, c, x, y, line_width))
+            continue;
+        if (!glyph)
+            glyph = font->FallbackGlyph;
+        if (!glyph)
+            continue;
+        if (c != ' ' && c != '\t')
+            run.quads.push_back(glyph_quad_s{ ImVec2(x + glyph->X0, y + glyph->Y0), ImVec2(x + glyph->X1, y + glyph->Y1), ImVec2(glyph->U0, glyph->V0), ImVec2(glyph->U1, glyph->V1) });
+        x += glyph->AdvanceX;
+        line_width += glyph->AdvanceX;
+    }
+    run.size.x = ImMax(run.size.x, line_width);
+    if (line_width > 0.0f || run.size.y == 0.0f)
+        run.size.y += font->FontSize;
+}
+
+static uint64_t textRunKey(ImFont *font, std::string_view text)
+{
+    return std::hash<std::string_view>{}(text) ^ ((uint64_t) (uintptr_t) font * 0x9E3779B97F4A7C15ULL);
+}
+
+static void clearTextRuns();
+
+// Keeps the page cells of a cached run from looking unused
+static void touchPageCells(const text_run_s &run)
+{
+    if (!run.page)
+        return;
+    std::lock_guard<std::mutex> guard(glyph_lock);
+    for (int cell : run.page_cells)
+        run.page->cell_used[cell] = glyph_frame;
+}
+
+static const text_run_s &textRun(ImFont *font, const char *text)
+{
+    if (text_runs_stale.exchange(false))
+        clearTextRuns();
+    std::string_view view(text);
+    uint64_t key = textRunKey(font, view);
+    auto it      = text_run_index.find(key);
+    if (it != text_run_index.end())
+    {
+        auto run = it->second;
+        text_runs.splice(text_runs.begin(), text_runs, run);
+        // Same key but different text, the newer one takes the slot
+        if (run->font != font || run->text != view)
+        {
+            run->font = font;
+            run->text.assign(view);
+            shapeText(*run);
+        }
+        else if (run->incomplete)
+            shapeText(*run);
+        else
+            touchPageCells(*run);
+        return *run;
+    }
+    if (text_runs.size() >= TEXT_RUN_CACHE_SIZE)
+    {
+        text_run_index.erase(textRunKey(text_runs.back().font, text_runs.back().text));
+        text_runs.pop_back();
+    }
+    text_runs.push_front(text_run_s{ font, std::string(view), {}, {} });
+    shapeText(text_runs.front());
+    text_run_index[key] = text_runs.begin();
+    return text_runs.front();
+}
+
+static void clearTextRuns()
+{
+    text_runs.clear();
+    text_run_index.clear();
+}
+
+static void submitQuads(const std::vector<glyph_quad_s> &quads, ImVec2 pos, ImU32 col)
+{
+    if ((col & IM_COL32_A_MASK) == 0 || quads.empty())
+        return;
+    auto list = buffers[currentBuffer];
+    list->PrimReserve(quads.size() * 6, quads.size() * 4);
+    for (auto &quad : quads)
+        list->PrimRectUV(pos + quad.min, pos + quad.max, quad.uv_min, quad.uv_max, col);
+}
+
+// Hands what got rasterized since the last frame to GL, only the new cells unless the page grew
+static void uploadGlyphPages()
+{
+    std::lock_guard<std::mutex> guard(glyph_lock);
+    glyph_frame++;
+    glyphs_rasterized = 0;
+    bool uploaded     = false;
+    for (auto &entry : glyph_pages)
+    {
+        auto &page = *entry.second;
+        if (page.dirty.empty())
+            continue;
+        GLint last_texture;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+        if (!page.texture)
+        {
+            glGenTextures(1, &page.texture);
+            glBindTexture(GL_TEXTURE_2D, page.texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        else
+            glBindTexture(GL_TEXTURE_2D, page.texture);
+        if (page.uploaded_size != page.size)
+        {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page.size, page.size, 0, GL_RGBA, GL_UNSIGNED_BYTE, page.pixels.data());
+            page.uploaded_size = page.size;
+        }
+        else
+        {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, page.size);
+            for (int cell : page.dirty)
+                glTexSubImage2D(GL_TEXTURE_2D, 0, page.cell_x[cell], page.cell_y[cell], page.cell_size, page.cell_size, GL_RGBA, GL_UNSIGNED_BYTE, &page.pixels[page.cell_y[cell] * page.size + page.cell_x[cell]]);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        }
+        glBindTexture(GL_TEXTURE_2D, last_texture);
+        for (int cell : page.dirty)
+        {
+            auto glyph = page.glyphs.find(page.cell_codepoint[cell]);
+            if (glyph != page.glyphs.end() && glyph->second.cell == cell)
+                glyph->second.uploaded = true;
+        }
+        page.dirty.clear();
+        uploaded = true;
+    }
+#if EXTERNAL_DRAWING
+    if (uploaded)
+        overlay_transport::InvalidateTextures();
+#endif
+}
+
 font::font(std::string path, int fontsize, bool outline) : size{ fontsize }, new_size{ fontsize }, path{ path }, outline{ outline }
 {
     font_atlas = new ImFontAtlas();
@@ -50,14 +452,14 @@ font::operator ImFont *()
         needs_rebuild = true;
     return nullptr;
 }
-void font::stringSize(std::string string, float *x, float *y)
+void font::stringSize(const std::string &string, float *x, float *y)
 {
     if (!size_map[size])
     {
         needs_rebuild = true;
         return;
     }
-    ImVec2 result = size_map[size]->CalcTextSizeA(size, FLT_MAX, 0.f, string.c_str());
+    ImVec2 result = textRun(size_map[size], string.c_str()).size;
     if (x)
         *x = result.x;
     if (y)
@@ -72,7 +474,12 @@ void font::changeSize(int new_font_size)
 }
 void font::rebuild()
 {
+    // Rebuilding the atlas moves glyphs around
+    clearTextRuns();
     ImGui_Impl_DestroyFontsTexture(font_atlas);
+#if EXTERNAL_DRAWING
+    overlay_transport::InvalidateTextures();
+#endif
     if (!size_map[new_size])
     {
         size_map[new_size] = font_atlas->AddFontFromFileTTF(path.c_str(), new_size, NULL, font_atlas->GetGlyphRangesDefault());
@@ -95,16 +502,46 @@ Texture::Texture(std::string path) : path{ path }
     textures().push(this);
 }
 
-Texture::Texture(unsigned int id, int h, int w) : texture_id(id), height(h), width(w)
+Texture::Texture(unsigned int id, int h, int w) : texture_id(id), height(h), width(w), atlas_width(w), atlas_height(h), owns_texture(true)
 {
 }
 
+// Decoded PNGs stay in memory so the atlas can be repacked when more textures show up later
+struct atlas_image_s
+{
+    std::string path;
+    std::vector<unsigned char> pixels;
+    int width{ 0 };
+    int height{ 0 };
+    int x{ 0 };
+    int y{ 0 };
+};
+
+static constexpr int ATLAS_MIN_WIDTH = 2048;
+static constexpr int ATLAS_PADDING   = 1;
+
+static std::vector<atlas_image_s> atlas_images;
+static std::vector<Texture *> atlas_users;
+static std::vector<Texture *> atlas_pending;
+static std::future<std::vector<atlas_image_s>> atlas_decode;
+static unsigned int atlas_texture{ 0 };
+static int atlas_width{ 0 };
+static int atlas_height{ 0 };
+
 Texture::~Texture()
 {
-    glDeleteTextures(1, &texture_id);
+    // Atlas textures are all statics that go away on unload, the shared GL texture goes with the context
+    if (owns_texture)
+        glDeleteTextures(1, &texture_id);
 }
 
-void Texture::load()
+unsigned int Texture::get()
+{
+    return texture_id;
+}
+
+// Runs on the decode thread, must not touch GL or any of the atlas state
+static atlas_image_s decodeImage(const std::string &path)
 {
     std::ifstream file(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
 
@@ -116,40 +553,147 @@ void Texture::load()
 
     if (size < 1)
     {
-        logging::Info("Error loading texture, size is under 1");
+        logging::Info("Error loading texture %s, size is under 1", path.c_str());
         throw std::runtime_error("Couldn't init texture!");
     }
 
-    unsigned char *buffer = new unsigned char[(size_t) size + 1];
-    file.read((char *) buffer, size);
+    std::vector<unsigned char> buffer((size_t) size);
+    file.read((char *) buffer.data(), size);
     file.close();
-    int error = decodePNG(data, width, height, buffer, size);
 
-    // if there's an error, display it and return false to indicate failure
+    atlas_image_s image{};
+    image.path          = path;
+    unsigned char *data = nullptr;
+    int error           = decodePNG(data, image.width, image.height, buffer.data(), size);
+
+    // if there's an error, display it and let the render thread throw
     if (error != 0)
     {
-        logging::Info("Error loading texture, error code %i", error);
+        delete[] data;
+        logging::Info("Error loading texture %s, error code %i", path.c_str(), error);
         throw std::runtime_error("Couldn't init texture!");
     }
+    image.pixels.assign(data, data + image.width * image.height * 4);
+    delete[] data;
+    return image;
+}
+
+static std::vector<atlas_image_s> decodeImages(std::vector<std::string> paths)
+{
+    std::vector<atlas_image_s> images;
+    for (auto &path : paths)
+        images.push_back(decodeImage(path));
+    return images;
+}
+
+static atlas_image_s *findImage(const std::string &path)
+{
+    for (auto &image : atlas_images)
+        if (image.path == path)
+            return &image;
+    return nullptr;
+}
+
+static void packAtlas()
+{
+    int width = ATLAS_MIN_WIDTH;
+    for (auto &image : atlas_images)
+        width = std::max(width, image.width + ATLAS_PADDING);
+
+    std::vector<stbrp_rect> rects(atlas_images.size());
+    for (size_t i = 0; i < atlas_images.size(); i++)
     {
-        // Upload texture to graphics system
-        GLint last_texture;
-        glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-        glGenTextures(1, &texture_id);
-        glBindTexture(GL_TEXTURE_2D, texture_id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        // Restore state
-        glBindTexture(GL_TEXTURE_2D, last_texture);
+        rects[i].id = i;
+        rects[i].w  = atlas_images[i].width + ATLAS_PADDING;
+        rects[i].h  = atlas_images[i].height + ATLAS_PADDING;
+    }
+    std::vector<stbrp_node> nodes(width);
+    bool packed = false;
+    for (int height = 2048; height <= 8192 && !packed; height *= 2)
+    {
+        stbrp_context context;
+        stbrp_init_target(&context, width, height, nodes.data(), nodes.size());
+        stbrp_pack_rects(&context, rects.data(), rects.size());
+        packed = std::all_of(rects.begin(), rects.end(), [](const stbrp_rect &rect) { return rect.was_packed; });
+    }
+    if (!packed)
+    {
+        logging::Info("Error packing texture atlas, %u textures do not fit", (unsigned) atlas_images.size());
+        throw std::runtime_error("Couldn't init texture!");
+    }
+
+    int height = 1;
+    for (auto &rect : rects)
+    {
+        atlas_images[rect.id].x = rect.x;
+        atlas_images[rect.id].y = rect.y;
+        height                  = std::max(height, rect.y + rect.h);
     }
-    return;
+
+    // Upload texture to graphics system
+    GLint last_texture;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    if (atlas_texture)
+        glDeleteTextures(1, &atlas_texture);
+#if EXTERNAL_DRAWING
+    overlay_transport::InvalidateTextures();
+#endif
+    glGenTextures(1, &atlas_texture);
+    glBindTexture(GL_TEXTURE_2D, atlas_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    for (auto &image : atlas_images)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, image.x, image.y, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+    // Restore state
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+
+    atlas_width  = width;
+    atlas_height = height;
 }
 
-unsigned int Texture::get()
+// Hands new paths to the decode thread and repacks once it is done.
+// Textures sharing a path share one image in the atlas
+void updateAtlas()
 {
-    return texture_id;
+    if (atlas_decode.valid())
+    {
+        if (atlas_decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+        // Rethrows decode errors here, on the render thread
+        for (auto &image : atlas_decode.get())
+            atlas_images.push_back(std::move(image));
+        packAtlas();
+        for (auto &texture : atlas_pending)
+            atlas_users.push_back(texture);
+        atlas_pending.clear();
+        for (auto &texture : atlas_users)
+        {
+            auto image            = findImage(texture->path);
+            texture->texture_id   = atlas_texture;
+            texture->width        = image->width;
+            texture->height       = image->height;
+            texture->atlas_x      = image->x;
+            texture->atlas_y      = image->y;
+            texture->atlas_width  = atlas_width;
+            texture->atlas_height = atlas_height;
+        }
+    }
+    if (textures().empty())
+        return;
+
+    std::vector<std::string> paths;
+    while (!textures().empty())
+    {
+        auto texture = textures().top();
+        textures().pop();
+        atlas_pending.push_back(texture);
+        if (!findImage(texture->path) && std::find(paths.begin(), paths.end(), texture->path) == paths.end())
+            paths.push_back(texture->path);
+    }
+    // Nothing new to decode, still goes through the future so the pending textures get their regions
+    atlas_decode = std::async(std::launch::async, decodeImages, std::move(paths));
 }
 
 void rebuildAll()
@@ -157,11 +701,8 @@ void rebuildAll()
     for (auto &i : fonts())
         if (i->needs_rebuild)
             i->rebuild();
-    while (!textures().empty())
-    {
-        textures().top()->load();
-        textures().pop();
-    }
+    uploadGlyphPages();
+    updateAtlas();
 }
 
 void init()
@@ -170,11 +711,60 @@ void init()
     rebuildAll();
 }
 
+// Geometry goes to channel 0, every texture (font atlases included) gets a channel of its own.
+// Interleaved text and shapes then cost one draw command per texture and layer instead of one per switch
+static constexpr int MAX_CHANNELS = 8;
+static std::array<ImTextureID, MAX_CHANNELS> channel_textures{};
+static int channel_count = 1;
+static frame_stats stats{};
+
+static void splitChannels()
+{
+    buffers[currentBuffer]->ChannelsSplit(MAX_CHANNELS);
+    channel_count = 1;
+}
+
+static void useChannel(ImTextureID texture)
+{
+    int channel = 0;
+    for (int i = 1; i < channel_count; i++)
+        if (channel_textures[i] == texture)
+            channel = i;
+    // Out of channels, the texture then shares the geometry channel and just switches there
+    if (!channel && channel_count < MAX_CHANNELS)
+    {
+        channel                   = channel_count++;
+        channel_textures[channel] = texture;
+    }
+    buffers[currentBuffer]->ChannelsSetCurrent(channel);
+}
+
 void bufferBegin()
 {
     buffers[currentBuffer]->Clear();
     buffers[currentBuffer]->AddDrawCmd();
     buffers[currentBuffer]->PushClipRectFullScreen();
+    // ChannelsSplit copies the current texture into every channel, so there has to be one
+    buffers[currentBuffer]->PushTextureID(nullptr);
+    splitChannels();
+}
+
+void bufferLayer()
+{
+    buffers[currentBuffer]->ChannelsMerge();
+    splitChannels();
+}
+
+void bufferEnd()
+{
+    buffers[currentBuffer]->ChannelsMerge();
+    stats.draw_calls = buffers[currentBuffer]->CmdBuffer.Size;
+    stats.vertices   = buffers[currentBuffer]->VtxBuffer.Size;
+}
+
+const frame_stats &lastFrameStats()
+{
+    return stats;
 }
 
 void renderStart()
@@ -210,12 +800,17 @@ void renderEnd()
             }
         } */
     }
+#if EXTERNAL_DRAWING
+    if (overlay_transport::Publish(drawdata))
+        return;
+#endif
     ImGui_Impl_Render(drawdata);
 }
 namespace draw
 {
 void line(float x1, float y1, float x2, float y2, rgba_t color, float thickness)
 {
+    buffers[currentBuffer]->ChannelsSetCurrent(0);
     buffers[currentBuffer]->AddLine(ImVec2(x1, y1), ImVec2(x1 + x2, y1 + y2 /* why */), ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)), thickness);
 }
 void string(int x, int y, rgba_t color, const char *text, font &font)
@@ -224,30 +819,49 @@ void string(int x, int y, rgba_t color, const char *text, font &font)
     if (!internal_font || !internal_font->ContainerAtlas) // stupid crash
         return;
 
+    useChannel(internal_font->ContainerAtlas->TexID);
     buffers[currentBuffer]->PushTextureID(internal_font->ContainerAtlas->TexID);
 
-    auto pos = ImVec2(x, y);
+    auto pos  = ImVec2(x, y);
+    auto &run = textRun(internal_font, text);
     if (font.outline)
         for (int i = -1; i < 2; i += 2) // ty ben xd
         {
-            buffers[currentBuffer]->AddText(internal_font, 0, ImVec2(pos.x + i, pos.y), ImGui::GetColorU32(ImVec4(0, 0, 0, color.a)), text);
-            buffers[currentBuffer]->AddText(internal_font, 0, ImVec2(pos.x, pos.y + i), ImGui::GetColorU32(ImVec4(0, 0, 0, color.a)), text);
+            submitQuads(run.quads, ImVec2(pos.x + i, pos.y), ImGui::GetColorU32(ImVec4(0, 0, 0, color.a)));
+            submitQuads(run.quads, ImVec2(pos.x, pos.y + i), ImGui::GetColorU32(ImVec4(0, 0, 0, color.a)));
         }
 
-    buffers[currentBuffer]->AddText(internal_font, 0, pos, ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)), text);
+    submitQuads(run.quads, pos, ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)));
+
+    buffers[currentBuffer]->PopTextureID();
 
+    if (run.page_quads.empty())
+        return;
+    ImTextureID page_texture = (ImTextureID) (uintptr_t) run.page->texture;
+    useChannel(page_texture);
+    buffers[currentBuffer]->PushTextureID(page_texture);
+    if (font.outline)
+        for (int i = -1; i < 2; i += 2)
+        {
+            submitQuads(run.page_quads, ImVec2(pos.x + i, pos.y), ImGui::GetColorU32(ImVec4(0, 0, 0, color.a)));
+            submitQuads(run.page_quads, ImVec2(pos.x, pos.y + i), ImGui::GetColorU32(ImVec4(0, 0, 0, color.a)));
+        }
+    submitQuads(run.page_quads, pos, ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)));
     buffers[currentBuffer]->PopTextureID();
 }
 void rectangle(float x, float y, float w, float h, rgba_t color)
 {
+    buffers[currentBuffer]->ChannelsSetCurrent(0);
     buffers[currentBuffer]->AddRectFilled(ImVec2(x, y), ImVec2(x + w, y + h), ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)), 0.0f, -1);
 }
 void triangle(float x, float y, float x2, float y2, float x3, float y3, rgba_t color)
 {
+    buffers[currentBuffer]->ChannelsSetCurrent(0);
     buffers[currentBuffer]->AddTriangleFilled(ImVec2(x, y), ImVec2(x2, y2), ImVec2(x3, y3), ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)));
 }
 void rectangleOutlined(float x, float y, float w, float h, rgba_t color, float thickness)
 {
+    buffers[currentBuffer]->ChannelsSetCurrent(0);
     buffers[currentBuffer]->AddRect(ImVec2(x, y), ImVec2(x + w, y + h), ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)), 0.0f, -1, thickness);
 }
 void rectangleTextured(float x, float y, float w, float h, rgba_t color, Texture &texture, float tx, float ty, float tw, float th, float angle)
@@ -259,16 +873,16 @@ void rectangleTextured(float x, float y, float w, float h, rgba_t color, Texture
     float cos_a;
     float sin_a;
     SinCos(angle, &sin_a, &cos_a);
-    float tex_width  = texture.getWidth();
-    float tex_height = texture.getHeight();
     ImVec2 center    = ImVec2(x, y);
     ImVec2 pos[4]    = { center + ImRotate(ImVec2(-w * 0.5f, -h * 0.5f), cos_a, sin_a), center + ImRotate(ImVec2(+w * 0.5f, -h * 0.5f), cos_a, sin_a), center + ImRotate(ImVec2(+w * 0.5f, +h * 0.5f), cos_a, sin_a), center + ImRotate(ImVec2(-w * 0.5f, +h * 0.5f), cos_a, sin_a) };
-    ImVec2 uvs[4]    = { ImVec2(tx / tex_width, ty / tex_height), ImVec2((tx + tw) / tex_width, ty / tex_height), ImVec2((tx + tw) / tex_width, (ty + th) / tex_height), ImVec2(tx / tex_width, (ty + th) / tex_height) };
+    ImVec2 uvs[4]    = { ImVec2(texture.getU(tx), texture.getV(ty)), ImVec2(texture.getU(tx + tw), texture.getV(ty)), ImVec2(texture.getU(tx + tw), texture.getV(ty + th)), ImVec2(texture.getU(tx), texture.getV(ty + th)) };
 
+    useChannel((void *) texture.get());
     buffers[currentBuffer]->AddImageQuad((void *) texture.get(), pos[0], pos[1], pos[2], pos[3], uvs[0], uvs[1], uvs[2], uvs[3], ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)));
 }
 void circle(float x, float y, float radius, rgba_t color, float thickness, int steps)
 {
+    buffers[currentBuffer]->ChannelsSetCurrent(0);
     buffers[currentBuffer]->AddCircle(ImVec2(x, y), radius, ImGui::GetColorU32(ImVec4(color.r, color.g, color.b, color.a)), steps, thickness);
 }
 } // namespace draw
@@ -0,0 +1,207 @@
+#include "common.hpp"
+#if EXTERNAL_DRAWING
+#include "visual/imgui/overlaytransport.hpp"
+#include "visual/imgui/imgui.h"
+#include "visual/imgui/imgui_impl.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace overlay_transport
+{
+static settings::Boolean enable{ "visual.overlay-transport.enable", "false" };
+static settings::Boolean show_stats{ "visual.overlay-transport.stats", "false" };
+
+static_assert(sizeof(vertex_s) == sizeof(ImDrawVert), "vertex_s has to match ImDrawVert");
+
+static header_s *header = nullptr;
+// Set once mapping failed so we don't retry every frame
+static bool map_failed = false;
+// GL names of header->textures
+static unsigned int texture_ids[MAX_TEXTURES];
+static uint32_t pool_used    = 0;
+static bool textures_invalid = false;
+static uint64_t frame_number = 0;
+static uint64_t truncated    = 0;
+static int64_t last_write_ns = 0;
+
+static bool Map()
+{
+    if (header)
+        return true;
+    if (map_failed)
+        return false;
+    int fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, sizeof(header_s)) < 0)
+    {
+        logging::Info("Overlay transport: couldn't create %s", SHM_NAME);
+        if (fd >= 0)
+            close(fd);
+        map_failed = true;
+        return false;
+    }
+    void *mapping = mmap(nullptr, sizeof(header_s), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        logging::Info("Overlay transport: couldn't map %s", SHM_NAME);
+        map_failed = true;
+        return false;
+    }
+    header          = (header_s *) mapping;
+    header->magic   = MAGIC;
+    header->version = VERSION;
+    header->latest.store(-1, std::memory_order_relaxed);
+    header->texture_sequence.store(0, std::memory_order_relaxed);
+    header->texture_count = 0;
+    for (auto &frame : header->frames)
+        frame.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+static void BeginTextureWrite()
+{
+    header->texture_sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+static void EndTextureWrite()
+{
+    header->texture_sequence.fetch_add(1, std::memory_order_release);
+}
+
+// Index of the GL texture in the shared table, read back from GL the first time a frame uses it
+static int32_t TextureSlot(ImTextureID texture)
+{
+    if (!texture)
+        return -1;
+    unsigned int id = (unsigned int) (uintptr_t) texture;
+    for (uint32_t i = 0; i < header->texture_count; i++)
+        if (texture_ids[i] == id)
+            return i;
+    if (header->texture_count == MAX_TEXTURES)
+        return -1;
+
+    GLint last_texture, width, height;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    uint32_t size = uint32_t(width) * uint32_t(height) * 4;
+    int32_t slot  = -1;
+    if (size && pool_used + size <= TEXTURE_POOL_SIZE)
+    {
+        BeginTextureWrite();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, header->texture_pool + pool_used);
+        slot                   = header->texture_count++;
+        header->textures[slot] = texture_s{ uint32_t(width), uint32_t(height), pool_used };
+        texture_ids[slot]      = id;
+        pool_used += size;
+        EndTextureWrite();
+    }
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+    return slot;
+}
+
+void InvalidateTextures()
+{
+    textures_invalid = true;
+}
+
+bool Publish(ImDrawData *data)
+{
+    if (!enable || !data || !Map())
+        return false;
+    int64_t start = Now();
+    if (textures_invalid)
+    {
+        BeginTextureWrite();
+        header->texture_count = 0;
+        pool_used             = 0;
+        EndTextureWrite();
+        textures_invalid = false;
+    }
+
+    // Never the slot the overlay was told about last, so it can keep reading that one
+    int32_t slot      = (header->latest.load(std::memory_order_relaxed) + 1) % FRAME_SLOTS;
+    frame_s &frame    = header->frames[slot];
+    uint32_t sequence = frame.sequence.load(std::memory_order_relaxed);
+    frame.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t vertex_count = 0, index_count = 0, command_count = 0;
+    bool overflow = false;
+    for (int i = 0; i < data->CmdListsCount && !overflow; i++)
+    {
+        const ImDrawList *list = data->CmdLists[i];
+        if (vertex_count + list->VtxBuffer.Size > MAX_VERTICES || index_count + list->IdxBuffer.Size > MAX_INDICES || command_count + list->CmdBuffer.Size > MAX_COMMANDS)
+        {
+            overflow = true;
+            break;
+        }
+        memcpy(frame.vertices + vertex_count, list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+        for (int j = 0; j < list->IdxBuffer.Size; j++)
+            frame.indices[index_count + j] = vertex_count + list->IdxBuffer.Data[j];
+        for (auto &cmd : list->CmdBuffer)
+        {
+            // Callbacks only make sense in process, they don't own any elements
+            if (cmd.UserCallback)
+                continue;
+            command_s &out    = frame.commands[command_count++];
+            out.element_count = cmd.ElemCount;
+            out.clip[0]       = cmd.ClipRect.x;
+            out.clip[1]       = cmd.ClipRect.y;
+            out.clip[2]       = cmd.ClipRect.z;
+            out.clip[3]       = cmd.ClipRect.w;
+            out.texture       = TextureSlot(cmd.TextureId);
+        }
+        vertex_count += list->VtxBuffer.Size;
+        index_count += list->IdxBuffer.Size;
+    }
+    if (overflow)
+        truncated++;
+
+    frame.frame_number     = ++frame_number;
+    frame.texture_sequence = header->texture_sequence.load(std::memory_order_relaxed);
+    frame.display_x        = data->DisplayPos.x;
+    frame.display_y        = data->DisplayPos.y;
+    frame.display_width    = data->DisplaySize.x;
+    frame.display_height   = data->DisplaySize.y;
+    frame.vertex_count     = vertex_count;
+    frame.index_count      = index_count;
+    frame.command_count    = command_count;
+    frame.publish_ns       = Now();
+    frame.sequence.store(sequence + 2, std::memory_order_release);
+    header->latest.store(slot, std::memory_order_release);
+    last_write_ns = frame.publish_ns - start;
+    return true;
+}
+
+static void Draw()
+{
+    if (!show_stats || !header)
+        return;
+    uint64_t overlay_frame = header->overlay_frame.load(std::memory_order_relaxed);
+    int64_t latency        = header->overlay_latency_ns.load(std::memory_order_relaxed);
+    char line[128];
+    format_to(line, "Overlay: write ", last_write_ns / 1000, "us, overlay latency ", latency / 1000, "us, ", frame_number - std::min(frame_number, overlay_frame), " frames behind, ", truncated, " truncated");
+    AddSideString(line, GUIColor());
+}
+
+static void Shutdown()
+{
+    if (!header)
+        return;
+    munmap(header, sizeof(header_s));
+    shm_unlink(SHM_NAME);
+    header = nullptr;
+}
+
+static InitRoutine init([]() {
+    EC::Register(EC::Draw, Draw, "overlay_transport_stats", EC::average);
+    EC::Register(EC::Shutdown, Shutdown, "overlay_transport_shutdown", EC::average);
+});
+} // namespace overlay_transport
+#endif
@@ -9,6 +9,7 @@
 #include <menu/menu/special/PlayerListController.hpp>
 #include <hack.hpp>
 #include <common.hpp>
+#include <atomic>
 
 settings::Button open_gui_button{ "visual.open-gui-button", "Insert" };
 
@@ -102,12 +103,12 @@ static void initPlayerlist()
             {
                 if (pl.state == playerlist::k_arrGUIStates.at(i).first)
                 {
-                    pl.state = playerlist::k_arrGUIStates.at(i + 1).first;
+                    playerlist::ChangeState(steam, playerlist::k_arrGUIStates.at(i + 1).first, true);
                     controller->updatePlayerState(userid, playerlist::k_Names[static_cast<size_t>(pl.state)]);
                     return;
                 }
             }
-            pl.state = playerlist::k_arrGUIStates.front().first;
+            playerlist::ChangeState(steam, playerlist::k_arrGUIStates.front().first, true);
             controller->updatePlayerState(userid, playerlist::k_Names[static_cast<size_t>(pl.state)]);
         });
     }
@@ -152,19 +153,78 @@ void gui::shutdown()
         g_IGameEventManager->RemoveListener(&listener);
 }
 
-void gui::draw()
+// Events for the menu. SDL_PollEvent pushes, draw() drains them once per frame, so a 1000Hz mouse costs one
+// menu pass per frame instead of one per event. Nothing gets queued while the menu is closed
+namespace event_queue
 {
-    if (!init_done)
+constexpr size_t SIZE = 256; // Power of two
+static SDL_Event events[SIZE];
+static std::atomic<size_t> head{ 0 };
+static std::atomic<size_t> tail{ 0 };
+// Motion since the last other event, merged into one and queued once something else comes or the poll loop ends
+static SDL_Event motion{};
+static bool has_motion = false;
+
+static void Push(const SDL_Event &event)
+{
+    size_t at = head.load(std::memory_order_relaxed);
+    // Menu hasn't drawn in a while, it won't miss these
+    if (at - tail.load(std::memory_order_acquire) >= SIZE)
         return;
+    events[at & (SIZE - 1)] = event;
+    head.store(at + 1, std::memory_order_release);
+}
 
-    zerokernel::Menu::instance->update();
-    zerokernel::Menu::instance->render();
+static void FlushMotion()
+{
+    if (!has_motion)
+        return;
+    Push(motion);
+    has_motion = false;
+}
+
+static void Queue(const SDL_Event &event)
+{
+    if (event.type != SDL_MOUSEMOTION)
+    {
+        FlushMotion();
+        Push(event);
+        return;
+    }
+    if (!has_motion)
+    {
+        motion     = event;
+        has_motion = true;
+        return;
+    }
+    motion.motion.timestamp = event.motion.timestamp;
+    motion.motion.state     = event.motion.state;
+    motion.motion.x         = event.motion.x;
+    motion.motion.y         = event.motion.y;
+    motion.motion.xrel += event.motion.xrel;
+    motion.motion.yrel += event.motion.yrel;
+}
+
+static void Drain()
+{
+    size_t at  = tail.load(std::memory_order_relaxed);
+    size_t end = head.load(std::memory_order_acquire);
+    for (; at != end; at++)
+    {
+        SDL_Event event = events[at & (SIZE - 1)];
+        tail.store(at + 1, std::memory_order_release);
+        zerokernel::Menu::instance->handleSdlEvent(&event);
+    }
 }
+} // namespace event_queue
+
 static Timer update_players{};
-bool gui::handleSdlEvent(SDL_Event *event)
+
+void gui::draw()
 {
-    if (!zerokernel::Menu::instance)
-        return false;
+    if (!init_done)
+        return;
+
     if (controller && CE_GOOD(LOCAL_E) && update_players.test_and_set(10000))
     {
         controller->removeAll();
@@ -177,6 +237,15 @@ bool gui::handleSdlEvent(SDL_Event *event)
             }
         }
     }
+    event_queue::Drain();
+    zerokernel::Menu::instance->update();
+    zerokernel::Menu::instance->render();
+}
+
+bool gui::handleSdlEvent(SDL_Event *event)
+{
+    if (!zerokernel::Menu::instance)
+        return false;
     if (event->type == SDL_KEYDOWN)
     {
         if (event->key.keysym.scancode == SDL_GetScancodeFromKey((*open_gui_button).keycode))
@@ -200,11 +269,15 @@ bool gui::handleSdlEvent(SDL_Event *event)
             return true;
         }
     }
-    zerokernel::Menu::instance->handleSdlEvent(event);
-    if (!zerokernel::Menu::instance->isInGame() && (event->type == SDL_MOUSEBUTTONDOWN || event->type == SDL_TEXTINPUT || event->type == SDL_KEYDOWN))
-        return true;
-    else
+    if (zerokernel::Menu::instance->isInGame())
         return false;
+    event_queue::Queue(*event);
+    return event->type == SDL_MOUSEBUTTONDOWN || event->type == SDL_TEXTINPUT || event->type == SDL_KEYDOWN;
+}
+
+void gui::flushSdlEvents()
+{
+    event_queue::FlushMotion();
 }
 
 void gui::onLevelLoad()
@@ -115,8 +115,10 @@ void Container::update()
         reorderElements();
         reorder_needed = false;
     }
+    // Hidden subtrees keep their reorder flags until they are shown again
     for (auto &object : objects)
-        object->update();
+        if (!object->isHidden())
+            object->update();
 }
 
 void Container::addObject(std::unique_ptr<BaseMenuObject> &&object)
@@ -3,10 +3,23 @@
 */
 
 #include <menu/object/container/TabContainer.hpp>
+#include <menu/special/SettingsManagerList.hpp>
 
 namespace zerokernel
 {
 
+// Variables of tabs that are not built yet still count as present in the UI
+static void markVariables(const tinyxml2::XMLElement *element)
+{
+    for (auto el = element->FirstChildElement(); el != nullptr; el = el->NextSiblingElement())
+    {
+        const char *target;
+        if (!strcmp("AutoVariable", el->Name()) && tinyxml2::XML_SUCCESS == el->QueryStringAttribute("target", &target))
+            special::SettingsManagerList::markVariable(target);
+        markVariables(el);
+    }
+}
+
 void TabContainer::loadFromXml(const tinyxml2::XMLElement *data)
 {
     BaseMenuObject::loadFromXml(data);
@@ -17,7 +30,8 @@ void TabContainer::loadFromXml(const tinyxml2::XMLElement *data)
         const char *name = "Unnamed";
         el->QueryStringAttribute("name", &name);
         addTab(name);
-        containers.at(containers.size() - 1)->loadFromXml(el);
+        pending.push_back(el);
+        markVariables(el);
         el = el->NextSiblingElement("Tab");
     }
 }
@@ -121,7 +135,7 @@ Container *TabContainer::getTab(std::string title)
     {
         if (selection.options.at(i) == title)
         {
-            return containers.at(i).get();
+            return loadTab(i);
         }
     }
     return nullptr;
@@ -160,6 +174,21 @@ Container *TabContainer::getActiveContainer()
         printf("WARNING: TabContainer: selection.active >= container.size()\n");
         return nullptr;
     }
-    return containers.at(selection.active).get();
+    return loadTab(selection.active);
+}
+
+Container *TabContainer::loadTab(size_t index)
+{
+    auto &container = containers.at(index);
+    if (index < pending.size() && pending[index])
+    {
+        auto el        = pending[index];
+        pending[index] = nullptr;
+        container->loadFromXml(el);
+        // Same as what Menu::loadFromXml does for the whole tree
+        container->onParentMove();
+        container->recursiveSizeUpdate();
+    }
+    return container.get();
 }
 } // namespace zerokernel
\ No newline at end of file
@@ -15,25 +15,16 @@ zerokernel::special::SettingsManagerList::SettingsManagerList(zerokernel::Contai
 
 void zerokernel::special::SettingsManagerList::construct()
 {
-    using pair_type = std::pair<std::string, settings::IVariable *>;
-    std::vector<pair_type> all_registered{};
-    for (auto &v : settings::Manager::instance().registered)
+    for (auto &v : settings::Manager::instance().sorted())
     {
-        all_registered.emplace_back(std::make_pair(v.first, &v.second.variable));
-    }
-
-    std::sort(all_registered.begin(), all_registered.end(), [](const pair_type &a, const pair_type &b) -> bool { return a.first.compare(b.first) < 0; });
-
-    for (auto &v : all_registered)
-    {
-        auto name      = explodeVariableName(v.first);
+        auto name      = explodeVariableName(*v.first);
         TreeNode *node = &root;
         for (auto &n : name)
         {
             node = &((*node)[n]);
         }
-        node->full_name = v.first;
-        node->variable  = v.second;
+        node->full_name = *v.first;
+        node->variable  = &v.second->variable;
     }
 
     recursiveWork(root, 0);
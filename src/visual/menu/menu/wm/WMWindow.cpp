@@ -37,7 +37,10 @@ bool WMWindow::handleSdlEvent(SDL_Event *event)
         }
     }
 
-    return Container::handleSdlEvent(event);
+    if (!Container::handleSdlEvent(event))
+        return false;
+    render_dirty = true;
+    return true;
 }
 
 void WMWindow::render()
@@ -45,6 +48,18 @@ void WMWindow::render()
     if (isHidden())
         return;
 
+    // Hover highlights and tooltips need the live tree, so windows are only replayed once the mouse has been outside for a frame
+    bool mouse_inside = containsMouse();
+    bool replay       = !render_dirty && !mouse_inside && !mouse_was_inside && Menu::instance->modal_stack.empty() && rendered_frame + 1 == Menu::instance->frame && !render_refresh.check(250);
+    mouse_was_inside  = mouse_inside;
+    rendered_frame    = Menu::instance->frame;
+    if (replay)
+    {
+        draw::Play(render_cache);
+        return;
+    }
+
+    draw::BeginRecording(render_cache);
     if (isFocused())
         renderBackground(*zerokernel_wmwindow::color_background);
     else
@@ -52,6 +67,42 @@ void WMWindow::render()
     renderBorder(*zerokernel_wmwindow::color_border);
 
     Container::render();
+    draw::EndRecording();
+    render_dirty = false;
+    render_refresh.update();
+}
+
+void WMWindow::update()
+{
+    if (layout_pending)
+    {
+        layout_pending = false;
+        Container::recursiveSizeUpdate();
+    }
+    Container::update();
+}
+
+void WMWindow::emitSizeUpdate()
+{
+    Container::emitSizeUpdate();
+    render_dirty = true;
+}
+
+void WMWindow::onMove()
+{
+    Container::onMove();
+    render_dirty = true;
+}
+
+void WMWindow::recursiveSizeUpdate()
+{
+    // Hidden windows get no events or updates either, nothing depends on their layout until they show up
+    if (isHidden())
+    {
+        layout_pending = true;
+        return;
+    }
+    Container::recursiveSizeUpdate();
 }
 
 void WMWindow::loadFromXml(const tinyxml2::XMLElement *data)
@@ -78,12 +129,14 @@ void WMWindow::handleMessage(Message &msg, bool is_relayed)
 
 void WMWindow::wmFocusGain()
 {
-    focused = true;
+    focused      = true;
+    render_dirty = true;
 }
 
 void WMWindow::wmFocusLose()
 {
-    focused = false;
+    focused      = false;
+    render_dirty = true;
 }
 
 void WMWindow::wmCloseWindow()
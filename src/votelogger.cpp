@@ -66,27 +66,21 @@ struct CVRNG
     Timer timer{};
 };
 static CVRNG vote_command;
-void dispatchUserMessage(bf_read &buffer, int type)
+void dispatchUserMessage(const usermessages::message_s &message)
 {
-    switch (type)
+    switch (message.type)
     {
-    case 45:
+    case usermessages::CallVoteFailed:
         // Vote setup Failed, Refresh vote timer for catbot so it can try again
         hacks::shared::catbot::timer_votekicks.last -= std::chrono::seconds(4);
         break;
-    case 46:
+    case usermessages::VoteStart:
     {
         // TODO: Add always vote no/vote no on friends. Cvar is "vote option2"
-        was_local_player = false;
-        int team         = buffer.ReadByte();
-        int caller       = buffer.ReadByte();
-        char reason[64];
-        char name[64];
-        buffer.ReadString(reason, 64, false, nullptr);
-        buffer.ReadString(name, 64, false, nullptr);
-        auto target = (unsigned char) buffer.ReadByte();
-        buffer.Seek(0);
-        target >>= 1;
+        was_local_player   = false;
+        int caller         = message.vote_start.caller;
+        int target         = message.vote_start.target;
+        const char *reason = message.vote_start.reason;
 
         // info is the person getting kicked,
         // info2 is the person calling the kick.
@@ -116,7 +110,7 @@ void dispatchUserMessage(bf_read &buffer, int type)
                 vote_command = { "vote option2", 1000u + (rand() % 5000) };
                 vote_command.timer.update();
                 if (*vote_rage_vote && !friendly_caller)
-                    pl_caller.state = k_EState::RAGE;
+                    ChangeState(info2.friendsID, k_EState::RAGE, true);
             }
             else if (*vote_kicky && !friendly_kicked)
             {
@@ -137,17 +131,17 @@ void dispatchUserMessage(bf_read &buffer, int type)
 #endif
         break;
     }
-    case 47:
+    case usermessages::VotePass:
     {
         logging::Info("Vote passed");
         // if (was_local_player && requeue)
         //    tfmm::startQueue();
         break;
     }
-    case 48:
+    case usermessages::VoteFailed:
         logging::Info("Vote failed");
         break;
-    case 49:
+    case usermessages::VoteSetup:
         logging::Info("VoteSetup?");
         break;
     default:
@@ -207,39 +201,30 @@ static void reset_vote_rage()
     EC::Unregister(EC::CreateMove, "vote_rage_back");
 }
 
-class VoteEventListener : public IGameEventListener
+static void OnVoteCast(const game_events::event_s &event)
 {
-public:
-    void FireGameEvent(KeyValues *event) override
-    {
-        if (!*chat_casts || (!*chat_partysay && !chat))
-            return;
-        const char *name = event->GetName();
-        if (!strcmp(name, "vote_cast"))
-        {
-            bool vote_option = event->GetInt("vote_option");
-            if (*chat_casts_f1_only && vote_option)
-                return;
-            int eid = event->GetInt("entityid");
+    if (!*chat_casts || (!*chat_partysay && !chat))
+        return;
+    bool vote_option = event.raw->GetInt("vote_option");
+    if (*chat_casts_f1_only && vote_option)
+        return;
+    int eid = event.raw->GetInt("entityid");
 
-            player_info_s info{};
-            if (!g_IEngine->GetPlayerInfo(eid, &info))
-                return;
-            if (chat_partysay)
-            {
-                char formated_string[256];
-                std::snprintf(formated_string, sizeof(formated_string), "[CAT] %s [U:1:%u] %s", info.name, info.friendsID, vote_option ? "F2" : "F1");
+    player_info_s info{};
+    if (!g_IEngine->GetPlayerInfo(eid, &info))
+        return;
+    if (chat_partysay)
+    {
+        char formated_string[256];
+        std::snprintf(formated_string, sizeof(formated_string), "[CAT] %s [U:1:%u] %s", info.name, info.friendsID, vote_option ? "F2" : "F1");
 
-                re::CTFPartyClient::GTFPartyClient()->SendPartyChat(formated_string);
-            }
+        re::CTFPartyClient::GTFPartyClient()->SendPartyChat(formated_string);
+    }
 #if ENABLE_VISUALS
-            if (chat)
-                PrintChat("\x07%06X%s\x01 [U:1:%u] %s", colors::chat::team(g_pPlayerResource->getTeam(eid)), info.name, info.friendsID, vote_option ? "F2" : "F1");
+    if (chat)
+        PrintChat("\x07%06X%s\x01 [U:1:%u] %s", colors::chat::team(g_pPlayerResource->getTeam(eid)), info.name, info.friendsID, vote_option ? "F2" : "F1");
 #endif
-        }
-    }
-};
-static VoteEventListener listener{};
+}
 static InitRoutine init([]() {
     if (*vote_rage_vote)
         setup_vote_rage();
@@ -251,8 +236,6 @@ static InitRoutine init([]() {
         else
             reset_vote_rage();
     });
-    g_IGameEventManager->AddListener(&listener, false);
-    EC::Register(
-        EC::Shutdown, []() { g_IGameEventManager->RemoveListener(&listener); }, "event_shutdown_vote");
+    game_events::Subscribe("vote_cast", OnVoteCast);
 });
 } // namespace votelogger